@@ -41,6 +41,7 @@
 #include <rte_per_lcore.h>
 #include <rte_lcore.h>
 #include <rte_ip.h>
+#include <rte_cpuflags.h>
 
 #define	PRINT_USAGE_START	"%s [EAL options]\n"
 
@@ -58,6 +59,8 @@
 
 #define	rte_eal_init(c, v)	(0)
 
+#define	RTE_MAX_LCORE	1
+
 #define	PRINT_USAGE_START	"%s\n"
 
 #endif /*RTE_LIBRTE_ACL_STANDALONE */
@@ -83,11 +86,14 @@
 #define	OPT_TRACE_NUM		"tracenum"
 #define	OPT_TRACE_STEP		"tracestep"
 #define	OPT_SEARCH_SCALAR	"scalar"
+#define	OPT_SEARCH_ALG		"alg"
 #define	OPT_BLD_CATEGORIES	"bldcat"
 #define	OPT_RUN_CATEGORIES	"runcat"
 #define	OPT_ITER_NUM		"iter"
 #define	OPT_VERBOSE		"verbose"
 #define	OPT_IPV6		"ipv6"
+#define	OPT_BLD_THREADS		"bldthreads"
+#define	OPT_MAX_SIZE		"maxsize"
 
 #define	TRACE_DEFAULT_NUM	0x10000
 #define	TRACE_STEP_MAX		0x1000
@@ -95,6 +101,27 @@
 
 #define	RULE_NUM		0x10000
 
+static const struct acl_alg {
+	const char *name;
+	enum rte_acl_classify_alg alg;
+} acl_alg[] = {
+	{
+		.name = "scalar",
+		.alg = RTE_ACL_CLASSIFY_SCALAR,
+	},
+	{
+		.name = "sse",
+		.alg = RTE_ACL_CLASSIFY_SSE,
+	},
+	{
+		.name = "avx2",
+		.alg = RTE_ACL_CLASSIFY_AVX2,
+	},
+};
+
+/* special value for OPT_SEARCH_ALG: compare all available methods. */
+#define	ACL_ALG_ALL	"all"
+
 enum {
 	DUMP_NONE,
 	DUMP_SEARCH,
@@ -115,10 +142,13 @@ static struct {
 	uint32_t            iter_num;
 	uint32_t            verbose;
 	uint32_t            scalar;
+	const char         *alg_name;
 	uint32_t            used_traces;
 	void               *traces;
 	struct rte_acl_ctx *acx;
 	uint32_t			ipv6;
+	uint32_t            bld_threads;
+	size_t              max_size;
 } config = {
 	.bld_categories = 3,
 	.run_categories = 1,
@@ -127,9 +157,63 @@ static struct {
 	.trace_step = TRACE_STEP_DEF,
 	.iter_num = 1,
 	.verbose = DUMP_MAX,
-	.ipv6 = 0
+	.ipv6 = 0,
+	.bld_threads = 1,
+	.max_size = 0,
 };
 
+/* per lcore search statistics. */
+static struct {
+	uint64_t pkt;
+	uint64_t tm;
+	uint64_t res_hash;
+} __rte_cache_aligned lcore_stats[RTE_MAX_LCORE];
+
+static const struct acl_alg *
+find_alg(const char *name)
+{
+	uint32_t i;
+
+	for (i = 0; i != RTE_DIM(acl_alg); i++) {
+		if (strcmp(name, acl_alg[i].name) == 0)
+			return &acl_alg[i];
+	}
+
+	rte_exit(-EINVAL, "unknown classify method: \"%s\"\n", name);
+	return NULL;
+}
+
+/* check that both the CPU and the library support given method. */
+static int
+alg_supported(const struct acl_alg *alg)
+{
+	uint32_t res;
+	const uint8_t *data[1];
+
+#ifndef RTE_LIBRTE_ACL_STANDALONE
+	if ((alg->alg == RTE_ACL_CLASSIFY_SSE &&
+			!rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1)) ||
+			(alg->alg == RTE_ACL_CLASSIFY_AVX2 &&
+			!rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2)))
+		return 0;
+#endif
+
+	/* method might not be compiled in, probe it with an empty burst. */
+	return rte_acl_classify_alg(config.acx, data, &res, 0, 1,
+		alg->alg) == 0;
+}
+
+static void
+acx_set_alg(const struct acl_alg *alg)
+{
+	int ret;
+
+	ret = rte_acl_set_ctx_classify(config.acx, alg->alg);
+	if (ret != 0)
+		rte_exit(ret, "failed to setup classify method %s "
+			"for ACL context\n", alg->name);
+}
+
 static struct rte_acl_param prm = {
 	.name = APP_NAME,
 	.socket_id = SOCKET_ID_ANY,
@@ -754,8 +838,11 @@ acx_init(void)
 {
 	int ret;
 	FILE *f;
+	uint64_t tm;
 	struct rte_acl_config cfg;
 
+	memset(&cfg, 0, sizeof(cfg));
+
 	/* setup ACL build config. */
 	if (config.ipv6) {
 		cfg.num_fields = RTE_DIM(ipv6_defs);
@@ -765,6 +852,8 @@ acx_init(void)
 		memcpy(&cfg.defs, ipv4_defs, sizeof(ipv4_defs));
 	}
 	cfg.num_categories = config.bld_categories;
+	cfg.num_threads = config.bld_threads;
+	cfg.max_size = config.max_size;
 
 	/* setup ACL creation parameters. */
 	prm.rule_size = RTE_ACL_RULE_SZ(cfg.num_fields);
@@ -783,6 +872,11 @@ acx_init(void)
 				"for ACL context\n");
 	}
 
+	/* set requested classify method for this context. */
+	if (config.alg_name != NULL &&
+			strcmp(config.alg_name, ACL_ALG_ALL) != 0)
+		acx_set_alg(find_alg(config.alg_name));
+
 	/* add ACL rules. */
 	f = fopen(config.rule_file, "r");
 	if (f == NULL)
@@ -796,11 +890,16 @@ acx_init(void)
 	fclose(f);
 
 	/* perform build. */
+	tm = rte_rdtsc();
 	ret = rte_acl_build(config.acx, &cfg);
+	tm = rte_rdtsc() - tm;
 
 	dump_verbose(DUMP_NONE, stdout,
 		"rte_acl_build(%u) finished with %d\n",
 		config.bld_categories, ret);
+	dump_verbose(DUMP_NONE, stdout,
+		"build with %u threads took %" PRIu64 " cycles\n",
+		config.bld_threads, tm);
 
 	rte_acl_dump(config.acx);
 
@@ -809,7 +908,8 @@ acx_init(void)
 }
 
 static uint32_t
-search_ip5tuples_once(uint32_t categories, uint32_t step, int scalar)
+search_ip5tuples_once(uint32_t categories, uint32_t step, const char *alg,
+	uint64_t *res_hash)
 {
 	int ret;
 	uint32_t i, j, k, n, r;
@@ -835,6 +935,7 @@ search_ip5tuples_once(uint32_t categories, uint32_t step, int scalar)
 
 		for (r = 0, j = 0; j != n; j++) {
 			for (k = 0; k != categories; k++, r++) {
+				*res_hash = *res_hash * 31 + results[r];
 				dump_verbose(DUMP_PKT, stdout,
 					"ipv%c_5tuple: %u, category: %u, "
 					"result: %u\n",
@@ -847,35 +948,122 @@ search_ip5tuples_once(uint32_t categories, uint32_t step, int scalar)
 
 	dump_verbose(DUMP_SEARCH, stdout,
 		"%s(%u, %u, %s) returns %u\n", __func__,
-		categories, step, scalar != 0 ? "scalar" : "sse", i);
+		categories, step, alg, i);
 	return i;
 }
 
 static int
-search_ip5tuples(__attribute__((unused)) void *arg)
+search_ip5tuples(void *arg)
 {
-	uint64_t pkt, start, tm;
+	uint64_t pkt, start, tm, res_hash;
 	uint32_t i, lcore;
+	const char *alg;
 
+	alg = (arg != NULL) ? arg : "default";
 	lcore = rte_lcore_id();
 	start = rte_rdtsc();
 	pkt = 0;
+	res_hash = 0;
 
 	for (i = 0; i != config.iter_num; i++) {
 		pkt += search_ip5tuples_once(config.run_categories,
-			config.trace_step, config.scalar);
+			config.trace_step, alg, &res_hash);
 	}
 
 	tm = rte_rdtsc() - start;
 	dump_verbose(DUMP_NONE, stdout,
-		"%s  @lcore %u: %" PRIu32 " iterations, %" PRIu64 " pkts, %"
-		PRIu32 " categories, %" PRIu64 " cycles, %#Lf cycles/pkt\n",
-		__func__, lcore, i, pkt, config.run_categories,
+		"%s(%s)  @lcore %u: %" PRIu32 " iterations, %" PRIu64
+		" pkts, %" PRIu32 " categories, %" PRIu64 " cycles, "
+		"%#Lf cycles/pkt\n",
+		__func__, alg, lcore, i, pkt, config.run_categories,
 		tm, (long double)tm / pkt);
 
+	lcore_stats[lcore].pkt = pkt;
+	lcore_stats[lcore].tm = tm;
+	lcore_stats[lcore].res_hash = res_hash;
 	return 0;
 }
 
+/*
+ * Run the search on all lcores with the context's classify method,
+ * per lcore statistics are left in lcore_stats[].
+ */
+static void
+run_search(const char *alg)
+{
+	uint32_t lcore;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+		 rte_eal_remote_launch(search_ip5tuples, (void *)(uintptr_t)alg,
+			lcore);
+
+	search_ip5tuples((void *)(uintptr_t)alg);
+
+	rte_eal_mp_wait_lcore();
+}
+
+/*
+ * Run the search with every classify method available on that machine,
+ * print them side by side and check that all of them produce
+ * the same results.
+ */
+static void
+search_all_algs(void)
+{
+	uint32_t i, lcore, n;
+	long double cpp, ref_cpp;
+	uint64_t ref_hash;
+	struct {
+		const struct acl_alg *alg;
+		long double cpp;
+		int match;
+	} res[RTE_DIM(acl_alg)];
+
+	lcore = rte_lcore_id();
+	ref_cpp = 0;
+	ref_hash = 0;
+	n = 0;
+
+	for (i = 0; i != RTE_DIM(acl_alg); i++) {
+
+		if (!alg_supported(&acl_alg[i])) {
+			dump_verbose(DUMP_NONE, stdout,
+				"%s: classify method %s is not supported, "
+				"skipping\n", __func__, acl_alg[i].name);
+			continue;
+		}
+
+		acx_set_alg(&acl_alg[i]);
+		run_search(acl_alg[i].name);
+
+		cpp = (long double)lcore_stats[lcore].tm /
+			lcore_stats[lcore].pkt;
+		if (n == 0) {
+			ref_cpp = cpp;
+			ref_hash = lcore_stats[lcore].res_hash;
+		}
+
+		res[n].alg = &acl_alg[i];
+		res[n].cpp = cpp;
+		res[n].match = (lcore_stats[lcore].res_hash == ref_hash);
+		n++;
+	}
+
+	fprintf(stdout, "%s  @lcore %u:\n", __func__, lcore);
+	fprintf(stdout, "%-8s %16s %12s %8s\n",
+		"method", "cycles/pkt", "speedup", "results");
+	for (i = 0; i != n; i++)
+		fprintf(stdout, "%-8s %16.2Lf %11.2Lfx %8s\n",
+			res[i].alg->name, res[i].cpp, ref_cpp / res[i].cpp,
+			res[i].match ? "ok" : "MISMATCH");
+
+	for (i = 0; i != n; i++) {
+		if (!res[i].match)
+			rte_exit(-EINVAL, "classify method %s produced "
+				"different results\n", res[i].alg->name);
+	}
+}
+
 static uint32_t
 get_uint32_opt(const char *opt, const char *name, uint32_t min, uint32_t max)
 {
@@ -912,7 +1100,14 @@ print_usage(const char *prgname)
 		"[--" OPT_ITER_NUM "=<number of iterations to perform>]\n"
 		"[--" OPT_VERBOSE "=<verbose level>]\n"
 		"[--" OPT_SEARCH_SCALAR "=<use scalar version>]\n"
-		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n",
+		"[--" OPT_SEARCH_ALG "=<scalar|sse|avx2|" ACL_ALG_ALL "> "
+			"classify method to use, " ACL_ALG_ALL
+			" runs and compares every available one]\n"
+		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n"
+		"[--" OPT_BLD_THREADS
+			"=<number of threads to build ACL context with>]\n"
+		"[--" OPT_MAX_SIZE
+			"=<memory budget in bytes for the build, 0 - no limit>]\n",
 		prgname, RTE_ACL_RESULTS_MULTIPLIER,
 		(uint32_t)RTE_ACL_MAX_CATEGORIES);
 }
@@ -931,7 +1126,11 @@ dump_config(FILE *f)
 	fprintf(f, "%s:%u\n", OPT_ITER_NUM, config.iter_num);
 	fprintf(f, "%s:%u\n", OPT_VERBOSE, config.verbose);
 	fprintf(f, "%s:%u\n", OPT_SEARCH_SCALAR, config.scalar);
+	fprintf(f, "%s:%s\n", OPT_SEARCH_ALG,
+		config.alg_name != NULL ? config.alg_name : "default");
 	fprintf(f, "%s:%u\n", OPT_IPV6, config.ipv6);
+	fprintf(f, "%s:%u\n", OPT_BLD_THREADS, config.bld_threads);
+	fprintf(f, "%s:%zu\n", OPT_MAX_SIZE, config.max_size);
 }
 
 static void
@@ -959,7 +1158,10 @@ get_input_opts(int argc, char **argv)
 		{OPT_ITER_NUM, 1, 0, 0},
 		{OPT_VERBOSE, 1, 0, 0},
 		{OPT_SEARCH_SCALAR, 0, 0, 0},
+		{OPT_SEARCH_ALG, 1, 0, 0},
 		{OPT_IPV6, 0, 0, 0},
+		{OPT_BLD_THREADS, 1, 0, 0},
+		{OPT_MAX_SIZE, 1, 0, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -1004,8 +1206,19 @@ get_input_opts(int argc, char **argv)
 		} else if (strcmp(lgopts[opt_idx].name,
 				OPT_SEARCH_SCALAR) == 0) {
 			config.scalar = 1;
+		} else if (strcmp(lgopts[opt_idx].name, OPT_SEARCH_ALG) == 0) {
+			if (strcmp(optarg, ACL_ALG_ALL) != 0)
+				find_alg(optarg);
+			config.alg_name = optarg;
 		} else if (strcmp(lgopts[opt_idx].name, OPT_IPV6) == 0) {
 			config.ipv6 = 1;
+		} else if (strcmp(lgopts[opt_idx].name,
+				OPT_BLD_THREADS) == 0) {
+			config.bld_threads = get_uint32_opt(optarg,
+				lgopts[opt_idx].name, 1, UINT8_MAX);
+		} else if (strcmp(lgopts[opt_idx].name, OPT_MAX_SIZE) == 0) {
+			config.max_size = get_uint32_opt(optarg,
+				lgopts[opt_idx].name, 0, UINT32_MAX);
 		}
 	}
 	config.trace_sz = config.ipv6 ? sizeof(struct ipv6_5tuple) :
@@ -1017,7 +1230,6 @@ int
 main(int argc, char **argv)
 {
 	int ret;
-	uint32_t lcore;
 
 	ret = rte_eal_init(argc, argv);
 	if (ret < 0)
@@ -1037,12 +1249,11 @@ main(int argc, char **argv)
 	if (config.trace_file != NULL)
 		tracef_init();
 
-	RTE_LCORE_FOREACH_SLAVE(lcore)
-		 rte_eal_remote_launch(search_ip5tuples, NULL, lcore);
-
-	search_ip5tuples(NULL);
-
-	rte_eal_mp_wait_lcore();
+	if (config.alg_name != NULL &&
+			strcmp(config.alg_name, ACL_ALG_ALL) == 0)
+		search_all_algs();
+	else
+		run_search(config.alg_name);
 
 	rte_acl_free(config.acx);
 	return 0;
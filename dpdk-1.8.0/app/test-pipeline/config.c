@@ -141,6 +141,7 @@ struct {
 	{"acl", e_APP_PIPELINE_ACL},
 	{"lpm", e_APP_PIPELINE_LPM},
 	{"lpm-ipv6", e_APP_PIPELINE_LPM_IPV6},
+	{"chain", e_APP_PIPELINE_CHAIN},
 };
 
 int
@@ -168,6 +169,7 @@ app_parse_args(int argc, char **argv)
 		{"acl", 0, 0, 0},
 		{"lpm", 0, 0, 0},
 		{"lpm-ipv6", 0, 0, 0},
+		{"chain", 0, 0, 0},
 		{NULL, 0, 0, 0}
 	};
 	uint32_t lcores[3], n_lcores, lcore_id, pipeline_type_provided;
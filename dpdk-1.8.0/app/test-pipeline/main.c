@@ -164,6 +164,14 @@ app_lcore_main_loop(__attribute__((unused)) void *arg)
 			app_main_loop_worker_pipeline_lpm_ipv6();
 			return 0;
 
+		case e_APP_PIPELINE_CHAIN:
+#ifndef RTE_LIBRTE_ACL
+			rte_exit(EXIT_FAILURE, "ACL not present in build\n");
+#else
+			app_main_loop_worker_pipeline_chain();
+			return 0;
+#endif
+
 		case e_APP_PIPELINE_NONE:
 		default:
 			app_main_loop_worker();
@@ -116,6 +116,7 @@ enum {
 	e_APP_PIPELINE_ACL,
 	e_APP_PIPELINE_LPM,
 	e_APP_PIPELINE_LPM_IPV6,
+	e_APP_PIPELINE_CHAIN,
 	e_APP_PIPELINES
 };
 
@@ -129,6 +130,7 @@ void app_main_loop_worker_pipeline_hash(void);
 void app_main_loop_worker_pipeline_acl(void);
 void app_main_loop_worker_pipeline_lpm(void);
 void app_main_loop_worker_pipeline_lpm_ipv6(void);
+void app_main_loop_worker_pipeline_chain(void);
 
 void app_main_loop_tx(void);
 
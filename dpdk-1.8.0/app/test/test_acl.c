@@ -42,6 +42,7 @@
 #include <rte_ip.h>
 #include <rte_acl.h>
 #include <rte_common.h>
+#include <rte_cpuflags.h>
 
 #include "test_acl.h"
 
@@ -89,6 +90,67 @@ bswap_test_data(struct ipv4_7tuple *data, int len, int to_be)
 	}
 }
 
+/*
+ * Run vector classify methods over all burst sizes
+ * and check them against the expected results.
+ */
+static int
+test_classify_alg(struct rte_acl_ctx *acx, const uint8_t **data,
+	uint32_t *results)
+{
+	static const struct {
+		enum rte_acl_classify_alg alg;
+		enum rte_cpu_flag_t flag;
+		const char *name;
+	} algs[] = {
+		{RTE_ACL_CLASSIFY_SSE, RTE_CPUFLAG_SSE4_1, "SSE"},
+		{RTE_ACL_CLASSIFY_AVX2, RTE_CPUFLAG_AVX2, "AVX2"},
+	};
+
+	int ret;
+	uint32_t a, count, i;
+	const uint32_t *res;
+
+	for (a = 0; a != RTE_DIM(algs); a++) {
+
+		if (!rte_cpu_get_flag_enabled(algs[a].flag)) {
+			printf("%s classify is not supported by CPU, "
+				"skipping\n", algs[a].name);
+			continue;
+		}
+
+		for (count = 0; count <= RTE_DIM(acl_test_data); count++) {
+			ret = rte_acl_classify_alg(acx, data, results, count,
+				RTE_ACL_MAX_CATEGORIES, algs[a].alg);
+			if (ret == -ENOTSUP) {
+				printf("%s classify is not compiled in, "
+					"skipping\n", algs[a].name);
+				break;
+			} else if (ret != 0) {
+				printf("Line %i: %s classify failed!\n",
+					__LINE__, algs[a].name);
+				return ret;
+			}
+
+			for (i = 0; i != count; i++) {
+				res = results + i * RTE_ACL_MAX_CATEGORIES;
+				if (res[ACL_ALLOW] != acl_test_data[i].allow ||
+						res[ACL_DENY] !=
+						acl_test_data[i].deny) {
+					printf("Line %i: %s classify error "
+						"in results at %u "
+						"(burst of %u)!\n",
+						__LINE__, algs[a].name,
+						i, count);
+					return -1;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
 /*
  * Test scalar and SSE ACL lookup.
  */
@@ -178,7 +240,7 @@ test_classify_run(struct rte_acl_ctx *acx)
 		}
 	}
 
-	ret = 0;
+	ret = test_classify_alg(acx, data, results);
 
 err:
 	/* swap data back to cpu order so that next time tests don't fail */
@@ -271,6 +333,154 @@ test_classify(void)
 	return ret;
 }
 
+/*
+ * Build config equivalent to rte_acl_ipv4vlan_build() for struct ipv4_7tuple.
+ */
+static void
+test_build_config(struct rte_acl_config *cfg)
+{
+	static const struct rte_acl_field_def
+		defs[RTE_ACL_IPV4VLAN_NUM_FIELDS] = {
+		{
+			.type = RTE_ACL_FIELD_TYPE_BITMASK,
+			.size = sizeof(uint8_t),
+			.field_index = RTE_ACL_IPV4VLAN_PROTO_FIELD,
+			.input_index = RTE_ACL_IPV4VLAN_PROTO,
+			.offset = offsetof(struct ipv4_7tuple, proto),
+		},
+		{
+			.type = RTE_ACL_FIELD_TYPE_BITMASK,
+			.size = sizeof(uint16_t),
+			.field_index = RTE_ACL_IPV4VLAN_VLAN1_FIELD,
+			.input_index = RTE_ACL_IPV4VLAN_VLAN,
+			.offset = offsetof(struct ipv4_7tuple, vlan),
+		},
+		{
+			.type = RTE_ACL_FIELD_TYPE_BITMASK,
+			.size = sizeof(uint16_t),
+			.field_index = RTE_ACL_IPV4VLAN_VLAN2_FIELD,
+			.input_index = RTE_ACL_IPV4VLAN_VLAN,
+			.offset = offsetof(struct ipv4_7tuple, domain),
+		},
+		{
+			.type = RTE_ACL_FIELD_TYPE_MASK,
+			.size = sizeof(uint32_t),
+			.field_index = RTE_ACL_IPV4VLAN_SRC_FIELD,
+			.input_index = RTE_ACL_IPV4VLAN_SRC,
+			.offset = offsetof(struct ipv4_7tuple, ip_src),
+		},
+		{
+			.type = RTE_ACL_FIELD_TYPE_MASK,
+			.size = sizeof(uint32_t),
+			.field_index = RTE_ACL_IPV4VLAN_DST_FIELD,
+			.input_index = RTE_ACL_IPV4VLAN_DST,
+			.offset = offsetof(struct ipv4_7tuple, ip_dst),
+		},
+		{
+			.type = RTE_ACL_FIELD_TYPE_RANGE,
+			.size = sizeof(uint16_t),
+			.field_index = RTE_ACL_IPV4VLAN_SRCP_FIELD,
+			.input_index = RTE_ACL_IPV4VLAN_PORTS,
+			.offset = offsetof(struct ipv4_7tuple, port_src),
+		},
+		{
+			.type = RTE_ACL_FIELD_TYPE_RANGE,
+			.size = sizeof(uint16_t),
+			.field_index = RTE_ACL_IPV4VLAN_DSTP_FIELD,
+			.input_index = RTE_ACL_IPV4VLAN_PORTS,
+			.offset = offsetof(struct ipv4_7tuple, port_dst),
+		},
+	};
+
+	memset(cfg, 0, sizeof(*cfg));
+	cfg->num_categories = RTE_ACL_MAX_CATEGORIES;
+	cfg->num_fields = RTE_DIM(defs);
+	memcpy(cfg->defs, defs, sizeof(defs));
+}
+
+#define	TEST_BUILD_MAX_SIZE	(32 * 1024 * 1024)
+
+/*
+ * Test multi-threaded build and build within a memory budget:
+ * classify results have to be the same as for the default build.
+ */
+static int
+test_build_param(void)
+{
+	struct rte_acl_ctx *acx;
+	struct rte_acl_config cfg;
+	size_t max_size;
+	int ret;
+
+	acx = rte_acl_create(&acl_param);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return -1;
+	}
+
+	ret = rte_acl_ipv4vlan_add_rules(acx, acl_test_rules,
+			RTE_DIM(acl_test_rules));
+	if (ret != 0) {
+		printf("Line %i: Adding rules to ACL context failed!\n",
+			__LINE__);
+		goto err;
+	}
+
+	test_build_config(&cfg);
+
+	/* build with several threads */
+	cfg.num_threads = 4;
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != 0) {
+		printf("Line %i: multi-threaded build failed: %d\n",
+			__LINE__, ret);
+		goto err;
+	}
+
+	ret = test_classify_run(acx);
+	if (ret != 0) {
+		printf("Line %i: classify after multi-threaded build "
+			"failed!\n", __LINE__);
+		goto err;
+	}
+
+	/* budget that can't be met */
+	cfg.max_size = 1;
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != -ERANGE) {
+		printf("Line %i: build within %zu bytes returned %d, "
+			"expected %d\n", __LINE__, cfg.max_size, ret, -ERANGE);
+		ret = -1;
+		goto err;
+	}
+
+	/* find the tightest budget (power of 2) the build still fits in */
+	for (max_size = TEST_BUILD_MAX_SIZE; max_size != 0; max_size /= 2) {
+		cfg.max_size = max_size;
+		if (rte_acl_build(acx, &cfg) != 0)
+			break;
+	}
+
+	cfg.max_size = max_size * 2;
+	ret = rte_acl_build(acx, &cfg);
+	if (ret != 0) {
+		printf("Line %i: build within %zu bytes failed: %d\n",
+			__LINE__, cfg.max_size, ret);
+		goto err;
+	}
+
+	ret = test_classify_run(acx);
+	if (ret != 0) {
+		printf("Line %i: classify after build within %zu bytes "
+			"failed!\n", __LINE__, cfg.max_size);
+		goto err;
+	}
+
+err:
+	rte_acl_free(acx);
+	return ret;
+}
+
 /*
  * Test wrong layout behavior
  * This test supplies the ACL context with invalid layout, which results in
@@ -926,6 +1136,8 @@ test_acl(void)
 		return -1;
 	if (test_classify() < 0)
 		return -1;
+	if (test_build_param() < 0)
+		return -1;
 
 	return 0;
 }
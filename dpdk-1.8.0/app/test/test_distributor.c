@@ -445,6 +445,231 @@ test_flush_with_worker_shutdown(struct rte_distributor *d,
 	return 0;
 }
 
+#define BURST_FLOWS 16
+
+/* per flow state checked by the burst workers: the worker processing the
+ * flow, plus one, and the sequence number of its last packet */
+static volatile unsigned flow_worker[BURST_FLOWS];
+static uint32_t flow_seq[BURST_FLOWS];
+static volatile unsigned burst_errors;
+static rte_atomic32_t burst_workers_done;
+
+/* burst worker function, checking that no flow is processed by two workers
+ * at the same time and that the packets of a flow are seen in order. The
+ * sequence number of a packet is stored in its data.
+ */
+static int
+handle_work_burst(void *arg)
+{
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+	struct rte_distributor *d = arg;
+	unsigned id = __sync_fetch_and_add(&worker_idx, 1);
+	int i, n;
+
+	n = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	for (;;) {
+		for (i = 0; i < n && !quit; i++) {
+			unsigned flow = pkts[i]->hash.usr % BURST_FLOWS;
+			uint32_t seq = *rte_pktmbuf_mtod(pkts[i], uint32_t *);
+
+			if (flow_worker[flow] != 0 &&
+					flow_worker[flow] != id + 1)
+				burst_errors++;
+			flow_worker[flow] = id + 1;
+			if (seq != flow_seq[flow] + 1)
+				burst_errors++;
+			flow_seq[flow] = seq;
+		}
+		worker_stats[id].handled_packets += n;
+		if (quit)
+			break;
+
+		/* the flows are released before the packets are returned */
+		for (i = 0; i < n; i++)
+			flow_worker[pkts[i]->hash.usr % BURST_FLOWS] = 0;
+		n = rte_distributor_get_pkt_burst(d, id, pkts, pkts, n);
+	}
+	rte_atomic32_inc(&burst_workers_done);
+	rte_distributor_return_pkt_burst(d, id, pkts, n);
+	return 0;
+}
+
+/* Perform a sanity test of the burst workers: send BIG_BATCH packets from a
+ * few flows, check that they are all returned and that the flow affinity
+ * and the order of the packets within a flow are kept.
+ */
+static int
+sanity_test_burst(struct rte_distributor *d, struct rte_mempool *p)
+{
+	struct rte_mbuf *many_bufs[BIG_BATCH], *return_bufs[BIG_BATCH];
+	unsigned i, num_returned = 0;
+
+	printf("=== Sanity test with burst workers ===\n");
+	clear_packet_count();
+	for (i = 0; i < BURST_FLOWS; i++) {
+		flow_worker[i] = 0;
+		flow_seq[i] = 0;
+	}
+	burst_errors = 0;
+
+	rte_distributor_flush(d);
+	rte_distributor_clear_returns(d);
+	if (rte_mempool_get_bulk(p, (void *)many_bufs, BIG_BATCH) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+	for (i = 0; i < BIG_BATCH; i++) {
+		many_bufs[i]->hash.usr = i % BURST_FLOWS;
+		*rte_pktmbuf_mtod(many_bufs[i], uint32_t *) =
+				i / BURST_FLOWS + 1;
+	}
+
+	for (i = 0; i < BIG_BATCH/BURST; i++) {
+		rte_distributor_process(d, &many_bufs[i*BURST], BURST);
+		num_returned += rte_distributor_returned_pkts(d,
+				&return_bufs[num_returned],
+				BIG_BATCH - num_returned);
+	}
+	rte_distributor_flush(d);
+	num_returned += rte_distributor_returned_pkts(d,
+			&return_bufs[num_returned], BIG_BATCH - num_returned);
+
+	for (i = 0; i < rte_lcore_count() - 1; i++)
+		printf("Worker %u handled %u packets\n", i,
+				worker_stats[i].handled_packets);
+
+	if (total_packet_count() != BIG_BATCH ||
+			num_returned != BIG_BATCH) {
+		printf("line %d: Error, %u packets handled and %u returned, "
+				"expected %u\n", __LINE__,
+				total_packet_count(), num_returned, BIG_BATCH);
+		return -1;
+	}
+	if (burst_errors != 0) {
+		printf("line %d: Error, %u packets out of flow order or "
+				"affinity\n", __LINE__, burst_errors);
+		return -1;
+	}
+	/* make sure all packets made it back */
+	for (i = 0; i < BIG_BATCH; i++) {
+		unsigned j;
+
+		for (j = 0; j < BIG_BATCH; j++)
+			if (return_bufs[j] == many_bufs[i])
+				break;
+		if (j == BIG_BATCH) {
+			printf("Error: could not find source packet #%u\n", i);
+			return -1;
+		}
+	}
+	rte_mempool_put_bulk(p, (void *)many_bufs, BIG_BATCH);
+
+	printf("Sanity test with burst workers passed\n\n");
+	return 0;
+}
+
+/* ensures that all the burst workers terminate: a burst worker may get the
+ * packets of several others, so they are sent until all workers quit. After
+ * the flush, the workers which got packets have quit and counted themselves,
+ * the others wait for more packets. */
+static void
+quit_burst_workers(struct rte_distributor *d, struct rte_mempool *p)
+{
+	const unsigned num_workers = rte_lcore_count() - 1;
+	unsigned i;
+	struct rte_mbuf *bufs[RTE_MAX_LCORE];
+	rte_mempool_get_bulk(p, (void *)bufs, num_workers);
+
+	quit = 1;
+	for (i = 0; i < num_workers; i++)
+		bufs[i]->hash.usr = i << 1;
+	while ((unsigned)rte_atomic32_read(&burst_workers_done) !=
+			num_workers) {
+		rte_distributor_process(d, bufs, num_workers);
+		rte_distributor_flush(d);
+	}
+	rte_distributor_clear_returns(d);
+
+	rte_mempool_put_bulk(p, (void *)bufs, num_workers);
+
+	rte_eal_mp_wait_lcore();
+	rte_atomic32_set(&burst_workers_done, 0);
+	quit = 0;
+	worker_idx = 0;
+}
+
+/* Sanity test using the maximum number of workers, which are all driven
+ * from this lcore through the non-blocking worker API.
+ * - each worker is given one packet of a distinct flow
+ * - a second packet of each flow is then sent, in the reverse order
+ * - each worker must get the second packet of its own flow
+ */
+static int
+sanity_test_many_workers(struct rte_mempool *p)
+{
+	static struct rte_distributor *d;
+	const unsigned num_workers = RTE_DISTRIB_MAX_WORKERS;
+	struct rte_mbuf *bufs[RTE_DISTRIB_MAX_WORKERS * 2];
+	struct rte_mbuf *pkt;
+	unsigned i;
+
+	printf("=== Sanity test with %u workers ===\n", num_workers);
+	if (d == NULL) {
+		d = rte_distributor_create("Test_dist_many", rte_socket_id(),
+				num_workers);
+		if (d == NULL) {
+			printf("Error creating distributor\n");
+			return -1;
+		}
+	}
+
+	if (rte_mempool_get_bulk(p, (void *)bufs, num_workers * 2) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+	for (i = 0; i < num_workers; i++) {
+		bufs[i]->hash.usr = i;
+		bufs[num_workers + i]->hash.usr = num_workers - 1 - i;
+	}
+
+	for (i = 0; i < num_workers; i++)
+		rte_distributor_request_pkt(d, i, NULL);
+	rte_distributor_process(d, bufs, num_workers);
+	/* all the flows are in flight, so these only go to the backlogs */
+	rte_distributor_process(d, &bufs[num_workers], num_workers);
+
+	for (i = 0; i < num_workers; i++) {
+		pkt = rte_distributor_poll_pkt(d, i);
+		if (pkt != bufs[i]) {
+			printf("line %d: Worker %u got wrong first packet\n",
+					__LINE__, i);
+			goto err;
+		}
+		rte_distributor_request_pkt(d, i, pkt);
+	}
+	rte_distributor_process(d, NULL, 0);
+
+	for (i = 0; i < num_workers; i++) {
+		pkt = rte_distributor_poll_pkt(d, i);
+		if (pkt == NULL || pkt->hash.usr != i) {
+			printf("line %d: Worker %u got packet of another flow\n",
+					__LINE__, i);
+			goto err;
+		}
+		rte_distributor_return_pkt(d, i, pkt);
+	}
+	rte_distributor_flush(d);
+	rte_distributor_clear_returns(d);
+
+	rte_mempool_put_bulk(p, (void *)bufs, num_workers * 2);
+	printf("Sanity test with %u workers passed\n\n", num_workers);
+	return 0;
+
+err:
+	rte_mempool_put_bulk(p, (void *)bufs, num_workers * 2);
+	return -1;
+}
+
 static
 int test_error_distributor_create_name(void)
 {
@@ -467,7 +692,7 @@ int test_error_distributor_create_numworkers(void)
 {
 	struct rte_distributor *d = NULL;
 	d = rte_distributor_create("test_numworkers", rte_socket_id(),
-			RTE_MAX_LCORE + 10);
+			RTE_DISTRIB_MAX_WORKERS + 1);
 	if (d != NULL || rte_errno != EINVAL) {
 		printf("ERROR: No error on create() with num_workers > MAX\n");
 		return -1;
@@ -567,6 +792,16 @@ test_distributor(void)
 		printf("Not enough cores to run tests for worker shutdown\n");
 	}
 
+	rte_eal_mp_remote_launch(handle_work_burst, d, SKIP_MASTER);
+	if (sanity_test_burst(d, p) < 0) {
+		quit_burst_workers(d, p);
+		return -1;
+	}
+	quit_burst_workers(d, p);
+
+	if (sanity_test_many_workers(p) < 0)
+		return -1;
+
 	if (test_error_distributor_create_numworkers() == -1 ||
 			test_error_distributor_create_name() == -1) {
 		printf("rte_distributor_create parameter check tests failed");
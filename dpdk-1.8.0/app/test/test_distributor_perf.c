@@ -45,6 +45,7 @@
 /* static vars - zero initialized by default */
 static volatile int quit;
 static volatile unsigned worker_idx;
+static rte_atomic32_t workers_done;
 
 struct worker_stats {
 	volatile unsigned handled_packets;
@@ -137,10 +138,32 @@ handle_work(void *arg)
 		pkt = rte_distributor_get_pkt(d, id, pkt);
 	}
 	worker_stats[id].handled_packets++, count++;
+	rte_atomic32_inc(&workers_done);
 	rte_distributor_return_pkt(d, id, pkt);
 	return 0;
 }
 
+/* the same worker function, exchanging bursts of packets with the
+ * distributor */
+static int
+handle_work_burst(void *arg)
+{
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+	struct rte_distributor *d = arg;
+	unsigned id = __sync_fetch_and_add(&worker_idx, 1);
+	int n;
+
+	n = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	while (!quit) {
+		worker_stats[id].handled_packets += n;
+		n = rte_distributor_get_pkt_burst(d, id, pkts, pkts, n);
+	}
+	worker_stats[id].handled_packets += n;
+	rte_atomic32_inc(&workers_done);
+	rte_distributor_return_pkt_burst(d, id, pkts, n);
+	return 0;
+}
+
 /* this basic performance test just repeatedly sends in 32 packets at a time
  * to the distributor and verifies at the end that we got them all in the worker
  * threads and finally how long per packet the processing took.
@@ -173,8 +196,11 @@ perf_test(struct rte_distributor *d, struct rte_mempool *p)
 
 	printf("=== Performance test of distributor ===\n");
 	printf("Time per burst:  %"PRIu64"\n", (end - start) >> ITER_POWER);
-	printf("Time per packet: %"PRIu64"\n\n",
+	printf("Time per packet: %"PRIu64"\n",
 			((end - start) >> ITER_POWER)/BURST);
+	printf("Packets per second on the distributor core: %.2f Mpps\n\n",
+			(double)rte_get_tsc_hz() * (BURST << ITER_POWER) /
+			(end - start) / 1000000);
 	rte_mempool_put_bulk(p, (void *)bufs, BURST);
 
 	for (i = 0; i < rte_lcore_count() - 1; i++)
@@ -187,7 +213,10 @@ perf_test(struct rte_distributor *d, struct rte_mempool *p)
 	return 0;
 }
 
-/* Useful function which ensures that all worker functions terminate */
+/* Useful function which ensures that all worker functions terminate. A
+ * burst worker may get the packets of several others, so they are sent
+ * until all workers quit: after the flush, the workers which got packets
+ * have quit and counted themselves, the others wait for more packets. */
 static void
 quit_workers(struct rte_distributor *d, struct rte_mempool *p)
 {
@@ -199,7 +228,10 @@ quit_workers(struct rte_distributor *d, struct rte_mempool *p)
 	quit = 1;
 	for (i = 0; i < num_workers; i++)
 		bufs[i]->hash.usr = i << 1;
-	rte_distributor_process(d, bufs, num_workers);
+	while ((unsigned)rte_atomic32_read(&workers_done) != num_workers) {
+		rte_distributor_process(d, bufs, num_workers);
+		rte_distributor_flush(d);
+	}
 
 	rte_mempool_put_bulk(p, (void *)bufs, num_workers);
 
@@ -207,6 +239,7 @@ quit_workers(struct rte_distributor *d, struct rte_mempool *p)
 	rte_eal_mp_wait_lcore();
 	quit = 0;
 	worker_idx = 0;
+	rte_atomic32_set(&workers_done, 0);
 }
 
 #define MBUF_SIZE (2048 + sizeof(struct rte_mbuf) + RTE_PKTMBUF_HEADROOM)
@@ -257,6 +290,12 @@ test_distributor_perf(void)
 		return -1;
 	quit_workers(d, p);
 
+	printf("=== Burst workers ===\n");
+	rte_eal_mp_remote_launch(handle_work_burst, d, SKIP_MASTER);
+	if (perf_test(d, p) < 0)
+		return -1;
+	quit_workers(d, p);
+
 	return 0;
 }
 
@@ -33,6 +33,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -611,6 +612,331 @@ static int test_full_bucket(void)
 }
 
 /******************************************************************************/
+/*
+ * Cuckoo hash table tests:
+ *	- add keys with the same signature: the first 8 are stored in their
+ *	  primary and secondary buckets, the 9th is rejected
+ *	- lookup and delete them, and check a deleted slot can be reused
+ *	- fill a table with random keys until an add fails, checking that
+ *	  more than 90% of the entries were used, keys being moved to their
+ *	  other bucket to make room
+ *	- lookup all the keys added, delete half of them, and lookup again
+ */
+#define CUCKOO_TEST_ENTRIES	1024
+#define CUCKOO_TEST_MIN_LOAD	90	/* percent */
+
+static int test_cuckoo_hash(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_cuckoo",
+		.entries = 64,
+		.key_len = sizeof(struct flow_key), /* 13 */
+		.hash_func = pseudo_hash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.flags = RTE_HASH_F_CUCKOO,
+	};
+	struct rte_hash *handle;
+	struct flow_key same_sig_keys[2 * RTE_HASH_CUCKOO_BUCKET_ENTRIES + 1];
+	static uint32_t rand_keys[CUCKOO_TEST_ENTRIES];
+	static int32_t rand_pos[CUCKOO_TEST_ENTRIES];
+	int32_t pos, expected_pos[RTE_DIM(same_sig_keys)];
+	unsigned i, n, added;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "cuckoo hash creation failed");
+
+	memset(same_sig_keys, 0, sizeof(same_sig_keys));
+	n = RTE_DIM(same_sig_keys) - 1;
+	for (i = 0; i <= n; i++)
+		same_sig_keys[i].ip_src = i;
+
+	/* Fill both buckets of the signature */
+	for (i = 0; i < n; i++) {
+		expected_pos[i] = rte_hash_add_key(handle, &same_sig_keys[i]);
+		print_key_info("Add", &same_sig_keys[i], expected_pos[i]);
+		RETURN_IF_ERROR(expected_pos[i] < 0,
+			"failed to add key (pos[%u]=%d)", i, expected_pos[i]);
+	}
+	pos = rte_hash_add_key(handle, &same_sig_keys[n]);
+	RETURN_IF_ERROR(pos != -ENOSPC,
+			"fail: added key to full buckets (pos=%d)", pos);
+
+	for (i = 0; i < n; i++) {
+		pos = rte_hash_lookup(handle, &same_sig_keys[i]);
+		RETURN_IF_ERROR(pos != expected_pos[i],
+			"failed to find key (pos[%u]=%d)", i, pos);
+	}
+	pos = rte_hash_lookup(handle, &same_sig_keys[n]);
+	RETURN_IF_ERROR(pos != -ENOENT,
+			"fail: found non-existent key (pos=%d)", pos);
+
+	/* Delete one key and add the last one in its place */
+	pos = rte_hash_del_key(handle, &same_sig_keys[0]);
+	RETURN_IF_ERROR(pos != expected_pos[0],
+			"failed to delete key (pos=%d)", pos);
+	pos = rte_hash_lookup(handle, &same_sig_keys[0]);
+	RETURN_IF_ERROR(pos != -ENOENT,
+			"fail: found deleted key (pos=%d)", pos);
+	pos = rte_hash_add_key(handle, &same_sig_keys[n]);
+	RETURN_IF_ERROR(pos < 0, "failed to add key (pos=%d)", pos);
+	RETURN_IF_ERROR(rte_hash_lookup(handle, &same_sig_keys[n]) != pos,
+			"failed to find key added after delete");
+	pos = rte_hash_free_key_with_position(handle, expected_pos[1]);
+	RETURN_IF_ERROR(pos != -EINVAL,
+			"fail: freed a position without NO_FREE_ON_DEL");
+
+	rte_hash_free(handle);
+
+	/* Deleted positions are only reused once freed by the caller */
+	params.name = "test_cuckoo_no_free";
+	params.entries = RTE_HASH_CUCKOO_BUCKET_ENTRIES;
+	params.flags = RTE_HASH_F_CUCKOO | RTE_HASH_F_NO_FREE_ON_DEL;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "cuckoo hash creation failed");
+
+	for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+		expected_pos[i] = rte_hash_add_key(handle, &same_sig_keys[i]);
+		RETURN_IF_ERROR(expected_pos[i] < 0,
+			"failed to add key (pos[%u]=%d)", i, expected_pos[i]);
+	}
+	pos = rte_hash_del_key(handle, &same_sig_keys[0]);
+	RETURN_IF_ERROR(pos != expected_pos[0],
+			"failed to delete key (pos=%d)", pos);
+	pos = rte_hash_add_key(handle, &same_sig_keys[n]);
+	RETURN_IF_ERROR(pos != -ENOSPC,
+			"fail: reused a position not freed (pos=%d)", pos);
+	pos = rte_hash_free_key_with_position(handle, expected_pos[0]);
+	RETURN_IF_ERROR(pos != 0, "failed to free position (ret=%d)", pos);
+	pos = rte_hash_add_key(handle, &same_sig_keys[n]);
+	RETURN_IF_ERROR(pos != expected_pos[0],
+			"failed to add key in freed position (pos=%d)", pos);
+	pos = rte_hash_free_key_with_position(handle,
+			RTE_HASH_CUCKOO_BUCKET_ENTRIES);
+	RETURN_IF_ERROR(pos != -EINVAL,
+			"fail: freed an invalid position (ret=%d)", pos);
+
+	rte_hash_free(handle);
+
+	/* Fill a table with random keys */
+	params.name = "test_cuckoo_fill";
+	params.entries = CUCKOO_TEST_ENTRIES;
+	params.flags = RTE_HASH_F_CUCKOO;
+	params.key_len = sizeof(uint32_t);
+	params.hash_func = rte_jhash;
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "cuckoo hash creation failed");
+
+	for (added = 0; added < CUCKOO_TEST_ENTRIES; added++) {
+		/* make keys unique, they are random in the high bits */
+		rand_keys[added] = (rte_rand() << 10) | added;
+		rand_pos[added] = rte_hash_add_key(handle, &rand_keys[added]);
+		if (rand_pos[added] < 0)
+			break;
+	}
+	printf("Cuckoo hash: %u of %u entries used before first failure\n",
+			added, CUCKOO_TEST_ENTRIES);
+	RETURN_IF_ERROR(added * 100 < CUCKOO_TEST_ENTRIES * CUCKOO_TEST_MIN_LOAD,
+			"load factor below %u%%", CUCKOO_TEST_MIN_LOAD);
+
+	for (i = 0; i < added; i++) {
+		pos = rte_hash_lookup(handle, &rand_keys[i]);
+		RETURN_IF_ERROR(pos != rand_pos[i],
+			"failed to find key %u (pos=%d, expected %d)",
+			i, pos, rand_pos[i]);
+	}
+
+	/* Delete every other key, the others must still be found */
+	for (i = 0; i < added; i += 2) {
+		pos = rte_hash_del_key(handle, &rand_keys[i]);
+		RETURN_IF_ERROR(pos != rand_pos[i],
+			"failed to delete key %u (pos=%d)", i, pos);
+	}
+	for (i = 0; i < added; i++) {
+		pos = rte_hash_lookup(handle, &rand_keys[i]);
+		RETURN_IF_ERROR(pos != ((i & 1) ? rand_pos[i] : -ENOENT),
+			"wrong lookup result for key %u (pos=%d)", i, pos);
+	}
+
+	rte_hash_free(handle);
+	return 0;
+}
+
+/*
+ * Burst lookup tests, for each kind of hash table:
+ *	- add every other key of a burst of RTE_HASH_LOOKUP_BURST_MAX keys
+ *	- lookup the burst: check the hit mask, the number of hits and the
+ *	  positions against single lookups
+ */
+static int test_lookup_burst(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_burst",
+		.entries = 1024,
+		.bucket_entries = 16,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+	};
+	static const uint32_t flags[] = { 0, RTE_HASH_F_CUCKOO };
+	struct rte_hash *handle = NULL;
+	uint32_t burst_keys[RTE_HASH_LOOKUP_BURST_MAX];
+	const void *key_ptrs[RTE_HASH_LOOKUP_BURST_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BURST_MAX];
+	uint64_t hit_mask, expected_mask = 0;
+	unsigned i, f;
+	int ret;
+
+	for (i = 0; i < RTE_HASH_LOOKUP_BURST_MAX; i++) {
+		burst_keys[i] = i * 0x01010101 + 1;
+		key_ptrs[i] = &burst_keys[i];
+		if ((i & 1) == 0)
+			expected_mask |= (uint64_t)1 << i;
+	}
+
+	for (f = 0; f < RTE_DIM(flags); f++) {
+		params.flags = flags[f];
+		handle = rte_hash_create(&params);
+		RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+		for (i = 0; i < RTE_HASH_LOOKUP_BURST_MAX; i += 2)
+			RETURN_IF_ERROR(rte_hash_add_key(handle,
+					&burst_keys[i]) < 0,
+					"failed to add key %u", i);
+
+		ret = rte_hash_lookup_burst(handle, key_ptrs,
+				RTE_HASH_LOOKUP_BURST_MAX, positions, &hit_mask);
+		RETURN_IF_ERROR(ret != RTE_HASH_LOOKUP_BURST_MAX / 2,
+				"wrong number of hits (%d)", ret);
+		RETURN_IF_ERROR(hit_mask != expected_mask,
+				"wrong hit mask 0x%" PRIx64, hit_mask);
+		for (i = 0; i < RTE_HASH_LOOKUP_BURST_MAX; i++)
+			RETURN_IF_ERROR(positions[i] !=
+					rte_hash_lookup(handle, &burst_keys[i]),
+					"wrong position for key %u (%d)",
+					i, positions[i]);
+
+		rte_hash_free(handle);
+	}
+	return 0;
+}
+
+/*
+ * User data and iterator tests, for each kind of hash table:
+ *	- add keys with their data, and update the data of one key
+ *	- lookup the keys one by one and in a burst, checking their data
+ *	- iterate over the table: each key is returned once, with its data
+ *	- delete every other key while iterating, as aging would, and check
+ *	  the remaining keys are returned by a new iteration
+ */
+#define DATA_TEST_KEYS	48
+
+static int test_hash_data_iterate(void)
+{
+	struct rte_hash_parameters params = {
+		.name = "test_data",
+		.entries = 256,
+		.bucket_entries = 16,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+	};
+	static const uint32_t flags[] = { 0, RTE_HASH_F_CUCKOO };
+	struct rte_hash *handle = NULL;
+	uint32_t data_keys[DATA_TEST_KEYS];
+	const void *key_ptrs[DATA_TEST_KEYS];
+	void *data[DATA_TEST_KEYS];
+	uint8_t seen[DATA_TEST_KEYS];
+	const void *next_key;
+	void *next_data;
+	uint64_t hit_mask;
+	uint32_t iter, k;
+	unsigned i, f, count;
+	int32_t pos;
+
+	for (i = 0; i < DATA_TEST_KEYS; i++) {
+		data_keys[i] = i * 0x00100001 + 7;
+		key_ptrs[i] = &data_keys[i];
+	}
+
+	for (f = 0; f < RTE_DIM(flags); f++) {
+		params.flags = flags[f] | RTE_HASH_F_USER_DATA;
+		handle = rte_hash_create(&params);
+		RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+		/* Data is the key index, plus one for the updated key */
+		for (i = 0; i < DATA_TEST_KEYS; i++)
+			RETURN_IF_ERROR(rte_hash_add_key_data(handle,
+					&data_keys[i],
+					(void *)(uintptr_t)i) < 0,
+					"failed to add key %u", i);
+		pos = rte_hash_add_key_data(handle, &data_keys[0],
+				(void *)(uintptr_t)DATA_TEST_KEYS);
+		RETURN_IF_ERROR(pos < 0, "failed to update key data");
+
+		for (i = 0; i < DATA_TEST_KEYS; i++) {
+			pos = rte_hash_lookup_data(handle, &data_keys[i],
+					&data[i]);
+			RETURN_IF_ERROR(pos < 0, "failed to find key %u", i);
+			RETURN_IF_ERROR((uintptr_t)data[i] !=
+					(i == 0 ? DATA_TEST_KEYS : i),
+					"wrong data for key %u", i);
+		}
+
+		memset(data, 0, sizeof(data));
+		RETURN_IF_ERROR(rte_hash_lookup_bulk_data(handle, key_ptrs,
+				DATA_TEST_KEYS, &hit_mask, data) !=
+				DATA_TEST_KEYS, "burst lookup failed");
+		RETURN_IF_ERROR(hit_mask != (UINT64_C(1) << DATA_TEST_KEYS) - 1,
+				"wrong hit mask 0x%" PRIx64, hit_mask);
+		for (i = 1; i < DATA_TEST_KEYS; i++)
+			RETURN_IF_ERROR((uintptr_t)data[i] != i,
+					"wrong burst data for key %u", i);
+
+		/* Iterate, deleting the even keys */
+		memset(seen, 0, sizeof(seen));
+		count = 0;
+		iter = 0;
+		while ((pos = rte_hash_iterate(handle, &next_key, &next_data,
+					       &iter)) >= 0) {
+			k = *(const uint32_t *)next_key;
+			i = (k - 7) / 0x00100001;
+			RETURN_IF_ERROR(i >= DATA_TEST_KEYS || seen[i],
+					"unexpected key 0x%x", k);
+			RETURN_IF_ERROR((uintptr_t)next_data !=
+					(i == 0 ? DATA_TEST_KEYS : i),
+					"wrong data for key %u", i);
+			RETURN_IF_ERROR(pos != rte_hash_lookup(handle,
+					&data_keys[i]),
+					"wrong position for key %u", i);
+			seen[i] = 1;
+			count++;
+			if ((i & 1) == 0)
+				rte_hash_del_key(handle, &data_keys[i]);
+		}
+		RETURN_IF_ERROR(pos != -ENOENT, "iteration failed (%d)", pos);
+		RETURN_IF_ERROR(count != DATA_TEST_KEYS,
+				"iterated over %u keys", count);
+
+		count = 0;
+		iter = 0;
+		while (rte_hash_iterate(handle, &next_key, &next_data,
+					&iter) >= 0) {
+			k = *(const uint32_t *)next_key;
+			RETURN_IF_ERROR((((k - 7) / 0x00100001) & 1) == 0,
+					"deleted key 0x%x found", k);
+			count++;
+		}
+		RETURN_IF_ERROR(count != DATA_TEST_KEYS / 2,
+				"iterated over %u keys after delete", count);
+
+		rte_hash_free(handle);
+	}
+	return 0;
+}
+
 static int
 fbk_hash_unit_test(void)
 {
@@ -1037,6 +1363,27 @@ static int test_hash_creation_with_bad_parameters(void)
 		return -1;
 	}
 
+	memcpy(&params, &ut_params, sizeof(params));
+	params.name = "creation_with_bad_parameters_8";
+	params.entries = RTE_HASH_CUCKOO_BUCKET_ENTRIES / 2;
+	params.flags = RTE_HASH_F_CUCKOO;
+	handle = rte_hash_create(&params);
+	if (handle != NULL) {
+		rte_hash_free(handle);
+		printf("Impossible creating cuckoo hash sucessfully if entries is less than a bucket\n");
+		return -1;
+	}
+
+	memcpy(&params, &ut_params, sizeof(params));
+	params.name = "creation_with_bad_parameters_9";
+	params.flags = RTE_HASH_F_NO_FREE_ON_DEL;
+	handle = rte_hash_create(&params);
+	if (handle != NULL) {
+		rte_hash_free(handle);
+		printf("Impossible creating hash sucessfully with NO_FREE_ON_DEL but without cuckoo\n");
+		return -1;
+	}
+
 	rte_hash_free(handle);
 
 	return 0;
@@ -1351,6 +1698,12 @@ test_hash(void)
 		return -1;
 	if (test_full_bucket() < 0)
 		return -1;
+	if (test_cuckoo_hash() < 0)
+		return -1;
+	if (test_lookup_burst() < 0)
+		return -1;
+	if (test_hash_data_iterate() < 0)
+		return -1;
 
 	if (test_fbk_hash_find_existing() < 0)
 		return -1;
@@ -761,6 +761,119 @@ fbk_hash_perf_test(void)
 	return 0;
 }
 
+/* Control operation of the load factor test of both hash implementations. */
+#define LF_ENTRIES (1 << 16)	/* How many entries. */
+#define LF_KEY_LEN 16		/* Size of the keys. */
+#define LF_LOOKUPS (1 << 22)	/* How many lookups to time. */
+#define LF_STRIDE 7919		/* Distance between keys looked up. */
+
+/*
+ * Fill a table with random keys until the first add fails, and measure the
+ * rate of lookups of the keys added, one at a time, in bulks of
+ * RTE_HASH_LOOKUP_BULK_MAX and in bursts of RTE_HASH_LOOKUP_BURST_MAX.
+ */
+static int
+load_factor_perf_test_one(uint32_t flags, uint32_t bucket_entries,
+		uint8_t (*keys)[LF_KEY_LEN], const void **burst)
+{
+	struct rte_hash_parameters hash_params = {
+		.name = "load_factor_test",
+		.entries = LF_ENTRIES,
+		.bucket_entries = bucket_entries,
+		.key_len = LF_KEY_LEN,
+		.hash_func = NULL,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id(),
+		.flags = flags,
+	};
+	struct rte_hash *handle;
+	int32_t positions[RTE_HASH_LOOKUP_BURST_MAX];
+	uint64_t begin, single_ticks, bulk_ticks, burst_ticks, hit_mask;
+	uint32_t added, i, j, idx;
+	int32_t pos;
+
+	handle = rte_hash_create(&hash_params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (added = 0; added < LF_ENTRIES; added++) {
+		for (j = 0; j < LF_KEY_LEN; j++)
+			keys[added][j] = (uint8_t) rte_rand();
+		if (rte_hash_add_key(handle, keys[added]) < 0)
+			break;
+	}
+	RETURN_IF_ERROR(added == 0, "no key could be added");
+
+	/* Lookup keys spread over the table */
+	begin = rte_rdtsc();
+	for (i = 0, idx = 0; i < LF_LOOKUPS; i++) {
+		pos = rte_hash_lookup(handle, keys[idx]);
+		RETURN_IF_ERROR(pos < 0, "failed to find key %u", idx);
+		idx = (idx + LF_STRIDE) % added;
+	}
+	single_ticks = rte_rdtsc() - begin;
+
+	begin = rte_rdtsc();
+	for (i = 0, idx = 0; i < LF_LOOKUPS; i += RTE_HASH_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			burst[j] = keys[idx];
+			idx = (idx + LF_STRIDE) % added;
+		}
+		rte_hash_lookup_bulk(handle, burst, RTE_HASH_LOOKUP_BULK_MAX,
+				positions);
+	}
+	bulk_ticks = rte_rdtsc() - begin;
+
+	begin = rte_rdtsc();
+	for (i = 0, idx = 0; i < LF_LOOKUPS; i += RTE_HASH_LOOKUP_BURST_MAX) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BURST_MAX; j++) {
+			burst[j] = keys[idx];
+			idx = (idx + LF_STRIDE) % added;
+		}
+		rte_hash_lookup_burst(handle, burst, RTE_HASH_LOOKUP_BURST_MAX,
+				positions, &hit_mask);
+	}
+	burst_ticks = rte_rdtsc() - begin;
+
+	printf("%-8s, %-18u, %-7u, %-26.1f, %-14.2f, %-19.2f, %.2f\n",
+		(flags & RTE_HASH_F_CUCKOO) ? "cuckoo" : "default",
+		(unsigned) handle->bucket_entries, (unsigned) LF_ENTRIES,
+		(double) added * 100 / LF_ENTRIES,
+		(double) LF_LOOKUPS * rte_get_tsc_hz() / single_ticks / 1e6,
+		(double) LF_LOOKUPS * rte_get_tsc_hz() / bulk_ticks / 1e6,
+		(double) LF_LOOKUPS * rte_get_tsc_hz() / burst_ticks / 1e6);
+
+	rte_hash_free(handle);
+	return 0;
+}
+
+static int
+load_factor_perf_test(void)
+{
+	uint8_t (*keys)[LF_KEY_LEN];
+	const void *burst[RTE_HASH_LOOKUP_BURST_MAX];
+	int ret = 0;
+
+	keys = rte_zmalloc(NULL, LF_ENTRIES * LF_KEY_LEN, 0);
+	if (keys == NULL) {
+		printf("load factor test: memory allocation for keys failed\n");
+		return -1;
+	}
+
+	printf("\n\n *** Hash table load factor test results ***\n");
+	printf("Table   , Entries per bucket, Entries, "
+	       "Load at first failure (%%), Lookup (Mpps), Bulk lookup (Mpps), "
+	       "Burst lookup (Mpps)\n");
+
+	if (load_factor_perf_test_one(0, 4, keys, burst) < 0 ||
+			load_factor_perf_test_one(0, 16, keys, burst) < 0 ||
+			load_factor_perf_test_one(RTE_HASH_F_CUCKOO, 0,
+				keys, burst) < 0)
+		ret = -1;
+
+	rte_free(keys);
+	return ret;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -773,6 +886,8 @@ test_hash_perf(void)
 
 	if (fbk_hash_perf_test() < 0)
 		return -1;
+	if (load_factor_perf_test() < 0)
+		return -1;
 	return 0;
 }
 
@@ -43,6 +43,8 @@
 #include <rte_random.h>
 #include <rte_branch_prediction.h>
 #include <rte_ip.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
 #include <time.h>
 
 #include "test.h"
@@ -77,6 +79,9 @@ static int32_t test14(void);
 static int32_t test15(void);
 static int32_t test16(void);
 static int32_t test17(void);
+static int32_t test18(void);
+static int32_t test19(void);
+static int32_t test20(void);
 static int32_t perf_test(void);
 
 rte_lpm_test tests[] = {
@@ -99,6 +104,9 @@ rte_lpm_test tests[] = {
 	test15,
 	test16,
 	test17,
+	test18,
+	test19,
+	test20,
 	perf_test,
 };
 
@@ -115,6 +123,7 @@ int32_t
 test0(void)
 {
 	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
 
 	/* rte_lpm_create: lpm name == NULL */
 	lpm = rte_lpm_create(NULL, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -129,6 +138,22 @@ test0(void)
 	lpm = rte_lpm_create(__func__, -2, MAX_RULES, 0);
 	TEST_LPM_ASSERT(lpm == NULL);
 
+	/* rte_lpm_create_config: config == NULL */
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, NULL);
+	TEST_LPM_ASSERT(lpm == NULL);
+
+	/* rte_lpm_create_config: number_tbl8s = 0 */
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 0;
+	config.flags = 0;
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+
+	/* rte_lpm_create_config: too many tbl8 groups */
+	config.number_tbl8s = RTE_LPM_MAX_TBL8_NUM_GROUPS + 1;
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+
 	return PASS;
 }
 
@@ -181,7 +206,8 @@ test3(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 24, next_hop = 100;
+	uint8_t depth = 24;
+	uint32_t next_hop = 100;
 	int32_t status = 0;
 
 	/* rte_lpm_add: lpm == NULL */
@@ -248,7 +274,7 @@ test5(void)
 #if defined(RTE_LIBRTE_LPM_DEBUG)
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
 	/* rte_lpm_lookup: lpm == NULL */
@@ -278,7 +304,8 @@ test6(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 24, next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 24;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -309,10 +336,11 @@ int32_t
 test7(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 32, next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 32;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -355,10 +383,11 @@ int32_t
 test8(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip1 = IPv4(127, 255, 255, 255), ip2 = IPv4(128, 0, 0, 0);
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -390,7 +419,7 @@ test8(void)
 
 	/* Loop with rte_lpm_delete. */
 	for (depth = 32; depth >= 1; depth--) {
-		next_hop_add = (uint8_t) (depth - 1);
+		next_hop_add = (uint32_t) (depth - 1);
 
 		status = rte_lpm_delete(lpm, ip2, depth);
 		TEST_LPM_ASSERT(status == 0);
@@ -438,7 +467,8 @@ test9(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip, ip_1, ip_2;
-	uint8_t depth, depth_1, depth_2, next_hop_add, next_hop_add_1,
+	uint8_t depth, depth_1, depth_2;
+	uint32_t next_hop_add, next_hop_add_1,
 		next_hop_add_2, next_hop_return;
 	int32_t status = 0;
 
@@ -602,7 +632,8 @@ test10(void)
 
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return;
 	int32_t status = 0;
 
 	/* Add rule that covers a TBL24 range previously invalid & lookup
@@ -788,7 +819,8 @@ test11(void)
 
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -851,10 +883,11 @@ int32_t
 test12(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip, i;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -904,7 +937,8 @@ test13(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip, i;
-	uint8_t depth, next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add_1, next_hop_add_2, next_hop_return;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -966,7 +1000,8 @@ test14(void)
 
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint8_t depth;
+	uint32_t next_hop_add, next_hop_return;
 	int32_t status = 0;
 
 	/* Add enough space for 256 rules for every depth */
@@ -1078,10 +1113,10 @@ test17(void)
 	const uint8_t d_ip_10_32 = 32,
 			d_ip_10_24 = 24,
 			d_ip_20_25 = 25;
-	const uint8_t next_hop_ip_10_32 = 100,
+	const uint32_t next_hop_ip_10_32 = 100,
 			next_hop_ip_10_24 = 105,
 			next_hop_ip_20_25 = 111;
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
 	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
@@ -1092,7 +1127,7 @@ test17(void)
 		return -1;
 
 	status = rte_lpm_lookup(lpm, ip_10_32, &next_hop_return);
-	uint8_t test_hop_10_32 = next_hop_return;
+	uint32_t test_hop_10_32 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_32);
 
@@ -1101,7 +1136,7 @@ test17(void)
 			return -1;
 
 	status = rte_lpm_lookup(lpm, ip_10_24, &next_hop_return);
-	uint8_t test_hop_10_24 = next_hop_return;
+	uint32_t test_hop_10_24 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_24);
 
@@ -1110,7 +1145,7 @@ test17(void)
 		return -1;
 
 	status = rte_lpm_lookup(lpm, ip_20_25, &next_hop_return);
-	uint8_t test_hop_20_25 = next_hop_return;
+	uint32_t test_hop_20_25 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_20_25);
 
@@ -1137,6 +1172,103 @@ test17(void)
 	return PASS;
 }
 
+/*
+ * Configurable tbl8 groups and 24-bit next hops:
+ *  - fill a table created with a non-default number of tbl8 groups and
+ *    check the next addition fails with -ENOSPC
+ *  - check next hops wider than 8 bits are returned by all lookup paths
+ *  - delete the rules and check every tbl8 group goes back to the pool
+ *  - check a tbl8 group covered by a /24 rule is recycled on delete
+ */
+int32_t
+test18(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	uint32_t ip, next_hop_return, hop[4];
+	uint32_t ip_batch[4];
+	__m128i ipx4;
+	int32_t status;
+	unsigned i;
+
+	config.max_rules = 2 * 1024;
+	config.number_tbl8s = 1024;
+	config.flags = 0;
+
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+	TEST_LPM_ASSERT(lpm->tbl8_free_count == config.number_tbl8s);
+
+	/* Next hops are 24 bits wide. */
+	status = rte_lpm_add(lpm, IPv4(10, 0, 0, 0), 8,
+			RTE_LPM_MAX_NEXT_HOP + 1);
+	TEST_LPM_ASSERT(status == -EINVAL);
+
+	/* Each /32 rule lives in a different tbl8 group. */
+	for (i = 0; i < config.number_tbl8s; i++) {
+		ip = IPv4(10, 0, 0, 1) + (i << 8);
+		status = rte_lpm_add(lpm, ip, 32, RTE_LPM_MAX_NEXT_HOP - i);
+		TEST_LPM_ASSERT(status == 0);
+	}
+	TEST_LPM_ASSERT(lpm->tbl8_free_count == 0);
+
+	ip = IPv4(10, 0, 0, 1) + (config.number_tbl8s << 8);
+	status = rte_lpm_add(lpm, ip, 32, 1);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+	TEST_LPM_ASSERT(rte_lpm_is_rule_present(lpm, ip, 32,
+			&next_hop_return) == 0);
+
+	for (i = 0; i < config.number_tbl8s; i += RTE_DIM(ip_batch)) {
+		unsigned j;
+
+		for (j = 0; j < RTE_DIM(ip_batch); j++) {
+			ip_batch[j] = IPv4(10, 0, 0, 1) + ((i + j) << 8);
+			status = rte_lpm_lookup(lpm, ip_batch[j],
+					&next_hop_return);
+			TEST_LPM_ASSERT(status == 0);
+			TEST_LPM_ASSERT(next_hop_return ==
+					RTE_LPM_MAX_NEXT_HOP - (i + j));
+		}
+
+		ipx4 = _mm_loadu_si128((__m128i *)ip_batch);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		for (j = 0; j < RTE_DIM(ip_batch); j++)
+			TEST_LPM_ASSERT(hop[j] == RTE_LPM_MAX_NEXT_HOP - (i + j));
+	}
+
+	for (i = 0; i < config.number_tbl8s; i++) {
+		ip = IPv4(10, 0, 0, 1) + (i << 8);
+		status = rte_lpm_delete(lpm, ip, 32);
+		TEST_LPM_ASSERT(status == 0);
+	}
+	TEST_LPM_ASSERT(lpm->tbl8_free_count == config.number_tbl8s);
+
+	status = rte_lpm_lookup(lpm, IPv4(10, 0, 0, 1), &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	/*
+	 * A tbl8 group whose entries all inherit from the same /24 rule
+	 * is folded back into tbl24 when the /32 is deleted.
+	 */
+	status = rte_lpm_add(lpm, IPv4(10, 0, 0, 0), 24, 0x123456);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_add(lpm, IPv4(10, 0, 0, 1), 32, 0x654321);
+	TEST_LPM_ASSERT(status == 0);
+	TEST_LPM_ASSERT(lpm->tbl8_free_count == config.number_tbl8s - 1);
+
+	status = rte_lpm_delete(lpm, IPv4(10, 0, 0, 1), 32);
+	TEST_LPM_ASSERT(status == 0);
+	TEST_LPM_ASSERT(lpm->tbl8_free_count == config.number_tbl8s);
+	TEST_LPM_ASSERT(lpm->tbl24[IPv4(10, 0, 0, 0) >> 8].ext_entry == 0);
+
+	status = rte_lpm_lookup(lpm, IPv4(10, 0, 0, 1), &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 0x123456));
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
 /*
  * Lookup performance test
  */
@@ -1169,13 +1301,257 @@ print_route_distribution(const struct route_rule *table, uint32_t n)
 	printf("\n");
 }
 
+/*
+ * Synthetic full routing table test: add 700k routes whose prefix length
+ * distribution follows a public BGP table (about 55% /24), check every
+ * route can be found and that all tbl8 groups are recycled on delete.
+ */
+
+#define FULL_TABLE_ROUTES 700000
+#define FULL_TABLE_TBL8S (1 << 14)
+
+/* Prefix length distribution, in routes per 10000. */
+static const uint16_t full_table_depth_dist[RTE_LPM_MAX_DEPTH + 1] = {
+	[8] = 1, [9] = 1, [10] = 2, [11] = 6, [12] = 18, [13] = 36,
+	[14] = 60, [15] = 100, [16] = 150, [17] = 180, [18] = 300,
+	[19] = 500, [20] = 600, [21] = 650, [22] = 900, [23] = 850,
+	[24] = 5500, [25] = 10, [26] = 12, [27] = 12, [28] = 12,
+	[29] = 20, [30] = 30, [31] = 5, [32] = 45,
+};
+
+static inline uint32_t
+full_table_rand(uint32_t *state)
+{
+	/* xorshift32, so the generated table is the same on every run */
+	*state ^= *state << 13;
+	*state ^= *state >> 17;
+	*state ^= *state << 5;
+	return *state;
+}
+
+static void
+full_table_generate(struct route_rule *table, uint32_t n)
+{
+	uint32_t state = 0x2545f491;
+	uint32_t i = 0;
+	unsigned depth, k;
+
+	for (depth = 1; depth <= RTE_LPM_MAX_DEPTH; depth++) {
+		uint32_t count = (uint32_t)((uint64_t)n *
+				full_table_depth_dist[depth] / 10000);
+
+		for (k = 0; k < count && i < n; k++, i++) {
+			table[i].ip = full_table_rand(&state);
+			table[i].depth = (uint8_t)depth;
+		}
+	}
+
+	/* Pad rounding losses with /24 routes. */
+	for (; i < n; i++) {
+		table[i].ip = full_table_rand(&state);
+		table[i].depth = 24;
+	}
+}
+
+int32_t
+test19(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_config config;
+	struct route_rule *table;
+	uint64_t begin, total_time;
+	uint32_t i, next_hop, next_hop_return, state = 1;
+	int32_t status;
+
+	table = malloc(FULL_TABLE_ROUTES * sizeof(*table));
+	TEST_LPM_ASSERT(table != NULL);
+	full_table_generate(table, FULL_TABLE_ROUTES);
+
+	print_route_distribution(table, FULL_TABLE_ROUTES);
+
+	config.max_rules = FULL_TABLE_ROUTES;
+	config.number_tbl8s = FULL_TABLE_TBL8S;
+	config.flags = 0;
+
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	if (lpm == NULL) {
+		printf("Error at line %d: \n", __LINE__);
+		free(table);
+		return -1;
+	}
+
+	begin = rte_rdtsc();
+	for (i = 0; i < FULL_TABLE_ROUTES; i++) {
+		/* Next hops above 255 only fit the 24-bit entries. */
+		status = rte_lpm_add(lpm, table[i].ip, table[i].depth,
+				i & RTE_LPM_MAX_NEXT_HOP);
+		if (status != 0) {
+			printf("Route %u (%08x/%u) add failed: %d\n", i,
+					table[i].ip, table[i].depth, status);
+			goto error;
+		}
+	}
+	total_time = rte_rdtsc() - begin;
+
+	printf("Full table: %u routes added in %.3f s "
+			"(%g cycles per route), %u tbl8 groups used\n",
+			FULL_TABLE_ROUTES,
+			(double)total_time / rte_get_tsc_hz(),
+			(double)total_time / FULL_TABLE_ROUTES,
+			FULL_TABLE_TBL8S - lpm->tbl8_free_count);
+
+	/*
+	 * Every route must be present; a /32 has no more specific route so
+	 * its lookup must return its own (possibly overwritten) next hop.
+	 */
+	for (i = 0; i < FULL_TABLE_ROUTES; i++) {
+		if (rte_lpm_is_rule_present(lpm, table[i].ip, table[i].depth,
+				&next_hop) != 1) {
+			printf("Route %u (%08x/%u) not present\n", i,
+					table[i].ip, table[i].depth);
+			goto error;
+		}
+		if (table[i].depth != RTE_LPM_MAX_DEPTH)
+			continue;
+		if (rte_lpm_lookup(lpm, table[i].ip, &next_hop_return) != 0 ||
+				next_hop_return != next_hop) {
+			printf("Route %u (%08x/32) lookup failed\n", i,
+					table[i].ip);
+			goto error;
+		}
+	}
+
+	/* Removing the routes longer than /24 must free every tbl8 group. */
+	for (i = 0; i < FULL_TABLE_ROUTES; i++)
+		if (table[i].depth > 24)
+			rte_lpm_delete(lpm, table[i].ip, table[i].depth);
+	if (lpm->tbl8_free_count != FULL_TABLE_TBL8S) {
+		printf("%u tbl8 groups not recycled\n",
+				FULL_TABLE_TBL8S - lpm->tbl8_free_count);
+		goto error;
+	}
+
+	for (i = 0; i < FULL_TABLE_ROUTES; i++)
+		if (table[i].depth <= 24)
+			rte_lpm_delete(lpm, table[i].ip, table[i].depth);
+
+	for (i = 0; i < 1000; i++) {
+		status = rte_lpm_lookup(lpm, full_table_rand(&state),
+				&next_hop_return);
+		if (status != -ENOENT)
+			goto error;
+	}
+
+	rte_lpm_free(lpm);
+	free(table);
+
+	return PASS;
+
+error:
+	rte_lpm_free(lpm);
+	free(table);
+	return -1;
+}
+
+/*
+ * Attach a QSBR variable to a table with a single tbl8 group. A group freed
+ * while a reader is online must not be reused before the reader reports a
+ * quiescent state, in both reclamation modes.
+ */
+int32_t
+test20(void)
+{
+	struct rte_lpm *lpm = NULL, *lpm_long;
+	struct rte_lpm_config config;
+	struct rte_lpm_rcu_config rcu_config;
+	struct rte_rcu_qsbr *v;
+	uint32_t ip = IPv4(10, 0, 0, 1), next_hop_return;
+	int32_t status;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 1;
+	config.flags = 0;
+
+	v = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+			RTE_CACHE_LINE_SIZE);
+	TEST_LPM_ASSERT(v != NULL);
+	TEST_LPM_ASSERT(rte_rcu_qsbr_init(v, RTE_MAX_LCORE) == 0);
+
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	memset(&rcu_config, 0, sizeof(rcu_config));
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(NULL, &rcu_config) == -EINVAL);
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm, &rcu_config) == -EINVAL);
+
+	rcu_config.v = v;
+	rcu_config.mode = RTE_LPM_QSBR_MODE_DQ;
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm, &rcu_config) == 0);
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm, &rcu_config) == -EEXIST);
+
+	/* The defer queue name is derived from the table name. */
+	lpm_long = rte_lpm_create_config("test20_long_lpm_table_name", SOCKET_ID_ANY,
+			&config);
+	TEST_LPM_ASSERT(lpm_long != NULL);
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm_long, &rcu_config) ==
+			-ENAMETOOLONG);
+	rte_lpm_free(lpm_long);
+
+	/* Simulated reader, it reports its states by hand. */
+	TEST_LPM_ASSERT(rte_rcu_qsbr_thread_register(v, 0) == 0);
+	rte_rcu_qsbr_thread_online(v, 0);
+
+	status = rte_lpm_add(lpm, ip, 32, 100);
+	TEST_LPM_ASSERT(status == 0);
+	TEST_LPM_ASSERT(lpm->tbl8_free_count == 0);
+
+	status = rte_lpm_delete(lpm, ip, 32);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	/* The group is still pending: no room for a new /32. */
+	TEST_LPM_ASSERT(lpm->tbl8_free_count == 0);
+	status = rte_lpm_add(lpm, ip + 256, 32, 101);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+
+	/* Once the reader is quiescent the group can be taken back. */
+	rte_rcu_qsbr_quiescent(v, 0);
+	status = rte_lpm_add(lpm, ip + 256, 32, 101);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_lookup(lpm, ip + 256, &next_hop_return);
+	TEST_LPM_ASSERT(status == 0 && next_hop_return == 101);
+
+	rte_rcu_qsbr_thread_offline(v, 0);
+	rte_lpm_free(lpm);
+
+	/* In blocking mode the delete waits for the grace period itself. */
+	lpm = rte_lpm_create_config(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	rcu_config.mode = RTE_LPM_QSBR_MODE_SYNC;
+	TEST_LPM_ASSERT(rte_lpm_rcu_qsbr_add(lpm, &rcu_config) == 0);
+
+	status = rte_lpm_add(lpm, ip, 32, 100);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_delete(lpm, ip, 32);
+	TEST_LPM_ASSERT(status == 0);
+	TEST_LPM_ASSERT(lpm->tbl8_free_count == 1);
+
+	rte_rcu_qsbr_thread_unregister(v, 0);
+	rte_lpm_free(lpm);
+	rte_free(v);
+
+	return PASS;
+}
+
 int32_t
 perf_test(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint64_t begin, total_time, lpm_used_entries = 0;
 	unsigned i, j;
-	uint8_t next_hop_add = 0xAA, next_hop_return = 0;
+	uint32_t next_hop_add = 0xAA, next_hop_return = 0;
 	int status = 0;
 	uint64_t cache_line_counter = 0;
 	int64_t count = 0;
@@ -1252,7 +1628,7 @@ perf_test(void)
 	count = 0;
 	for (i = 0; i < ITERATIONS; i ++) {
 		static uint32_t ip_batch[BATCH_SIZE];
-		uint16_t next_hops[BULK_SIZE];
+		uint32_t next_hops[BULK_SIZE];
 
 		/* Create array of random IP addresses */
 		for (j = 0; j < BATCH_SIZE; j ++)
@@ -1279,7 +1655,7 @@ perf_test(void)
 	count = 0;
 	for (i = 0; i < ITERATIONS; i++) {
 		static uint32_t ip_batch[BATCH_SIZE];
-		uint16_t next_hops[4];
+		uint32_t next_hops[4];
 
 		/* Create array of random IP addresses */
 		for (j = 0; j < BATCH_SIZE; j++)
@@ -47,6 +47,9 @@
 #include <rte_random.h>
 #include <rte_branch_prediction.h>
 #include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
 
 #include "rte_lpm6.h"
 #include "test_lpm6_routes.h"
@@ -88,7 +91,11 @@ static int32_t test24(void);
 static int32_t test25(void);
 static int32_t test26(void);
 static int32_t test27(void);
+static int32_t test28(void);
+static int32_t test29(void);
+static int32_t test30(void);
 static int32_t perf_test(void);
+static int32_t perf_test_table_sizes(void);
 
 rte_lpm6_test tests6[] = {
 /* Test Cases */
@@ -120,7 +127,11 @@ rte_lpm6_test tests6[] = {
 	test25,
 	test26,
 	test27,
+	test28,
+	test29,
+	test30,
 	perf_test,
+	perf_test_table_sizes,
 };
 
 #define NUM_LPM6_TESTS                (sizeof(tests6)/sizeof(tests6[0]))
@@ -1761,6 +1772,325 @@ test27(void)
 		return PASS;
 }
 
+/*
+ * Delete rules one at a time with just the tbl8 groups of one /128 rule.
+ * The groups left behind by a deleted rule must be freed, the entries it
+ * covered must return to the next less specific rule, and rules of other
+ * prefixes must still be found.
+ */
+int32_t
+test28(void)
+{
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	uint8_t ip[] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
+	uint8_t ip_other[] = {1,2,3,4,5,6,8,0,0,0,0,0,0,0,0,0};
+	uint8_t next_hop_return;
+	int32_t status;
+	int i;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 13;
+	config.flags = 0;
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	/* A /128 uses every group, again and again. */
+	for (i = 0; i < 100; i++) {
+		ip[15] = (uint8_t)i;
+		status = rte_lpm6_add(lpm, ip, 128, (uint8_t)i);
+		TEST_LPM_ASSERT(status == 0);
+		status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+		TEST_LPM_ASSERT(status == 0 && next_hop_return == i);
+		status = rte_lpm6_delete(lpm, ip, 128);
+		TEST_LPM_ASSERT(status == 0);
+		status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+		TEST_LPM_ASSERT(status == -ENOENT);
+	}
+
+	/* Deleting the /128 falls back to the /48 and frees its groups. */
+	status = rte_lpm6_add(lpm, ip, 48, 48);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_add(lpm, ip, 128, 128);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_delete(lpm, ip, 128);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == 0 && next_hop_return == 48);
+
+	/* The /48 shares its first two groups with another /56. */
+	status = rte_lpm6_add(lpm, ip_other, 56, 56);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_add(lpm, ip, 64, 64);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_delete(lpm, ip, 48);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == 0 && next_hop_return == 64);
+	status = rte_lpm6_lookup(lpm, ip_other, &next_hop_return);
+	TEST_LPM_ASSERT(status == 0 && next_hop_return == 56);
+	ip[6] = 9;
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+	ip[6] = 7;
+
+	status = rte_lpm6_delete(lpm, ip, 64);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_delete(lpm, ip_other, 56);
+	TEST_LPM_ASSERT(status == 0);
+
+	/* Everything was freed: a /128 fits again. */
+	status = rte_lpm6_add(lpm, ip, 128, 128);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == 0 && next_hop_return == 128);
+
+	rte_lpm6_free(lpm);
+
+	return PASS;
+}
+
+/*
+ * Attach a QSBR variable to a table with the tbl8 groups of one /128 rule.
+ * The groups freed while a reader is online must not be reused before the
+ * reader reports a quiescent state.
+ */
+int32_t
+test29(void)
+{
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	struct rte_lpm6_rcu_config rcu_config;
+	struct rte_rcu_qsbr *v;
+	uint8_t ip[] = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
+	uint8_t next_hop_return;
+	int32_t status;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 13;
+	config.flags = 0;
+
+	v = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE),
+			RTE_CACHE_LINE_SIZE);
+	TEST_LPM_ASSERT(v != NULL);
+	TEST_LPM_ASSERT(rte_rcu_qsbr_init(v, RTE_MAX_LCORE) == 0);
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	memset(&rcu_config, 0, sizeof(rcu_config));
+	TEST_LPM_ASSERT(rte_lpm6_rcu_qsbr_add(lpm, &rcu_config) == -EINVAL);
+	rcu_config.v = v;
+	rcu_config.mode = RTE_LPM6_QSBR_MODE_DQ;
+	TEST_LPM_ASSERT(rte_lpm6_rcu_qsbr_add(lpm, &rcu_config) == 0);
+	TEST_LPM_ASSERT(rte_lpm6_rcu_qsbr_add(lpm, &rcu_config) == -EEXIST);
+
+	/* Simulated reader, it reports its states by hand. */
+	TEST_LPM_ASSERT(rte_rcu_qsbr_thread_register(v, 0) == 0);
+	rte_rcu_qsbr_thread_online(v, 0);
+
+	status = rte_lpm6_add(lpm, ip, 128, 100);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_delete(lpm, ip, 128);
+	TEST_LPM_ASSERT(status == 0);
+
+	/* The groups are still pending. */
+	ip[0] = 2;
+	status = rte_lpm6_add(lpm, ip, 128, 101);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	rte_rcu_qsbr_quiescent(v, 0);
+	status = rte_lpm6_add(lpm, ip, 128, 101);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == 0 && next_hop_return == 101);
+
+	rte_rcu_qsbr_thread_offline(v, 0);
+	rte_rcu_qsbr_thread_unregister(v, 0);
+	rte_lpm6_free(lpm);
+	rte_free(v);
+
+	return PASS;
+}
+
+/*
+ * Synthetic routes: prefix lengths spread like a provider table, mostly /48
+ * and /32, from a deterministic generator so that runs are comparable.
+ */
+static const struct {
+	uint8_t depth;
+	uint8_t percent;
+} synth_depth_dist[] = {
+	{ 20, 2 }, { 28, 3 }, { 29, 2 }, { 32, 20 }, { 36, 3 }, { 40, 6 },
+	{ 44, 4 }, { 48, 46 }, { 56, 4 }, { 64, 8 }, { 128, 2 },
+};
+
+static uint32_t
+synth_rand(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+/*
+ * Fills table with n routes. They share their first 16 bits with a few
+ * others, as routes from the same registry block do.
+ */
+static void
+synth_routes(struct rules_tbl_entry *table, uint32_t n, uint32_t seed)
+{
+	uint32_t state = seed, i, j, k, count;
+
+	for (i = 0, k = 0; k < RTE_DIM(synth_depth_dist); k++) {
+		count = (uint32_t)(((uint64_t)n * synth_depth_dist[k].percent +
+				99) / 100);
+		for (j = 0; j < count && i < n; j++, i++) {
+			uint32_t r;
+
+			for (r = 0; r < RTE_LPM6_IPV6_ADDR_SIZE; r += 4) {
+				uint32_t x = synth_rand(&state);
+
+				memcpy(&table[i].ip[r], &x, sizeof(x));
+			}
+			table[i].ip[0] = 0x20;
+			table[i].ip[1] = (uint8_t)(table[i].ip[1] & 0x0f);
+			table[i].depth = synth_depth_dist[k].depth;
+			table[i].next_hop = (uint8_t)synth_rand(&state);
+		}
+	}
+}
+
+/* An address covered by route, random past the prefix. */
+static void
+synth_addr(uint8_t *ip, const struct rules_tbl_entry *route, uint32_t *state)
+{
+	uint32_t r, b;
+
+	for (r = 0; r < RTE_LPM6_IPV6_ADDR_SIZE; r += 4) {
+		uint32_t x = synth_rand(state);
+
+		memcpy(&ip[r], &x, sizeof(x));
+	}
+	for (b = 0; b < route->depth; b++) {
+		uint8_t mask = (uint8_t)(0x80 >> (b % 8));
+
+		ip[b / 8] = (uint8_t)((ip[b / 8] & ~mask) |
+				(route->ip[b / 8] & mask));
+	}
+}
+
+/* Worst case number of tbl8 groups needed by the routes. */
+static uint32_t
+synth_tbl8s(const struct rules_tbl_entry *table, uint32_t n,
+		uint32_t first_bits)
+{
+	uint32_t i, tbl8s = 0;
+
+	for (i = 0; i < n; i++)
+		if (table[i].depth > first_bits)
+			tbl8s += (table[i].depth - first_bits + 7) / 8;
+
+	return tbl8s;
+}
+
+/*
+ * Add the same routes to a tbl24 and a tbl16 table, and check that every
+ * lookup gives the same result, before and after deleting half the routes.
+ */
+int32_t
+test30(void)
+{
+	struct rte_lpm6 *lpm = NULL, *lpm16 = NULL;
+	struct rte_lpm6_config config;
+	struct rules_tbl_entry *table;
+	uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE];
+	uint8_t next_hop, next_hop16;
+	uint32_t state = 0x9e3779b9, n = 2000, i, j, round;
+	int32_t status, status16;
+
+	table = malloc(sizeof(*table) * n);
+	TEST_LPM_ASSERT(table != NULL);
+	synth_routes(table, n, 0x2545f491);
+
+	config.max_rules = n;
+	config.number_tbl8s = synth_tbl8s(table, n, 24);
+	config.flags = 0;
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	if (lpm == NULL)
+		goto error;
+
+	config.number_tbl8s = synth_tbl8s(table, n, 16);
+	config.flags = RTE_LPM6_F_TBL16;
+	lpm16 = rte_lpm6_create("test30_tbl16", SOCKET_ID_ANY, &config);
+	if (lpm16 == NULL)
+		goto error;
+
+	for (i = 0; i < n; i++) {
+		status = rte_lpm6_add(lpm, table[i].ip, table[i].depth,
+				table[i].next_hop);
+		status16 = rte_lpm6_add(lpm16, table[i].ip, table[i].depth,
+				table[i].next_hop);
+		if (status != 0 || status16 != 0) {
+			printf("Cannot add route %u: %d %d\n", i, status,
+					status16);
+			goto error;
+		}
+	}
+
+	for (round = 0; round < 2; round++) {
+		for (i = 0; i < n; i++) {
+			for (j = 0; j < 4; j++) {
+				synth_addr(ip, &table[i], &state);
+				/* Some addresses are anywhere in the block. */
+				if (j == 3)
+					memset(&ip[3], 0, 4);
+
+				status = rte_lpm6_lookup(lpm, ip, &next_hop);
+				status16 = rte_lpm6_lookup(lpm16, ip,
+						&next_hop16);
+				if (status != status16 || (status == 0 &&
+						next_hop != next_hop16)) {
+					printf("Lookup mismatch for route %u\n",
+							i);
+					goto error;
+				}
+				if (round == 0 && j == 0 && status != 0)
+					goto error;
+			}
+		}
+
+		/* Then do it again with every other route deleted. */
+		for (i = 0; round == 0 && i < n; i += 2) {
+			status = rte_lpm6_delete(lpm, table[i].ip,
+					table[i].depth);
+			status16 = rte_lpm6_delete(lpm16, table[i].ip,
+					table[i].depth);
+			if (status != status16)
+				goto error;
+		}
+	}
+
+	rte_lpm6_free(lpm);
+	rte_lpm6_free(lpm16);
+	free(table);
+
+	return PASS;
+
+error:
+	rte_lpm6_free(lpm);
+	rte_lpm6_free(lpm16);
+	free(table);
+	return -1;
+}
+
 /*
  * Lookup performance test
  */
@@ -1897,6 +2227,100 @@ perf_test(void)
 	return PASS;
 }
 
+/*
+ * Memory and bulk lookup rate of tbl24 and tbl16 tables for a growing
+ * number of synthetic routes.
+ */
+#define SIZES_LOOKUP_BATCH  (1 << 12)
+#define SIZES_ITERATIONS    (1 << 8)
+
+static int
+perf_table_size(struct rules_tbl_entry *table, uint32_t n, int flags,
+		uint8_t (*ips)[RTE_LPM6_IPV6_ADDR_SIZE], int16_t *next_hops)
+{
+	struct rte_lpm6 *lpm;
+	struct rte_lpm6_config config;
+	struct rte_malloc_socket_stats before, after;
+	uint64_t begin, total_time, count;
+	unsigned socket_id = rte_socket_id();
+	uint32_t i, j;
+	double cycles;
+
+	config.max_rules = n;
+	config.number_tbl8s = synth_tbl8s(table, n,
+			(flags & RTE_LPM6_F_TBL16) ? 16 : 24);
+	config.flags = flags;
+
+	rte_malloc_get_socket_stats(socket_id, &before);
+	lpm = rte_lpm6_create(__func__, socket_id, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+	rte_malloc_get_socket_stats(socket_id, &after);
+
+	for (i = 0; i < n; i++)
+		TEST_LPM_ASSERT(rte_lpm6_add(lpm, table[i].ip, table[i].depth,
+				table[i].next_hop) == 0);
+
+	total_time = 0;
+	count = 0;
+	for (i = 0; i < SIZES_ITERATIONS; i++) {
+		begin = rte_rdtsc();
+		rte_lpm6_lookup_bulk_func(lpm, ips, next_hops,
+				SIZES_LOOKUP_BATCH);
+		total_time += rte_rdtsc() - begin;
+
+		for (j = 0; j < SIZES_LOOKUP_BATCH; j++)
+			if (next_hops[j] < 0)
+				count++;
+	}
+
+	cycles = (double)total_time /
+			((double)SIZES_ITERATIONS * SIZES_LOOKUP_BATCH);
+	printf("%8u  %-6s %10.1f KB %8u %10.1f %10.1f %8.1f%%\n", n,
+			(flags & RTE_LPM6_F_TBL16) ? "tbl16" : "tbl24",
+			(double)(after.heap_allocsz_bytes -
+				before.heap_allocsz_bytes) / 1024,
+			config.number_tbl8s, cycles,
+			(double)rte_get_tsc_hz() / cycles / 1000000,
+			(count * 100.0) / (SIZES_ITERATIONS * SIZES_LOOKUP_BATCH));
+
+	rte_lpm6_free(lpm);
+
+	return 0;
+}
+
+int32_t
+perf_test_table_sizes(void)
+{
+	static const uint32_t sizes[] = { 50, 1000, 10000 };
+	static uint8_t ips[SIZES_LOOKUP_BATCH][RTE_LPM6_IPV6_ADDR_SIZE];
+	static int16_t next_hops[SIZES_LOOKUP_BATCH];
+	struct rules_tbl_entry *table;
+	uint32_t state = 0x9e3779b9, i, k;
+	int status = 0;
+
+	printf("  routes  layout     memory    tbl8s   cycles/ip     Mpps   misses\n");
+
+	for (k = 0; k < RTE_DIM(sizes) && status == 0; k++) {
+		table = malloc(sizeof(*table) * sizes[k]);
+		TEST_LPM_ASSERT(table != NULL);
+		synth_routes(table, sizes[k], 0x2545f491);
+
+		/* Addresses hit random routes, the lookups walk all levels. */
+		for (i = 0; i < SIZES_LOOKUP_BATCH; i++)
+			synth_addr(ips[i],
+				&table[synth_rand(&state) % sizes[k]], &state);
+
+		status = perf_table_size(table, sizes[k], 0, ips, next_hops);
+		if (status == 0)
+			status = perf_table_size(table, sizes[k],
+					RTE_LPM6_F_TBL16, ips, next_hops);
+
+		free(table);
+	}
+
+	return status;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -57,6 +57,7 @@
 #include <rte_mempool.h>
 #include <rte_spinlock.h>
 #include <rte_malloc.h>
+#include <rte_errno.h>
 
 #include "test.h"
 
@@ -70,6 +71,18 @@
  *    - Get two objects, put two objects
  *    - Get all objects, test that their content is not modified and
  *      put them back in the pool.
+ *
+ * Pool handler tests:
+ *
+ *    - Run the basic tests on a mempool using the "stack" handler, and
+ *      check that the last object put is the first one retrieved.
+ *    - Check that an unknown pool handler name is rejected.
+ *
+ * Cache tests:
+ *
+ *    - Check that the lcore cache is resized to the size of the bursts,
+ *      within the configured range.
+ *    - Drain the lcore cache and check that no object is lost.
  */
 
 #define N 65536
@@ -428,6 +441,179 @@ test_mempool_same_name_twice_creation(void)
 	return 0;
 }
 
+/*
+ * Test the "stack" pool handler, and creation with an unknown handler.
+ */
+static int
+test_mempool_stack(void)
+{
+	static struct rte_mempool *mp_stack;
+	static int long_name_tested;
+	struct rte_mempool *mp_cov;
+	void *obj, *obj2, *obj3;
+
+	mp_cov = rte_mempool_create_with_ops("test_mempool_bad_ops",
+			MEMPOOL_SIZE, MEMPOOL_ELT_SIZE, 0, 0,
+			NULL, NULL, NULL, NULL,
+			SOCKET_ID_ANY, 0, "no_such_ops");
+	if (mp_cov != NULL || rte_errno != ENOENT) {
+		printf("mempool with unknown ops was created\n");
+		return -1;
+	}
+
+	/* the stack memzone name must not be truncated into the pool one;
+	 * the space of a failed mempool is lost, so keep it small and only
+	 * try it once */
+	if (!long_name_tested) {
+		long_name_tested = 1;
+		mp_cov = rte_mempool_create_with_ops(
+				"test_mempool_stack_long_name", 1,
+				sizeof(uint64_t), 0, 0,
+				NULL, NULL, NULL, NULL,
+				SOCKET_ID_ANY, 0, "stack");
+		if (mp_cov != NULL || rte_errno != ENAMETOOLONG) {
+			printf("stack mempool with a long name was created\n");
+			return -1;
+		}
+	}
+
+	if (mp_stack == NULL)
+		mp_stack = rte_mempool_create_with_ops("test_stack",
+				MEMPOOL_SIZE, MEMPOOL_ELT_SIZE, 0, 0,
+				NULL, NULL, my_obj_init, NULL,
+				SOCKET_ID_ANY, 0, "stack");
+	if (mp_stack == NULL)
+		return -1;
+
+	/* without cache, objects come back in LIFO order */
+	if (rte_mempool_get(mp_stack, &obj) < 0)
+		return -1;
+	if (rte_mempool_get(mp_stack, &obj2) < 0) {
+		rte_mempool_put(mp_stack, obj);
+		return -1;
+	}
+	rte_mempool_put(mp_stack, obj);
+	rte_mempool_put(mp_stack, obj2);
+	if (rte_mempool_get(mp_stack, &obj3) < 0)
+		return -1;
+	rte_mempool_put(mp_stack, obj3);
+	if (obj3 != obj2) {
+		printf("stack mempool did not return the last object put\n");
+		return -1;
+	}
+
+	mp = mp_stack;
+	return test_mempool_basic();
+}
+
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+/* get and put objects by bursts of n, long enough to resize the cache */
+static int
+test_mempool_cache_bursts(struct rte_mempool *mp_c, unsigned n)
+{
+	void *objtable[MAX_KEEP];
+	unsigned i;
+
+	for (i = 0; i < RTE_MEMPOOL_CACHE_ADAPT_PERIOD; i++) {
+		if (rte_mempool_get_bulk(mp_c, objtable, n) < 0)
+			return -1;
+		rte_mempool_put_bulk(mp_c, objtable, n);
+	}
+	return 0;
+}
+
+/*
+ * Test the resizing of the lcore caches, and the draining of a cache.
+ */
+static int
+test_mempool_cache_range(void)
+{
+	struct rte_mempool_cache *cache;
+	unsigned lcore_id = rte_lcore_id();
+	unsigned count, len;
+	const unsigned min_size = 16;
+
+	if (rte_mempool_set_cache_range(mp_nocache, 0, 32) != -ENOTSUP)
+		return -1;
+	if (rte_mempool_set_cache_range(mp_cache, 32, 16) != -EINVAL)
+		return -1;
+	if (rte_mempool_set_cache_range(mp_cache, 0,
+			RTE_MEMPOOL_CACHE_MAX_SIZE + 1) != -EINVAL)
+		return -1;
+	if (rte_mempool_set_cache_range(mp_cache, min_size,
+			RTE_MEMPOOL_CACHE_MAX_SIZE) != 0)
+		return -1;
+
+	cache = &mp_cache->local_cache[lcore_id];
+
+	printf("small bursts shrink the cache\n");
+	if (test_mempool_cache_bursts(mp_cache, 4) < 0)
+		return -1;
+	if (cache->size != min_size) {
+		printf("cache size is %u, expected %u\n", cache->size, min_size);
+		return -1;
+	}
+
+	printf("large bursts grow the cache\n");
+	if (test_mempool_cache_bursts(mp_cache, MAX_KEEP) < 0)
+		return -1;
+	if (cache->size != MAX_KEEP * RTE_MEMPOOL_CACHE_BURST_FACTOR) {
+		printf("cache size is %u, expected %u\n", cache->size,
+		       MAX_KEEP * RTE_MEMPOOL_CACHE_BURST_FACTOR);
+		return -1;
+	}
+	if (cache->get_hits == 0 || cache->put_hits == 0)
+		return -1;
+
+	printf("drain the cache\n");
+	count = rte_mempool_count(mp_cache);
+	len = cache->len;
+	if (rte_mempool_cache_drain(mp_cache, lcore_id) != (int)len)
+		return -1;
+	if (cache->len != 0 || rte_mempool_count(mp_cache) != count)
+		return -1;
+	if (rte_mempool_cache_drain(mp_cache, RTE_MAX_LCORE) != -EINVAL)
+		return -1;
+
+	rte_mempool_dump(stdout, mp_cache);
+
+	printf("disable the cache, then enable it again\n");
+	if (test_mempool_cache_bursts(mp_cache, MAX_KEEP) < 0)
+		return -1;
+	if (cache->len == 0)
+		return -1;
+	count = rte_mempool_count(mp_cache);
+	if (rte_mempool_set_cache_range(mp_cache, 0, 0) != 0)
+		return -1;
+	if (cache->len != 0 || rte_mempool_count(mp_cache) != count)
+		return -1;
+	if (test_mempool_cache_bursts(mp_cache, MAX_KEEP) < 0)
+		return -1;
+	if (cache->len != 0)
+		return -1;
+	if (rte_mempool_set_cache_range(mp_cache, min_size,
+			RTE_MEMPOOL_CACHE_MAX_SIZE) != 0)
+		return -1;
+	if (test_mempool_cache_bursts(mp_cache, MAX_KEEP) < 0)
+		return -1;
+	if (cache->len == 0)
+		return -1;
+
+	/* back to a fixed size cache */
+	if (rte_mempool_set_cache_range(mp_cache, RTE_MEMPOOL_CACHE_MAX_SIZE,
+			RTE_MEMPOOL_CACHE_MAX_SIZE) != 0)
+		return -1;
+
+	return 0;
+}
+#else
+static int
+test_mempool_cache_range(void)
+{
+	return 0;
+}
+#endif
+
 /*
  * BAsic test for mempool_xmem functions.
  */
@@ -500,6 +686,14 @@ test_mempool(void)
 	if (test_mempool_basic() < 0)
 		return -1;
 
+	/* basic tests with the stack pool handler */
+	if (test_mempool_stack() < 0)
+		return -1;
+
+	/* resizing of the lcore caches */
+	if (test_mempool_cache_range() < 0)
+		return -1;
+
 	/* more basic tests without cache */
 	if (test_mempool_basic_ex(mp_nocache) < 0)
 		return -1;
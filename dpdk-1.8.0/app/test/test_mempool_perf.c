@@ -89,6 +89,21 @@
  *
  *      - 32
  *      - 128
+ *
+ * Asymmetric performance
+ * ======================
+ *
+ *    Objects are allocated on some cores by bulk of *n_get_bulk*, and
+ *    passed through a ring to other cores which free them, as when
+ *    mbufs are received on one core and transmitted on another.
+ *
+ *    This is done during TIME_S seconds, for each pool handler ("ring"
+ *    and "stack"), with and without cache, and for the following core
+ *    sets (with N being the number of slave cores):
+ *
+ *      - 1 get core, N-1 put cores
+ *      - N-1 get cores, 1 put core
+ *      - N/2 get cores, N-N/2 put cores
  */
 
 #define N 65536
@@ -99,6 +114,7 @@
 
 static struct rte_mempool *mp;
 static struct rte_mempool *mp_cache, *mp_nocache;
+static struct rte_mempool *mp_stack_cache, *mp_stack_nocache;
 
 static rte_atomic32_t synchro;
 
@@ -116,6 +132,12 @@ struct mempool_test_stats {
 
 static struct mempool_test_stats stats[RTE_MAX_LCORE];
 
+/* ring used to pass objects from the get cores to the put cores */
+#define XFER_RING_SIZE 4096
+#define XFER_BULK 32
+static struct rte_ring *xfer_ring;
+static volatile int xfer_stop;
+
 /*
  * save the object number in the first 4 bytes of object data. All
  * other bytes are set to 0.
@@ -162,7 +184,6 @@ per_lcore_mempool_test(__attribute__((unused)) void *arg)
 							   n_get_bulk);
 				if (unlikely(ret < 0)) {
 					rte_mempool_dump(stdout, mp);
-					rte_ring_dump(stdout, mp->ring);
 					/* in this case, objects are lost... */
 					return -1;
 				}
@@ -244,6 +265,132 @@ launch_cores(unsigned cores)
 	return 0;
 }
 
+/* allocate objects and pass them to the put cores */
+static int
+per_lcore_get_test(__attribute__((unused)) void *arg)
+{
+	void *obj_table[XFER_BULK];
+
+	while (rte_atomic32_read(&synchro) == 0)
+		;
+
+	while (xfer_stop == 0) {
+		if (rte_mempool_get_bulk(mp, obj_table, XFER_BULK) < 0)
+			continue;
+		while (rte_ring_mp_enqueue_bulk(xfer_ring, obj_table,
+				XFER_BULK) == -ENOBUFS) {
+			if (xfer_stop) {
+				rte_mempool_put_bulk(mp, obj_table, XFER_BULK);
+				return 0;
+			}
+		}
+	}
+	return 0;
+}
+
+/* free the objects allocated by the get cores */
+static int
+per_lcore_put_test(__attribute__((unused)) void *arg)
+{
+	void *obj_table[XFER_BULK];
+	unsigned lcore_id = rte_lcore_id();
+	unsigned n;
+
+	stats[lcore_id].enq_count = 0;
+
+	while (rte_atomic32_read(&synchro) == 0)
+		;
+
+	while (xfer_stop == 0) {
+		n = rte_ring_mc_dequeue_burst(xfer_ring, obj_table, XFER_BULK);
+		if (n == 0)
+			continue;
+		rte_mempool_put_bulk(mp, obj_table, n);
+		stats[lcore_id].enq_count += n;
+	}
+	return 0;
+}
+
+/* launch the asymmetric test on n_get + n_put slave cores */
+static int
+launch_asym_cores(unsigned n_get, unsigned n_put)
+{
+	void *obj_table[XFER_BULK];
+	unsigned lcore_id, i;
+	unsigned n;
+	uint64_t rate;
+	int ret = 0;
+
+	rte_atomic32_set(&synchro, 0);
+	xfer_stop = 0;
+	memset(stats, 0, sizeof(stats));
+
+	printf("mempool_autotest ops=%s cache=%u get_cores=%u put_cores=%u "
+	       "n_bulk=%u ", __mempool_get_ops(mp)->name,
+	       (unsigned) mp->cache_size, n_get, n_put, XFER_BULK);
+
+	i = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (i == n_get + n_put)
+			break;
+		if (i < n_get)
+			rte_eal_remote_launch(per_lcore_get_test, NULL, lcore_id);
+		else
+			rte_eal_remote_launch(per_lcore_put_test, NULL, lcore_id);
+		i++;
+	}
+
+	rte_atomic32_set(&synchro, 1);
+	rte_delay_ms(TIME_S * 1000);
+	xfer_stop = 1;
+
+	i = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (i == n_get + n_put)
+			break;
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+		i++;
+	}
+
+	/* give back the objects still in transit */
+	while ((n = rte_ring_sc_dequeue_burst(xfer_ring, obj_table,
+			XFER_BULK)) != 0)
+		rte_mempool_put_bulk(mp, obj_table, n);
+
+	if (ret < 0) {
+		printf("per-lcore test returned -1\n");
+		return -1;
+	}
+
+	rate = 0;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		rate += stats[lcore_id].enq_count;
+
+	printf("rate_persec=%"PRIu64"\n", rate / TIME_S);
+
+	return 0;
+}
+
+/* launch the asymmetric test on all core sets */
+static int
+do_asym_mempool_test(void)
+{
+	unsigned n_slaves = rte_lcore_count() - 1;
+
+	if (launch_asym_cores(1, n_slaves - 1) < 0)
+		return -1;
+
+	if (launch_asym_cores(n_slaves - 1, 1) < 0)
+		return -1;
+
+	if (n_slaves >= 4 &&
+	    launch_asym_cores(n_slaves / 2, n_slaves - n_slaves / 2) < 0)
+		return -1;
+
+	return 0;
+}
+
 /* for a given number of core, launch all test cases */
 static int
 do_one_mempool_test(unsigned cores)
@@ -325,6 +472,55 @@ test_mempool_perf(void)
 	if (do_one_mempool_test(rte_lcore_count()) < 0)
 		return -1;
 
+	/* create the mempools using the stack handler */
+	if (mp_stack_nocache == NULL)
+		mp_stack_nocache = rte_mempool_create_with_ops(
+						"perf_test_stack_nocache",
+						MEMPOOL_SIZE,
+						MEMPOOL_ELT_SIZE, 0, 0,
+						NULL, NULL,
+						my_obj_init, NULL,
+						SOCKET_ID_ANY, 0, "stack");
+	if (mp_stack_nocache == NULL)
+		return -1;
+
+	if (mp_stack_cache == NULL)
+		mp_stack_cache = rte_mempool_create_with_ops(
+						"perf_test_stack_cache",
+						MEMPOOL_SIZE,
+						MEMPOOL_ELT_SIZE,
+						RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+						NULL, NULL,
+						my_obj_init, NULL,
+						SOCKET_ID_ANY, 0, "stack");
+	if (mp_stack_cache == NULL)
+		return -1;
+
+	if (xfer_ring == NULL)
+		xfer_ring = rte_ring_create("perf_test_xfer", XFER_RING_SIZE,
+					    SOCKET_ID_ANY, 0);
+	if (xfer_ring == NULL)
+		return -1;
+
+	/* asymmetric test, objects are freed on other cores */
+	if (rte_lcore_count() < 3) {
+		printf("need at least 3 cores for asymmetric test, skipping\n");
+	} else {
+		printf("start asymmetric performance test\n");
+		mp = mp_nocache;
+		if (do_asym_mempool_test() < 0)
+			return -1;
+		mp = mp_stack_nocache;
+		if (do_asym_mempool_test() < 0)
+			return -1;
+		mp = mp_cache;
+		if (do_asym_mempool_test() < 0)
+			return -1;
+		mp = mp_stack_cache;
+		if (do_asym_mempool_test() < 0)
+			return -1;
+	}
+
 	rte_mempool_list_dump(stdout);
 
 	return 0;
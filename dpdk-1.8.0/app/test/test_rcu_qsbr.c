@@ -0,0 +1,458 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_cycles.h>
+#include <rte_atomic.h>
+#include <rte_errno.h>
+#include <rte_rcu_qsbr.h>
+
+#include "test.h"
+
+/*
+ * RCU QSBR test
+ * =============
+ *
+ * - Check the argument validation of the QSBR and defer queue API.
+ *
+ * - With simulated reader threads, check that a grace period only ends
+ *   once every online reader reported a quiescent state, that offline and
+ *   unregistered readers do not hold it, and that a defer queue frees its
+ *   elements only after their grace period.
+ *
+ * - If there are enough lcores, readers run on the slave lcores and keep
+ *   dereferencing a shared element while the master replaces it and frees
+ *   the old one through a defer queue. A reader must never see a freed
+ *   element.
+ */
+
+#define TEST_RCU_MAX_THREADS 128
+#define TEST_RCU_DQ_SIZE     8
+#define TEST_RCU_ELEMS       64
+#define TEST_RCU_ITERATIONS  100000
+
+#define ELEM_LIVE  0x600d
+#define ELEM_FREED 0xdead
+
+static struct rte_rcu_qsbr *t_v;
+static volatile uint32_t t_elems[TEST_RCU_ELEMS];
+static volatile uint32_t t_freed[TEST_RCU_ELEMS];
+static volatile uint32_t t_current;
+static volatile int t_stop;
+static rte_atomic32_t t_errors;
+
+static void
+test_free_elem(void *p, uint32_t e)
+{
+	RTE_SET_USED(p);
+	t_elems[e] = ELEM_FREED;
+	t_freed[e]++;
+}
+
+static struct rte_rcu_qsbr *
+test_rcu_alloc(uint32_t max_threads)
+{
+	struct rte_rcu_qsbr *v;
+
+	v = rte_zmalloc(NULL, rte_rcu_qsbr_get_memsize(max_threads),
+			RTE_CACHE_LINE_SIZE);
+	if (v == NULL)
+		return NULL;
+	if (rte_rcu_qsbr_init(v, max_threads) != 0) {
+		rte_free(v);
+		return NULL;
+	}
+	return v;
+}
+
+static int
+test_rcu_qsbr_params(void)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	struct rte_rcu_qsbr *v;
+
+	if (rte_rcu_qsbr_get_memsize(0) != 0 ||
+			rte_rcu_qsbr_get_memsize(RTE_RCU_QSBR_MAX_THREADS + 1) != 0) {
+		printf("get_memsize accepted an invalid thread count\n");
+		return -1;
+	}
+	if (rte_rcu_qsbr_init(NULL, 1) != -EINVAL) {
+		printf("init accepted a NULL variable\n");
+		return -1;
+	}
+
+	v = test_rcu_alloc(TEST_RCU_MAX_THREADS);
+	if (v == NULL) {
+		printf("cannot allocate QSBR variable\n");
+		return -1;
+	}
+
+	if (rte_rcu_qsbr_thread_register(v, TEST_RCU_MAX_THREADS) != -EINVAL ||
+			rte_rcu_qsbr_thread_unregister(v,
+				TEST_RCU_MAX_THREADS) != -EINVAL) {
+		printf("out of range thread id accepted\n");
+		goto fail;
+	}
+
+	memset(&params, 0, sizeof(params));
+	params.name = "test_rcu_dq";
+	params.socket_id = SOCKET_ID_ANY;
+	params.size = TEST_RCU_DQ_SIZE;
+	params.free_fn = test_free_elem;
+	params.v = v;
+
+	params.trigger_reclaim_limit = TEST_RCU_DQ_SIZE + 1;
+	if (rte_rcu_qsbr_dq_create(&params) != NULL || rte_errno != EINVAL) {
+		printf("dq_create accepted a reclaim limit above the size\n");
+		goto fail;
+	}
+	params.trigger_reclaim_limit = 0;
+	params.free_fn = NULL;
+	if (rte_rcu_qsbr_dq_create(&params) != NULL || rte_errno != EINVAL) {
+		printf("dq_create accepted a NULL free function\n");
+		goto fail;
+	}
+
+	rte_free(v);
+	return 0;
+fail:
+	rte_free(v);
+	return -1;
+}
+
+static int
+test_rcu_qsbr_grace_period(void)
+{
+	struct rte_rcu_qsbr *v;
+	uint64_t token;
+
+	v = test_rcu_alloc(TEST_RCU_MAX_THREADS);
+	if (v == NULL) {
+		printf("cannot allocate QSBR variable\n");
+		return -1;
+	}
+
+	/* No reader: every grace period is over at once. */
+	token = rte_rcu_qsbr_start(v);
+	if (rte_rcu_qsbr_check(v, token, 0) != 1) {
+		printf("grace period blocked without readers\n");
+		goto fail;
+	}
+
+	/* Thread ids on both sides of a bitmap word. */
+	if (rte_rcu_qsbr_thread_register(v, 3) != 0 ||
+			rte_rcu_qsbr_thread_register(v, 64) != 0 ||
+			rte_rcu_qsbr_thread_register(v, 3) != 0) {
+		printf("cannot register reader threads\n");
+		goto fail;
+	}
+	if (v->num_threads != 2) {
+		printf("wrong number of registered threads %u\n",
+				v->num_threads);
+		goto fail;
+	}
+
+	/* Registered readers are offline and do not hold grace periods. */
+	token = rte_rcu_qsbr_start(v);
+	if (rte_rcu_qsbr_check(v, token, 0) != 1) {
+		printf("offline readers blocked the grace period\n");
+		goto fail;
+	}
+
+	rte_rcu_qsbr_thread_online(v, 3);
+	rte_rcu_qsbr_thread_online(v, 64);
+
+	token = rte_rcu_qsbr_start(v);
+	if (rte_rcu_qsbr_check(v, token, 0) != 0) {
+		printf("grace period ended with online readers\n");
+		goto fail;
+	}
+
+	rte_rcu_qsbr_quiescent(v, 3);
+	if (rte_rcu_qsbr_check(v, token, 0) != 0) {
+		printf("grace period ended before every reader reported\n");
+		goto fail;
+	}
+
+	rte_rcu_qsbr_quiescent(v, 64);
+	if (rte_rcu_qsbr_check(v, token, 0) != 1) {
+		printf("grace period still running after every reader\n");
+		goto fail;
+	}
+
+	/* Going offline or unregistering releases the grace period. */
+	token = rte_rcu_qsbr_start(v);
+	rte_rcu_qsbr_quiescent(v, 64);
+	rte_rcu_qsbr_thread_offline(v, 3);
+	if (rte_rcu_qsbr_check(v, token, 0) != 1) {
+		printf("offline reader blocked the grace period\n");
+		goto fail;
+	}
+
+	token = rte_rcu_qsbr_start(v);
+	if (rte_rcu_qsbr_thread_unregister(v, 64) != 0 ||
+			v->num_threads != 1 ||
+			rte_rcu_qsbr_check(v, token, 0) != 1) {
+		printf("unregistered reader blocked the grace period\n");
+		goto fail;
+	}
+
+	rte_free(v);
+	return 0;
+fail:
+	rte_free(v);
+	return -1;
+}
+
+static int
+test_rcu_qsbr_dq(void)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	struct rte_rcu_qsbr_dq *dq;
+	struct rte_rcu_qsbr *v;
+	uint32_t i, freed, pending;
+
+	v = test_rcu_alloc(TEST_RCU_MAX_THREADS);
+	if (v == NULL) {
+		printf("cannot allocate QSBR variable\n");
+		return -1;
+	}
+
+	memset(&params, 0, sizeof(params));
+	params.name = "test_rcu_dq";
+	params.socket_id = SOCKET_ID_ANY;
+	params.size = TEST_RCU_DQ_SIZE;
+	params.trigger_reclaim_limit = TEST_RCU_DQ_SIZE;
+	params.max_reclaim_size = TEST_RCU_DQ_SIZE;
+	params.free_fn = test_free_elem;
+	params.v = v;
+
+	dq = rte_rcu_qsbr_dq_create(&params);
+	if (dq == NULL) {
+		printf("cannot create defer queue\n");
+		rte_free(v);
+		return -1;
+	}
+
+	memset((void *)(uintptr_t)t_freed, 0, sizeof(t_freed));
+	rte_rcu_qsbr_thread_register(v, 1);
+	rte_rcu_qsbr_thread_online(v, 1);
+
+	/* Nothing is freed while the reader holds the grace period. */
+	for (i = 0; i < TEST_RCU_DQ_SIZE; i++) {
+		if (rte_rcu_qsbr_dq_enqueue(dq, i) != 0) {
+			printf("cannot enqueue element %u\n", i);
+			goto fail;
+		}
+	}
+	if (rte_rcu_qsbr_dq_enqueue(dq, TEST_RCU_DQ_SIZE) != -ENOSPC) {
+		printf("enqueue into a full blocked queue succeeded\n");
+		goto fail;
+	}
+	rte_rcu_qsbr_dq_reclaim(dq, TEST_RCU_DQ_SIZE, &freed, &pending);
+	if (freed != 0 || pending != TEST_RCU_DQ_SIZE) {
+		printf("reclaimed %u elements of %u before the grace period\n",
+				freed, pending);
+		goto fail;
+	}
+
+	/* A quiescent state releases every element queued before it. */
+	rte_rcu_qsbr_quiescent(v, 1);
+	rte_rcu_qsbr_dq_reclaim(dq, 2, &freed, &pending);
+	if (freed != 2 || pending != TEST_RCU_DQ_SIZE - 2) {
+		printf("reclaim ignored its limit: %u freed, %u pending\n",
+				freed, pending);
+		goto fail;
+	}
+	if (rte_rcu_qsbr_dq_enqueue(dq, TEST_RCU_DQ_SIZE) != 0) {
+		printf("enqueue failed after the grace period\n");
+		goto fail;
+	}
+	rte_rcu_qsbr_dq_reclaim(dq, TEST_RCU_DQ_SIZE, &freed, &pending);
+	if (pending != 1) {
+		printf("element queued after the quiescent state freed\n");
+		goto fail;
+	}
+
+	rte_rcu_qsbr_thread_offline(v, 1);
+	rte_rcu_qsbr_dq_delete(dq);
+
+	for (i = 0; i <= TEST_RCU_DQ_SIZE; i++) {
+		if (t_freed[i] != 1) {
+			printf("element %u freed %u times\n", i, t_freed[i]);
+			rte_free(v);
+			return -1;
+		}
+	}
+
+	rte_free(v);
+	return 0;
+fail:
+	rte_rcu_qsbr_thread_offline(v, 1);
+	rte_rcu_qsbr_dq_delete(dq);
+	rte_free(v);
+	return -1;
+}
+
+static int
+test_rcu_qsbr_reader(__attribute__((unused)) void *arg)
+{
+	unsigned lcore_id = rte_lcore_id();
+	uint32_t e;
+
+	rte_rcu_qsbr_thread_register(t_v, lcore_id);
+	rte_rcu_qsbr_thread_online(t_v, lcore_id);
+
+	while (t_stop == 0) {
+		e = t_current;
+		if (t_elems[e] != ELEM_LIVE)
+			rte_atomic32_inc(&t_errors);
+		rte_rcu_qsbr_quiescent(t_v, lcore_id);
+	}
+
+	rte_rcu_qsbr_thread_offline(t_v, lcore_id);
+	rte_rcu_qsbr_thread_unregister(t_v, lcore_id);
+
+	return 0;
+}
+
+static int
+test_rcu_qsbr_multi_lcore(void)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	struct rte_rcu_qsbr_dq *dq;
+	uint32_t i, e, old;
+	unsigned lcore_id;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough lcores for the multi-lcore RCU test\n");
+		return 0;
+	}
+
+	t_v = test_rcu_alloc(RTE_MAX_LCORE);
+	if (t_v == NULL) {
+		printf("cannot allocate QSBR variable\n");
+		return -1;
+	}
+
+	memset(&params, 0, sizeof(params));
+	params.name = "test_rcu_mt_dq";
+	params.socket_id = SOCKET_ID_ANY;
+	params.size = TEST_RCU_ELEMS - 1;
+	params.trigger_reclaim_limit = TEST_RCU_ELEMS / 2;
+	params.max_reclaim_size = TEST_RCU_ELEMS / 4;
+	params.free_fn = test_free_elem;
+	params.v = t_v;
+
+	dq = rte_rcu_qsbr_dq_create(&params);
+	if (dq == NULL) {
+		printf("cannot create defer queue\n");
+		rte_free(t_v);
+		return -1;
+	}
+
+	for (i = 0; i < TEST_RCU_ELEMS; i++)
+		t_elems[i] = ELEM_FREED;
+	t_current = 0;
+	t_elems[0] = ELEM_LIVE;
+	t_stop = 0;
+	rte_atomic32_init(&t_errors);
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		rte_eal_remote_launch(test_rcu_qsbr_reader, NULL, lcore_id);
+
+	for (i = 0; i < TEST_RCU_ITERATIONS; i++) {
+		/* Find a free element, reclaiming if all are pending. */
+		for (e = 0; e < TEST_RCU_ELEMS; e++)
+			if (t_elems[e] == ELEM_FREED)
+				break;
+		if (e == TEST_RCU_ELEMS) {
+			rte_rcu_qsbr_dq_reclaim(dq, TEST_RCU_ELEMS, NULL, NULL);
+			continue;
+		}
+
+		/* Publish the new element, then retire the old one. */
+		t_elems[e] = ELEM_LIVE;
+		rte_wmb();
+		old = t_current;
+		t_current = e;
+		while (rte_rcu_qsbr_dq_enqueue(dq, old) != 0)
+			rte_pause();
+	}
+
+	t_stop = 1;
+	rte_eal_mp_wait_lcore();
+	rte_rcu_qsbr_dq_delete(dq);
+	rte_free(t_v);
+
+	if (rte_atomic32_read(&t_errors) != 0) {
+		printf("readers saw %d freed elements\n",
+				rte_atomic32_read(&t_errors));
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_rcu_qsbr(void)
+{
+	if (test_rcu_qsbr_params() < 0)
+		return -1;
+
+	if (test_rcu_qsbr_grace_period() < 0)
+		return -1;
+
+	if (test_rcu_qsbr_dq() < 0)
+		return -1;
+
+	if (test_rcu_qsbr_multi_lcore() < 0)
+		return -1;
+
+	return 0;
+}
+
+static struct test_command rcu_qsbr_cmd = {
+	.command = "rcu_qsbr_autotest",
+	.callback = test_rcu_qsbr,
+};
+REGISTER_TEST_COMMAND(rcu_qsbr_cmd);
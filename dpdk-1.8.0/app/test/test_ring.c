@@ -87,6 +87,25 @@
  *        watermark is exceeded
  *      - Check that dequeued pointers are correct
  *
+ *    - Test zero-copy enqueue/dequeue:
+ *
+ *      - Write and read objects directly in the ring slots, across the
+ *        wrap-around of the ring table
+ *      - Commit only a part of a reservation
+ *
+ *    - Test rings of fixed-size elements:
+ *
+ *      - Enqueue and dequeue 4, 8, 12, 16 and 32-byte elements, across
+ *        the wrap-around of the ring table
+ *      - Check that invalid element sizes are refused
+ *
+ *    - Test the RTS and HTS sync modes:
+ *
+ *      - Enqueue and dequeue objects with the default and the mode
+ *        specific functions, across the wrap-around of the ring table
+ *      - Check the full and empty conditions and the htd_max setting
+ *      - Check that conflicting mode flags are refused
+ *
  * #. Check live watermark change
  *
  *    - Start a loop on another lcore that will enqueue and dequeue
@@ -1248,6 +1267,348 @@ test_lookup_null(void)
 	return 0;
 }
 
+/*
+ * it tests the zero-copy enqueue/dequeue, including the wrap-around
+ */
+#define ZC_RING_SIZE 16
+#define ZC_BURST 5
+
+static int
+test_ring_zc(void)
+{
+	struct rte_ring *rp;
+	struct rte_ring_zc_data zcd;
+	uintptr_t enq_val = 0, deq_val = 0;
+	unsigned i, j, n;
+
+	rp = rte_ring_create("test_ring_zc", ZC_RING_SIZE, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (rp == NULL) {
+		printf("test_ring_zc fail to create ring\n");
+		return -1;
+	}
+
+	/* enough iterations to wrap around the ring several times */
+	for (i = 0; i < 4 * ZC_RING_SIZE; i++) {
+		n = rte_ring_sp_enqueue_zc_bulk_start(rp, ZC_BURST, &zcd);
+		if (n != ZC_BURST || zcd.n1 > n ||
+				(zcd.n1 < n && zcd.ptr2 == NULL)) {
+			printf("test_ring_zc: bad enqueue reservation\n");
+			return -1;
+		}
+		for (j = 0; j < n; j++) {
+			if (j < zcd.n1)
+				zcd.ptr1[j] = (void *)enq_val++;
+			else
+				zcd.ptr2[j - zcd.n1] = (void *)enq_val++;
+		}
+		rte_ring_sp_enqueue_zc_finish(rp, n);
+		if (rte_ring_count(rp) != ZC_BURST) {
+			printf("test_ring_zc: objects not enqueued\n");
+			return -1;
+		}
+
+		n = rte_ring_sc_dequeue_zc_burst_start(rp, ZC_RING_SIZE, &zcd);
+		if (n != ZC_BURST) {
+			printf("test_ring_zc: bad dequeue reservation\n");
+			return -1;
+		}
+		for (j = 0; j < n; j++) {
+			void *obj = (j < zcd.n1) ? zcd.ptr1[j] :
+					zcd.ptr2[j - zcd.n1];
+			if (obj != (void *)deq_val++) {
+				printf("test_ring_zc: wrong object dequeued\n");
+				return -1;
+			}
+		}
+		rte_ring_sc_dequeue_zc_finish(rp, n);
+		if (rte_ring_empty(rp) != 1) {
+			printf("test_ring_zc: ring is not empty\n");
+			return -1;
+		}
+	}
+
+	/* only commit a part of the reservation */
+	n = rte_ring_sp_enqueue_zc_burst_start(rp, ZC_RING_SIZE, &zcd);
+	if (n != ZC_RING_SIZE - 1) {
+		printf("test_ring_zc: bad burst reservation\n");
+		return -1;
+	}
+	for (j = 0; j < 3; j++)
+		zcd.ptr1[j] = (void *)enq_val++;
+	rte_ring_sp_enqueue_zc_finish(rp, 3);
+	if (rte_ring_count(rp) != 3) {
+		printf("test_ring_zc: partial enqueue commit failed\n");
+		return -1;
+	}
+
+	/* a fixed reservation bigger than the free room must fail */
+	if (rte_ring_sp_enqueue_zc_bulk_start(rp, ZC_RING_SIZE - 3, &zcd) != 0) {
+		printf("test_ring_zc: enqueue reservation should fail\n");
+		return -1;
+	}
+	if (rte_ring_sc_dequeue_zc_bulk_start(rp, 4, &zcd) != 0) {
+		printf("test_ring_zc: dequeue reservation should fail\n");
+		return -1;
+	}
+
+	/* consume one object, leave the two others in the ring */
+	n = rte_ring_sc_dequeue_zc_bulk_start(rp, 3, &zcd);
+	if (n != 3 || zcd.ptr1[0] != (void *)deq_val) {
+		printf("test_ring_zc: wrong object reserved\n");
+		return -1;
+	}
+	rte_ring_sc_dequeue_zc_finish(rp, 1);
+	if (rte_ring_count(rp) != 2) {
+		printf("test_ring_zc: partial dequeue commit failed\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * it tests rings of fixed-size elements copied inline in the ring
+ */
+#define ELEM_RING_SIZE 64
+#define ELEM_BURST 23
+#define ELEM_MAX_WORDS 8
+
+static int
+test_ring_elem_size(unsigned esize)
+{
+	char name[RTE_RING_NAMESIZE];
+	struct rte_ring *rp;
+	uint32_t src[ELEM_BURST][ELEM_MAX_WORDS];
+	uint32_t dst[ELEM_BURST][ELEM_MAX_WORDS];
+	uint32_t val = 0, expected = 0;
+	unsigned i, j, k, n;
+	const unsigned nwords = esize / sizeof(uint32_t);
+
+	snprintf(name, sizeof(name), "test_ring_elem_%u", esize);
+	rp = rte_ring_create_elem(name, esize, ELEM_RING_SIZE, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (rp == NULL) {
+		printf("test_ring_elem: fail to create ring (esize %u)\n",
+				esize);
+		return -1;
+	}
+
+	/* enough iterations to wrap around the ring several times */
+	for (i = 0; i < 2 * ELEM_RING_SIZE; i++) {
+		/* the element table is packed, fill it word by word */
+		for (j = 0; j < ELEM_BURST; j++)
+			for (k = 0; k < nwords; k++)
+				((uint32_t *)src)[j * nwords + k] = val++;
+
+		if (rte_ring_enqueue_bulk_elem(rp, src, esize, ELEM_BURST) != 0) {
+			printf("test_ring_elem: bulk enqueue failed\n");
+			return -1;
+		}
+		n = rte_ring_dequeue_burst_elem(rp, dst, esize, ELEM_RING_SIZE);
+		if (n != ELEM_BURST) {
+			printf("test_ring_elem: burst dequeue failed\n");
+			return -1;
+		}
+		for (j = 0; j < ELEM_BURST * nwords; j++) {
+			if (((uint32_t *)dst)[j] != expected++) {
+				printf("test_ring_elem: wrong element (esize %u)\n",
+						esize);
+				return -1;
+			}
+		}
+	}
+
+	/* burst enqueue stops when the ring is full */
+	n = 0;
+	for (i = 0; i < ELEM_RING_SIZE / ELEM_BURST + 1; i++)
+		n += rte_ring_mp_enqueue_burst_elem(rp, src, esize, ELEM_BURST);
+	if (n != ELEM_RING_SIZE - 1 || rte_ring_full(rp) != 1) {
+		printf("test_ring_elem: ring should be full\n");
+		return -1;
+	}
+	if (rte_ring_enqueue_elem(rp, src, esize) != -ENOBUFS) {
+		printf("test_ring_elem: enqueue in a full ring\n");
+		return -1;
+	}
+	for (i = 0; i < ELEM_RING_SIZE - 1; i++) {
+		if (rte_ring_mc_dequeue_bulk_elem(rp, dst, esize, 1) != 0) {
+			printf("test_ring_elem: single dequeue failed\n");
+			return -1;
+		}
+	}
+	if (rte_ring_dequeue_elem(rp, dst, esize) != -ENOENT) {
+		printf("test_ring_elem: dequeue from an empty ring\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_ring_elem(void)
+{
+	static const unsigned esizes[] = { 4, 8, 12, 16, 32 };
+	unsigned i;
+
+	for (i = 0; i < sizeof(esizes) / sizeof(esizes[0]); i++)
+		if (test_ring_elem_size(esizes[i]) < 0)
+			return -1;
+
+	/* element size must be a non-zero multiple of 4 */
+	if (rte_ring_create_elem("test_ring_elem_bad", 6, ELEM_RING_SIZE,
+			SOCKET_ID_ANY, 0) != NULL ||
+			rte_ring_create_elem("test_ring_elem_bad", 0,
+			ELEM_RING_SIZE, SOCKET_ID_ANY, 0) != NULL) {
+		printf("test_ring_elem: invalid element size accepted\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * it tests rings whose producers and consumers are in RTS or HTS mode
+ */
+#define SYNC_RING_SIZE 64
+#define SYNC_BURST 7
+
+static int
+test_ring_sync_mode(const char *name, unsigned flags, int is_rts)
+{
+	struct rte_ring *rp;
+	void *src[SYNC_RING_SIZE], *dst[SYNC_RING_SIZE];
+	uintptr_t val = 0, expected = 0;
+	unsigned i, j, n;
+	int ret;
+
+	rp = rte_ring_create(name, SYNC_RING_SIZE, SOCKET_ID_ANY, flags);
+	if (rp == NULL) {
+		printf("%s: fail to create ring\n", name);
+		return -1;
+	}
+
+	/* enough iterations to wrap around the ring several times */
+	for (i = 0; i < 2 * SYNC_RING_SIZE; i++) {
+		for (j = 0; j < SYNC_BURST; j++)
+			src[j] = (void *)val++;
+
+		/* alternate the default and the mode specific functions */
+		if (i & 1)
+			ret = rte_ring_enqueue_bulk(rp, src, SYNC_BURST);
+		else if (is_rts)
+			ret = rte_ring_mp_rts_enqueue_bulk(rp, src, SYNC_BURST);
+		else
+			ret = rte_ring_mp_hts_enqueue_bulk(rp, src, SYNC_BURST);
+		if (ret != 0) {
+			printf("%s: bulk enqueue failed\n", name);
+			return -1;
+		}
+
+		if (i & 1)
+			n = rte_ring_dequeue_burst(rp, dst, SYNC_RING_SIZE);
+		else if (is_rts)
+			n = rte_ring_mc_rts_dequeue_burst(rp, dst,
+					SYNC_RING_SIZE);
+		else
+			n = rte_ring_mc_hts_dequeue_burst(rp, dst,
+					SYNC_RING_SIZE);
+		if (n != SYNC_BURST) {
+			printf("%s: burst dequeue failed\n", name);
+			return -1;
+		}
+		for (j = 0; j < n; j++) {
+			if (dst[j] != (void *)expected++) {
+				printf("%s: wrong object dequeued\n", name);
+				return -1;
+			}
+		}
+		if (rp->prod.head != rp->prod.tail ||
+				rp->cons.head != rp->cons.tail) {
+			printf("%s: head and tail differ\n", name);
+			return -1;
+		}
+	}
+
+	/* fill the ring, one more object must be refused */
+	n = rte_ring_enqueue_burst(rp, src, SYNC_RING_SIZE);
+	if (n != SYNC_RING_SIZE - 1 || rte_ring_full(rp) != 1) {
+		printf("%s: ring should be full\n", name);
+		return -1;
+	}
+	if (rte_ring_enqueue(rp, src[0]) != -ENOBUFS) {
+		printf("%s: enqueue in a full ring\n", name);
+		return -1;
+	}
+	if (rte_ring_dequeue_bulk(rp, dst, SYNC_RING_SIZE - 1) != 0 ||
+			rte_ring_dequeue(rp, &dst[0]) != -ENOENT) {
+		printf("%s: bad dequeue of a full ring\n", name);
+		return -1;
+	}
+
+	/* failed and empty operations must leave the ring usable */
+	if (rte_ring_dequeue_burst(rp, dst, SYNC_BURST) != 0 ||
+			rte_ring_dequeue_bulk(rp, dst, 0) != 0 ||
+			rte_ring_enqueue_bulk(rp, src, 0) != 0 ||
+			rte_ring_enqueue_burst(rp, src, SYNC_RING_SIZE) !=
+			SYNC_RING_SIZE - 1 ||
+			rte_ring_enqueue_burst(rp, src, SYNC_BURST) != 0 ||
+			rte_ring_enqueue_burst(rp, src, 0) != 0 ||
+			rte_ring_dequeue_burst(rp, dst, 0) != 0) {
+		printf("%s: bad operation on an empty or full ring\n", name);
+		return -1;
+	}
+	if (rte_ring_dequeue_bulk(rp, dst, SYNC_RING_SIZE - 1) != 0 ||
+			rte_ring_enqueue_bulk(rp, src, SYNC_BURST) != 0 ||
+			rte_ring_dequeue_bulk(rp, dst, SYNC_BURST) != 0 ||
+			rte_ring_empty(rp) != 1) {
+		printf("%s: ring unusable after failed operations\n", name);
+		return -1;
+	}
+	if (rp->prod.head != rp->prod.tail ||
+			rp->cons.head != rp->cons.tail) {
+		printf("%s: head and tail differ\n", name);
+		return -1;
+	}
+
+	/* the head/tail distance can only be changed in RTS mode */
+	ret = rte_ring_set_prod_htd_max(rp, SYNC_RING_SIZE / 2);
+	if ((is_rts && ret != 0) || (!is_rts && ret != -ENOTSUP)) {
+		printf("%s: bad htd_max setting\n", name);
+		return -1;
+	}
+	if (is_rts && (rte_ring_set_cons_htd_max(rp, SYNC_RING_SIZE) !=
+			-EINVAL || rp->cons.htd_max != SYNC_RING_SIZE / 8)) {
+		printf("%s: invalid htd_max accepted\n", name);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int
+test_ring_sync_modes(void)
+{
+	if (test_ring_sync_mode("test_ring_rts",
+			RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ, 1) < 0)
+		return -1;
+	if (test_ring_sync_mode("test_ring_hts",
+			RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ, 0) < 0)
+		return -1;
+
+	/* only one enqueue mode can be requested */
+	if (rte_ring_create("test_ring_bad_sync", SYNC_RING_SIZE,
+			SOCKET_ID_ANY, RING_F_SP_ENQ | RING_F_MP_RTS_ENQ) != NULL ||
+			rte_ring_create("test_ring_bad_sync", SYNC_RING_SIZE,
+			SOCKET_ID_ANY, RING_F_MC_RTS_DEQ | RING_F_MC_HTS_DEQ) !=
+			NULL) {
+		printf("test_ring_sync_modes: conflicting flags accepted\n");
+		return -1;
+	}
+
+	return 0;
+}
+
 /*
  * it tests some more basic ring operations
  */
@@ -1354,6 +1715,18 @@ test_ring(void)
 	if (test_ring_stats() < 0)
 		return -1;
 
+	/* zero-copy operations */
+	if (test_ring_zc() < 0)
+		return -1;
+
+	/* rings of fixed-size elements */
+	if (test_ring_elem() < 0)
+		return -1;
+
+	/* relaxed tail and head/tail sync modes */
+	if (test_ring_sync_modes() < 0)
+		return -1;
+
 	/* basic operations */
 	if (test_live_watermark_change() < 0)
 		return -1;
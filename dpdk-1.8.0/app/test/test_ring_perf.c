@@ -48,6 +48,10 @@
  *  * Empty ring dequeue
  *  * Enqueue/dequeue of bursts in 1 threads
  *  * Enqueue/dequeue of bursts in 2 threads
+ *  * Zero-copy enqueue/dequeue of bursts compared to the copying path
+ *  * Enqueue/dequeue of bursts of fixed-size elements in 1 thread
+ *  * MP, MP RTS and MP HTS enqueue while another producer is preempted in
+ *    the middle of its enqueue (3 threads)
  */
 
 #define RING_NAME "RING_PERF"
@@ -381,6 +385,276 @@ test_bulk_enqueue_dequeue(void)
 	}
 }
 
+/*
+ * Times an SP/SC stage that writes a burst of objects in the ring and reads
+ * them back, either by copying through a table (burst API) or in place in
+ * the ring slots (zero-copy API).
+ */
+static void
+test_zc_enqueue_dequeue(void)
+{
+	const unsigned iter_shift = 23;
+	const unsigned iterations = 1<<iter_shift;
+	unsigned sz, i, j, n;
+	uintptr_t sum = 0;
+	void *burst[MAX_BURST] = {0};
+	struct rte_ring_zc_data zcd;
+
+	for (sz = 0; sz < sizeof(bulk_sizes)/sizeof(bulk_sizes[0]); sz++) {
+		const unsigned size = bulk_sizes[sz];
+
+		const uint64_t copy_start = rte_rdtsc();
+		for (i = 0; i < iterations; i++) {
+			for (j = 0; j < size; j++)
+				burst[j] = (void *)(uintptr_t)j;
+			rte_ring_sp_enqueue_burst(r, burst, size);
+			n = rte_ring_sc_dequeue_burst(r, burst, size);
+			for (j = 0; j < n; j++)
+				sum += (uintptr_t)burst[j];
+		}
+		const uint64_t copy_end = rte_rdtsc();
+
+		const uint64_t zc_start = rte_rdtsc();
+		for (i = 0; i < iterations; i++) {
+			n = rte_ring_sp_enqueue_zc_burst_start(r, size, &zcd);
+			for (j = 0; j < zcd.n1; j++)
+				zcd.ptr1[j] = (void *)(uintptr_t)j;
+			for (; j < n; j++)
+				zcd.ptr2[j - zcd.n1] = (void *)(uintptr_t)j;
+			rte_ring_sp_enqueue_zc_finish(r, n);
+
+			n = rte_ring_sc_dequeue_zc_burst_start(r, size, &zcd);
+			for (j = 0; j < zcd.n1; j++)
+				sum += (uintptr_t)zcd.ptr1[j];
+			for (; j < n; j++)
+				sum += (uintptr_t)zcd.ptr2[j - zcd.n1];
+			rte_ring_sc_dequeue_zc_finish(r, n);
+		}
+		const uint64_t zc_end = rte_rdtsc();
+
+		printf("SP/SC copy enq/dequeue (size: %u): %.2F\n", size,
+				(double)(copy_end - copy_start) /
+				(iterations * size));
+		printf("SP/SC zero-copy enq/dequeue (size: %u): %.2F\n", size,
+				(double)(zc_end - zc_start) /
+				(iterations * size));
+	}
+
+	/* consume the sum so the object accesses are not optimised out */
+	if (sum == 0)
+		printf("no object read\n");
+}
+
+/*
+ * Times burst enqueue and dequeue of fixed-size elements copied inline in
+ * the ring, on a single lcore.
+ */
+#define ELEM_PERF_MAX_SIZE 32
+
+static void
+test_elem_enqueue_dequeue(void)
+{
+	static const unsigned esizes[] = { 4, 16, ELEM_PERF_MAX_SIZE };
+	const unsigned iter_shift = 23;
+	const unsigned iterations = 1<<iter_shift;
+	uint8_t burst[MAX_BURST * ELEM_PERF_MAX_SIZE] = {0};
+	struct rte_ring *er;
+	char name[RTE_RING_NAMESIZE];
+	unsigned e, sz, i;
+
+	for (e = 0; e < sizeof(esizes)/sizeof(esizes[0]); e++) {
+		const unsigned esize = esizes[e];
+
+		snprintf(name, sizeof(name), "%s_%u", RING_NAME, esize);
+		er = rte_ring_create_elem(name, esize, RING_SIZE,
+				rte_socket_id(), 0);
+		if (er == NULL && (er = rte_ring_lookup(name)) == NULL)
+			return;
+
+		for (sz = 0; sz < sizeof(bulk_sizes)/sizeof(bulk_sizes[0]); sz++) {
+			const unsigned size = bulk_sizes[sz];
+
+			const uint64_t sc_start = rte_rdtsc();
+			for (i = 0; i < iterations; i++) {
+				rte_ring_sp_enqueue_burst_elem(er, burst, esize,
+						size);
+				rte_ring_sc_dequeue_burst_elem(er, burst, esize,
+						size);
+			}
+			const uint64_t sc_end = rte_rdtsc();
+
+			printf("SP/SC %u-byte elem burst enq/dequeue (size: %u): %.2F\n",
+					esize, size, (double)(sc_end - sc_start) /
+					(iterations * size));
+		}
+	}
+}
+
+/*
+ * Lock-holder preemption: one producer stalls between the head and the
+ * tail update of one enqueue out of PREEMPT_PERIOD, as if its vCPU was
+ * descheduled. A second producer measures its enqueue cycles, while a
+ * consumer empties the ring.
+ */
+#define PREEMPT_SLEEP_US 200
+#define PREEMPT_PERIOD 256
+#define PREEMPT_BURST 8
+#define PREEMPT_ITER_SHIFT 20
+
+static volatile int preempt_stop;
+
+struct preempt_params {
+	struct rte_ring *r;
+	uint64_t cycles;      /* output value, total enqueue cycles */
+	uint64_t max_cycles;  /* output value, longest enqueue */
+};
+
+/* enqueue on the ring, with a stall between the head and tail update */
+static void
+enqueue_preempted(struct rte_ring *pr, void * const *burst, unsigned n)
+{
+	uint32_t head, next, free_entries;
+
+	switch (pr->prod.sync_type) {
+	case RTE_RING_SYNC_MT_RTS:
+		if (__rte_ring_rts_move_prod_head(pr, n, RTE_RING_QUEUE_FIXED,
+				&head, &free_entries) == 0)
+			return;
+		__rte_ring_enqueue_elems(pr, head, burst, sizeof(void *), n);
+		rte_delay_us(PREEMPT_SLEEP_US);
+		__rte_ring_rts_update_tail(&pr->prod.head_raw,
+				&pr->prod.tail_raw);
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		if (__rte_ring_hts_move_prod_head(pr, n, RTE_RING_QUEUE_FIXED,
+				&head, &free_entries) == 0)
+			return;
+		__rte_ring_enqueue_elems(pr, head, burst, sizeof(void *), n);
+		rte_delay_us(PREEMPT_SLEEP_US);
+		pr->prod.tail = head + n;
+		break;
+	default:
+		/* same steps as __rte_ring_mp_do_enqueue_elem() */
+		do {
+			head = pr->prod.head;
+			free_entries = pr->prod.mask + pr->cons.tail - head;
+			if (n > free_entries)
+				return;
+			next = head + n;
+		} while (rte_atomic32_cmpset(&pr->prod.head, head, next) == 0);
+		__rte_ring_enqueue_elems(pr, head, burst, sizeof(void *), n);
+		rte_delay_us(PREEMPT_SLEEP_US);
+		while (pr->prod.tail != head)
+			rte_pause();
+		pr->prod.tail = next;
+		break;
+	}
+}
+
+static int
+preempted_producer(void *p)
+{
+	struct preempt_params *params = p;
+	void *burst[PREEMPT_BURST] = {0};
+	unsigned i = 0;
+
+	while (preempt_stop == 0) {
+		if (++i % PREEMPT_PERIOD == 0)
+			enqueue_preempted(params->r, burst, PREEMPT_BURST);
+		else
+			rte_ring_enqueue_bulk(params->r, burst, PREEMPT_BURST);
+	}
+	return 0;
+}
+
+static int
+measured_producer(void *p)
+{
+	const unsigned iterations = 1<<PREEMPT_ITER_SHIFT;
+	struct preempt_params *params = p;
+	void *burst[PREEMPT_BURST] = {0};
+	uint64_t start, cycles;
+	unsigned i;
+
+	params->cycles = 0;
+	params->max_cycles = 0;
+	for (i = 0; i < iterations; i++) {
+		start = rte_rdtsc();
+		while (rte_ring_enqueue_bulk(params->r, burst,
+				PREEMPT_BURST) == -ENOBUFS)
+			rte_pause();
+		cycles = rte_rdtsc() - start;
+
+		params->cycles += cycles;
+		if (cycles > params->max_cycles)
+			params->max_cycles = cycles;
+	}
+	preempt_stop = 1;
+	return 0;
+}
+
+static int
+preempt_consumer(void *p)
+{
+	struct preempt_params *params = p;
+	void *burst[MAX_BURST];
+
+	while (preempt_stop == 0)
+		rte_ring_dequeue_burst(params->r, burst, MAX_BURST);
+	return 0;
+}
+
+static void
+test_preempted_enqueue(void)
+{
+	static const struct {
+		const char *name;
+		unsigned flags;
+	} modes[] = {
+		{ "MP", 0 },
+		{ "MP RTS", RING_F_MP_RTS_ENQ },
+		{ "MP HTS", RING_F_MP_HTS_ENQ },
+	};
+	const unsigned iterations = 1<<PREEMPT_ITER_SHIFT;
+	struct preempt_params params;
+	char name[RTE_RING_NAMESIZE];
+	unsigned lcores[3], lcore_id, nb_lcores = 0, m;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (nb_lcores == 3)
+			break;
+		lcores[nb_lcores++] = lcore_id;
+	}
+	if (nb_lcores < 3) {
+		printf("Need 3 slave lcores, skipping\n");
+		return;
+	}
+
+	for (m = 0; m < sizeof(modes)/sizeof(modes[0]); m++) {
+		snprintf(name, sizeof(name), "%s_PREEMPT_%u", RING_NAME, m);
+		params.r = rte_ring_create(name, RING_SIZE, rte_socket_id(),
+				modes[m].flags);
+		if (params.r == NULL &&
+				(params.r = rte_ring_lookup(name)) == NULL)
+			return;
+
+		preempt_stop = 0;
+		rte_eal_remote_launch(preempt_consumer, &params, lcores[2]);
+		rte_eal_remote_launch(preempted_producer, &params, lcores[0]);
+		rte_eal_remote_launch(measured_producer, &params, lcores[1]);
+		rte_eal_wait_lcore(lcores[1]);
+		rte_eal_wait_lcore(lcores[0]);
+		rte_eal_wait_lcore(lcores[2]);
+
+		printf("%s enqueue with a preempted producer (size: %u): "
+				"%.2F, longest enqueue: %"PRIu64" cycles\n",
+				modes[m].name, PREEMPT_BURST,
+				(double)params.cycles /
+				((uint64_t)iterations * PREEMPT_BURST),
+				params.max_cycles);
+	}
+}
+
 static int
 test_ring_perf(void)
 {
@@ -399,6 +673,12 @@ test_ring_perf(void)
 	printf("\n### Testing using a single lcore ###\n");
 	test_bulk_enqueue_dequeue();
 
+	printf("\n### Testing zero-copy against copying enq/deq ###\n");
+	test_zc_enqueue_dequeue();
+
+	printf("\n### Testing fixed-size elements ###\n");
+	test_elem_enqueue_dequeue();
+
 	if (get_two_hyperthreads(&cores) == 0) {
 		printf("\n### Testing using two hyperthreads ###\n");
 		run_on_core_pair(&cores, enqueue_bulk, dequeue_bulk);
@@ -411,6 +691,9 @@ test_ring_perf(void)
 		printf("\n### Testing using two NUMA nodes ###\n");
 		run_on_core_pair(&cores, enqueue_bulk, dequeue_bulk);
 	}
+
+	printf("\n### Testing sync modes with a preempted producer ###\n");
+	test_preempted_enqueue();
 	return 0;
 }
 
@@ -149,6 +149,106 @@ prepare_pkt(struct rte_mbuf *mbuf)
 	mbuf->data_len = 60;
 }
 
+/**
+ * Split enqueue/dequeue and parallel subport modes, driven from a single lcore
+ */
+static int
+test_sched_multicore(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[10];
+	struct rte_mbuf *out_mbufs[10];
+	uint32_t n_pkts_subport[2] = {0, 0};
+	uint32_t subport, pipe;
+	int i, err;
+
+	params.n_subports_per_port = 2;
+	params.n_pipes_per_subport = 1024;
+
+	/* Invalid flags */
+	params.flags = 0x80;
+	port = rte_sched_port_config(&params);
+	VERIFY(port == NULL, "Port config accepted invalid flags\n");
+
+	/* Enqueue and dequeue on different lcores */
+	params.flags = RTE_SCHED_PORT_FLAG_ENQ_DEQ_SPLIT;
+	port = rte_sched_port_config(&params);
+	VERIFY(port != NULL, "Error config split sched port\n");
+
+	for (subport = 0; subport < params.n_subports_per_port; subport ++) {
+		err = rte_sched_subport_config(port, subport, subport_param);
+		VERIFY(err == 0, "Error config sched subport %u, err=%d\n", subport, err);
+
+		for (pipe = 0; pipe < params.n_pipes_per_subport; pipe ++) {
+			err = rte_sched_pipe_config(port, subport, pipe, 0);
+			VERIFY(err == 0, "Error config sched pipe %u, err=%d\n", pipe, err);
+		}
+	}
+
+	for (i = 0; i < 10; i++) {
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		VERIFY(in_mbufs[i] != NULL, "Error allocating mbuf\n");
+		prepare_pkt(in_mbufs[i]);
+		rte_sched_port_pkt_write(in_mbufs[i], i & 1, PIPE, TC, QUEUE, e_RTE_METER_YELLOW);
+	}
+
+	err = rte_sched_port_enqueue(port, in_mbufs, 10);
+	VERIFY(err == 10, "Wrong split enqueue, err=%d\n", err);
+
+	err = rte_sched_port_dequeue(port, out_mbufs, 10);
+	VERIFY(err == 10, "Wrong split dequeue, err=%d\n", err);
+
+	rte_sched_port_free(port);
+
+	/* Each subport scheduled on its own, then merged */
+	params.flags = RTE_SCHED_PORT_FLAG_SUBPORT_PARALLEL;
+	port = rte_sched_port_config(&params);
+	VERIFY(port != NULL, "Error config parallel sched port\n");
+
+	for (subport = 0; subport < params.n_subports_per_port; subport ++) {
+		err = rte_sched_subport_config(port, subport, subport_param);
+		VERIFY(err == 0, "Error config sched subport %u, err=%d\n", subport, err);
+
+		for (pipe = 0; pipe < params.n_pipes_per_subport; pipe ++) {
+			err = rte_sched_pipe_config(port, subport, pipe, 0);
+			VERIFY(err == 0, "Error config sched pipe %u, err=%d\n", pipe, err);
+		}
+	}
+
+	err = rte_sched_port_enqueue(port, out_mbufs, 10);
+	VERIFY(err == 10, "Wrong parallel enqueue, err=%d\n", err);
+
+	err = rte_sched_port_merge(port, in_mbufs, 10);
+	VERIFY(err == 0, "Merge returned unscheduled packets, err=%d\n", err);
+
+	for (subport = 0; subport < params.n_subports_per_port; subport ++) {
+		err = rte_sched_subport_schedule(port, subport, 10);
+		VERIFY(err == 5, "Wrong subport %u schedule, err=%d\n", subport, err);
+	}
+
+	err = rte_sched_port_merge(port, in_mbufs, 10);
+	VERIFY(err == 10, "Wrong merge, err=%d\n", err);
+
+	for (i = 0; i < 10; i++) {
+		uint32_t traffic_class, queue;
+
+		rte_sched_port_pkt_read_tree_path(in_mbufs[i],
+				&subport, &pipe, &traffic_class, &queue);
+		VERIFY(subport < 2, "Wrong subport\n");
+		VERIFY(pipe == PIPE, "Wrong pipe\n");
+		n_pkts_subport[subport] ++;
+
+		rte_pktmbuf_free(in_mbufs[i]);
+	}
+	VERIFY((n_pkts_subport[0] == 5) && (n_pkts_subport[1] == 5),
+		"Wrong merge distribution: %u, %u\n", n_pkts_subport[0], n_pkts_subport[1]);
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
 
 /**
  * test main entrance for library sched
@@ -209,6 +309,7 @@ test_sched(void)
 		VERIFY(traffic_class == TC, "Wrong traffic_class\n");
 		VERIFY(queue == QUEUE, "Wrong queue\n");
 
+		rte_pktmbuf_free(out_mbufs[i]);
 	}
 
 
@@ -224,7 +325,7 @@ test_sched(void)
 
 	rte_sched_port_free(port);
 
-	return 0;
+	return test_sched_multicore(mp);
 }
 
 static struct test_command sched_cmd = {
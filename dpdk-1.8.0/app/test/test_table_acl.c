@@ -31,7 +31,11 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <netinet/in.h>
+
 #include <rte_hexdump.h>
+#include <rte_random.h>
+#include <rte_byteorder.h>
 #include "test_table.h"
 #include "test_table_acl.h"
 
@@ -361,6 +365,7 @@ setup_acl_pipeline(void)
 		struct rte_table_acl_params acl_params;
 
 		acl_params.n_rules = 1 << 5;
+		acl_params.n_rules_delta = 1 << 3;
 		acl_params.n_rule_fields = DIM(ipv4_defs);
 		snprintf(acl_name, sizeof(acl_name), "ACL%d", i);
 		acl_params.name = acl_name;
@@ -578,6 +583,258 @@ fail:
 
 }
 
+/*
+ * Incremental rule updates: check lookup results against a linear search
+ * through the live rules after every add, delete and merge step.
+ */
+#define ACL_UPD_N_RULES		64
+#define ACL_UPD_N_RULES_DELTA	8
+#define ACL_UPD_N_PKTS		RTE_PORT_IN_BURST_SIZE_MAX
+
+struct acl_upd_rule {
+	struct rte_table_acl_rule_add_params prm;
+	int live;
+};
+
+static struct acl_upd_rule acl_upd_rules[ACL_UPD_N_RULES - 1];
+static struct ipv4_5tuple acl_upd_pkts[ACL_UPD_N_PKTS];
+
+static void
+acl_upd_gen_rule(struct acl_upd_rule *r, uint32_t id)
+{
+	static const uint32_t depths[] = {8, 16, 24, 32};
+	uint32_t i, depth, port;
+
+	memset(r, 0, sizeof(*r));
+	r->prm.priority = id;
+
+	if (rte_rand() & 1) {
+		r->prm.field_value[PROTO_FIELD_IPV4].value.u8 =
+			(rte_rand() & 1) ? IPPROTO_TCP : IPPROTO_UDP;
+		r->prm.field_value[PROTO_FIELD_IPV4].mask_range.u8 = 0xff;
+	}
+
+	for (i = SRC_FIELD_IPV4; i <= DST_FIELD_IPV4; i++) {
+		depth = depths[rte_rand() % RTE_DIM(depths)];
+		r->prm.field_value[i].value.u32 = IPv4(10, rte_rand() % 4,
+			rte_rand() % 4, rte_rand() % 4) &
+			(UINT32_MAX << (32 - depth));
+		r->prm.field_value[i].mask_range.u32 = depth;
+	}
+
+	for (i = SRCP_FIELD_IPV4; i <= DSTP_FIELD_IPV4; i++) {
+		port = (rte_rand() % 8) * 1000;
+		r->prm.field_value[i].value.u16 = port;
+		r->prm.field_value[i].mask_range.u16 = port +
+			rte_rand() % 3000;
+	}
+}
+
+static void
+acl_upd_gen_pkt(struct ipv4_5tuple *pkt, const struct acl_upd_rule *r)
+{
+	const struct rte_acl_field *f = r->prm.field_value;
+	uint32_t mask;
+
+	pkt->proto = (f[PROTO_FIELD_IPV4].mask_range.u8 != 0) ?
+		f[PROTO_FIELD_IPV4].value.u8 :
+		((rte_rand() & 1) ? IPPROTO_TCP : IPPROTO_UDP);
+
+	mask = UINT32_MAX << (32 - f[SRC_FIELD_IPV4].mask_range.u32);
+	pkt->ip_src = f[SRC_FIELD_IPV4].value.u32 | (rte_rand() & ~mask);
+	mask = UINT32_MAX << (32 - f[DST_FIELD_IPV4].mask_range.u32);
+	pkt->ip_dst = f[DST_FIELD_IPV4].value.u32 | (rte_rand() & ~mask);
+
+	pkt->port_src = f[SRCP_FIELD_IPV4].value.u16 + rte_rand() %
+		(f[SRCP_FIELD_IPV4].mask_range.u16 -
+		f[SRCP_FIELD_IPV4].value.u16 + 1);
+	pkt->port_dst = f[DSTP_FIELD_IPV4].value.u16 + rte_rand() %
+		(f[DSTP_FIELD_IPV4].mask_range.u16 -
+		f[DSTP_FIELD_IPV4].value.u16 + 1);
+}
+
+static int
+acl_upd_rule_match(const struct acl_upd_rule *r,
+	const struct ipv4_5tuple *pkt)
+{
+	const struct rte_acl_field *f = r->prm.field_value;
+	uint32_t ip[2] = {pkt->ip_src, pkt->ip_dst};
+	uint16_t port[2] = {pkt->port_src, pkt->port_dst};
+	uint32_t i, mask;
+
+	if ((pkt->proto & f[PROTO_FIELD_IPV4].mask_range.u8) !=
+		f[PROTO_FIELD_IPV4].value.u8)
+		return 0;
+
+	for (i = 0; i != 2; i++) {
+		mask = (f[SRC_FIELD_IPV4 + i].mask_range.u32 == 0) ? 0 :
+			UINT32_MAX << (32 - f[SRC_FIELD_IPV4 + i].mask_range.u32);
+		if ((ip[i] & mask) != f[SRC_FIELD_IPV4 + i].value.u32)
+			return 0;
+		if (port[i] < f[SRCP_FIELD_IPV4 + i].value.u16 ||
+			port[i] > f[SRCP_FIELD_IPV4 + i].mask_range.u16)
+			return 0;
+	}
+
+	return 1;
+}
+
+static int
+acl_upd_check(void *table, const char *step)
+{
+	struct rte_mbuf mbufs[ACL_UPD_N_PKTS], *pkts[ACL_UPD_N_PKTS];
+	struct ipv4_5tuple data[ACL_UPD_N_PKTS];
+	void *entries[ACL_UPD_N_PKTS];
+	uint64_t hit_mask;
+	uint32_t i, j, expected, found;
+
+	for (i = 0; i != ACL_UPD_N_PKTS; i++) {
+		/* ACL expects the input fields in network byte order */
+		data[i] = acl_upd_pkts[i];
+		data[i].ip_src = rte_cpu_to_be_32(data[i].ip_src);
+		data[i].ip_dst = rte_cpu_to_be_32(data[i].ip_dst);
+		data[i].port_src = rte_cpu_to_be_16(data[i].port_src);
+		data[i].port_dst = rte_cpu_to_be_16(data[i].port_dst);
+
+		memset(&mbufs[i], 0, sizeof(mbufs[i]));
+		mbufs[i].buf_addr = &data[i];
+		pkts[i] = &mbufs[i];
+	}
+
+	rte_table_acl_ops.f_lookup(table, pkts, UINT64_MAX, &hit_mask,
+		entries);
+
+	for (i = 0; i != ACL_UPD_N_PKTS; i++) {
+		expected = UINT32_MAX;
+		for (j = 0; j != RTE_DIM(acl_upd_rules); j++) {
+			if (acl_upd_rules[j].live &&
+				acl_upd_rule_match(&acl_upd_rules[j],
+				&acl_upd_pkts[i])) {
+				expected = j;
+				break;
+			}
+		}
+
+		found = ((hit_mask >> i) & 1) ?
+			*(uint32_t *)entries[i] : UINT32_MAX;
+		if (found != expected) {
+			printf("%s: %s: packet %u matches rule %d "
+				"instead of %d\n", __func__, step, i,
+				(int)found, (int)expected);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int
+acl_upd_add(void *table, uint32_t id)
+{
+	void *entry_ptr;
+	int key_found;
+
+	acl_upd_rules[id].live = 1;
+	return rte_table_acl_ops.f_add(table, &acl_upd_rules[id].prm, &id,
+		&key_found, &entry_ptr);
+}
+
+static int
+acl_upd_delete(void *table, uint32_t id)
+{
+	struct rte_table_acl_rule_delete_params prm;
+	int key_found;
+
+	acl_upd_rules[id].live = 0;
+	memcpy(prm.field_value, acl_upd_rules[id].prm.field_value,
+		sizeof(prm.field_value));
+	return rte_table_acl_ops.f_delete(table, &prm, &key_found, NULL);
+}
+
+static int
+test_table_acl_update(void)
+{
+	struct rte_table_acl_params params;
+	void *table;
+	uint32_t i, id, n;
+
+	/* Highest priority rules come first in the list */
+	for (i = 0; i != RTE_DIM(acl_upd_rules); i++)
+		acl_upd_gen_rule(&acl_upd_rules[i], i);
+
+	/* Each packet matches at least one of the rules */
+	for (i = 0; i != RTE_DIM(acl_upd_pkts); i++)
+		acl_upd_gen_pkt(&acl_upd_pkts[i],
+			&acl_upd_rules[i % RTE_DIM(acl_upd_rules)]);
+
+	memset(&params, 0, sizeof(params));
+	params.name = "ACL_UPD";
+	params.n_rules = ACL_UPD_N_RULES;
+	params.n_rules_delta = ACL_UPD_N_RULES_DELTA;
+	params.n_rule_fields = DIM(ipv4_defs);
+	memcpy(params.field_format, ipv4_defs, sizeof(ipv4_defs));
+
+	table = rte_table_acl_ops.f_create(&params, 0, sizeof(uint32_t));
+	if (table == NULL)
+		return -1;
+
+	/* Rules go to the delta table, then get merged every few updates */
+	for (id = 0; id < RTE_DIM(acl_upd_rules); id += 2) {
+		if (acl_upd_add(table, id) != 0 ||
+			acl_upd_check(table, "add") != 0)
+			goto fail;
+	}
+
+	/* Deleted main table rules have to be hidden until next merge */
+	for (n = 0; n != ACL_UPD_N_RULES_DELTA; n++) {
+		id = (rte_rand() % (RTE_DIM(acl_upd_rules) / 2)) * 2;
+		if (acl_upd_rules[id].live == 0)
+			continue;
+		if (acl_upd_delete(table, id) != 0 ||
+			acl_upd_check(table, "delete") != 0)
+			goto fail;
+	}
+
+	/* Merge split in steps, with updates while it is in progress */
+	if (rte_table_acl_merge_start(table) != 0 ||
+		rte_table_acl_merge_start(table) != -EBUSY ||
+		rte_table_acl_merge_finish(table) != -EAGAIN)
+		goto fail;
+
+	for (id = 1; id < RTE_DIM(acl_upd_rules); id += 4) {
+		if (acl_upd_add(table, id) != 0 ||
+			acl_upd_check(table, "add while merging") != 0)
+			goto fail;
+	}
+	for (id = 0; id < RTE_DIM(acl_upd_rules); id += 8) {
+		if (acl_upd_rules[id].live &&
+			(acl_upd_delete(table, id) != 0 ||
+			acl_upd_check(table, "delete while merging") != 0))
+			goto fail;
+	}
+
+	if (rte_table_acl_merge_build(table) != 0 ||
+		acl_upd_check(table, "merge build") != 0 ||
+		rte_table_acl_merge_finish(table) != 0 ||
+		acl_upd_check(table, "merge finish") != 0)
+		goto fail;
+
+	/* Delete everything */
+	for (id = 0; id != RTE_DIM(acl_upd_rules); id++) {
+		if (acl_upd_rules[id].live &&
+			(acl_upd_delete(table, id) != 0 ||
+			acl_upd_check(table, "delete all") != 0))
+			goto fail;
+	}
+
+	rte_table_acl_ops.f_free(table);
+	return 0;
+
+fail:
+	rte_table_acl_ops.f_free(table);
+	return -1;
+}
+
 int
 test_table_ACL(void)
 {
@@ -589,5 +846,8 @@ test_table_ACL(void)
 	if (test_pipeline_single_filter(10) < 0)
 		return -1;
 
+	if (test_table_acl_update() < 0)
+		return -1;
+
 	return 0;
 }
@@ -36,6 +36,7 @@
 #include <rte_log.h>
 #include <inttypes.h>
 #include <rte_hexdump.h>
+#include <rte_cycles.h>
 #include "test_table.h"
 #include "test_table_pipeline.h"
 
@@ -518,6 +519,272 @@ fail:
 
 }
 
+/*
+ * Chain of array tables, the entry of each packet is selected by the value
+ * written at packet meta-data offset 32. The same value is the output port ID
+ * read by action "Send packet to output port read from packet meta-data".
+ */
+#define CHAIN_N_TABLES		3
+#define CHAIN_N_ENTRIES		8
+#define CHAIN_PERF_ITERATIONS	100000
+
+static int
+setup_pipeline_chain(const uint8_t actions[CHAIN_N_TABLES][CHAIN_N_ENTRIES],
+	uint32_t burst_size)
+{
+	struct rte_pipeline_params pipeline_params = {
+		.name = "PIPELINE",
+		.socket_id = 0,
+		.offset_port_id = 32,
+	};
+	struct rte_port_ring_reader_params port_in_params = {
+		.ring = rings_rx[0],
+	};
+	struct rte_pipeline_port_in_params port_params = {
+		.ops = &rte_port_ring_reader_ops,
+		.arg_create = (void *) &port_in_params,
+		.f_action = NULL,
+		.burst_size = burst_size,
+	};
+	struct rte_table_array_params array_params = {
+		.n_entries = CHAIN_N_ENTRIES,
+		.offset = 32,
+	};
+	struct rte_pipeline_table_params table_params = {
+		.ops = &rte_table_array_ops,
+		.arg_create = &array_params,
+		.f_action_hit = NULL,
+		.f_action_miss = NULL,
+		.action_data_size = 0,
+	};
+	uint32_t chain_table_id[CHAIN_N_TABLES];
+	uint32_t i, j;
+
+	p = rte_pipeline_create(&pipeline_params);
+	if (p == NULL)
+		return -1;
+
+	if (rte_pipeline_port_in_create(p, &port_params, &port_in_id[0]))
+		return -1;
+
+	for (i = 0; i < N_PORTS; i++) {
+		struct rte_port_ring_writer_params port_ring_params = {
+			.ring = rings_tx[i],
+			.tx_burst_sz = BURST_SIZE,
+		};
+		struct rte_pipeline_port_out_params port_params = {
+			.ops = &rte_port_ring_writer_ops,
+			.arg_create = (void *) &port_ring_params,
+			.f_action = NULL,
+			.f_action_bulk = NULL,
+			.arg_ah = NULL,
+		};
+
+		if (rte_pipeline_port_out_create(p, &port_params,
+			&port_out_id[i]))
+			return -1;
+	}
+
+	for (i = 0; i < CHAIN_N_TABLES; i++)
+		if (rte_pipeline_table_create(p, &table_params,
+			&chain_table_id[i]))
+			return -1;
+
+	for (i = 0; i < CHAIN_N_TABLES; i++)
+		for (j = 0; j < CHAIN_N_ENTRIES; j++) {
+			struct rte_table_array_key key = {
+				.pos = j,
+			};
+			struct rte_pipeline_table_entry entry = {
+				.action = (enum rte_pipeline_action)
+					actions[i][j],
+				{.port_id = port_out_id[j & 1]},
+			};
+			struct rte_pipeline_table_entry *entry_ptr;
+			int key_found;
+
+			if (entry.action == RTE_PIPELINE_ACTION_TABLE)
+				entry.table_id = chain_table_id[i + 1];
+
+			if (rte_pipeline_table_entry_add(p, chain_table_id[i],
+				&key, &entry, &key_found, &entry_ptr))
+				return -1;
+		}
+
+	if (rte_pipeline_port_in_connect_to_table(p, port_in_id[0],
+		chain_table_id[0]))
+		return -1;
+
+	if (rte_pipeline_port_in_enable(p, port_in_id[0]))
+		return -1;
+
+	return rte_pipeline_check(p);
+}
+
+static int
+test_pipeline_chain_perf(void)
+{
+	static const uint8_t actions[CHAIN_N_TABLES][CHAIN_N_ENTRIES] = {
+		{3, 3, 3, 3, 3, 3, 3, 3},
+		{3, 3, 3, 3, 3, 3, 3, 3},
+		{1, 1, 1, 1, 1, 1, 1, 1},
+	};
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t cycles = 0;
+	uint32_t i, j;
+	int status = 0;
+
+	if (setup_pipeline_chain(actions, RTE_PORT_IN_BURST_SIZE_MAX) < 0)
+		return -1;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+		mbufs[i] = rte_pktmbuf_alloc(pool);
+		if (mbufs[i] == NULL) {
+			while (i--)
+				rte_pktmbuf_free(mbufs[i]);
+			cleanup_pipeline();
+			return -1;
+		}
+		*RTE_MBUF_METADATA_UINT32_PTR(mbufs[i], 32) = i;
+	}
+
+	for (i = 0; (i < CHAIN_PERF_ITERATIONS) && (status == 0); i++) {
+		uint64_t start;
+		uint32_t n_pkts = 0;
+
+		rte_ring_sp_enqueue_bulk(rings_rx[0], (void **) mbufs,
+			RTE_PORT_IN_BURST_SIZE_MAX);
+
+		start = rte_rdtsc();
+		rte_pipeline_run(p);
+		cycles += rte_rdtsc() - start;
+
+		rte_pipeline_flush(p);
+		for (j = 0; j < N_PORTS; j++)
+			n_pkts += rte_ring_sc_dequeue_burst(rings_tx[j],
+				(void **) &mbufs[n_pkts],
+				RTE_PORT_IN_BURST_SIZE_MAX - n_pkts);
+
+		if (n_pkts != RTE_PORT_IN_BURST_SIZE_MAX)
+			status = -1;
+	}
+
+	printf("Pipeline with %u chained tables: %.1f cycles per packet\n",
+		CHAIN_N_TABLES, (double) cycles /
+		((uint64_t) i * RTE_PORT_IN_BURST_SIZE_MAX));
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		rte_pktmbuf_free(mbufs[i]);
+
+	cleanup_pipeline();
+	return status;
+}
+
+/*
+ * Check the statistics of the pipeline built by setup_pipeline_chain() after
+ * one burst of CHAIN_N_ENTRIES packets went through test_pipeline_chain(). All
+ * the counters read as zero when statistics collection is compiled out.
+ */
+static int
+check_pipeline_chain_stats(void)
+{
+#ifdef RTE_PIPELINE_STATS_COLLECT
+	static const uint64_t table_pkts_in[CHAIN_N_TABLES] = {8, 6, 4};
+	static const uint64_t port_out_pkts_in[N_PORTS] = {2, 4};
+	const uint64_t n = 1;
+#else
+	static const uint64_t table_pkts_in[CHAIN_N_TABLES];
+	static const uint64_t port_out_pkts_in[N_PORTS];
+	const uint64_t n = 0;
+#endif
+	struct rte_pipeline_port_in_stats port_in_stats;
+	struct rte_pipeline_port_out_stats port_out_stats;
+	struct rte_pipeline_table_stats table_stats;
+	uint32_t i;
+
+	if (rte_pipeline_port_in_stats_read(p, 0, &port_in_stats, 0) ||
+		(port_in_stats.n_pkts_in != n * CHAIN_N_ENTRIES) ||
+		(port_in_stats.n_pkts_dropped_by_ah != 0))
+		return -1;
+
+	for (i = 0; i < CHAIN_N_TABLES; i++)
+		if (rte_pipeline_table_stats_read(p, i, &table_stats, 1) ||
+			(table_stats.n_pkts_in != table_pkts_in[i]) ||
+			(table_stats.n_pkts_lookup_hit != table_pkts_in[i]) ||
+			(table_stats.n_pkts_lookup_miss != 0) ||
+			(table_stats.n_pkts_dropped_by_lookup_hit_ah != 0) ||
+			(table_stats.n_pkts_dropped_by_lookup_miss_ah != 0) ||
+			((table_stats.n_cycles == 0) != (n == 0)))
+			return -2;
+
+	for (i = 0; i < N_PORTS; i++)
+		if (rte_pipeline_port_out_stats_read(p, i, &port_out_stats,
+			0) ||
+			(port_out_stats.n_pkts_in != port_out_pkts_in[i]) ||
+			(port_out_stats.n_pkts_dropped_by_ah != 0))
+			return -3;
+
+	/* Clear on read */
+	if (rte_pipeline_table_stats_read(p, 0, &table_stats, 0) ||
+		(table_stats.n_pkts_in != 0) || (table_stats.n_cycles != 0))
+		return -4;
+
+	if (rte_pipeline_port_in_stats_read(p, 0, NULL, 1) ||
+		rte_pipeline_port_in_stats_read(p, 0, &port_in_stats, 0) ||
+		(port_in_stats.n_pkts_in != 0))
+		return -5;
+
+	/* Invalid parameters */
+	if ((rte_pipeline_table_stats_read(NULL, 0, &table_stats, 0) == 0) ||
+		(rte_pipeline_table_stats_read(p, CHAIN_N_TABLES,
+			&table_stats, 0) == 0) ||
+		(rte_pipeline_port_in_stats_read(p, 1, &port_in_stats,
+			0) == 0) ||
+		(rte_pipeline_port_out_stats_read(p, N_PORTS,
+			&port_out_stats, 0) == 0))
+		return -6;
+
+	return 0;
+}
+
+static int
+test_pipeline_chain(void)
+{
+	/*
+	 * Table 0 drops packets 0 and 4. Table 1 sends packet 1 to the
+	 * output port read from its meta-data (1) and packet 5 to output
+	 * port 1. Table 2 sends the other packets to output port (value & 1).
+	 */
+	static const uint8_t actions[CHAIN_N_TABLES][CHAIN_N_ENTRIES] = {
+		{0, 3, 3, 3, 0, 3, 3, 3},
+		{3, 2, 3, 3, 3, 1, 3, 3},
+		{1, 1, 1, 1, 1, 1, 1, 1},
+	};
+	uint32_t i;
+	int status;
+
+	if (setup_pipeline_chain(actions, BURST_SIZE) < 0)
+		return -1;
+
+	for (i = 0; i < CHAIN_N_ENTRIES; i++)
+		RING_ENQUEUE(rings_rx[0], i);
+
+	RUN_PIPELINE(p);
+
+	VERIFY_TRAFFIC(rings_tx[0], CHAIN_N_ENTRIES, 2);
+	VERIFY_TRAFFIC(rings_tx[1], CHAIN_N_ENTRIES, 4);
+
+	status = check_pipeline_chain_stats();
+	if (status != 0) {
+		printf("Pipeline statistics check failed (%d)\n", status);
+		return -1;
+	}
+
+	cleanup_pipeline();
+
+	return test_pipeline_chain_perf();
+}
+
 int
 test_table_pipeline(void)
 {
@@ -581,6 +848,10 @@ test_table_pipeline(void)
 		return -1;
 	connect_miss_action_to_table = 0;
 
+	printf("TEST - three chained tables, mixed actions\n");
+	if (test_pipeline_chain() < 0)
+		return -1;
+
 	if (check_pipeline_invalid_params()) {
 		RTE_LOG(INFO, PIPELINE, "%s: Check pipeline invalid params "
 			"failed.\n", __func__);
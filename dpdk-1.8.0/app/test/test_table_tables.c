@@ -46,12 +46,17 @@ table_test table_tests[] = {
 	test_table_lpm_ipv6,
 	test_table_hash_lru,
 	test_table_hash_ext,
+	test_table_hash_cuckoo,
+	test_table_hash_aging,
+	test_table_wildcard,
 };
 
 #define PREPARE_PACKET(mbuf, value) do {				\
 	uint32_t *k32, *signature;					\
 	uint8_t *key;							\
 	mbuf = rte_pktmbuf_alloc(pool);					\
+	if (mbuf == NULL)						\
+		return -1;						\
 	signature = RTE_MBUF_METADATA_UINT32_PTR(mbuf, 0);		\
 	key = RTE_MBUF_METADATA_UINT8_PTR(mbuf, 32);			\
 	memset(key, 0, 32);						\
@@ -67,6 +72,12 @@ static int
 test_table_hash_lru_generic(struct rte_table_ops *ops);
 static int
 test_table_hash_ext_generic(struct rte_table_ops *ops);
+static int
+test_table_hash_cuckoo_generic(struct rte_table_ops *ops);
+static int
+test_table_lpm_perf(void);
+static int
+test_table_array_perf(void);
 
 struct rte_bucket_4_8 {
 	/* Cache line 0 */
@@ -301,6 +312,10 @@ test_table_array(void)
 
 	status = rte_table_array_ops.f_free(table);
 
+	status = test_table_array_perf();
+	if (status < 0)
+		return status;
+
 	return 0;
 }
 
@@ -453,12 +468,44 @@ test_table_lpm(void)
 	if (result_mask != expected_mask)
 		return -21;
 
+	/* Traffic flow: more specific rule, resolved through tbl8 */
+	lpm_key.depth = 28;
+	entry = 'B';
+	status = rte_table_lpm_ops.f_add(table, &lpm_key, &entry, &key_found,
+		&entry_ptr);
+	if (status < 0)
+		return -23;
+
+	rte_table_lpm_ops.f_lookup(table, mbufs, -1,
+		&result_mask, (void **)entries);
+	if (result_mask != expected_mask)
+		return -24;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i += 2)
+		if (*entries[i] != 'B')
+			return -25;
+
+	/* Traffic flow: sparse input packet mask */
+	rte_table_lpm_ops.f_lookup(table, mbufs, 0x0F0F0F0F0F0F0F00LLU,
+		&result_mask, (void **)entries);
+	if (result_mask != (expected_mask & 0x0F0F0F0F0F0F0F00LLU))
+		return -26;
+
+	rte_table_lpm_ops.f_lookup(table, &mbufs[1], 0x7, &result_mask,
+		(void **)entries);
+	if (result_mask != 0x2)
+		return -27;
+
 	/* Free resources */
 	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
 		rte_pktmbuf_free(mbufs[i]);
 
 	status = rte_table_lpm_ops.f_free(table);
 
+	status = test_table_lpm_perf();
+	if (status < 0)
+		return status;
+
 	return 0;
 }
 
@@ -642,6 +689,7 @@ test_table_hash_lru_generic(struct rte_table_ops *ops)
 	/* Create */
 	struct rte_table_hash_key8_lru_params hash_params;
 
+	memset(&hash_params, 0, sizeof(hash_params));
 	hash_params.n_entries = 0;
 
 	table = ops->f_create(&hash_params, 0, 1);
@@ -750,6 +798,7 @@ test_table_hash_ext_generic(struct rte_table_ops *ops)
 	/* Create */
 	struct rte_table_hash_key8_ext_params hash_params;
 
+	memset(&hash_params, 0, sizeof(hash_params));
 	hash_params.n_entries = 0;
 
 	table = ops->f_create(&hash_params, 0, 1);
@@ -901,3 +950,1340 @@ test_table_hash_ext(void)
 
 	return 0;
 }
+
+/* Hash function with good bit dispersion for the key sets used below */
+static uint64_t
+test_hash_mix(void *key, uint32_t key_size, uint64_t seed)
+{
+	uint8_t *k = (uint8_t *) key;
+	uint64_t h = seed;
+	uint32_t i;
+
+	for (i = 0; i < key_size; i += sizeof(uint64_t)) {
+		uint64_t w;
+
+		memcpy(&w, &k[i], sizeof(w));
+		h ^= w;
+		h *= 0xff51afd7ed558ccdLLU;
+		h ^= h >> 33;
+	}
+
+	return h;
+}
+
+#define CUCKOO_N_KEYS		(1 << 16)
+#define CUCKOO_N_BUCKETS	(1 << 13)
+#define CUCKOO_N_KEYS_BULK	60000
+#define CUCKOO_KEY_SIZE		16
+
+static void
+cuckoo_key_set(uint8_t *key, uint32_t value)
+{
+	uint32_t *k32 = (uint32_t *) key;
+
+	memset(key, 0, CUCKOO_KEY_SIZE);
+	k32[0] = value;
+}
+
+static struct rte_mbuf *
+cuckoo_packet(uint32_t value)
+{
+	struct rte_mbuf *mbuf = rte_pktmbuf_alloc(pool);
+	uint8_t *key;
+
+	if (mbuf == NULL)
+		return NULL;
+
+	key = RTE_MBUF_METADATA_UINT8_PTR(mbuf, 32);
+	cuckoo_key_set(key, value);
+	*RTE_MBUF_METADATA_UINT32_PTR(mbuf, 0) =
+		test_hash_mix(key, CUCKOO_KEY_SIZE, 0);
+
+	return mbuf;
+}
+
+/*
+ * Look up the keys value_base + i * value_step, i = 0 .. 63, and return the
+ * lookup hit mask, or 0 on mbuf allocation failure. Each entry found is
+ * checked to store the low byte of its key value.
+ */
+static uint64_t
+cuckoo_lookup(struct rte_table_ops *ops, void *table, uint32_t value_base,
+	uint32_t value_step, int *valid)
+{
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t result_mask = 0;
+	uint32_t i;
+
+	*valid = 1;
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+		mbufs[i] = cuckoo_packet(value_base + i * value_step);
+		if (mbufs[i] == NULL) {
+			while (i--)
+				rte_pktmbuf_free(mbufs[i]);
+			*valid = 0;
+			return 0;
+		}
+	}
+
+	ops->f_lookup(table, mbufs, -1, &result_mask, (void **) entries);
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+		if ((result_mask & (1LLU << i)) &&
+			(*entries[i] != value_base + i * value_step))
+			*valid = 0;
+		rte_pktmbuf_free(mbufs[i]);
+	}
+
+	return result_mask;
+}
+
+static int
+test_table_hash_cuckoo_generic(struct rte_table_ops *ops)
+{
+	int status, i, valid;
+	uint64_t expected_mask = 0, result_mask;
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	void *table;
+	char *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	char entry;
+	int key_found;
+	void *entry_ptr;
+
+	/* Create */
+	struct rte_table_hash_cuckoo_params hash_params;
+
+	memset(&hash_params, 0, sizeof(hash_params));
+	hash_params.key_size = 32;
+	hash_params.n_keys = 1 << 10;
+	hash_params.n_buckets = 1 << 8;
+	hash_params.f_hash = pipeline_test_hash;
+	hash_params.seed = 0;
+	hash_params.signature_offset = 0;
+	hash_params.key_offset = 32;
+
+	hash_params.key_size = 0;
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table != NULL)
+		return -1;
+
+	hash_params.key_size = 24;
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table != NULL)
+		return -1;
+
+	hash_params.key_size = 32;
+	hash_params.n_keys = 0;
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table != NULL)
+		return -2;
+
+	hash_params.n_keys = 1 << 10;
+	hash_params.n_buckets = 1 << 6;
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table != NULL)
+		return -2;
+
+	hash_params.n_buckets = 1 << 8;
+	hash_params.signature_offset = 1;
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table != NULL)
+		return -3;
+
+	hash_params.signature_offset = 0;
+	hash_params.key_offset = 1;
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table != NULL)
+		return -3;
+
+	hash_params.key_offset = 32;
+	hash_params.f_hash = NULL;
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table != NULL)
+		return -4;
+
+	hash_params.f_hash = pipeline_test_hash;
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table == NULL)
+		return -5;
+
+	/* Free */
+	status = ops->f_free(table);
+	if (status < 0)
+		return -6;
+
+	status = ops->f_free(NULL);
+	if (status == 0)
+		return -7;
+
+	/* Add */
+	uint8_t key[32];
+	uint32_t *k32 = (uint32_t *) &key;
+
+	memset(key, 0, 32);
+	k32[0] = rte_be_to_cpu_32(0xadadadad);
+
+	table = ops->f_create(&hash_params, 0, 1);
+	if (table == NULL)
+		return -8;
+
+	entry = 'A';
+	status = ops->f_add(table, &key, &entry, &key_found, &entry_ptr);
+	if ((status != 0) || (key_found != 0))
+		return -9;
+
+	entry = 'B';
+	status = ops->f_add(table, &key, &entry, &key_found, &entry_ptr);
+	if ((status != 0) || (key_found == 0) || (*(char *) entry_ptr != 'B'))
+		return -9;
+
+	/* Delete */
+	status = ops->f_delete(table, &key, &key_found, &entry);
+	if ((status != 0) || (key_found == 0) || (entry != 'B'))
+		return -10;
+
+	status = ops->f_delete(table, &key, &key_found, NULL);
+	if ((status != 0) || (key_found != 0))
+		return -11;
+
+	/* Traffic flow */
+	entry = 'A';
+	status = ops->f_add(table, &key, &entry, &key_found, &entry_ptr);
+	if (status < 0)
+		return -12;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		if (i % 2 == 0) {
+			expected_mask |= (uint64_t)1 << i;
+			PREPARE_PACKET(mbufs[i], 0xadadadad);
+		} else
+			PREPARE_PACKET(mbufs[i], 0xadadadab);
+
+	ops->f_lookup(table, mbufs, -1, &result_mask, (void **)entries);
+	if (result_mask != expected_mask)
+		return -13;
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++)
+		rte_pktmbuf_free(mbufs[i]);
+
+	status = ops->f_free(table);
+
+	/* Bulk add: fill the table up to more than 90% of its key slots */
+	static uint8_t keys_mem[CUCKOO_N_KEYS][CUCKOO_KEY_SIZE];
+	static uint64_t data[CUCKOO_N_KEYS];
+	static void *keys[CUCKOO_N_KEYS];
+	static void *data_ptr[CUCKOO_N_KEYS];
+	static void *entries_ptr[CUCKOO_N_KEYS];
+	static int keys_found[CUCKOO_N_KEYS];
+
+	hash_params.key_size = CUCKOO_KEY_SIZE;
+	hash_params.n_keys = CUCKOO_N_KEYS;
+	hash_params.n_buckets = CUCKOO_N_BUCKETS;
+	hash_params.f_hash = test_hash_mix;
+
+	table = ops->f_create(&hash_params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -14;
+
+	for (i = 0; i < CUCKOO_N_KEYS; i++) {
+		cuckoo_key_set(keys_mem[i], i);
+		data[i] = i;
+		keys[i] = keys_mem[i];
+		data_ptr[i] = &data[i];
+	}
+
+	status = ops->f_add_bulk(table, keys, data_ptr, CUCKOO_N_KEYS_BULK,
+		keys_found, entries_ptr);
+	if (status != 0)
+		return -15;
+
+	for (i = 0; i < CUCKOO_N_KEYS_BULK; i++)
+		if ((keys_found[i] != 0) || (entries_ptr[i] == NULL))
+			return -15;
+
+	/* Entry handles have to survive the key moves of later adds */
+	for (i = 0; i < CUCKOO_N_KEYS_BULK; i++)
+		if (*(uint64_t *) entries_ptr[i] != (uint64_t) i)
+			return -16;
+
+	status = ops->f_add_bulk(table, keys, data_ptr, CUCKOO_N_KEYS_BULK,
+		keys_found, entries_ptr);
+	if (status != 0)
+		return -17;
+
+	for (i = 0; i < CUCKOO_N_KEYS_BULK; i++)
+		if (keys_found[i] == 0)
+			return -17;
+
+	for (i = 0; i < CUCKOO_N_KEYS_BULK; i += RTE_PORT_IN_BURST_SIZE_MAX) {
+		result_mask = cuckoo_lookup(ops, table, i, 1, &valid);
+		if (!valid)
+			return -18;
+		if ((i + RTE_PORT_IN_BURST_SIZE_MAX <= CUCKOO_N_KEYS_BULK) &&
+			(result_mask != (uint64_t) -1))
+			return -18;
+	}
+
+	/* Bulk delete of the even keys */
+	for (i = 0; i < CUCKOO_N_KEYS_BULK / 2; i++)
+		keys[i] = keys_mem[2 * i];
+
+	status = ops->f_delete_bulk(table, keys, CUCKOO_N_KEYS_BULK / 2,
+		keys_found, NULL);
+	if (status != 0)
+		return -19;
+
+	for (i = 0; i < CUCKOO_N_KEYS_BULK / 2; i++)
+		if (keys_found[i] == 0)
+			return -19;
+
+	result_mask = cuckoo_lookup(ops, table, 0, 1, &valid);
+	if (!valid || (result_mask != 0xAAAAAAAAAAAAAAAALLU))
+		return -20;
+
+	status = ops->f_delete_bulk(table, keys, CUCKOO_N_KEYS_BULK / 2,
+		keys_found, NULL);
+	if (status != 0)
+		return -21;
+
+	for (i = 0; i < CUCKOO_N_KEYS_BULK / 2; i++)
+		if (keys_found[i] != 0)
+			return -21;
+
+	/* Bulk add beyond the table capacity */
+	for (i = 0; i < CUCKOO_N_KEYS; i++)
+		keys[i] = keys_mem[i];
+
+	status = ops->f_add_bulk(table, keys, data_ptr, CUCKOO_N_KEYS,
+		keys_found, entries_ptr);
+	if (status == 0)
+		return -22;
+
+	for (i = 0; i < CUCKOO_N_KEYS; i++)
+		if ((entries_ptr[i] != NULL) &&
+			(*(uint64_t *) entries_ptr[i] != (uint64_t) i))
+			return -23;
+
+	status = ops->f_free(table);
+
+	return 0;
+}
+
+#define PERF_N_KEYS		(1 << 16)
+#define PERF_N_BURSTS		16
+#define PERF_ITERATIONS		10000
+
+/*
+ * Run lookups over the same PERF_N_BURSTS bursts and print the cost. Like the
+ * pipeline table actions do, the entry of each lookup hit is read.
+ */
+static volatile uint64_t perf_entry_sum;
+
+static void
+test_table_lookup_perf(const char *name, struct rte_table_ops *ops,
+	void *table, struct rte_mbuf *mbufs[][RTE_PORT_IN_BURST_SIZE_MAX])
+{
+	uint64_t *entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t result_mask, n_hits = 0, sum = 0, start, cycles;
+	uint32_t i, j;
+
+	start = rte_rdtsc();
+	for (i = 0; i < PERF_ITERATIONS; i++)
+		for (j = 0; j < PERF_N_BURSTS; j++) {
+			ops->f_lookup(table, mbufs[j], -1, &result_mask,
+				(void **) entries);
+			n_hits += __builtin_popcountll(result_mask);
+
+			for ( ; result_mask; result_mask &= result_mask - 1)
+				sum += *entries[__builtin_ctzll(result_mask)];
+		}
+	cycles = rte_rdtsc() - start;
+	perf_entry_sum = sum;
+
+	printf("%s: %.1f cycles per packet, %.1f%% hits\n", name,
+		(double) cycles / ((uint64_t) PERF_ITERATIONS *
+		PERF_N_BURSTS * RTE_PORT_IN_BURST_SIZE_MAX),
+		100.0 * n_hits / ((uint64_t) PERF_ITERATIONS *
+		PERF_N_BURSTS * RTE_PORT_IN_BURST_SIZE_MAX));
+}
+
+static int
+test_table_hash_lookup_perf(const char *name, struct rte_table_ops *ops,
+	void *params)
+{
+	struct rte_mbuf *mbufs[PERF_N_BURSTS][RTE_PORT_IN_BURST_SIZE_MAX];
+	uint8_t key[CUCKOO_KEY_SIZE];
+	uint64_t entry;
+	void *table, *entry_ptr;
+	uint32_t i, j;
+	int key_found, status = 0;
+
+	table = ops->f_create(params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -1;
+
+	for (i = 0; i < PERF_N_KEYS / 2; i++) {
+		cuckoo_key_set(key, i * 7);
+		entry = i;
+		ops->f_add(table, key, &entry, &key_found, &entry_ptr);
+	}
+
+	for (i = 0; i < PERF_N_BURSTS; i++)
+		for (j = 0; j < RTE_PORT_IN_BURST_SIZE_MAX; j++) {
+			uint32_t k = (i * RTE_PORT_IN_BURST_SIZE_MAX + j) *
+				2654435761U % (PERF_N_KEYS / 2);
+
+			mbufs[i][j] = cuckoo_packet(k * 7);
+			if (mbufs[i][j] == NULL)
+				status = -2;
+		}
+
+	if (status == 0)
+		test_table_lookup_perf(name, ops, table, mbufs);
+
+	for (i = 0; i < PERF_N_BURSTS; i++)
+		for (j = 0; j < RTE_PORT_IN_BURST_SIZE_MAX; j++)
+			rte_pktmbuf_free(mbufs[i][j]);
+
+	ops->f_free(table);
+	return status;
+}
+
+#define LPM_PERF_N_RULES	(1 << 12)
+#define LPM_PERF_N_RULES_TBL8	64
+#define LPM_PERF_N_NEXT_HOPS	200
+
+static uint32_t
+perf_random(uint32_t i)
+{
+	uint64_t h = (i + 1) * 0x9E3779B97F4A7C15LLU;
+
+	return (uint32_t) (h >> 32);
+}
+
+/*
+ * Packet meta-data at offset 32: IPv4 address in network byte order for the
+ * LPM table, entry position for the array table
+ */
+static int
+test_table_perf_packets(struct rte_mbuf *mbufs[][RTE_PORT_IN_BURST_SIZE_MAX],
+	uint32_t (*f_value)(uint32_t))
+{
+	uint32_t i, j;
+
+	for (i = 0; i < PERF_N_BURSTS; i++)
+		for (j = 0; j < RTE_PORT_IN_BURST_SIZE_MAX; j++) {
+			struct rte_mbuf *m = rte_pktmbuf_alloc(pool);
+
+			mbufs[i][j] = m;
+			if (m == NULL) {
+				for ( ; j > 0; j--)
+					rte_pktmbuf_free(mbufs[i][j - 1]);
+				while (i--)
+					for (j = 0;
+						j < RTE_PORT_IN_BURST_SIZE_MAX;
+						j++)
+						rte_pktmbuf_free(mbufs[i][j]);
+				return -1;
+			}
+
+			*RTE_MBUF_METADATA_UINT32_PTR(m, 32) = f_value(
+				i * RTE_PORT_IN_BURST_SIZE_MAX + j);
+		}
+
+	return 0;
+}
+
+static void
+test_table_perf_packets_free(
+	struct rte_mbuf *mbufs[][RTE_PORT_IN_BURST_SIZE_MAX])
+{
+	uint32_t i, j;
+
+	for (i = 0; i < PERF_N_BURSTS; i++)
+		for (j = 0; j < RTE_PORT_IN_BURST_SIZE_MAX; j++)
+			rte_pktmbuf_free(mbufs[i][j]);
+}
+
+static uint32_t
+lpm_perf_ip(uint32_t i)
+{
+	/* Every fourth packet hits one of the tbl8 rules */
+	if ((i & 3) == 0)
+		return rte_bswap32(perf_random(i % LPM_PERF_N_RULES_TBL8));
+
+	return rte_bswap32(perf_random(LPM_PERF_N_RULES_TBL8 +
+		i % LPM_PERF_N_RULES) ^ (i & 0xFF));
+}
+
+static int
+test_table_lpm_perf(void)
+{
+	struct rte_mbuf *mbufs[PERF_N_BURSTS][RTE_PORT_IN_BURST_SIZE_MAX];
+	struct rte_table_lpm_params lpm_params = {
+		.n_rules = 2 * LPM_PERF_N_RULES,
+		.entry_unique_size = sizeof(uint64_t),
+		.offset = 32,
+	};
+	struct rte_table_lpm_key lpm_key;
+	uint64_t entry;
+	void *table, *entry_ptr;
+	uint32_t i;
+	int key_found;
+
+	table = rte_table_lpm_ops.f_create(&lpm_params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -101;
+
+	/* Rules of depth 28 use tbl8, the others only tbl24 */
+	for (i = 0; i < LPM_PERF_N_RULES_TBL8 + LPM_PERF_N_RULES; i++) {
+		lpm_key.ip = perf_random(i);
+		lpm_key.depth = (i < LPM_PERF_N_RULES_TBL8) ? 28 :
+			16 + i % 9;
+		entry = i % LPM_PERF_N_NEXT_HOPS;
+		if (rte_table_lpm_ops.f_add(table, &lpm_key, &entry,
+			&key_found, &entry_ptr) != 0) {
+			rte_table_lpm_ops.f_free(table);
+			return -102;
+		}
+	}
+
+	if (test_table_perf_packets(mbufs, lpm_perf_ip) != 0) {
+		rte_table_lpm_ops.f_free(table);
+		return -103;
+	}
+
+	test_table_lookup_perf("lpm", &rte_table_lpm_ops, table, mbufs);
+
+	test_table_perf_packets_free(mbufs);
+	rte_table_lpm_ops.f_free(table);
+	return 0;
+}
+
+#define ARRAY_PERF_N_ENTRIES	(1 << 20)
+
+static int
+test_table_array_perf(void)
+{
+	struct rte_mbuf *mbufs[PERF_N_BURSTS][RTE_PORT_IN_BURST_SIZE_MAX];
+	struct rte_table_array_params array_params = {
+		.n_entries = ARRAY_PERF_N_ENTRIES,
+		.offset = 32,
+	};
+	void *table;
+
+	table = rte_table_array_ops.f_create(&array_params, 0,
+		sizeof(uint64_t));
+	if (table == NULL)
+		return -101;
+
+	if (test_table_perf_packets(mbufs, perf_random) != 0) {
+		rte_table_array_ops.f_free(table);
+		return -102;
+	}
+
+	test_table_lookup_perf("array", &rte_table_array_ops, table, mbufs);
+
+	test_table_perf_packets_free(mbufs);
+	rte_table_array_ops.f_free(table);
+	return 0;
+}
+
+static int
+test_table_hash_cuckoo_perf(void)
+{
+	struct rte_table_hash_key16_lru_params lru_params = {
+		.n_entries = PERF_N_KEYS,
+		.f_hash = test_hash_mix,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = 32,
+	};
+	struct rte_table_hash_key16_ext_params ext_params = {
+		.n_entries = PERF_N_KEYS,
+		.n_entries_ext = PERF_N_KEYS / 4,
+		.f_hash = test_hash_mix,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = 32,
+	};
+	struct rte_table_hash_cuckoo_params cuckoo_params = {
+		.key_size = CUCKOO_KEY_SIZE,
+		.n_keys = PERF_N_KEYS,
+		.n_buckets = PERF_N_KEYS / 4,
+		.f_hash = test_hash_mix,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = 32,
+	};
+
+	printf("------------------------------------------\n");
+	printf("Lookup performance, 16-byte key tables...\n");
+	printf("------------------------------------------\n");
+
+	if (test_table_hash_lookup_perf("key16 lru",
+		&rte_table_hash_key16_lru_ops, &lru_params) < 0)
+		return -1;
+
+	if (test_table_hash_lookup_perf("key16 ext",
+		&rte_table_hash_key16_ext_ops, &ext_params) < 0)
+		return -2;
+
+	if (test_table_hash_lookup_perf("cuckoo",
+		&rte_table_hash_cuckoo_ops, &cuckoo_params) < 0)
+		return -3;
+
+	return 0;
+}
+
+int
+test_table_hash_cuckoo(void)
+{
+	int status;
+
+	status = test_table_hash_cuckoo_generic(&rte_table_hash_cuckoo_ops);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_cuckoo_generic(
+		&rte_table_hash_cuckoo_dosig_ops);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_cuckoo_perf();
+	if (status < 0)
+		return status;
+
+	return 0;
+}
+
+#define AGING_N_KEYS		(2 * RTE_PORT_IN_BURST_SIZE_MAX)
+#define AGING_N_HITS		2
+
+struct aging_report {
+	uint32_t n_reported;
+	uint32_t n_invalid;
+	uint64_t n_hits;
+};
+
+/*
+ * Keys below RTE_PORT_IN_BURST_SIZE_MAX are expected to have been hit
+ * n_hits times, the other keys are expected to have never been hit.
+ */
+static void
+aging_report(void *key, void *entry, __rte_unused uint64_t last_hit,
+	uint64_t n_hits, void *arg)
+{
+	struct aging_report *r = (struct aging_report *) arg;
+	uint32_t value = *((uint32_t *) key);
+
+	r->n_reported++;
+	if ((*((uint64_t *) entry) != value) ||
+		(n_hits != ((value < RTE_PORT_IN_BURST_SIZE_MAX) ?
+		r->n_hits : 0)))
+		r->n_invalid++;
+}
+
+static int
+test_table_hash_aging_generic(struct rte_table_ops *ops, void *params,
+	uint32_t *aging, uint32_t n_buckets)
+{
+	struct aging_report report;
+	uint8_t key[CUCKOO_KEY_SIZE];
+	uint64_t entry, result_mask, expire_time;
+	void *table, *entry_ptr;
+	uint32_t i;
+	int key_found, valid, status;
+
+	/* Aging disabled */
+	*aging = 0;
+	table = ops->f_create(params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -1;
+
+	if (ops->f_age(table, UINT64_MAX, n_buckets, 0, NULL, NULL) !=
+		-ENOTSUP)
+		return -2;
+
+	ops->f_free(table);
+
+	/* Aging enabled */
+	*aging = 1;
+	table = ops->f_create(params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -3;
+
+	for (i = 0; i < AGING_N_KEYS; i++) {
+		cuckoo_key_set(key, i);
+		entry = i;
+		if (ops->f_add(table, key, &entry, &key_found, &entry_ptr) != 0)
+			return -4;
+	}
+
+	/* Hit the first half of the keys */
+	expire_time = rte_rdtsc();
+	for (i = 0; i < AGING_N_HITS; i++) {
+		result_mask = cuckoo_lookup(ops, table, 0, 1, &valid);
+		if ((result_mask != UINT64_MAX) || (valid == 0))
+			return -5;
+	}
+
+	/* Report all the entries */
+	memset(&report, 0, sizeof(report));
+	report.n_hits = AGING_N_HITS;
+	status = ops->f_age(table, UINT64_MAX, n_buckets, 0, aging_report,
+		&report);
+	if ((status != AGING_N_KEYS) || (report.n_reported != AGING_N_KEYS) ||
+		(report.n_invalid != 0))
+		return -6;
+
+	/* Incremental scan: each entry is reported exactly once per pass */
+	memset(&report, 0, sizeof(report));
+	report.n_hits = AGING_N_HITS;
+	status = 0;
+	for (i = 0; i < n_buckets; i += 7)
+		status += ops->f_age(table, UINT64_MAX, 7, 0, aging_report,
+			&report);
+	if ((status < AGING_N_KEYS) || (report.n_invalid != 0))
+		return -7;
+
+	/* Expire the keys that were not hit */
+	memset(&report, 0, sizeof(report));
+	status = ops->f_age(table, expire_time, n_buckets, 1, aging_report,
+		&report);
+	if ((status != AGING_N_KEYS / 2) ||
+		(report.n_reported != AGING_N_KEYS / 2) ||
+		(report.n_invalid != 0))
+		return -8;
+
+	result_mask = cuckoo_lookup(ops, table, RTE_PORT_IN_BURST_SIZE_MAX, 1,
+		&valid);
+	if ((result_mask != 0) || (valid == 0))
+		return -9;
+
+	result_mask = cuckoo_lookup(ops, table, 0, 1, &valid);
+	if ((result_mask != UINT64_MAX) || (valid == 0))
+		return -10;
+
+	/* Expired keys can be added back */
+	for (i = RTE_PORT_IN_BURST_SIZE_MAX; i < AGING_N_KEYS; i++) {
+		cuckoo_key_set(key, i);
+		entry = i;
+		if ((ops->f_add(table, key, &entry, &key_found,
+			&entry_ptr) != 0) || (key_found != 0))
+			return -11;
+	}
+
+	memset(&report, 0, sizeof(report));
+	report.n_hits = AGING_N_HITS + 1;
+	status = ops->f_age(table, UINT64_MAX, n_buckets, 1, aging_report,
+		&report);
+	if ((status != AGING_N_KEYS) || (report.n_invalid != 0))
+		return -12;
+
+	result_mask = cuckoo_lookup(ops, table, 0, 1, &valid);
+	if ((result_mask != 0) || (valid == 0))
+		return -13;
+
+	ops->f_free(table);
+	return 0;
+}
+
+int
+test_table_hash_aging(void)
+{
+	struct rte_table_hash_ext_params ext_params = {
+		.key_size = CUCKOO_KEY_SIZE,
+		.n_keys = 1 << 12,
+		.n_buckets = 1 << 10,
+		.n_buckets_ext = 1 << 8,
+		.f_hash = test_hash_mix,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = 32,
+	};
+	struct rte_table_hash_lru_params lru_params = {
+		.key_size = CUCKOO_KEY_SIZE,
+		.n_keys = 1 << 12,
+		.n_buckets = 1 << 10,
+		.f_hash = test_hash_mix,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = 32,
+	};
+	struct rte_table_hash_key16_lru_params key16_lru_params = {
+		.n_entries = 1 << 12,
+		.f_hash = test_hash_mix,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = 32,
+	};
+	struct rte_table_hash_key16_ext_params key16_ext_params = {
+		.n_entries = 1 << 12,
+		.n_entries_ext = 1 << 10,
+		.f_hash = test_hash_mix,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = 32,
+	};
+	struct rte_table_hash_cuckoo_params cuckoo_params = {
+		.key_size = CUCKOO_KEY_SIZE,
+		.n_keys = 1 << 12,
+		.n_buckets = 1 << 9,
+		.f_hash = test_hash_mix,
+		.seed = 0,
+		.signature_offset = 0,
+		.key_offset = 32,
+	};
+	int status;
+
+	status = test_table_hash_aging_generic(&rte_table_hash_ext_ops,
+		&ext_params, &ext_params.aging, 1 << 10);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_aging_generic(&rte_table_hash_lru_ops,
+		&lru_params, &lru_params.aging, 1 << 10);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_aging_generic(&rte_table_hash_key16_lru_ops,
+		&key16_lru_params, &key16_lru_params.aging, 1 << 10);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_aging_generic(&rte_table_hash_key16_ext_ops,
+		&key16_ext_params, &key16_ext_params.aging, 1 << 10);
+	if (status < 0)
+		return status;
+
+	status = test_table_hash_aging_generic(&rte_table_hash_cuckoo_ops,
+		&cuckoo_params, &cuckoo_params.aging, 1 << 9);
+	if (status < 0)
+		return status;
+
+	return 0;
+}
+
+/*
+ * Wildcard table: the key is two 32-bit fields at packet meta-data offset 32,
+ * followed by 8 bytes of zero padding
+ */
+#define WILDCARD_KEY_SIZE	16
+#define WILDCARD_N_RULES	1024
+#define WILDCARD_N_MASKS	8
+#define WILDCARD_N_SLOTS	512
+#define WILDCARD_N_OPS		(1 << 13)
+
+static const uint32_t wildcard_masks[WILDCARD_N_MASKS][2] = {
+	{0xFF000000, 0},
+	{0xFFFF0000, 0},
+	{0xFFFFFF00, 0},
+	{0xFFFFFFFF, 0},
+	{0xFFFF0000, 0xFFFFFFFF},
+	{0xFFFFFF00, 0xFFFFFFFF},
+	{0, 0xFFFFFFFF},
+	{0, 0},
+};
+
+struct wildcard_rule {
+	uint32_t key[2];
+	uint32_t mask[2];
+	int32_t priority;
+	int valid;
+};
+
+static void
+wildcard_key_set(uint8_t *key, uint32_t field0, uint32_t field1)
+{
+	uint32_t *k32 = (uint32_t *) key;
+
+	memset(key, 0, WILDCARD_KEY_SIZE);
+	k32[0] = field0;
+	k32[1] = field1;
+}
+
+static void
+wildcard_rule_set(struct rte_table_wildcard_rule_add_params *rule,
+	uint32_t key0, uint32_t key1, uint32_t mask0, uint32_t mask1,
+	int32_t priority)
+{
+	memset(rule, 0, sizeof(*rule));
+	wildcard_key_set(rule->key, key0, key1);
+	wildcard_key_set(rule->mask, mask0, mask1);
+	rule->priority = priority;
+}
+
+static int
+wildcard_rule_add(void *table, uint32_t key0, uint32_t key1, uint32_t mask0,
+	uint32_t mask1, int32_t priority, uint64_t entry, int *key_found)
+{
+	struct rte_table_wildcard_rule_add_params rule;
+	void *entry_ptr;
+
+	wildcard_rule_set(&rule, key0, key1, mask0, mask1, priority);
+	return rte_table_wildcard_ops.f_add(table, &rule, &entry, key_found,
+		&entry_ptr);
+}
+
+static int
+wildcard_rule_delete(void *table, uint32_t key0, uint32_t key1,
+	uint32_t mask0, uint32_t mask1, int *key_found)
+{
+	struct rte_table_wildcard_rule_delete_params rule;
+
+	wildcard_key_set(rule.key, key0, key1);
+	wildcard_key_set(rule.mask, mask0, mask1);
+	return rte_table_wildcard_ops.f_delete(table, &rule, key_found, NULL);
+}
+
+/*
+ * Look up one burst with the keys (field0[i], field1[i]) and return the lookup
+ * hit mask, or 0 on mbuf allocation failure. The second key field is cleared
+ * again before the mbufs are returned to the shared pool.
+ */
+static uint64_t
+wildcard_lookup(void *table, uint32_t *field0, uint32_t *field1,
+	uint64_t pkts_mask, uint64_t *entries, int *valid)
+{
+	struct rte_mbuf *mbufs[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t *entry_ptrs[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t result_mask = 0;
+	uint32_t i;
+
+	*valid = 1;
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+		mbufs[i] = rte_pktmbuf_alloc(pool);
+		if (mbufs[i] == NULL) {
+			while (i--)
+				rte_pktmbuf_free(mbufs[i]);
+			*valid = 0;
+			return 0;
+		}
+
+		wildcard_key_set(RTE_MBUF_METADATA_UINT8_PTR(mbufs[i], 32),
+			field0[i], field1[i]);
+	}
+
+	rte_table_wildcard_ops.f_lookup(table, mbufs, pkts_mask, &result_mask,
+		(void **) entry_ptrs);
+
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
+		if (result_mask & (1LLU << i))
+			entries[i] = *entry_ptrs[i];
+		wildcard_key_set(RTE_MBUF_METADATA_UINT8_PTR(mbufs[i], 32),
+			0, 0);
+		rte_pktmbuf_free(mbufs[i]);
+	}
+
+	if (result_mask & ~pkts_mask)
+		*valid = 0;
+
+	return result_mask;
+}
+
+static int
+test_table_wildcard_basic(void)
+{
+	struct rte_table_wildcard_params params = {
+		.key_size = WILDCARD_KEY_SIZE,
+		.n_rules = WILDCARD_N_RULES,
+		.n_masks = 4,
+		.key_offset = 32,
+	};
+	uint32_t field0[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t field1[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t result_mask;
+	void *table;
+	uint32_t i;
+	int key_found, valid, status;
+
+	/* Create */
+	params.key_size = 0;
+	if (rte_table_wildcard_ops.f_create(&params, 0, 8) != NULL)
+		return -1;
+	params.key_size = 12;
+	if (rte_table_wildcard_ops.f_create(&params, 0, 8) != NULL)
+		return -2;
+	params.key_size = RTE_TABLE_WILDCARD_KEY_SIZE_MAX + 8;
+	if (rte_table_wildcard_ops.f_create(&params, 0, 8) != NULL)
+		return -3;
+	params.key_size = WILDCARD_KEY_SIZE;
+
+	params.n_rules = 0;
+	if (rte_table_wildcard_ops.f_create(&params, 0, 8) != NULL)
+		return -4;
+	params.n_rules = WILDCARD_N_RULES;
+
+	params.n_masks = 0;
+	if (rte_table_wildcard_ops.f_create(&params, 0, 8) != NULL)
+		return -5;
+	params.n_masks = 4;
+
+	params.key_offset = 36;
+	if (rte_table_wildcard_ops.f_create(&params, 0, 8) != NULL)
+		return -6;
+	params.key_offset = 32;
+
+	table = rte_table_wildcard_ops.f_create(&params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -7;
+
+	/*
+	 * Overlapping rules, the lowest priority value wins:
+	 *   1: 10.0.0.0/8, *          priority 10
+	 *   2: 10.1.0.0/16, *         priority 5
+	 *   3: 10.1.2.0/24, 80        priority 20
+	 *   4: *, *                   priority 100
+	 */
+	status = wildcard_rule_add(table, 0x0A000000, 0, 0xFF000000, 0, 10, 1,
+		&key_found);
+	if ((status != 0) || (key_found != 0))
+		return -8;
+	status = wildcard_rule_add(table, 0x0A010000, 0, 0xFFFF0000, 0, 5, 2,
+		&key_found);
+	if ((status != 0) || (key_found != 0))
+		return -9;
+	status = wildcard_rule_add(table, 0x0A010203, 80, 0xFFFFFF00,
+		0xFFFFFFFF, 20, 3, &key_found);
+	if ((status != 0) || (key_found != 0))
+		return -10;
+	status = wildcard_rule_add(table, 0, 0, 0, 0, 100, 4, &key_found);
+	if ((status != 0) || (key_found != 0))
+		return -11;
+
+	/* Same masked key and mask: update */
+	status = wildcard_rule_add(table, 0x0A0A0A0A, 0, 0xFF000000, 0, 10, 1,
+		&key_found);
+	if ((status != 0) || (key_found != 1))
+		return -12;
+
+	/* Fifth distinct mask */
+	status = wildcard_rule_add(table, 0, 80, 0, 0xFFFFFFFF, 1, 5,
+		&key_found);
+	if (status != -ENOSPC)
+		return -13;
+
+	/* Lookup, packets in groups of 4 */
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i += 4) {
+		field0[i] = 0x0A010203;
+		field1[i] = 80;
+		field0[i + 1] = 0x0A020304;
+		field1[i + 1] = 80;
+		field0[i + 2] = 0x0B000000;
+		field1[i + 2] = 0;
+		field0[i + 3] = 0x0A010299;
+		field1[i + 3] = 81;
+	}
+
+	result_mask = wildcard_lookup(table, field0, field1, -1, entries,
+		&valid);
+	if ((valid == 0) || (result_mask != UINT64_MAX))
+		return -14;
+	for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i += 4)
+		if ((entries[i] != 2) || (entries[i + 1] != 1) ||
+			(entries[i + 2] != 4) || (entries[i + 3] != 2))
+			return -15;
+
+	/* Sparse packet mask */
+	result_mask = wildcard_lookup(table, field0, field1,
+		0xA5A5A5A5A5A5A5A5LLU, entries, &valid);
+	if ((valid == 0) || (result_mask != 0xA5A5A5A5A5A5A5A5LLU))
+		return -16;
+
+	/* Delete rule 2: rule 1 now wins over rule 3 */
+	status = wildcard_rule_delete(table, 0x0A01FFFF, 0, 0xFFFF0000, 0,
+		&key_found);
+	if ((status != 0) || (key_found != 1))
+		return -17;
+	status = wildcard_rule_delete(table, 0x0A010000, 0, 0xFFFF0000, 0,
+		&key_found);
+	if ((status != 0) || (key_found != 0))
+		return -18;
+
+	result_mask = wildcard_lookup(table, field0, field1, -1, entries,
+		&valid);
+	if ((valid == 0) || (result_mask != UINT64_MAX) || (entries[0] != 1) ||
+		(entries[3] != 1))
+		return -19;
+
+	/* Raise the priority of rule 3 */
+	status = wildcard_rule_add(table, 0x0A010200, 80, 0xFFFFFF00,
+		0xFFFFFFFF, 1, 3, &key_found);
+	if ((status != 0) || (key_found != 1))
+		return -20;
+
+	result_mask = wildcard_lookup(table, field0, field1, -1, entries,
+		&valid);
+	if ((valid == 0) || (result_mask != UINT64_MAX) || (entries[0] != 3) ||
+		(entries[1] != 1) || (entries[3] != 1))
+		return -21;
+
+	/* Delete the default rule: third packet of each group misses */
+	status = wildcard_rule_delete(table, 0, 0, 0, 0, &key_found);
+	if ((status != 0) || (key_found != 1))
+		return -22;
+
+	result_mask = wildcard_lookup(table, field0, field1, -1, entries,
+		&valid);
+	if ((valid == 0) || (result_mask != 0xBBBBBBBBBBBBBBBBLLU))
+		return -23;
+
+	/* The mask of rule 2 and of the default rule are free again */
+	status = wildcard_rule_add(table, 0, 80, 0, 0xFFFFFFFF, 1, 5,
+		&key_found);
+	if ((status != 0) || (key_found != 0))
+		return -24;
+	status = wildcard_rule_add(table, 0x0A010000, 0, 0xFFFF0000, 0, 5, 2,
+		&key_found);
+	if ((status != 0) || (key_found != 0))
+		return -25;
+	status = wildcard_rule_add(table, 0, 0, 0, 0, 100, 4, &key_found);
+	if (status != -ENOSPC)
+		return -26;
+
+	rte_table_wildcard_ops.f_free(table);
+
+	/* Rule limit */
+	params.n_rules = 4;
+	table = rte_table_wildcard_ops.f_create(&params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -27;
+
+	for (i = 0; i < 4; i++) {
+		status = wildcard_rule_add(table, i, 0, 0xFFFFFFFF, 0, i, i,
+			&key_found);
+		if ((status != 0) || (key_found != 0))
+			return -28;
+	}
+	status = wildcard_rule_add(table, 4, 0, 0xFFFFFFFF, 0, 4, 4,
+		&key_found);
+	if (status != -ENOSPC)
+		return -29;
+	status = wildcard_rule_delete(table, 0, 0, 0xFFFFFFFF, 0, &key_found);
+	if ((status != 0) || (key_found != 1))
+		return -30;
+	status = wildcard_rule_add(table, 4, 0, 0xFFFFFFFF, 0, 4, 4,
+		&key_found);
+	if ((status != 0) || (key_found != 0))
+		return -31;
+
+	rte_table_wildcard_ops.f_free(table);
+	return 0;
+}
+
+/* Lowest priority value of the rules matching the key, INT32_MAX for none */
+static int32_t
+wildcard_rules_match(struct wildcard_rule *rules, uint32_t field0,
+	uint32_t field1)
+{
+	int32_t priority = INT32_MAX;
+	uint32_t i;
+
+	for (i = 0; i < WILDCARD_N_SLOTS; i++) {
+		struct wildcard_rule *r = &rules[i];
+
+		if (r->valid &&
+			(((field0 ^ r->key[0]) & r->mask[0]) == 0) &&
+			(((field1 ^ r->key[1]) & r->mask[1]) == 0) &&
+			(r->priority < priority))
+			priority = r->priority;
+	}
+
+	return priority;
+}
+
+static uint32_t
+wildcard_random_field0(uint32_t i)
+{
+	return 0x0A000000 | (perf_random(i) & 0x3FFFF);
+}
+
+/*
+ * Random rule add, update and delete, checked after every burst of operations
+ * against a linear search of the same rule set. Each entry is the slot of its
+ * rule, so both the match and its priority get checked.
+ */
+static int
+test_table_wildcard_random(void)
+{
+	struct rte_table_wildcard_params params = {
+		.key_size = WILDCARD_KEY_SIZE,
+		.n_rules = WILDCARD_N_RULES,
+		.n_masks = WILDCARD_N_MASKS,
+		.key_offset = 32,
+	};
+	struct wildcard_rule rules[WILDCARD_N_SLOTS];
+	uint32_t field0[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t field1[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t entries[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t result_mask;
+	void *table;
+	uint32_t i, j, r = 0, n_hits = 0;
+	int key_found, valid, status;
+
+	memset(rules, 0, sizeof(rules));
+
+	table = rte_table_wildcard_ops.f_create(&params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -101;
+
+	status = 0;
+	for (i = 0; (i < WILDCARD_N_OPS) && (status == 0); i++) {
+		uint32_t slot = perf_random(r++) % WILDCARD_N_SLOTS;
+		struct wildcard_rule *rule = &rules[slot];
+
+		if (rule->valid) {
+			rule->valid = 0;
+			if ((wildcard_rule_delete(table, rule->key[0],
+				rule->key[1], rule->mask[0], rule->mask[1],
+				&key_found) != 0) || (key_found != 1))
+				status = -102;
+		} else {
+			const uint32_t *mask =
+				wildcard_masks[perf_random(r++) %
+				WILDCARD_N_MASKS];
+
+			rule->key[0] = wildcard_random_field0(r++) & mask[0];
+			rule->key[1] = (perf_random(r++) & 3) & mask[1];
+			rule->mask[0] = mask[0];
+			rule->mask[1] = mask[1];
+			rule->priority = perf_random(r++) & 0xFFF;
+
+			/* An existing rule with the same key and mask moves */
+			for (j = 0; j < WILDCARD_N_SLOTS; j++)
+				if (rules[j].valid &&
+					(rules[j].key[0] == rule->key[0]) &&
+					(rules[j].key[1] == rule->key[1]) &&
+					(rules[j].mask[0] == rule->mask[0]) &&
+					(rules[j].mask[1] == rule->mask[1]))
+					break;
+			if (j < WILDCARD_N_SLOTS)
+				rules[j].valid = 0;
+			rule->valid = 1;
+
+			if ((wildcard_rule_add(table, rule->key[0],
+				rule->key[1], rule->mask[0], rule->mask[1],
+				rule->priority, slot, &key_found) != 0) ||
+				(key_found != (j < WILDCARD_N_SLOTS)))
+				status = -103;
+		}
+
+		if ((i % RTE_PORT_IN_BURST_SIZE_MAX) != 0)
+			continue;
+
+		for (j = 0; j < RTE_PORT_IN_BURST_SIZE_MAX; j++) {
+			field0[j] = wildcard_random_field0(r++);
+			field1[j] = perf_random(r++) & 3;
+		}
+
+		result_mask = wildcard_lookup(table, field0, field1, -1,
+			entries, &valid);
+		if (valid == 0)
+			status = -104;
+
+		for (j = 0; j < RTE_PORT_IN_BURST_SIZE_MAX; j++) {
+			int32_t priority = wildcard_rules_match(rules,
+				field0[j], field1[j]);
+			struct wildcard_rule *match;
+
+			if ((result_mask & (1LLU << j)) == 0) {
+				if (priority != INT32_MAX)
+					status = -105;
+				continue;
+			}
+
+			n_hits++;
+			if (entries[j] >= WILDCARD_N_SLOTS) {
+				status = -106;
+				continue;
+			}
+
+			match = &rules[entries[j]];
+			if ((match->valid == 0) ||
+				(match->priority != priority) ||
+				((field0[j] & match->mask[0]) !=
+				match->key[0]) ||
+				((field1[j] & match->mask[1]) !=
+				match->key[1]))
+				status = -106;
+		}
+	}
+
+	/* Some lookups should hit, some miss */
+	if ((status == 0) && ((n_hits == 0) ||
+		(n_hits == (WILDCARD_N_OPS / RTE_PORT_IN_BURST_SIZE_MAX) *
+		RTE_PORT_IN_BURST_SIZE_MAX)))
+		status = -107;
+
+	rte_table_wildcard_ops.f_free(table);
+	return status;
+}
+
+#define WILDCARD_PERF_N_RULES	(1 << 12)
+
+static uint32_t
+wildcard_perf_field0(uint32_t i)
+{
+	return 0x0A000000 | (perf_random(i) & 0xFFFFF);
+}
+
+static int
+test_table_wildcard_perf(void)
+{
+	struct rte_mbuf *mbufs[PERF_N_BURSTS][RTE_PORT_IN_BURST_SIZE_MAX];
+	struct rte_table_wildcard_params params = {
+		.key_size = WILDCARD_KEY_SIZE,
+		.n_rules = WILDCARD_PERF_N_RULES,
+		.n_masks = WILDCARD_N_MASKS,
+		.key_offset = 32,
+	};
+	void *table;
+	uint32_t i;
+	int key_found;
+
+	table = rte_table_wildcard_ops.f_create(&params, 0, sizeof(uint64_t));
+	if (table == NULL)
+		return -201;
+
+	/* Rules over the first four masks, the more specific ones first */
+	for (i = 0; i < WILDCARD_PERF_N_RULES; i++) {
+		const uint32_t *mask = wildcard_masks[3 - (i & 3)];
+
+		if (wildcard_rule_add(table, wildcard_perf_field0(i) & mask[0],
+			0, mask[0], 0, i & 3, i, &key_found) != 0) {
+			rte_table_wildcard_ops.f_free(table);
+			return -202;
+		}
+	}
+
+	if (test_table_perf_packets(mbufs, wildcard_perf_field0) != 0) {
+		rte_table_wildcard_ops.f_free(table);
+		return -203;
+	}
+
+	test_table_lookup_perf("wildcard", &rte_table_wildcard_ops, table,
+		mbufs);
+
+	test_table_perf_packets_free(mbufs);
+	rte_table_wildcard_ops.f_free(table);
+	return 0;
+}
+
+int
+test_table_wildcard(void)
+{
+	int status;
+
+	status = test_table_wildcard_basic();
+	if (status < 0)
+		return status;
+
+	status = test_table_wildcard_random();
+	if (status < 0)
+		return status;
+
+	return test_table_wildcard_perf();
+}
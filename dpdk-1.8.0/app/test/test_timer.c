@@ -112,10 +112,38 @@
  *      - At initialization, timer3 is loaded by the master core, on
  *        another core in "periodical" mode (time = 1 second).
  *      - It is stopped at t=25s by timer2.
+ *
+ * #. Timer wheel test.
+ *
+ *    This test checks the timer wheel backend on the master core, with a
+ *    one cycle resolution so that the timers spread over all the levels
+ *    of the wheel within one second.
+ *
+ *    - Timers are loaded with random delays of up to one second, and a
+ *      few beyond the span of the wheel.
+ *    - One timer in four is then stopped and one in four is reloaded
+ *      while pending.
+ *    - A periodic timer runs during the whole test.
+ *    - The test checks that each timer expired exactly once, not before
+ *      its expiry time, except for the stopped ones.
+ *
+ *    Then the stress test 2 is run again with the timer wheel backend.
+ *
+ * #. Mailbox stress test.
+ *
+ *    This test checks the cross-lcore requests posted to the lcore
+ *    mailboxes, with both backends.
+ *
+ *    - All cores stop and reset at random their own share of a set of
+ *      timers, all scheduled on the master lcore, which calls
+ *      rte_timer_manage() between its own requests.
+ *    - Each core finally resets its timers, then the test checks that
+ *      each timer expired exactly once on the master lcore.
  */
 
 #include <stdio.h>
 #include <stdarg.h>
+#include <errno.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdint.h>
@@ -248,9 +276,12 @@ timer_stress2_main_loop(__attribute__((unused)) void *arg)
 {
 	static struct rte_timer *timers;
 	int i;
+	/* 1 while scheduling the timers, 2 while stopping and resetting them */
 	static volatile int ready = 0;
+	static rte_atomic32_t n_done;
 	uint64_t delay = rte_get_timer_hz() / 4;
 	unsigned lcore_id = rte_lcore_id();
+	int n_slaves = rte_lcore_count() - 1;
 
 	if (lcore_id == rte_get_master_lcore()) {
 		timers = rte_malloc(NULL, sizeof(*timers) * NB_STRESS2_TIMERS, 0);
@@ -261,9 +292,10 @@ timer_stress2_main_loop(__attribute__((unused)) void *arg)
 		}
 		for (i = 0; i < NB_STRESS2_TIMERS; i++)
 			rte_timer_init(&timers[i]);
+		rte_atomic32_set(&n_done, 0);
 		ready = 1;
 	} else {
-		while (!ready)
+		while (ready != 1)
 			rte_pause();
 	}
 
@@ -272,7 +304,12 @@ timer_stress2_main_loop(__attribute__((unused)) void *arg)
 		rte_timer_reset(&timers[i], delay, SINGLE, rte_get_master_lcore(),
 				timer_stress2_cb, NULL);
 
-	ready = 0;
+	/* the master waits for the other cores, which wait for its check */
+	if (lcore_id == rte_get_master_lcore()) {
+		while (rte_atomic32_read(&n_done) != n_slaves)
+			rte_pause();
+	} else
+		rte_atomic32_inc(&n_done);
 	rte_delay_ms(500);
 
 	/* now check that we get the right number of callbacks */
@@ -285,9 +322,9 @@ timer_stress2_main_loop(__attribute__((unused)) void *arg)
 					cb_count);
 			return -1;
 		}
-		ready  = 1;
+		ready = 2;
 	} else {
-		while (!ready)
+		while (ready != 2)
 			rte_pause();
 	}
 
@@ -306,6 +343,12 @@ timer_stress2_main_loop(__attribute__((unused)) void *arg)
 				timer_stress2_cb, NULL);
 	}
 
+	if (lcore_id == rte_get_master_lcore()) {
+		while (rte_atomic32_read(&n_done) != 2 * n_slaves)
+			rte_pause();
+		ready = 0;
+	} else
+		rte_atomic32_inc(&n_done);
 	rte_delay_ms(500);
 
 	/* now check that we get the right number of callbacks */
@@ -324,6 +367,224 @@ timer_stress2_main_loop(__attribute__((unused)) void *arg)
 	return 0;
 }
 
+#define NB_WHEEL_TIMERS 4096
+#define NB_WHEEL_FAR_TIMERS 4
+
+struct wheeltimerinfo {
+	struct rte_timer tim;
+	unsigned count;
+};
+
+static unsigned wheel_cb_count;
+static unsigned wheel_cb_early;
+
+/* callback for the timer wheel test */
+static void
+timer_wheel_cb(struct rte_timer *tim, void *arg)
+{
+	struct wheeltimerinfo *timinfo = arg;
+
+	if (rte_get_timer_cycles() < tim->expire)
+		wheel_cb_early++;
+
+	timinfo->count++;
+	wheel_cb_count++;
+}
+
+#define NB_MBOX_TIMERS 4096
+#define NB_MBOX_REQUESTS 20000
+
+static rte_atomic32_t mbox_n_done;
+static volatile int mbox_failed;
+
+static int
+timer_mbox_main_loop(__attribute__((unused)) void *arg)
+{
+	static struct rte_timer *timers;
+	static volatile int ready = 0;
+	uint64_t hz = rte_get_timer_hz();
+	unsigned lcore_id = rte_lcore_id();
+	unsigned master = rte_get_master_lcore();
+	unsigned n_lcores = rte_lcore_count();
+	unsigned idx = rte_lcore_index(lcore_id);
+	int i;
+
+	if (lcore_id == master) {
+		timers = rte_malloc(NULL, sizeof(*timers) * NB_MBOX_TIMERS, 0);
+		if (timers == NULL) {
+			printf("Test Failed\n");
+			printf("- Cannot allocate memory for timers\n");
+			mbox_failed = 1;
+			return -1;
+		}
+		for (i = 0; i < NB_MBOX_TIMERS; i++)
+			rte_timer_init(&timers[i]);
+		rte_atomic32_set(&mbox_n_done, 0);
+		cb_count = 0;
+		ready = 1;
+	} else {
+		while (!ready)
+			rte_pause();
+	}
+
+	/* stop or reset, far in the future, random timers of this core; the
+	 * resets of the other cores wait in the master lcore mailbox */
+	for (i = 0; i < NB_MBOX_REQUESTS; i++) {
+		int r = (rand() % (NB_MBOX_TIMERS / n_lcores)) * n_lcores + idx;
+
+		if (lcore_id == master)
+			rte_timer_manage();
+		if (i % 2) {
+			/* the timer can be freed at once */
+			rte_timer_stop_sync(&timers[r]);
+			if (timers[r].status.state != RTE_TIMER_STOP) {
+				printf("- Timer not stopped by stop_sync\n");
+				mbox_failed = 1;
+			}
+		} else
+			rte_timer_reset_sync(&timers[r], 10 * hz, SINGLE,
+				master, timer_stress2_cb, NULL);
+	}
+
+	/* now reset all the timers of this core to expire soon */
+	for (i = idx; i < NB_MBOX_TIMERS; i += n_lcores) {
+		if (lcore_id == master)
+			rte_timer_manage();
+		rte_timer_reset_sync(&timers[i], hz / 10, SINGLE, master,
+			timer_stress2_cb, NULL);
+	}
+	rte_atomic32_inc(&mbox_n_done);
+
+	if (lcore_id != master)
+		return 0;
+
+	/* keep applying the requests until all cores are done */
+	while (rte_atomic32_read(&mbox_n_done) != (int)n_lcores)
+		rte_timer_manage();
+
+	rte_delay_ms(200);
+	rte_timer_manage();
+	ready = 0;
+
+	if (cb_count != NB_MBOX_TIMERS) {
+		printf("Test Failed\n");
+		printf("- Mailbox stress test failed\n");
+		printf("- Expected %d callbacks, got %d\n", NB_MBOX_TIMERS,
+				cb_count);
+		mbox_failed = 1;
+		return -1;
+	}
+
+	rte_free(timers);
+	return 0;
+}
+
+static int
+timer_wheel_check(void)
+{
+	struct wheeltimerinfo *timinfo, periodic;
+	uint64_t hz = rte_get_timer_hz();
+	uint64_t far = (1ULL << 32) + hz / 10;
+	uint64_t end;
+	unsigned i, n_expected;
+	int ret = -1;
+
+	if (rte_timer_subsystem_backend_set(RTE_TIMER_BACKEND_WHEEL, 0) !=
+			-EINVAL) {
+		printf("Timer wheel with null resolution accepted\n");
+		return -1;
+	}
+
+	if (rte_timer_subsystem_backend_set(RTE_TIMER_BACKEND_WHEEL, 1) != 0) {
+		printf("Cannot select the timer wheel backend\n");
+		return -1;
+	}
+
+	timinfo = rte_zmalloc(NULL, sizeof(*timinfo) * NB_WHEEL_TIMERS, 0);
+	if (timinfo == NULL) {
+		printf("Cannot allocate memory for timers\n");
+		goto end;
+	}
+
+	wheel_cb_count = 0;
+	wheel_cb_early = 0;
+	for (i = 0; i < NB_WHEEL_TIMERS; i++) {
+		uint64_t ticks = (i < NB_WHEEL_FAR_TIMERS) ?
+			far + i : rte_rand() % hz;
+
+		rte_timer_init(&timinfo[i].tim);
+		rte_timer_reset(&timinfo[i].tim, ticks, SINGLE,
+			rte_lcore_id(), timer_wheel_cb, &timinfo[i]);
+	}
+
+	memset(&periodic, 0, sizeof(periodic));
+	rte_timer_init(&periodic.tim);
+	rte_timer_reset(&periodic.tim, hz / 100, PERIODICAL, rte_lcore_id(),
+		timer_wheel_cb, &periodic);
+
+	if (rte_timer_subsystem_backend_set(RTE_TIMER_BACKEND_SKIPLIST, 0) !=
+			-EBUSY) {
+		printf("Timer backend changed with pending timers\n");
+		goto end;
+	}
+
+	/* stop one timer in four, reload one in four */
+	n_expected = 0;
+	for (i = NB_WHEEL_FAR_TIMERS; i < NB_WHEEL_TIMERS; i++) {
+		if ((i & 3) == 0) {
+			rte_timer_stop(&timinfo[i].tim);
+			continue;
+		}
+		if ((i & 3) == 1)
+			rte_timer_reset(&timinfo[i].tim, rte_rand() % hz,
+				SINGLE, rte_lcore_id(), timer_wheel_cb,
+				&timinfo[i]);
+		n_expected++;
+	}
+	n_expected += NB_WHEEL_FAR_TIMERS;
+
+	end = rte_get_timer_cycles() + far + hz / 10;
+	while (wheel_cb_count - periodic.count < n_expected &&
+			rte_get_timer_cycles() < end)
+		rte_timer_manage();
+
+	rte_timer_stop_sync(&periodic.tim);
+
+	for (i = 0; i < NB_WHEEL_TIMERS; i++) {
+		unsigned count = (i >= NB_WHEEL_FAR_TIMERS && (i & 3) == 0) ?
+			0 : 1;
+
+		if (timinfo[i].count != count ||
+				rte_timer_pending(&timinfo[i].tim)) {
+			printf("Timer %u expired %u times\n", i,
+				timinfo[i].count);
+			goto end;
+		}
+	}
+
+	if (periodic.count < 10 || wheel_cb_early != 0) {
+		printf("Periodic timer expired %u times, %u early callbacks\n",
+			periodic.count, wheel_cb_early);
+		goto end;
+	}
+
+	printf("Timer wheel: %u timers expired, periodic timer expired %u "
+		"times\n", n_expected, periodic.count);
+	ret = 0;
+
+end:
+	if (ret != 0)
+		for (i = 0; i < NB_WHEEL_TIMERS && timinfo != NULL; i++)
+			rte_timer_stop_sync(&timinfo[i].tim);
+	rte_free(timinfo);
+
+	if (rte_timer_subsystem_backend_set(RTE_TIMER_BACKEND_SKIPLIST, 0) !=
+			0)
+		ret = -1;
+
+	return ret;
+}
+
 /* timer callback for basic tests */
 static void
 timer_basic_cb(struct rte_timer *tim, void *arg)
@@ -469,6 +730,11 @@ test_timer(void)
 		return -1;
 	}
 
+	if (timer_wheel_check() < 0) {
+		printf("Timer wheel test failed\n");
+		return -1;
+	}
+
 	if (rte_lcore_count() < 2) {
 		printf("not enough lcores for this test\n");
 		return -1;
@@ -514,6 +780,53 @@ test_timer(void)
 		rte_timer_stop_sync(&mytiminfo[i].tim);
 	}
 
+	/* run the stress tests 2 again with the timer wheel */
+	if (rte_timer_subsystem_backend_set(RTE_TIMER_BACKEND_WHEEL,
+			hz / 100000) != 0) {
+		printf("Cannot select the timer wheel backend\n");
+		return -1;
+	}
+
+	printf("Start timer stress tests 2 with the timer wheel\n");
+	cb_count = 0;
+	rte_eal_mp_remote_launch(timer_stress2_main_loop, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+
+	if (rte_timer_subsystem_backend_set(RTE_TIMER_BACKEND_SKIPLIST, 0)) {
+		printf("Timers left pending by stress tests 2\n");
+		return -1;
+	}
+
+	/* run the mailbox stress test with both backends */
+	if (rte_timer_subsystem_mailbox_set(1) != 0) {
+		printf("Cannot enable the timer mailboxes\n");
+		return -1;
+	}
+
+	printf("Start timer mailbox stress tests\n");
+	rte_eal_mp_remote_launch(timer_mbox_main_loop, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+	if (mbox_failed)
+		return -1;
+
+	if (rte_timer_subsystem_backend_set(RTE_TIMER_BACKEND_WHEEL,
+			hz / 100000) != 0) {
+		printf("Cannot select the timer wheel backend\n");
+		return -1;
+	}
+
+	printf("Start timer mailbox stress tests with the timer wheel\n");
+	rte_eal_mp_remote_launch(timer_mbox_main_loop, NULL, CALL_MASTER);
+	rte_eal_mp_wait_lcore();
+	if (mbox_failed)
+		return -1;
+
+	if (rte_timer_subsystem_backend_set(RTE_TIMER_BACKEND_SKIPLIST, 0) ||
+			rte_timer_subsystem_mailbox_set(0)) {
+		printf("Timers left pending by mailbox stress tests\n");
+		return -1;
+	}
+
 	rte_timer_dump_stats(stdout);
 
 	return 0;
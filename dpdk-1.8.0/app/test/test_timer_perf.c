@@ -62,19 +62,13 @@ timer_cb(struct rte_timer *t __rte_unused, void *param __rte_unused)
 #endif
 
 static int
-test_timer_perf(void)
+timer_perf_run(struct rte_timer *tms)
 {
 	unsigned iterations = 100;
 	unsigned i;
-	struct rte_timer *tms;
 	uint64_t start_tsc, end_tsc, delay_start;
 	unsigned lcore_id = rte_lcore_id();
 
-	tms = rte_malloc(NULL, sizeof(*tms) * MAX_ITERATIONS, 0);
-
-	for (i = 0; i < MAX_ITERATIONS; i++)
-		rte_timer_init(&tms[i]);
-
 	const uint64_t ticks = rte_get_timer_hz() * DELAY_SECONDS;
 	const uint64_t ticks_per_ms = rte_get_tsc_hz()/1000;
 	const uint64_t ticks_per_us = ticks_per_ms/1000;
@@ -87,6 +81,18 @@ test_timer_perf(void)
 			rte_timer_reset(&tms[i], ticks, SINGLE, lcore_id,
 					timer_cb, NULL);
 		end_tsc = rte_rdtsc();
+		printf("Time for %u timers: %"PRIu64" (%"PRIu64"ms), ", iterations,
+				end_tsc-start_tsc, (end_tsc-start_tsc+ticks_per_ms/2)/(ticks_per_ms));
+		printf("Time per timer: %"PRIu64" (%"PRIu64"us)\n",
+				(end_tsc-start_tsc)/iterations,
+				((end_tsc-start_tsc)/iterations+ticks_per_us/2)/(ticks_per_us));
+
+		printf("Re-arming %u pending timers\n", iterations);
+		start_tsc = rte_rdtsc();
+		for (i = 0; i < iterations; i++)
+			rte_timer_reset(&tms[i], ticks, SINGLE, lcore_id,
+					timer_cb, NULL);
+		end_tsc = rte_rdtsc();
 		printf("Time for %u timers: %"PRIu64" (%"PRIu64"ms), ", iterations,
 				end_tsc-start_tsc, (end_tsc-start_tsc+ticks_per_ms/2)/(ticks_per_ms));
 		printf("Time per timer: %"PRIu64" (%"PRIu64"us)\n",
@@ -154,10 +160,50 @@ test_timer_perf(void)
 	end_tsc = rte_rdtsc();
 	printf("Time per rte_timer_manage with zero callbacks: %"PRIu64" cycles\n",
 			(end_tsc - start_tsc + iterations/2) / iterations);
+	rte_timer_stop(&tms[0]);
 
 	return 0;
 }
 
+/* compare the skiplist and the timer wheel (1 us tick) backends */
+static int
+test_timer_perf(void)
+{
+	static const char * const names[] = {"skiplist", "timer wheel"};
+	static const enum rte_timer_backend backends[] = {
+		RTE_TIMER_BACKEND_SKIPLIST,
+		RTE_TIMER_BACKEND_WHEEL,
+	};
+	struct rte_timer *tms;
+	unsigned i, j;
+	int ret = 0;
+
+	tms = rte_malloc(NULL, sizeof(*tms) * MAX_ITERATIONS, 0);
+	if (tms == NULL) {
+		printf("Cannot allocate memory for timers\n");
+		return -1;
+	}
+
+	for (j = 0; j < RTE_DIM(backends) && ret == 0; j++) {
+		printf("\n=== Timer backend: %s ===\n", names[j]);
+		if (rte_timer_subsystem_backend_set(backends[j],
+				rte_get_timer_hz() / 1000000) != 0) {
+			ret = -1;
+			break;
+		}
+
+		for (i = 0; i < MAX_ITERATIONS; i++)
+			rte_timer_init(&tms[i]);
+
+		ret = timer_perf_run(tms);
+	}
+
+	rte_timer_subsystem_backend_set(RTE_TIMER_BACKEND_SKIPLIST, 0);
+	rte_free(tms);
+
+	return ret;
+}
+
 static struct test_command timer_perf_cmd = {
 	.command = "timer_perf_autotest",
 	.callback = test_timer_perf,
@@ -184,6 +184,8 @@ app_main_loop_pipeline_firewall(void) {
 		struct rte_table_acl_params table_acl_params = {
 			.name = "test", /* unique identifier for acl contexts */
 			.n_rules = app.max_firewall_rules,
+			/* rebuild only a small delta table on rule updates */
+			.n_rules_delta = app.max_firewall_rules / 4,
 			.n_rule_fields = DIM(ipv4_field_formats),
 		};
 
@@ -60,35 +60,51 @@ struct app_core_fc_message_handle_params {
 static void
 app_message_handle(struct app_core_fc_message_handle_params *params);
 
+#define APP_FC_ADD_BULK_SIZE 64
+
 static int app_flow_classification_table_init(
 	struct rte_pipeline *p,
 	uint32_t *port_out_id,
 	uint32_t table_id)
 {
-	struct app_flow_key flow_key;
-	uint32_t i;
+	struct app_flow_key flow_keys[APP_FC_ADD_BULK_SIZE];
+	struct rte_pipeline_table_entry entries[APP_FC_ADD_BULK_SIZE];
+	struct rte_pipeline_table_entry *entries_ptr[APP_FC_ADD_BULK_SIZE];
+	struct rte_pipeline_table_entry *entries_in[APP_FC_ADD_BULK_SIZE];
+	void *keys[APP_FC_ADD_BULK_SIZE];
+	int key_found[APP_FC_ADD_BULK_SIZE];
+	uint32_t i, j;
+
+	for (j = 0; j < APP_FC_ADD_BULK_SIZE; j++) {
+		keys[j] = (void *) &flow_keys[j];
+		entries_in[j] = &entries[j];
+	}
 
-	/* Add entries to tables */
-	for (i = 0; i < (1 << 24); i++) {
-		struct rte_pipeline_table_entry entry = {
-			.action = RTE_PIPELINE_ACTION_PORT,
-			{.port_id = port_out_id[i & (app.n_ports - 1)]},
-		};
-		struct rte_pipeline_table_entry *entry_ptr;
-		int key_found, status;
-
-		flow_key.ttl = 0;
-		flow_key.proto = 6; /* TCP */
-		flow_key.header_checksum = 0;
-		flow_key.ip_src = 0;
-		flow_key.ip_dst = rte_bswap32(i);
-		flow_key.port_src = 0;
-		flow_key.port_dst = 0;
-
-		status = rte_pipeline_table_entry_add(p, table_id,
-			(void *) &flow_key, &entry, &key_found, &entry_ptr);
+	/* Add entries to tables, in batches */
+	for (i = 0; i < (1 << 24); i += APP_FC_ADD_BULK_SIZE) {
+		int status;
+
+		for (j = 0; j < APP_FC_ADD_BULK_SIZE; j++) {
+			struct app_flow_key *flow_key = &flow_keys[j];
+
+			entries[j].action = RTE_PIPELINE_ACTION_PORT;
+			entries[j].port_id =
+				port_out_id[(i + j) & (app.n_ports - 1)];
+
+			flow_key->ttl = 0;
+			flow_key->proto = 6; /* TCP */
+			flow_key->header_checksum = 0;
+			flow_key->ip_src = 0;
+			flow_key->ip_dst = rte_bswap32(i + j);
+			flow_key->port_src = 0;
+			flow_key->port_dst = 0;
+		}
+
+		status = rte_pipeline_table_entry_add_bulk(p, table_id, keys,
+			entries_in, APP_FC_ADD_BULK_SIZE, key_found,
+			entries_ptr);
 		if (status < 0)
-			rte_panic("Unable to add entry to table %u (%d)\n",
+			rte_panic("Unable to add entries to table %u (%d)\n",
 				table_id, status);
 	}
 
@@ -1178,6 +1178,8 @@ setup_acl(struct rte_acl_rule *route_base,
 			rte_exit(EXIT_FAILURE, "add rules failed\n");
 
 	/* Perform builds */
+	memset(&acl_build_param, 0, sizeof(acl_build_param));
+
 	acl_build_param.num_categories = DEFAULT_MAX_CATEGORIES;
 
 	acl_build_param.num_fields = dim;
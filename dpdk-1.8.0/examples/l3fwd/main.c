@@ -707,7 +707,7 @@ get_ipv6_dst_port(void *ipv6_hdr,  uint8_t portid, lookup_struct_t * ipv6_l3fwd_
 static inline uint8_t
 get_ipv4_dst_port(void *ipv4_hdr,  uint8_t portid, lookup_struct_t * ipv4_l3fwd_lookup_struct)
 {
-	uint8_t next_hop;
+	uint32_t next_hop;
 
 	return (uint8_t) ((rte_lpm_lookup(ipv4_l3fwd_lookup_struct,
 		rte_be_to_cpu_32(((struct ipv4_hdr *)ipv4_hdr)->dst_addr),
@@ -1070,7 +1070,8 @@ static inline __attribute__((always_inline)) uint16_t
 get_dst_port(const struct lcore_conf *qconf, struct rte_mbuf *pkt,
 	uint32_t dst_ipv4, uint8_t portid)
 {
-	uint8_t next_hop;
+	uint32_t next_hop;
+	uint8_t next_hop6;
 	struct ipv6_hdr *ipv6_hdr;
 	struct ether_hdr *eth_hdr;
 
@@ -1082,8 +1083,9 @@ get_dst_port(const struct lcore_conf *qconf, struct rte_mbuf *pkt,
 		eth_hdr = rte_pktmbuf_mtod(pkt, struct ether_hdr *);
 		ipv6_hdr = (struct ipv6_hdr *)(eth_hdr + 1);
 		if (rte_lpm6_lookup(qconf->ipv6_lookup_struct,
-				ipv6_hdr->dst_addr, &next_hop) != 0)
-			next_hop = portid;
+				ipv6_hdr->dst_addr, &next_hop6) != 0)
+			next_hop6 = portid;
+		next_hop = next_hop6;
 	} else {
 		next_hop = portid;
 	}
@@ -1160,6 +1162,7 @@ processx4_step2(const struct lcore_conf *qconf, __m128i dip, uint32_t flag,
 	uint8_t portid, struct rte_mbuf *pkt[FWDSTEP], uint16_t dprt[FWDSTEP])
 {
 	rte_xmm_t dst;
+	uint32_t hop[FWDSTEP];
 	const  __m128i bswap_mask = _mm_set_epi8(12, 13, 14, 15, 8, 9, 10, 11,
 						4, 5, 6, 7, 0, 1, 2, 3);
 
@@ -1168,7 +1171,11 @@ processx4_step2(const struct lcore_conf *qconf, __m128i dip, uint32_t flag,
 
 	/* if all 4 packets are IPV4. */
 	if (likely(flag != 0)) {
-		rte_lpm_lookupx4(qconf->ipv4_lookup_struct, dip, dprt, portid);
+		rte_lpm_lookupx4(qconf->ipv4_lookup_struct, dip, hop, portid);
+		dprt[0] = (uint16_t)hop[0];
+		dprt[1] = (uint16_t)hop[1];
+		dprt[2] = (uint16_t)hop[2];
+		dprt[3] = (uint16_t)hop[3];
 	} else {
 		dst.m = dip;
 		dprt[0] = get_dst_port(qconf, pkt[0], dst.u32[0], portid);
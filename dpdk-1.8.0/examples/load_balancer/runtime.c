@@ -525,7 +525,7 @@ app_lcore_worker(
 		for (j = 0; j < bsz_rd; j ++) {
 			struct rte_mbuf *pkt;
 			struct ipv4_hdr *ipv4_hdr;
-			uint32_t ipv4_dst, pos;
+			uint32_t ipv4_dst, pos, next_hop;
 			uint8_t port;
 
 			if (likely(j < bsz_rd - 1)) {
@@ -539,7 +539,10 @@ app_lcore_worker(
 			ipv4_hdr = (struct ipv4_hdr *)(rte_pktmbuf_mtod(pkt, unsigned char *) + sizeof(struct ether_hdr));
 			ipv4_dst = rte_be_to_cpu_32(ipv4_hdr->dst_addr);
 
-			if (unlikely(rte_lpm_lookup(lp->lpm_table, ipv4_dst, &port) != 0)) {
+			if (likely((rte_lpm_lookup(lp->lpm_table, ipv4_dst, &next_hop) == 0) &&
+				   (next_hop < APP_MAX_NIC_PORTS))) {
+				port = (uint8_t) next_hop;
+			} else {
 				port = pkt->port;
 			}
 
@@ -31,6 +31,7 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <pthread.h>
 #include <rte_acl.h>
 #include "tb_mem.h"
 #include "acl.h"
@@ -43,6 +44,7 @@
 
 /* variable for dividing rule sets */
 #define NODE_MAX	2500
+#define NODE_MIN	(NODE_MAX / 16)
 #define NODE_PERCENTAGE	(0.40)
 #define RULE_PERCENTAGE	(0.40)
 
@@ -92,6 +94,28 @@ struct rte_acl_build_rule {
 	uint32_t                    *wildness;
 };
 
+struct acl_build_context;
+
+/* Build of a single trie, done by a worker thread in its own context */
+struct acl_build_job {
+	struct acl_build_context  *context;
+	/**< worker context, owns the memory of the trie. */
+	struct rte_acl_build_rule *head;
+	/**< rules to build the trie from. */
+	struct rte_acl_build_rule *last;
+	/**< if not NULL, the trie was split after that rule. */
+	struct rte_acl_node       *trie;
+	uint32_t                  count;
+	/**< number of rules in the trie. */
+	uint32_t                  base;
+	/**< match flags of the trie start after that value. */
+	uint32_t                  node_max;
+	/**< max nodes a rule can add to the trie, 0 means no limit. */
+	uint32_t                  rule_max;
+	/**< max rules in the trie, 0 means no limit. */
+	int                       rc;
+};
+
 /* Context for build phase */
 struct acl_build_context {
 	const struct rte_acl_ctx *acx;
@@ -105,6 +129,8 @@ struct acl_build_context {
 	uint32_t                  src_mask;
 	uint32_t                  num_build_rules;
 	uint32_t                  num_tries;
+	uint32_t                  node_max;
+	uint32_t                  rule_max;
 	struct tb_mem_pool        pool;
 	struct rte_acl_trie       tries[RTE_ACL_MAX_TRIES];
 	struct rte_acl_bld_trie   bld_tries[RTE_ACL_MAX_TRIES];
@@ -113,6 +139,12 @@ struct acl_build_context {
 	/* memory free lists for nodes and blocks used for node ptrs */
 	struct acl_mem_block      blocks[MEM_BLOCK_NUM];
 	struct rte_acl_node       *node_free_list;
+
+	/* per trie builds */
+	struct acl_build_job      jobs[RTE_ACL_MAX_TRIES];
+	uint32_t                  next_job;
+	uint32_t                  num_jobs;
+	uint32_t                  job_idx[RTE_ACL_MAX_TRIES];
 };
 
 static int acl_merge_trie(struct acl_build_context *context,
@@ -1447,11 +1479,19 @@ build_trie(struct acl_build_context *context, struct rte_acl_build_rule *head,
 			return NULL;
 
 		node_count = context->num_nodes - node_count;
-		if (node_count > NODE_MAX) {
+		if (context->node_max != 0 &&
+				node_count > (int)context->node_max) {
 			*last = prev;
 			return trie;
 		}
 
+		/* trie is full, it holds all rules up to this one */
+		if (context->rule_max != 0 && *count >= context->rule_max &&
+				rule->next != NULL) {
+			*last = rule;
+			return trie;
+		}
+
 		prev = rule;
 		rule = rule->next;
 	}
@@ -1748,12 +1788,157 @@ acl_build_index(const struct rte_acl_config *config, uint32_t *data_index)
 	return m;
 }
 
+static uint32_t
+acl_rule_count(const struct rte_acl_build_rule *head)
+{
+	uint32_t n;
+
+	for (n = 0; head != NULL; head = head->next)
+		n++;
+	return n;
+}
+
+/*
+ * Setup build of the n-th trie from the given rule set.
+ * Each trie gets its own context and memory pool, so different tries
+ * can be built concurrently, and a distinct range of match flags.
+ */
+static int
+acl_build_job_init(struct acl_build_context *context, uint32_t n,
+	struct rte_acl_build_rule *head)
+{
+	uint32_t num;
+	struct acl_build_job *job;
+	struct acl_build_context *wcx;
+
+	wcx = calloc(1, sizeof(*wcx));
+	if (wcx == NULL) {
+		RTE_LOG(ERR, ACL,
+			"Failed to get space for %u-th trie build context\n", n);
+		return -ENOMEM;
+	}
+
+	wcx->acx = context->acx;
+	wcx->cfg = context->cfg;
+	wcx->category_mask = context->category_mask;
+	wcx->pool.alignment = ACL_POOL_ALIGN;
+	wcx->pool.min_alloc = ACL_POOL_ALLOC_MIN;
+	wcx->pool.max_alloc = context->cfg.max_size;
+
+	num = acl_rule_count(head);
+
+	job = context->jobs + n;
+	job->context = wcx;
+	job->head = head;
+	job->base = context->num_build_rules;
+	job->node_max = context->node_max;
+	job->rule_max = context->rule_max;
+	context->num_build_rules += num;
+
+	context->tries[n].type = RTE_ACL_FULL_TRIE;
+	context->tries[n].count = 0;
+	context->tries[n].num_data_indexes = acl_build_index(head->config,
+		context->data_indexes[n]);
+	context->tries[n].data_index = context->data_indexes[n];
+	return 0;
+}
+
+/*
+ * Build a trie from scratch within the job's context.
+ */
+static void
+acl_build_job_run(struct acl_build_job *job)
+{
+	int rc;
+	struct acl_build_context *wcx;
+
+	wcx = job->context;
+
+	/* release memory of the previous build attempt */
+	tb_free_pool(&wcx->pool);
+	memset(wcx->blocks, 0, sizeof(wcx->blocks));
+	wcx->node_free_list = NULL;
+	wcx->num_nodes = 0;
+	wcx->num_build_rules = job->base;
+	wcx->node_max = job->node_max;
+	wcx->rule_max = job->rule_max;
+
+	job->trie = NULL;
+	job->last = NULL;
+	job->count = 0;
+
+	rc = sigsetjmp(wcx->pool.fail, 0);
+	if (rc != 0) {
+		job->trie = NULL;
+		job->rc = rc;
+		return;
+	}
+
+	job->trie = build_trie(wcx, job->head, &job->last, &job->count);
+	job->rc = (job->trie == NULL) ? -ENOMEM : 0;
+}
+
+static void *
+acl_build_worker(void *arg)
+{
+	uint32_t n;
+	struct acl_build_context *context;
+
+	context = arg;
+	while ((n = __sync_fetch_and_add(&context->next_job, 1)) <
+			context->num_jobs)
+		acl_build_job_run(context->jobs + context->job_idx[n]);
+
+	return NULL;
+}
+
+/*
+ * Run the jobs queued in context->job_idx[] on up to cfg.num_threads
+ * threads, the calling thread included.
+ * Jobs are independent, so the result doesn't depend on the scheduling.
+ */
+static int
+acl_build_jobs(struct acl_build_context *context)
+{
+	uint32_t i, n, num;
+	pthread_t tid[RTE_ACL_MAX_TRIES];
+
+	context->next_job = 0;
+	num = RTE_MIN(context->cfg.num_threads, context->num_jobs);
+
+	for (n = 1; n < num; n++) {
+		if (pthread_create(tid + n, NULL, acl_build_worker,
+				context) != 0) {
+			RTE_LOG(DEBUG, ACL, "Failed to start build thread %u, "
+				"continue with %u threads\n", n, n);
+			break;
+		}
+	}
+
+	acl_build_worker(context);
+
+	for (i = 1; i != n; i++)
+		pthread_join(tid[i], NULL);
+
+	for (i = 0; i != context->num_jobs; i++) {
+		n = context->job_idx[i];
+		if (context->jobs[n].rc != 0) {
+			if (context->jobs[n].rc != -ERANGE)
+				RTE_LOG(ERR, ACL,
+					"Build of %u-th trie failed\n", n);
+			return context->jobs[n].rc;
+		}
+	}
+
+	return 0;
+}
+
 static int
 acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *head)
 {
 	int32_t rc;
-	uint32_t n, m, num_tries;
+	uint32_t n, m, lo, num_tries;
 	struct rte_acl_config *config;
 	struct rte_acl_build_rule *last, *rule;
 	uint32_t wild_limit[RTE_ACL_MAX_LEVELS];
@@ -1832,53 +2017,106 @@ acl_build_tries(struct acl_build_context *context,
 			"Number of tries(%d) exceeded.\n", RTE_ACL_MAX_TRIES);
 
 	for (n = 0; n < num_tries; n++) {
-
 		rule_sets[n] = sort_rules(rule_sets[n]);
-		context->tries[n].type = RTE_ACL_FULL_TRIE;
-		context->tries[n].count = 0;
-		context->tries[n].num_data_indexes =
-			acl_build_index(rule_sets[n]->config,
-			context->data_indexes[n]);
-		context->tries[n].data_index = context->data_indexes[n];
-
-		context->bld_tries[n].trie =
-				build_trie(context, rule_sets[n],
-				&last, &context->tries[n].count);
-		if (context->bld_tries[n].trie == NULL) {
-			RTE_LOG(ERR, ACL, "Build of %u-th trie failed\n", n);
-			return -ENOMEM;
-		}
+		rc = acl_build_job_init(context, n, rule_sets[n]);
+		if (rc != 0)
+			return rc;
+	}
+
+	/*
+	 * Build tries in rounds: all tries of the round concurrently,
+	 * then move the rules that didn't fit into a trie into new tries
+	 * (in trie order, so the result is deterministic) and rebuild
+	 * the truncated tries. The new tries are built by the next round.
+	 */
+	for (lo = 0; lo != num_tries; lo = m) {
 
-		if (last != NULL) {
-			rule_sets[num_tries++] = last->next;
-			last->next = NULL;
-			acl_free_node(context, context->bld_tries[n].trie);
-			context->tries[n].count = 0;
+		m = num_tries;
+		context->num_jobs = 0;
+		for (n = lo; n != m; n++)
+			context->job_idx[context->num_jobs++] = n;
 
-			context->bld_tries[n].trie =
-					build_trie(context, rule_sets[n],
-					&last, &context->tries[n].count);
-			if (context->bld_tries[n].trie == NULL) {
-				RTE_LOG(ERR, ACL,
-					"Build of %u-th trie failed\n", n);
-					return -ENOMEM;
+		rc = acl_build_jobs(context);
+		if (rc != 0)
+			return rc;
+
+		context->num_jobs = 0;
+		for (n = lo; n != m; n++) {
+
+			last = context->jobs[n].last;
+			if (last == NULL)
+				continue;
+
+			/* no more tries available, keep all rules here */
+			if (num_tries == RTE_ACL_MAX_TRIES) {
+				RTE_LOG(DEBUG, ACL, "Number of tries(%d) "
+					"exceeded, trie %u is not split.\n",
+					RTE_ACL_MAX_TRIES, n);
+			} else {
+				rc = acl_build_job_init(context, num_tries,
+					last->next);
+				if (rc != 0)
+					return rc;
+				rule_sets[num_tries++] = last->next;
+				last->next = NULL;
+
+				/*
+				 * Split on the rule limit leaves a complete
+				 * trie, split on the node limit leaves a
+				 * partially merged rule that has to go.
+				 */
+				if (context->jobs[n].count ==
+						acl_rule_count(rule_sets[n]))
+					continue;
 			}
+
+			context->jobs[n].node_max = 0;
+			context->jobs[n].rule_max = 0;
+			context->job_idx[context->num_jobs++] = n;
 		}
+
+		rc = acl_build_jobs(context);
+		if (rc != 0)
+			return rc;
+	}
+
+	for (n = 0; n < num_tries; n++) {
+		context->bld_tries[n].trie = context->jobs[n].trie;
+		context->tries[n].count = context->jobs[n].count;
 	}
 
 	context->num_tries = num_tries;
 	return 0;
 }
 
+/*
+ * Temporary memory consumed by the build and all its tries.
+ */
+static size_t
+acl_build_mem(const struct acl_build_context *ctx)
+{
+	uint32_t n;
+	size_t sz;
+
+	sz = ctx->pool.alloc;
+	for (n = 0; n != RTE_DIM(ctx->jobs); n++) {
+		if (ctx->jobs[n].context != NULL)
+			sz += ctx->jobs[n].context->pool.alloc;
+	}
+	return sz;
+}
+
 static void
 acl_build_log(const struct acl_build_context *ctx)
 {
 	uint32_t n;
 
 	RTE_LOG(DEBUG, ACL, "Build phase for ACL \"%s\":\n"
+		"node limit: %u, rule limit: %u\n"
 		"memory consumed: %zu\n",
 		ctx->acx->name,
-		ctx->pool.alloc);
+		ctx->node_max, ctx->rule_max,
+		acl_build_mem(ctx));
 
 	for (n = 0; n < RTE_DIM(ctx->tries); n++) {
 		if (ctx->tries[n].count != 0)
@@ -1952,57 +2190,127 @@ acl_set_data_indexes(struct rte_acl_ctx *ctx)
 	}
 }
 
+/*
+ * Release all temporary memory of the build.
+ */
+static void
+acl_build_free_ctx(struct acl_build_context *bcx)
+{
+	uint32_t n;
 
-int
-rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
+	for (n = 0; n != RTE_DIM(bcx->jobs); n++) {
+		if (bcx->jobs[n].context != NULL) {
+			tb_free_pool(&bcx->jobs[n].context->pool);
+			free(bcx->jobs[n].context);
+			bcx->jobs[n].context = NULL;
+		}
+	}
+	tb_free_pool(&bcx->pool);
+}
+
+/*
+ * Single build attempt with the given limits of nodes a rule is allowed
+ * to add to a trie and of rules in a trie before the trie is split.
+ */
+static int
+acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
+	const struct rte_acl_config *cfg, uint32_t node_max, uint32_t rule_max)
 {
 	int rc;
-	struct acl_build_context bcx;
-
-	if (ctx == NULL || cfg == NULL || cfg->num_categories == 0 ||
-			cfg->num_categories > RTE_ACL_MAX_CATEGORIES)
-		return -EINVAL;
 
 	acl_build_reset(ctx);
 
-	memset(&bcx, 0, sizeof(bcx));
-	bcx.acx = ctx;
-	bcx.pool.alignment = ACL_POOL_ALIGN;
-	bcx.pool.min_alloc = ACL_POOL_ALLOC_MIN;
-	bcx.cfg = *cfg;
-	bcx.category_mask = LEN2MASK(bcx.cfg.num_categories);
-
+	memset(bcx, 0, sizeof(*bcx));
+	bcx->acx = ctx;
+	bcx->pool.alignment = ACL_POOL_ALIGN;
+	bcx->pool.min_alloc = ACL_POOL_ALLOC_MIN;
+	bcx->cfg = *cfg;
+	bcx->category_mask = LEN2MASK(bcx->cfg.num_categories);
+	bcx->node_max = node_max;
+	bcx->rule_max = rule_max;
+
+	/* fail path for the allocations from the main pool */
+	rc = sigsetjmp(bcx->pool.fail, 0);
+	if (rc != 0) {
+		RTE_LOG(ERR, ACL, "ACL context %s: failed to get space "
+			"for build\n", ctx->name);
+		return rc;
+	}
 
 	/* Create a build rules copy. */
-	rc = acl_build_rules(&bcx);
+	rc = acl_build_rules(bcx);
 	if (rc != 0)
 		return rc;
 
 	/* No rules to build for that context+config */
-	if (bcx.build_rules == NULL) {
-		rc = -EINVAL;
+	if (bcx->build_rules == NULL)
+		return -EINVAL;
 
 	/* build internal trie representation. */
-	} else if ((rc = acl_build_tries(&bcx, bcx.build_rules)) == 0) {
+	rc = acl_build_tries(bcx, bcx->build_rules);
+	if (rc != 0)
+		return rc;
 
-		/* allocate and fill run-time  structures. */
-		rc = rte_acl_gen(ctx, bcx.tries, bcx.bld_tries,
-				bcx.num_tries, bcx.cfg.num_categories,
-				RTE_ACL_IPV4VLAN_NUM * RTE_DIM(bcx.tries),
-				bcx.num_build_rules);
-		if (rc == 0) {
+	/* allocate and fill run-time  structures. */
+	rc = rte_acl_gen(ctx, bcx->tries, bcx->bld_tries,
+			bcx->num_tries, bcx->cfg.num_categories,
+			RTE_ACL_MAX_FIELDS * RTE_DIM(bcx->tries) *
+			sizeof(ctx->data_indexes[0]),
+			bcx->num_build_rules + 1, bcx->cfg.max_size);
+	if (rc != 0)
+		return rc;
 
-			/* set data indexes. */
-			acl_set_data_indexes(ctx);
+	/* set data indexes. */
+	acl_set_data_indexes(ctx);
 
-			/* copy in build config. */
-			ctx->config = *cfg;
-		}
+	/* copy in build config. */
+	ctx->config = *cfg;
+	return 0;
+}
+
+int
+rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
+{
+	int rc;
+	uint32_t node_max, rule_max;
+	struct acl_build_context bcx;
+
+	if (ctx == NULL || cfg == NULL || cfg->num_categories == 0 ||
+			cfg->num_categories > RTE_ACL_MAX_CATEGORIES)
+		return -EINVAL;
+
+	/*
+	 * If the build doesn't fit into the memory budget,
+	 * retry it with smaller tries: each retry halves both the number of
+	 * nodes a rule may add to a trie and the number of rules in a trie.
+	 */
+	node_max = NODE_MAX;
+	rule_max = 0;
+	for (;;) {
+
+		rc = acl_bld(&bcx, ctx, cfg, node_max, rule_max);
+
+		acl_build_log(&bcx);
+		ctx->build_mem_sz = acl_build_mem(&bcx);
+
+		/* cleanup after build. */
+		acl_build_free_ctx(&bcx);
+
+		if (rc != -ERANGE || node_max / 2 < NODE_MIN)
+			break;
+
+		node_max /= 2;
+		rule_max = (rule_max == 0) ? ctx->num_rules : rule_max;
+		rule_max = RTE_MAX(rule_max / 2, 1U);
+
+		RTE_LOG(DEBUG, ACL, "ACL context %s: build exceeds max size "
+			"%zu, retry with node limit %u, rule limit %u\n",
+			ctx->name, cfg->max_size, node_max, rule_max);
 	}
 
-	acl_build_log(&bcx);
+	if (rc == -ERANGE)
+		RTE_LOG(ERR, ACL, "ACL context %s: failed to fit into "
+			"max size %zu\n", ctx->name, cfg->max_size);
 
-	/* cleanup after build. */
-	tb_free_pool(&bcx.pool);
 	return rc;
 }
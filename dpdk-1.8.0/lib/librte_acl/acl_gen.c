@@ -400,7 +400,8 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 int
 rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint32_t num_categories, uint32_t data_index_sz, int match_num)
+	uint32_t num_categories, uint32_t data_index_sz, int match_num,
+	size_t max_size)
 {
 	void *mem;
 	size_t total_size;
@@ -420,6 +421,14 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 		(match_num + 2) * sizeof(struct rte_acl_match_results) +
 		XMM_SIZE;
 
+	/* Report when the run-time structures don't fit into the budget */
+	if (max_size != 0 && total_size > max_size) {
+		RTE_LOG(DEBUG, ACL, "Gen phase for ACL ctx \"%s\" exceeds max "
+			"size limit, requested: %zu bytes, limit: %zu bytes\n",
+			ctx->name, total_size, max_size);
+		return -ERANGE;
+	}
+
 	mem = rte_zmalloc_socket(ctx->name, total_size, RTE_CACHE_LINE_SIZE,
 			ctx->socket_id);
 	if (mem == NULL) {
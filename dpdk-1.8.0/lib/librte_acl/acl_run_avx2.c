@@ -0,0 +1,394 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <immintrin.h>
+
+#include "acl_run_sse.h"
+
+/*
+ * AVX2 version of the trie traversal.
+ * Transitions for 8 flows are kept in a pair of YMM registers:
+ * one holds low 32 bits (node index and type) of each transition,
+ * other holds high 32 bits (quad range boundaries).
+ * That way the address calculation doesn't need any shuffling and
+ * next transitions are fetched with two 32-bit gathers.
+ * Two such pairs are processed at once, giving 16 flows in parallel.
+ */
+
+typedef __m256i ymm_t;
+
+typedef union {
+	ymm_t    m;
+	uint8_t  u8[sizeof(ymm_t) / sizeof(uint8_t)];
+	uint16_t u16[sizeof(ymm_t) / sizeof(uint16_t)];
+	uint32_t u32[sizeof(ymm_t) / sizeof(uint32_t)];
+} acl_ymm_t;
+
+#define	ACL_YMM_FLOWS	(sizeof(ymm_t) / sizeof(uint32_t))
+
+static const acl_ymm_t ymm_type_quad_range = {
+	.u32 = {
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+		RTE_ACL_NODE_QRANGE,
+	},
+};
+
+static const acl_ymm_t ymm_shuffle_input = {
+	.u32 = {
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+	},
+};
+
+static const acl_ymm_t ymm_ones_16 = {
+	.u16 = {
+		1, 1, 1, 1, 1, 1, 1, 1,
+		1, 1, 1, 1, 1, 1, 1, 1,
+	},
+};
+
+static const acl_ymm_t ymm_bytes = {
+	.u32 = {
+		UINT8_MAX, UINT8_MAX, UINT8_MAX, UINT8_MAX,
+		UINT8_MAX, UINT8_MAX, UINT8_MAX, UINT8_MAX,
+	},
+};
+
+static const acl_ymm_t ymm_match_mask = {
+	.u32 = {
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH,
+	},
+};
+
+static const acl_ymm_t ymm_index_mask = {
+	.u32 = {
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX,
+	},
+};
+
+/*
+ * Split 8 transitions back into 64-bit values, check them for matches
+ * and put the updated transitions back into the YMM registers.
+ */
+static void
+acl_process_matches_avx2(ymm_t *tr_lo, ymm_t *tr_hi, int slot,
+	const struct rte_acl_ctx *ctx, struct parms *parms,
+	struct acl_flow_data *flows)
+{
+	uint32_t i;
+	uint64_t transition;
+	acl_ymm_t lo, hi;
+
+	lo.m = *tr_lo;
+	hi.m = *tr_hi;
+
+	for (i = 0; i != ACL_YMM_FLOWS; i++) {
+		transition = (uint64_t)hi.u32[i] << 32 | lo.u32[i];
+		transition = acl_match_check(transition, slot + i, ctx,
+			parms, flows, resolve_priority_sse);
+		lo.u32[i] = (uint32_t)transition;
+		hi.u32[i] = (uint32_t)(transition >> 32);
+	}
+
+	*tr_lo = lo.m;
+	*tr_hi = hi.m;
+}
+
+/*
+ * Check for any match in 8 transitions (contained in 2 YMM registers)
+ */
+static inline void
+acl_match_check_x8(int slot, const struct rte_acl_ctx *ctx,
+	struct parms *parms, struct acl_flow_data *flows,
+	ymm_t *tr_lo, ymm_t *tr_hi, ymm_t match_mask)
+{
+	while (!_mm256_testz_si256(*tr_lo, match_mask))
+		acl_process_matches_avx2(tr_lo, tr_hi, slot, ctx, parms, flows);
+}
+
+/*
+ * Calculate the address of the next transition for 8 flows.
+ * Same as acl_calc_addr() from the SSE version, except that
+ * low and high halves of the transitions are already split.
+ * Note that no transition is done for a match node and therefore
+ * a stream freezes when it reaches a match.
+ */
+static inline ymm_t
+acl_calc_addr_avx2(ymm_t index_mask, ymm_t next_input, ymm_t shuffle_input,
+	ymm_t ones_16, ymm_t bytes, ymm_t type_quad_range,
+	ymm_t tr_lo, ymm_t tr_hi)
+{
+	ymm_t addr, node_types, temp;
+
+	/* Calc node type and node addr */
+	node_types = _mm256_andnot_si256(index_mask, tr_lo);
+	addr = _mm256_and_si256(index_mask, tr_lo);
+
+	/*
+	 * Calc addr for DFAs - addr = dfa_index + input_byte
+	 */
+
+	/* mask for DFA type (0) nodes */
+	temp = _mm256_cmpeq_epi32(node_types, _mm256_setzero_si256());
+
+	/* add input byte to DFA position */
+	temp = _mm256_and_si256(temp, bytes);
+	temp = _mm256_and_si256(temp, next_input);
+	addr = _mm256_add_epi32(addr, temp);
+
+	/*
+	 * Calc addr for Range nodes -> range_index + range(input)
+	 */
+	node_types = _mm256_cmpeq_epi32(node_types, type_quad_range);
+
+	/* shuffle input byte to all 4 positions of 32 bit value */
+	temp = _mm256_shuffle_epi8(next_input, shuffle_input);
+
+	/* count range boundaries that are less than the input byte */
+	temp = _mm256_cmpgt_epi8(temp, tr_hi);
+	temp = _mm256_sign_epi8(temp, temp);
+	temp = _mm256_maddubs_epi16(temp, temp);
+	temp = _mm256_madd_epi16(temp, ones_16);
+
+	/* mask to range type nodes */
+	temp = _mm256_and_si256(temp, node_types);
+
+	/* add index into node position */
+	return _mm256_add_epi32(addr, temp);
+}
+
+/*
+ * Process 8 transitions (in 2 YMM registers) in parallel
+ */
+static inline ymm_t
+transition8(ymm_t index_mask, ymm_t next_input, ymm_t shuffle_input,
+	ymm_t ones_16, ymm_t bytes, ymm_t type_quad_range,
+	const uint64_t *trans, ymm_t *tr_lo, ymm_t *tr_hi)
+{
+	ymm_t addr;
+
+	addr = acl_calc_addr_avx2(index_mask, next_input, shuffle_input,
+		ones_16, bytes, type_quad_range, *tr_lo, *tr_hi);
+
+	/* gather low and high halves of 8 64-bit transitions. */
+	*tr_lo = _mm256_i32gather_epi32((const int *)trans, addr,
+		sizeof(trans[0]));
+	*tr_hi = _mm256_i32gather_epi32((const int *)trans + 1, addr,
+		sizeof(trans[0]));
+
+	return _mm256_srli_epi32(next_input, CHAR_BIT);
+}
+
+/*
+ * Gather 4 bytes of input data for 8 streams starting at given slot.
+ */
+static inline ymm_t
+acl_next_input_x8(struct parms *parms, int slot)
+{
+	return _mm256_set_epi32(
+		GET_NEXT_4BYTES(parms, slot + 7),
+		GET_NEXT_4BYTES(parms, slot + 6),
+		GET_NEXT_4BYTES(parms, slot + 5),
+		GET_NEXT_4BYTES(parms, slot + 4),
+		GET_NEXT_4BYTES(parms, slot + 3),
+		GET_NEXT_4BYTES(parms, slot + 2),
+		GET_NEXT_4BYTES(parms, slot + 1),
+		GET_NEXT_4BYTES(parms, slot));
+}
+
+/*
+ * Load 8 64-bit transitions and split them into low and high halves.
+ */
+static inline void
+acl_load_trans_x8(const uint64_t *index_array, ymm_t *tr_lo, ymm_t *tr_hi)
+{
+	ymm_t t0, t1;
+
+	t0 = _mm256_loadu_si256((const ymm_t *)index_array);
+	t1 = _mm256_loadu_si256((const ymm_t *)(index_array + 4));
+
+	/* {lo0, hi0, lo1, hi1, ...} -> {lo0, lo1, ..., lo7} */
+	*tr_lo = (ymm_t)_mm256_shuffle_ps((__m256)t0, (__m256)t1, 0x88);
+	*tr_hi = (ymm_t)_mm256_shuffle_ps((__m256)t0, (__m256)t1, 0xdd);
+
+	/* restore flow order across 128-bit lanes */
+	*tr_lo = _mm256_permute4x64_epi64(*tr_lo, 0xd8);
+	*tr_hi = _mm256_permute4x64_epi64(*tr_hi, 0xd8);
+}
+
+/*
+ * Execute trie traversal with 16 traversals in parallel
+ */
+static inline int
+search_avx2_16(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	int n;
+	struct acl_flow_data flows;
+	uint64_t index_array[MAX_SEARCHES_AVX16];
+	struct completion cmplt[MAX_SEARCHES_AVX16];
+	struct parms parms[MAX_SEARCHES_AVX16];
+	ymm_t input0, input1;
+	ymm_t tr_lo0, tr_hi0, tr_lo1, tr_hi1;
+
+	acl_set_flow(&flows, cmplt, RTE_DIM(cmplt), data, results,
+		total_packets, categories, ctx->trans_table);
+
+	for (n = 0; n < MAX_SEARCHES_AVX16; n++) {
+		cmplt[n].count = 0;
+		index_array[n] = acl_start_next_trie(&flows, parms, n, ctx);
+	}
+
+	acl_load_trans_x8(index_array, &tr_lo0, &tr_hi0);
+	acl_load_trans_x8(index_array + ACL_YMM_FLOWS, &tr_lo1, &tr_hi1);
+
+	/* Check for any matches. */
+	acl_match_check_x8(0, ctx, parms, &flows, &tr_lo0, &tr_hi0,
+		ymm_match_mask.m);
+	acl_match_check_x8(ACL_YMM_FLOWS, ctx, parms, &flows,
+		&tr_lo1, &tr_hi1, ymm_match_mask.m);
+
+	while (flows.started > 0) {
+
+		/* Gather 4 bytes of input data for each stream. */
+		input0 = acl_next_input_x8(parms, 0);
+		input1 = acl_next_input_x8(parms, ACL_YMM_FLOWS);
+
+		/* Process the 4 bytes of input on each stream. */
+		for (n = 0; n != sizeof(uint32_t); n++) {
+
+			input0 = transition8(ymm_index_mask.m, input0,
+				ymm_shuffle_input.m, ymm_ones_16.m,
+				ymm_bytes.m, ymm_type_quad_range.m,
+				flows.trans, &tr_lo0, &tr_hi0);
+
+			input1 = transition8(ymm_index_mask.m, input1,
+				ymm_shuffle_input.m, ymm_ones_16.m,
+				ymm_bytes.m, ymm_type_quad_range.m,
+				flows.trans, &tr_lo1, &tr_hi1);
+		}
+
+		/* Check for any matches. */
+		acl_match_check_x8(0, ctx, parms, &flows, &tr_lo0, &tr_hi0,
+			ymm_match_mask.m);
+		acl_match_check_x8(ACL_YMM_FLOWS, ctx, parms, &flows,
+			&tr_lo1, &tr_hi1, ymm_match_mask.m);
+	}
+
+	return 0;
+}
+
+/*
+ * Execute trie traversal with 8 traversals in parallel
+ */
+static inline int
+search_avx2_8(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	int n;
+	struct acl_flow_data flows;
+	uint64_t index_array[MAX_SEARCHES_SSE8];
+	struct completion cmplt[MAX_SEARCHES_SSE8];
+	struct parms parms[MAX_SEARCHES_SSE8];
+	ymm_t input, tr_lo, tr_hi;
+
+	acl_set_flow(&flows, cmplt, RTE_DIM(cmplt), data, results,
+		total_packets, categories, ctx->trans_table);
+
+	for (n = 0; n < MAX_SEARCHES_SSE8; n++) {
+		cmplt[n].count = 0;
+		index_array[n] = acl_start_next_trie(&flows, parms, n, ctx);
+	}
+
+	acl_load_trans_x8(index_array, &tr_lo, &tr_hi);
+
+	/* Check for any matches. */
+	acl_match_check_x8(0, ctx, parms, &flows, &tr_lo, &tr_hi,
+		ymm_match_mask.m);
+
+	while (flows.started > 0) {
+
+		/* Gather 4 bytes of input data for each stream. */
+		input = acl_next_input_x8(parms, 0);
+
+		/* Process the 4 bytes of input on each stream. */
+		for (n = 0; n != sizeof(uint32_t); n++)
+			input = transition8(ymm_index_mask.m, input,
+				ymm_shuffle_input.m, ymm_ones_16.m,
+				ymm_bytes.m, ymm_type_quad_range.m,
+				flows.trans, &tr_lo, &tr_hi);
+
+		/* Check for any matches. */
+		acl_match_check_x8(0, ctx, parms, &flows, &tr_lo, &tr_hi,
+			ymm_match_mask.m);
+	}
+
+	return 0;
+}
+
+int
+rte_acl_classify_avx2(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t num, uint32_t categories)
+{
+	if (categories != 1 &&
+		((RTE_ACL_RESULTS_MULTIPLIER - 1) & categories) != 0)
+		return -EINVAL;
+
+	if (likely(num >= MAX_SEARCHES_AVX16))
+		return search_avx2_16(ctx, data, results, num, categories);
+	else if (num >= MAX_SEARCHES_SSE8)
+		return search_avx2_8(ctx, data, results, num, categories);
+	else
+		return rte_acl_classify_sse(ctx, data, results, num,
+			categories);
+}
@@ -94,6 +94,14 @@ struct rte_acl_config {
 	uint32_t num_fields;     /**< Number of field definitions. */
 	struct rte_acl_field_def defs[RTE_ACL_MAX_FIELDS];
 	/**< array of field definitions. */
+	uint32_t num_threads;
+	/**< Number of threads to build tries with, 0 or 1 means serial build. */
+	size_t max_size;
+	/**<
+	 * Memory budget in bytes for the internal run-time structures and
+	 * for the temporary memory of each trie, 0 means no limit.
+	 * When the budget is exceeded, the rules are split into more tries.
+	 */
 };
 
 /**
@@ -233,6 +241,9 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
 /**
  * Analyze set of rules and build required internal run-time structures.
  * This function is not multi-thread safe.
+ * Independent tries are built concurrently by up to cfg->num_threads
+ * threads (including the caller); the result does not depend on the
+ * number of threads.
  *
  * @param ctx
  *   ACL context to build.
@@ -240,6 +251,7 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
  *   Pointer to struct rte_acl_config - defines build parameters.
  * @return
  *   - -ENOMEM if couldn't allocate enough memory.
+ *   - -ERANGE if the rules do not fit into cfg->max_size.
  *   - -EINVAL if the parameters are invalid.
  *   - Negative error code if operation failed.
  *   - Zero if operation completed successfully.
@@ -265,6 +277,7 @@ enum rte_acl_classify_alg {
 	RTE_ACL_CLASSIFY_DEFAULT = 0,
 	RTE_ACL_CLASSIFY_SCALAR = 1,  /**< generic implementation. */
 	RTE_ACL_CLASSIFY_SSE = 2,     /**< requires SSE4.1 support. */
+	RTE_ACL_CLASSIFY_AVX2 = 3,    /**< requires AVX2 support. */
 };
 
 /**
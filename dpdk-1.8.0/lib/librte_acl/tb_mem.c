@@ -37,6 +37,8 @@
  *  Memory management routines for temporary memory.
  *  That memory is used only during build phase and is released after
  *  build is finished.
+ *  tb_alloc() never returns NULL: on failure it jumps to pool->fail,
+ *  which the caller has to set up with sigsetjmp() beforehand.
  */
 
 static struct tb_mem_block *
@@ -47,10 +49,19 @@ tb_pool(struct tb_mem_pool *pool, size_t sz)
 	size_t size;
 
 	size = sz + pool->alignment - 1;
+	if (pool->max_alloc != 0 && pool->alloc + size > pool->max_alloc) {
+		RTE_LOG(DEBUG, MALLOC, "%s(%zu) exceeds pool limit of %zu "
+			"bytes, currently allocated by pool: %zu bytes\n",
+			__func__, sz, pool->max_alloc, pool->alloc);
+		siglongjmp(pool->fail, -ERANGE);
+		return NULL;
+	}
+
 	block = calloc(1, size + sizeof(*pool->block));
 	if (block == NULL) {
 		RTE_LOG(ERR, MALLOC, "%s(%zu)\n failed, currently allocated "
 			"by pool: %zu bytes\n", __func__, sz, pool->alloc);
+		siglongjmp(pool->fail, -ENOMEM);
 		return NULL;
 	}
 
@@ -80,9 +91,13 @@ tb_alloc(struct tb_mem_pool *pool, size_t size)
 	block = pool->block;
 	if (block == NULL || block->size < size) {
 		new_sz = (size > pool->min_alloc) ? size : pool->min_alloc;
+		/* don't let a minimal size block alone exceed the limit */
+		if (pool->max_alloc != 0 && new_sz > size &&
+				pool->max_alloc > pool->alloc + size +
+				pool->alignment)
+			new_sz = RTE_MIN(new_sz, pool->max_alloc -
+				pool->alloc - pool->alignment);
 		block = tb_pool(pool, new_sz);
-		if (block == NULL)
-			return NULL;
 	}
 	ptr = block->mem;
 	block->size -= size;
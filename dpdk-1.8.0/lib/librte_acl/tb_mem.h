@@ -48,6 +48,7 @@ extern "C" {
 #endif
 
 #include <rte_acl_osdep.h>
+#include <setjmp.h>
 
 struct tb_mem_block {
 	struct tb_mem_block *next;
@@ -61,6 +62,9 @@ struct tb_mem_pool {
 	size_t               alignment;
 	size_t               min_alloc;
 	size_t               alloc;
+	size_t               max_alloc; /* 0 means no limit */
+	sigjmp_buf           fail;
+	/* tb_alloc() jumps here with -ENOMEM or -ERANGE on failure */
 };
 
 void *tb_alloc(struct tb_mem_pool *pool, size_t size);
@@ -41,6 +41,7 @@
 #include <rte_string_fns.h>
 #include <rte_tailq.h>
 #include <rte_eal_memconfig.h>
+#include <rte_common_vect.h>
 #include "rte_distributor.h"
 
 #define NO_FLAGS 0
@@ -55,6 +56,7 @@
 #define RTE_DISTRIB_NO_BUF 0       /**< empty flags: no buffer requested */
 #define RTE_DISTRIB_GET_BUF (1)    /**< worker requests a buffer, returns old */
 #define RTE_DISTRIB_RETURN_BUF (2) /**< worker returns a buffer, no request */
+#define RTE_DISTRIB_BURST_BUF (4)  /**< request or return of a burst worker */
 
 #define RTE_DISTRIB_BACKLOG_SIZE 8
 #define RTE_DISTRIB_BACKLOG_MASK (RTE_DISTRIB_BACKLOG_SIZE - 1)
@@ -63,28 +65,32 @@
 #define RTE_DISTRIB_RETURNS_MASK (RTE_DISTRIB_MAX_RETURNS - 1)
 
 /**
- * Maximum number of workers allowed.
- * Be aware of increasing the limit, becaus it is limited by how we track
- * in-flight tags. See @in_flight_bitmask and @rte_distributor_process
+ * Number of 64-bit words in the in-flight bitmask. RTE_DISTRIB_MAX_WORKERS
+ * must be a multiple of 64.
  */
-#define RTE_DISTRIB_MAX_WORKERS	64
+#define RTE_DISTRIB_BITMASK_WORDS (RTE_DISTRIB_MAX_WORKERS / 64)
 
 /**
- * Buffer structure used to pass the pointer data between cores. This is cache
- * line aligned, but to improve performance and prevent adjacent cache-line
- * prefetches of buffers for other workers, e.g. when worker 1's buffer is on
- * the next cache line to worker 0, we pad this out to three cache lines.
- * Only 64-bits of the memory is actually used though.
+ * Buffer structure used to pass the pointer data between cores. The first
+ * cache line carries the request flags and the packets given to the worker:
+ * only bufptr64[0] is used by single packet workers, while burst workers get
+ * up to RTE_DISTRIB_BURST_SIZE packets at once. The packets returned by burst
+ * workers are in the retptr64 cache line. To improve performance and prevent
+ * adjacent cache-line prefetches, each of these lines is followed by a
+ * padding one.
  */
-union rte_distributor_buffer {
-	volatile int64_t bufptr64;
-	char pad[RTE_CACHE_LINE_SIZE*3];
+struct rte_distributor_buffer {
+	volatile int64_t bufptr64[RTE_DISTRIB_BURST_SIZE] __rte_cache_aligned;
+	char pad1 __rte_cache_aligned;
+	volatile int64_t retptr64[RTE_DISTRIB_BURST_SIZE] __rte_cache_aligned;
+	char pad2 __rte_cache_aligned;
 } __rte_cache_aligned;
 
 struct rte_distributor_backlog {
 	unsigned start;
 	unsigned count;
 	int64_t pkts[RTE_DISTRIB_BACKLOG_SIZE];
+	uint32_t tags[RTE_DISTRIB_BACKLOG_SIZE];
 };
 
 struct rte_distributor_returned_pkts {
@@ -99,17 +105,21 @@ struct rte_distributor {
 	char name[RTE_DISTRIBUTOR_NAMESIZE];  /**< Name of the ring. */
 	unsigned num_workers;                 /**< Number of workers polling */
 
-	uint32_t in_flight_tags[RTE_DISTRIB_MAX_WORKERS];
-		/**< Tracks the tag being processed per core */
-	uint64_t in_flight_bitmask;
-		/**< on/off bits for in-flight tags.
-		 * Note that if RTE_DISTRIB_MAX_WORKERS is larger than 64 then
-		 * the bitmask has to expand.
+	uint32_t in_flight_tags[RTE_DISTRIB_MAX_WORKERS][RTE_DISTRIB_BURST_SIZE]
+			__rte_cache_aligned;
+		/**< Tracks the tags being processed per core. The entries
+		 * beyond the number of packets in flight repeat the first
+		 * tag, so that all the entries can be compared, and the
+		 * entries of a worker are read as whole vectors.
 		 */
+	uint64_t in_flight_bitmask[RTE_DISTRIB_BITMASK_WORDS];
+		/**< on/off bits for in-flight tags, one bit per worker */
+	unsigned in_flight_count[RTE_DISTRIB_MAX_WORKERS];
+		/**< Number of packets being processed per core */
 
 	struct rte_distributor_backlog backlog[RTE_DISTRIB_MAX_WORKERS];
 
-	union rte_distributor_buffer bufs[RTE_DISTRIB_MAX_WORKERS];
+	struct rte_distributor_buffer bufs[RTE_DISTRIB_MAX_WORKERS];
 
 	struct rte_distributor_returned_pkts returns;
 };
@@ -122,24 +132,24 @@ void
 rte_distributor_request_pkt(struct rte_distributor *d,
 		unsigned worker_id, struct rte_mbuf *oldpkt)
 {
-	union rte_distributor_buffer *buf = &d->bufs[worker_id];
+	struct rte_distributor_buffer *buf = &d->bufs[worker_id];
 	int64_t req = (((int64_t)(uintptr_t)oldpkt) << RTE_DISTRIB_FLAG_BITS)
 			| RTE_DISTRIB_GET_BUF;
-	while (unlikely(buf->bufptr64 & RTE_DISTRIB_FLAGS_MASK))
+	while (unlikely(buf->bufptr64[0] & RTE_DISTRIB_FLAGS_MASK))
 		rte_pause();
-	buf->bufptr64 = req;
+	buf->bufptr64[0] = req;
 }
 
 struct rte_mbuf *
 rte_distributor_poll_pkt(struct rte_distributor *d,
 		unsigned worker_id)
 {
-	union rte_distributor_buffer *buf = &d->bufs[worker_id];
-	if (buf->bufptr64 & RTE_DISTRIB_GET_BUF)
+	struct rte_distributor_buffer *buf = &d->bufs[worker_id];
+	if (buf->bufptr64[0] & RTE_DISTRIB_GET_BUF)
 		return NULL;
 
 	/* since bufptr64 is signed, this should be an arithmetic shift */
-	int64_t ret = buf->bufptr64 >> RTE_DISTRIB_FLAG_BITS;
+	int64_t ret = buf->bufptr64[0] >> RTE_DISTRIB_FLAG_BITS;
 	return (struct rte_mbuf *)((uintptr_t)ret);
 }
 
@@ -158,10 +168,94 @@ int
 rte_distributor_return_pkt(struct rte_distributor *d,
 		unsigned worker_id, struct rte_mbuf *oldpkt)
 {
-	union rte_distributor_buffer *buf = &d->bufs[worker_id];
+	struct rte_distributor_buffer *buf = &d->bufs[worker_id];
 	uint64_t req = (((int64_t)(uintptr_t)oldpkt) << RTE_DISTRIB_FLAG_BITS)
 			| RTE_DISTRIB_RETURN_BUF;
-	buf->bufptr64 = req;
+	buf->bufptr64[0] = req;
+	return 0;
+}
+
+/* write the packets returned by a burst worker, zeroing the unused entries */
+static inline void
+burst_write_returns(struct rte_distributor_buffer *buf,
+		struct rte_mbuf **oldpkt, unsigned num)
+{
+	unsigned i;
+
+	for (i = 0; i < num; i++)
+		buf->retptr64[i] = (int64_t)(uintptr_t)oldpkt[i];
+	for ( ; i < RTE_DISTRIB_BURST_SIZE; i++)
+		buf->retptr64[i] = 0;
+}
+
+int
+rte_distributor_request_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt,
+		unsigned retcount)
+{
+	struct rte_distributor_buffer *buf = &d->bufs[worker_id];
+
+	if (unlikely(retcount > RTE_DISTRIB_BURST_SIZE))
+		return -EINVAL;
+
+	while (unlikely(buf->bufptr64[0] & RTE_DISTRIB_FLAGS_MASK))
+		rte_pause();
+
+	/* the returned packets are visible before the request */
+	burst_write_returns(buf, oldpkt, retcount);
+	buf->bufptr64[0] = RTE_DISTRIB_GET_BUF | RTE_DISTRIB_BURST_BUF;
+	return 0;
+}
+
+int
+rte_distributor_poll_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts)
+{
+	struct rte_distributor_buffer *buf = &d->bufs[worker_id];
+	unsigned i, count = 0;
+
+	if (buf->bufptr64[0] & RTE_DISTRIB_GET_BUF)
+		return 0;
+
+	/* the first entry is written last by the distributor, the unused
+	 * ones are zero */
+	for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++) {
+		int64_t ret = buf->bufptr64[i] >> RTE_DISTRIB_FLAG_BITS;
+
+		if (ret == 0)
+			break;
+		pkts[count++] = (struct rte_mbuf *)((uintptr_t)ret);
+	}
+	return count;
+}
+
+int
+rte_distributor_get_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts,
+		struct rte_mbuf **oldpkt, unsigned retcount)
+{
+	int count;
+
+	if (rte_distributor_request_pkt_burst(d, worker_id, oldpkt,
+			retcount) < 0)
+		return -EINVAL;
+	while ((count = rte_distributor_poll_pkt_burst(d, worker_id,
+			pkts)) == 0)
+		rte_pause();
+	return count;
+}
+
+int
+rte_distributor_return_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned num)
+{
+	struct rte_distributor_buffer *buf = &d->bufs[worker_id];
+
+	if (unlikely(num > RTE_DISTRIB_BURST_SIZE))
+		return -EINVAL;
+
+	burst_write_returns(buf, oldpkt, num);
+	buf->bufptr64[0] = RTE_DISTRIB_RETURN_BUF | RTE_DISTRIB_BURST_BUF;
 	return 0;
 }
 
@@ -169,13 +263,16 @@ rte_distributor_return_pkt(struct rte_distributor *d,
 
 /* as name suggests, adds a packet to the backlog for a particular worker */
 static int
-add_to_backlog(struct rte_distributor_backlog *bl, int64_t item)
+add_to_backlog(struct rte_distributor_backlog *bl, int64_t item, uint32_t tag)
 {
+	unsigned idx;
+
 	if (bl->count == RTE_DISTRIB_BACKLOG_SIZE)
 		return -1;
 
-	bl->pkts[(bl->start + bl->count++) & (RTE_DISTRIB_BACKLOG_MASK)]
-			= item;
+	idx = (bl->start + bl->count++) & RTE_DISTRIB_BACKLOG_MASK;
+	bl->pkts[idx] = item;
+	bl->tags[idx] = tag;
 	return 0;
 }
 
@@ -187,6 +284,125 @@ backlog_pop(struct rte_distributor_backlog *bl)
 	return bl->pkts[bl->start++ & RTE_DISTRIB_BACKLOG_MASK];
 }
 
+#if defined(RTE_MACHINE_CPUFLAG_AVX2)
+/* turns each non-zero byte of x into one bit of the result */
+static inline uint64_t
+bytes_to_bits(uint64_t x)
+{
+	x |= x >> 4;
+	x |= x >> 2;
+	x |= x >> 1;
+	x &= UINT64_C(0x0101010101010101);
+	return (x * UINT64_C(0x0102040810204080)) >> 56;
+}
+#endif
+
+/*
+ * Returns the bitmask of the workers first to first + num - 1 (at most 64)
+ * which have an in-flight entry equal to tag. Each worker's entries are
+ * compared as a whole vector, a one-bit indicates a match for the worker
+ * given by the bit-position. The bits beyond num may be set by the idle
+ * entries following the last worker, they are masked by the caller.
+ */
+static inline uint64_t
+match_tag_word(const struct rte_distributor *d, uint32_t tag,
+		unsigned first, unsigned num)
+{
+	const uint32_t (*tags)[RTE_DISTRIB_BURST_SIZE] =
+			&d->in_flight_tags[first];
+	uint64_t match = 0;
+	unsigned i;
+
+#if defined(RTE_MACHINE_CPUFLAG_AVX2)
+	const __m256i tag8 = _mm256_set1_epi32(tag);
+	unsigned j;
+
+	/* the masks of 8 workers are gathered as bytes before being turned
+	 * into bits, to keep the compares independent of each other */
+	for (i = 0; i < num; i += 8) {
+		uint64_t bytes = 0;
+
+		for (j = 0; j < 8; j++)
+			bytes |= (uint64_t)_mm256_movemask_ps(
+				_mm256_castsi256_ps(_mm256_cmpeq_epi32(tag8,
+				_mm256_load_si256(
+					(const __m256i *)tags[i + j])))) <<
+				(j * 8);
+		match |= bytes_to_bits(bytes) << i;
+	}
+#elif defined(RTE_MACHINE_CPUFLAG_SSE2)
+	const __m128i tag4 = _mm_set1_epi32(tag);
+
+	for (i = 0; i < num; i++)
+		match |= (uint64_t)(_mm_movemask_ps(_mm_castsi128_ps(
+			_mm_or_si128(
+				_mm_cmpeq_epi32(tag4, _mm_load_si128(
+					(const __m128i *)&tags[i][0])),
+				_mm_cmpeq_epi32(tag4, _mm_load_si128(
+					(const __m128i *)&tags[i][4]))))) != 0)
+				<< i;
+#else
+	unsigned j;
+
+	/*
+	 * to scan for a match use "xor" and "not" to get a 0/1
+	 * value, then use shifting to merge to single "match"
+	 * variable
+	 */
+	for (i = 0; i < num; i++) {
+		unsigned m = 0;
+
+		for (j = 0; j < RTE_DISTRIB_BURST_SIZE; j++)
+			m |= !(tags[i][j] ^ tag);
+		match |= (uint64_t)m << i;
+	}
+#endif
+	return match;
+}
+
+/* returns the worker processing packets with this tag, or -1 if none is */
+static inline int
+match_tag(const struct rte_distributor *d, uint32_t tag)
+{
+	unsigned w, first;
+
+	for (w = 0, first = 0; first < d->num_workers; w++, first += 64) {
+		uint64_t match;
+
+		/* skip the words without any worker busy */
+		if (d->in_flight_bitmask[w] == 0)
+			continue;
+
+		/* Only turned-on bits are considered as match */
+		match = match_tag_word(d, tag, first,
+				RTE_MIN(d->num_workers - first, 64u)) &
+				d->in_flight_bitmask[w];
+		if (match)
+			return first + __builtin_ctzll(match);
+	}
+	return -1;
+}
+
+/* records the tags of the packets given to a worker */
+static inline void
+set_in_flight(struct rte_distributor *d, unsigned wkr,
+		const uint32_t *tags, unsigned count)
+{
+	unsigned i;
+
+	for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++)
+		d->in_flight_tags[wkr][i] = tags[i < count ? i : 0];
+	d->in_flight_count[wkr] = count;
+	d->in_flight_bitmask[wkr / 64] |= (1ULL << (wkr % 64));
+}
+
+static inline void
+clear_in_flight(struct rte_distributor *d, unsigned wkr)
+{
+	d->in_flight_count[wkr] = 0;
+	d->in_flight_bitmask[wkr / 64] &= ~(1ULL << (wkr % 64));
+}
+
 /* stores a packet returned from a worker inside the returns array */
 static inline void
 store_return(uintptr_t oldbuf, struct rte_distributor *d,
@@ -199,12 +415,97 @@ store_return(uintptr_t oldbuf, struct rte_distributor *d,
 	*ret_count += (*ret_count != RTE_DISTRIB_RETURNS_MASK) & !!(oldbuf);
 }
 
+/* stores the packets returned by a burst worker, which are then cleared so
+ * that a pending request does not return them twice */
+static inline void
+store_burst_returns(struct rte_distributor *d, unsigned wkr,
+		unsigned *ret_start, unsigned *ret_count)
+{
+	struct rte_distributor_buffer *buf = &d->bufs[wkr];
+	unsigned i;
+
+	for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++) {
+		uintptr_t oldbuf = (uintptr_t)buf->retptr64[i];
+
+		if (oldbuf == 0)
+			break;
+		store_return(oldbuf, d, ret_start, ret_count);
+		buf->retptr64[i] = 0;
+	}
+}
+
+/*
+ * Gives a burst to a worker which requested packets: first the packets of
+ * its backlog, then the pending packet next_mb if any, then as many of the
+ * following packets of mbufs as fit, moving those of flows in flight on
+ * other workers to their backlog. Returns the index of the first packet of
+ * mbufs not consumed.
+ */
+static unsigned
+give_burst(struct rte_distributor *d, unsigned wkr,
+		struct rte_mbuf **next_mb, int64_t next_value, uint32_t new_tag,
+		struct rte_mbuf **mbufs, unsigned next_idx, unsigned num_mbufs)
+{
+	struct rte_distributor_buffer *buf = &d->bufs[wkr];
+	struct rte_distributor_backlog *bl = &d->backlog[wkr];
+	int64_t burst[RTE_DISTRIB_BURST_SIZE];
+	uint32_t tags[RTE_DISTRIB_BURST_SIZE];
+	unsigned i, n = 0;
+
+	/* the worker completed all its previous packets */
+	clear_in_flight(d, wkr);
+
+	while (bl->count != 0 && n < RTE_DISTRIB_BURST_SIZE) {
+		tags[n] = bl->tags[bl->start & RTE_DISTRIB_BACKLOG_MASK];
+		burst[n++] = backlog_pop(bl);
+	}
+
+	if (*next_mb != NULL && n < RTE_DISTRIB_BURST_SIZE) {
+		tags[n] = new_tag;
+		burst[n++] = next_value;
+		*next_mb = NULL;
+	}
+
+	while (*next_mb == NULL && n < RTE_DISTRIB_BURST_SIZE &&
+			next_idx < num_mbufs) {
+		struct rte_mbuf *mb = mbufs[next_idx];
+		uint32_t tag = mb->hash.usr;
+		int match = match_tag(d, tag);
+
+		if (match >= 0) {
+			/* stop at a packet for a full backlog, the caller
+			 * will wait for its worker */
+			if (add_to_backlog(&d->backlog[match],
+					((int64_t)(uintptr_t)mb) <<
+					RTE_DISTRIB_FLAG_BITS, tag) < 0)
+				break;
+		} else {
+			/* the packets of a flow already in this burst are
+			 * processed in order by this worker too */
+			tags[n] = tag;
+			burst[n++] = ((int64_t)(uintptr_t)mb) <<
+					RTE_DISTRIB_FLAG_BITS;
+		}
+		next_idx++;
+	}
+
+	for (i = n; i < RTE_DISTRIB_BURST_SIZE; i++)
+		buf->bufptr64[i] = 0;
+	for (i = n - 1; i > 0; i--)
+		buf->bufptr64[i] = burst[i];
+	/* the first entry clears the request flags, it is written last */
+	buf->bufptr64[0] = burst[0];
+
+	set_in_flight(d, wkr, tags, n);
+
+	return next_idx;
+}
+
 static inline void
 handle_worker_shutdown(struct rte_distributor *d, unsigned wkr)
 {
-	d->in_flight_tags[wkr] = 0;
-	d->in_flight_bitmask &= ~(1UL << wkr);
-	d->bufs[wkr].bufptr64 = 0;
+	clear_in_flight(d, wkr);
+	d->bufs[wkr].bufptr64[0] = 0;
 	if (unlikely(d->backlog[wkr].count != 0)) {
 		/* On return of a packet, we need to move the
 		 * queued packets for this core elsewhere.
@@ -249,18 +550,35 @@ process_returns(struct rte_distributor *d)
 
 	for (wkr = 0; wkr < d->num_workers; wkr++) {
 
-		const int64_t data = d->bufs[wkr].bufptr64;
+		const int64_t data = d->bufs[wkr].bufptr64[0];
 		uintptr_t oldbuf = 0;
 
-		if (data & RTE_DISTRIB_GET_BUF) {
+		if (data & RTE_DISTRIB_BURST_BUF) {
+			if (data & (RTE_DISTRIB_GET_BUF |
+					RTE_DISTRIB_RETURN_BUF))
+				store_burst_returns(d, wkr, &ret_start,
+						&ret_count);
+			if (data & RTE_DISTRIB_GET_BUF) {
+				flushed++;
+				/* the request stays pending if there is
+				 * nothing to give */
+				if (d->backlog[wkr].count) {
+					struct rte_mbuf *none = NULL;
+
+					give_burst(d, wkr, &none, 0, 0,
+							NULL, 0, 0);
+				} else
+					clear_in_flight(d, wkr);
+			} else if (data & RTE_DISTRIB_RETURN_BUF)
+				handle_worker_shutdown(d, wkr);
+		} else if (data & RTE_DISTRIB_GET_BUF) {
 			flushed++;
 			if (d->backlog[wkr].count)
-				d->bufs[wkr].bufptr64 =
+				d->bufs[wkr].bufptr64[0] =
 						backlog_pop(&d->backlog[wkr]);
 			else {
-				d->bufs[wkr].bufptr64 = RTE_DISTRIB_GET_BUF;
-				d->in_flight_tags[wkr] = 0;
-				d->in_flight_bitmask &= ~(1UL << wkr);
+				d->bufs[wkr].bufptr64[0] = RTE_DISTRIB_GET_BUF;
+				clear_in_flight(d, wkr);
 			}
 			oldbuf = data >> RTE_DISTRIB_FLAG_BITS;
 		} else if (data & RTE_DISTRIB_RETURN_BUF) {
@@ -295,7 +613,7 @@ rte_distributor_process(struct rte_distributor *d,
 
 	while (next_idx < num_mbufs || next_mb != NULL) {
 
-		int64_t data = d->bufs[wkr].bufptr64;
+		int64_t data = d->bufs[wkr].bufptr64[0];
 		uintptr_t oldbuf = 0;
 
 		if (!next_mb) {
@@ -310,30 +628,12 @@ rte_distributor_process(struct rte_distributor *d,
 			 */
 			new_tag = next_mb->hash.usr;
 
-			/*
-			 * Note that if RTE_DISTRIB_MAX_WORKERS is larger than 64
-			 * then the size of match has to be expanded.
-			 */
-			uint64_t match = 0;
-			unsigned i;
-			/*
-			 * to scan for a match use "xor" and "not" to get a 0/1
-			 * value, then use shifting to merge to single "match"
-			 * variable, where a one-bit indicates a match for the
-			 * worker given by the bit-position
-			 */
-			for (i = 0; i < d->num_workers; i++)
-				match |= (!(d->in_flight_tags[i] ^ new_tag)
-					<< i);
-
-			/* Only turned-on bits are considered as match */
-			match &= d->in_flight_bitmask;
+			int worker = match_tag(d, new_tag);
 
-			if (match) {
+			if (worker >= 0) {
 				next_mb = NULL;
-				unsigned worker = __builtin_ctzl(match);
 				if (add_to_backlog(&d->backlog[worker],
-						next_value) < 0)
+						next_value, new_tag) < 0)
 					next_idx--;
 			}
 		}
@@ -341,18 +641,26 @@ rte_distributor_process(struct rte_distributor *d,
 		if ((data & RTE_DISTRIB_GET_BUF) &&
 				(d->backlog[wkr].count || next_mb)) {
 
-			if (d->backlog[wkr].count)
-				d->bufs[wkr].bufptr64 =
+			if (data & RTE_DISTRIB_BURST_BUF) {
+				store_burst_returns(d, wkr, &ret_start,
+						&ret_count);
+				next_idx = give_burst(d, wkr, &next_mb,
+						next_value, new_tag, mbufs,
+						next_idx, num_mbufs);
+			} else if (d->backlog[wkr].count)
+				d->bufs[wkr].bufptr64[0] =
 						backlog_pop(&d->backlog[wkr]);
 
 			else {
-				d->bufs[wkr].bufptr64 = next_value;
-				d->in_flight_tags[wkr] = new_tag;
-				d->in_flight_bitmask |= (1UL << wkr);
+				d->bufs[wkr].bufptr64[0] = next_value;
+				set_in_flight(d, wkr, &new_tag, 1);
 				next_mb = NULL;
 			}
 			oldbuf = data >> RTE_DISTRIB_FLAG_BITS;
 		} else if (data & RTE_DISTRIB_RETURN_BUF) {
+			if (data & RTE_DISTRIB_BURST_BUF)
+				store_burst_returns(d, wkr, &ret_start,
+						&ret_count);
 			handle_worker_shutdown(d, wkr);
 			oldbuf = data >> RTE_DISTRIB_FLAG_BITS;
 		}
@@ -367,13 +675,20 @@ rte_distributor_process(struct rte_distributor *d,
 	 * if they are ready */
 	for (wkr = 0; wkr < d->num_workers; wkr++)
 		if (d->backlog[wkr].count &&
-				(d->bufs[wkr].bufptr64 & RTE_DISTRIB_GET_BUF)) {
+				(d->bufs[wkr].bufptr64[0] & RTE_DISTRIB_GET_BUF)) {
 
-			int64_t oldbuf = d->bufs[wkr].bufptr64 >>
+			int64_t oldbuf = d->bufs[wkr].bufptr64[0] >>
 					RTE_DISTRIB_FLAG_BITS;
 			store_return(oldbuf, d, &ret_start, &ret_count);
 
-			d->bufs[wkr].bufptr64 = backlog_pop(&d->backlog[wkr]);
+			if (d->bufs[wkr].bufptr64[0] & RTE_DISTRIB_BURST_BUF) {
+				store_burst_returns(d, wkr, &ret_start,
+						&ret_count);
+				next_mb = NULL;
+				give_burst(d, wkr, &next_mb, 0, 0, NULL, 0, 0);
+			} else
+				d->bufs[wkr].bufptr64[0] =
+						backlog_pop(&d->backlog[wkr]);
 		}
 
 	d->returns.start = ret_start;
@@ -406,12 +721,11 @@ rte_distributor_returned_pkts(struct rte_distributor *d,
 static inline unsigned
 total_outstanding(const struct rte_distributor *d)
 {
-	unsigned wkr, total_outstanding;
-
-	total_outstanding = __builtin_popcountl(d->in_flight_bitmask);
+	unsigned wkr, total_outstanding = 0;
 
 	for (wkr = 0; wkr < d->num_workers; wkr++)
-		total_outstanding += d->backlog[wkr].count;
+		total_outstanding += d->in_flight_count[wkr] +
+				d->backlog[wkr].count;
 
 	return total_outstanding;
 }
@@ -452,11 +766,12 @@ rte_distributor_create(const char *name,
 
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(*d) & RTE_CACHE_LINE_MASK) != 0);
-	RTE_BUILD_BUG_ON((RTE_DISTRIB_MAX_WORKERS & 7) != 0);
+	RTE_BUILD_BUG_ON((RTE_DISTRIB_MAX_WORKERS & 63) != 0);
 	RTE_BUILD_BUG_ON(RTE_DISTRIB_MAX_WORKERS >
 				sizeof(d->in_flight_bitmask) * CHAR_BIT);
+	RTE_BUILD_BUG_ON(sizeof(d->in_flight_tags[0]) != 32);
 
-	if (name == NULL || num_workers >= RTE_DISTRIB_MAX_WORKERS) {
+	if (name == NULL || num_workers > RTE_DISTRIB_MAX_WORKERS) {
 		rte_errno = EINVAL;
 		return NULL;
 	}
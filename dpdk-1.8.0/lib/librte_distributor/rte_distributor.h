@@ -39,7 +39,9 @@
  * RTE distributor
  *
  * The distributor is a component which is designed to pass packets
- * one-at-a-time to workers, with dynamic load balancing.
+ * one-at-a-time to workers, with dynamic load balancing. Workers can also
+ * exchange packets by bursts of up to RTE_DISTRIB_BURST_SIZE with the
+ * distributor, see rte_distributor_get_pkt_burst().
  */
 
 #ifdef __cplusplus
@@ -50,6 +52,12 @@ extern "C" {
 
 #define RTE_DISTRIBUTOR_NAMESIZE 32 /**< Length of name for instance */
 
+/** Maximum number of packets exchanged at once with a burst worker. */
+#define RTE_DISTRIB_BURST_SIZE 8
+
+/** Maximum number of workers of a distributor instance. */
+#define RTE_DISTRIB_MAX_WORKERS 256
+
 struct rte_distributor;
 
 /**
@@ -64,7 +72,7 @@ struct rte_distributor;
  *   The NUMA node on which the memory is to be allocated
  * @param num_workers
  *   The maximum number of workers that will request packets from this
- *   distributor
+ *   distributor, up to RTE_DISTRIB_MAX_WORKERS
  * @return
  *   The newly created distributor instance
  */
@@ -241,6 +249,110 @@ struct rte_mbuf *
 rte_distributor_poll_pkt(struct rte_distributor *d,
 		unsigned worker_id);
 
+/**
+ * API called by a worker to get a burst of new packets to process. Any
+ * previous packets given to the worker are assumed to have completed
+ * processing, and may be optionally returned to the distributor via the
+ * oldpkt array.
+ *
+ * Up to RTE_DISTRIB_BURST_SIZE packets are exchanged in each direction
+ * through one cache line, instead of one packet per cache line exchange
+ * with rte_distributor_get_pkt(). The packets of a burst with the same
+ * tag are given in order, and the worker must process them in order.
+ * A worker must use either the burst or the single packet functions.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param pkts
+ *   The array of RTE_DISTRIB_BURST_SIZE entries to be filled with the new
+ *   packets.
+ * @param oldpkt
+ *   The previous packets, if any, being processed by the worker
+ * @param retcount
+ *   The number of packets in the oldpkt array, at most
+ *   RTE_DISTRIB_BURST_SIZE.
+ *
+ * @return
+ *   The number of new packets, or -EINVAL if retcount is too large.
+ */
+int
+rte_distributor_get_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts,
+		struct rte_mbuf **oldpkt, unsigned retcount);
+
+/**
+ * API called by a worker to return a burst of completed packets without
+ * requesting new packets, for example, because a worker thread is shutting
+ * down.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param oldpkt
+ *   The previous packets being processed by the worker
+ * @param num
+ *   The number of packets in the oldpkt array, at most
+ *   RTE_DISTRIB_BURST_SIZE.
+ * @return
+ *   0 on success, or -EINVAL if num is too large.
+ */
+int
+rte_distributor_return_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned num);
+
+/**
+ * API called by a worker to request a burst of new packets, returning the
+ * previous ones, without waiting for the new packets. See
+ * rte_distributor_get_pkt_burst() for details.
+ *
+ * NOTE: after calling this function, rte_distributor_poll_pkt_burst()
+ * should be used to poll for the packets requested.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param oldpkt
+ *   The previous packets, if any, being processed by the worker
+ * @param retcount
+ *   The number of packets in the oldpkt array, at most
+ *   RTE_DISTRIB_BURST_SIZE.
+ * @return
+ *   0 on success, or -EINVAL if retcount is too large.
+ */
+int
+rte_distributor_request_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt,
+		unsigned retcount);
+
+/**
+ * API called by a worker to check for the new packets previously requested
+ * by a call to rte_distributor_request_pkt_burst(). It does not wait for
+ * the new packets to be available.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param pkts
+ *   The array of RTE_DISTRIB_BURST_SIZE entries to be filled with the new
+ *   packets.
+ *
+ * @return
+ *   The number of new packets, 0 if the request has not yet been fulfilled
+ *   by the distributor.
+ */
+int
+rte_distributor_poll_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts);
+
 #ifdef __cplusplus
 }
 #endif
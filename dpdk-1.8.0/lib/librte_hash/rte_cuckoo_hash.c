@@ -0,0 +1,552 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_memcpy.h>
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+#include <rte_atomic.h>
+#include <rte_common_vect.h>
+
+#include "rte_hash.h"
+#include "rte_cuckoo_hash.h"
+
+/* Signature of an empty entry, real signatures have the high bit set */
+#define NULL_SIGNATURE          0
+
+/* Number of buckets that can be visited to find room for a new key */
+#define CUCKOO_BFS_QUEUE_LEN    512
+
+/* Number of times the search is restarted if the path found is stale */
+#define CUCKOO_MAX_RETRIES      4
+
+/* Multiplier mixing a signature into its alternative signature */
+#define CUCKOO_ALT_SIG_MUL      0x5bd1e995
+
+/* Node of the breadth-first search for a free slot */
+struct cuckoo_queue_node {
+	struct rte_hash_bucket *bkt; /* Bucket visited */
+	int prev;                    /* Node of the bucket of the moved entry */
+	int prev_slot;               /* Slot of the moved entry in prev */
+};
+
+uint32_t
+rte_hash_cuckoo_mem_size(uint32_t entries, uint32_t key_size)
+{
+	uint32_t num_buckets = entries / RTE_HASH_CUCKOO_BUCKET_ENTRIES;
+
+	return RTE_ALIGN_CEIL(num_buckets * sizeof(struct rte_hash_bucket),
+			RTE_CACHE_LINE_SIZE) +
+		RTE_ALIGN_CEIL((entries + 1) * key_size,
+			RTE_CACHE_LINE_SIZE) +
+		sizeof(struct rte_hash_cuckoo_state) +
+		entries * sizeof(uint32_t);
+}
+
+void
+rte_hash_cuckoo_init(struct rte_hash *h, uint8_t *mem)
+{
+	uint32_t i;
+
+	h->buckets = (struct rte_hash_bucket *)mem;
+	mem += RTE_ALIGN_CEIL(h->num_buckets * sizeof(struct rte_hash_bucket),
+			RTE_CACHE_LINE_SIZE);
+	/* slot 0 of the key store is never used */
+	h->key_tbl = mem;
+	mem += RTE_ALIGN_CEIL((h->entries + 1) * h->key_tbl_key_size,
+			RTE_CACHE_LINE_SIZE);
+	h->cuckoo = (struct rte_hash_cuckoo_state *)mem;
+
+	/* the memory is zeroed: all the entries are empty */
+	h->cuckoo->tbl_chng_cnt = 0;
+	for (i = 0; i < h->entries; i++)
+		h->cuckoo->free_slots[i] = h->entries - i;
+	h->cuckoo->nb_free_slots = h->entries;
+}
+
+/* Returns the signature of the other bucket of a key. */
+static inline hash_sig_t
+cuckoo_alt_sig(const struct rte_hash *h, hash_sig_t sig)
+{
+	return (sig ^ (((sig >> 16) + 1) * CUCKOO_ALT_SIG_MUL)) | h->sig_msb;
+}
+
+static inline struct rte_hash_bucket *
+cuckoo_bucket(const struct rte_hash *h, hash_sig_t sig)
+{
+	return &h->buckets[sig & h->bucket_bitmask];
+}
+
+static inline void *
+cuckoo_key(const struct rte_hash *h, uint32_t key_idx)
+{
+	return &h->key_tbl[key_idx * h->key_tbl_key_size];
+}
+
+static inline void **
+cuckoo_key_data(const struct rte_hash *h, uint32_t key_idx)
+{
+	return (void **) &h->key_tbl[key_idx * h->key_tbl_key_size +
+				     h->key_data_offset];
+}
+
+/* Returns the slot of the key in the bucket, or -1 if not found. */
+static inline int
+cuckoo_search_bucket(const struct rte_hash *h,
+		const struct rte_hash_bucket *bkt, hash_sig_t sig,
+		const void *key)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+		if (bkt->sig_current[i] == sig &&
+		    likely(memcmp(key, cuckoo_key(h, bkt->key_idx[i]),
+				  h->key_len) == 0))
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * Write an entry in an empty slot. The key index and the alternative
+ * signature are written first, so that a concurrent lookup matching the
+ * signature sees a complete entry.
+ */
+static inline void
+cuckoo_write_entry(struct rte_hash_bucket *bkt, uint32_t slot,
+		hash_sig_t sig, hash_sig_t alt, uint32_t key_idx)
+{
+	bkt->key_idx[slot] = key_idx;
+	bkt->sig_alt[slot] = alt;
+	rte_wmb();
+	bkt->sig_current[slot] = sig;
+}
+
+/* Returns the first empty slot of the bucket, or -1 if full. */
+static inline int
+cuckoo_free_slot(const struct rte_hash_bucket *bkt)
+{
+	uint32_t i;
+
+	for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+		if (bkt->sig_current[i] == NULL_SIGNATURE)
+			return i;
+	}
+	return -1;
+}
+
+/*
+ * Move the entries along the path ending at a free slot of the bucket of
+ * queue[node], starting from the end, so that each key is always present
+ * in one of its buckets. Returns the slot freed in the first bucket of
+ * the path, or -1 if the table changed since the path was found.
+ */
+static int
+cuckoo_move_path(const struct rte_hash *h,
+		const struct cuckoo_queue_node *queue, int node, int free_slot)
+{
+	struct rte_hash_bucket *cur_bkt, *prev_bkt;
+	int prev_slot;
+
+	while (queue[node].prev >= 0) {
+		cur_bkt = queue[node].bkt;
+		prev_bkt = queue[queue[node].prev].bkt;
+		prev_slot = queue[node].prev_slot;
+
+		/* check the entry still belongs to the path */
+		if (cur_bkt->sig_current[free_slot] != NULL_SIGNATURE ||
+		    prev_bkt->sig_current[prev_slot] == NULL_SIGNATURE ||
+		    cuckoo_bucket(h, prev_bkt->sig_alt[prev_slot]) != cur_bkt)
+			return -1;
+
+		/* copy the entry to its other bucket, swapping signatures */
+		cuckoo_write_entry(cur_bkt, free_slot,
+				prev_bkt->sig_alt[prev_slot],
+				prev_bkt->sig_current[prev_slot],
+				prev_bkt->key_idx[prev_slot]);
+
+		/*
+		 * a lookup that does not find the entry in its old slot
+		 * will see the counter change and retry
+		 */
+		rte_wmb();
+		h->cuckoo->tbl_chng_cnt++;
+		rte_wmb();
+		prev_bkt->sig_current[prev_slot] = NULL_SIGNATURE;
+
+		free_slot = prev_slot;
+		node = queue[node].prev;
+	}
+	return free_slot;
+}
+
+/*
+ * Free a slot in one of the two buckets of a key, by moving entries to
+ * their other bucket. Returns the slot and sets *bkt to its bucket, or
+ * returns -1 if no slot can be freed.
+ */
+static int
+cuckoo_make_space(const struct rte_hash *h, struct rte_hash_bucket **bkt,
+		struct rte_hash_bucket *prim_bkt, struct rte_hash_bucket *sec_bkt)
+{
+	struct cuckoo_queue_node queue[CUCKOO_BFS_QUEUE_LEN];
+	struct rte_hash_bucket *cur_bkt;
+	int head, tail, node, slot, i;
+	unsigned retries;
+
+	for (retries = 0; retries < CUCKOO_MAX_RETRIES; retries++) {
+		head = 0;
+		tail = 0;
+		queue[tail].bkt = prim_bkt;
+		queue[tail].prev = -1;
+		queue[tail++].prev_slot = -1;
+		queue[tail].bkt = sec_bkt;
+		queue[tail].prev = -1;
+		queue[tail++].prev_slot = -1;
+
+		slot = -1;
+		node = -1;
+		while (head < tail) {
+			cur_bkt = queue[head].bkt;
+			slot = cuckoo_free_slot(cur_bkt);
+			if (slot >= 0) {
+				node = head;
+				break;
+			}
+			if (tail + RTE_HASH_CUCKOO_BUCKET_ENTRIES >
+					CUCKOO_BFS_QUEUE_LEN) {
+				head++;
+				continue;
+			}
+			/* visit the other bucket of each entry */
+			for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+				queue[tail].bkt = cuckoo_bucket(h,
+						cur_bkt->sig_alt[i]);
+				queue[tail].prev = head;
+				queue[tail++].prev_slot = i;
+			}
+			head++;
+		}
+		if (node < 0)
+			return -1;
+
+		slot = cuckoo_move_path(h, queue, node, slot);
+		if (slot >= 0) {
+			/* the path starts from the primary or secondary bucket */
+			while (queue[node].prev >= 0)
+				node = queue[node].prev;
+			*bkt = queue[node].bkt;
+			return slot;
+		}
+	}
+	return -1;
+}
+
+int32_t
+rte_hash_cuckoo_add(const struct rte_hash *h, const void *key,
+		hash_sig_t sig, void *data)
+{
+	struct rte_hash_cuckoo_state *state = h->cuckoo;
+	struct rte_hash_bucket *prim_bkt, *sec_bkt, *bkt;
+	hash_sig_t alt;
+	uint32_t key_idx;
+	int slot;
+
+	sig |= h->sig_msb;
+	alt = cuckoo_alt_sig(h, sig);
+	prim_bkt = cuckoo_bucket(h, sig);
+	sec_bkt = cuckoo_bucket(h, alt);
+
+	/* Check if key is already present in the hash, update its data */
+	bkt = prim_bkt;
+	slot = cuckoo_search_bucket(h, bkt, sig, key);
+	if (slot < 0) {
+		bkt = sec_bkt;
+		slot = cuckoo_search_bucket(h, bkt, alt, key);
+	}
+	if (slot >= 0) {
+		if (h->flags & RTE_HASH_F_USER_DATA)
+			*cuckoo_key_data(h, bkt->key_idx[slot]) = data;
+		return bkt->key_idx[slot] - 1;
+	}
+
+	if (unlikely(state->nb_free_slots == 0))
+		return -ENOSPC;
+
+	/* Find a free slot in one of the buckets, or make one */
+	slot = cuckoo_free_slot(prim_bkt);
+	if (slot >= 0)
+		bkt = prim_bkt;
+	else {
+		slot = cuckoo_free_slot(sec_bkt);
+		if (slot >= 0)
+			bkt = sec_bkt;
+		else {
+			slot = cuckoo_make_space(h, &bkt, prim_bkt, sec_bkt);
+			if (slot < 0)
+				return -ENOSPC;
+		}
+	}
+
+	/* Store the key, then make the entry visible */
+	key_idx = state->free_slots[--state->nb_free_slots];
+	rte_memcpy(cuckoo_key(h, key_idx), key, h->key_len);
+	if (h->flags & RTE_HASH_F_USER_DATA)
+		*cuckoo_key_data(h, key_idx) = data;
+	rte_wmb();
+	if (bkt == prim_bkt)
+		cuckoo_write_entry(bkt, slot, sig, alt, key_idx);
+	else
+		cuckoo_write_entry(bkt, slot, alt, sig, key_idx);
+
+	return key_idx - 1;
+}
+
+int32_t
+rte_hash_cuckoo_del(const struct rte_hash *h, const void *key,
+		hash_sig_t sig)
+{
+	struct rte_hash_cuckoo_state *state = h->cuckoo;
+	struct rte_hash_bucket *bkt;
+	hash_sig_t alt;
+	uint32_t key_idx;
+	int slot;
+
+	sig |= h->sig_msb;
+	alt = cuckoo_alt_sig(h, sig);
+
+	bkt = cuckoo_bucket(h, sig);
+	slot = cuckoo_search_bucket(h, bkt, sig, key);
+	if (slot < 0) {
+		bkt = cuckoo_bucket(h, alt);
+		slot = cuckoo_search_bucket(h, bkt, alt, key);
+		if (slot < 0)
+			return -ENOENT;
+	}
+
+	/*
+	 * the key index is kept in the entry, a concurrent lookup reading it
+	 * compares against the old key until the slot is reused
+	 */
+	key_idx = bkt->key_idx[slot];
+	bkt->sig_current[slot] = NULL_SIGNATURE;
+	if (!(h->flags & RTE_HASH_F_NO_FREE_ON_DEL))
+		state->free_slots[state->nb_free_slots++] = key_idx;
+
+	return key_idx - 1;
+}
+
+int
+rte_hash_cuckoo_free_key(const struct rte_hash *h, int32_t position)
+{
+	struct rte_hash_cuckoo_state *state = h->cuckoo;
+
+	/* more frees than deletes would overflow the stack */
+	if (unlikely(state->nb_free_slots >= h->entries))
+		return -EINVAL;
+
+	state->free_slots[state->nb_free_slots++] = position + 1;
+	return 0;
+}
+
+int32_t
+rte_hash_cuckoo_lookup(const struct rte_hash *h, const void *key,
+		hash_sig_t sig)
+{
+	const struct rte_hash_bucket *prim_bkt, *sec_bkt;
+	hash_sig_t alt;
+	uint32_t cnt;
+	int slot;
+
+	sig |= h->sig_msb;
+	alt = cuckoo_alt_sig(h, sig);
+	prim_bkt = cuckoo_bucket(h, sig);
+	sec_bkt = cuckoo_bucket(h, alt);
+
+	do {
+		cnt = h->cuckoo->tbl_chng_cnt;
+		rte_rmb();
+
+		slot = cuckoo_search_bucket(h, prim_bkt, sig, key);
+		if (slot >= 0)
+			return prim_bkt->key_idx[slot] - 1;
+		slot = cuckoo_search_bucket(h, sec_bkt, alt, key);
+		if (slot >= 0)
+			return sec_bkt->key_idx[slot] - 1;
+
+		/* the key may have moved between the two searches */
+		rte_rmb();
+	} while (unlikely(cnt != h->cuckoo->tbl_chng_cnt));
+
+	return -ENOENT;
+}
+
+/* Returns a bitmask of the entries of a bucket matching a signature. */
+static inline uint32_t
+cuckoo_compare_signatures(const struct rte_hash_bucket *bkt, hash_sig_t sig)
+{
+#if defined(RTE_MACHINE_CPUFLAG_SSE2)
+	return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(
+			_mm_set1_epi32(sig),
+			_mm_load_si128((const __m128i *)bkt->sig_current))));
+#else
+	uint32_t i, mask = 0;
+
+	for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+		if (bkt->sig_current[i] == sig)
+			mask |= 1 << i;
+	}
+	return mask;
+#endif
+}
+
+/*
+ * Lookup a burst of keys in three stages: compute the signatures and
+ * prefetch both buckets, compare the signatures and prefetch the matching
+ * keys, then compare the keys. The keys missed while entries were being
+ * moved are looked up again one by one.
+ */
+uint64_t
+rte_hash_cuckoo_lookup_burst(const struct rte_hash *h, const void **keys,
+		uint32_t num_keys, int32_t *positions)
+{
+	hash_sig_t sigs[RTE_HASH_LOOKUP_BURST_MAX];
+	hash_sig_t alts[RTE_HASH_LOOKUP_BURST_MAX];
+	uint8_t prim_hits[RTE_HASH_LOOKUP_BURST_MAX];
+	uint8_t sec_hits[RTE_HASH_LOOKUP_BURST_MAX];
+	const struct rte_hash_bucket *bkt;
+	uint64_t hits = 0, misses;
+	uint32_t i, cnt;
+	int slot;
+
+	/* Get the hash signatures and prefetch both buckets */
+	for (i = 0; i < num_keys; i++) {
+		sigs[i] = h->hash_func(keys[i], h->key_len,
+				h->hash_func_init_val) | h->sig_msb;
+		alts[i] = cuckoo_alt_sig(h, sigs[i]);
+		rte_prefetch0(cuckoo_bucket(h, sigs[i]));
+		rte_prefetch0(cuckoo_bucket(h, alts[i]));
+	}
+
+	cnt = h->cuckoo->tbl_chng_cnt;
+	rte_rmb();
+
+	/* Compare the signatures and prefetch the first matching keys */
+	for (i = 0; i < num_keys; i++) {
+		bkt = cuckoo_bucket(h, sigs[i]);
+		prim_hits[i] = cuckoo_compare_signatures(bkt, sigs[i]);
+		if (prim_hits[i] != 0)
+			rte_prefetch0(cuckoo_key(h,
+				bkt->key_idx[__builtin_ctz(prim_hits[i])]));
+		bkt = cuckoo_bucket(h, alts[i]);
+		sec_hits[i] = cuckoo_compare_signatures(bkt, alts[i]);
+		if (sec_hits[i] != 0)
+			rte_prefetch0(cuckoo_key(h,
+				bkt->key_idx[__builtin_ctz(sec_hits[i])]));
+	}
+
+	/* Compare the keys of the entries with a matching signature */
+	for (i = 0; i < num_keys; i++) {
+		positions[i] = -ENOENT;
+
+		bkt = cuckoo_bucket(h, sigs[i]);
+		while (prim_hits[i] != 0) {
+			slot = __builtin_ctz(prim_hits[i]);
+			if (likely(memcmp(keys[i], cuckoo_key(h,
+					bkt->key_idx[slot]), h->key_len) == 0))
+				goto hit;
+			prim_hits[i] &= prim_hits[i] - 1;
+		}
+		bkt = cuckoo_bucket(h, alts[i]);
+		while (sec_hits[i] != 0) {
+			slot = __builtin_ctz(sec_hits[i]);
+			if (likely(memcmp(keys[i], cuckoo_key(h,
+					bkt->key_idx[slot]), h->key_len) == 0))
+				goto hit;
+			sec_hits[i] &= sec_hits[i] - 1;
+		}
+		continue;
+hit:
+		positions[i] = bkt->key_idx[slot] - 1;
+		hits |= (uint64_t)1 << i;
+	}
+
+	/* Retry the misses if an entry was moved during the lookup */
+	rte_rmb();
+	if (unlikely(cnt != h->cuckoo->tbl_chng_cnt)) {
+		misses = ~hits & (UINT64_MAX >> (64 - num_keys));
+		while (misses != 0) {
+			i = __builtin_ctzll(misses);
+			positions[i] = rte_hash_cuckoo_lookup(h, keys[i],
+							      sigs[i]);
+			if (positions[i] >= 0)
+				hits |= (uint64_t)1 << i;
+			misses &= misses - 1;
+		}
+	}
+
+	return hits;
+}
+
+int32_t
+rte_hash_cuckoo_iterate(const struct rte_hash *h, const void **key,
+		void **data, uint32_t *next)
+{
+	const struct rte_hash_bucket *bkt;
+	uint32_t total = h->num_buckets * RTE_HASH_CUCKOO_BUCKET_ENTRIES;
+	uint32_t idx, slot, key_idx;
+
+	/* Find the next used entry, in bucket order */
+	for (idx = *next; idx < total; idx++) {
+		bkt = &h->buckets[idx / RTE_HASH_CUCKOO_BUCKET_ENTRIES];
+		slot = idx % RTE_HASH_CUCKOO_BUCKET_ENTRIES;
+		if (bkt->sig_current[slot] != NULL_SIGNATURE)
+			break;
+	}
+	if (idx >= total) {
+		*next = total;
+		return -ENOENT;
+	}
+	*next = idx + 1;
+
+	key_idx = bkt->key_idx[slot];
+	*key = cuckoo_key(h, key_idx);
+	*data = (h->flags & RTE_HASH_F_USER_DATA) ?
+		*cuckoo_key_data(h, key_idx) : NULL;
+	return key_idx - 1;
+}
@@ -0,0 +1,106 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_CUCKOO_HASH_H_
+#define _RTE_CUCKOO_HASH_H_
+
+/*
+ * Cuckoo hash table, used by rte_hash when created with RTE_HASH_F_CUCKOO.
+ *
+ * Each key has two candidate buckets: the primary one, selected by its
+ * signature, and the secondary one, selected by an alternative signature
+ * derived from the first one. Both signatures are stored with the entry,
+ * so that an entry can be moved to its other bucket without the key.
+ * When both buckets are full, a breadth-first search finds a path of
+ * entries that can be moved to their other bucket to free a slot.
+ *
+ * Keys are stored in a separate array, indexed by the slot allocated to
+ * the key when it is added. That index does not change when the entry
+ * is moved, so it is the position returned to the user.
+ */
+
+#include <stdint.h>
+
+#include <rte_memory.h>
+
+#include "rte_hash.h"
+
+/** A bucket of a cuckoo hash table, filling one cache line. */
+struct rte_hash_bucket {
+	/** Signature selecting the bucket the entry is in, 0 if empty. */
+	hash_sig_t sig_current[RTE_HASH_CUCKOO_BUCKET_ENTRIES];
+	/** Signature selecting the other bucket of the entry. */
+	hash_sig_t sig_alt[RTE_HASH_CUCKOO_BUCKET_ENTRIES];
+	/** Index of the key in the key store, starting at 1. */
+	uint32_t key_idx[RTE_HASH_CUCKOO_BUCKET_ENTRIES];
+} __rte_cache_aligned;
+
+/** State of a cuckoo hash table updated by the writer. */
+struct rte_hash_cuckoo_state {
+	/**
+	 * Incremented each time an entry is moved, so that a lookup that
+	 * missed a key being moved can retry.
+	 */
+	volatile uint32_t tbl_chng_cnt __rte_cache_aligned;
+	/** Number of free key slots. */
+	uint32_t nb_free_slots __rte_cache_aligned;
+	/** Stack of free key slots. */
+	uint32_t free_slots[0];
+};
+
+/* Return the memory needed for the tables of a cuckoo hash. */
+uint32_t rte_hash_cuckoo_mem_size(uint32_t entries, uint32_t key_size);
+
+/* Set up the tables of a cuckoo hash in the memory following h. */
+void rte_hash_cuckoo_init(struct rte_hash *h, uint8_t *mem);
+
+int32_t rte_hash_cuckoo_add(const struct rte_hash *h, const void *key,
+		hash_sig_t sig, void *data);
+
+int32_t rte_hash_cuckoo_del(const struct rte_hash *h, const void *key,
+		hash_sig_t sig);
+
+/* Free the key slot of a position deleted with RTE_HASH_F_NO_FREE_ON_DEL. */
+int rte_hash_cuckoo_free_key(const struct rte_hash *h, int32_t position);
+
+int32_t rte_hash_cuckoo_lookup(const struct rte_hash *h, const void *key,
+		hash_sig_t sig);
+
+/* Lookup up to RTE_HASH_LOOKUP_BURST_MAX keys, returning the hit mask. */
+uint64_t rte_hash_cuckoo_lookup_burst(const struct rte_hash *h,
+		const void **keys, uint32_t num_keys, int32_t *positions);
+
+int32_t rte_hash_cuckoo_iterate(const struct rte_hash *h, const void **key,
+		void **data, uint32_t *next);
+
+#endif /* _RTE_CUCKOO_HASH_H_ */
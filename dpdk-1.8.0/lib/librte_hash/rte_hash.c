@@ -56,8 +56,10 @@
 #include <rte_log.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
+#include <rte_common_vect.h>
 
 #include "rte_hash.h"
+#include "rte_cuckoo_hash.h"
 
 
 TAILQ_HEAD(rte_hash_list, rte_tailq_entry);
@@ -112,6 +114,23 @@ get_key_from_bucket(const struct rte_hash *h, uint8_t *bkt, uint32_t pos)
 	return (void *) &bkt[pos * h->key_tbl_key_size];
 }
 
+/* Returns a pointer to the key at a position returned to the user. */
+static inline void *
+get_key_from_position(const struct rte_hash *h, int32_t pos)
+{
+	/* cuckoo tables do not use the first slot of the key table */
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		pos++;
+	return (void *) &h->key_tbl[pos * h->key_tbl_key_size];
+}
+
+/* Returns a pointer to the user data stored after a key. */
+static inline void **
+get_data_from_key(const struct rte_hash *h, void *key)
+{
+	return (void **) ((uint8_t *) key + h->key_data_offset);
+}
+
 /* Does integer division with rounding-up of result. */
 static inline uint32_t
 div_roundup(uint32_t numerator, uint32_t denominator)
@@ -126,16 +145,55 @@ align_size(uint32_t val, uint32_t alignment)
 	return alignment * div_roundup(val, alignment);
 }
 
-/* Returns the index into the bucket of the first occurrence of a signature. */
-static inline int
-find_first(uint32_t sig, const uint32_t *sig_bucket, uint32_t num_sigs)
+/*
+ * Returns a bitmask of the entries of a bucket matching a signature. The
+ * signature bucket is padded to SIG_BUCKET_ALIGNMENT, so it can be read
+ * by whole vectors.
+ */
+static inline uint32_t
+compare_signatures(uint32_t sig, const uint32_t *sig_bucket, uint32_t num_sigs)
 {
-	uint32_t i;
+	uint32_t i, mask = 0;
+
+#if defined(RTE_MACHINE_CPUFLAG_AVX2)
+	if (num_sigs >= 8) {
+		const __m256i sig8 = _mm256_set1_epi32(sig);
+
+		for (i = 0; i < num_sigs; i += 8)
+			mask |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(
+				_mm256_cmpeq_epi32(sig8, _mm256_loadu_si256(
+					(const __m256i *)&sig_bucket[i])))) << i;
+		return mask;
+	}
+#endif
+#if defined(RTE_MACHINE_CPUFLAG_SSE2)
+	const __m128i sig4 = _mm_set1_epi32(sig);
+
+	for (i = 0; i < num_sigs; i += 4)
+		mask |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(
+			_mm_cmpeq_epi32(sig4, _mm_load_si128(
+				(const __m128i *)&sig_bucket[i])))) << i;
+
+	/* buckets of less than 4 entries are compared with their padding */
+	return mask & (uint32_t)((UINT64_C(1) << num_sigs) - 1);
+#else
 	for (i = 0; i < num_sigs; i++) {
 		if (sig == sig_bucket[i])
-			return i;
+			mask |= 1 << i;
 	}
-	return -1;
+	return mask;
+#endif
+}
+
+/* Returns the index into the bucket of the first occurrence of a signature. */
+static inline int
+find_first(uint32_t sig, const uint32_t *sig_bucket, uint32_t num_sigs)
+{
+	uint32_t mask = compare_signatures(sig, sig_bucket, num_sigs);
+
+	if (mask == 0)
+		return -1;
+	return __builtin_ctz(mask);
 }
 
 struct rte_hash *
@@ -172,8 +230,8 @@ rte_hash_create(const struct rte_hash_parameters *params)
 {
 	struct rte_hash *h = NULL;
 	struct rte_tailq_entry *te;
-	uint32_t num_buckets, sig_bucket_size, key_size,
-		hash_tbl_size, sig_tbl_size, key_tbl_size, mem_size;
+	uint32_t num_buckets, sig_bucket_size, key_size, bucket_entries = 0,
+		key_data_offset = 0, hash_tbl_size, sig_tbl_size, key_tbl_size, mem_size;
 	char hash_name[RTE_HASH_NAMESIZE];
 	struct rte_hash_list *hash_list;
 
@@ -185,14 +243,20 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	}
 
 	/* Check for valid parameters */
+	if ((params != NULL) && (params->flags & RTE_HASH_F_CUCKOO))
+		bucket_entries = RTE_HASH_CUCKOO_BUCKET_ENTRIES;
+	else if (params != NULL)
+		bucket_entries = params->bucket_entries;
 	if ((params == NULL) ||
 			(params->entries > RTE_HASH_ENTRIES_MAX) ||
-			(params->bucket_entries > RTE_HASH_BUCKET_ENTRIES_MAX) ||
-			(params->entries < params->bucket_entries) ||
+			(bucket_entries > RTE_HASH_BUCKET_ENTRIES_MAX) ||
+			(params->entries < bucket_entries) ||
 			!rte_is_power_of_2(params->entries) ||
-			!rte_is_power_of_2(params->bucket_entries) ||
+			!rte_is_power_of_2(bucket_entries) ||
 			(params->key_len == 0) ||
-			(params->key_len > RTE_HASH_KEY_LENGTH_MAX)) {
+			(params->key_len > RTE_HASH_KEY_LENGTH_MAX) ||
+			((params->flags & RTE_HASH_F_NO_FREE_ON_DEL) &&
+			 !(params->flags & RTE_HASH_F_CUCKOO))) {
 		rte_errno = EINVAL;
 		RTE_LOG(ERR, HASH, "rte_hash_create has invalid parameters\n");
 		return NULL;
@@ -201,16 +265,29 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	snprintf(hash_name, sizeof(hash_name), "HT_%s", params->name);
 
 	/* Calculate hash dimensions */
-	num_buckets = params->entries / params->bucket_entries;
-	sig_bucket_size = align_size(params->bucket_entries *
+	num_buckets = params->entries / bucket_entries;
+	sig_bucket_size = align_size(bucket_entries *
 				     sizeof(hash_sig_t), SIG_BUCKET_ALIGNMENT);
 	key_size =  align_size(params->key_len, KEY_ALIGNMENT);
+	if (params->flags & RTE_HASH_F_USER_DATA) {
+		/* the user data follows the key, in the same cache line */
+		key_data_offset = align_size(params->key_len, sizeof(void *));
+		key_size = align_size(key_data_offset + sizeof(void *),
+				      KEY_ALIGNMENT);
+	}
 
 	hash_tbl_size = align_size(sizeof(struct rte_hash), RTE_CACHE_LINE_SIZE);
-	sig_tbl_size = align_size(num_buckets * sig_bucket_size,
-				  RTE_CACHE_LINE_SIZE);
-	key_tbl_size = align_size(num_buckets * key_size *
-				  params->bucket_entries, RTE_CACHE_LINE_SIZE);
+	if (params->flags & RTE_HASH_F_CUCKOO) {
+		/* buckets, keys and free slots are set up by the cuckoo code */
+		sig_tbl_size = 0;
+		key_tbl_size = rte_hash_cuckoo_mem_size(params->entries,
+							key_size);
+	} else {
+		sig_tbl_size = align_size(num_buckets * sig_bucket_size,
+					  RTE_CACHE_LINE_SIZE);
+		key_tbl_size = align_size(num_buckets * key_size *
+					  bucket_entries, RTE_CACHE_LINE_SIZE);
+	}
 
 	/* Total memory required for hash context */
 	mem_size = hash_tbl_size + sig_tbl_size + key_tbl_size;
@@ -243,7 +320,7 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	/* Setup hash context */
 	snprintf(h->name, sizeof(h->name), "%s", params->name);
 	h->entries = params->entries;
-	h->bucket_entries = params->bucket_entries;
+	h->bucket_entries = bucket_entries;
 	h->key_len = params->key_len;
 	h->hash_func_init_val = params->hash_func_init_val;
 	h->num_buckets = num_buckets;
@@ -253,8 +330,14 @@ rte_hash_create(const struct rte_hash_parameters *params)
 	h->sig_tbl_bucket_size = sig_bucket_size;
 	h->key_tbl = h->sig_tbl + sig_tbl_size;
 	h->key_tbl_key_size = key_size;
+	h->key_data_offset = key_data_offset;
 	h->hash_func = (params->hash_func == NULL) ?
 		DEFAULT_HASH_FUNC : params->hash_func;
+	h->flags = params->flags;
+	if (h->flags & RTE_HASH_F_CUCKOO) {
+		h->sig_tbl = NULL;
+		rte_hash_cuckoo_init(h, (uint8_t *)h + hash_tbl_size);
+	}
 
 	te->data = (void *) h;
 
@@ -305,7 +388,7 @@ rte_hash_free(struct rte_hash *h)
 
 static inline int32_t
 __rte_hash_add_key_with_hash(const struct rte_hash *h,
-				const void *key, hash_sig_t sig)
+				const void *key, hash_sig_t sig, void *data)
 {
 	hash_sig_t *sig_bucket;
 	uint8_t *key_bucket;
@@ -323,6 +406,9 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h,
 		if ((sig == sig_bucket[i]) &&
 		    likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
 				  h->key_len) == 0)) {
+			if (h->flags & RTE_HASH_F_USER_DATA)
+				*get_data_from_key(h, get_key_from_bucket(h,
+						key_bucket, i)) = data;
 			return bucket_index * h->bucket_entries + i;
 		}
 	}
@@ -336,6 +422,9 @@ __rte_hash_add_key_with_hash(const struct rte_hash *h,
 	/* Add the new key to the bucket */
 	sig_bucket[pos] = sig;
 	rte_memcpy(get_key_from_bucket(h, key_bucket, pos), key, h->key_len);
+	if (h->flags & RTE_HASH_F_USER_DATA)
+		*get_data_from_key(h, get_key_from_bucket(h, key_bucket, pos)) =
+			data;
 	return bucket_index * h->bucket_entries + pos;
 }
 
@@ -344,14 +433,39 @@ rte_hash_add_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_add_key_with_hash(h, key, sig);
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		return rte_hash_cuckoo_add(h, key, sig, NULL);
+	return __rte_hash_add_key_with_hash(h, key, sig, NULL);
 }
 
 int32_t
 rte_hash_add_key(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
-	return __rte_hash_add_key_with_hash(h, key, rte_hash_hash(h, key));
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		return rte_hash_cuckoo_add(h, key, rte_hash_hash(h, key), NULL);
+	return __rte_hash_add_key_with_hash(h, key, rte_hash_hash(h, key),
+					    NULL);
+}
+
+int32_t
+rte_hash_add_key_with_hash_data(const struct rte_hash *h,
+				const void *key, hash_sig_t sig, void *data)
+{
+	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (unlikely(!(h->flags & RTE_HASH_F_USER_DATA)))
+		return -EINVAL;
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		return rte_hash_cuckoo_add(h, key, sig, data);
+	return __rte_hash_add_key_with_hash(h, key, sig, data);
+}
+
+int32_t
+rte_hash_add_key_data(const struct rte_hash *h, const void *key, void *data)
+{
+	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	return rte_hash_add_key_with_hash_data(h, key, rte_hash_hash(h, key),
+					       data);
 }
 
 static inline int32_t
@@ -386,6 +500,8 @@ rte_hash_del_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		return rte_hash_cuckoo_del(h, key, sig);
 	return __rte_hash_del_key_with_hash(h, key, sig);
 }
 
@@ -393,16 +509,29 @@ int32_t
 rte_hash_del_key(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		return rte_hash_cuckoo_del(h, key, rte_hash_hash(h, key));
 	return __rte_hash_del_key_with_hash(h, key, rte_hash_hash(h, key));
 }
 
+int
+rte_hash_free_key_with_position(const struct rte_hash *h, int32_t position)
+{
+	RETURN_IF_TRUE((h == NULL), -EINVAL);
+	/* a wrong position would corrupt the free slots, always check it */
+	if (!(h->flags & RTE_HASH_F_NO_FREE_ON_DEL) || (position < 0) ||
+			((uint32_t)position >= h->entries))
+		return -EINVAL;
+	return rte_hash_cuckoo_free_key(h, position);
+}
+
 static inline int32_t
 __rte_hash_lookup_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
 {
 	hash_sig_t *sig_bucket;
 	uint8_t *key_bucket;
-	uint32_t bucket_index, i;
+	uint32_t bucket_index, i, mask;
 
 	/* Get the hash signature and bucket index */
 	sig |= h->sig_msb;
@@ -411,12 +540,13 @@ __rte_hash_lookup_with_hash(const struct rte_hash *h,
 	key_bucket = get_key_tbl_bucket(h, bucket_index);
 
 	/* Check if key is already present in the hash */
-	for (i = 0; i < h->bucket_entries; i++) {
-		if ((sig == sig_bucket[i]) &&
-		    likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
-				  h->key_len) == 0)) {
+	mask = compare_signatures(sig, sig_bucket, h->bucket_entries);
+	while (mask != 0) {
+		i = __builtin_ctz(mask);
+		if (likely(memcmp(key, get_key_from_bucket(h, key_bucket, i),
+				  h->key_len) == 0))
 			return bucket_index * h->bucket_entries + i;
-		}
+		mask &= mask - 1;
 	}
 
 	return -ENOENT;
@@ -427,6 +557,8 @@ rte_hash_lookup_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		return rte_hash_cuckoo_lookup(h, key, sig);
 	return __rte_hash_lookup_with_hash(h, key, sig);
 }
 
@@ -434,50 +566,189 @@ int32_t
 rte_hash_lookup(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		return rte_hash_cuckoo_lookup(h, key, rte_hash_hash(h, key));
 	return __rte_hash_lookup_with_hash(h, key, rte_hash_hash(h, key));
 }
 
-int
-rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
-		      uint32_t num_keys, int32_t *positions)
+int32_t
+rte_hash_lookup_with_hash_data(const struct rte_hash *h,
+			const void *key, hash_sig_t sig, void **data)
 {
-	uint32_t i, j, bucket_index;
-	hash_sig_t sigs[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t pos;
 
-	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) || (num_keys == 0) ||
-			(num_keys > RTE_HASH_LOOKUP_BULK_MAX) ||
-			(positions == NULL)), -EINVAL);
+	RETURN_IF_TRUE(((h == NULL) || (key == NULL) || (data == NULL) ||
+			!(h->flags & RTE_HASH_F_USER_DATA)), -EINVAL);
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		pos = rte_hash_cuckoo_lookup(h, key, sig);
+	else
+		pos = __rte_hash_lookup_with_hash(h, key, sig);
+	if (pos >= 0)
+		*data = *get_data_from_key(h, get_key_from_position(h, pos));
+	return pos;
+}
 
-	/* Get the hash signature and bucket index */
+int32_t
+rte_hash_lookup_data(const struct rte_hash *h, const void *key, void **data)
+{
+	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	return rte_hash_lookup_with_hash_data(h, key, rte_hash_hash(h, key),
+					      data);
+}
+
+/*
+ * Lookup a burst of keys in three stages, so that the memory accesses of
+ * each stage are prefetched by the previous one for all the keys:
+ *  - compute the signatures and prefetch the signature buckets,
+ *  - compare the signatures of the buckets and prefetch the matching keys,
+ *  - compare the keys.
+ */
+static inline uint64_t
+__rte_hash_lookup_burst(const struct rte_hash *h, const void **keys,
+			uint32_t num_keys, int32_t *positions)
+{
+	hash_sig_t sigs[RTE_HASH_LOOKUP_BURST_MAX];
+	uint32_t sig_hits[RTE_HASH_LOOKUP_BURST_MAX];
+	uint32_t i, j, bucket_index;
+	uint64_t hits = 0;
+
+	/* Get the hash signature and prefetch the signature bucket */
 	for (i = 0; i < num_keys; i++) {
 		sigs[i] = h->hash_func(keys[i], h->key_len,
 				h->hash_func_init_val) | h->sig_msb;
 		bucket_index = sigs[i] & h->bucket_bitmask;
-
-		/* Pre-fetch relevant buckets */
-		rte_prefetch1((void *) get_sig_tbl_bucket(h, bucket_index));
-		rte_prefetch1((void *) get_key_tbl_bucket(h, bucket_index));
+		rte_prefetch0(get_sig_tbl_bucket(h, bucket_index));
 	}
 
-	/* Check if key is already present in the hash */
+	/* Compare the signatures and prefetch the first matching key */
 	for (i = 0; i < num_keys; i++) {
 		bucket_index = sigs[i] & h->bucket_bitmask;
-		hash_sig_t *sig_bucket = get_sig_tbl_bucket(h, bucket_index);
-		uint8_t *key_bucket = get_key_tbl_bucket(h, bucket_index);
+		sig_hits[i] = compare_signatures(sigs[i],
+				get_sig_tbl_bucket(h, bucket_index),
+				h->bucket_entries);
+		if (sig_hits[i] != 0)
+			rte_prefetch0(get_key_from_bucket(h,
+				get_key_tbl_bucket(h, bucket_index),
+				__builtin_ctz(sig_hits[i])));
+	}
 
+	/* Compare the keys of the entries with a matching signature */
+	for (i = 0; i < num_keys; i++) {
+		bucket_index = sigs[i] & h->bucket_bitmask;
 		positions[i] = -ENOENT;
 
-		for (j = 0; j < h->bucket_entries; j++) {
-			if ((sigs[i] == sig_bucket[j]) &&
-			    likely(memcmp(keys[i],
-					  get_key_from_bucket(h, key_bucket, j),
-					  h->key_len) == 0)) {
+		while (sig_hits[i] != 0) {
+			j = __builtin_ctz(sig_hits[i]);
+			if (likely(memcmp(keys[i], get_key_from_bucket(h,
+					get_key_tbl_bucket(h, bucket_index), j),
+					h->key_len) == 0)) {
 				positions[i] = bucket_index *
 					h->bucket_entries + j;
+				hits |= (uint64_t)1 << i;
 				break;
 			}
+			sig_hits[i] &= sig_hits[i] - 1;
 		}
 	}
 
+	return hits;
+}
+
+int
+rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
+		      uint32_t num_keys, int32_t *positions)
+{
+	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) || (num_keys == 0) ||
+			(num_keys > RTE_HASH_LOOKUP_BULK_MAX) ||
+			(positions == NULL)), -EINVAL);
+
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		rte_hash_cuckoo_lookup_burst(h, keys, num_keys, positions);
+	else
+		__rte_hash_lookup_burst(h, keys, num_keys, positions);
+
 	return 0;
 }
+
+int
+rte_hash_lookup_burst(const struct rte_hash *h, const void **keys,
+		      uint32_t num_keys, int32_t *positions, uint64_t *hit_mask)
+{
+	uint64_t hits;
+
+	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) || (num_keys == 0) ||
+			(num_keys > RTE_HASH_LOOKUP_BURST_MAX) ||
+			(positions == NULL) || (hit_mask == NULL)), -EINVAL);
+
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		hits = rte_hash_cuckoo_lookup_burst(h, keys, num_keys,
+						    positions);
+	else
+		hits = __rte_hash_lookup_burst(h, keys, num_keys, positions);
+
+	*hit_mask = hits;
+	return __builtin_popcountll(hits);
+}
+
+int
+rte_hash_lookup_bulk_data(const struct rte_hash *h, const void **keys,
+			  uint32_t num_keys, uint64_t *hit_mask, void *data[])
+{
+	int32_t positions[RTE_HASH_LOOKUP_BURST_MAX];
+	uint64_t hits, mask;
+	uint32_t i;
+
+	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) || (num_keys == 0) ||
+			(num_keys > RTE_HASH_LOOKUP_BURST_MAX) ||
+			(hit_mask == NULL) || (data == NULL) ||
+			!(h->flags & RTE_HASH_F_USER_DATA)), -EINVAL);
+
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		hits = rte_hash_cuckoo_lookup_burst(h, keys, num_keys,
+						    positions);
+	else
+		hits = __rte_hash_lookup_burst(h, keys, num_keys, positions);
+
+	/* The keys were just compared, so their data is in cache */
+	for (mask = hits; mask != 0; mask &= mask - 1) {
+		i = __builtin_ctzll(mask);
+		data[i] = *get_data_from_key(h,
+				get_key_from_position(h, positions[i]));
+	}
+
+	*hit_mask = hits;
+	return __builtin_popcountll(hits);
+}
+
+int32_t
+rte_hash_iterate(const struct rte_hash *h, const void **key, void **data,
+		 uint32_t *next)
+{
+	const hash_sig_t *sig_bucket;
+	uint32_t pos;
+	void *k;
+
+	RETURN_IF_TRUE(((h == NULL) || (key == NULL) || (data == NULL) ||
+			(next == NULL)), -EINVAL);
+
+	if (h->flags & RTE_HASH_F_CUCKOO)
+		return rte_hash_cuckoo_iterate(h, key, data, next);
+
+	/* Find the next used entry, in position order */
+	for (pos = *next; pos < h->entries; pos++) {
+		sig_bucket = get_sig_tbl_bucket(h, pos / h->bucket_entries);
+		if (sig_bucket[pos % h->bucket_entries] != NULL_SIGNATURE)
+			break;
+	}
+	if (pos >= h->entries) {
+		*next = pos;
+		return -ENOENT;
+	}
+
+	k = get_key_from_position(h, pos);
+	*key = k;
+	*data = (h->flags & RTE_HASH_F_USER_DATA) ?
+		*get_data_from_key(h, k) : NULL;
+	*next = pos + 1;
+	return pos;
+}
@@ -38,6 +38,16 @@
  * @file
  *
  * RTE Hash Table
+ *
+ * Two implementations are available, selected at creation time:
+ *  - The default one stores each key in a single bucket of
+ *    *bucket_entries* slots, so adding a key fails as soon as its bucket
+ *    is full, even if the table is far from full.
+ *  - The cuckoo one (RTE_HASH_F_CUCKOO) can store each key in one of two
+ *    buckets, and moves keys to their other bucket to make room for new
+ *    keys, so that more than 90% of the entries can be used. Lookups can
+ *    run on several lcores concurrently with one lcore adding and
+ *    deleting keys, without locks.
  */
 
 #include <stdint.h>
@@ -60,9 +70,32 @@ extern "C" {
 #define RTE_HASH_LOOKUP_BULK_MAX		16
 #define RTE_HASH_LOOKUP_MULTI_MAX		RTE_HASH_LOOKUP_BULK_MAX
 
+/** Max number of keys that can be searched for using rte_hash_lookup_burst. */
+#define RTE_HASH_LOOKUP_BURST_MAX		64
+
 /** Max number of characters in hash name.*/
 #define RTE_HASH_NAMESIZE			32
 
+/** Create a cuckoo hash table, with lock-free concurrent lookups. */
+#define RTE_HASH_F_CUCKOO			0x0001
+
+/**
+ * Store a user data pointer next to each key, set by rte_hash_add_key_data()
+ * and returned by rte_hash_lookup_data(), rte_hash_lookup_bulk_data() and
+ * rte_hash_iterate().
+ */
+#define RTE_HASH_F_USER_DATA			0x0002
+
+/**
+ * Only with RTE_HASH_F_CUCKOO: deleting a key does not free its position,
+ * which stays reserved until rte_hash_free_key_with_position() is called,
+ * once no lookup running concurrently with the delete can still use it.
+ */
+#define RTE_HASH_F_NO_FREE_ON_DEL		0x0004
+
+/** Number of entries in each bucket of a cuckoo hash table. */
+#define RTE_HASH_CUCKOO_BUCKET_ENTRIES		4
+
 /** Signature of key that is stored internally. */
 typedef uint32_t hash_sig_t;
 
@@ -72,7 +105,8 @@ typedef uint32_t (*rte_hash_function)(const void *key, uint32_t key_len,
 
 /**
  * Parameters used when creating the hash table. The total table entries and
- * bucket entries must be a power of 2.
+ * bucket entries must be a power of 2. For a cuckoo hash table, the
+ * bucket entries are ignored and RTE_HASH_CUCKOO_BUCKET_ENTRIES is used.
  */
 struct rte_hash_parameters {
 	const char *name;		/**< Name of the hash. */
@@ -82,8 +116,12 @@ struct rte_hash_parameters {
 	rte_hash_function hash_func;	/**< Function used to calculate hash. */
 	uint32_t hash_func_init_val;	/**< Init value used by hash_func. */
 	int socket_id;			/**< NUMA Socket ID for memory. */
+	uint32_t flags;			/**< RTE_HASH_F_* flags. */
 };
 
+struct rte_hash_bucket;
+struct rte_hash_cuckoo_state;
+
 /** A hash table structure. */
 struct rte_hash {
 	char name[RTE_HASH_NAMESIZE];	/**< Name of the hash. */
@@ -104,6 +142,12 @@ struct rte_hash {
 	uint32_t key_tbl_key_size;	/**< Keys may be padded for alignment
 					   reasons, and this is the key size
 					   used	by key_tbl. */
+	uint32_t flags;			/**< Flags given at creation. */
+	uint32_t key_data_offset;	/**< Offset of the user data in
+					   each key of key_tbl. */
+	struct rte_hash_bucket *buckets;	/**< Cuckoo table buckets. */
+	struct rte_hash_cuckoo_state *cuckoo;	/**< Cuckoo table free key
+						   slots and change counter. */
 };
 
 /**
@@ -151,7 +195,8 @@ rte_hash_free(struct rte_hash *h);
 
 /**
  * Add a key to an existing hash table. This operation is not multi-thread safe
- * and should only be called from one thread.
+ * and should only be called from one thread. On a cuckoo hash table, it can
+ * run concurrently with lookups.
  *
  * @param h
  *   Hash table to add the key to.
@@ -168,7 +213,8 @@ rte_hash_add_key(const struct rte_hash *h, const void *key);
 
 /**
  * Add a key to an existing hash table. This operation is not multi-thread safe
- * and should only be called from one thread.
+ * and should only be called from one thread. On a cuckoo hash table, it can
+ * run concurrently with lookups.
  *
  * @param h
  *   Hash table to add the key to.
@@ -186,9 +232,60 @@ int32_t
 rte_hash_add_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig);
 
+/**
+ * Add a key and its user data to an existing hash table created with
+ * RTE_HASH_F_USER_DATA. If the key is already in the table, its data is
+ * updated. This operation is not multi-thread safe and should only be
+ * called from one thread. On a cuckoo hash table, it can run concurrently
+ * with lookups.
+ *
+ * @param h
+ *   Hash table to add the key to.
+ * @param key
+ *   Key to add to the hash table.
+ * @param data
+ *   User data to store with the key, either a pointer or a value that fits
+ *   in a pointer.
+ * @return
+ *   - -EINVAL if the parameters are invalid or the table has no user data.
+ *   - -ENOSPC if there is no space in the hash for this key.
+ *   - A positive value that can be used by the caller as an offset into an
+ *     array of user data. This value is unique for this key.
+ */
+int32_t
+rte_hash_add_key_data(const struct rte_hash *h, const void *key, void *data);
+
+/**
+ * Add a key and its user data to an existing hash table created with
+ * RTE_HASH_F_USER_DATA, using a precomputed hash value. See
+ * rte_hash_add_key_data().
+ *
+ * @param h
+ *   Hash table to add the key to.
+ * @param key
+ *   Key to add to the hash table.
+ * @param sig
+ *   Hash value to add to the hash table.
+ * @param data
+ *   User data to store with the key.
+ * @return
+ *   - -EINVAL if the parameters are invalid or the table has no user data.
+ *   - -ENOSPC if there is no space in the hash for this key.
+ *   - A positive value that can be used by the caller as an offset into an
+ *     array of user data. This value is unique for this key.
+ */
+int32_t
+rte_hash_add_key_with_hash_data(const struct rte_hash *h, const void *key,
+				hash_sig_t sig, void *data);
+
 /**
  * Remove a key from an existing hash table. This operation is not multi-thread
- * safe and should only be called from one thread.
+ * safe and should only be called from one thread. On a cuckoo hash table, it
+ * can run concurrently with lookups, but unless the table was created with
+ * RTE_HASH_F_NO_FREE_ON_DEL the value returned may be given to a new key by
+ * the next add while a lookup that started before the delete still returns
+ * it: adding keys after a delete then needs the lcores doing lookups to be
+ * synchronized with the writer by the application.
  *
  * @param h
  *   Hash table to remove the key from.
@@ -206,7 +303,12 @@ rte_hash_del_key(const struct rte_hash *h, const void *key);
 
 /**
  * Remove a key from an existing hash table. This operation is not multi-thread
- * safe and should only be called from one thread.
+ * safe and should only be called from one thread. On a cuckoo hash table, it
+ * can run concurrently with lookups, but unless the table was created with
+ * RTE_HASH_F_NO_FREE_ON_DEL the value returned may be given to a new key by
+ * the next add while a lookup that started before the delete still returns
+ * it: adding keys after a delete then needs the lcores doing lookups to be
+ * synchronized with the writer by the application.
  *
  * @param h
  *   Hash table to remove the key from.
@@ -225,6 +327,25 @@ int32_t
 rte_hash_del_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig);
 
+/**
+ * Free the position of a key deleted from a cuckoo hash table created with
+ * RTE_HASH_F_NO_FREE_ON_DEL, so that it can be given to a new key. This
+ * operation is not multi-thread safe and should only be called from the
+ * thread adding and deleting keys, once the lcores doing lookups can no
+ * longer return the position of the deleted key.
+ *
+ * @param h
+ *   Hash table the key was deleted from.
+ * @param position
+ *   Position returned when the key was deleted.
+ * @return
+ *   - 0 if the position was freed.
+ *   - -EINVAL if the parameters are invalid, or the table was not created
+ *     with RTE_HASH_F_NO_FREE_ON_DEL.
+ */
+int
+rte_hash_free_key_with_position(const struct rte_hash *h, int32_t position);
+
 
 /**
  * Find a key in the hash table. This operation is multi-thread safe.
@@ -282,6 +403,47 @@ rte_hash_hash(const struct rte_hash *h, const void *key)
 }
 
 #define rte_hash_lookup_multi rte_hash_lookup_bulk
+/**
+ * Find a key in a hash table created with RTE_HASH_F_USER_DATA, and return
+ * its user data. The data is stored next to the key, so it does not cost
+ * another cache miss. This operation is multi-thread safe.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param key
+ *   Key to find.
+ * @param data
+ *   Output containing the user data of the key, if found.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOENT if the key is not found.
+ *   - A positive value, as returned by rte_hash_lookup().
+ */
+int32_t
+rte_hash_lookup_data(const struct rte_hash *h, const void *key, void **data);
+
+/**
+ * Find a key in a hash table created with RTE_HASH_F_USER_DATA, using a
+ * precomputed hash value, and return its user data. This operation is
+ * multi-thread safe.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param key
+ *   Key to find.
+ * @param sig
+ *   Hash value of the key.
+ * @param data
+ *   Output containing the user data of the key, if found.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOENT if the key is not found.
+ *   - A positive value, as returned by rte_hash_lookup().
+ */
+int32_t
+rte_hash_lookup_with_hash_data(const struct rte_hash *h, const void *key,
+			       hash_sig_t sig, void **data);
+
 /**
  * Find multiple keys in the hash table. This operation is multi-thread safe.
  *
@@ -303,6 +465,81 @@ rte_hash_hash(const struct rte_hash *h, const void *key)
 int
 rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		      uint32_t num_keys, int32_t *positions);
+
+/**
+ * Find a burst of keys in the hash table, such as the flows of a burst of
+ * received packets. The signatures of all the keys are computed first and
+ * their buckets prefetched, then the bucket signatures are compared using
+ * vector instructions and the matching keys prefetched, and only then are
+ * the keys compared. This operation is multi-thread safe.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param keys
+ *   A pointer to a list of keys to look for.
+ * @param num_keys
+ *   How many keys are in the keys list (at most RTE_HASH_LOOKUP_BURST_MAX).
+ * @param positions
+ *   Output containing a list of values, as for rte_hash_lookup_bulk(). If a
+ *   key in the list was not found, then -ENOENT will be the value.
+ * @param hit_mask
+ *   Output containing a bitmask, with bit i set if keys[i] was found.
+ * @return
+ *   -EINVAL if there's an error, otherwise the number of keys found.
+ */
+int
+rte_hash_lookup_burst(const struct rte_hash *h, const void **keys,
+		      uint32_t num_keys, int32_t *positions, uint64_t *hit_mask);
+
+/**
+ * Find a burst of keys in a hash table created with RTE_HASH_F_USER_DATA,
+ * and return their user data. See rte_hash_lookup_burst(). This operation
+ * is multi-thread safe.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param keys
+ *   A pointer to a list of keys to look for.
+ * @param num_keys
+ *   How many keys are in the keys list (at most RTE_HASH_LOOKUP_BURST_MAX).
+ * @param hit_mask
+ *   Output containing a bitmask, with bit i set if keys[i] was found.
+ * @param data
+ *   Output containing the user data of the keys found. The entries of the
+ *   keys not found are left untouched.
+ * @return
+ *   -EINVAL if there's an error, otherwise the number of keys found.
+ */
+int
+rte_hash_lookup_bulk_data(const struct rte_hash *h, const void **keys,
+			  uint32_t num_keys, uint64_t *hit_mask, void *data[]);
+
+/**
+ * Iterate over the keys of a hash table. The iterator has no state other
+ * than *next*, so a large table can be walked a few entries at a time, for
+ * instance for aging. The keys returned may be deleted while iterating;
+ * keys added during the iteration may or may not be returned, and on a
+ * cuckoo hash table, adding keys may make the iteration skip or repeat
+ * keys moved to make room. This operation is multi-thread safe.
+ *
+ * @param h
+ *   Hash table to iterate.
+ * @param key
+ *   Output containing a pointer to the key found.
+ * @param data
+ *   Output containing the user data of the key found, or NULL if the table
+ *   was not created with RTE_HASH_F_USER_DATA.
+ * @param next
+ *   Pointer to the iterator, set to 0 to start from the first entry, and
+ *   updated to resume from the entry following the one found.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - -ENOENT if there are no more keys.
+ *   - The position of the key found, as returned by rte_hash_lookup().
+ */
+int32_t
+rte_hash_iterate(const struct rte_hash *h, const void **key, void **data,
+		 uint32_t *next);
 #ifdef __cplusplus
 }
 #endif
@@ -541,12 +541,18 @@ add_mempool_to_metadata(const struct rte_mempool * mp,
 		return -1;
 	}
 
-	/* mempool consists of memzone and ring */
+	/* mempool consists of memzone and pool handler data */
 	ret = add_memzone_to_metadata(mz, config);
 	if (ret < 0)
 		return -1;
 
-	return add_ring_to_metadata(mp->ring, config);
+	mz = get_memzone_by_addr(mp->pool_data);
+	if (!mz) {
+		RTE_LOG(ERR, EAL, "Cannot find memzone for mempool data!\n");
+		return -1;
+	}
+
+	return add_memzone_to_metadata(mz, config);
 }
 
 int
@@ -60,6 +60,15 @@ TAILQ_HEAD(rte_lpm_list, rte_tailq_entry);
 
 #define MAX_DEPTH_TBL24 24
 
+/* End of a rule hash chain or of the free rule list */
+#define RULE_NONE UINT32_MAX
+
+/* Maximum number of rules, so that the rule hash size fits in 32 bits */
+#define RULE_HASH_MAX_SIZE (1U << 31)
+
+/* Multiplier spreading prefixes over the rule hash */
+#define RULE_HASH_MULTIPLIER 0x9e3779b1
+
 enum valid_flag {
 	INVALID = 0,
 	VALID
@@ -145,17 +154,41 @@ rte_lpm_find_existing(const char *name)
 	return l;
 }
 
+/*
+ * Resets the rule table and the free tbl8 groups, the tables being zeroed.
+ */
+static void
+lpm_tables_init(struct rte_lpm *lpm)
+{
+	uint32_t i;
+
+	/* Chain all the rules in the free list. */
+	for (i = 0; i < lpm->max_rules; i++)
+		lpm->rules_tbl[i].next = i + 1;
+	lpm->rules_tbl[lpm->max_rules - 1].next = RULE_NONE;
+	lpm->rule_free = 0;
+	memset(lpm->rule_hash, 0xff,
+			(lpm->rule_hash_mask + 1) * sizeof(lpm->rule_hash[0]));
+
+	/* Groups are allocated from the top of the stack, lowest first. */
+	for (i = 0; i < lpm->number_tbl8s; i++)
+		lpm->tbl8_free[i] = lpm->number_tbl8s - 1 - i;
+	lpm->tbl8_free_count = lpm->number_tbl8s;
+}
+
 /*
  * Allocates memory for LPM object
  */
 struct rte_lpm *
-rte_lpm_create(const char *name, int socket_id, int max_rules,
-		__rte_unused int flags)
+rte_lpm_create_config(const char *name, int socket_id,
+		const struct rte_lpm_config *config)
 {
 	char mem_name[RTE_LPM_NAMESIZE];
 	struct rte_lpm *lpm = NULL;
 	struct rte_tailq_entry *te;
-	uint32_t mem_size;
+	uint32_t rule_hash_size;
+	size_t mem_size, tbl8_size, tbl8_free_size;
+	uint8_t *tbl8_mem;
 	struct rte_lpm_list *lpm_list;
 
 	/* check that we have an initialised tail queue */
@@ -165,11 +198,15 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 		return NULL;
 	}
 
-	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl24_entry) != 2);
-	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl8_entry) != 2);
+	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl24_entry) != 4);
+	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl8_entry) != 4);
 
 	/* Check user arguments. */
-	if ((name == NULL) || (socket_id < -1) || (max_rules == 0)){
+	if ((name == NULL) || (socket_id < -1) || (config == NULL) ||
+			(config->max_rules == 0) ||
+			(config->max_rules > RULE_HASH_MAX_SIZE) ||
+			(config->number_tbl8s == 0) ||
+			(config->number_tbl8s > RTE_LPM_MAX_TBL8_NUM_GROUPS)) {
 		rte_errno = EINVAL;
 		return NULL;
 	}
@@ -177,7 +214,14 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 	snprintf(mem_name, sizeof(mem_name), "LPM_%s", name);
 
 	/* Determine the amount of memory to allocate. */
-	mem_size = sizeof(*lpm) + (sizeof(lpm->rules_tbl[0]) * max_rules);
+	mem_size = sizeof(*lpm) + (sizeof(lpm->rules_tbl[0]) *
+			(size_t)config->max_rules);
+	rule_hash_size = rte_align32pow2(config->max_rules);
+	tbl8_size = RTE_ALIGN_CEIL((size_t)config->number_tbl8s *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
+			sizeof(struct rte_lpm_tbl8_entry), RTE_CACHE_LINE_SIZE);
+	tbl8_free_size = RTE_ALIGN_CEIL((size_t)config->number_tbl8s *
+			sizeof(uint32_t), RTE_CACHE_LINE_SIZE);
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
 
@@ -206,10 +250,29 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 		goto exit;
 	}
 
+	/* The tbl8 groups, their free stack and the rule hash follow. */
+	tbl8_mem = rte_zmalloc_socket(mem_name, tbl8_size + tbl8_free_size +
+			(size_t)rule_hash_size * sizeof(uint32_t),
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (tbl8_mem == NULL) {
+		RTE_LOG(ERR, LPM, "LPM tbl8 memory allocation failed\n");
+		rte_free(lpm);
+		lpm = NULL;
+		rte_free(te);
+		goto exit;
+	}
+
 	/* Save user arguments. */
-	lpm->max_rules = max_rules;
+	lpm->max_rules = config->max_rules;
+	lpm->number_tbl8s = config->number_tbl8s;
 	snprintf(lpm->name, sizeof(lpm->name), "%s", name);
 
+	lpm->tbl8 = (struct rte_lpm_tbl8_entry *)tbl8_mem;
+	lpm->tbl8_free = (uint32_t *)(tbl8_mem + tbl8_size);
+	lpm->rule_hash = (uint32_t *)(tbl8_mem + tbl8_size + tbl8_free_size);
+	lpm->rule_hash_mask = rule_hash_size - 1;
+	lpm_tables_init(lpm);
+
 	te->data = (void *) lpm;
 
 	TAILQ_INSERT_TAIL(lpm_list, te, next);
@@ -220,6 +283,19 @@ exit:
 	return lpm;
 }
 
+struct rte_lpm *
+rte_lpm_create(const char *name, int socket_id, int max_rules,
+		int flags)
+{
+	struct rte_lpm_config config = {
+		.max_rules = (max_rules > 0) ? max_rules : 0,
+		.number_tbl8s = RTE_LPM_TBL8_NUM_GROUPS,
+		.flags = flags,
+	};
+
+	return rte_lpm_create_config(name, socket_id, &config);
+}
+
 /*
  * Deallocates memory for given LPM table.
  */
@@ -256,79 +332,152 @@ rte_lpm_free(struct rte_lpm *lpm)
 
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
+	rte_rcu_qsbr_dq_delete(lpm->dq);
+	rte_free(lpm->tbl8);
 	rte_free(lpm);
 	rte_free(te);
 }
 
 /*
- * Adds a rule to the rule table.
- *
- * NOTE: The rule table is split into 32 groups. Each group contains rules that
- * apply to a specific prefix depth (i.e. group 1 contains rules that apply to
- * prefixes with a depth of 1 etc.). In the following code (depth - 1) is used
- * to refer to depth 1 because even though the depth range is 1 - 32, depths
- * are stored in the rule table from 0 - 31.
- * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
+ * Find, clean and allocate a tbl8, whose group index is returned in
+ * tbl8_gindex.
  */
 static inline int32_t
-rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
-	uint8_t next_hop)
+tbl8_alloc(struct rte_lpm *lpm, uint32_t *tbl8_gindex)
 {
-	uint32_t rule_gindex, rule_index, last_rule;
-	int i;
+	struct rte_lpm_tbl8_entry *tbl8_entry;
 
-	VERIFY_DEPTH(depth);
+	/* Take back the groups whose readers are gone, if any. */
+	if (lpm->tbl8_free_count == 0 && lpm->dq != NULL)
+		rte_rcu_qsbr_dq_reclaim(lpm->dq, lpm->number_tbl8s, NULL, NULL);
 
-	/* Scan through rule group to see if rule already exists. */
-	if (lpm->rule_info[depth - 1].used_rules > 0) {
+	/* If there are no tbl8 groups free then return error. */
+	if (lpm->tbl8_free_count == 0)
+		return -ENOSPC;
 
-		/* rule_gindex stands for rule group index. */
-		rule_gindex = lpm->rule_info[depth - 1].first_rule;
-		/* Initialise rule_index to point to start of rule group. */
-		rule_index = rule_gindex;
-		/* Last rule = Last used rule in this rule group. */
-		last_rule = rule_gindex + lpm->rule_info[depth - 1].used_rules;
+	/* Take a free tbl8 group, clean it and set as VALID. */
+	*tbl8_gindex = lpm->tbl8_free[--lpm->tbl8_free_count];
+	tbl8_entry = &lpm->tbl8[*tbl8_gindex * RTE_LPM_TBL8_GROUP_NUM_ENTRIES];
+	memset(&tbl8_entry[0], 0,
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES * sizeof(tbl8_entry[0]));
 
-		for (; rule_index < last_rule; rule_index++) {
+	tbl8_entry->valid_group = VALID;
 
-			/* If rule already exists update its next_hop and return. */
-			if (lpm->rules_tbl[rule_index].ip == ip_masked) {
-				lpm->rules_tbl[rule_index].next_hop = next_hop;
+	return 0;
+}
 
-				return rule_index;
-			}
-		}
-	} else {
-		/* Calculate the position in which the rule will be stored. */
-		rule_index = 0;
-
-		for (i = depth - 1; i > 0; i--) {
-			if (lpm->rule_info[i - 1].used_rules > 0) {
-				rule_index = lpm->rule_info[i - 1].first_rule + lpm->rule_info[i - 1].used_rules;
-				break;
-			}
+/*
+ * Puts a tbl8 group back on the free stack.
+ */
+static void
+tbl8_reclaim(void *p, uint32_t tbl8_group_index)
+{
+	struct rte_lpm *lpm = p;
+
+	lpm->tbl8_free[lpm->tbl8_free_count++] = tbl8_group_index;
+}
+
+/*
+ * Associate a QSBR variable with an LPM object.
+ */
+int
+rte_lpm_rcu_qsbr_add(struct rte_lpm *lpm, const struct rte_lpm_rcu_config *cfg)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	char dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if ((lpm == NULL) || (cfg == NULL) || (cfg->v == NULL))
+		return -EINVAL;
+
+	if (lpm->v != NULL)
+		return -EEXIST;
+
+	if (cfg->mode == RTE_LPM_QSBR_MODE_DQ) {
+		memset(&params, 0, sizeof(params));
+		if (snprintf(dq_name, sizeof(dq_name), "LPM_RCU_%s", lpm->name)
+				>= (int)sizeof(dq_name))
+			return -ENAMETOOLONG;
+		params.name = dq_name;
+		params.socket_id = SOCKET_ID_ANY;
+		params.size = (cfg->dq_size != 0) ?
+				cfg->dq_size : lpm->number_tbl8s;
+		params.trigger_reclaim_limit = RTE_MIN(params.size,
+				(cfg->reclaim_thd != 0) ?
+				cfg->reclaim_thd : RTE_LPM_RCU_DQ_RECLAIM_THD);
+		params.max_reclaim_size = (cfg->reclaim_max != 0) ?
+				cfg->reclaim_max : RTE_LPM_RCU_DQ_RECLAIM_MAX;
+		params.free_fn = tbl8_reclaim;
+		params.p = lpm;
+		params.v = cfg->v;
+
+		lpm->dq = rte_rcu_qsbr_dq_create(&params);
+		if (lpm->dq == NULL) {
+			RTE_LOG(ERR, LPM, "LPM defer queue creation failed\n");
+			return -ENOMEM;
 		}
-		if (rule_index == lpm->max_rules)
-			return -ENOSPC;
+	} else if (cfg->mode != RTE_LPM_QSBR_MODE_SYNC)
+		return -EINVAL;
 
-		lpm->rule_info[depth - 1].first_rule = rule_index;
-	}
+	lpm->rcu_mode = cfg->mode;
+	lpm->v = cfg->v;
+
+	return 0;
+}
+
+/*
+ * Returns the hash chain of a rule.
+ */
+static inline uint32_t
+rule_hash(const struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth)
+{
+	uint32_t h = (ip_masked ^ depth) * RULE_HASH_MULTIPLIER;
+
+	return (h ^ (h >> 16)) & lpm->rule_hash_mask;
+}
+
+/*
+ * Adds a rule to the rule table.
+ *
+ * NOTE: Rules are kept in hash chains indexed by prefix and depth, so that
+ * finding a rule does not depend on the number of rules. A rule keeps its
+ * index until it is deleted. The number of rules of each depth is kept in
+ * rule_info, where (depth - 1) is used because depths are stored from 0.
+ * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
+ */
+static inline int32_t
+rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
+	uint32_t next_hop)
+{
+	uint32_t h, rule_index;
 
-	/* Make room for the new rule in the array. */
-	for (i = RTE_LPM_MAX_DEPTH; i > depth; i--) {
-		if (lpm->rule_info[i - 1].first_rule + lpm->rule_info[i - 1].used_rules == lpm->max_rules)
-			return -ENOSPC;
+	VERIFY_DEPTH(depth);
 
-		if (lpm->rule_info[i - 1].used_rules > 0) {
-			lpm->rules_tbl[lpm->rule_info[i - 1].first_rule + lpm->rule_info[i - 1].used_rules]
-					= lpm->rules_tbl[lpm->rule_info[i - 1].first_rule];
-			lpm->rule_info[i - 1].first_rule++;
+	/* Scan the hash chain to see if rule already exists. */
+	h = rule_hash(lpm, ip_masked, depth);
+	for (rule_index = lpm->rule_hash[h]; rule_index != RULE_NONE;
+			rule_index = lpm->rules_tbl[rule_index].next) {
+
+		/* If rule already exists update its next_hop and return. */
+		if (lpm->rules_tbl[rule_index].ip == ip_masked &&
+				lpm->rules_tbl[rule_index].depth == depth) {
+			lpm->rules_tbl[rule_index].next_hop = next_hop;
+
+			return rule_index;
 		}
 	}
 
-	/* Add the new rule. */
+	/* Take a rule from the free list. */
+	rule_index = lpm->rule_free;
+	if (rule_index == RULE_NONE)
+		return -ENOSPC;
+	lpm->rule_free = lpm->rules_tbl[rule_index].next;
+
+	/* Add the new rule at the head of its chain. */
 	lpm->rules_tbl[rule_index].ip = ip_masked;
 	lpm->rules_tbl[rule_index].next_hop = next_hop;
+	lpm->rules_tbl[rule_index].depth = depth;
+	lpm->rules_tbl[rule_index].next = lpm->rule_hash[h];
+	lpm->rule_hash[h] = rule_index;
 
 	/* Increment the used rules counter for this rule group. */
 	lpm->rule_info[depth - 1].used_rules++;
@@ -343,20 +492,20 @@ rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 static inline void
 rule_delete(struct rte_lpm *lpm, int32_t rule_index, uint8_t depth)
 {
-	int i;
+	uint32_t *prev;
 
 	VERIFY_DEPTH(depth);
 
-	lpm->rules_tbl[rule_index] = lpm->rules_tbl[lpm->rule_info[depth - 1].first_rule
-			+ lpm->rule_info[depth - 1].used_rules - 1];
+	/* Unlink the rule from its chain. */
+	prev = &lpm->rule_hash[rule_hash(lpm,
+			lpm->rules_tbl[rule_index].ip, depth)];
+	while (*prev != (uint32_t)rule_index)
+		prev = &lpm->rules_tbl[*prev].next;
+	*prev = lpm->rules_tbl[rule_index].next;
 
-	for (i = depth; i < RTE_LPM_MAX_DEPTH; i++) {
-		if (lpm->rule_info[i].used_rules > 0) {
-			lpm->rules_tbl[lpm->rule_info[i].first_rule - 1] =
-					lpm->rules_tbl[lpm->rule_info[i].first_rule + lpm->rule_info[i].used_rules - 1];
-			lpm->rule_info[i].first_rule--;
-		}
-	}
+	/* Put it back in the free list. */
+	lpm->rules_tbl[rule_index].next = lpm->rule_free;
+	lpm->rule_free = rule_index;
 
 	lpm->rule_info[depth - 1].used_rules--;
 }
@@ -368,17 +517,21 @@ rule_delete(struct rte_lpm *lpm, int32_t rule_index, uint8_t depth)
 static inline int32_t
 rule_find(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth)
 {
-	uint32_t rule_gindex, last_rule, rule_index;
+	uint32_t rule_index;
 
 	VERIFY_DEPTH(depth);
 
-	rule_gindex = lpm->rule_info[depth - 1].first_rule;
-	last_rule = rule_gindex + lpm->rule_info[depth - 1].used_rules;
+	/* Skip the hash when there is no rule at this depth. */
+	if (lpm->rule_info[depth - 1].used_rules == 0)
+		return -E_RTE_NO_TAILQ;
 
-	/* Scan used rules at given depth to find rule. */
-	for (rule_index = rule_gindex; rule_index < last_rule; rule_index++) {
+	/* Scan the hash chain to find rule. */
+	for (rule_index = lpm->rule_hash[rule_hash(lpm, ip_masked, depth)];
+			rule_index != RULE_NONE;
+			rule_index = lpm->rules_tbl[rule_index].next) {
 		/* If rule is found return the rule index. */
-		if (lpm->rules_tbl[rule_index].ip == ip_masked)
+		if (lpm->rules_tbl[rule_index].ip == ip_masked &&
+				lpm->rules_tbl[rule_index].depth == depth)
 			return (rule_index);
 	}
 
@@ -386,47 +539,35 @@ rule_find(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth)
 	return -E_RTE_NO_TAILQ;
 }
 
-/*
- * Find, clean and allocate a tbl8.
- */
-static inline int32_t
-tbl8_alloc(struct rte_lpm_tbl8_entry *tbl8)
+static inline void
+tbl8_free(struct rte_lpm *lpm, uint32_t tbl8_group_start)
 {
-	uint32_t tbl8_gindex; /* tbl8 group index. */
-	struct rte_lpm_tbl8_entry *tbl8_entry;
+	uint32_t tbl8_group_index =
+		tbl8_group_start / RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 
-	/* Scan through tbl8 to find a free (i.e. INVALID) tbl8 group. */
-	for (tbl8_gindex = 0; tbl8_gindex < RTE_LPM_TBL8_NUM_GROUPS;
-			tbl8_gindex++) {
-		tbl8_entry = &tbl8[tbl8_gindex *
-		                   RTE_LPM_TBL8_GROUP_NUM_ENTRIES];
-		/* If a free tbl8 group is found clean it and set as VALID. */
-		if (!tbl8_entry->valid_group) {
-			memset(&tbl8_entry[0], 0,
-					RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
-					sizeof(tbl8_entry[0]));
-
-			tbl8_entry->valid_group = VALID;
-
-			/* Return group index for allocated tbl8 group. */
-			return tbl8_gindex;
-		}
+	/* Set tbl8 group invalid*/
+	lpm->tbl8[tbl8_group_start].valid_group = INVALID;
+
+	if (lpm->v == NULL) {
+		tbl8_reclaim(lpm, tbl8_group_index);
+		return;
 	}
 
-	/* If there are no tbl8 groups free then return error. */
-	return -ENOSPC;
-}
+	/*
+	 * Readers may still be walking the group: reuse it only after they
+	 * all went through a quiescent state.
+	 */
+	if (lpm->rcu_mode == RTE_LPM_QSBR_MODE_DQ &&
+			rte_rcu_qsbr_dq_enqueue(lpm->dq, tbl8_group_index) == 0)
+		return;
 
-static inline void
-tbl8_free(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
-{
-	/* Set tbl8 group invalid*/
-	tbl8[tbl8_group_start].valid_group = INVALID;
+	rte_rcu_qsbr_synchronize(lpm->v, RTE_QSBR_THRID_INVALID);
+	tbl8_reclaim(lpm, tbl8_group_index);
 }
 
 static inline int32_t
 add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	uint32_t tbl24_index, tbl24_range, tbl8_index, tbl8_group_end, i, j;
 
@@ -443,7 +584,7 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 				lpm->tbl24[i].depth <= depth)) {
 
 			struct rte_lpm_tbl24_entry new_tbl24_entry = {
-				{ .next_hop = next_hop, },
+				.next_hop = next_hop,
 				.valid = VALID,
 				.ext_entry = 0,
 				.depth = depth,
@@ -456,9 +597,13 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 			continue;
 		}
 
+		/* Entries of more specific tbl24 rules are left untouched. */
+		if (lpm->tbl24[i].ext_entry == 0)
+			continue;
+
 		/* If tbl24 entry is valid and extended calculate the index
 		 * into tbl8. */
-		tbl8_index = lpm->tbl24[i].tbl8_gindex *
+		tbl8_index = lpm->tbl24[i].next_hop *
 				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 		tbl8_group_end = tbl8_index + RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 
@@ -488,22 +633,22 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 
 static inline int32_t
 add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
-	uint32_t tbl24_index;
-	int32_t tbl8_group_index, tbl8_group_start, tbl8_group_end, tbl8_index,
-		tbl8_range, i;
+	uint32_t tbl24_index, tbl8_group_index, tbl8_group_start, tbl8_group_end,
+		tbl8_index, tbl8_range, i;
+	int32_t status;
 
 	tbl24_index = (ip_masked >> 8);
 	tbl8_range = depth_to_range(depth);
 
 	if (!lpm->tbl24[tbl24_index].valid) {
 		/* Search for a free tbl8 group. */
-		tbl8_group_index = tbl8_alloc(lpm->tbl8);
+		status = tbl8_alloc(lpm, &tbl8_group_index);
 
 		/* Check tbl8 allocation was successful. */
-		if (tbl8_group_index < 0) {
-			return tbl8_group_index;
+		if (status < 0) {
+			return status;
 		}
 
 		/* Find index into tbl8 and range. */
@@ -525,21 +670,24 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 		 */
 
 		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-			{ .tbl8_gindex = (uint8_t)tbl8_group_index, },
+			.next_hop = tbl8_group_index,
 			.valid = VALID,
 			.ext_entry = 1,
 			.depth = 0,
 		};
 
+		/* The group must be filled before readers can reach it. */
+		rte_wmb();
+
 		lpm->tbl24[tbl24_index] = new_tbl24_entry;
 
 	}/* If valid entry but not extended calculate the index into Table8. */
 	else if (lpm->tbl24[tbl24_index].ext_entry == 0) {
 		/* Search for free tbl8 group. */
-		tbl8_group_index = tbl8_alloc(lpm->tbl8);
+		status = tbl8_alloc(lpm, &tbl8_group_index);
 
-		if (tbl8_group_index < 0) {
-			return tbl8_group_index;
+		if (status < 0) {
+			return status;
 		}
 
 		tbl8_group_start = tbl8_group_index *
@@ -576,19 +724,22 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 		 */
 
 		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-				{ .tbl8_gindex = (uint8_t)tbl8_group_index, },
+				.next_hop = tbl8_group_index,
 				.valid = VALID,
 				.ext_entry = 1,
 				.depth = 0,
 		};
 
+		/* The group must be filled before readers can reach it. */
+		rte_wmb();
+
 		lpm->tbl24[tbl24_index] = new_tbl24_entry;
 
 	}
 	else { /*
 		* If it is valid, extended entry calculate the index into tbl8.
 		*/
-		tbl8_group_index = lpm->tbl24[tbl24_index].tbl8_gindex;
+		tbl8_group_index = lpm->tbl24[tbl24_index].next_hop;
 		tbl8_group_start = tbl8_group_index *
 				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 		tbl8_index = tbl8_group_start + (ip_masked & 0xFF);
@@ -623,13 +774,14 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
  */
 int
 rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-		uint8_t next_hop)
+		uint32_t next_hop)
 {
 	int32_t rule_index, status = 0;
 	uint32_t ip_masked;
 
 	/* Check user arguments. */
-	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH))
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH) ||
+			(next_hop > RTE_LPM_MAX_NEXT_HOP))
 		return -EINVAL;
 
 	ip_masked = ip & depth_to_mask(depth);
@@ -667,7 +819,7 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
  */
 int
 rte_lpm_is_rule_present(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-uint8_t *next_hop)
+uint32_t *next_hop)
 {
 	uint32_t ip_masked;
 	int32_t rule_index;
@@ -737,14 +889,14 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 					lpm->tbl24[i].depth <= depth ) {
 				lpm->tbl24[i].valid = INVALID;
 			}
-			else {
+			else if (lpm->tbl24[i].ext_entry == 1) {
 				/*
 				 * If TBL24 entry is extended, then there has
 				 * to be a rule with depth >= 25 in the
 				 * associated TBL8 group.
 				 */
 
-				tbl8_group_index = lpm->tbl24[i].tbl8_gindex;
+				tbl8_group_index = lpm->tbl24[i].next_hop;
 				tbl8_index = tbl8_group_index *
 						RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 
@@ -764,7 +916,7 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 		 */
 
 		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-			{.next_hop = lpm->rules_tbl[sub_rule_index].next_hop,},
+			.next_hop = lpm->rules_tbl[sub_rule_index].next_hop,
 			.valid = VALID,
 			.ext_entry = 0,
 			.depth = sub_rule_depth,
@@ -783,14 +935,14 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 					lpm->tbl24[i].depth <= depth ) {
 				lpm->tbl24[i] = new_tbl24_entry;
 			}
-			else {
+			else if (lpm->tbl24[i].ext_entry == 1) {
 				/*
 				 * If TBL24 entry is extended, then there has
 				 * to be a rule with depth >= 25 in the
 				 * associated TBL8 group.
 				 */
 
-				tbl8_group_index = lpm->tbl24[i].tbl8_gindex;
+				tbl8_group_index = lpm->tbl24[i].next_hop;
 				tbl8_index = tbl8_group_index *
 						RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 
@@ -812,8 +964,8 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
  *
  * Return of -EEXIST means tbl8 is in use and thus can not be recycled.
  * Return of -EINVAL means tbl8 is empty and thus can be recycled
- * Return of value > -1 means tbl8 is in use but has all the same values and
- * thus can be recycled
+ * Return of 0 means tbl8 is in use but has all the same values as its first
+ * entry and thus can be recycled
  */
 static inline int32_t
 tbl8_recycle_check(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
@@ -829,22 +981,22 @@ tbl8_recycle_check(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
 	 */
 	if (tbl8[tbl8_group_start].valid) {
 		/*
-		 * If first entry is valid check if the depth is less than 24
-		 * and if so check the rest of the entries to verify that they
-		 * are all of this depth.
+		 * If first entry is valid check if the depth is not more than
+		 * 24 and if so check the rest of the entries to verify that
+		 * they are all valid and of this depth.
 		 */
-		if (tbl8[tbl8_group_start].depth < MAX_DEPTH_TBL24) {
+		if (tbl8[tbl8_group_start].depth <= MAX_DEPTH_TBL24) {
 			for (i = (tbl8_group_start + 1); i < tbl8_group_end;
 					i++) {
 
-				if (tbl8[i].depth !=
+				if (!tbl8[i].valid || tbl8[i].depth !=
 						tbl8[tbl8_group_start].depth) {
 
 					return -EEXIST;
 				}
 			}
-			/* If all entries are the same return the tb8 index */
-			return tbl8_group_start;
+			/* All entries are the same */
+			return 0;
 		}
 
 		return -EEXIST;
@@ -867,7 +1019,7 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 {
 	uint32_t tbl24_index, tbl8_group_index, tbl8_group_start, tbl8_index,
 			tbl8_range, i;
-	int32_t tbl8_recycle_index;
+	int32_t tbl8_recycle_status;
 
 	/*
 	 * Calculate the index into tbl24 and range. Note: All depths larger
@@ -876,7 +1028,7 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 	tbl24_index = ip_masked >> 8;
 
 	/* Calculate the index into tbl8 and range. */
-	tbl8_group_index = lpm->tbl24[tbl24_index].tbl8_gindex;
+	tbl8_group_index = lpm->tbl24[tbl24_index].next_hop;
 	tbl8_group_start = tbl8_group_index * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
 	tbl8_index = tbl8_group_start + (ip_masked & 0xFF);
 	tbl8_range = depth_to_range(depth);
@@ -916,25 +1068,25 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 	 * associated tbl24 entry.
 	 */
 
-	tbl8_recycle_index = tbl8_recycle_check(lpm->tbl8, tbl8_group_start);
+	tbl8_recycle_status = tbl8_recycle_check(lpm->tbl8, tbl8_group_start);
 
-	if (tbl8_recycle_index == -EINVAL){
+	if (tbl8_recycle_status == -EINVAL){
 		/* Set tbl24 before freeing tbl8 to avoid race condition. */
 		lpm->tbl24[tbl24_index].valid = 0;
-		tbl8_free(lpm->tbl8, tbl8_group_start);
+		tbl8_free(lpm, tbl8_group_start);
 	}
-	else if (tbl8_recycle_index > -1) {
+	else if (tbl8_recycle_status == 0) {
 		/* Update tbl24 entry. */
 		struct rte_lpm_tbl24_entry new_tbl24_entry = {
-			{ .next_hop = lpm->tbl8[tbl8_recycle_index].next_hop, },
+			.next_hop = lpm->tbl8[tbl8_group_start].next_hop,
 			.valid = VALID,
 			.ext_entry = 0,
-			.depth = lpm->tbl8[tbl8_recycle_index].depth,
+			.depth = lpm->tbl8[tbl8_group_start].depth,
 		};
 
 		/* Set tbl24 before freeing tbl8 to avoid race condition. */
 		lpm->tbl24[tbl24_index] = new_tbl24_entry;
-		tbl8_free(lpm->tbl8, tbl8_group_start);
+		tbl8_free(lpm, tbl8_group_start);
 	}
 
 	return 0;
@@ -1002,6 +1154,12 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
 void
 rte_lpm_delete_all(struct rte_lpm *lpm)
 {
+	/* Drop the groups waiting for their grace period. */
+	if (lpm->dq != NULL) {
+		rte_rcu_qsbr_synchronize(lpm->v, RTE_QSBR_THRID_INVALID);
+		rte_rcu_qsbr_dq_reclaim(lpm->dq, lpm->number_tbl8s, NULL, NULL);
+	}
+
 	/* Zero rule information. */
 	memset(lpm->rule_info, 0, sizeof(lpm->rule_info));
 
@@ -1009,9 +1167,11 @@ rte_lpm_delete_all(struct rte_lpm *lpm)
 	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
 
 	/* Zero tbl8. */
-	memset(lpm->tbl8, 0, sizeof(lpm->tbl8));
+	memset(lpm->tbl8, 0, (size_t)lpm->number_tbl8s *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES * sizeof(lpm->tbl8[0]));
 
 	/* Delete all rules form the rules table. */
 	memset(lpm->rules_tbl, 0, sizeof(lpm->rules_tbl[0]) * lpm->max_rules);
+	lpm_tables_init(lpm);
 }
 
@@ -47,6 +47,7 @@
 #include <rte_memory.h>
 #include <rte_common.h>
 #include <rte_common_vect.h>
+#include <rte_rcu_qsbr.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -74,12 +75,17 @@ extern "C" {
 /** @internal Number of entries in a tbl8 group. */
 #define RTE_LPM_TBL8_GROUP_NUM_ENTRIES  256
 
-/** @internal Total number of tbl8 groups in the tbl8. */
+/** Number of tbl8 groups of tables created with rte_lpm_create(). */
 #define RTE_LPM_TBL8_NUM_GROUPS         256
 
-/** @internal Total number of tbl8 entries. */
-#define RTE_LPM_TBL8_NUM_ENTRIES        (RTE_LPM_TBL8_NUM_GROUPS * \
-					RTE_LPM_TBL8_GROUP_NUM_ENTRIES)
+/**
+ * Maximum number of tbl8 groups, limited by the size of the group index
+ * and by the end of the last group, which must fit in 32 bits.
+ */
+#define RTE_LPM_MAX_TBL8_NUM_GROUPS     ((1 << 24) - 1)
+
+/** Maximum next hop value. */
+#define RTE_LPM_MAX_NEXT_HOP            ((1 << 24) - 1)
 
 /** @internal Macro to enable/disable run-time checks. */
 #if defined(RTE_LIBRTE_LPM_DEBUG)
@@ -91,43 +97,86 @@ extern "C" {
 #endif
 
 /** @internal bitmask with valid and ext_entry/valid_group fields set */
-#define RTE_LPM_VALID_EXT_ENTRY_BITMASK 0x0300
+#define RTE_LPM_VALID_EXT_ENTRY_BITMASK 0x03000000
 
 /** Bitmask used to indicate successful lookup */
-#define RTE_LPM_LOOKUP_SUCCESS          0x0100
+#define RTE_LPM_LOOKUP_SUCCESS          0x01000000
+
+/** @internal Bitmask of the next hop or tbl8 group index of an entry. */
+#define RTE_LPM_NEXT_HOP_MASK           0x00ffffff
 
 /** @internal Tbl24 entry structure. */
 struct rte_lpm_tbl24_entry {
-	/* Stores Next hop or group index (i.e. gindex)into tbl8. */
 	union {
-		uint8_t next_hop;
-		uint8_t tbl8_gindex;
+		uint32_t val; /**< Whole entry, as read by the lookup functions. */
+		/*
+		 * Stores Next hop, or group index into tbl8 if ext_entry is set.
+		 * Using single uint32_t to store 4 values.
+		 */
+		struct {
+			uint32_t next_hop  :24; /**< Next hop or tbl8 group index. */
+			uint32_t valid     :1;  /**< Validation flag. */
+			uint32_t ext_entry :1;  /**< External entry. */
+			uint32_t depth     :6;  /**< Rule depth. */
+		};
 	};
-	/* Using single uint8_t to store 3 values. */
-	uint8_t valid     :1; /**< Validation flag. */
-	uint8_t ext_entry :1; /**< External entry. */
-	uint8_t depth     :6; /**< Rule depth. */
 };
 
 /** @internal Tbl8 entry structure. */
 struct rte_lpm_tbl8_entry {
-	uint8_t next_hop; /**< next hop. */
-	/* Using single uint8_t to store 3 values. */
-	uint8_t valid       :1; /**< Validation flag. */
-	uint8_t valid_group :1; /**< Group validation flag. */
-	uint8_t depth       :6; /**< Rule depth. */
+	union {
+		uint32_t val; /**< Whole entry, as read by the lookup functions. */
+		/* Using single uint32_t to store 4 values. */
+		struct {
+			uint32_t next_hop    :24; /**< next hop. */
+			uint32_t valid       :1;  /**< Validation flag. */
+			uint32_t valid_group :1;  /**< Group validation flag. */
+			uint32_t depth       :6;  /**< Rule depth. */
+		};
+	};
 };
 
 /** @internal Rule structure. */
 struct rte_lpm_rule {
-	uint32_t ip; /**< Rule IP address. */
-	uint8_t  next_hop; /**< Rule next hop. */
+	uint32_t ip;       /**< Rule IP address. */
+	uint32_t next_hop; /**< Rule next hop. */
+	uint32_t next;     /**< Next rule in hash chain or free list. */
+	uint8_t  depth;    /**< Rule depth. */
 };
 
 /** @internal Contains metadata about the rules table. */
 struct rte_lpm_rule_info {
 	uint32_t used_rules; /**< Used rules so far. */
-	uint32_t first_rule; /**< Indexes the first rule of a given depth. */
+};
+
+/** LPM configuration structure. */
+struct rte_lpm_config {
+	uint32_t max_rules;      /**< Max number of rules. */
+	uint32_t number_tbl8s;   /**< Number of tbl8 groups to allocate. */
+	int flags;               /**< This field is currently unused. */
+};
+
+/** Reclamation modes of the tbl8 groups of an LPM table using RCU. */
+enum rte_lpm_qsbr_mode {
+	/** Queue freed groups, reclaim them when their grace period ended. */
+	RTE_LPM_QSBR_MODE_DQ = 0,
+	/** Wait for the grace period each time a group is freed. */
+	RTE_LPM_QSBR_MODE_SYNC
+};
+
+/** Default number of queued tbl8 groups that triggers a reclaim. */
+#define RTE_LPM_RCU_DQ_RECLAIM_THD      32
+
+/** Default maximum number of tbl8 groups reclaimed at once. */
+#define RTE_LPM_RCU_DQ_RECLAIM_MAX      16
+
+/** LPM RCU configuration structure. */
+struct rte_lpm_rcu_config {
+	struct rte_rcu_qsbr *v;     /**< QSBR variable of the readers. */
+	enum rte_lpm_qsbr_mode mode; /**< Reclamation mode. */
+	uint32_t dq_size;      /**< Defer queue size, 0 for number of tbl8s. */
+	uint32_t reclaim_thd;  /**< Reclaim threshold, 0 for the default. */
+	uint32_t reclaim_max;  /**< Max groups per reclaim, 0 for the default. */
 };
 
 /** @internal LPM structure. */
@@ -136,19 +185,27 @@ struct rte_lpm {
 	char name[RTE_LPM_NAMESIZE];        /**< Name of the lpm. */
 	int mem_location; /**< @deprecated @see RTE_LPM_HEAP and RTE_LPM_MEMZONE. */
 	uint32_t max_rules; /**< Max. balanced rules per lpm. */
+	uint32_t number_tbl8s; /**< Number of tbl8 groups. */
 	struct rte_lpm_rule_info rule_info[RTE_LPM_MAX_DEPTH]; /**< Rule info table. */
+	uint32_t rule_free;      /**< First free rule, chained by next. */
+	uint32_t rule_hash_mask; /**< Bitmask of rule_hash indexes. */
+	uint32_t *rule_hash;     /**< Heads of the rule hash chains. */
+	uint32_t tbl8_free_count; /**< Number of free tbl8 groups. */
+	uint32_t *tbl8_free;     /**< Stack of free tbl8 groups. */
+	struct rte_rcu_qsbr *v;  /**< RCU variable of the readers. */
+	enum rte_lpm_qsbr_mode rcu_mode; /**< tbl8 group reclamation mode. */
+	struct rte_rcu_qsbr_dq *dq; /**< Queue of tbl8 groups to reclaim. */
 
 	/* LPM Tables. */
+	struct rte_lpm_tbl8_entry *tbl8; /**< LPM tbl8 table. */
 	struct rte_lpm_tbl24_entry tbl24[RTE_LPM_TBL24_NUM_ENTRIES] \
 			__rte_cache_aligned; /**< LPM tbl24 table. */
-	struct rte_lpm_tbl8_entry tbl8[RTE_LPM_TBL8_NUM_ENTRIES] \
-			__rte_cache_aligned; /**< LPM tbl8 table. */
 	struct rte_lpm_rule rules_tbl[0] \
 			__rte_cache_aligned; /**< LPM rules. */
 };
 
 /**
- * Create an LPM object.
+ * Create an LPM object with RTE_LPM_TBL8_NUM_GROUPS tbl8 groups.
  *
  * @param name
  *   LPM object name
@@ -172,6 +229,33 @@ struct rte_lpm {
 struct rte_lpm *
 rte_lpm_create(const char *name, int socket_id, int max_rules, int flags);
 
+/**
+ * Create an LPM object, with the number of tbl8 groups set by the
+ * configuration. Each group of 256 tbl8 entries holds the rules deeper than
+ * 24 bits of one /24 prefix, so a full Internet routing table needs tens
+ * of thousands of groups.
+ *
+ * @param name
+ *   LPM object name
+ * @param socket_id
+ *   NUMA socket ID for LPM table memory allocation
+ * @param config
+ *   Structure containing the configuration
+ * @return
+ *   Handle to LPM object on success, NULL otherwise with rte_errno set
+ *   to an appropriate values. Possible rte_errno values include:
+ *    - E_RTE_NO_CONFIG - function could not get pointer to rte_config structure
+ *    - E_RTE_SECONDARY - function was called from a secondary process instance
+ *    - E_RTE_NO_TAILQ - no tailq list could be got for the lpm object list
+ *    - EINVAL - invalid parameter passed to function
+ *    - ENOSPC - the maximum number of memzones has already been allocated
+ *    - EEXIST - a memzone with the same name already exists
+ *    - ENOMEM - no appropriate memory area found in which to create memzone
+ */
+struct rte_lpm *
+rte_lpm_create_config(const char *name, int socket_id,
+		const struct rte_lpm_config *config);
+
 /**
  * Find an existing LPM object and return a pointer to it.
  *
@@ -206,12 +290,13 @@ rte_lpm_free(struct rte_lpm *lpm);
  * @param depth
  *   Depth of the rule to be added to the LPM table
  * @param next_hop
- *   Next hop of the rule to be added to the LPM table
+ *   Next hop of the rule to be added to the LPM table, at most
+ *   RTE_LPM_MAX_NEXT_HOP
  * @return
  *   0 on success, negative value otherwise
  */
 int
-rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t next_hop);
+rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint32_t next_hop);
 
 /**
  * Check if a rule is present in the LPM table,
@@ -230,7 +315,7 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t next_hop);
  */
 int
 rte_lpm_is_rule_present(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
-uint8_t *next_hop);
+uint32_t *next_hop);
 
 /**
  * Delete a rule from the LPM table.
@@ -256,6 +341,31 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth);
 void
 rte_lpm_delete_all(struct rte_lpm *lpm);
 
+/**
+ * Associate a QSBR variable with an LPM object, so that routes can be
+ * added and deleted while other threads look the table up.
+ *
+ * Entries are always updated with single atomic stores; what the readers
+ * need to be protected from is a tbl8 group being freed and reused while
+ * they are still walking it. Once a QSBR variable is attached, a freed
+ * group is only reused after every reader registered with the variable
+ * reported a quiescent state. Lookups are unchanged.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param cfg
+ *   RCU configuration
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameters
+ *    - -EEXIST - a QSBR variable is already attached
+ *    - -ENOMEM - no memory for the defer queue
+ *    - -ENAMETOOLONG - the defer queue name derived from the LPM name
+ *      does not fit in RTE_RCU_QSBR_DQ_NAMESIZE
+ */
+int
+rte_lpm_rcu_qsbr_add(struct rte_lpm *lpm, const struct rte_lpm_rcu_config *cfg);
+
 /**
  * Lookup an IP into the LPM table.
  *
@@ -269,28 +379,29 @@ rte_lpm_delete_all(struct rte_lpm *lpm);
  *   -EINVAL for incorrect arguments, -ENOENT on lookup miss, 0 on lookup hit
  */
 static inline int
-rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint8_t *next_hop)
+rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint32_t *next_hop)
 {
 	unsigned tbl24_index = (ip >> 8);
-	uint16_t tbl_entry;
+	uint32_t tbl_entry;
 
 	/* DEBUG: Check user input arguments. */
 	RTE_LPM_RETURN_IF_TRUE(((lpm == NULL) || (next_hop == NULL)), -EINVAL);
 
 	/* Copy tbl24 entry */
-	tbl_entry = *(const uint16_t *)&lpm->tbl24[tbl24_index];
+	tbl_entry = lpm->tbl24[tbl24_index].val;
 
 	/* Copy tbl8 entry (only if needed) */
 	if (unlikely((tbl_entry & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 
 		unsigned tbl8_index = (uint8_t)ip +
-				((uint8_t)tbl_entry * RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
+				((tbl_entry & RTE_LPM_NEXT_HOP_MASK) *
+				 RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
 
-		tbl_entry = *(const uint16_t *)&lpm->tbl8[tbl8_index];
+		tbl_entry = lpm->tbl8[tbl8_index].val;
 	}
 
-	*next_hop = (uint8_t)tbl_entry;
+	*next_hop = tbl_entry & RTE_LPM_NEXT_HOP_MASK;
 	return (tbl_entry & RTE_LPM_LOOKUP_SUCCESS) ? 0 : -ENOENT;
 }
 
@@ -304,10 +415,10 @@ rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint8_t *next_hop)
  *   Array of IPs to be looked up in the LPM table
  * @param next_hops
  *   Next hop of the most specific rule found for IP (valid on lookup hit only).
- *   This is an array of two byte values. The most significant byte in each
+ *   This is an array of four byte values. The most significant byte in each
  *   value says whether the lookup was successful (bitmask
- *   RTE_LPM_LOOKUP_SUCCESS is set). The least significant byte is the
- *   actual next hop.
+ *   RTE_LPM_LOOKUP_SUCCESS is set). The three least significant bytes are
+ *   the actual next hop.
  * @param n
  *   Number of elements in ips (and next_hops) array to lookup. This should be a
  *   compile time constant, and divisible by 8 for best performance.
@@ -319,7 +430,7 @@ rte_lpm_lookup(struct rte_lpm *lpm, uint32_t ip, uint8_t *next_hop)
 
 static inline int
 rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
-		uint16_t * next_hops, const unsigned n)
+		uint32_t * next_hops, const unsigned n)
 {
 	unsigned i;
 	unsigned tbl24_indexes[n];
@@ -334,24 +445,24 @@ rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
 
 	for (i = 0; i < n; i++) {
 		/* Simply copy tbl24 entry to output */
-		next_hops[i] = *(const uint16_t *)&lpm->tbl24[tbl24_indexes[i]];
+		next_hops[i] = lpm->tbl24[tbl24_indexes[i]].val;
 
 		/* Overwrite output with tbl8 entry if needed */
 		if (unlikely((next_hops[i] & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 				RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
 
 			unsigned tbl8_index = (uint8_t)ips[i] +
-					((uint8_t)next_hops[i] *
+					((next_hops[i] & RTE_LPM_NEXT_HOP_MASK) *
 					 RTE_LPM_TBL8_GROUP_NUM_ENTRIES);
 
-			next_hops[i] = *(const uint16_t *)&lpm->tbl8[tbl8_index];
+			next_hops[i] = lpm->tbl8[tbl8_index].val;
 		}
 	}
 	return 0;
 }
 
-/* Mask four results. */
-#define	 RTE_LPM_MASKX4_RES	UINT64_C(0x00ff00ff00ff00ff)
+/* Mask two results. */
+#define	 RTE_LPM_MASKX2_RES	UINT64_C(0x00ffffff00ffffff)
 
 /**
  * Lookup four IP addresses in an LPM table.
@@ -362,10 +473,10 @@ rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
  *   Four IPs to be looked up in the LPM table
  * @param hop
  *   Next hop of the most specific rule found for IP (valid on lookup hit only).
- *   This is an 4 elements array of two byte values.
- *   If the lookup was succesfull for the given IP, then least significant byte
- *   of the corresponding element is the  actual next hop and the most
- *   significant byte is zero.
+ *   This is an 4 elements array of four byte values.
+ *   If the lookup was succesfull for the given IP, then the three least
+ *   significant bytes of the corresponding element are the actual next hop
+ *   and the most significant byte is zero.
  *   If the lookup for the given IP failed, then corresponding element would
  *   contain default value, see description of then next parameter.
  * @param defv
@@ -373,36 +484,32 @@ rte_lpm_lookup_bulk_func(const struct rte_lpm *lpm, const uint32_t * ips,
  *   if lookup would fail.
  */
 static inline void
-rte_lpm_lookupx4(const struct rte_lpm *lpm, __m128i ip, uint16_t hop[4],
-	uint16_t defv)
+rte_lpm_lookupx4(const struct rte_lpm *lpm, __m128i ip, uint32_t hop[4],
+	uint32_t defv)
 {
 	__m128i i24;
 	rte_xmm_t i8;
-	uint16_t tbl[4];
-	uint64_t idx, pt;
+	uint32_t tbl[4];
+	uint64_t idx, pt, pt2;
 
 	const __m128i mask8 =
 		_mm_set_epi32(UINT8_MAX, UINT8_MAX, UINT8_MAX, UINT8_MAX);
 
 	/*
-	 * RTE_LPM_VALID_EXT_ENTRY_BITMASK for 4 LPM entries
-	 * as one 64-bit value (0x0300030003000300).
+	 * RTE_LPM_VALID_EXT_ENTRY_BITMASK for 2 LPM entries
+	 * as one 64-bit value (0x0300000003000000).
 	 */
 	const uint64_t mask_xv =
 		((uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK |
-		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 16 |
-		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 32 |
-		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 48);
+		(uint64_t)RTE_LPM_VALID_EXT_ENTRY_BITMASK << 32);
 
 	/*
-	 * RTE_LPM_LOOKUP_SUCCESS for 4 LPM entries
-	 * as one 64-bit value (0x0100010001000100).
+	 * RTE_LPM_LOOKUP_SUCCESS for 2 LPM entries
+	 * as one 64-bit value (0x0100000001000000).
 	 */
 	const uint64_t mask_v =
 		((uint64_t)RTE_LPM_LOOKUP_SUCCESS |
-		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 16 |
-		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 32 |
-		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 48);
+		(uint64_t)RTE_LPM_LOOKUP_SUCCESS << 32);
 
 	/* get 4 indexes for tbl24[]. */
 	i24 = _mm_srli_epi32(ip, CHAR_BIT);
@@ -411,58 +518,64 @@ rte_lpm_lookupx4(const struct rte_lpm *lpm, __m128i ip, uint16_t hop[4],
 	idx = _mm_cvtsi128_si64(i24);
 	i24 = _mm_srli_si128(i24, sizeof(uint64_t));
 
-	tbl[0] = *(const uint16_t *)&lpm->tbl24[(uint32_t)idx];
-	tbl[1] = *(const uint16_t *)&lpm->tbl24[idx >> 32];
+	tbl[0] = lpm->tbl24[(uint32_t)idx].val;
+	tbl[1] = lpm->tbl24[idx >> 32].val;
 
 	idx = _mm_cvtsi128_si64(i24);
 
-	tbl[2] = *(const uint16_t *)&lpm->tbl24[(uint32_t)idx];
-	tbl[3] = *(const uint16_t *)&lpm->tbl24[idx >> 32];
+	tbl[2] = lpm->tbl24[(uint32_t)idx].val;
+	tbl[3] = lpm->tbl24[idx >> 32].val;
 
 	/* get 4 indexes for tbl8[]. */
 	i8.m = _mm_and_si128(ip, mask8);
 
 	pt = (uint64_t)tbl[0] |
-		(uint64_t)tbl[1] << 16 |
-		(uint64_t)tbl[2] << 32 |
-		(uint64_t)tbl[3] << 48;
+		(uint64_t)tbl[1] << 32;
+	pt2 = (uint64_t)tbl[2] |
+		(uint64_t)tbl[3] << 32;
 
 	/* search successfully finished for all 4 IP addresses. */
-	if (likely((pt & mask_xv) == mask_v)) {
+	if (likely((pt & mask_xv) == mask_v) &&
+			likely((pt2 & mask_xv) == mask_v)) {
 		uintptr_t ph = (uintptr_t)hop;
-		*(uint64_t *)ph = pt & RTE_LPM_MASKX4_RES;
+		*(uint64_t *)ph = pt & RTE_LPM_MASKX2_RES;
+		*(uint64_t *)(ph + sizeof(uint64_t)) = pt2 & RTE_LPM_MASKX2_RES;
 		return;
 	}
 
 	if (unlikely((pt & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
-		i8.u32[0] = i8.u32[0] +
-			(uint8_t)tbl[0] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[0] = *(const uint16_t *)&lpm->tbl8[i8.u32[0]];
+		i8.u32[0] = i8.u32[0] + (tbl[0] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		tbl[0] = lpm->tbl8[i8.u32[0]].val;
 	}
-	if (unlikely((pt >> 16 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
+	if (unlikely((pt >> 32 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
-		i8.u32[1] = i8.u32[1] +
-			(uint8_t)tbl[1] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[1] = *(const uint16_t *)&lpm->tbl8[i8.u32[1]];
+		i8.u32[1] = i8.u32[1] + (tbl[1] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		tbl[1] = lpm->tbl8[i8.u32[1]].val;
 	}
-	if (unlikely((pt >> 32 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
+	if (unlikely((pt2 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
-		i8.u32[2] = i8.u32[2] +
-			(uint8_t)tbl[2] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[2] = *(const uint16_t *)&lpm->tbl8[i8.u32[2]];
+		i8.u32[2] = i8.u32[2] + (tbl[2] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		tbl[2] = lpm->tbl8[i8.u32[2]].val;
 	}
-	if (unlikely((pt >> 48 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
+	if (unlikely((pt2 >> 32 & RTE_LPM_VALID_EXT_ENTRY_BITMASK) ==
 			RTE_LPM_VALID_EXT_ENTRY_BITMASK)) {
-		i8.u32[3] = i8.u32[3] +
-			(uint8_t)tbl[3] * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
-		tbl[3] = *(const uint16_t *)&lpm->tbl8[i8.u32[3]];
+		i8.u32[3] = i8.u32[3] + (tbl[3] & RTE_LPM_NEXT_HOP_MASK) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		tbl[3] = lpm->tbl8[i8.u32[3]].val;
 	}
 
-	hop[0] = (tbl[0] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[0] : defv;
-	hop[1] = (tbl[1] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[1] : defv;
-	hop[2] = (tbl[2] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[2] : defv;
-	hop[3] = (tbl[3] & RTE_LPM_LOOKUP_SUCCESS) ? (uint8_t)tbl[3] : defv;
+	hop[0] = (tbl[0] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[0] & RTE_LPM_NEXT_HOP_MASK : defv;
+	hop[1] = (tbl[1] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[1] & RTE_LPM_NEXT_HOP_MASK : defv;
+	hop[2] = (tbl[2] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[2] & RTE_LPM_NEXT_HOP_MASK : defv;
+	hop[3] = (tbl[3] & RTE_LPM_LOOKUP_SUCCESS) ?
+		tbl[3] & RTE_LPM_NEXT_HOP_MASK : defv;
 }
 
 #ifdef __cplusplus
@@ -45,6 +45,7 @@
 #include <rte_malloc.h>
 #include <rte_memzone.h>
 #include <rte_memcpy.h>
+#include <rte_prefetch.h>
 #include <rte_tailq.h>
 #include <rte_eal.h>
 #include <rte_eal_memconfig.h>
@@ -57,6 +58,7 @@
 #include "rte_lpm6.h"
 
 #define RTE_LPM6_TBL24_NUM_ENTRIES        (1 << 24)
+#define RTE_LPM6_TBL16_NUM_ENTRIES        (1 << 16)
 #define RTE_LPM6_TBL8_GROUP_NUM_ENTRIES         256
 #define RTE_LPM6_TBL8_MAX_NUM_GROUPS      (1 << 21)
 
@@ -64,11 +66,12 @@
 #define RTE_LPM6_LOOKUP_SUCCESS          0x20000000
 #define RTE_LPM6_TBL8_BITMASK            0x001FFFFF
 
-#define ADD_FIRST_BYTE                            3
-#define LOOKUP_FIRST_BYTE                         4
 #define BYTE_SIZE                                 8
 #define BYTES2_SIZE                              16
 
+/* Number of addresses walked side by side by the bulk lookup. */
+#define LOOKUP_BULK_INTERLEAVE                    8
+
 #define lpm6_tbl8_gindex next_hop
 
 /** Flags for setting an entry as valid/invalid. */
@@ -79,7 +82,7 @@ enum valid_flag {
 
 TAILQ_HEAD(rte_lpm6_list, rte_tailq_entry);
 
-/** Tbl entry structure. It is the same for both tbl24 and tbl8 */
+/** Tbl entry structure. It is the same for both tbl24/tbl16 and tbl8 */
 struct rte_lpm6_tbl_entry {
 	uint32_t next_hop:	21;  /**< Next hop / next table to be checked. */
 	uint32_t depth	:8;      /**< Rule depth. */
@@ -104,14 +107,24 @@ struct rte_lpm6 {
 	uint32_t max_rules;              /**< Max number of rules. */
 	uint32_t used_rules;             /**< Used rules so far. */
 	uint32_t number_tbl8s;           /**< Number of tbl8s to allocate. */
-	uint32_t next_tbl8;              /**< Next tbl8 to be used. */
+	uint32_t tbl8_free_count;        /**< Number of free tbl8 groups. */
+	uint32_t *tbl8_free;             /**< Stack of free tbl8 groups. */
+
+	/* RCU config. */
+	struct rte_rcu_qsbr *v;          /**< RCU QSBR variable. */
+	enum rte_lpm6_qsbr_mode rcu_mode;/**< Blocking, defer queue. */
+	struct rte_rcu_qsbr_dq *dq;      /**< RCU QSBR defer queue. */
+
+	/* First level geometry, tbl24 or tbl16. */
+	uint32_t tbl24_num_entries;      /**< Number of first level entries. */
+	uint8_t first_bytes;             /**< Address bytes of the first level. */
+	uint8_t tbl24_shift;             /**< Shift of a 24-bit first index. */
 
 	/* LPM Tables. */
 	struct rte_lpm6_rule *rules_tbl; /**< LPM rules. */
-	struct rte_lpm6_tbl_entry tbl24[RTE_LPM6_TBL24_NUM_ENTRIES]
-			__rte_cache_aligned; /**< LPM tbl24 table. */
-	struct rte_lpm6_tbl_entry tbl8[0]
-			__rte_cache_aligned; /**< LPM tbl8 table. */
+	struct rte_lpm6_tbl_entry *tbl8; /**< LPM tbl8 table, after tbl24. */
+	struct rte_lpm6_tbl_entry tbl24[0]
+			__rte_cache_aligned; /**< LPM tbl24 (or tbl16) table. */
 };
 
 /*
@@ -138,6 +151,19 @@ mask_ip(uint8_t *ip, uint8_t depth)
 		}
 }
 
+/*
+ * Puts every tbl8 group on the free stack, lowest index on top.
+ */
+static void
+tbl8_pool_init(struct rte_lpm6 *lpm)
+{
+	uint32_t i;
+
+	for (i = 0; i < lpm->number_tbl8s; i++)
+		lpm->tbl8_free[i] = lpm->number_tbl8s - 1 - i;
+	lpm->tbl8_free_count = lpm->number_tbl8s;
+}
+
 /*
  * Allocates memory for LPM object
  */
@@ -149,6 +175,7 @@ rte_lpm6_create(const char *name, int socket_id,
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_tailq_entry *te;
 	uint64_t mem_size, rules_size;
+	uint32_t tbl24_num_entries;
 	struct rte_lpm6_list *lpm_list;
 
 	/* Check that we have an initialised tail queue */
@@ -170,9 +197,13 @@ rte_lpm6_create(const char *name, int socket_id,
 
 	snprintf(mem_name, sizeof(mem_name), "LPM_%s", name);
 
+	tbl24_num_entries = (config->flags & RTE_LPM6_F_TBL16) ?
+			RTE_LPM6_TBL16_NUM_ENTRIES : RTE_LPM6_TBL24_NUM_ENTRIES;
+
 	/* Determine the amount of memory to allocate. */
-	mem_size = sizeof(*lpm) + (sizeof(lpm->tbl8[0]) *
-			RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * config->number_tbl8s);
+	mem_size = sizeof(*lpm) + sizeof(lpm->tbl24[0]) * tbl24_num_entries +
+			(sizeof(lpm->tbl8[0]) * RTE_LPM6_TBL8_GROUP_NUM_ENTRIES *
+			config->number_tbl8s);
 	rules_size = sizeof(struct rte_lpm6_rule) * config->max_rules;
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
@@ -209,6 +240,20 @@ rte_lpm6_create(const char *name, int socket_id,
 	if (lpm->rules_tbl == NULL) {
 		RTE_LOG(ERR, LPM, "LPM memory allocation failed\n");
 		rte_free(lpm);
+		lpm = NULL;
+		rte_free(te);
+		goto exit;
+	}
+
+	lpm->tbl8_free = (uint32_t *)rte_zmalloc_socket(NULL,
+			sizeof(uint32_t) * RTE_MAX(config->number_tbl8s, 1U),
+			RTE_CACHE_LINE_SIZE, socket_id);
+
+	if (lpm->tbl8_free == NULL) {
+		RTE_LOG(ERR, LPM, "LPM memory allocation failed\n");
+		rte_free(lpm->rules_tbl);
+		rte_free(lpm);
+		lpm = NULL;
 		rte_free(te);
 		goto exit;
 	}
@@ -216,6 +261,12 @@ rte_lpm6_create(const char *name, int socket_id,
 	/* Save user arguments. */
 	lpm->max_rules = config->max_rules;
 	lpm->number_tbl8s = config->number_tbl8s;
+	lpm->tbl24_num_entries = tbl24_num_entries;
+	lpm->first_bytes = (tbl24_num_entries == RTE_LPM6_TBL16_NUM_ENTRIES) ?
+			2 : 3;
+	lpm->tbl24_shift = (uint8_t)((3 - lpm->first_bytes) * BYTE_SIZE);
+	lpm->tbl8 = &lpm->tbl24[tbl24_num_entries];
+	tbl8_pool_init(lpm);
 	snprintf(lpm->name, sizeof(lpm->name), "%s", name);
 
 	te->data = (void *) lpm;
@@ -276,7 +327,7 @@ rte_lpm6_free(struct rte_lpm6 *lpm)
 
 	/* check that we have an initialised tail queue */
 	if ((lpm_list =
-	     RTE_TAILQ_LOOKUP_BY_IDX(RTE_TAILQ_LPM, rte_lpm6_list)) == NULL) {
+	     RTE_TAILQ_LOOKUP_BY_IDX(RTE_TAILQ_LPM6, rte_lpm6_list)) == NULL) {
 		rte_errno = E_RTE_NO_TAILQ;
 		return;
 	}
@@ -297,10 +348,117 @@ rte_lpm6_free(struct rte_lpm6 *lpm)
 
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
+	rte_rcu_qsbr_dq_delete(lpm->dq);
+	rte_free(lpm->tbl8_free);
+	rte_free(lpm->rules_tbl);
 	rte_free(lpm);
 	rte_free(te);
 }
 
+/*
+ * Puts a tbl8 group back on the free stack.
+ */
+static void
+tbl8_reclaim(void *p, uint32_t tbl8_gindex)
+{
+	struct rte_lpm6 *lpm = p;
+
+	lpm->tbl8_free[lpm->tbl8_free_count++] = tbl8_gindex;
+}
+
+/*
+ * Associate a QSBR variable with an LPM object.
+ */
+int
+rte_lpm6_rcu_qsbr_add(struct rte_lpm6 *lpm,
+		const struct rte_lpm6_rcu_config *cfg)
+{
+	struct rte_rcu_qsbr_dq_parameters params;
+	char dq_name[RTE_RCU_QSBR_DQ_NAMESIZE];
+
+	if ((lpm == NULL) || (cfg == NULL) || (cfg->v == NULL))
+		return -EINVAL;
+
+	if (lpm->v != NULL)
+		return -EEXIST;
+
+	if (cfg->mode == RTE_LPM6_QSBR_MODE_DQ) {
+		memset(&params, 0, sizeof(params));
+		if (snprintf(dq_name, sizeof(dq_name), "LPM6_RCU_%s", lpm->name)
+				>= (int)sizeof(dq_name))
+			return -ENAMETOOLONG;
+		params.name = dq_name;
+		params.socket_id = SOCKET_ID_ANY;
+		params.size = (cfg->dq_size != 0) ?
+				cfg->dq_size : RTE_MAX(lpm->number_tbl8s, 1U);
+		params.trigger_reclaim_limit = RTE_MIN(params.size,
+				(cfg->reclaim_thd != 0) ?
+				cfg->reclaim_thd : RTE_LPM6_RCU_DQ_RECLAIM_THD);
+		params.max_reclaim_size = (cfg->reclaim_max != 0) ?
+				cfg->reclaim_max : RTE_LPM6_RCU_DQ_RECLAIM_MAX;
+		params.free_fn = tbl8_reclaim;
+		params.p = lpm;
+		params.v = cfg->v;
+
+		lpm->dq = rte_rcu_qsbr_dq_create(&params);
+		if (lpm->dq == NULL) {
+			RTE_LOG(ERR, LPM, "LPM6 defer queue creation failed\n");
+			return -ENOMEM;
+		}
+	} else if (cfg->mode != RTE_LPM6_QSBR_MODE_SYNC)
+		return -EINVAL;
+
+	lpm->rcu_mode = cfg->mode;
+	lpm->v = cfg->v;
+
+	return 0;
+}
+
+/*
+ * Takes a tbl8 group from the free stack and cleans it.
+ */
+static inline int32_t
+tbl8_alloc(struct rte_lpm6 *lpm)
+{
+	uint32_t tbl8_gindex;
+
+	/* Take back the groups whose readers are gone, if any. */
+	if (lpm->tbl8_free_count == 0 && lpm->dq != NULL)
+		rte_rcu_qsbr_dq_reclaim(lpm->dq, lpm->number_tbl8s, NULL, NULL);
+
+	if (lpm->tbl8_free_count == 0)
+		return -ENOSPC;
+
+	tbl8_gindex = lpm->tbl8_free[--lpm->tbl8_free_count];
+	memset(&lpm->tbl8[tbl8_gindex * RTE_LPM6_TBL8_GROUP_NUM_ENTRIES], 0,
+			RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * sizeof(lpm->tbl8[0]));
+
+	return tbl8_gindex;
+}
+
+/*
+ * Releases a tbl8 group no table entry points to anymore.
+ */
+static inline void
+tbl8_free(struct rte_lpm6 *lpm, uint32_t tbl8_gindex)
+{
+	if (lpm->v == NULL) {
+		tbl8_reclaim(lpm, tbl8_gindex);
+		return;
+	}
+
+	/*
+	 * Readers may still be walking the group: reuse it only after they
+	 * all went through a quiescent state.
+	 */
+	if (lpm->rcu_mode == RTE_LPM6_QSBR_MODE_DQ &&
+			rte_rcu_qsbr_dq_enqueue(lpm->dq, tbl8_gindex) == 0)
+		return;
+
+	rte_rcu_qsbr_synchronize(lpm->v, RTE_QSBR_THRID_INVALID);
+	tbl8_reclaim(lpm, tbl8_gindex);
+}
+
 /*
  * Checks if a rule already exists in the rules table and updates
  * the nexthop if so. Otherwise it adds a new rule if enough space is available.
@@ -450,10 +608,9 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 	else {
 		/* If it's invalid a new tbl8 is needed */
 		if (!tbl[tbl_index].valid) {
-			if (lpm->next_tbl8 < lpm->number_tbl8s)
-				tbl8_gindex = (lpm->next_tbl8)++;
-			else
-				return -ENOSPC;
+			tbl8_gindex = tbl8_alloc(lpm);
+			if (tbl8_gindex < 0)
+				return tbl8_gindex;
 
 			struct rte_lpm6_tbl_entry new_tbl_entry = {
 				.lpm6_tbl8_gindex = tbl8_gindex,
@@ -463,6 +620,8 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 				.ext_entry = 1,
 			};
 
+			/* The group must be clean before readers can reach it. */
+			rte_wmb();
 			tbl[tbl_index] = new_tbl_entry;
 		}
 		/*
@@ -471,10 +630,9 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 		 */
 		else if (tbl[tbl_index].ext_entry == 0) {
 			/* Search for free tbl8 group. */
-			if (lpm->next_tbl8 < lpm->number_tbl8s)
-				tbl8_gindex = (lpm->next_tbl8)++;
-			else
-				return -ENOSPC;
+			tbl8_gindex = tbl8_alloc(lpm);
+			if (tbl8_gindex < 0)
+				return tbl8_gindex;
 
 			tbl8_group_start = tbl8_gindex *
 					RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
@@ -502,6 +660,8 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 				.ext_entry = 1,
 			};
 
+			/* The group must be filled before readers can reach it. */
+			rte_wmb();
 			tbl[tbl_index] = new_tbl_entry;
 		}
 
@@ -542,9 +702,9 @@ rte_lpm6_add(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth,
 		return rule_index;
 	}
 
-	/* Inspect the first three bytes through tbl24 on the first step. */
+	/* Inspect the first bytes through tbl24 (or tbl16) on the first step. */
 	tbl = lpm->tbl24;
-	status = add_step (lpm, tbl, &tbl_next, masked_ip, ADD_FIRST_BYTE, 1,
+	status = add_step (lpm, tbl, &tbl_next, masked_ip, lpm->first_bytes, 1,
 			depth, next_hop);
 	if (status < 0) {
 		rte_lpm6_delete(lpm, masked_ip, depth);
@@ -556,7 +716,8 @@ rte_lpm6_add(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth,
 	 * Inspect one by one the rest of the bytes until
 	 * the process is completed.
 	 */
-	for (i = ADD_FIRST_BYTE; i < RTE_LPM6_IPV6_ADDR_SIZE && status == 1; i++) {
+	for (i = lpm->first_bytes; i < RTE_LPM6_IPV6_ADDR_SIZE && status == 1;
+			i++) {
 		tbl = tbl_next;
 		status = add_step (lpm, tbl, &tbl_next, masked_ip, 1, (uint8_t)(i+1),
 				depth, next_hop);
@@ -620,8 +781,9 @@ rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop)
 		return -EINVAL;
 	}
 
-	first_byte = LOOKUP_FIRST_BYTE;
-	tbl24_index = (ip[0] << BYTES2_SIZE) | (ip[1] << BYTE_SIZE) | ip[2];
+	first_byte = (uint8_t)(lpm->first_bytes + 1);
+	tbl24_index = ((ip[0] << BYTES2_SIZE) | (ip[1] << BYTE_SIZE) | ip[2]) >>
+			lpm->tbl24_shift;
 
 	/* Calculate pointer to the first entry to be inspected */
 	tbl = &lpm->tbl24[tbl24_index];
@@ -636,18 +798,22 @@ rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop)
 }
 
 /*
- * Looks up a group of IP addresses
+ * Looks up a group of IP addresses. The addresses are walked down the
+ * levels side by side, and the entry each of them needs next is prefetched
+ * while the others are looked at, so that the cache misses overlap.
  */
 int
 rte_lpm6_lookup_bulk_func(const struct rte_lpm6 *lpm,
 		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE],
 		int16_t * next_hops, unsigned n)
 {
-	unsigned i;
-	const struct rte_lpm6_tbl_entry *tbl;
+	unsigned i, j, k, p, left;
+	const struct rte_lpm6_tbl_entry *tbl[LOOKUP_BULK_INTERLEAVE];
 	const struct rte_lpm6_tbl_entry *tbl_next;
+	uint8_t first_byte[LOOKUP_BULK_INTERLEAVE];
+	uint8_t pending[LOOKUP_BULK_INTERLEAVE];
 	uint32_t tbl24_index;
-	uint8_t first_byte, next_hop;
+	uint8_t next_hop;
 	int status;
 
 	/* DEBUG: Check user input arguments. */
@@ -655,25 +821,42 @@ rte_lpm6_lookup_bulk_func(const struct rte_lpm6 *lpm,
 		return -EINVAL;
 	}
 
-	for (i = 0; i < n; i++) {
-		first_byte = LOOKUP_FIRST_BYTE;
-		tbl24_index = (ips[i][0] << BYTES2_SIZE) |
-				(ips[i][1] << BYTE_SIZE) | ips[i][2];
+	for (i = 0; i < n; i += k) {
+		k = RTE_MIN(n - i, (unsigned)LOOKUP_BULK_INTERLEAVE);
 
-		/* Calculate pointer to the first entry to be inspected */
-		tbl = &lpm->tbl24[tbl24_index];
+		for (j = 0; j < k; j++) {
+			tbl24_index = ((ips[i + j][0] << BYTES2_SIZE) |
+					(ips[i + j][1] << BYTE_SIZE) |
+					ips[i + j][2]) >> lpm->tbl24_shift;
 
-		do {
-			/* Continue inspecting following levels until success or failure */
-			status = lookup_step(lpm, tbl, &tbl_next, ips[i], first_byte++,
-					&next_hop);
-			tbl = tbl_next;
-		} while (status == 1);
+			/* Calculate pointer to the first entry to be inspected */
+			tbl[j] = &lpm->tbl24[tbl24_index];
+			rte_prefetch0((void *)(uintptr_t)tbl[j]);
+			first_byte[j] = (uint8_t)(lpm->first_bytes + 1);
+			pending[j] = (uint8_t)j;
+		}
 
-		if (status < 0)
-			next_hops[i] = -1;
-		else
-			next_hops[i] = next_hop;
+		/*
+		 * Inspect one level of every address still walking, keep the
+		 * ones that go on in pending[].
+		 */
+		for (left = k; left != 0; left = p) {
+			for (p = 0, j = 0; j < left; j++) {
+				unsigned x = pending[j];
+
+				status = lookup_step(lpm, tbl[x], &tbl_next,
+						ips[i + x], first_byte[x]++,
+						&next_hop);
+				if (status == 1) {
+					tbl[x] = tbl_next;
+					rte_prefetch0((void *)(uintptr_t)tbl_next);
+					pending[p++] = (uint8_t)x;
+				} else if (status < 0)
+					next_hops[i + x] = -1;
+				else
+					next_hops[i + x] = next_hop;
+			}
+		}
 	}
 
 	return 0;
@@ -750,25 +933,155 @@ rule_delete(struct rte_lpm6 *lpm, int32_t rule_index)
 }
 
 /*
- * Deletes a rule
+ * Finds the longest rule less specific than depth that covers ip.
+ * Returns its index, or -ENOENT if ip is only covered by the deleted rule.
  */
-int
-rte_lpm6_delete(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
+static int32_t
+rule_find_less_specific(struct rte_lpm6 *lpm, const uint8_t *ip, uint8_t depth)
 {
-	int32_t rule_to_delete_index;
 	uint8_t ip_masked[RTE_LPM6_IPV6_ADDR_SIZE];
-	unsigned i;
+	uint32_t rule_index;
+	int32_t found = -ENOENT;
+	uint8_t found_depth = 0;
 
-	/*
-	 * Check input arguments.
-	 */
-	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM6_MAX_DEPTH)) {
-		return -EINVAL;
+	for (rule_index = 0; rule_index < lpm->used_rules; rule_index++) {
+		const struct rte_lpm6_rule *rule = &lpm->rules_tbl[rule_index];
+
+		if (rule->depth >= depth || rule->depth <= found_depth)
+			continue;
+
+		memcpy(ip_masked, ip, RTE_LPM6_IPV6_ADDR_SIZE);
+		mask_ip(ip_masked, rule->depth);
+		if (memcmp(ip_masked, rule->ip, RTE_LPM6_IPV6_ADDR_SIZE) == 0) {
+			found = rule_index;
+			found_depth = rule->depth;
+		}
 	}
 
-	/* Copy the IP and mask it to avoid modifying user's input data. */
-	memcpy(ip_masked, ip, RTE_LPM6_IPV6_ADDR_SIZE);
-	mask_ip(ip_masked, depth);
+	return found;
+}
+
+/*
+ * Collapses the tbl8 group an entry points to back into the entry when all
+ * the group entries are the same, then frees the group. The entry is
+ * rewritten before the group is freed, so readers never reach a group that
+ * is being reused.
+ */
+static void
+tbl8_recycle(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *entry,
+		uint8_t bits_covered)
+{
+	struct rte_lpm6_tbl_entry *tbl8;
+	struct rte_lpm6_tbl_entry new_entry;
+	uint32_t tbl8_gindex, i;
+
+	tbl8_gindex = entry->lpm6_tbl8_gindex;
+	tbl8 = &lpm->tbl8[tbl8_gindex * RTE_LPM6_TBL8_GROUP_NUM_ENTRIES];
+
+	/* A rule more specific than the entry must stay in the group. */
+	if (tbl8[0].ext_entry == 1 ||
+			(tbl8[0].valid && tbl8[0].depth > bits_covered))
+		return;
+
+	for (i = 1; i < RTE_LPM6_TBL8_GROUP_NUM_ENTRIES; i++) {
+		if (tbl8[i].ext_entry == 1 || tbl8[i].valid != tbl8[0].valid)
+			return;
+		if (tbl8[i].valid && (tbl8[i].depth != tbl8[0].depth ||
+				tbl8[i].next_hop != tbl8[0].next_hop))
+			return;
+	}
+
+	memset(&new_entry, 0, sizeof(new_entry));
+	if (tbl8[0].valid) {
+		new_entry.next_hop = tbl8[0].next_hop;
+		new_entry.depth = tbl8[0].depth;
+		new_entry.valid = VALID;
+		new_entry.valid_group = VALID;
+	}
+
+	*entry = new_entry;
+	tbl8_free(lpm, tbl8_gindex);
+}
+
+/*
+ * Replaces the entries of a deleted rule in a tbl8 group, and in the groups
+ * below it, by the entry of the next less specific rule.
+ */
+static void
+delete_expand(struct rte_lpm6 *lpm, uint32_t tbl8_gindex, uint8_t depth,
+		const struct rte_lpm6_tbl_entry *new_entry, uint8_t bits_covered)
+{
+	struct rte_lpm6_tbl_entry *tbl8;
+	uint32_t i;
+
+	tbl8 = &lpm->tbl8[tbl8_gindex * RTE_LPM6_TBL8_GROUP_NUM_ENTRIES];
+
+	for (i = 0; i < RTE_LPM6_TBL8_GROUP_NUM_ENTRIES; i++) {
+		if (tbl8[i].ext_entry == 1) {
+			delete_expand(lpm, tbl8[i].lpm6_tbl8_gindex, depth,
+					new_entry, bits_covered + BYTE_SIZE);
+			tbl8_recycle(lpm, &tbl8[i], bits_covered);
+		} else if (tbl8[i].valid && tbl8[i].depth == depth)
+			tbl8[i] = *new_entry;
+	}
+}
+
+/*
+ * Removes a rule from the data structure (tbl24+tbl8s), walking the same
+ * path as add_step() and freeing the tbl8 groups it leaves uniform.
+ */
+static void
+delete_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
+		const uint8_t *ip, uint8_t bytes, uint8_t first_byte, uint8_t depth,
+		const struct rte_lpm6_tbl_entry *new_entry)
+{
+	uint32_t tbl_index, tbl_range, i;
+	int8_t bitshift;
+	uint8_t bits_covered;
+
+	tbl_index = 0;
+	for (i = first_byte; i < (uint32_t)(first_byte + bytes); i++) {
+		bitshift = (int8_t)((bytes - i)*BYTE_SIZE);
+
+		if (bitshift < 0) bitshift = 0;
+		tbl_index = tbl_index | ip[i-1] << bitshift;
+	}
+
+	bits_covered = (uint8_t)((bytes+first_byte-1)*BYTE_SIZE);
+
+	if (depth <= bits_covered) {
+		tbl_range = 1 << (bits_covered - depth);
+
+		for (i = tbl_index; i < (tbl_index + tbl_range); i++) {
+			if (tbl[i].ext_entry == 1) {
+				delete_expand(lpm, tbl[i].lpm6_tbl8_gindex, depth,
+						new_entry, bits_covered + BYTE_SIZE);
+				tbl8_recycle(lpm, &tbl[i], bits_covered);
+			} else if (tbl[i].valid && tbl[i].depth == depth)
+				tbl[i] = *new_entry;
+		}
+
+		return;
+	}
+
+	/* Nothing below this entry if the rule was never fully added. */
+	if (!tbl[tbl_index].valid || tbl[tbl_index].ext_entry == 0)
+		return;
+
+	delete_step(lpm, &lpm->tbl8[tbl[tbl_index].lpm6_tbl8_gindex *
+			RTE_LPM6_TBL8_GROUP_NUM_ENTRIES], ip, 1,
+			(uint8_t)(first_byte + bytes), depth, new_entry);
+	tbl8_recycle(lpm, &tbl[tbl_index], bits_covered);
+}
+
+/*
+ * Deletes a masked rule from the rules table and from the data structure.
+ */
+static int
+delete_rule(struct rte_lpm6 *lpm, uint8_t *ip_masked, uint8_t depth)
+{
+	struct rte_lpm6_tbl_entry new_entry;
+	int32_t rule_to_delete_index, sub_rule_index;
 
 	/*
 	 * Find the index of the input rule, that needs to be deleted, in the
@@ -787,24 +1100,44 @@ rte_lpm6_delete(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
 	rule_delete(lpm, rule_to_delete_index);
 
 	/*
-	 * Set all the table entries to 0 (ie delete every rule
-	 * from the data structure.
+	 * The entries of the deleted rule now belong to the next less specific
+	 * rule, or become invalid if there is none.
 	 */
-	lpm->next_tbl8 = 0;
-	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
-	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0])
-			* RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
+	memset(&new_entry, 0, sizeof(new_entry));
+	sub_rule_index = rule_find_less_specific(lpm, ip_masked, depth);
+	if (sub_rule_index >= 0) {
+		new_entry.next_hop = lpm->rules_tbl[sub_rule_index].next_hop;
+		new_entry.depth = lpm->rules_tbl[sub_rule_index].depth;
+		new_entry.valid = VALID;
+		new_entry.valid_group = VALID;
+	}
+
+	delete_step(lpm, lpm->tbl24, ip_masked, lpm->first_bytes, 1, depth,
+			&new_entry);
+
+	return 0;
+}
+
+/*
+ * Deletes a rule
+ */
+int
+rte_lpm6_delete(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
+{
+	uint8_t ip_masked[RTE_LPM6_IPV6_ADDR_SIZE];
 
 	/*
-	 * Add every rule again (except for the one that was removed from
-	 * the rules table).
+	 * Check input arguments.
 	 */
-	for (i = 0; i < lpm->used_rules; i++) {
-		rte_lpm6_add(lpm, lpm->rules_tbl[i].ip, lpm->rules_tbl[i].depth,
-				lpm->rules_tbl[i].next_hop);
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM6_MAX_DEPTH)) {
+		return -EINVAL;
 	}
 
-	return 0;
+	/* Copy the IP and mask it to avoid modifying user's input data. */
+	memcpy(ip_masked, ip, RTE_LPM6_IPV6_ADDR_SIZE);
+	mask_ip(ip_masked, depth);
+
+	return delete_rule(lpm, ip_masked, depth);
 }
 
 /*
@@ -814,7 +1147,6 @@ int
 rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE], uint8_t *depths, unsigned n)
 {
-	int32_t rule_to_delete_index;
 	uint8_t ip_masked[RTE_LPM6_IPV6_ADDR_SIZE];
 	unsigned i;
 
@@ -826,43 +1158,15 @@ rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 	}
 
 	for (i = 0; i < n; i++) {
+		if ((depths[i] < 1) || (depths[i] > RTE_LPM6_MAX_DEPTH))
+			continue;
+
 		/* Copy the IP and mask it to avoid modifying user's input data. */
 		memcpy(ip_masked, ips[i], RTE_LPM6_IPV6_ADDR_SIZE);
 		mask_ip(ip_masked, depths[i]);
 
-		/*
-		 * Find the index of the input rule, that needs to be deleted, in the
-		 * rule table.
-		 */
-		rule_to_delete_index = rule_find(lpm, ip_masked, depths[i]);
-
-		/*
-		 * Check if rule_to_delete_index was found. If no rule was found the
-		 * function rule_find returns -ENOENT.
-		 */
-		if (rule_to_delete_index < 0)
-			continue;
-
-		/* Delete the rule from the rule table. */
-		rule_delete(lpm, rule_to_delete_index);
-	}
-
-	/*
-	 * Set all the table entries to 0 (ie delete every rule
-	 * from the data structure.
-	 */
-	lpm->next_tbl8 = 0;
-	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
-	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0])
-			* RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
-
-	/*
-	 * Add every rule again (except for the ones that were removed from
-	 * the rules table).
-	 */
-	for (i = 0; i < lpm->used_rules; i++) {
-		rte_lpm6_add(lpm, lpm->rules_tbl[i].ip, lpm->rules_tbl[i].depth,
-				lpm->rules_tbl[i].next_hop);
+		/* Rules that are not in the table are skipped. */
+		delete_rule(lpm, ip_masked, depths[i]);
 	}
 
 	return 0;
@@ -874,19 +1178,25 @@ rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 void
 rte_lpm6_delete_all(struct rte_lpm6 *lpm)
 {
+	/* Drop the groups waiting for their grace period. */
+	if (lpm->dq != NULL) {
+		rte_rcu_qsbr_synchronize(lpm->v, RTE_QSBR_THRID_INVALID);
+		rte_rcu_qsbr_dq_reclaim(lpm->dq, lpm->number_tbl8s, NULL, NULL);
+	}
+
 	/* Zero used rules counter. */
 	lpm->used_rules = 0;
 
-	/* Zero next tbl8 index. */
-	lpm->next_tbl8 = 0;
-
 	/* Zero tbl24. */
-	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
+	memset(lpm->tbl24, 0, sizeof(lpm->tbl24[0]) * lpm->tbl24_num_entries);
 
 	/* Zero tbl8. */
 	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0]) *
 			RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
 
+	/* All the tbl8 groups are free again. */
+	tbl8_pool_init(lpm);
+
 	/* Delete all rules form the rules table. */
 	memset(lpm->rules_tbl, 0, sizeof(struct rte_lpm6_rule) * lpm->max_rules);
 }
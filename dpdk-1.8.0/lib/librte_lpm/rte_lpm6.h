@@ -42,12 +42,22 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+#include <rte_rcu_qsbr.h>
 
 #define RTE_LPM6_MAX_DEPTH               128
 #define RTE_LPM6_IPV6_ADDR_SIZE           16
 /** Max number of characters in LPM name. */
 #define RTE_LPM6_NAMESIZE                 32
 
+/**
+ * Index the first level of the table with 16 address bits instead of 24.
+ * The first level shrinks from 64 MB to 256 KB, so the memory of the table
+ * is mostly its number_tbl8s groups of 1 KB and follows the number and the
+ * length of the prefixes. Each lookup walks one more tbl8 level.
+ */
+#define RTE_LPM6_F_TBL16                 0x0001
+
 /** LPM structure. */
 struct rte_lpm6;
 
@@ -55,7 +65,30 @@ struct rte_lpm6;
 struct rte_lpm6_config {
 	uint32_t max_rules;      /**< Max number of rules. */
 	uint32_t number_tbl8s;   /**< Number of tbl8s to allocate. */
-	int flags;               /**< This field is currently unused. */
+	int flags;               /**< RTE_LPM6_F_* flags. */
+};
+
+/** Reclamation modes of the tbl8 groups of an LPM6 table using RCU. */
+enum rte_lpm6_qsbr_mode {
+	/** Queue freed groups, reclaim them when their grace period ended. */
+	RTE_LPM6_QSBR_MODE_DQ = 0,
+	/** Wait for the grace period each time a group is freed. */
+	RTE_LPM6_QSBR_MODE_SYNC
+};
+
+/** Default number of queued tbl8 groups that triggers a reclaim. */
+#define RTE_LPM6_RCU_DQ_RECLAIM_THD      32
+
+/** Default maximum number of tbl8 groups reclaimed at once. */
+#define RTE_LPM6_RCU_DQ_RECLAIM_MAX      16
+
+/** LPM6 RCU configuration structure. */
+struct rte_lpm6_rcu_config {
+	struct rte_rcu_qsbr *v;      /**< QSBR variable of the readers. */
+	enum rte_lpm6_qsbr_mode mode; /**< Reclamation mode. */
+	uint32_t dq_size;      /**< Defer queue size, 0 for number of tbl8s. */
+	uint32_t reclaim_thd;  /**< Reclaim threshold, 0 for the default. */
+	uint32_t reclaim_max;  /**< Max groups per reclaim, 0 for the default. */
 };
 
 /**
@@ -146,6 +179,10 @@ uint8_t *next_hop);
 /**
  * Delete a rule from the LPM table.
  *
+ * Only the table entries covered by the rule are rewritten, with the next
+ * less specific rule, and the tbl8 groups left with identical entries are
+ * freed. Other prefixes keep being looked up while the rule is deleted.
+ *
  * @param lpm
  *   LPM object handle
  * @param ip
@@ -185,6 +222,28 @@ rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 void
 rte_lpm6_delete_all(struct rte_lpm6 *lpm);
 
+/**
+ * Associate a QSBR variable with an LPM object, so that routes can be
+ * added and deleted while other threads look the table up. A freed tbl8
+ * group is only reused after every reader registered with the variable
+ * reported a quiescent state. Lookups are unchanged.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param cfg
+ *   RCU configuration
+ * @return
+ *   0 on success, negative value otherwise:
+ *    - -EINVAL - invalid parameters
+ *    - -EEXIST - a QSBR variable is already attached
+ *    - -ENOMEM - no memory for the defer queue
+ *    - -ENAMETOOLONG - the defer queue name derived from the LPM name
+ *      does not fit in RTE_RCU_QSBR_DQ_NAMESIZE
+ */
+int
+rte_lpm6_rcu_qsbr_add(struct rte_lpm6 *lpm,
+		const struct rte_lpm6_rcu_config *cfg);
+
 /**
  * Lookup an IP into the LPM table.
  *
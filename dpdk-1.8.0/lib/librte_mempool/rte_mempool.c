@@ -63,7 +63,73 @@
 
 TAILQ_HEAD(rte_mempool_list, rte_tailq_entry);
 
-#define CACHE_FLUSHTHRESH_MULTIPLIER 1.5
+/* table of the pool handlers registered in this process */
+struct rte_mempool_ops_table rte_mempool_ops_table = {
+	.sl = RTE_SPINLOCK_INITIALIZER,
+	.num_ops = 0
+};
+
+/* add a new pool handler in the table */
+int
+rte_mempool_ops_register(const struct rte_mempool_ops *h)
+{
+	struct rte_mempool_ops *ops;
+	unsigned i;
+	int ops_index;
+
+	if (h->alloc == NULL || h->put == NULL || h->get == NULL ||
+			h->get_count == NULL) {
+		RTE_LOG(ERR, MEMPOOL,
+			"Missing callback while registering mempool ops\n");
+		return -EINVAL;
+	}
+
+	if (strnlen(h->name, sizeof(ops->name)) == 0 ||
+			strnlen(h->name, sizeof(ops->name)) == sizeof(ops->name)) {
+		RTE_LOG(ERR, MEMPOOL, "Invalid mempool ops name\n");
+		return -EINVAL;
+	}
+
+	rte_spinlock_lock(&rte_mempool_ops_table.sl);
+
+	for (i = 0; i < rte_mempool_ops_table.num_ops; i++) {
+		if (strcmp(h->name, rte_mempool_ops_table.ops[i].name) == 0) {
+			rte_spinlock_unlock(&rte_mempool_ops_table.sl);
+			RTE_LOG(ERR, MEMPOOL,
+				"Mempool ops <%s> already registered\n",
+				h->name);
+			return -EEXIST;
+		}
+	}
+
+	if (rte_mempool_ops_table.num_ops >= RTE_MEMPOOL_MAX_OPS_IDX) {
+		rte_spinlock_unlock(&rte_mempool_ops_table.sl);
+		RTE_LOG(ERR, MEMPOOL,
+			"Maximum number of mempool ops structs exceeded\n");
+		return -ENOSPC;
+	}
+
+	ops_index = rte_mempool_ops_table.num_ops++;
+	ops = &rte_mempool_ops_table.ops[ops_index];
+	*ops = *h;
+
+	rte_spinlock_unlock(&rte_mempool_ops_table.sl);
+
+	return ops_index;
+}
+
+/* return the index of a pool handler from its name, or -1 */
+static int
+mempool_ops_lookup(const char *name)
+{
+	unsigned i;
+
+	for (i = 0; i < rte_mempool_ops_table.num_ops; i++) {
+		if (strcmp(name, rte_mempool_ops_table.ops[i].name) == 0)
+			return i;
+	}
+	return -1;
+}
 
 /*
  * return the greatest common divisor between a and b (fast algorithm)
@@ -140,8 +206,8 @@ mempool_add_elem(struct rte_mempool *mp, void *obj, uint32_t obj_idx,
 	if (obj_init)
 		obj_init(mp, obj_init_arg, obj, obj_idx);
 
-	/* enqueue in ring */
-	rte_ring_sp_enqueue(mp->ring, obj);
+	/* enqueue in the common pool */
+	__mempool_get_ops(mp)->put(mp, &obj, 1, 0);
 }
 
 uint32_t
@@ -388,33 +454,33 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
 }
 
 /*
- * Create the mempool over already allocated chunk of memory.
- * That external memory buffer can consists of physically disjoint pages.
- * Setting vaddr to NULL, makes mempool to fallback to original behaviour
- * and allocate space for mempool and it's elements as one big chunk of
- * physically continuos memory.
- * */
-struct rte_mempool *
-rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
+ * Create the mempool over already allocated chunk of memory, using the
+ * given pool handler.
+ */
+static struct rte_mempool *
+mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 		unsigned cache_size, unsigned private_data_size,
 		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
 		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
 		int socket_id, unsigned flags, void *vaddr,
-		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift)
+		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift,
+		const char *ops_name)
 {
 	char mz_name[RTE_MEMZONE_NAMESIZE];
-	char rg_name[RTE_RING_NAMESIZE];
 	struct rte_mempool *mp = NULL;
 	struct rte_tailq_entry *te;
-	struct rte_ring *r;
 	const struct rte_memzone *mz;
 	size_t mempool_size;
 	int mz_flags = RTE_MEMZONE_1GB|RTE_MEMZONE_SIZE_HINT_ONLY;
-	int rg_flags = 0;
+	int ops_index;
+	int ret;
 	void *obj;
 	struct rte_mempool_objsz objsz;
 	void *startaddr;
 	int page_size = getpagesize();
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	unsigned lcore_id;
+#endif
 
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(struct rte_mempool) &
@@ -457,16 +523,18 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 		return NULL;
 	}
 
+	/* check that the pool handler is registered */
+	ops_index = mempool_ops_lookup(ops_name);
+	if (ops_index < 0) {
+		RTE_LOG(ERR, MEMPOOL, "Unknown mempool ops <%s>\n", ops_name);
+		rte_errno = ENOENT;
+		return NULL;
+	}
+
 	/* "no cache align" imply "no spread" */
 	if (flags & MEMPOOL_F_NO_CACHE_ALIGN)
 		flags |= MEMPOOL_F_NO_SPREAD;
 
-	/* ring flags */
-	if (flags & MEMPOOL_F_SP_PUT)
-		rg_flags |= RING_F_SP_ENQ;
-	if (flags & MEMPOOL_F_SC_GET)
-		rg_flags |= RING_F_SC_DEQ;
-
 	/* calculate mempool object sizes. */
 	if (!rte_mempool_calc_obj_size(elt_size, flags, &objsz)) {
 		rte_errno = EINVAL;
@@ -475,15 +543,6 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 	rte_rwlock_write_lock(RTE_EAL_MEMPOOL_RWLOCK);
 
-	/* allocate the ring that will be used to store objects */
-	/* Ring functions will return appropriate errors if we are
-	 * running as a secondary process etc., so no checks made
-	 * in this function for that condition */
-	snprintf(rg_name, sizeof(rg_name), RTE_MEMPOOL_MZ_FORMAT, name);
-	r = rte_ring_create(rg_name, rte_align32pow2(n+1), socket_id, rg_flags);
-	if (r == NULL)
-		goto exit;
-
 	/*
 	 * reserve a memory zone for this mempool: private data is
 	 * cache-aligned
@@ -558,15 +617,23 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 	memset(mp, 0, sizeof(*mp));
 	snprintf(mp->name, sizeof(mp->name), "%s", name);
 	mp->phys_addr = mz->phys_addr;
-	mp->ring = r;
+	mp->ops_index = ops_index;
+	mp->socket_id = socket_id;
 	mp->size = n;
 	mp->flags = flags;
 	mp->elt_size = objsz.elt_size;
 	mp->header_size = objsz.header_size;
 	mp->trailer_size = objsz.trailer_size;
 	mp->cache_size = cache_size;
-	mp->cache_flushthresh = (uint32_t)
-		(cache_size * CACHE_FLUSHTHRESH_MULTIPLIER);
+	mp->cache_min_size = cache_size;
+	mp->cache_init_size = cache_size;
+	mp->cache_flushthresh = RTE_MEMPOOL_CACHE_FLUSHTHRESH(cache_size);
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		mp->local_cache[lcore_id].size = cache_size;
+		mp->local_cache[lcore_id].flushthresh = mp->cache_flushthresh;
+	}
+#endif
 	mp->private_data_size = private_data_size;
 
 	/* calculate address of the first element for continuous mempool. */
@@ -592,6 +659,19 @@ rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
 
 	mp->elt_va_end = mp->elt_va_start;
 
+	/*
+	 * allocate the pool handler data that will be used to store
+	 * objects; as for the memzone above, the space reserved for the
+	 * mempool is lost on failure
+	 */
+	ret = __mempool_get_ops(mp)->alloc(mp);
+	if (ret < 0) {
+		rte_errno = -ret;
+		rte_free(te);
+		mp = NULL;
+		goto exit;
+	}
+
 	/* call the initializer */
 	if (mp_init)
 		mp_init(mp, mp_init_arg);
@@ -608,13 +688,65 @@ exit:
 	return mp;
 }
 
+/* create the mempool, using the given pool handler */
+struct rte_mempool *
+rte_mempool_create_with_ops(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, const char *ops_name)
+{
+#ifdef RTE_LIBRTE_XEN_DOM0
+	if (strcmp(ops_name, RTE_MEMPOOL_OPS_DEFAULT) != 0) {
+		rte_errno = ENOTSUP;
+		return NULL;
+	}
+	return (rte_dom0_mempool_create(name, n, elt_size,
+		cache_size, private_data_size,
+		mp_init, mp_init_arg,
+		obj_init, obj_init_arg,
+		socket_id, flags));
+#else
+	return (mempool_xmem_create(name, n, elt_size,
+		cache_size, private_data_size,
+		mp_init, mp_init_arg,
+		obj_init, obj_init_arg,
+		socket_id, flags,
+		NULL, NULL, MEMPOOL_PG_NUM_DEFAULT, MEMPOOL_PG_SHIFT_MAX,
+		ops_name));
+#endif
+}
+
+/*
+ * Create the mempool over already allocated chunk of memory.
+ * That external memory buffer can consists of physically disjoint pages.
+ * Setting vaddr to NULL, makes mempool to fallback to original behaviour
+ * and allocate space for mempool and it's elements as one big chunk of
+ * physically continuos memory.
+ * */
+struct rte_mempool *
+rte_mempool_xmem_create(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, void *vaddr,
+		const phys_addr_t paddr[], uint32_t pg_num, uint32_t pg_shift)
+{
+	return (mempool_xmem_create(name, n, elt_size,
+		cache_size, private_data_size,
+		mp_init, mp_init_arg,
+		obj_init, obj_init_arg,
+		socket_id, flags, vaddr, paddr, pg_num, pg_shift,
+		RTE_MEMPOOL_OPS_DEFAULT));
+}
+
 /* Return the number of entries in the mempool */
 unsigned
 rte_mempool_count(const struct rte_mempool *mp)
 {
 	unsigned count;
 
-	count = rte_ring_count(mp->ring);
+	count = __mempool_get_ops(mp)->get_count(mp);
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	{
@@ -636,21 +768,106 @@ rte_mempool_count(const struct rte_mempool *mp)
 	return count;
 }
 
+/* change the range of the per-lcore cache sizes */
+int
+rte_mempool_set_cache_range(struct rte_mempool *mp, unsigned min_size,
+		unsigned max_size)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	struct rte_mempool_cache *cache;
+	unsigned lcore_id;
+
+	/* a disabled cache can be enabled again, a missing one cannot */
+	if (mp->cache_init_size == 0)
+		return -ENOTSUP;
+
+	if (min_size > max_size || max_size > RTE_MEMPOOL_CACHE_MAX_SIZE)
+		return -EINVAL;
+
+	mp->cache_min_size = min_size;
+	mp->cache_size = max_size;
+	mp->cache_flushthresh = RTE_MEMPOOL_CACHE_FLUSHTHRESH(max_size);
+
+	/*
+	 * Restart every cache from the new maximum size, giving back what
+	 * it holds beyond it; they adapt again from there.
+	 */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		cache = &mp->local_cache[lcore_id];
+		if (cache->len > max_size) {
+			__mempool_get_ops(mp)->put(mp, &cache->objs[max_size],
+				cache->len - max_size, 1);
+			cache->len = max_size;
+		}
+		cache->size = max_size;
+		cache->flushthresh = mp->cache_flushthresh;
+		cache->max_burst = 0;
+		cache->nb_ops = 0;
+	}
+	return 0;
+#else
+	RTE_SET_USED(mp);
+	RTE_SET_USED(min_size);
+	RTE_SET_USED(max_size);
+	return -ENOTSUP;
+#endif
+}
+
+/* put the objects of an lcore cache back in the common pool */
+int
+rte_mempool_cache_drain(struct rte_mempool *mp, unsigned lcore_id)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	struct rte_mempool_cache *cache;
+	unsigned len;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+
+	cache = &mp->local_cache[lcore_id];
+	len = cache->len;
+	if (len != 0)
+		__mempool_get_ops(mp)->put(mp, cache->objs, len, 1);
+	cache->len = 0;
+	return len;
+#else
+	RTE_SET_USED(mp);
+	if (lcore_id >= RTE_MAX_LCORE)
+		return -EINVAL;
+	return 0;
+#endif
+}
+
 /* dump the cache status */
 static unsigned
 rte_mempool_dump_cache(FILE *f, const struct rte_mempool *mp)
 {
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	const struct rte_mempool_cache *cache;
 	unsigned lcore_id;
 	unsigned count = 0;
 	unsigned cache_count;
 
 	fprintf(f, "  cache infos:\n");
 	fprintf(f, "    cache_size=%"PRIu32"\n", mp->cache_size);
+	fprintf(f, "    cache_min_size=%"PRIu32"\n", mp->cache_min_size);
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		cache_count = mp->local_cache[lcore_id].len;
+		cache = &mp->local_cache[lcore_id];
+		cache_count = cache->len;
 		fprintf(f, "    cache_count[%u]=%u\n", lcore_id, cache_count);
 		count += cache_count;
+
+		/* only dump the caches that were used */
+		if (cache->get_hits + cache->get_misses +
+				cache->put_hits + cache->put_misses == 0)
+			continue;
+		fprintf(f, "    cache_stats[%u]: size=%"PRIu32
+			" flushthresh=%"PRIu32" get_hits=%"PRIu64
+			" get_misses=%"PRIu64" put_hits=%"PRIu64
+			" put_misses=%"PRIu64"\n", lcore_id,
+			cache->size, cache->flushthresh,
+			cache->get_hits, cache->get_misses,
+			cache->put_hits, cache->put_misses);
 	}
 	fprintf(f, "    total_cache_count=%u\n", count);
 	return count;
@@ -728,10 +945,15 @@ mempool_audit_cookies(const struct rte_mempool *mp)
 static void
 mempool_audit_cache(const struct rte_mempool *mp)
 {
-	/* check cache size consistency */
+	/*
+	 * check cache size consistency: the length of a cache can stay
+	 * above its flush threshold after the cache range is reduced,
+	 * until the next put on that lcore
+	 */
 	unsigned lcore_id;
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
-		if (mp->local_cache[lcore_id].len > mp->cache_flushthresh) {
+		if (mp->local_cache[lcore_id].len >
+				RTE_DIM(mp->local_cache[lcore_id].objs)) {
 			RTE_LOG(CRIT, MEMPOOL, "badness on cache[%u]\n",
 				lcore_id);
 			rte_panic("MEMPOOL: invalid cache len\n");
@@ -770,7 +992,8 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 
 	fprintf(f, "mempool <%s>@%p\n", mp->name, mp);
 	fprintf(f, "  flags=%x\n", mp->flags);
-	fprintf(f, "  ring=<%s>@%p\n", mp->ring->name, mp->ring);
+	fprintf(f, "  ops=<%s>\n", __mempool_get_ops(mp)->name);
+	fprintf(f, "  pool_data=%p\n", mp->pool_data);
 	fprintf(f, "  phys_addr=0x%" PRIx64 "\n", mp->phys_addr);
 	fprintf(f, "  size=%"PRIu32"\n", mp->size);
 	fprintf(f, "  header_size=%"PRIu32"\n", mp->header_size);
@@ -793,7 +1016,7 @@ rte_mempool_dump(FILE *f, const struct rte_mempool *mp)
 			mp->size);
 
 	cache_count = rte_mempool_dump_cache(f, mp);
-	common_count = rte_ring_count(mp->ring);
+	common_count = __mempool_get_ops(mp)->get_count(mp);
 	if ((cache_count + common_count) > mp->size)
 		common_count = mp->size - cache_count;
 	fprintf(f, "  common_pool_count=%u\n", common_count);
@@ -39,10 +39,17 @@
  * RTE Mempool.
  *
  * A memory pool is an allocator of fixed-size object. It is
- * identified by its name, and uses a ring to store free objects. It
- * provides some other optional services, like a per-core object
- * cache, and an alignment helper to ensure that objects are padded
- * to spread them equally on all RAM channels, ranks, and so on.
+ * identified by its name, and uses a pool handler to store free
+ * objects. It provides some other optional services, like a per-core
+ * object cache, and an alignment helper to ensure that objects are
+ * padded to spread them equally on all RAM channels, ranks, and so on.
+ *
+ * The pool handler is selected by name when the mempool is created
+ * (see rte_mempool_create_with_ops()). Two handlers are provided: "ring",
+ * the default, which stores objects in a lockless ring, and "stack",
+ * which stores them in a LIFO so that the most recently freed, and
+ * likely cache-hot, objects are allocated first. Other handlers can be
+ * registered with MEMPOOL_REGISTER_OPS().
  *
  * Objects owned by a mempool should never be added in another
  * mempool. When an object is freed using rte_mempool_put() or
@@ -52,7 +59,7 @@
  *
  * Note: the mempool implementation is not preemptable. A lcore must
  * not be interrupted by another task that uses the same mempool
- * (because it uses a ring which is not preemptable). Also, mempool
+ * (because its pool handlers are not preemptable). Also, mempool
  * functions must not be used outside the DPDK environment: for
  * example, in linuxapp environment, a thread that is not created by
  * the EAL must not use mempools. This is due to the per-lcore cache
@@ -71,6 +78,7 @@
 #include <rte_lcore.h>
 #include <rte_memory.h>
 #include <rte_branch_prediction.h>
+#include <rte_spinlock.h>
 #include <rte_ring.h>
 
 #ifdef __cplusplus
@@ -95,12 +103,37 @@ struct rte_mempool_debug_stats {
 } __rte_cache_aligned;
 #endif
 
+/**
+ * Flush threshold of a per-core cache of the given size.
+ */
+#define RTE_MEMPOOL_CACHE_FLUSHTHRESH(size) ((size) + (size) / 2)
+
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+/**
+ * Number of get/put operations on a per-core cache after which its size
+ * is adapted to the largest burst seen.
+ */
+#define RTE_MEMPOOL_CACHE_ADAPT_PERIOD 256
+
+/**
+ * Ratio between the size of a per-core cache and the largest burst of
+ * objects got from or put in it.
+ */
+#define RTE_MEMPOOL_CACHE_BURST_FACTOR 2
+
 /**
  * A structure that stores a per-core object cache.
  */
 struct rte_mempool_cache {
 	unsigned len; /**< Cache len */
+	uint32_t size;        /**< Current size, adapted at runtime. */
+	uint32_t flushthresh; /**< Threshold before we flush excess elements. */
+	uint32_t max_burst;   /**< Largest burst since the last adaptation. */
+	uint32_t nb_ops;      /**< Operations since the last adaptation. */
+	uint64_t get_hits;    /**< Gets served from the cache. */
+	uint64_t get_misses;  /**< Gets that needed the common pool. */
+	uint64_t put_hits;    /**< Puts stored in the cache. */
+	uint64_t put_misses;  /**< Puts that flushed to the common pool. */
 	/*
 	 * Cache is allocated to this size to allow it to overflow in certain
 	 * cases to avoid needless emptying of cache.
@@ -144,13 +177,17 @@ struct rte_mempool_objsz {
  */
 struct rte_mempool {
 	char name[RTE_MEMPOOL_NAMESIZE]; /**< Name of mempool. */
-	struct rte_ring *ring;           /**< Ring to store objects. */
+	void *pool_data;                 /**< Pool handler private data. */
+	int32_t ops_index;               /**< Index of the pool handler. */
+	int socket_id;                   /**< Socket id passed at creation. */
 	phys_addr_t phys_addr;           /**< Phys. addr. of mempool struct. */
 	int flags;                       /**< Flags of the mempool. */
 	uint32_t size;                   /**< Size of the mempool. */
-	uint32_t cache_size;             /**< Size of per-lcore local cache. */
+	uint32_t cache_size;             /**< Max size of per-lcore cache. */
+	uint32_t cache_min_size;         /**< Min size of per-lcore cache. */
+	uint32_t cache_init_size;        /**< Cache size given at creation. */
 	uint32_t cache_flushthresh;
-	/**< Threshold before we flush excess elements. */
+	/**< Max threshold before we flush excess elements. */
 
 	uint32_t elt_size;               /**< Size of an element. */
 	uint32_t header_size;            /**< Size of header (before elt). */
@@ -188,6 +225,107 @@ struct rte_mempool {
 #define MEMPOOL_F_SP_PUT         0x0004 /**< Default put is "single-producer".*/
 #define MEMPOOL_F_SC_GET         0x0008 /**< Default get is "single-consumer".*/
 
+#define RTE_MEMPOOL_OPS_NAMESIZE 32 /**< Max length of a pool handler name. */
+#define RTE_MEMPOOL_MAX_OPS_IDX 16  /**< Max number of pool handlers. */
+
+/** Name of the pool handler used by rte_mempool_create(). */
+#define RTE_MEMPOOL_OPS_DEFAULT "ring"
+
+/**
+ * Prototype for the pool handler function allocating the handler private
+ * data. It is called once the mempool structure is initialized, before
+ * the objects are added; it must store its data in mp->pool_data.
+ * Returns 0 on success, or a negative errno value.
+ */
+typedef int (*rte_mempool_alloc_t)(struct rte_mempool *mp);
+
+/**
+ * Prototype for the pool handler function storing objects. is_mp is 1
+ * when several lcores may call it concurrently. Returns 0 on success, or
+ * a negative errno value if the objects cannot be stored.
+ */
+typedef int (*rte_mempool_put_t)(struct rte_mempool *mp,
+		void * const *obj_table, unsigned n, int is_mp);
+
+/**
+ * Prototype for the pool handler function retrieving objects. is_mc is 1
+ * when several lcores may call it concurrently. Either all n objects are
+ * retrieved and 0 is returned, or none and a negative errno value is
+ * returned.
+ */
+typedef int (*rte_mempool_get_t)(struct rte_mempool *mp,
+		void **obj_table, unsigned n, int is_mc);
+
+/**
+ * Prototype for the pool handler function returning the number of
+ * objects it stores, not counting the per-lcore caches.
+ */
+typedef unsigned (*rte_mempool_get_count_t)(const struct rte_mempool *mp);
+
+/**
+ * Structure defining a mempool pool handler.
+ */
+struct rte_mempool_ops {
+	char name[RTE_MEMPOOL_OPS_NAMESIZE]; /**< Name of the pool handler. */
+	rte_mempool_alloc_t alloc;           /**< Allocate private data. */
+	rte_mempool_put_t put;               /**< Store objects. */
+	rte_mempool_get_t get;               /**< Retrieve objects. */
+	rte_mempool_get_count_t get_count;   /**< Number of stored objects. */
+} __rte_cache_aligned;
+
+/**
+ * Table of the registered pool handlers. The mempool only stores the
+ * index of its handler, as the function pointers are not the same in
+ * the primary and secondary processes; the handlers must then be
+ * registered in the same order by all processes.
+ */
+struct rte_mempool_ops_table {
+	rte_spinlock_t sl;  /**< Protects registration. */
+	uint32_t num_ops;   /**< Number of registered pool handlers. */
+	/** Registered pool handlers. */
+	struct rte_mempool_ops ops[RTE_MEMPOOL_MAX_OPS_IDX];
+} __rte_cache_aligned;
+
+/** Table of the pool handlers registered in this process. */
+extern struct rte_mempool_ops_table rte_mempool_ops_table;
+
+/**
+ * @internal Get the pool handler of a mempool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @return
+ *   A pointer to the pool handler.
+ */
+static inline struct rte_mempool_ops *
+__mempool_get_ops(const struct rte_mempool *mp)
+{
+	return &rte_mempool_ops_table.ops[mp->ops_index];
+}
+
+/**
+ * Register a mempool pool handler.
+ *
+ * @param ops
+ *   A pointer to the pool handler structure; it is copied in the table.
+ * @return
+ *   - >=0: Success; index of the pool handler in the table.
+ *   - -EINVAL: Some of the handler functions are missing.
+ *   - -EEXIST: A pool handler with the same name is already registered.
+ *   - -ENOSPC: The maximum number of pool handlers has been reached.
+ */
+int rte_mempool_ops_register(const struct rte_mempool_ops *ops);
+
+/**
+ * Macro to statically register a mempool pool handler at startup.
+ */
+#define MEMPOOL_REGISTER_OPS(ops)\
+void mp_opsinitfn_ ##ops(void);\
+void __attribute__((constructor, used)) mp_opsinitfn_ ##ops(void)\
+{\
+	rte_mempool_ops_register(&ops);\
+}
+
 /**
  * @internal When debug is enabled, store some statistics.
  * @param mp
@@ -527,6 +665,7 @@ typedef void (rte_mempool_ctor_t)(struct rte_mempool *, void *);
  *    - ENOSPC - the maximum number of memzones has already been allocated
  *    - EEXIST - a memzone with the same name already exists
  *    - ENOMEM - no appropriate memory area found in which to create memzone
+ *    - ENAMETOOLONG - the name is too long for the pool handler data
  */
 struct rte_mempool *
 rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
@@ -535,6 +674,62 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
 		   rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
 		   int socket_id, unsigned flags);
 
+/**
+ * Creates a new mempool named *name* in memory, using the pool handler
+ * named *ops_name* to store free objects.
+ *
+ * This function behaves as rte_mempool_create(), which is equivalent to
+ * calling it with RTE_MEMPOOL_OPS_DEFAULT. The "stack" pool handler
+ * returns the most recently freed objects first: it is a good choice
+ * when objects are allocated and freed on different lcores, as the
+ * objects going through the common pool are still hot in the cache.
+ *
+ * @param name
+ *   The name of the mempool.
+ * @param n
+ *   The number of elements in the mempool.
+ * @param elt_size
+ *   The size of each element.
+ * @param cache_size
+ *   Size of the per-lcore object cache, see rte_mempool_create().
+ * @param private_data_size
+ *   The size of the private data appended after the mempool
+ *   structure.
+ * @param mp_init
+ *   A function pointer that is called for initialization of the pool,
+ *   before object initialization.
+ * @param mp_init_arg
+ *   An opaque pointer to data that can be used in the mempool
+ *   constructor function.
+ * @param obj_init
+ *   A function pointer that is called for each object at
+ *   initialization of the pool.
+ * @param obj_init_arg
+ *   An opaque pointer to data that can be used as an argument for
+ *   each call to the object constructor function.
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in the case of
+ *   NUMA.
+ * @param flags
+ *   Flags of the mempool, see rte_mempool_create().
+ * @param ops_name
+ *   The name of a registered pool handler, for instance "ring" or
+ *   "stack".
+ * @return
+ *   The pointer to the new allocated mempool, on success. NULL on error
+ *   with rte_errno set appropriately. In addition to the values of
+ *   rte_mempool_create(), possible rte_errno values include:
+ *    - ENOENT - no pool handler is registered with that name
+ *    - ENOTSUP - a pool handler other than the default one was requested
+ *      in a Xen Dom0 build
+ */
+struct rte_mempool *
+rte_mempool_create_with_ops(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, const char *ops_name);
+
 /**
  * Creates a new mempool named *name* in memory.
  *
@@ -738,6 +933,95 @@ rte_dom0_mempool_create(const char *name, unsigned n, unsigned elt_size,
  */
 void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
 
+/**
+ * Set the range in which the per-lcore caches are resized.
+ *
+ * Every RTE_MEMPOOL_CACHE_ADAPT_PERIOD operations, the cache of an lcore
+ * is resized to RTE_MEMPOOL_CACHE_BURST_FACTOR times the largest number
+ * of objects got or put in one call, within [min_size, max_size]. Its
+ * flush threshold follows its size. By default, both values are the
+ * cache_size given at creation, so the size of the caches is fixed.
+ *
+ * An lcore that frees objects in large bursts then keeps enough objects
+ * to avoid going to the common pool on each call, while an lcore using
+ * small bursts does not strand objects in its cache.
+ *
+ * All the caches restart from max_size and the objects they hold beyond
+ * it are put back in the common pool, so no lcore may use the mempool
+ * during the call.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param min_size
+ *   Minimum size of the per-lcore caches.
+ * @param max_size
+ *   Maximum size of the per-lcore caches, lower or equal to
+ *   CONFIG_RTE_MEMPOOL_CACHE_MAX_SIZE. Setting it to 0 empties and
+ *   disables the caches, a later call with a non-zero max_size enables
+ *   them again.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: min_size is greater than max_size, or max_size is too big.
+ *   - -ENOTSUP: The mempool was created without cache, or the per-lcore
+ *     caches are disabled in the configuration.
+ */
+int rte_mempool_set_cache_range(struct rte_mempool *mp, unsigned min_size,
+		unsigned max_size);
+
+/**
+ * Put all the objects of an lcore cache back in the common pool.
+ *
+ * This can be used to give back the objects kept by an lcore that
+ * stopped using the mempool. The lcore owning the cache must not use
+ * the mempool at the same time, except when calling this function
+ * itself.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The identifier of the lcore whose cache is drained.
+ * @return
+ *   - >=0: Success; number of objects put back in the common pool.
+ *   - -EINVAL: Invalid lcore identifier.
+ */
+int rte_mempool_cache_drain(struct rte_mempool *mp, unsigned lcore_id);
+
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+/**
+ * @internal Account a burst of n objects in an lcore cache, and resize
+ * the cache every RTE_MEMPOOL_CACHE_ADAPT_PERIOD operations.
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param cache
+ *   A pointer to the lcore cache.
+ * @param n
+ *   The number of objects got or put.
+ */
+static inline void __attribute__((always_inline))
+__mempool_cache_adapt(const struct rte_mempool *mp,
+		      struct rte_mempool_cache *cache, unsigned n)
+{
+	uint32_t size;
+
+	if (n > cache->max_burst)
+		cache->max_burst = n;
+
+	if (likely(++cache->nb_ops < RTE_MEMPOOL_CACHE_ADAPT_PERIOD))
+		return;
+
+	size = cache->max_burst * RTE_MEMPOOL_CACHE_BURST_FACTOR;
+	if (size < mp->cache_min_size)
+		size = mp->cache_min_size;
+	if (size > mp->cache_size)
+		size = mp->cache_size;
+
+	cache->size = size;
+	cache->flushthresh = RTE_MEMPOOL_CACHE_FLUSHTHRESH(size);
+	cache->max_burst = 0;
+	cache->nb_ops = 0;
+}
+#endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -754,13 +1038,13 @@ static inline void __attribute__((always_inline))
 __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 		    unsigned n, int is_mp)
 {
+	struct rte_mempool_ops *ops = __mempool_get_ops(mp);
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	struct rte_mempool_cache *cache;
 	uint32_t index;
 	void **cache_objs;
 	unsigned lcore_id = rte_lcore_id();
 	uint32_t cache_size = mp->cache_size;
-	uint32_t flushthresh = mp->cache_flushthresh;
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
 	/* increment stat now, adding in mempool always success */
@@ -771,18 +1055,19 @@ __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 	if (unlikely(cache_size == 0 || is_mp == 0))
 		goto ring_enqueue;
 
-	/* Go straight to ring if put would overflow mem allocated for cache */
+	/* Go straight to the pool if put would overflow mem allocated for cache */
 	if (unlikely(n > RTE_MEMPOOL_CACHE_MAX_SIZE))
 		goto ring_enqueue;
 
 	cache = &mp->local_cache[lcore_id];
+	__mempool_cache_adapt(mp, cache, n);
 	cache_objs = &cache->objs[cache->len];
 
 	/*
 	 * The cache follows the following algorithm
 	 *   1. Add the objects to the cache
 	 *   2. Anything greater than the cache min value (if it crosses the
-	 *   cache flush threshold) is flushed to the ring.
+	 *   cache flush threshold) is flushed to the common pool.
 	 */
 
 	/* Add elements back into the cache */
@@ -791,32 +1076,25 @@ __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 
 	cache->len += n;
 
-	if (cache->len >= flushthresh) {
-		rte_ring_mp_enqueue_bulk(mp->ring, &cache->objs[cache_size],
-				cache->len - cache_size);
-		cache->len = cache_size;
-	}
+	if (cache->len >= cache->flushthresh) {
+		ops->put(mp, &cache->objs[cache->size],
+				cache->len - cache->size, 1);
+		cache->len = cache->size;
+		cache->put_misses++;
+	} else
+		cache->put_hits++;
 
 	return;
 
 ring_enqueue:
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* push remaining objects in ring */
+	/* push remaining objects in the common pool */
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
-	if (is_mp) {
-		if (rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
-	else {
-		if (rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
+	if (ops->put(mp, obj_table, n, is_mp) < 0)
+		rte_panic("cannot put objects in mempool\n");
 #else
-	if (is_mp)
-		rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n);
-	else
-		rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n);
+	ops->put(mp, obj_table, n, is_mp);
 #endif
 }
 
@@ -937,12 +1215,13 @@ rte_mempool_put(struct rte_mempool *mp, void *obj)
  *   Mono-consumer (0) or multi-consumers (1).
  * @return
  *   - >=0: Success; number of objects supplied.
- *   - <0: Error; code of ring dequeue function.
+ *   - <0: Error; code of the pool handler get function.
  */
 static inline int __attribute__((always_inline))
 __mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
 		   unsigned n, int is_mc)
 {
+	struct rte_mempool_ops *ops = __mempool_get_ops(mp);
 	int ret;
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 	struct rte_mempool_cache *cache;
@@ -952,31 +1231,41 @@ __mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
 	uint32_t cache_size = mp->cache_size;
 
 	/* cache is not enabled or single consumer */
-	if (unlikely(cache_size == 0 || is_mc == 0 || n >= cache_size))
+	if (unlikely(cache_size == 0 || is_mc == 0))
 		goto ring_dequeue;
 
 	cache = &mp->local_cache[lcore_id];
+	__mempool_cache_adapt(mp, cache, n);
 	cache_objs = cache->objs;
 
+	/* request too big for the cache */
+	if (unlikely(n >= cache->size)) {
+		cache->get_misses++;
+		goto ring_dequeue;
+	}
+
 	/* Can this be satisfied from the cache? */
 	if (cache->len < n) {
 		/* No. Backfill the cache first, and then fill from it */
-		uint32_t req = n + (cache_size - cache->len);
+		uint32_t req = n + (cache->size - cache->len);
 
 		/* How many do we require i.e. number to fill the cache + the request */
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, &cache->objs[cache->len], req);
+		ret = ops->get(mp, &cache->objs[cache->len], req, 1);
 		if (unlikely(ret < 0)) {
 			/*
 			 * In the offchance that we are buffer constrained,
 			 * where we are not able to allocate cache + n, go to
-			 * the ring directly. If that fails, we are truly out of
+			 * the common pool directly. If that fails, we are truly out of
 			 * buffers.
 			 */
+			cache->get_misses++;
 			goto ring_dequeue;
 		}
 
 		cache->len += req;
-	}
+		cache->get_misses++;
+	} else
+		cache->get_hits++;
 
 	/* Now fill in the response ... */
 	for (index = 0, len = cache->len - 1; index < n; ++index, len--, obj_table++)
@@ -991,11 +1280,8 @@ __mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
 ring_dequeue:
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* get remaining objects from ring */
-	if (is_mc)
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, obj_table, n);
-	else
-		ret = rte_ring_sc_dequeue_bulk(mp->ring, obj_table, n);
+	/* get remaining objects from the common pool */
+	ret = ops->get(mp, obj_table, n, is_mc);
 
 	if (ret < 0)
 		__MEMPOOL_STAT_ADD(mp, get_fail, n);
@@ -1180,7 +1466,7 @@ rte_mempool_get(struct rte_mempool *mp, void **obj_p)
 unsigned rte_mempool_count(const struct rte_mempool *mp);
 
 /**
- * Return the number of free entries in the mempool ring.
+ * Return the number of free entries in the mempool.
  * i.e. how many entries can be freed back to the mempool.
  *
  * NOTE: This corresponds to the number of elements *allocated* from the
@@ -0,0 +1,156 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_memzone.h>
+#include <rte_spinlock.h>
+
+#include "rte_mempool.h"
+
+/*
+ * Stack pool handler: free objects are stored in a LIFO, so that the
+ * objects allocated first are the ones freed last, which are the most
+ * likely to still be in the cache of the CPU. This helps when objects
+ * are freed on other lcores than the ones allocating them, as these
+ * lcores keep emptying and filling their local caches from the common
+ * pool.
+ */
+
+/* "MPS_<name>", distinct from the "MP_<name>" memzone of the pool */
+#define MEMPOOL_STACK_MZ_FORMAT "MPS_%s"
+
+struct mempool_stack {
+	rte_spinlock_t sl;  /**< Protects len and objs. */
+	uint32_t size;      /**< Max number of objects. */
+	uint32_t len;       /**< Number of objects in the stack. */
+	void *objs[0] __rte_cache_aligned; /**< Stored objects. */
+};
+
+static int
+stack_alloc(struct rte_mempool *mp)
+{
+	char mz_name[RTE_MEMZONE_NAMESIZE];
+	const struct rte_memzone *mz;
+	struct mempool_stack *s;
+	size_t size;
+	int ret;
+
+	size = sizeof(*s) + mp->size * sizeof(s->objs[0]);
+	ret = snprintf(mz_name, sizeof(mz_name), MEMPOOL_STACK_MZ_FORMAT,
+		mp->name);
+	if (ret < 0 || ret >= (int)sizeof(mz_name))
+		return -ENAMETOOLONG;
+	mz = rte_memzone_reserve(mz_name, size, mp->socket_id, 0);
+	if (mz == NULL)
+		return -rte_errno;
+
+	s = mz->addr;
+	rte_spinlock_init(&s->sl);
+	s->size = mp->size;
+	s->len = 0;
+
+	mp->pool_data = s;
+	return 0;
+}
+
+static int
+stack_put(struct rte_mempool *mp, void * const *obj_table, unsigned n,
+	__rte_unused int is_mp)
+{
+	struct mempool_stack *s = mp->pool_data;
+	void **cache_objs;
+	unsigned index;
+
+	rte_spinlock_lock(&s->sl);
+
+	if (unlikely(s->len + n > s->size)) {
+		rte_spinlock_unlock(&s->sl);
+		return -ENOBUFS;
+	}
+
+	cache_objs = &s->objs[s->len];
+	for (index = 0; index < n; index++)
+		cache_objs[index] = obj_table[index];
+	s->len += n;
+
+	rte_spinlock_unlock(&s->sl);
+	return 0;
+}
+
+static int
+stack_get(struct rte_mempool *mp, void **obj_table, unsigned n,
+	__rte_unused int is_mc)
+{
+	struct mempool_stack *s = mp->pool_data;
+	void **cache_objs;
+	unsigned index, len;
+
+	rte_spinlock_lock(&s->sl);
+
+	if (unlikely(n > s->len)) {
+		rte_spinlock_unlock(&s->sl);
+		return -ENOENT;
+	}
+
+	/* pop the objects, the last one pushed first */
+	cache_objs = s->objs;
+	for (index = 0, len = s->len - 1; index < n; index++, len--)
+		obj_table[index] = cache_objs[len];
+	s->len -= n;
+
+	rte_spinlock_unlock(&s->sl);
+	return 0;
+}
+
+static unsigned
+stack_get_count(const struct rte_mempool *mp)
+{
+	const struct mempool_stack *s = mp->pool_data;
+
+	return s->len;
+}
+
+static struct rte_mempool_ops mempool_ops_stack = {
+	.name = "stack",
+	.alloc = stack_alloc,
+	.put = stack_put,
+	.get = stack_get,
+	.get_count = stack_get_count,
+};
+
+MEMPOOL_REGISTER_OPS(mempool_ops_stack);
@@ -48,6 +48,21 @@
 
 #define RTE_TABLE_INVALID                                 UINT32_MAX
 
+#ifdef RTE_PIPELINE_STATS_COLLECT
+
+#define RTE_PIPELINE_STATS_ADD(counter, val)	((counter) += (val))
+#define RTE_PIPELINE_STATS_ADD_M(counter, mask)	\
+	((counter) += __builtin_popcountll(mask))
+#define RTE_PIPELINE_STATS_TSC()		rte_rdtsc()
+
+#else
+
+#define RTE_PIPELINE_STATS_ADD(counter, val)	((void)(val))
+#define RTE_PIPELINE_STATS_ADD_M(counter, mask)	((void)(mask))
+#define RTE_PIPELINE_STATS_TSC()		0
+
+#endif
+
 struct rte_port_in {
 	/* Input parameters */
 	struct rte_port_in_ops ops;
@@ -63,6 +78,9 @@ struct rte_port_in {
 
 	/* List of enabled ports */
 	struct rte_port_in *next;
+
+	/* Statistics */
+	struct rte_pipeline_port_in_stats stats;
 };
 
 struct rte_port_out {
@@ -74,6 +92,9 @@ struct rte_port_out {
 
 	/* Handle to low-level port */
 	void *h_port;
+
+	/* Statistics */
+	struct rte_pipeline_port_out_stats stats;
 };
 
 struct rte_table {
@@ -90,6 +111,9 @@ struct rte_table {
 
 	/* Handle to the low-level table object */
 	void *h_table;
+
+	/* Statistics */
+	struct rte_pipeline_table_stats stats;
 };
 
 #define RTE_PIPELINE_MAX_NAME_SZ                           124
@@ -118,7 +142,10 @@ struct rte_pipeline {
 	struct rte_mbuf *pkts[RTE_PORT_IN_BURST_SIZE_MAX];
 	struct rte_pipeline_table_entry *entries[RTE_PORT_IN_BURST_SIZE_MAX];
 	uint64_t action_mask0[RTE_PIPELINE_ACTIONS];
-	uint64_t action_mask1[RTE_PIPELINE_ACTIONS];
+
+	/* Packets to be sent to each output port, written once per burst */
+	uint64_t port_out_pkts_mask[RTE_PIPELINE_PORT_OUT_MAX];
+	uint64_t port_out_mask;
 } __rte_cache_aligned;
 
 static inline uint32_t
@@ -378,6 +405,7 @@ rte_pipeline_table_create(struct rte_pipeline *p,
 	table->h_table = h_table;
 	table->table_next_id = 0;
 	table->table_next_id_valid = 0;
+	memset(&table->stats, 0, sizeof(table->stats));
 
 	return 0;
 }
@@ -574,6 +602,229 @@ rte_pipeline_table_entry_delete(struct rte_pipeline *p,
 	return (table->ops.f_delete)(table->h_table, key, key_found, entry);
 }
 
+int
+rte_pipeline_table_entry_add_bulk(struct rte_pipeline *p,
+		uint32_t table_id,
+		void **keys,
+		struct rte_pipeline_table_entry **entries,
+		uint32_t n_keys,
+		int *key_found,
+		struct rte_pipeline_table_entry **entries_ptr)
+{
+	struct rte_table *table;
+	uint32_t table_next_id, table_next_id_valid, i;
+	int status;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if ((keys == NULL) || (entries == NULL) || (key_found == NULL) ||
+		(entries_ptr == NULL)) {
+		RTE_LOG(ERR, PIPELINE, "%s: array parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table_id %d out of range\n", __func__, table_id);
+		return -EINVAL;
+	}
+
+	table = &p->tables[table_id];
+
+	if ((table->ops.f_add_bulk == NULL) && (table->ops.f_add == NULL)) {
+		RTE_LOG(ERR, PIPELINE, "%s: f_add function pointer NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	table_next_id = table->table_next_id;
+	table_next_id_valid = table->table_next_id_valid;
+
+	for (i = 0; i < n_keys; i++) {
+		struct rte_pipeline_table_entry *entry = entries[i];
+
+		if ((keys[i] == NULL) || (entry == NULL)) {
+			RTE_LOG(ERR, PIPELINE,
+				"%s: key or entry %u is NULL\n", __func__, i);
+			return -EINVAL;
+		}
+
+		if (entry->action != RTE_PIPELINE_ACTION_TABLE)
+			continue;
+
+		if (table_next_id_valid &&
+			(entry->table_id != table_next_id)) {
+			RTE_LOG(ERR, PIPELINE,
+				"%s: Tree-like topologies not allowed\n",
+				__func__);
+			return -EINVAL;
+		}
+
+		table_next_id = entry->table_id;
+		table_next_id_valid = 1;
+	}
+
+	/* Add entries */
+	table->table_next_id = table_next_id;
+	table->table_next_id_valid = table_next_id_valid;
+
+	if (table->ops.f_add_bulk != NULL)
+		return (table->ops.f_add_bulk)(table->h_table, keys,
+			(void **) entries, n_keys, key_found,
+			(void **) entries_ptr);
+
+	status = 0;
+	for (i = 0; i < n_keys; i++) {
+		int s = (table->ops.f_add)(table->h_table, keys[i],
+			(void *) entries[i], &key_found[i],
+			(void **) &entries_ptr[i]);
+
+		if (s != 0) {
+			key_found[i] = 0;
+			entries_ptr[i] = NULL;
+			if (status == 0)
+				status = s;
+		}
+	}
+
+	return status;
+}
+
+int
+rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
+		uint32_t table_id,
+		void **keys,
+		uint32_t n_keys,
+		int *key_found,
+		struct rte_pipeline_table_entry **entries)
+{
+	struct rte_table *table;
+	uint32_t i;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if ((keys == NULL) || (key_found == NULL)) {
+		RTE_LOG(ERR, PIPELINE, "%s: array parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table_id %d out of range\n", __func__, table_id);
+		return -EINVAL;
+	}
+
+	table = &p->tables[table_id];
+
+	if ((table->ops.f_delete_bulk == NULL) &&
+		(table->ops.f_delete == NULL)) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: f_delete function pointer NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	for (i = 0; i < n_keys; i++)
+		if (keys[i] == NULL) {
+			RTE_LOG(ERR, PIPELINE,
+				"%s: key %u is NULL\n", __func__, i);
+			return -EINVAL;
+		}
+
+	if (table->ops.f_delete_bulk != NULL)
+		return (table->ops.f_delete_bulk)(table->h_table, keys, n_keys,
+			key_found, (void **) entries);
+
+	for (i = 0; i < n_keys; i++) {
+		int status = (table->ops.f_delete)(table->h_table, keys[i],
+			&key_found[i], (entries != NULL) ? entries[i] : NULL);
+
+		if (status != 0)
+			return status;
+	}
+
+	return 0;
+}
+
+int
+rte_pipeline_table_age(struct rte_pipeline *p,
+		uint32_t table_id,
+		uint64_t expire_time,
+		uint32_t n_buckets,
+		int remove,
+		rte_table_age_report f_report,
+		void *arg)
+{
+	struct rte_table *table;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table_id %d out of range\n", __func__, table_id);
+		return -EINVAL;
+	}
+
+	table = &p->tables[table_id];
+
+	if (table->ops.f_age == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: f_age function pointer NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	return (table->ops.f_age)(table->h_table, expire_time, n_buckets,
+		remove, f_report, arg);
+}
+
+int
+rte_pipeline_table_stats_read(struct rte_pipeline *p,
+		uint32_t table_id,
+		struct rte_pipeline_table_stats *stats,
+		int clear)
+{
+	struct rte_table *table;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (table_id >= p->num_tables) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: table_id %d out of range\n", __func__, table_id);
+		return -EINVAL;
+	}
+
+	table = &p->tables[table_id];
+
+	if (stats != NULL)
+		memcpy(stats, &table->stats, sizeof(table->stats));
+
+	if (clear)
+		memset(&table->stats, 0, sizeof(table->stats));
+
+	return 0;
+}
+
 /*
  * Port
  *
@@ -743,6 +994,7 @@ rte_pipeline_port_in_create(struct rte_pipeline *p,
 	port->table_id = RTE_TABLE_INVALID;
 	port->h_port = h_port;
 	port->next = NULL;
+	memset(&port->stats, 0, sizeof(port->stats));
 
 	return 0;
 }
@@ -791,6 +1043,7 @@ rte_pipeline_port_out_create(struct rte_pipeline *p,
 
 	/* Initialize port internal data structure */
 	port->h_port = h_port;
+	memset(&port->stats, 0, sizeof(port->stats));
 
 	return 0;
 }
@@ -945,6 +1198,37 @@ rte_pipeline_port_in_disable(struct rte_pipeline *p, uint32_t port_id)
 	return 0;
 }
 
+int
+rte_pipeline_port_in_stats_read(struct rte_pipeline *p, uint32_t port_id,
+	struct rte_pipeline_port_in_stats *stats, int clear)
+{
+	struct rte_port_in *port;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (port_id >= p->num_ports_in) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: port IN ID %u is out of range\n",
+			__func__, port_id);
+		return -EINVAL;
+	}
+
+	port = &p->ports_in[port_id];
+
+	if (stats != NULL)
+		memcpy(stats, &port->stats, sizeof(port->stats));
+
+	if (clear)
+		memset(&port->stats, 0, sizeof(port->stats));
+
+	return 0;
+}
+
 /*
  * Pipeline run-time
  *
@@ -995,36 +1279,55 @@ rte_pipeline_check(struct rte_pipeline *p)
 }
 
 static inline void
-rte_pipeline_compute_masks(struct rte_pipeline *p, uint64_t pkts_mask)
+rte_pipeline_port_out_pkts_add(struct rte_pipeline *p, uint32_t port_id,
+	uint64_t pkts_mask)
 {
-	p->action_mask1[RTE_PIPELINE_ACTION_DROP] = 0;
-	p->action_mask1[RTE_PIPELINE_ACTION_PORT] = 0;
-	p->action_mask1[RTE_PIPELINE_ACTION_TABLE] = 0;
-
-	if ((pkts_mask & (pkts_mask + 1)) == 0) {
-		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
-		uint32_t i;
-
-		for (i = 0; i < n_pkts; i++) {
-			uint64_t pkt_mask = 1LLU << i;
-			uint32_t pos = p->entries[i]->action;
-
-			p->action_mask1[pos] |= pkt_mask;
-		}
-	} else {
-		uint32_t i;
-
-		for (i = 0; i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
-			uint64_t pkt_mask = 1LLU << i;
-			uint32_t pos;
-
-			if ((pkt_mask & pkts_mask) == 0)
-				continue;
+	p->port_out_pkts_mask[port_id] |= pkts_mask;
+	p->port_out_mask |= 1LLU << port_id;
+}
 
-			pos = p->entries[i]->action;
-			p->action_mask1[pos] |= pkt_mask;
+/*
+ * Resolve the reserved action of each lookup hit in a single pass. The action
+ * masks are accumulated in local variables rather than in the pipeline, so
+ * that each packet does not wait for the mask update of the previous one. The
+ * packets sent to an output port are grouped per port.
+ */
+static inline void
+rte_pipeline_compute_masks(struct rte_pipeline *p, uint64_t pkts_mask)
+{
+	uint64_t drop_mask = 0, port_meta_mask = 0, table_mask = 0;
+	uint64_t port_out_mask = 0;
+
+	for ( ; pkts_mask; pkts_mask &= pkts_mask - 1) {
+		uint32_t pos = __builtin_ctzll(pkts_mask);
+		uint64_t pkt_mask = 1LLU << pos;
+		struct rte_pipeline_table_entry *entry = p->entries[pos];
+
+		switch (entry->action) {
+		case RTE_PIPELINE_ACTION_PORT:
+			p->port_out_pkts_mask[entry->port_id] |= pkt_mask;
+			port_out_mask |= 1LLU << entry->port_id;
+			break;
+
+		case RTE_PIPELINE_ACTION_PORT_META:
+			port_meta_mask |= pkt_mask;
+			break;
+
+		case RTE_PIPELINE_ACTION_TABLE:
+			table_mask |= pkt_mask;
+			break;
+
+		case RTE_PIPELINE_ACTION_DROP:
+		default:
+			drop_mask |= pkt_mask;
+			break;
 		}
 	}
+
+	p->action_mask0[RTE_PIPELINE_ACTION_DROP] |= drop_mask;
+	p->action_mask0[RTE_PIPELINE_ACTION_PORT_META] |= port_meta_mask;
+	p->action_mask0[RTE_PIPELINE_ACTION_TABLE] |= table_mask;
+	p->port_out_mask |= port_out_mask;
 }
 
 static inline void
@@ -1032,6 +1335,9 @@ rte_pipeline_action_handler_port_bulk(struct rte_pipeline *p,
 		uint64_t pkts_mask, uint32_t port_id)
 {
 	struct rte_port_out *port_out = &p->ports_out[port_id];
+	uint64_t start = RTE_PIPELINE_STATS_TSC();
+
+	RTE_PIPELINE_STATS_ADD_M(port_out->stats.n_pkts_in, pkts_mask);
 
 	/* Output port user actions */
 	if (port_out->f_action_bulk != NULL) {
@@ -1039,146 +1345,45 @@ rte_pipeline_action_handler_port_bulk(struct rte_pipeline *p,
 
 		port_out->f_action_bulk(p->pkts, &pkts_mask, port_out->arg_ah);
 		p->action_mask0[RTE_PIPELINE_ACTION_DROP] |= pkts_mask ^  mask;
+		RTE_PIPELINE_STATS_ADD_M(port_out->stats.n_pkts_dropped_by_ah,
+			pkts_mask ^ mask);
 	}
 
 	/* Output port TX */
 	if (pkts_mask != 0)
 		port_out->ops.f_tx_bulk(port_out->h_port, p->pkts, pkts_mask);
+
+	RTE_PIPELINE_STATS_ADD(port_out->stats.n_cycles,
+		RTE_PIPELINE_STATS_TSC() - start);
 }
 
+/* Write each output port once with all the packets of the burst sent to it */
 static inline void
-rte_pipeline_action_handler_port(struct rte_pipeline *p, uint64_t pkts_mask)
+rte_pipeline_action_handler_port(struct rte_pipeline *p)
 {
-	if ((pkts_mask & (pkts_mask + 1)) == 0) {
-		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
-		uint32_t i;
+	uint64_t port_out_mask = p->port_out_mask;
 
-		for (i = 0; i < n_pkts; i++) {
-			struct rte_mbuf *pkt = p->pkts[i];
-			uint32_t port_out_id = p->entries[i]->port_id;
-			struct rte_port_out *port_out =
-				&p->ports_out[port_out_id];
-
-			/* Output port user actions */
-			if (port_out->f_action == NULL) /* Output port TX */
-				port_out->ops.f_tx(port_out->h_port, pkt);
-			else {
-				uint64_t pkt_mask = 1LLU;
-
-				port_out->f_action(pkt, &pkt_mask,
-					port_out->arg_ah);
-				p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
-					(pkt_mask ^ 1LLU) << i;
-
-				/* Output port TX */
-				if (pkt_mask != 0)
-					port_out->ops.f_tx(port_out->h_port,
-						pkt);
-			}
-		}
-	} else {
-		uint32_t i;
-
-		for (i = 0;  i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
-			uint64_t pkt_mask = 1LLU << i;
-			struct rte_mbuf *pkt;
-			struct rte_port_out *port_out;
-			uint32_t port_out_id;
-
-			if ((pkt_mask & pkts_mask) == 0)
-				continue;
+	for ( ; port_out_mask; port_out_mask &= port_out_mask - 1) {
+		uint32_t port_id = __builtin_ctzll(port_out_mask);
+		uint64_t pkts_mask = p->port_out_pkts_mask[port_id];
 
-			pkt = p->pkts[i];
-			port_out_id = p->entries[i]->port_id;
-			port_out = &p->ports_out[port_out_id];
-
-			/* Output port user actions */
-			if (port_out->f_action == NULL) /* Output port TX */
-				port_out->ops.f_tx(port_out->h_port, pkt);
-			else {
-				pkt_mask = 1LLU;
-
-				port_out->f_action(pkt, &pkt_mask,
-					port_out->arg_ah);
-				p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
-					(pkt_mask ^ 1LLU) << i;
-
-				/* Output port TX */
-				if (pkt_mask != 0)
-					port_out->ops.f_tx(port_out->h_port,
-						pkt);
-			}
-		}
+		p->port_out_pkts_mask[port_id] = 0;
+		rte_pipeline_action_handler_port_bulk(p, pkts_mask, port_id);
 	}
+
+	p->port_out_mask = 0;
 }
 
 static inline void
 rte_pipeline_action_handler_port_meta(struct rte_pipeline *p,
 	uint64_t pkts_mask)
 {
-	if ((pkts_mask & (pkts_mask + 1)) == 0) {
-		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
-		uint32_t i;
-
-		for (i = 0; i < n_pkts; i++) {
-			struct rte_mbuf *pkt = p->pkts[i];
-			uint32_t port_out_id =
-				RTE_MBUF_METADATA_UINT32(pkt,
-					p->offset_port_id);
-			struct rte_port_out *port_out = &p->ports_out[
-				port_out_id];
-
-			/* Output port user actions */
-			if (port_out->f_action == NULL) /* Output port TX */
-				port_out->ops.f_tx(port_out->h_port, pkt);
-			else {
-				uint64_t pkt_mask = 1LLU;
-
-				port_out->f_action(pkt, &pkt_mask,
-					port_out->arg_ah);
-				p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
-					(pkt_mask ^ 1LLU) << i;
-
-				/* Output port TX */
-				if (pkt_mask != 0)
-					port_out->ops.f_tx(port_out->h_port,
-						pkt);
-			}
-		}
-	} else {
-		uint32_t i;
-
-		for (i = 0;  i < RTE_PORT_IN_BURST_SIZE_MAX; i++) {
-			uint64_t pkt_mask = 1LLU << i;
-			struct rte_mbuf *pkt;
-			struct rte_port_out *port_out;
-			uint32_t port_out_id;
-
-			if ((pkt_mask & pkts_mask) == 0)
-				continue;
+	for ( ; pkts_mask; pkts_mask &= pkts_mask - 1) {
+		uint32_t pos = __builtin_ctzll(pkts_mask);
+		uint32_t port_out_id = RTE_MBUF_METADATA_UINT32(p->pkts[pos],
+			p->offset_port_id);
 
-			pkt = p->pkts[i];
-			port_out_id = RTE_MBUF_METADATA_UINT32(pkt,
-				p->offset_port_id);
-			port_out = &p->ports_out[port_out_id];
-
-			/* Output port user actions */
-			if (port_out->f_action == NULL) /* Output port TX */
-				port_out->ops.f_tx(port_out->h_port, pkt);
-			else {
-				pkt_mask = 1LLU;
-
-				port_out->f_action(pkt, &pkt_mask,
-					port_out->arg_ah);
-				p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
-					(pkt_mask ^ 1LLU) << i;
-
-				/* Output port TX */
-				if (pkt_mask != 0)
-					port_out->ops.f_tx(port_out->h_port,
-						pkt);
-			}
-		}
+		rte_pipeline_port_out_pkts_add(p, port_out_id, 1LLU << pos);
 	}
 }
 
@@ -1212,18 +1417,21 @@ rte_pipeline_run(struct rte_pipeline *p)
 
 	for (port_in = p->port_in_first; port_in != NULL;
 		port_in = port_in->next) {
-		uint64_t pkts_mask;
+		uint64_t pkts_mask, start;
 		uint32_t n_pkts, table_id;
 
 		/* Input port RX */
+		start = RTE_PIPELINE_STATS_TSC();
 		n_pkts = port_in->ops.f_rx(port_in->h_port, p->pkts,
 			port_in->burst_size);
 		if (n_pkts == 0)
 			continue;
 
+		RTE_PIPELINE_STATS_ADD(port_in->stats.n_pkts_in, n_pkts);
+
 		pkts_mask = RTE_LEN2MASK(n_pkts, uint64_t);
 		p->action_mask0[RTE_PIPELINE_ACTION_DROP] = 0;
-		p->action_mask0[RTE_PIPELINE_ACTION_PORT] = 0;
+		p->action_mask0[RTE_PIPELINE_ACTION_PORT_META] = 0;
 		p->action_mask0[RTE_PIPELINE_ACTION_TABLE] = 0;
 
 		/* Input port user actions */
@@ -1234,8 +1442,14 @@ rte_pipeline_run(struct rte_pipeline *p)
 				port_in->arg_ah);
 			p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
 				pkts_mask ^ mask;
+			RTE_PIPELINE_STATS_ADD_M(
+				port_in->stats.n_pkts_dropped_by_ah,
+				pkts_mask ^ mask);
 		}
 
+		RTE_PIPELINE_STATS_ADD(port_in->stats.n_cycles,
+			RTE_PIPELINE_STATS_TSC() - start);
+
 		/* Table */
 		for (table_id = port_in->table_id; pkts_mask != 0; ) {
 			struct rte_table *table;
@@ -1243,10 +1457,20 @@ rte_pipeline_run(struct rte_pipeline *p)
 
 			/* Lookup */
 			table = &p->tables[table_id];
+			start = RTE_PIPELINE_STATS_TSC();
 			table->ops.f_lookup(table->h_table, p->pkts, pkts_mask,
 					&lookup_hit_mask, (void **) p->entries);
 			lookup_miss_mask = pkts_mask & (~lookup_hit_mask);
 
+			RTE_PIPELINE_STATS_ADD_M(table->stats.n_pkts_in,
+				pkts_mask);
+			RTE_PIPELINE_STATS_ADD_M(
+				table->stats.n_pkts_lookup_hit,
+				lookup_hit_mask);
+			RTE_PIPELINE_STATS_ADD_M(
+				table->stats.n_pkts_lookup_miss,
+				lookup_miss_mask);
+
 			/* Lookup miss */
 			if (lookup_miss_mask != 0) {
 				struct rte_pipeline_table_entry *default_entry =
@@ -1262,19 +1486,23 @@ rte_pipeline_run(struct rte_pipeline *p)
 					p->action_mask0[
 						RTE_PIPELINE_ACTION_DROP] |=
 						lookup_miss_mask ^ mask;
+					RTE_PIPELINE_STATS_ADD_M(table->stats.
+					n_pkts_dropped_by_lookup_miss_ah,
+						lookup_miss_mask ^ mask);
 				}
 
 				/* Table reserved actions */
 				if ((default_entry->action ==
 					RTE_PIPELINE_ACTION_PORT) &&
 					(lookup_miss_mask != 0))
-					rte_pipeline_action_handler_port_bulk(p,
-						lookup_miss_mask,
-						default_entry->port_id);
+					rte_pipeline_port_out_pkts_add(p,
+						default_entry->port_id,
+						lookup_miss_mask);
 				else {
 					uint32_t pos = default_entry->action;
 
-					p->action_mask0[pos] = lookup_miss_mask;
+					p->action_mask0[pos] |=
+						lookup_miss_mask;
 				}
 			}
 
@@ -1290,35 +1518,31 @@ rte_pipeline_run(struct rte_pipeline *p)
 					p->action_mask0[
 						RTE_PIPELINE_ACTION_DROP] |=
 						lookup_hit_mask ^ mask;
+					RTE_PIPELINE_STATS_ADD_M(table->stats.
+					n_pkts_dropped_by_lookup_hit_ah,
+						lookup_hit_mask ^ mask);
 				}
 
 				/* Table reserved actions */
 				rte_pipeline_compute_masks(p, lookup_hit_mask);
-				p->action_mask0[RTE_PIPELINE_ACTION_DROP] |=
-					p->action_mask1[
-						RTE_PIPELINE_ACTION_DROP];
-				p->action_mask0[RTE_PIPELINE_ACTION_PORT] |=
-					p->action_mask1[
-						RTE_PIPELINE_ACTION_PORT];
-				p->action_mask0[RTE_PIPELINE_ACTION_TABLE] |=
-					p->action_mask1[
-						RTE_PIPELINE_ACTION_TABLE];
 			}
 
+			RTE_PIPELINE_STATS_ADD(table->stats.n_cycles,
+				RTE_PIPELINE_STATS_TSC() - start);
+
 			/* Prepare for next iteration */
 			pkts_mask = p->action_mask0[RTE_PIPELINE_ACTION_TABLE];
 			table_id = table->table_next_id;
 			p->action_mask0[RTE_PIPELINE_ACTION_TABLE] = 0;
 		}
 
-		/* Table reserved action PORT */
-		rte_pipeline_action_handler_port(p,
-				p->action_mask0[RTE_PIPELINE_ACTION_PORT]);
-
 		/* Table reserved action PORT META */
 		rte_pipeline_action_handler_port_meta(p,
 				p->action_mask0[RTE_PIPELINE_ACTION_PORT_META]);
 
+		/* Table reserved actions PORT and PORT META */
+		rte_pipeline_action_handler_port(p);
+
 		/* Table reserved action DROP */
 		rte_pipeline_action_handler_drop(p,
 				p->action_mask0[RTE_PIPELINE_ACTION_DROP]);
@@ -1354,6 +1578,9 @@ rte_pipeline_port_out_packet_insert(struct rte_pipeline *p,
 		uint32_t port_id, struct rte_mbuf *pkt)
 {
 	struct rte_port_out *port_out = &p->ports_out[port_id];
+	uint64_t start = RTE_PIPELINE_STATS_TSC();
+
+	RTE_PIPELINE_STATS_ADD(port_out->stats.n_pkts_in, 1);
 
 	/* Output port user actions */
 	if (port_out->f_action == NULL)
@@ -1365,9 +1592,46 @@ rte_pipeline_port_out_packet_insert(struct rte_pipeline *p,
 
 		if (pkt_mask != 0) /* Output port TX */
 			port_out->ops.f_tx(port_out->h_port, pkt);
-		else
+		else {
 			rte_pktmbuf_free(pkt);
+			RTE_PIPELINE_STATS_ADD(
+				port_out->stats.n_pkts_dropped_by_ah, 1);
+		}
 	}
 
+	RTE_PIPELINE_STATS_ADD(port_out->stats.n_cycles,
+		RTE_PIPELINE_STATS_TSC() - start);
+
+	return 0;
+}
+
+int
+rte_pipeline_port_out_stats_read(struct rte_pipeline *p, uint32_t port_id,
+	struct rte_pipeline_port_out_stats *stats, int clear)
+{
+	struct rte_port_out *port;
+
+	/* Check input arguments */
+	if (p == NULL) {
+		RTE_LOG(ERR, PIPELINE, "%s: pipeline parameter NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	if (port_id >= p->num_ports_out) {
+		RTE_LOG(ERR, PIPELINE,
+			"%s: port OUT ID %u is out of range\n",
+			__func__, port_id);
+		return -EINVAL;
+	}
+
+	port = &p->ports_out[port_id];
+
+	if (stats != NULL)
+		memcpy(stats, &port->stats, sizeof(port->stats));
+
+	if (clear)
+		memset(&port->stats, 0, sizeof(port->stats));
+
 	return 0;
 }
@@ -425,6 +425,150 @@ int rte_pipeline_table_entry_delete(struct rte_pipeline *p,
 	int *key_found,
 	struct rte_pipeline_table_entry *entry);
 
+/**
+ * Pipeline table entry add bulk
+ *
+ * The keys are handed over to the table in a single batch when the table
+ * type supports bulk add, otherwise they are added one by one.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @param keys
+ *   Array containing n_keys table entry keys
+ * @param entries
+ *   Array containing n_keys table entries, entries[i] provides the new
+ *   contents for the table entry identified by keys[i]
+ * @param n_keys
+ *   Number of keys to add
+ * @param key_found
+ *   Array of n_keys elements. After invocation, key_found[i] is set to TRUE
+ *   (value different than 0) if keys[i] was already present in the table
+ *   before the add operation and to FALSE (value 0) if not
+ * @param entries_ptr
+ *   Array of n_keys elements. After invocation, entries_ptr[i] points to the
+ *   table entry associated with keys[i] (see rte_pipeline_table_entry_add())
+ *   or is set to NULL when keys[i] could not be added
+ * @return
+ *   0 when all the keys were added, otherwise the error code of the first key
+ *   that could not be added. A failure on one key does not prevent the
+ *   remaining keys from being added.
+ */
+int rte_pipeline_table_entry_add_bulk(struct rte_pipeline *p,
+	uint32_t table_id,
+	void **keys,
+	struct rte_pipeline_table_entry **entries,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries_ptr);
+
+/**
+ * Pipeline table entry delete bulk
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @param keys
+ *   Array containing n_keys table entry keys
+ * @param n_keys
+ *   Number of keys to delete
+ * @param key_found
+ *   Array of n_keys elements. After invocation, key_found[i] is set to TRUE
+ *   (value different than 0) if keys[i] was found in the table before the
+ *   delete operation and to FALSE (value 0) if not
+ * @param entries
+ *   Either NULL or array of n_keys elements. When keys[i] is found in the
+ *   table and entries[i] points to a valid buffer, the table entry contents
+ *   (as it was before the delete was performed) is copied to this buffer
+ * @return
+ *   0 on success, error code otherwise
+ */
+int rte_pipeline_table_entry_delete_bulk(struct rte_pipeline *p,
+	uint32_t table_id,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	struct rte_pipeline_table_entry **entries);
+
+/**
+ * Pipeline table age
+ *
+ * Incremental aging scan of a table created with per-entry aging enabled. It
+ * is intended to be called periodically from the packet processing loop,
+ * between bursts, with a small number of buckets per call.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @param expire_time
+ *   Entries whose last lookup hit (or add) happened before this time stamp
+ *   (in CPU cycles, as returned by rte_rdtsc()) are expired
+ * @param n_buckets
+ *   Number of table buckets to scan, starting from where the previous scan
+ *   of the same table stopped
+ * @param remove
+ *   When different than 0, the expired entries are deleted from the table
+ * @param f_report
+ *   Either NULL or callback invoked for each expired entry, before its
+ *   deletion. The entry parameter points to the struct
+ *   rte_pipeline_table_entry stored in the table.
+ * @param arg
+ *   Opaque parameter passed to f_report
+ * @return
+ *   Number of expired entries on success, negative error code otherwise
+ */
+int rte_pipeline_table_age(struct rte_pipeline *p,
+	uint32_t table_id,
+	uint64_t expire_time,
+	uint32_t n_buckets,
+	int remove,
+	rte_table_age_report f_report,
+	void *arg);
+
+/** Pipeline table statistics. The counters are only updated when the
+pipeline library is built with CONFIG_RTE_PIPELINE_STATS_COLLECT enabled,
+otherwise they always read as zero. */
+struct rte_pipeline_table_stats {
+	/** Number of packets looked up in the table */
+	uint64_t n_pkts_in;
+	/** Number of packets that hit a table entry */
+	uint64_t n_pkts_lookup_hit;
+	/** Number of packets that missed and got the default entry */
+	uint64_t n_pkts_lookup_miss;
+	/** Number of packets dropped by the lookup hit action handler */
+	uint64_t n_pkts_dropped_by_lookup_hit_ah;
+	/** Number of packets dropped by the lookup miss action handler */
+	uint64_t n_pkts_dropped_by_lookup_miss_ah;
+	/** CPU cycles (TSC) spent on the lookup and the actions of the table */
+	uint64_t n_cycles;
+};
+
+/**
+ * Pipeline table statistics read
+ *
+ * The statistics are updated by rte_pipeline_run() without any
+ * synchronization, so when read from a different lcore the counters can be
+ * slightly behind and the increments racing with a clear can be lost.
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param table_id
+ *   Table ID (returned by previous invocation of pipeline table create)
+ * @param stats
+ *   Either NULL or location where the table statistics are copied
+ * @param clear
+ *   When different than 0, the table statistics are reset after being read
+ * @return
+ *   0 on success, error code otherwise
+ */
+int rte_pipeline_table_stats_read(struct rte_pipeline *p,
+	uint32_t table_id,
+	struct rte_pipeline_table_stats *stats,
+	int clear);
+
 /*
  * Port IN
  *
@@ -539,6 +683,40 @@ int rte_pipeline_port_in_enable(struct rte_pipeline *p,
 int rte_pipeline_port_in_disable(struct rte_pipeline *p,
 	uint32_t port_id);
 
+/** Pipeline input port statistics. The counters are only updated when the
+pipeline library is built with CONFIG_RTE_PIPELINE_STATS_COLLECT enabled,
+otherwise they always read as zero. */
+struct rte_pipeline_port_in_stats {
+	/** Number of packets read from the port */
+	uint64_t n_pkts_in;
+	/** Number of packets dropped by the port action handler */
+	uint64_t n_pkts_dropped_by_ah;
+	/** CPU cycles (TSC) spent on the RX and the actions of the port, for
+	the non-empty bursts only */
+	uint64_t n_cycles;
+};
+
+/**
+ * Pipeline input port statistics read
+ *
+ * Same synchronization rules as for rte_pipeline_table_stats_read().
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param port_id
+ *   Port ID (returned by previous invocation of pipeline input port create)
+ * @param stats
+ *   Either NULL or location where the port statistics are copied
+ * @param clear
+ *   When different than 0, the port statistics are reset after being read
+ * @return
+ *   0 on success, error code otherwise
+ */
+int rte_pipeline_port_in_stats_read(struct rte_pipeline *p,
+	uint32_t port_id,
+	struct rte_pipeline_port_in_stats *stats,
+	int clear);
+
 /*
  * Port OUT
  *
@@ -598,8 +776,9 @@ typedef int (*rte_pipeline_port_out_action_handler_bulk)(
 
 /** Parameters for pipeline output port creation. The action handlers have to
 be either both enabled or both disabled (by setting them to NULL). When
-enabled, the pipeline selects between them at different moments, based on the
-number of packets that have to be sent to the same output port. */
+enabled, the bulk action handler is invoked once per input burst with all the
+packets of the burst sent to this output port, while the single packet action
+handler is invoked for the packets inserted by the table action handlers. */
 struct rte_pipeline_port_out_params {
 	/** Output port operations (specific to each table type) */
 	struct rte_port_out_ops *ops;
@@ -657,6 +836,39 @@ int rte_pipeline_port_out_packet_insert(struct rte_pipeline *p,
 	uint32_t port_id,
 	struct rte_mbuf *pkt);
 
+/** Pipeline output port statistics. The counters are only updated when the
+pipeline library is built with CONFIG_RTE_PIPELINE_STATS_COLLECT enabled,
+otherwise they always read as zero. */
+struct rte_pipeline_port_out_stats {
+	/** Number of packets sent to the port, including the inserted ones */
+	uint64_t n_pkts_in;
+	/** Number of packets dropped by the port action handler */
+	uint64_t n_pkts_dropped_by_ah;
+	/** CPU cycles (TSC) spent on the actions and the TX of the port */
+	uint64_t n_cycles;
+};
+
+/**
+ * Pipeline output port statistics read
+ *
+ * Same synchronization rules as for rte_pipeline_table_stats_read().
+ *
+ * @param p
+ *   Handle to pipeline instance
+ * @param port_id
+ *   Port ID (returned by previous invocation of pipeline output port create)
+ * @param stats
+ *   Either NULL or location where the port statistics are copied
+ * @param clear
+ *   When different than 0, the port statistics are reset after being read
+ * @return
+ *   0 on success, error code otherwise
+ */
+int rte_pipeline_port_out_stats_read(struct rte_pipeline *p,
+	uint32_t port_id,
+	struct rte_pipeline_port_out_stats *stats,
+	int clear);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,281 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_log.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
+#include <rte_atomic.h>
+
+#include "rte_rcu_qsbr.h"
+
+/* Element of a defer queue. */
+struct rte_rcu_qsbr_dq_elem {
+	uint64_t token; /* Grace period started when the element was queued. */
+	uint32_t e;     /* Element handle. */
+};
+
+/* Defer queue. Elements are queued at tail and reclaimed from head. */
+struct rte_rcu_qsbr_dq {
+	char name[RTE_RCU_QSBR_DQ_NAMESIZE];
+	struct rte_rcu_qsbr *v;
+	uint32_t size;
+	uint32_t mask;
+	uint32_t head;
+	uint32_t tail;
+	uint32_t trigger_reclaim_limit;
+	uint32_t max_reclaim_size;
+	rte_rcu_qsbr_free_resource_t free_fn;
+	void *p;
+	struct rte_rcu_qsbr_dq_elem elems[0] __rte_cache_aligned;
+};
+
+size_t
+rte_rcu_qsbr_get_memsize(uint32_t max_threads)
+{
+	if (max_threads == 0 || max_threads > RTE_RCU_QSBR_MAX_THREADS)
+		return 0;
+
+	return RTE_ALIGN_CEIL(sizeof(struct rte_rcu_qsbr) +
+			sizeof(struct rte_rcu_qsbr_cnt) * max_threads +
+			sizeof(uint64_t) * RTE_QSBR_THRID_ARRAY_ELEMS(max_threads),
+			RTE_CACHE_LINE_SIZE);
+}
+
+int
+rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads)
+{
+	size_t sz;
+
+	sz = rte_rcu_qsbr_get_memsize(max_threads);
+	if (v == NULL || sz == 0)
+		return -EINVAL;
+
+	memset(v, 0, sz);
+	v->max_threads = max_threads;
+	v->num_elems = RTE_QSBR_THRID_ARRAY_ELEMS(max_threads);
+	v->token = RTE_QSBR_CNT_INIT;
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	volatile uint64_t *reg;
+	uint64_t bit, old;
+
+	if (v == NULL || thread_id >= v->max_threads)
+		return -EINVAL;
+
+	reg = &RTE_QSBR_THRID_ARRAY(v)[thread_id / 64];
+	bit = 1ULL << (thread_id % 64);
+
+	v->qsbr_cnt[thread_id].cnt = RTE_QSBR_CNT_THR_OFFLINE;
+
+	/* Writers may be scanning the bitmap, update it atomically. */
+	old = __sync_fetch_and_or(reg, bit);
+	if ((old & bit) == 0)
+		__sync_fetch_and_add(&v->num_threads, 1);
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	volatile uint64_t *reg;
+	uint64_t bit, old;
+
+	if (v == NULL || thread_id >= v->max_threads)
+		return -EINVAL;
+
+	reg = &RTE_QSBR_THRID_ARRAY(v)[thread_id / 64];
+	bit = 1ULL << (thread_id % 64);
+
+	old = __sync_fetch_and_and(reg, ~bit);
+	if ((old & bit) != 0)
+		__sync_fetch_and_sub(&v->num_threads, 1);
+
+	return 0;
+}
+
+void
+rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t;
+
+	/* A reader waiting for a grace period is itself quiescent. */
+	if (thread_id != RTE_QSBR_THRID_INVALID)
+		rte_rcu_qsbr_quiescent(v, thread_id);
+
+	t = rte_rcu_qsbr_start(v);
+	rte_rcu_qsbr_check(v, t, 1);
+}
+
+void
+rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v)
+{
+	volatile uint64_t *reg;
+	uint64_t bmap;
+	unsigned int i, id;
+
+	if (f == NULL || v == NULL)
+		return;
+
+	reg = RTE_QSBR_THRID_ARRAY(v);
+
+	fprintf(f, "QSBR variable <%p>\n", v);
+	fprintf(f, "  max_threads=%u\n", v->max_threads);
+	fprintf(f, "  num_threads=%u\n", v->num_threads);
+	fprintf(f, "  token=%"PRIu64"\n", v->token);
+	for (i = 0; i < v->num_elems; i++) {
+		bmap = reg[i];
+		while (bmap != 0) {
+			id = i * 64 + __builtin_ctzll(bmap);
+			fprintf(f, "  thread %u cnt=%"PRIu64"\n", id,
+					v->qsbr_cnt[id].cnt);
+			bmap &= bmap - 1;
+		}
+	}
+}
+
+struct rte_rcu_qsbr_dq *
+rte_rcu_qsbr_dq_create(const struct rte_rcu_qsbr_dq_parameters *params)
+{
+	struct rte_rcu_qsbr_dq *dq;
+	uint32_t qsize;
+
+	if (params == NULL || params->name == NULL || params->v == NULL ||
+			params->free_fn == NULL || params->size == 0 ||
+			params->size > (1U << 31) ||
+			params->trigger_reclaim_limit > params->size) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	qsize = rte_align32pow2(params->size);
+
+	dq = rte_zmalloc_socket(params->name, sizeof(*dq) +
+			(size_t)qsize * sizeof(dq->elems[0]),
+			RTE_CACHE_LINE_SIZE, params->socket_id);
+	if (dq == NULL) {
+		RTE_LOG(ERR, RCU, "Cannot allocate defer queue %s\n",
+				params->name);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+
+	snprintf(dq->name, sizeof(dq->name), "%s", params->name);
+	dq->v = params->v;
+	dq->size = params->size;
+	dq->mask = qsize - 1;
+	dq->trigger_reclaim_limit = params->trigger_reclaim_limit;
+	dq->max_reclaim_size = params->max_reclaim_size;
+	dq->free_fn = params->free_fn;
+	dq->p = params->p;
+
+	return dq;
+}
+
+int
+rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, uint32_t n,
+	uint32_t *freed, uint32_t *pending)
+{
+	struct rte_rcu_qsbr_dq_elem *elem;
+	uint32_t cnt = 0;
+
+	/* Tokens grow along the queue: stop at the first busy element. */
+	while (cnt < n && dq->head != dq->tail) {
+		elem = &dq->elems[dq->head & dq->mask];
+		if (rte_rcu_qsbr_check(dq->v, elem->token, 0) == 0)
+			break;
+		dq->free_fn(dq->p, elem->e);
+		dq->head++;
+		cnt++;
+	}
+
+	if (freed != NULL)
+		*freed = cnt;
+	if (pending != NULL)
+		*pending = dq->tail - dq->head;
+
+	return 0;
+}
+
+int
+rte_rcu_qsbr_dq_enqueue(struct rte_rcu_qsbr_dq *dq, uint32_t e)
+{
+	struct rte_rcu_qsbr_dq_elem *elem;
+
+	if (dq->tail - dq->head >= dq->trigger_reclaim_limit)
+		rte_rcu_qsbr_dq_reclaim(dq, dq->max_reclaim_size, NULL, NULL);
+
+	if (dq->tail - dq->head == dq->size) {
+		rte_rcu_qsbr_dq_reclaim(dq, dq->size, NULL, NULL);
+		if (dq->tail - dq->head == dq->size)
+			return -ENOSPC;
+	}
+
+	elem = &dq->elems[dq->tail & dq->mask];
+	elem->token = rte_rcu_qsbr_start(dq->v);
+	elem->e = e;
+	dq->tail++;
+
+	return 0;
+}
+
+void
+rte_rcu_qsbr_dq_delete(struct rte_rcu_qsbr_dq *dq)
+{
+	struct rte_rcu_qsbr_dq_elem *elem;
+
+	if (dq == NULL)
+		return;
+
+	while (dq->head != dq->tail) {
+		elem = &dq->elems[dq->head & dq->mask];
+		rte_rcu_qsbr_check(dq->v, elem->token, 1);
+		dq->free_fn(dq->p, elem->e);
+		dq->head++;
+	}
+
+	rte_free(dq);
+}
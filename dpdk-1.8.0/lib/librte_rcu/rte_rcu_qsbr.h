@@ -0,0 +1,441 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_RCU_QSBR_H_
+#define _RTE_RCU_QSBR_H_
+
+/**
+ * @file
+ * RTE Quiescent State Based Reclamation (QSBR)
+ *
+ * Lock-free data structures like the LPM tables are updated in place by a
+ * writer while reader threads keep looking them up. Memory unlinked by the
+ * writer (for example a tbl8 group) can only be reused once no reader can
+ * still hold a reference to it.
+ *
+ * With QSBR, every reader thread periodically reports a quiescent state,
+ * i.e. a point where it holds no reference to the shared data, typically
+ * once per iteration of its packet processing loop. The writer starts a
+ * grace period after unlinking an element and frees the element once all
+ * the registered readers have reported a quiescent state since then. The
+ * readers pay nothing per lookup: a quiescent state is a single store to a
+ * counter on a cache line owned by the reader.
+ *
+ * Reader side:
+ *   rte_rcu_qsbr_thread_register(v, id);
+ *   rte_rcu_qsbr_thread_online(v, id);
+ *   while (1) {
+ *       ... lookups ...
+ *       rte_rcu_qsbr_quiescent(v, id);
+ *   }
+ *   rte_rcu_qsbr_thread_offline(v, id);
+ *   rte_rcu_qsbr_thread_unregister(v, id);
+ *
+ * Writer side, either blocking:
+ *   ... unlink element ...
+ *   rte_rcu_qsbr_synchronize(v, RTE_QSBR_THRID_INVALID);
+ *   ... free element ...
+ *
+ * or deferred, with a defer queue (rte_rcu_qsbr_dq_create()) that frees
+ * the elements whose grace period has elapsed.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_atomic.h>
+
+/** Maximum number of reader threads of a QSBR variable. */
+#define RTE_RCU_QSBR_MAX_THREADS 1024
+
+/** Thread ID to pass when the caller is not a registered reader. */
+#define RTE_QSBR_THRID_INVALID 0xffffffff
+
+/** Counter value of a thread that is offline. */
+#define RTE_QSBR_CNT_THR_OFFLINE 0
+
+/** Initial value of the grace period token. */
+#define RTE_QSBR_CNT_INIT 1
+
+/** Length of name for a defer queue. */
+#define RTE_RCU_QSBR_DQ_NAMESIZE 32
+
+/** @internal Number of 64-bit words of the registered thread bitmap. */
+#define RTE_QSBR_THRID_ARRAY_ELEMS(max_threads) \
+	(((max_threads) + 63) / 64)
+
+/** @internal Per thread quiescent state counter, one per cache line. */
+struct rte_rcu_qsbr_cnt {
+	volatile uint64_t cnt;
+	/**< Last token seen by the thread, RTE_QSBR_CNT_THR_OFFLINE if offline. */
+} __rte_cache_aligned;
+
+/**
+ * @internal QSBR variable. The counters are followed by the bitmap of the
+ * registered threads.
+ */
+struct rte_rcu_qsbr {
+	volatile uint64_t token __rte_cache_aligned;
+	/**< Counter of the grace periods started by the writers. */
+	uint32_t max_threads;  /**< Maximum number of reader threads. */
+	uint32_t num_elems;    /**< Number of words of the thread bitmap. */
+	volatile uint32_t num_threads; /**< Number of registered threads. */
+
+	struct rte_rcu_qsbr_cnt qsbr_cnt[0] __rte_cache_aligned;
+	/**< Quiescent state counter of each thread. */
+};
+
+/** @internal Registered thread bitmap of a QSBR variable. */
+#define RTE_QSBR_THRID_ARRAY(v) \
+	((volatile uint64_t *)&(v)->qsbr_cnt[(v)->max_threads])
+
+/**
+ * Return the size of the memory needed by a QSBR variable.
+ *
+ * @param max_threads
+ *   Maximum number of reader threads using the variable.
+ * @return
+ *   The size in bytes, or 0 if max_threads is 0 or larger than
+ *   RTE_RCU_QSBR_MAX_THREADS.
+ */
+size_t
+rte_rcu_qsbr_get_memsize(uint32_t max_threads);
+
+/**
+ * Initialize a QSBR variable.
+ *
+ * The memory pointed to by v must be cache line aligned and at least
+ * rte_rcu_qsbr_get_memsize(max_threads) bytes long. It can be shared
+ * between processes.
+ *
+ * @param v
+ *   QSBR variable to initialize.
+ * @param max_threads
+ *   Maximum number of reader threads using the variable.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ */
+int
+rte_rcu_qsbr_init(struct rte_rcu_qsbr *v, uint32_t max_threads);
+
+/**
+ * Register a reader thread to report its quiescent states.
+ *
+ * A registered thread is offline until rte_rcu_qsbr_thread_online() is
+ * called. Can be called by any thread, but not concurrently with
+ * rte_rcu_qsbr_thread_unregister() for the same thread_id.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread ID, lower than the max_threads of the variable. The
+ *   lcore ID is a natural choice.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ */
+int
+rte_rcu_qsbr_thread_register(struct rte_rcu_qsbr *v, unsigned int thread_id);
+
+/**
+ * Unregister a reader thread. The writers no longer wait for it.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread ID.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid parameters.
+ */
+int
+rte_rcu_qsbr_thread_unregister(struct rte_rcu_qsbr *v, unsigned int thread_id);
+
+/**
+ * Mark a registered reader thread online: from now on the writers wait
+ * for it to report a quiescent state. Must be called before the thread
+ * accesses the shared data structures.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread ID.
+ */
+static inline void
+rte_rcu_qsbr_thread_online(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	v->qsbr_cnt[thread_id].cnt = v->token;
+
+	/*
+	 * The store must be visible to the writers before the thread loads
+	 * any pointer from the shared data structures.
+	 */
+	rte_mb();
+}
+
+/**
+ * Mark a reader thread offline, e.g. before it blocks for a long time.
+ * The writers do not wait for an offline thread. The thread must not
+ * hold any reference to the shared data structures.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread ID.
+ */
+static inline void
+rte_rcu_qsbr_thread_offline(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	/* Complete the loads of the shared data before going offline. */
+	rte_mb();
+
+	v->qsbr_cnt[thread_id].cnt = RTE_QSBR_CNT_THR_OFFLINE;
+}
+
+/**
+ * Report a quiescent state: the calling reader thread holds no reference
+ * to the shared data structures. This is meant to be called once per
+ * iteration of the thread's main loop.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   Reader thread ID, which must be online.
+ */
+static inline void
+rte_rcu_qsbr_quiescent(struct rte_rcu_qsbr *v, unsigned int thread_id)
+{
+	uint64_t t = v->token;
+
+	/*
+	 * The loads of the shared data must complete before the counter is
+	 * updated. x86 does not reorder loads with later stores, so only the
+	 * compiler needs to be held back.
+	 */
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686) || \
+	defined(RTE_ARCH_X86_64_32)
+	rte_compiler_barrier();
+#else
+	rte_mb();
+#endif
+
+	v->qsbr_cnt[thread_id].cnt = t;
+}
+
+/**
+ * Start a grace period. Called by a writer after it unlinked elements
+ * from the shared data structures.
+ *
+ * @param v
+ *   QSBR variable.
+ * @return
+ *   Token of the grace period, to pass to rte_rcu_qsbr_check().
+ */
+static inline uint64_t
+rte_rcu_qsbr_start(struct rte_rcu_qsbr *v)
+{
+	/* Full barrier: the unlinking stores happen before the new token. */
+	return __sync_add_and_fetch(&v->token, 1);
+}
+
+/**
+ * Check whether a grace period has elapsed, i.e. whether every registered
+ * and online reader thread reported a quiescent state after the grace
+ * period was started.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param t
+ *   Token returned by rte_rcu_qsbr_start().
+ * @param wait
+ *   If non-zero, wait for the grace period to elapse.
+ * @return
+ *   - 1: The grace period has elapsed, elements unlinked before
+ *     rte_rcu_qsbr_start() can be freed.
+ *   - 0: Some readers may still reference them (only if wait is 0).
+ */
+static inline int
+rte_rcu_qsbr_check(struct rte_rcu_qsbr *v, uint64_t t, int wait)
+{
+	volatile uint64_t *reg = RTE_QSBR_THRID_ARRAY(v);
+	uint64_t bmap, c;
+	unsigned int i, id;
+
+	for (i = 0; i < v->num_elems; i++) {
+		bmap = reg[i];
+		while (bmap != 0) {
+			id = i * 64 + __builtin_ctzll(bmap);
+			c = v->qsbr_cnt[id].cnt;
+			if (c != RTE_QSBR_CNT_THR_OFFLINE && c < t) {
+				if (wait == 0)
+					return 0;
+				rte_pause();
+				/* The thread may have unregistered meanwhile. */
+				bmap &= reg[i];
+				continue;
+			}
+			bmap &= bmap - 1;
+		}
+	}
+
+	/* The frees must not be done before the counters were read. */
+	rte_mb();
+
+	return 1;
+}
+
+/**
+ * Wait for a grace period to elapse: start one and wait for all readers
+ * to go through a quiescent state.
+ *
+ * @param v
+ *   QSBR variable.
+ * @param thread_id
+ *   If the caller is itself a registered reader thread, its ID: it reports
+ *   a quiescent state first instead of deadlocking on itself. Otherwise
+ *   RTE_QSBR_THRID_INVALID.
+ */
+void
+rte_rcu_qsbr_synchronize(struct rte_rcu_qsbr *v, unsigned int thread_id);
+
+/**
+ * Dump the state of a QSBR variable.
+ *
+ * @param f
+ *   A pointer to a file for output.
+ * @param v
+ *   QSBR variable.
+ */
+void
+rte_rcu_qsbr_dump(FILE *f, struct rte_rcu_qsbr *v);
+
+/*
+ * Defer queue
+ *
+ * Elements unlinked by a writer are queued along with the token of a grace
+ * period started at that time. They are handed back to a user function once
+ * the grace period elapsed, either when the queue fills up or when the
+ * writer explicitly asks for a reclaim. Elements are 32-bit handles, e.g.
+ * indexes into a table. A defer queue is not multi-thread safe on the
+ * writer side; the writers of a data structure are expected to already be
+ * serialized.
+ */
+
+/** Function called to free an element after its grace period. */
+typedef void (*rte_rcu_qsbr_free_resource_t)(void *p, uint32_t e);
+
+struct rte_rcu_qsbr_dq;
+
+/** Parameters of a defer queue. */
+struct rte_rcu_qsbr_dq_parameters {
+	const char *name;        /**< Name of the defer queue. */
+	int socket_id;           /**< NUMA socket of the queue memory. */
+	uint32_t size;           /**< Maximum number of queued elements. */
+	uint32_t trigger_reclaim_limit;
+	/**< Reclaim when at least this many elements are queued. */
+	uint32_t max_reclaim_size;
+	/**< Maximum number of elements reclaimed by an enqueue. */
+	rte_rcu_qsbr_free_resource_t free_fn; /**< Element free function. */
+	void *p;                 /**< Argument passed to free_fn. */
+	struct rte_rcu_qsbr *v;  /**< QSBR variable of the readers. */
+};
+
+/**
+ * Create a defer queue.
+ *
+ * @param params
+ *   Parameters of the defer queue.
+ * @return
+ *   The defer queue, or NULL on error with rte_errno set:
+ *    - EINVAL - invalid parameters
+ *    - ENOMEM - no appropriate memory area found
+ */
+struct rte_rcu_qsbr_dq *
+rte_rcu_qsbr_dq_create(const struct rte_rcu_qsbr_dq_parameters *params);
+
+/**
+ * Queue an element unlinked from the shared data structure. Elements whose
+ * grace period elapsed are reclaimed first if the queue holds at least
+ * trigger_reclaim_limit elements.
+ *
+ * @param dq
+ *   Defer queue.
+ * @param e
+ *   Element to free after the grace period.
+ * @return
+ *   - 0: Success.
+ *   - -ENOSPC: The queue is full and no element could be reclaimed.
+ */
+int
+rte_rcu_qsbr_dq_enqueue(struct rte_rcu_qsbr_dq *dq, uint32_t e);
+
+/**
+ * Free the queued elements whose grace period has elapsed, without
+ * waiting for the readers.
+ *
+ * @param dq
+ *   Defer queue.
+ * @param n
+ *   Maximum number of elements to free.
+ * @param freed
+ *   If not NULL, returns the number of elements freed.
+ * @param pending
+ *   If not NULL, returns the number of elements still queued.
+ * @return
+ *   0
+ */
+int
+rte_rcu_qsbr_dq_reclaim(struct rte_rcu_qsbr_dq *dq, uint32_t n,
+	uint32_t *freed, uint32_t *pending);
+
+/**
+ * Wait for the grace period of all the queued elements, free them and
+ * free the defer queue.
+ *
+ * @param dq
+ *   Defer queue, may be NULL.
+ */
+void
+rte_rcu_qsbr_dq_delete(struct rte_rcu_qsbr_dq *dq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _RTE_RCU_QSBR_H_ */
@@ -95,12 +95,20 @@ TAILQ_HEAD(rte_ring_list, rte_tailq_entry);
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
 
-/* return the size of memory occupied by a ring */
+/* return the size of memory occupied by a ring of esize-byte elements */
 ssize_t
-rte_ring_get_memsize(unsigned count)
+rte_ring_get_memsize_elem(unsigned esize, unsigned count)
 {
 	ssize_t sz;
 
+	/* element size must be a non-zero multiple of 4 bytes */
+	if (esize == 0 || (esize & 3) != 0 || esize > RTE_RING_ELEM_MAX_SIZE) {
+		RTE_LOG(ERR, RING,
+			"Requested element size is invalid, must be a multiple "
+			"of 4 and do not exceed %u\n", RTE_RING_ELEM_MAX_SIZE);
+		return -EINVAL;
+	}
+
 	/* count must be a power of 2 */
 	if ((!POWEROF2(count)) || (count > RTE_RING_SZ_MASK )) {
 		RTE_LOG(ERR, RING,
@@ -109,14 +117,61 @@ rte_ring_get_memsize(unsigned count)
 		return -EINVAL;
 	}
 
-	sz = sizeof(struct rte_ring) + count * sizeof(void *);
+	sz = sizeof(struct rte_ring) + (ssize_t)count * esize;
 	sz = RTE_ALIGN(sz, RTE_CACHE_LINE_SIZE);
 	return sz;
 }
 
+/* return the size of memory occupied by a ring */
+ssize_t
+rte_ring_get_memsize(unsigned count)
+{
+	return rte_ring_get_memsize_elem(sizeof(void *), count);
+}
+
+/*
+ * get the enqueue or dequeue sync mode from the ring flags, -EINVAL if
+ * several modes are requested
+ */
+static int
+get_sync_type(unsigned flags, unsigned st_flag, unsigned rts_flag,
+	unsigned hts_flag)
+{
+	switch (flags & (st_flag | rts_flag | hts_flag)) {
+	case 0:
+		return RTE_RING_SYNC_MT;
+	case RING_F_SP_ENQ:
+	case RING_F_SC_DEQ:
+		return RTE_RING_SYNC_ST;
+	case RING_F_MP_RTS_ENQ:
+	case RING_F_MC_RTS_DEQ:
+		return RTE_RING_SYNC_MT_RTS;
+	case RING_F_MP_HTS_ENQ:
+	case RING_F_MC_HTS_DEQ:
+		return RTE_RING_SYNC_MT_HTS;
+	default:
+		return -EINVAL;
+	}
+}
+
+/* check that the flags request at most one mode for each side */
+static int
+check_flags(unsigned flags)
+{
+	if (get_sync_type(flags, RING_F_SP_ENQ, RING_F_MP_RTS_ENQ,
+			RING_F_MP_HTS_ENQ) < 0 ||
+			get_sync_type(flags, RING_F_SC_DEQ, RING_F_MC_RTS_DEQ,
+			RING_F_MC_HTS_DEQ) < 0) {
+		RTE_LOG(ERR, RING, "Requested ring flags are invalid, "
+			"at most one enqueue and one dequeue mode can be set\n");
+		return -EINVAL;
+	}
+	return 0;
+}
+
 int
-rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
-	unsigned flags)
+rte_ring_init_elem(struct rte_ring *r, const char *name, unsigned esize,
+	unsigned count, unsigned flags)
 {
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(struct rte_ring) &
@@ -127,6 +182,11 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 #endif
 	RTE_BUILD_BUG_ON((offsetof(struct rte_ring, prod) &
 			  RTE_CACHE_LINE_MASK) != 0);
+	/* head/tail and their counter are updated with 64-bit atomics */
+	RTE_BUILD_BUG_ON((offsetof(struct rte_ring, prod.head_raw) &
+			  (sizeof(uint64_t) - 1)) != 0);
+	RTE_BUILD_BUG_ON((offsetof(struct rte_ring, cons.head_raw) &
+			  (sizeof(uint64_t) - 1)) != 0);
 #ifdef RTE_LIBRTE_RING_DEBUG
 	RTE_BUILD_BUG_ON((sizeof(struct rte_ring_debug_stats) &
 			  RTE_CACHE_LINE_MASK) != 0);
@@ -134,13 +194,22 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 			  RTE_CACHE_LINE_MASK) != 0);
 #endif
 
+	if (check_flags(flags) < 0)
+		return -EINVAL;
+
 	/* init the ring structure */
 	memset(r, 0, sizeof(*r));
 	snprintf(r->name, sizeof(r->name), "%s", name);
 	r->flags = flags;
+	r->esize = esize;
 	r->prod.watermark = count;
 	r->prod.sp_enqueue = !!(flags & RING_F_SP_ENQ);
 	r->cons.sc_dequeue = !!(flags & RING_F_SC_DEQ);
+	r->prod.sync_type = get_sync_type(flags, RING_F_SP_ENQ,
+			RING_F_MP_RTS_ENQ, RING_F_MP_HTS_ENQ);
+	r->cons.sync_type = get_sync_type(flags, RING_F_SC_DEQ,
+			RING_F_MC_RTS_DEQ, RING_F_MC_HTS_DEQ);
+	r->prod.htd_max = r->cons.htd_max = count / 8;
 	r->prod.size = r->cons.size = count;
 	r->prod.mask = r->cons.mask = count-1;
 	r->prod.head = r->cons.head = 0;
@@ -149,10 +218,17 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 	return 0;
 }
 
+int
+rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
+	unsigned flags)
+{
+	return rte_ring_init_elem(r, name, sizeof(void *), count, flags);
+}
+
 /* create the ring */
 struct rte_ring *
-rte_ring_create(const char *name, unsigned count, int socket_id,
-		unsigned flags)
+rte_ring_create_elem(const char *name, unsigned esize, unsigned count,
+		int socket_id, unsigned flags)
 {
 	char mz_name[RTE_MEMZONE_NAMESIZE];
 	struct rte_ring *r;
@@ -169,12 +245,17 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 		return NULL;
 	}
 
-	ring_size = rte_ring_get_memsize(count);
+	ring_size = rte_ring_get_memsize_elem(esize, count);
 	if (ring_size < 0) {
 		rte_errno = ring_size;
 		return NULL;
 	}
 
+	if (check_flags(flags) < 0) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
 	te = rte_zmalloc("RING_TAILQ_ENTRY", sizeof(*te), 0);
 	if (te == NULL) {
 		RTE_LOG(ERR, RING, "Cannot reserve memory for tailq\n");
@@ -194,7 +275,7 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 		r = mz->addr;
 		/* no need to check return value here, we already checked the
 		 * arguments above */
-		rte_ring_init(r, name, count, flags);
+		rte_ring_init_elem(r, name, esize, count, flags);
 
 		te->data = (void *) r;
 
@@ -209,6 +290,15 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 	return r;
 }
 
+/* create a ring of pointers */
+struct rte_ring *
+rte_ring_create(const char *name, unsigned count, int socket_id,
+		unsigned flags)
+{
+	return rte_ring_create_elem(name, sizeof(void *), count, socket_id,
+			flags);
+}
+
 /*
  * change the high water mark. If *count* is 0, water marking is
  * disabled
@@ -227,6 +317,32 @@ rte_ring_set_water_mark(struct rte_ring *r, unsigned count)
 	return 0;
 }
 
+/* change the maximum producer head/tail distance of a RTS ring */
+int
+rte_ring_set_prod_htd_max(struct rte_ring *r, unsigned v)
+{
+	if (r->prod.sync_type != RTE_RING_SYNC_MT_RTS)
+		return -ENOTSUP;
+	if (v >= r->prod.size)
+		return -EINVAL;
+
+	r->prod.htd_max = v;
+	return 0;
+}
+
+/* change the maximum consumer head/tail distance of a RTS ring */
+int
+rte_ring_set_cons_htd_max(struct rte_ring *r, unsigned v)
+{
+	if (r->cons.sync_type != RTE_RING_SYNC_MT_RTS)
+		return -ENOTSUP;
+	if (v >= r->cons.size)
+		return -EINVAL;
+
+	r->cons.htd_max = v;
+	return 0;
+}
+
 /* dump the status of the ring on the console */
 void
 rte_ring_dump(FILE *f, const struct rte_ring *r)
@@ -239,10 +355,17 @@ rte_ring_dump(FILE *f, const struct rte_ring *r)
 	fprintf(f, "ring <%s>@%p\n", r->name, r);
 	fprintf(f, "  flags=%x\n", r->flags);
 	fprintf(f, "  size=%"PRIu32"\n", r->prod.size);
+	fprintf(f, "  esize=%"PRIu32"\n", r->esize);
 	fprintf(f, "  ct=%"PRIu32"\n", r->cons.tail);
 	fprintf(f, "  ch=%"PRIu32"\n", r->cons.head);
 	fprintf(f, "  pt=%"PRIu32"\n", r->prod.tail);
 	fprintf(f, "  ph=%"PRIu32"\n", r->prod.head);
+	fprintf(f, "  prod_sync=%"PRIu32"\n", r->prod.sync_type);
+	fprintf(f, "  cons_sync=%"PRIu32"\n", r->cons.sync_type);
+	if (r->prod.sync_type == RTE_RING_SYNC_MT_RTS)
+		fprintf(f, "  prod_htd_max=%"PRIu32"\n", r->prod.htd_max);
+	if (r->cons.sync_type == RTE_RING_SYNC_MT_RTS)
+		fprintf(f, "  cons_htd_max=%"PRIu32"\n", r->cons.htd_max);
 	fprintf(f, "  used=%u\n", rte_ring_count(r));
 	fprintf(f, "  avail=%u\n", rte_ring_free_count(r));
 	if (r->prod.watermark == r->prod.size)
@@ -79,8 +79,13 @@
  * - Lockless implementation.
  * - Multi- or single-consumer dequeue.
  * - Multi- or single-producer enqueue.
+ * - Optional head/tail sync (HTS) or relaxed tail sync (RTS) modes for
+ *   multi-producer/consumer rings.
  * - Bulk dequeue.
  * - Bulk enqueue.
+ * - Fixed-size elements other than pointers, copied inline in the ring.
+ * - Zero-copy enqueue/dequeue in the ring slots (single producer /
+ *   single consumer only).
  *
  * Note: the ring implementation is not preemptable. A lcore must not
  * be interrupted by another task that uses the same ring.
@@ -106,6 +111,29 @@ enum rte_ring_queue_behavior {
 	RTE_RING_QUEUE_VARIABLE   /* Enq/Deq as many items a possible from ring */
 };
 
+/**
+ * Synchronization mode of the producers or of the consumers of a ring.
+ *
+ * In the default multi-thread mode, a thread that has moved the head waits
+ * for all the threads that moved it before to update the tail. If one of
+ * them is preempted, all others spin until it is scheduled again. The
+ * other modes are meant for overcommitted systems:
+ *
+ * - RTS (relaxed tail sync): the tail is only moved by the last thread
+ *   completing its operation, so that no thread waits for another one to
+ *   finish. The head can go ahead of the tail by at most *htd_max*
+ *   entries.
+ * - HTS (head/tail sync): a thread only moves the head when no other
+ *   operation is in progress, so that at most one thread is between the
+ *   head and the tail update at a time.
+ */
+enum rte_ring_sync_type {
+	RTE_RING_SYNC_MT = 0,     /**< Multi-thread safe (default mode). */
+	RTE_RING_SYNC_ST,         /**< Single thread only. */
+	RTE_RING_SYNC_MT_RTS,     /**< Multi-thread safe, relaxed tail sync. */
+	RTE_RING_SYNC_MT_HTS,     /**< Multi-thread safe, head/tail sync. */
+};
+
 #ifdef RTE_LIBRTE_RING_DEBUG
 /**
  * A structure that stores the ring statistics (per-lcore).
@@ -125,6 +153,7 @@ struct rte_ring_debug_stats {
 #endif
 
 #define RTE_RING_NAMESIZE 32 /**< The maximum length of a ring name. */
+#define RTE_RING_ELEM_MAX_SIZE 256 /**< The maximum size of a ring element. */
 #define RTE_RING_MZ_PREFIX "RG_"
 
 /**
@@ -136,10 +165,14 @@ struct rte_ring_debug_stats {
  * field. Thanks to this assumption, we can do subtractions between 2 index
  * values in a modulo-32bit base: that's why the overflow of the indexes is not
  * a problem.
+ *
+ * The ring[] table stores *esize*-byte elements. For rings created with
+ * rte_ring_create(), the elements are object pointers (void *).
  */
 struct rte_ring {
 	char name[RTE_RING_NAMESIZE];    /**< Name of the ring. */
 	int flags;                       /**< Flags supplied at creation. */
+	uint32_t esize;                  /**< Size of an element, in bytes. */
 
 	/** Ring producer status. */
 	struct prod {
@@ -147,8 +180,22 @@ struct rte_ring {
 		uint32_t sp_enqueue;     /**< True, if single producer. */
 		uint32_t size;           /**< Size of ring. */
 		uint32_t mask;           /**< Mask (size-1) of ring. */
-		volatile uint32_t head;  /**< Producer head. */
-		volatile uint32_t tail;  /**< Producer tail. */
+		union {
+			volatile uint64_t head_raw; /**< Head and counter. */
+			struct {
+				volatile uint32_t head;  /**< Producer head. */
+				volatile uint32_t head_cnt; /**< Started ops (RTS). */
+			};
+		};
+		union {
+			volatile uint64_t tail_raw; /**< Tail and counter. */
+			struct {
+				volatile uint32_t tail;  /**< Producer tail. */
+				volatile uint32_t tail_cnt; /**< Completed ops (RTS). */
+			};
+		};
+		uint32_t sync_type;      /**< Enqueue mode (rte_ring_sync_type). */
+		uint32_t htd_max;        /**< Max head/tail distance (RTS). */
 	} prod __rte_cache_aligned;
 
 	/** Ring consumer status. */
@@ -156,8 +203,22 @@ struct rte_ring {
 		uint32_t sc_dequeue;     /**< True, if single consumer. */
 		uint32_t size;           /**< Size of the ring. */
 		uint32_t mask;           /**< Mask (size-1) of ring. */
-		volatile uint32_t head;  /**< Consumer head. */
-		volatile uint32_t tail;  /**< Consumer tail. */
+		uint32_t sync_type;      /**< Dequeue mode (rte_ring_sync_type). */
+		union {
+			volatile uint64_t head_raw; /**< Head and counter. */
+			struct {
+				volatile uint32_t head;  /**< Consumer head. */
+				volatile uint32_t head_cnt; /**< Started ops (RTS). */
+			};
+		};
+		union {
+			volatile uint64_t tail_raw; /**< Tail and counter. */
+			struct {
+				volatile uint32_t tail;  /**< Consumer tail. */
+				volatile uint32_t tail_cnt; /**< Completed ops (RTS). */
+			};
+		};
+		uint32_t htd_max;        /**< Max head/tail distance (RTS). */
 #ifdef RTE_RING_SPLIT_PROD_CONS
 	} cons __rte_cache_aligned;
 #else
@@ -175,6 +236,10 @@ struct rte_ring {
 
 #define RING_F_SP_ENQ 0x0001 /**< The default enqueue is "single-producer". */
 #define RING_F_SC_DEQ 0x0002 /**< The default dequeue is "single-consumer". */
+#define RING_F_MP_RTS_ENQ 0x0008 /**< The default enqueue is "MP RTS". */
+#define RING_F_MC_RTS_DEQ 0x0010 /**< The default dequeue is "MC RTS". */
+#define RING_F_MP_HTS_ENQ 0x0020 /**< The default enqueue is "MP HTS". */
+#define RING_F_MC_HTS_DEQ 0x0040 /**< The default dequeue is "MC HTS". */
 #define RTE_RING_QUOT_EXCEED (1 << 31)  /**< Quota exceed for burst ops */
 #define RTE_RING_SZ_MASK  (unsigned)(0x0fffffff) /**< Ring size mask */
 
@@ -213,6 +278,23 @@ struct rte_ring {
  */
 ssize_t rte_ring_get_memsize(unsigned count);
 
+/**
+ * Calculate the memory size needed for a ring of fixed-size elements
+ *
+ * Same as rte_ring_get_memsize(), for a ring storing *esize*-byte
+ * elements instead of object pointers.
+ *
+ * @param esize
+ *   The size of a ring element, in bytes. It must be a multiple of 4
+ *   and not exceed RTE_RING_ELEM_MAX_SIZE.
+ * @param count
+ *   The number of elements in the ring (must be a power of 2).
+ * @return
+ *   - The memory size needed for the ring on success.
+ *   - -EINVAL if esize is invalid or count is not a power of 2.
+ */
+ssize_t rte_ring_get_memsize_elem(unsigned esize, unsigned count);
+
 /**
  * Initialize a ring structure.
  *
@@ -244,12 +326,43 @@ ssize_t rte_ring_get_memsize(unsigned count);
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_MP_RTS_ENQ, RING_F_MP_HTS_ENQ: If one of these flags is
+ *      set, the default enqueue is "multi-producers" using the relaxed
+ *      tail sync or the head/tail sync mode (see rte_ring_sync_type).
+ *    - RING_F_MC_RTS_DEQ, RING_F_MC_HTS_DEQ: Same for the default
+ *      dequeue.
+ *    At most one enqueue flag and one dequeue flag can be set.
  * @return
  *   0 on success, or a negative value on error.
  */
 int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 	unsigned flags);
 
+/**
+ * Initialize a ring structure of fixed-size elements.
+ *
+ * Same as rte_ring_init(), but the ring stores *esize*-byte elements
+ * instead of object pointers. Such a ring must only be accessed through
+ * the *_elem() enqueue/dequeue functions. It is advised to use
+ * rte_ring_get_memsize_elem() to get the appropriate memory size.
+ *
+ * @param r
+ *   The pointer to the ring structure followed by the elements table.
+ * @param name
+ *   The name of the ring.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be a multiple of 4
+ *   and not exceed RTE_RING_ELEM_MAX_SIZE.
+ * @param count
+ *   The number of elements in the ring (must be a power of 2).
+ * @param flags
+ *   Same as for rte_ring_init().
+ * @return
+ *   0 on success, or a negative value on error.
+ */
+int rte_ring_init_elem(struct rte_ring *r, const char *name, unsigned esize,
+	unsigned count, unsigned flags);
+
 /**
  * Create a new ring named *name* in memory.
  *
@@ -279,13 +392,19 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_MP_RTS_ENQ, RING_F_MP_HTS_ENQ: If one of these flags is
+ *      set, the default enqueue is "multi-producers" using the relaxed
+ *      tail sync or the head/tail sync mode (see rte_ring_sync_type).
+ *    - RING_F_MC_RTS_DEQ, RING_F_MC_HTS_DEQ: Same for the default
+ *      dequeue.
+ *    At most one enqueue flag and one dequeue flag can be set.
  * @return
  *   On success, the pointer to the new allocated ring. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
  *    - E_RTE_NO_CONFIG - function could not get pointer to rte_config structure
  *    - E_RTE_SECONDARY - function was called from a secondary process instance
  *    - E_RTE_NO_TAILQ - no tailq list could be got for the ring list
- *    - EINVAL - count provided is not a power of 2
+ *    - EINVAL - count provided is not a power of 2, or invalid flags
  *    - ENOSPC - the maximum number of memzones has already been allocated
  *    - EEXIST - a memzone with the same name already exists
  *    - ENOMEM - no appropriate memory area found in which to create memzone
@@ -293,6 +412,35 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 struct rte_ring *rte_ring_create(const char *name, unsigned count,
 				 int socket_id, unsigned flags);
 
+/**
+ * Create a new ring of fixed-size elements named *name* in memory.
+ *
+ * Same as rte_ring_create(), but the ring stores *esize*-byte elements
+ * inline instead of object pointers, so that small messages can be
+ * passed without allocating them from a mempool. Such a ring must only
+ * be accessed through the *_elem() enqueue/dequeue functions.
+ *
+ * @param name
+ *   The name of the ring.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be a multiple of 4
+ *   and not exceed RTE_RING_ELEM_MAX_SIZE.
+ * @param count
+ *   The size of the ring (must be a power of 2).
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in case of
+ *   NUMA. The value can be *SOCKET_ID_ANY* if there is no NUMA
+ *   constraint for the reserved zone.
+ * @param flags
+ *   Same as for rte_ring_create().
+ * @return
+ *   On success, the pointer to the new allocated ring. NULL on error with
+ *    rte_errno set appropriately (see rte_ring_create()). EINVAL is also
+ *    returned if esize is invalid.
+ */
+struct rte_ring *rte_ring_create_elem(const char *name, unsigned esize,
+				 unsigned count, int socket_id, unsigned flags);
+
 /**
  * Change the high water mark.
  *
@@ -313,6 +461,43 @@ struct rte_ring *rte_ring_create(const char *name, unsigned count,
  */
 int rte_ring_set_water_mark(struct rte_ring *r, unsigned count);
 
+/**
+ * Change the maximum distance between the producer head and tail.
+ *
+ * Only for rings whose producers are in relaxed tail sync mode
+ * (RING_F_MP_RTS_ENQ). A producer does not move the head while the tail
+ * lags more than *v* entries behind, which bounds the number of objects
+ * written in the ring but not yet visible to the consumers. The default
+ * value is 1/8 of the ring size.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param v
+ *   The new maximum head/tail distance, lower than the ring size.
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: The producers are not in RTS mode.
+ *   - -EINVAL: Invalid value.
+ */
+int rte_ring_set_prod_htd_max(struct rte_ring *r, unsigned v);
+
+/**
+ * Change the maximum distance between the consumer head and tail.
+ *
+ * Same as rte_ring_set_prod_htd_max(), for rings whose consumers are in
+ * relaxed tail sync mode (RING_F_MC_RTS_DEQ).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param v
+ *   The new maximum head/tail distance, lower than the ring size.
+ * @return
+ *   - 0: Success.
+ *   - -ENOTSUP: The consumers are not in RTS mode.
+ *   - -EINVAL: Invalid value.
+ */
+int rte_ring_set_cons_htd_max(struct rte_ring *r, unsigned v);
+
 /**
  * Dump the status of the ring to the console.
  *
@@ -375,8 +560,196 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
 	} \
 } while (0)
 
+/* the actual copy of elements on the ring, in units of 64 bits */
+static inline void __attribute__((always_inline))
+__rte_ring_enqueue_elems_64(struct rte_ring *r, uint32_t size, uint32_t idx,
+		const void *obj_table, uint32_t n)
+{
+	unsigned i;
+	uint64_t *ring = (uint64_t *)&r->ring[0];
+	const uint64_t *obj = (const uint64_t *)obj_table;
+
+	if (likely(idx + n < size)) {
+		for (i = 0; i < (n & ((~(unsigned)0x3))); i+=4, idx+=4) {
+			ring[idx] = obj[i];
+			ring[idx+1] = obj[i+1];
+			ring[idx+2] = obj[i+2];
+			ring[idx+3] = obj[i+3];
+		}
+		switch (n & 0x3) {
+			case 3: ring[idx++] = obj[i++];
+			case 2: ring[idx++] = obj[i++];
+			case 1: ring[idx++] = obj[i++];
+		}
+	} else {
+		for (i = 0; idx < size; i++, idx++)
+			ring[idx] = obj[i];
+		for (idx = 0; i < n; i++, idx++)
+			ring[idx] = obj[i];
+	}
+}
+
+/* the actual copy of elements on the ring, in units of 32 bits */
+static inline void __attribute__((always_inline))
+__rte_ring_enqueue_elems_32(struct rte_ring *r, uint32_t size, uint32_t idx,
+		const void *obj_table, uint32_t n)
+{
+	unsigned i;
+	uint32_t *ring = (uint32_t *)&r->ring[0];
+	const uint32_t *obj = (const uint32_t *)obj_table;
+
+	if (likely(idx + n < size)) {
+		for (i = 0; i < (n & ((~(unsigned)0x3))); i+=4, idx+=4) {
+			ring[idx] = obj[i];
+			ring[idx+1] = obj[i+1];
+			ring[idx+2] = obj[i+2];
+			ring[idx+3] = obj[i+3];
+		}
+		switch (n & 0x3) {
+			case 3: ring[idx++] = obj[i++];
+			case 2: ring[idx++] = obj[i++];
+			case 1: ring[idx++] = obj[i++];
+		}
+	} else {
+		for (i = 0; idx < size; i++, idx++)
+			ring[idx] = obj[i];
+		for (idx = 0; i < n; i++, idx++)
+			ring[idx] = obj[i];
+	}
+}
+
+/* the actual copy of elements from the ring, in units of 64 bits */
+static inline void __attribute__((always_inline))
+__rte_ring_dequeue_elems_64(struct rte_ring *r, uint32_t size, uint32_t idx,
+		void *obj_table, uint32_t n)
+{
+	unsigned i;
+	const uint64_t *ring = (const uint64_t *)&r->ring[0];
+	uint64_t *obj = (uint64_t *)obj_table;
+
+	if (likely(idx + n < size)) {
+		for (i = 0; i < (n & ((~(unsigned)0x3))); i+=4, idx+=4) {
+			obj[i] = ring[idx];
+			obj[i+1] = ring[idx+1];
+			obj[i+2] = ring[idx+2];
+			obj[i+3] = ring[idx+3];
+		}
+		switch (n & 0x3) {
+			case 3: obj[i++] = ring[idx++];
+			case 2: obj[i++] = ring[idx++];
+			case 1: obj[i++] = ring[idx++];
+		}
+	} else {
+		for (i = 0; idx < size; i++, idx++)
+			obj[i] = ring[idx];
+		for (idx = 0; i < n; i++, idx++)
+			obj[i] = ring[idx];
+	}
+}
+
+/* the actual copy of elements from the ring, in units of 32 bits */
+static inline void __attribute__((always_inline))
+__rte_ring_dequeue_elems_32(struct rte_ring *r, uint32_t size, uint32_t idx,
+		void *obj_table, uint32_t n)
+{
+	unsigned i;
+	const uint32_t *ring = (const uint32_t *)&r->ring[0];
+	uint32_t *obj = (uint32_t *)obj_table;
+
+	if (likely(idx + n < size)) {
+		for (i = 0; i < (n & ((~(unsigned)0x3))); i+=4, idx+=4) {
+			obj[i] = ring[idx];
+			obj[i+1] = ring[idx+1];
+			obj[i+2] = ring[idx+2];
+			obj[i+3] = ring[idx+3];
+		}
+		switch (n & 0x3) {
+			case 3: obj[i++] = ring[idx++];
+			case 2: obj[i++] = ring[idx++];
+			case 1: obj[i++] = ring[idx++];
+		}
+	} else {
+		for (i = 0; idx < size; i++, idx++)
+			obj[i] = ring[idx];
+		for (idx = 0; i < n; i++, idx++)
+			obj[i] = ring[idx];
+	}
+}
+
+/* copy pointers on the ring, see ENQUEUE_PTRS() */
+static inline void __attribute__((always_inline))
+__rte_ring_enqueue_ptrs(struct rte_ring *r, uint32_t prod_head,
+		void * const *obj_table, unsigned n)
+{
+	uint32_t mask = r->prod.mask;
+	unsigned i;
+
+	ENQUEUE_PTRS();
+}
+
+/* copy pointers from the ring, see DEQUEUE_PTRS() */
+static inline void __attribute__((always_inline))
+__rte_ring_dequeue_ptrs(struct rte_ring *r, uint32_t cons_head,
+		void **obj_table, unsigned n)
+{
+	uint32_t mask = r->cons.mask;
+	unsigned i;
+
+	DEQUEUE_PTRS();
+}
+
+/*
+ * Copy n elements of esize bytes on the ring, starting at index prod_head.
+ * esize is a compile-time constant in all callers, so only one of the
+ * copy loops is kept.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_enqueue_elems(struct rte_ring *r, uint32_t prod_head,
+		const void *obj_table, unsigned esize, unsigned n)
+{
+	uint32_t idx = prod_head & r->prod.mask;
+	uint32_t scale;
+
+	if (esize == sizeof(void *))
+		__rte_ring_enqueue_ptrs(r, prod_head,
+				(void * const *)obj_table, n);
+	else if ((esize & 0x7) == 0) {
+		scale = esize / sizeof(uint64_t);
+		__rte_ring_enqueue_elems_64(r, r->prod.size * scale,
+				idx * scale, obj_table, n * scale);
+	} else {
+		scale = esize / sizeof(uint32_t);
+		__rte_ring_enqueue_elems_32(r, r->prod.size * scale,
+				idx * scale, obj_table, n * scale);
+	}
+}
+
+/*
+ * Copy n elements of esize bytes from the ring, starting at index
+ * cons_head.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_dequeue_elems(struct rte_ring *r, uint32_t cons_head,
+		void *obj_table, unsigned esize, unsigned n)
+{
+	uint32_t idx = cons_head & r->cons.mask;
+	uint32_t scale;
+
+	if (esize == sizeof(void *))
+		__rte_ring_dequeue_ptrs(r, cons_head, (void **)obj_table, n);
+	else if ((esize & 0x7) == 0) {
+		scale = esize / sizeof(uint64_t);
+		__rte_ring_dequeue_elems_64(r, r->cons.size * scale,
+				idx * scale, obj_table, n * scale);
+	} else {
+		scale = esize / sizeof(uint32_t);
+		__rte_ring_dequeue_elems_32(r, r->cons.size * scale,
+				idx * scale, obj_table, n * scale);
+	}
+}
+
 /**
- * @internal Enqueue several objects on the ring (multi-producers safe).
+ * @internal Enqueue several elements on the ring (multi-producers safe).
  *
  * This function uses a "compare and set" instruction to move the
  * producer index atomically.
@@ -384,7 +757,9 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects).
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes.
  * @param n
  *   The number of objects to add in the ring from the obj_table.
  * @param behavior
@@ -401,14 +776,14 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
  *   - n: Actual number of objects enqueued.
  */
 static inline int __attribute__((always_inline))
-__rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
-			 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_mp_do_enqueue_elem(struct rte_ring *r, const void *obj_table,
+			 unsigned esize, unsigned n,
+			 enum rte_ring_queue_behavior behavior)
 {
 	uint32_t prod_head, prod_next;
 	uint32_t cons_tail, free_entries;
 	const unsigned max = n;
 	int success;
-	unsigned i;
 	uint32_t mask = r->prod.mask;
 	int ret;
 
@@ -448,7 +823,7 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	} while (unlikely(success == 0));
 
 	/* write entries in ring */
-	ENQUEUE_PTRS();
+	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
 	rte_compiler_barrier();
 
 	/* if we exceed the watermark */
@@ -474,12 +849,14 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 }
 
 /**
- * @internal Enqueue several objects on a ring (NOT multi-producers safe).
+ * @internal Enqueue several elements on a ring (NOT multi-producers safe).
  *
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects).
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes.
  * @param n
  *   The number of objects to add in the ring from the obj_table.
  * @param behavior
@@ -496,12 +873,12 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  *   - n: Actual number of objects enqueued.
  */
 static inline int __attribute__((always_inline))
-__rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
-			 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_sp_do_enqueue_elem(struct rte_ring *r, const void *obj_table,
+			 unsigned esize, unsigned n,
+			 enum rte_ring_queue_behavior behavior)
 {
 	uint32_t prod_head, cons_tail;
 	uint32_t prod_next, free_entries;
-	unsigned i;
 	uint32_t mask = r->prod.mask;
 	int ret;
 
@@ -534,7 +911,7 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	r->prod.head = prod_next;
 
 	/* write entries in ring */
-	ENQUEUE_PTRS();
+	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
 	rte_compiler_barrier();
 
 	/* if we exceed the watermark */
@@ -553,7 +930,7 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 }
 
 /**
- * @internal Dequeue several objects from a ring (multi-consumers safe). When
+ * @internal Dequeue several elements from a ring (multi-consumers safe). When
  * the request objects are more than the available objects, only dequeue the
  * actual number of objects
  *
@@ -563,7 +940,9 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes.
  * @param n
  *   The number of objects to dequeue from the ring to the obj_table.
  * @param behavior
@@ -580,15 +959,14 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  */
 
 static inline int __attribute__((always_inline))
-__rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
-		 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_mc_do_dequeue_elem(struct rte_ring *r, void *obj_table,
+		 unsigned esize, unsigned n,
+		 enum rte_ring_queue_behavior behavior)
 {
 	uint32_t cons_head, prod_tail;
 	uint32_t cons_next, entries;
 	const unsigned max = n;
 	int success;
-	unsigned i;
-	uint32_t mask = r->prod.mask;
 
 	/* move cons.head atomically */
 	do {
@@ -625,7 +1003,7 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
 	} while (unlikely(success == 0));
 
 	/* copy in table */
-	DEQUEUE_PTRS();
+	__rte_ring_dequeue_elems(r, cons_head, obj_table, esize, n);
 	rte_compiler_barrier();
 
 	/*
@@ -642,14 +1020,16 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
 }
 
 /**
- * @internal Dequeue several objects from a ring (NOT multi-consumers safe).
+ * @internal Dequeue several elements from a ring (NOT multi-consumers safe).
  * When the request objects are more than the available objects, only dequeue
  * the actual number of objects
  *
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes.
  * @param n
  *   The number of objects to dequeue from the ring to the obj_table.
  * @param behavior
@@ -665,13 +1045,12 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
  *   - n: Actual number of objects dequeued.
  */
 static inline int __attribute__((always_inline))
-__rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
-		 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_sc_do_dequeue_elem(struct rte_ring *r, void *obj_table,
+		 unsigned esize, unsigned n,
+		 enum rte_ring_queue_behavior behavior)
 {
 	uint32_t cons_head, prod_tail;
 	uint32_t cons_next, entries;
-	unsigned i;
-	uint32_t mask = r->prod.mask;
 
 	cons_head = r->cons.head;
 	prod_tail = r->prod.tail;
@@ -700,7 +1079,7 @@ __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
 	r->cons.head = cons_next;
 
 	/* copy in table */
-	DEQUEUE_PTRS();
+	__rte_ring_dequeue_elems(r, cons_head, obj_table, esize, n);
 	rte_compiler_barrier();
 
 	__RING_STAT_ADD(r, deq_success, n);
@@ -709,146 +1088,631 @@ __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
 }
 
 /**
- * Enqueue several objects on the ring (multi-producers safe).
- *
- * This function uses a "compare and set" instruction to move the
- * producer index atomically.
- *
- * @param r
- *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
- * @param n
- *   The number of objects to add in the ring from the obj_table.
- * @return
- *   - 0: Success; objects enqueue.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ * @internal Enqueue several objects on the ring (multi-producers safe).
+ * See __rte_ring_mp_do_enqueue_elem().
  */
 static inline int __attribute__((always_inline))
-rte_ring_mp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
-			 unsigned n)
+__rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
+			 unsigned n, enum rte_ring_queue_behavior behavior)
 {
-	return __rte_ring_mp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_mp_do_enqueue_elem(r, obj_table, sizeof(void *), n,
+			behavior);
 }
 
 /**
- * Enqueue several objects on a ring (NOT multi-producers safe).
- *
- * @param r
- *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
- * @param n
- *   The number of objects to add in the ring from the obj_table.
- * @return
- *   - 0: Success; objects enqueued.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ * @internal Enqueue several objects on a ring (NOT multi-producers safe).
+ * See __rte_ring_sp_do_enqueue_elem().
  */
 static inline int __attribute__((always_inline))
-rte_ring_sp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
-			 unsigned n)
+__rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
+			 unsigned n, enum rte_ring_queue_behavior behavior)
 {
-	return __rte_ring_sp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_sp_do_enqueue_elem(r, obj_table, sizeof(void *), n,
+			behavior);
 }
 
 /**
- * Enqueue several objects on a ring.
- *
- * This function calls the multi-producer or the single-producer
- * version depending on the default behavior that was specified at
- * ring creation time (see flags).
- *
- * @param r
- *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
- * @param n
- *   The number of objects to add in the ring from the obj_table.
- * @return
- *   - 0: Success; objects enqueued.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ * @internal Dequeue several objects from a ring (multi-consumers safe).
+ * See __rte_ring_mc_do_dequeue_elem().
  */
 static inline int __attribute__((always_inline))
-rte_ring_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
-		      unsigned n)
+__rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
+		 unsigned n, enum rte_ring_queue_behavior behavior)
 {
-	if (r->prod.sp_enqueue)
-		return rte_ring_sp_enqueue_bulk(r, obj_table, n);
-	else
-		return rte_ring_mp_enqueue_bulk(r, obj_table, n);
+	return __rte_ring_mc_do_dequeue_elem(r, obj_table, sizeof(void *), n,
+			behavior);
 }
 
 /**
- * Enqueue one object on a ring (multi-producers safe).
- *
- * This function uses a "compare and set" instruction to move the
- * producer index atomically.
- *
- * @param r
- *   A pointer to the ring structure.
- * @param obj
- *   A pointer to the object to be added.
- * @return
- *   - 0: Success; objects enqueued.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ * @internal Dequeue several objects from a ring (NOT multi-consumers safe).
+ * See __rte_ring_sc_do_dequeue_elem().
  */
 static inline int __attribute__((always_inline))
-rte_ring_mp_enqueue(struct rte_ring *r, void *obj)
+__rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
+		 unsigned n, enum rte_ring_queue_behavior behavior)
 {
-	return rte_ring_mp_enqueue_bulk(r, &obj, 1);
+	return __rte_ring_sc_do_dequeue_elem(r, obj_table, sizeof(void *), n,
+			behavior);
 }
 
+/* position and operation counter of a head or tail in RTS mode */
+union __rte_ring_poscnt {
+	uint64_t raw;
+	struct {
+		uint32_t pos;
+		uint32_t cnt;
+	} val;
+};
+
 /**
- * Enqueue one object on a ring (NOT multi-producers safe).
- *
- * @param r
- *   A pointer to the ring structure.
- * @param obj
- *   A pointer to the object to be added.
+ * @internal Wait until the tail is close enough to the head (RTS mode).
+ *
+ * @param head_raw
+ *   A pointer to the head and counter of the producer or consumer.
+ * @param tail
+ *   A pointer to the tail of the producer or consumer.
+ * @param htd_max
+ *   The maximum distance allowed between the head and the tail.
  * @return
- *   - 0: Success; objects enqueued.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ *   The head and counter value read last.
  */
-static inline int __attribute__((always_inline))
-rte_ring_sp_enqueue(struct rte_ring *r, void *obj)
+static inline uint64_t __attribute__((always_inline))
+__rte_ring_rts_head_wait(volatile uint64_t *head_raw,
+		volatile uint32_t *tail, uint32_t htd_max)
 {
-	return rte_ring_sp_enqueue_bulk(r, &obj, 1);
+	union __rte_ring_poscnt h;
+
+	h.raw = *head_raw;
+	while (unlikely(h.val.pos - *tail > htd_max)) {
+		rte_pause();
+		h.raw = *head_raw;
+	}
+	return h.raw;
 }
 
 /**
- * Enqueue one object on a ring.
+ * @internal Complete an operation in RTS mode.
  *
- * This function calls the multi-producer or the single-producer
- * version, depending on the default behaviour that was specified at
- * ring creation time (see flags).
+ * The tail counter is incremented. The thread that completes the last
+ * started operation also moves the tail position up to the head, so no
+ * thread ever waits for another one to complete.
  *
- * @param r
- *   A pointer to the ring structure.
- * @param obj
- *   A pointer to the object to be added.
- * @return
- *   - 0: Success; objects enqueued.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ * @param head_raw
+ *   A pointer to the head and counter of the producer or consumer.
+ * @param tail_raw
+ *   A pointer to the tail and counter of the producer or consumer.
  */
-static inline int __attribute__((always_inline))
-rte_ring_enqueue(struct rte_ring *r, void *obj)
+static inline void __attribute__((always_inline))
+__rte_ring_rts_update_tail(volatile uint64_t *head_raw,
+		volatile uint64_t *tail_raw)
 {
-	if (r->prod.sp_enqueue)
-		return rte_ring_sp_enqueue(r, obj);
-	else
-		return rte_ring_mp_enqueue(r, obj);
+	union __rte_ring_poscnt h, ot, nt;
+
+	do {
+		ot.raw = *tail_raw;
+		h.raw = *head_raw;
+
+		nt.raw = ot.raw;
+		if (++nt.val.cnt == h.val.cnt)
+			nt.val.pos = h.val.pos;
+	} while (unlikely(rte_atomic64_cmpset(tail_raw, ot.raw, nt.raw) == 0));
+}
+
+/**
+ * @internal Move the producer head in RTS mode.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param num
+ *   The number of entries to reserve.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Reserve a fixed number of entries
+ *   RTE_RING_QUEUE_VARIABLE: Reserve as many entries as possible
+ * @param old_head
+ *   Filled with the head position before the move.
+ * @param free_entries
+ *   Filled with the number of free entries before the move.
+ * @return
+ *   The number of entries reserved, 0 on failure.
+ */
+static inline unsigned __attribute__((always_inline))
+__rte_ring_rts_move_prod_head(struct rte_ring *r, unsigned num,
+		enum rte_ring_queue_behavior behavior, uint32_t *old_head,
+		uint32_t *free_entries)
+{
+	union __rte_ring_poscnt oh, nh;
+	uint32_t mask = r->prod.mask;
+	unsigned n;
+
+	do {
+		/* Reset n to the initial burst count */
+		n = num;
+
+		oh.raw = __rte_ring_rts_head_wait(&r->prod.head_raw,
+				&r->prod.tail, r->prod.htd_max);
+		*free_entries = mask + r->cons.tail - oh.val.pos;
+
+		/* check that we have enough room in ring */
+		if (unlikely(n > *free_entries))
+			n = (behavior == RTE_RING_QUEUE_FIXED) ?
+					0 : *free_entries;
+		if (n == 0)
+			break;
+
+		nh.val.pos = oh.val.pos + n;
+		nh.val.cnt = oh.val.cnt + 1;
+	} while (unlikely(rte_atomic64_cmpset(&r->prod.head_raw, oh.raw,
+			nh.raw) == 0));
+
+	*old_head = oh.val.pos;
+	return n;
+}
+
+/**
+ * @internal Move the consumer head in RTS mode.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param num
+ *   The number of entries to reserve.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Reserve a fixed number of entries
+ *   RTE_RING_QUEUE_VARIABLE: Reserve as many entries as possible
+ * @param old_head
+ *   Filled with the head position before the move.
+ * @return
+ *   The number of entries reserved, 0 on failure.
+ */
+static inline unsigned __attribute__((always_inline))
+__rte_ring_rts_move_cons_head(struct rte_ring *r, unsigned num,
+		enum rte_ring_queue_behavior behavior, uint32_t *old_head)
+{
+	union __rte_ring_poscnt oh, nh;
+	uint32_t entries;
+	unsigned n;
+
+	do {
+		/* Restore n as it may change every loop */
+		n = num;
+
+		oh.raw = __rte_ring_rts_head_wait(&r->cons.head_raw,
+				&r->cons.tail, r->cons.htd_max);
+		entries = r->prod.tail - oh.val.pos;
+
+		if (n > entries)
+			n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : entries;
+		if (unlikely(n == 0))
+			break;
+
+		nh.val.pos = oh.val.pos + n;
+		nh.val.cnt = oh.val.cnt + 1;
+	} while (unlikely(rte_atomic64_cmpset(&r->cons.head_raw, oh.raw,
+			nh.raw) == 0));
+
+	*old_head = oh.val.pos;
+	return n;
+}
+
+/**
+ * @internal Move the producer head in HTS mode.
+ *
+ * The head is only moved when it is equal to the tail, i.e. when no
+ * other enqueue is in progress.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param num
+ *   The number of entries to reserve.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Reserve a fixed number of entries
+ *   RTE_RING_QUEUE_VARIABLE: Reserve as many entries as possible
+ * @param old_head
+ *   Filled with the head position before the move.
+ * @param free_entries
+ *   Filled with the number of free entries before the move.
+ * @return
+ *   The number of entries reserved, 0 on failure.
+ */
+static inline unsigned __attribute__((always_inline))
+__rte_ring_hts_move_prod_head(struct rte_ring *r, unsigned num,
+		enum rte_ring_queue_behavior behavior, uint32_t *old_head,
+		uint32_t *free_entries)
+{
+	uint32_t prod_head;
+	uint32_t mask = r->prod.mask;
+	unsigned n;
+	int success;
+
+	do {
+		/* Reset n to the initial burst count */
+		n = num;
+
+		/* wait for the enqueue in progress to complete. The head
+		 * is read before the tail: if another producer moves the
+		 * head in between, the compare and set below fails */
+		prod_head = r->prod.head;
+		while (unlikely(r->prod.tail != prod_head)) {
+			rte_pause();
+			prod_head = r->prod.head;
+		}
+		*free_entries = mask + r->cons.tail - prod_head;
+
+		/* check that we have enough room in ring */
+		if (unlikely(n > *free_entries))
+			n = (behavior == RTE_RING_QUEUE_FIXED) ?
+					0 : *free_entries;
+		if (n == 0)
+			break;
+
+		success = rte_atomic32_cmpset(&r->prod.head, prod_head,
+					      prod_head + n);
+	} while (unlikely(success == 0));
+
+	*old_head = prod_head;
+	return n;
+}
+
+/**
+ * @internal Move the consumer head in HTS mode.
+ *
+ * The head is only moved when it is equal to the tail, i.e. when no
+ * other dequeue is in progress.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param num
+ *   The number of entries to reserve.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Reserve a fixed number of entries
+ *   RTE_RING_QUEUE_VARIABLE: Reserve as many entries as possible
+ * @param old_head
+ *   Filled with the head position before the move.
+ * @return
+ *   The number of entries reserved, 0 on failure.
+ */
+static inline unsigned __attribute__((always_inline))
+__rte_ring_hts_move_cons_head(struct rte_ring *r, unsigned num,
+		enum rte_ring_queue_behavior behavior, uint32_t *old_head)
+{
+	uint32_t cons_head, entries;
+	unsigned n;
+	int success;
+
+	do {
+		/* Restore n as it may change every loop */
+		n = num;
+
+		cons_head = r->cons.head;
+		while (unlikely(r->cons.tail != cons_head)) {
+			rte_pause();
+			cons_head = r->cons.head;
+		}
+		entries = r->prod.tail - cons_head;
+
+		if (n > entries)
+			n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : entries;
+		if (unlikely(n == 0))
+			break;
+
+		success = rte_atomic32_cmpset(&r->cons.head, cons_head,
+					      cons_head + n);
+	} while (unlikely(success == 0));
+
+	*old_head = cons_head;
+	return n;
+}
+
+/**
+ * @internal Enqueue several elements on the ring in RTS or HTS mode.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
+ * @param sync_type
+ *   RTE_RING_SYNC_MT_RTS or RTE_RING_SYNC_MT_HTS.
+ * @return
+ *   Same as __rte_ring_mp_do_enqueue_elem().
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_ts_do_enqueue_elem(struct rte_ring *r, const void *obj_table,
+			 unsigned esize, unsigned n,
+			 enum rte_ring_queue_behavior behavior,
+			 enum rte_ring_sync_type sync_type)
+{
+	uint32_t prod_head, free_entries;
+	uint32_t mask = r->prod.mask;
+	const unsigned max = n;
+	int ret;
+
+	if (sync_type == RTE_RING_SYNC_MT_RTS)
+		n = __rte_ring_rts_move_prod_head(r, n, behavior, &prod_head,
+				&free_entries);
+	else
+		n = __rte_ring_hts_move_prod_head(r, n, behavior, &prod_head,
+				&free_entries);
+
+	/* nothing was reserved, so the tail must not be updated: in RTS
+	 * mode, it would count an operation the head never started */
+	if (unlikely(n == 0)) {
+		if (max == 0)
+			return 0;
+		__RING_STAT_ADD(r, enq_fail, max);
+		return (behavior == RTE_RING_QUEUE_FIXED) ? -ENOBUFS : 0;
+	}
+
+	/* write entries in ring */
+	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
+	rte_compiler_barrier();
+
+	/* if we exceed the watermark */
+	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
+		ret = (behavior == RTE_RING_QUEUE_FIXED) ? -EDQUOT :
+				(int)(n | RTE_RING_QUOT_EXCEED);
+		__RING_STAT_ADD(r, enq_quota, n);
+	}
+	else {
+		ret = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : n;
+		__RING_STAT_ADD(r, enq_success, n);
+	}
+
+	if (sync_type == RTE_RING_SYNC_MT_RTS)
+		__rte_ring_rts_update_tail(&r->prod.head_raw,
+				&r->prod.tail_raw);
+	else
+		r->prod.tail = prod_head + n;
+	return ret;
+}
+
+/**
+ * @internal Dequeue several elements from a ring in RTS or HTS mode.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items a possible from ring
+ * @param sync_type
+ *   RTE_RING_SYNC_MT_RTS or RTE_RING_SYNC_MT_HTS.
+ * @return
+ *   Same as __rte_ring_mc_do_dequeue_elem().
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_ts_do_dequeue_elem(struct rte_ring *r, void *obj_table,
+		 unsigned esize, unsigned n,
+		 enum rte_ring_queue_behavior behavior,
+		 enum rte_ring_sync_type sync_type)
+{
+	uint32_t cons_head;
+	const unsigned max = n;
+
+	if (sync_type == RTE_RING_SYNC_MT_RTS)
+		n = __rte_ring_rts_move_cons_head(r, n, behavior, &cons_head);
+	else
+		n = __rte_ring_hts_move_cons_head(r, n, behavior, &cons_head);
+
+	/* nothing was reserved, so the tail must not be updated: in RTS
+	 * mode, it would count an operation the head never started */
+	if (unlikely(n == 0)) {
+		if (max == 0)
+			return 0;
+		__RING_STAT_ADD(r, deq_fail, max);
+		return (behavior == RTE_RING_QUEUE_FIXED) ? -ENOENT : 0;
+	}
+
+	/* copy in table */
+	__rte_ring_dequeue_elems(r, cons_head, obj_table, esize, n);
+	rte_compiler_barrier();
+
+	__RING_STAT_ADD(r, deq_success, n);
+	if (sync_type == RTE_RING_SYNC_MT_RTS)
+		__rte_ring_rts_update_tail(&r->cons.head_raw,
+				&r->cons.tail_raw);
+	else
+		r->cons.tail = cons_head + n;
+
+	return behavior == RTE_RING_QUEUE_FIXED ? 0 : n;
+}
+
+/**
+ * @internal Enqueue several elements on a ring, using the enqueue mode
+ * that was specified at ring creation time.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_do_enqueue_elem(struct rte_ring *r, const void *obj_table,
+			 unsigned esize, unsigned n,
+			 enum rte_ring_queue_behavior behavior)
+{
+	switch (r->prod.sync_type) {
+	case RTE_RING_SYNC_ST:
+		return __rte_ring_sp_do_enqueue_elem(r, obj_table, esize, n,
+				behavior);
+	case RTE_RING_SYNC_MT_RTS:
+		return __rte_ring_ts_do_enqueue_elem(r, obj_table, esize, n,
+				behavior, RTE_RING_SYNC_MT_RTS);
+	case RTE_RING_SYNC_MT_HTS:
+		return __rte_ring_ts_do_enqueue_elem(r, obj_table, esize, n,
+				behavior, RTE_RING_SYNC_MT_HTS);
+	default:
+		return __rte_ring_mp_do_enqueue_elem(r, obj_table, esize, n,
+				behavior);
+	}
+}
+
+/**
+ * @internal Dequeue several elements from a ring, using the dequeue mode
+ * that was specified at ring creation time.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_do_dequeue_elem(struct rte_ring *r, void *obj_table,
+		 unsigned esize, unsigned n,
+		 enum rte_ring_queue_behavior behavior)
+{
+	switch (r->cons.sync_type) {
+	case RTE_RING_SYNC_ST:
+		return __rte_ring_sc_do_dequeue_elem(r, obj_table, esize, n,
+				behavior);
+	case RTE_RING_SYNC_MT_RTS:
+		return __rte_ring_ts_do_dequeue_elem(r, obj_table, esize, n,
+				behavior, RTE_RING_SYNC_MT_RTS);
+	case RTE_RING_SYNC_MT_HTS:
+		return __rte_ring_ts_do_dequeue_elem(r, obj_table, esize, n,
+				behavior, RTE_RING_SYNC_MT_HTS);
+	default:
+		return __rte_ring_mc_do_dequeue_elem(r, obj_table, esize, n,
+				behavior);
+	}
+}
+
+/**
+ * Enqueue several objects on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueue.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_mp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue several objects on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_sp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue several objects on a ring.
+ *
+ * This function calls the multi-producer or the single-producer
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+		      unsigned n)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue one object on a ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the object to be added.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue(struct rte_ring *r, void *obj)
+{
+	return rte_ring_mp_enqueue_bulk(r, &obj, 1);
+}
+
+/**
+ * Enqueue one object on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the object to be added.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue(struct rte_ring *r, void *obj)
+{
+	return rte_ring_sp_enqueue_bulk(r, &obj, 1);
+}
+
+/**
+ * Enqueue one object on a ring.
+ *
+ * This function calls the multi-producer or the single-producer
+ * version, depending on the default behaviour that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the object to be added.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue(struct rte_ring *r, void *obj)
+{
+	return rte_ring_enqueue_bulk(r, &obj, 1);
 }
 
 /**
@@ -869,342 +1733,1180 @@ rte_ring_enqueue(struct rte_ring *r, void *obj)
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_mc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+rte_ring_mc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_mc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Dequeue several objects from a ring (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table,
+ *   must be strictly positive.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_sc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Dequeue several objects from a ring.
+ *
+ * This function calls the multi-consumers or the single-consumer
+ * version, depending on the default behaviour that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Dequeue one object from a ring (multi-consumers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_p
+ *   A pointer to a void * pointer (object) that will be filled.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_dequeue(struct rte_ring *r, void **obj_p)
+{
+	return rte_ring_mc_dequeue_bulk(r, obj_p, 1);
+}
+
+/**
+ * Dequeue one object from a ring (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_p
+ *   A pointer to a void * pointer (object) that will be filled.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sc_dequeue(struct rte_ring *r, void **obj_p)
+{
+	return rte_ring_sc_dequeue_bulk(r, obj_p, 1);
+}
+
+/**
+ * Dequeue one object from a ring.
+ *
+ * This function calls the multi-consumers or the single-consumer
+ * version depending on the default behaviour that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_p
+ *   A pointer to a void * pointer (object) that will be filled.
+ * @return
+ *   - 0: Success, objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_dequeue(struct rte_ring *r, void **obj_p)
+{
+	return rte_ring_dequeue_bulk(r, obj_p, 1);
+}
+
+/**
+ * Test if a ring is full.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   - 1: The ring is full.
+ *   - 0: The ring is not full.
+ */
+static inline int
+rte_ring_full(const struct rte_ring *r)
+{
+	uint32_t prod_tail = r->prod.tail;
+	uint32_t cons_tail = r->cons.tail;
+	return (((cons_tail - prod_tail - 1) & r->prod.mask) == 0);
+}
+
+/**
+ * Test if a ring is empty.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   - 1: The ring is empty.
+ *   - 0: The ring is not empty.
+ */
+static inline int
+rte_ring_empty(const struct rte_ring *r)
+{
+	uint32_t prod_tail = r->prod.tail;
+	uint32_t cons_tail = r->cons.tail;
+	return !!(cons_tail == prod_tail);
+}
+
+/**
+ * Return the number of entries in a ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   The number of entries in the ring.
+ */
+static inline unsigned
+rte_ring_count(const struct rte_ring *r)
+{
+	uint32_t prod_tail = r->prod.tail;
+	uint32_t cons_tail = r->cons.tail;
+	return ((prod_tail - cons_tail) & r->prod.mask);
+}
+
+/**
+ * Return the number of free entries in a ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   The number of free entries in the ring.
+ */
+static inline unsigned
+rte_ring_free_count(const struct rte_ring *r)
+{
+	uint32_t prod_tail = r->prod.tail;
+	uint32_t cons_tail = r->cons.tail;
+	return ((cons_tail - prod_tail - 1) & r->prod.mask);
+}
+
+/**
+ * Dump the status of all rings on the console
+ *
+ * @param f
+ *   A pointer to a file for output
+ */
+void rte_ring_list_dump(FILE *f);
+
+/**
+ * Search a ring from its name
+ *
+ * @param name
+ *   The name of the ring.
+ * @return
+ *   The pointer to the ring matching the name, or NULL if not found,
+ *   with rte_errno set appropriately. Possible rte_errno values include:
+ *    - ENOENT - required entry not available to return.
+ */
+struct rte_ring *rte_ring_lookup(const char *name);
+
+/**
+ * Enqueue several objects on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_mp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Enqueue several objects on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_sp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Enqueue several objects on a ring.
+ *
+ * This function calls the multi-producer or the single-producer
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+		      unsigned n)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe). When the request
+ * objects are more than the available objects, only dequeue the actual number
+ * of objects
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_mc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Dequeue several objects from a ring (NOT multi-consumers safe).When the
+ * request objects are more than the available objects, only dequeue the
+ * actual number of objects
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_sc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Dequeue multiple objects from a ring up to a maximum number.
+ *
+ * This function calls the multi-consumers or the single-consumer
+ * version, depending on the default behaviour that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - Number of objects dequeued
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_do_dequeue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Enqueue several objects on a ring (multi-producers safe, RTS mode).
+ *
+ * The ring producers must have been created in RTS mode
+ * (RING_F_MP_RTS_ENQ); see rte_ring_sync_type.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_rts_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_ts_do_enqueue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED, RTE_RING_SYNC_MT_RTS);
+}
+
+/**
+ * Enqueue several objects on a ring (multi-producers safe, RTS mode).
+ * When there is not enough room for all objects, enqueue as many as
+ * possible.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_rts_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_ts_do_enqueue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_MT_RTS);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe, RTS mode).
+ *
+ * The ring consumers must have been created in RTS mode
+ * (RING_F_MC_RTS_DEQ); see rte_ring_sync_type.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_rts_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_ts_do_dequeue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED, RTE_RING_SYNC_MT_RTS);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe, RTS mode).
+ * When the request objects are more than the available objects, only
+ * dequeue the actual number of objects.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_rts_dequeue_burst(struct rte_ring *r, void **obj_table,
+		unsigned n)
+{
+	return __rte_ring_ts_do_dequeue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_MT_RTS);
+}
+
+/**
+ * Enqueue several objects on a ring (multi-producers safe, HTS mode).
+ *
+ * The ring producers must have been created in HTS mode
+ * (RING_F_MP_HTS_ENQ); see rte_ring_sync_type.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_hts_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_ts_do_enqueue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED, RTE_RING_SYNC_MT_HTS);
+}
+
+/**
+ * Enqueue several objects on a ring (multi-producers safe, HTS mode).
+ * When there is not enough room for all objects, enqueue as many as
+ * possible.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_hts_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_ts_do_enqueue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_MT_HTS);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe, HTS mode).
+ *
+ * The ring consumers must have been created in HTS mode
+ * (RING_F_MC_HTS_DEQ); see rte_ring_sync_type.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_hts_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_ts_do_dequeue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED, RTE_RING_SYNC_MT_HTS);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe, HTS mode).
+ * When the request objects are more than the available objects, only
+ * dequeue the actual number of objects.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_hts_dequeue_burst(struct rte_ring *r, void **obj_table,
+		unsigned n)
+{
+	return __rte_ring_ts_do_dequeue_elem(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE, RTE_RING_SYNC_MT_HTS);
+}
+
+/**
+ * Enqueue several elements on a ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically. The elements are copied inline in the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; elements enqueued.
+ *   - -EDQUOT: Quota exceeded. The elements have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no element is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+			 unsigned esize, unsigned n)
+{
+	return __rte_ring_mp_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue several elements on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; elements enqueued.
+ *   - -EDQUOT: Quota exceeded. The elements have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no element is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+			 unsigned esize, unsigned n)
+{
+	return __rte_ring_sp_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue several elements on a ring.
+ *
+ * This function calls the multi-producer or the single-producer
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; elements enqueued.
+ *   - -EDQUOT: Quota exceeded. The elements have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no element is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+		      unsigned esize, unsigned n)
+{
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue one element on a ring.
+ *
+ * This function calls the multi-producer or the single-producer
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj
+ *   A pointer to the element to be copied in the ring.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @return
+ *   - 0: Success; element enqueued.
+ *   - -EDQUOT: Quota exceeded. The element has been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no element is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_elem(struct rte_ring *r, const void *obj, unsigned esize)
+{
+	return rte_ring_enqueue_bulk_elem(r, obj, esize, 1);
+}
+
+/**
+ * Enqueue several elements on a ring (multi-producers safe). When there is
+ * not enough room for all elements, enqueue as many as possible.
+ *
+ * @param r
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of elements enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+			 unsigned esize, unsigned n)
 {
-	return __rte_ring_mc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_mp_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Dequeue several objects from a ring (NOT multi-consumers safe).
+ * Enqueue several elements on a ring (NOT multi-producers safe). When there
+ * is not enough room for all elements, enqueue as many as possible.
  *
  * @param r
- *   A pointer to the ring structure.
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
  * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
  * @param n
- *   The number of objects to dequeue from the ring to the obj_table,
- *   must be strictly positive.
+ *   The number of elements to add in the ring from the obj_table.
  * @return
- *   - 0: Success; objects dequeued.
- *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
- *     dequeued.
+ *   - n: Actual number of elements enqueued.
  */
-static inline int __attribute__((always_inline))
-rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+static inline unsigned __attribute__((always_inline))
+rte_ring_sp_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+			 unsigned esize, unsigned n)
 {
-	return __rte_ring_sc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_sp_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Dequeue several objects from a ring.
+ * Enqueue several elements on a ring, as many as possible.
  *
- * This function calls the multi-consumers or the single-consumer
- * version, depending on the default behaviour that was specified at
+ * This function calls the multi-producer or the single-producer
+ * version depending on the default behavior that was specified at
  * ring creation time (see flags).
  *
  * @param r
- *   A pointer to the ring structure.
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
  * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
+ *   A pointer to a table of elements.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
  * @param n
- *   The number of objects to dequeue from the ring to the obj_table.
+ *   The number of elements to add in the ring from the obj_table.
  * @return
- *   - 0: Success; objects dequeued.
- *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
- *     dequeued.
+ *   - n: Actual number of elements enqueued.
  */
-static inline int __attribute__((always_inline))
-rte_ring_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+static inline unsigned __attribute__((always_inline))
+rte_ring_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+		      unsigned esize, unsigned n)
 {
-	if (r->cons.sc_dequeue)
-		return rte_ring_sc_dequeue_bulk(r, obj_table, n);
-	else
-		return rte_ring_mc_dequeue_bulk(r, obj_table, n);
+	return __rte_ring_do_enqueue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Dequeue one object from a ring (multi-consumers safe).
+ * Dequeue several elements from a ring (multi-consumers safe).
  *
  * This function uses a "compare and set" instruction to move the
  * consumer index atomically.
  *
  * @param r
- *   A pointer to the ring structure.
- * @param obj_p
- *   A pointer to a void * pointer (object) that will be filled.
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
  * @return
- *   - 0: Success; objects dequeued.
- *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *   - 0: Success; elements dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_mc_dequeue(struct rte_ring *r, void **obj_p)
+rte_ring_mc_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
 {
-	return rte_ring_mc_dequeue_bulk(r, obj_p, 1);
+	return __rte_ring_mc_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
 }
 
 /**
- * Dequeue one object from a ring (NOT multi-consumers safe).
+ * Dequeue several elements from a ring (NOT multi-consumers safe).
  *
  * @param r
- *   A pointer to the ring structure.
- * @param obj_p
- *   A pointer to a void * pointer (object) that will be filled.
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
  * @return
- *   - 0: Success; objects dequeued.
- *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
+ *   - 0: Success; elements dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_sc_dequeue(struct rte_ring *r, void **obj_p)
+rte_ring_sc_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
 {
-	return rte_ring_sc_dequeue_bulk(r, obj_p, 1);
+	return __rte_ring_sc_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
 }
 
 /**
- * Dequeue one object from a ring.
+ * Dequeue several elements from a ring.
  *
  * This function calls the multi-consumers or the single-consumer
- * version depending on the default behaviour that was specified at
+ * version, depending on the default behaviour that was specified at
  * ring creation time (see flags).
  *
  * @param r
- *   A pointer to the ring structure.
- * @param obj_p
- *   A pointer to a void * pointer (object) that will be filled.
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
  * @return
- *   - 0: Success, objects dequeued.
- *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
+ *   - 0: Success; elements dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_dequeue(struct rte_ring *r, void **obj_p)
+rte_ring_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
 {
-	if (r->cons.sc_dequeue)
-		return rte_ring_sc_dequeue(r, obj_p);
-	else
-		return rte_ring_mc_dequeue(r, obj_p);
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
 }
 
 /**
- * Test if a ring is full.
+ * Dequeue one element from a ring.
+ *
+ * This function calls the multi-consumers or the single-consumer
+ * version, depending on the default behaviour that was specified at
+ * ring creation time (see flags).
  *
  * @param r
- *   A pointer to the ring structure.
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_p
+ *   A pointer to the element that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
  * @return
- *   - 1: The ring is full.
- *   - 0: The ring is not full.
+ *   - 0: Success; element dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no element is
+ *     dequeued.
  */
-static inline int
-rte_ring_full(const struct rte_ring *r)
+static inline int __attribute__((always_inline))
+rte_ring_dequeue_elem(struct rte_ring *r, void *obj_p, unsigned esize)
 {
-	uint32_t prod_tail = r->prod.tail;
-	uint32_t cons_tail = r->cons.tail;
-	return (((cons_tail - prod_tail - 1) & r->prod.mask) == 0);
+	return rte_ring_dequeue_bulk_elem(r, obj_p, esize, 1);
 }
 
 /**
- * Test if a ring is empty.
+ * Dequeue several elements from a ring (multi-consumers safe). When the
+ * request elements are more than the available elements, only dequeue the
+ * actual number of elements.
  *
  * @param r
- *   A pointer to the ring structure.
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
  * @return
- *   - 1: The ring is empty.
- *   - 0: The ring is not empty.
+ *   - n: Actual number of elements dequeued, 0 if ring is empty
  */
-static inline int
-rte_ring_empty(const struct rte_ring *r)
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
 {
-	uint32_t prod_tail = r->prod.tail;
-	uint32_t cons_tail = r->cons.tail;
-	return !!(cons_tail == prod_tail);
+	return __rte_ring_mc_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Return the number of entries in a ring.
+ * Dequeue several elements from a ring (NOT multi-consumers safe). When the
+ * request elements are more than the available elements, only dequeue the
+ * actual number of elements.
  *
  * @param r
- *   A pointer to the ring structure.
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
  * @return
- *   The number of entries in the ring.
+ *   - n: Actual number of elements dequeued, 0 if ring is empty
  */
-static inline unsigned
-rte_ring_count(const struct rte_ring *r)
+static inline unsigned __attribute__((always_inline))
+rte_ring_sc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
 {
-	uint32_t prod_tail = r->prod.tail;
-	uint32_t cons_tail = r->cons.tail;
-	return ((prod_tail - cons_tail) & r->prod.mask);
+	return __rte_ring_sc_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Return the number of free entries in a ring.
+ * Dequeue several elements from a ring up to a maximum number.
+ *
+ * This function calls the multi-consumers or the single-consumer
+ * version, depending on the default behaviour that was specified at
+ * ring creation time (see flags).
  *
  * @param r
- *   A pointer to the ring structure.
+ *   A pointer to the ring structure, created with rte_ring_create_elem().
+ * @param obj_table
+ *   A pointer to a table of elements that will be filled.
+ * @param esize
+ *   The size of a ring element, in bytes. It must be equal to the size
+ *   given at ring creation.
+ * @param n
+ *   The number of elements to dequeue from the ring to the obj_table.
  * @return
- *   The number of free entries in the ring.
+ *   - Number of elements dequeued
  */
-static inline unsigned
-rte_ring_free_count(const struct rte_ring *r)
+static inline unsigned __attribute__((always_inline))
+rte_ring_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n)
 {
-	uint32_t prod_tail = r->prod.tail;
-	uint32_t cons_tail = r->cons.tail;
-	return ((cons_tail - prod_tail - 1) & r->prod.mask);
+	return __rte_ring_do_dequeue_elem(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Dump the status of all rings on the console
- *
- * @param f
- *   A pointer to a file for output
+ * Ring slots handed out by the zero-copy API.
+ *
+ * The zero-copy API is only available for rings of object pointers.
+ * The reserved slots are not necessarily contiguous in memory: when the
+ * reservation crosses the end of the ring[] table, the first *n1* slots
+ * start at *ptr1* and the remaining ones start at *ptr2* (which points
+ * to the beginning of the ring[] table). When no wrap-around occurs,
+ * *ptr2* is NULL and all slots are in *ptr1*. When nothing is reserved,
+ * *n1* is 0.
  */
-void rte_ring_list_dump(FILE *f);
+struct rte_ring_zc_data {
+	void **ptr1;      /**< First contiguous chunk of ring slots. */
+	unsigned n1;      /**< Number of slots in the first chunk. */
+	void **ptr2;      /**< Second chunk after wrap-around, or NULL. */
+};
+
+/* fill the zero-copy descriptor for n slots starting at index head */
+#define ZC_FILL_SLOTS(zcd, head, n) do { \
+	const uint32_t size = r->prod.size; \
+	uint32_t idx = (head) & r->prod.mask; \
+	(zcd)->ptr1 = &r->ring[idx]; \
+	if (likely(idx + (n) <= size)) { \
+		(zcd)->n1 = (n); \
+		(zcd)->ptr2 = NULL; \
+	} else { \
+		(zcd)->n1 = size - idx; \
+		(zcd)->ptr2 = &r->ring[0]; \
+	} \
+} while (0)
 
 /**
- * Search a ring from its name
+ * @internal Reserve slots in a ring for a zero-copy enqueue (NOT
+ * multi-producers safe).
  *
- * @param name
- *   The name of the ring.
+ * The producer head is moved forward, so that the reserved slots cannot
+ * be handed out twice, but the producer tail is left untouched: the
+ * consumer does not see the objects until
+ * rte_ring_sp_enqueue_zc_finish() is called.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of slots to reserve.
+ * @param zcd
+ *   A pointer to a structure filled with the reserved slots.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Reserve a fixed number of slots
+ *   RTE_RING_QUEUE_VARIABLE: Reserve as many slots as possible
  * @return
- *   The pointer to the ring matching the name, or NULL if not found,
- *   with rte_errno set appropriately. Possible rte_errno values include:
- *    - ENOENT - required entry not available to return.
+ *   - Actual number of slots reserved (0 or n if behavior is
+ *     RTE_RING_QUEUE_FIXED).
  */
-struct rte_ring *rte_ring_lookup(const char *name);
+static inline unsigned __attribute__((always_inline))
+__rte_ring_sp_do_enqueue_zc_start(struct rte_ring *r, unsigned n,
+		struct rte_ring_zc_data *zcd,
+		enum rte_ring_queue_behavior behavior)
+{
+	uint32_t prod_head, cons_tail;
+	uint32_t free_entries;
+	uint32_t mask = r->prod.mask;
+
+	prod_head = r->prod.tail;
+	cons_tail = r->cons.tail;
+	/* The subtraction is done between two unsigned 32bits value
+	 * (the result is always modulo 32 bits even if we have
+	 * prod_head > cons_tail). So 'free_entries' is always between 0
+	 * and size(ring)-1. */
+	free_entries = mask + cons_tail - prod_head;
+
+	/* check that we have enough room in ring */
+	if (unlikely(n > free_entries)) {
+		if (behavior == RTE_RING_QUEUE_FIXED || free_entries == 0) {
+			__RING_STAT_ADD(r, enq_fail, n);
+			n = 0;
+		} else
+			n = free_entries;
+	}
+
+	r->prod.head = prod_head + n;
+	ZC_FILL_SLOTS(zcd, prod_head, n);
+	return n;
+}
 
 /**
- * Enqueue several objects on the ring (multi-producers safe).
+ * @internal Reserve objects of a ring for a zero-copy dequeue (NOT
+ * multi-consumers safe).
  *
- * This function uses a "compare and set" instruction to move the
- * producer index atomically.
+ * The consumer head is moved forward but the consumer tail is left
+ * untouched: the producer cannot overwrite the slots until
+ * rte_ring_sc_dequeue_zc_finish() is called.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
  * @param n
- *   The number of objects to add in the ring from the obj_table.
+ *   The number of objects to reserve.
+ * @param zcd
+ *   A pointer to a structure filled with the reserved slots.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Reserve a fixed number of objects
+ *   RTE_RING_QUEUE_VARIABLE: Reserve as many objects as possible
  * @return
- *   - n: Actual number of objects enqueued.
+ *   - Actual number of objects reserved (0 or n if behavior is
+ *     RTE_RING_QUEUE_FIXED).
  */
 static inline unsigned __attribute__((always_inline))
-rte_ring_mp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
-			 unsigned n)
+__rte_ring_sc_do_dequeue_zc_start(struct rte_ring *r, unsigned n,
+		struct rte_ring_zc_data *zcd,
+		enum rte_ring_queue_behavior behavior)
 {
-	return __rte_ring_mp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	uint32_t cons_head, prod_tail;
+	uint32_t entries;
+
+	cons_head = r->cons.tail;
+	prod_tail = r->prod.tail;
+	/* The subtraction is done between two unsigned 32bits value
+	 * (the result is always modulo 32 bits even if we have
+	 * cons_head > prod_tail). So 'entries' is always between 0
+	 * and size(ring)-1. */
+	entries = prod_tail - cons_head;
+
+	if (n > entries) {
+		if (behavior == RTE_RING_QUEUE_FIXED || entries == 0) {
+			__RING_STAT_ADD(r, deq_fail, n);
+			n = 0;
+		} else
+			n = entries;
+	}
+
+	r->cons.head = cons_head + n;
+	/* make sure the slots are read after prod.tail */
+	rte_compiler_barrier();
+	ZC_FILL_SLOTS(zcd, cons_head, n);
+	return n;
 }
 
 /**
- * Enqueue several objects on a ring (NOT multi-producers safe).
+ * Reserve slots in a ring for a zero-copy enqueue (NOT multi-producers
+ * safe).
+ *
+ * Instead of copying object pointers from a table, the caller gets
+ * pointers to the ring slots themselves (see struct rte_ring_zc_data)
+ * and writes the objects directly in them. The objects are made visible
+ * to the consumer by rte_ring_sp_enqueue_zc_finish(). Between the two
+ * calls, no other enqueue may be done on the ring. The high water mark
+ * is not checked by the zero-copy API.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
  * @param n
- *   The number of objects to add in the ring from the obj_table.
+ *   The number of slots to reserve.
+ * @param zcd
+ *   A pointer to a structure filled with the reserved slots.
  * @return
- *   - n: Actual number of objects enqueued.
+ *   - n: Success; slots reserved.
+ *   - 0: Not enough room in the ring; no slot is reserved.
  */
 static inline unsigned __attribute__((always_inline))
-rte_ring_sp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
-			 unsigned n)
+rte_ring_sp_enqueue_zc_bulk_start(struct rte_ring *r, unsigned n,
+		struct rte_ring_zc_data *zcd)
 {
-	return __rte_ring_sp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_sp_do_enqueue_zc_start(r, n, zcd,
+			RTE_RING_QUEUE_FIXED);
 }
 
 /**
- * Enqueue several objects on a ring.
+ * Reserve up to *n* slots in a ring for a zero-copy enqueue (NOT
+ * multi-producers safe).
  *
- * This function calls the multi-producer or the single-producer
- * version depending on the default behavior that was specified at
- * ring creation time (see flags).
+ * Same as rte_ring_sp_enqueue_zc_bulk_start(), but reserve as many slots
+ * as possible when there is not enough room for *n* objects.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
  * @param n
- *   The number of objects to add in the ring from the obj_table.
+ *   The maximum number of slots to reserve.
+ * @param zcd
+ *   A pointer to a structure filled with the reserved slots.
  * @return
- *   - n: Actual number of objects enqueued.
+ *   - Actual number of slots reserved, 0 if the ring is full.
  */
 static inline unsigned __attribute__((always_inline))
-rte_ring_enqueue_burst(struct rte_ring *r, void * const *obj_table,
-		      unsigned n)
+rte_ring_sp_enqueue_zc_burst_start(struct rte_ring *r, unsigned n,
+		struct rte_ring_zc_data *zcd)
 {
-	if (r->prod.sp_enqueue)
-		return rte_ring_sp_enqueue_burst(r, obj_table, n);
-	else
-		return rte_ring_mp_enqueue_burst(r, obj_table, n);
+	return __rte_ring_sp_do_enqueue_zc_start(r, n, zcd,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Dequeue several objects from a ring (multi-consumers safe). When the request
- * objects are more than the available objects, only dequeue the actual number
- * of objects
+ * Complete a zero-copy enqueue (NOT multi-producers safe).
  *
- * This function uses a "compare and set" instruction to move the
- * consumer index atomically.
+ * The first *n* reserved slots are made visible to the consumer. *n* can
+ * be lower than the number of slots returned by the start function, in
+ * which case the remaining slots are given back to the ring.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
  * @param n
- *   The number of objects to dequeue from the ring to the obj_table.
- * @return
- *   - n: Actual number of objects dequeued, 0 if ring is empty
+ *   The number of objects written in the reserved slots.
  */
-static inline unsigned __attribute__((always_inline))
-rte_ring_mc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+static inline void __attribute__((always_inline))
+rte_ring_sp_enqueue_zc_finish(struct rte_ring *r, unsigned n)
 {
-	return __rte_ring_mc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	uint32_t prod_next = r->prod.tail + n;
+
+	r->prod.head = prod_next;
+	/* the objects must be written before they are seen by the consumer */
+	rte_compiler_barrier();
+	__RING_STAT_ADD(r, enq_success, n);
+	r->prod.tail = prod_next;
 }
 
 /**
- * Dequeue several objects from a ring (NOT multi-consumers safe).When the
- * request objects are more than the available objects, only dequeue the
- * actual number of objects
+ * Reserve objects of a ring for a zero-copy dequeue (NOT multi-consumers
+ * safe).
+ *
+ * Instead of copying object pointers to a table, the caller gets
+ * pointers to the ring slots holding the objects (see struct
+ * rte_ring_zc_data) and can process them in place. The slots are given
+ * back to the producer by rte_ring_sc_dequeue_zc_finish(). Between the
+ * two calls, no other dequeue may be done on the ring.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
  * @param n
- *   The number of objects to dequeue from the ring to the obj_table.
+ *   The number of objects to reserve.
+ * @param zcd
+ *   A pointer to a structure filled with the reserved slots.
  * @return
- *   - n: Actual number of objects dequeued, 0 if ring is empty
+ *   - n: Success; objects reserved.
+ *   - 0: Not enough entries in the ring; no object is reserved.
  */
 static inline unsigned __attribute__((always_inline))
-rte_ring_sc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+rte_ring_sc_dequeue_zc_bulk_start(struct rte_ring *r, unsigned n,
+		struct rte_ring_zc_data *zcd)
 {
-	return __rte_ring_sc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_sc_do_dequeue_zc_start(r, n, zcd,
+			RTE_RING_QUEUE_FIXED);
 }
 
 /**
- * Dequeue multiple objects from a ring up to a maximum number.
+ * Reserve up to *n* objects of a ring for a zero-copy dequeue (NOT
+ * multi-consumers safe).
  *
- * This function calls the multi-consumers or the single-consumer
- * version, depending on the default behaviour that was specified at
- * ring creation time (see flags).
+ * Same as rte_ring_sc_dequeue_zc_bulk_start(), but reserve as many
+ * objects as available when the ring holds less than *n* objects.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
  * @param n
- *   The number of objects to dequeue from the ring to the obj_table.
+ *   The maximum number of objects to reserve.
+ * @param zcd
+ *   A pointer to a structure filled with the reserved slots.
  * @return
- *   - Number of objects dequeued
+ *   - Actual number of objects reserved, 0 if the ring is empty.
  */
 static inline unsigned __attribute__((always_inline))
-rte_ring_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+rte_ring_sc_dequeue_zc_burst_start(struct rte_ring *r, unsigned n,
+		struct rte_ring_zc_data *zcd)
 {
-	if (r->cons.sc_dequeue)
-		return rte_ring_sc_dequeue_burst(r, obj_table, n);
-	else
-		return rte_ring_mc_dequeue_burst(r, obj_table, n);
+	return __rte_ring_sc_do_dequeue_zc_start(r, n, zcd,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Complete a zero-copy dequeue (NOT multi-consumers safe).
+ *
+ * The first *n* reserved objects are removed from the ring. *n* can be
+ * lower than the number of objects returned by the start function, in
+ * which case the remaining objects are left in the ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param n
+ *   The number of objects consumed from the reserved slots.
+ */
+static inline void __attribute__((always_inline))
+rte_ring_sc_dequeue_zc_finish(struct rte_ring *r, unsigned n)
+{
+	uint32_t cons_next = r->cons.tail + n;
+
+	r->cons.head = cons_next;
+	/* the slots must be read before they are given back to the producer */
+	rte_compiler_barrier();
+	__RING_STAT_ADD(r, deq_success, n);
+	r->cons.tail = cons_next;
 }
 
 #ifdef __cplusplus
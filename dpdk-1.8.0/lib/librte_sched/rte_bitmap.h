@@ -62,6 +62,14 @@ extern "C" {
  * enforced by the caller, while the bit get operation does not require locking
  * the bitmap.
  *
+ * The rte_bitmap_set_atomic(), rte_bitmap_clear_atomic() and
+ * rte_bitmap_scan_atomic() variants relax the single writer rule: bits can be
+ * set by any thread while a single thread is clearing bits and scanning the
+ * bitmap at the same time. These variants are more expensive, as every update
+ * of array1 and array2 slabs is done with a locked read-modify-write
+ * instruction, and they must not be mixed with the non-atomic set/clear
+ * operations on the same bitmap instance while both threads are active.
+ *
  ***/
 
 #include <rte_common.h>
@@ -459,6 +467,94 @@ rte_bitmap_clear(struct rte_bitmap *bmp, uint32_t pos)
 	return;
 }
 
+/**
+ * Bitmap bit set (atomic)
+ *
+ * Can be called by any thread while another thread is calling
+ * rte_bitmap_clear_atomic() and rte_bitmap_scan_atomic() on the same bitmap.
+ *
+ * @param bmp
+ *   Handle to bitmap instance
+ * @param pos
+ *   Bit position
+ */
+static inline void
+rte_bitmap_set_atomic(struct rte_bitmap *bmp, uint32_t pos)
+{
+	uint64_t *slab1, *slab2;
+	uint32_t index1, index2, offset1, offset2;
+
+	index2 = pos >> RTE_BITMAP_SLAB_BIT_SIZE_LOG2;
+	offset2 = pos & RTE_BITMAP_SLAB_BIT_MASK;
+	index1 = pos >>
+		(RTE_BITMAP_SLAB_BIT_SIZE_LOG2 + RTE_BITMAP_CL_BIT_SIZE_LOG2);
+	offset1 = (pos >> RTE_BITMAP_CL_BIT_SIZE_LOG2) &
+		RTE_BITMAP_SLAB_BIT_MASK;
+	slab2 = bmp->array2 + index2;
+	slab1 = bmp->array1 + index1;
+
+	/* array2 first, so that a set bit in array1 never hides an update */
+	__sync_fetch_and_or(slab2, 1lu << offset2);
+	__sync_fetch_and_or(slab1, 1lu << offset1);
+}
+
+static inline void
+__rte_bitmap_line_clear_atomic(struct rte_bitmap *bmp, uint32_t index2)
+{
+	uint64_t *slab1, *slab2;
+	uint32_t index1, offset1;
+
+	index2 &= ~ RTE_BITMAP_CL_SLAB_MASK;
+	slab2 = bmp->array2 + index2;
+	index1 = index2 >>
+		(RTE_BITMAP_CL_SLAB_SIZE_LOG2 + RTE_BITMAP_SLAB_BIT_SIZE_LOG2);
+	offset1 = (index2 >> RTE_BITMAP_CL_SLAB_SIZE_LOG2) &
+		RTE_BITMAP_SLAB_BIT_MASK;
+	slab1 = bmp->array1 + index1;
+
+	__sync_fetch_and_and(slab1, ~(1lu << offset1));
+
+	/* A concurrent set may have had its array1 update cleared above */
+	if (unlikely(__rte_bitmap_line_not_empty(slab2))) {
+		__sync_fetch_and_or(slab1, 1lu << offset1);
+	}
+}
+
+/**
+ * Bitmap bit clear (atomic)
+ *
+ * Can be called by one thread while another thread is calling
+ * rte_bitmap_set_atomic() on the same bitmap.
+ *
+ * @param bmp
+ *   Handle to bitmap instance
+ * @param pos
+ *   Bit position
+ */
+static inline void
+rte_bitmap_clear_atomic(struct rte_bitmap *bmp, uint32_t pos)
+{
+	uint64_t *slab2;
+	uint32_t index2, offset2;
+
+	index2 = pos >> RTE_BITMAP_SLAB_BIT_SIZE_LOG2;
+	offset2 = pos & RTE_BITMAP_SLAB_BIT_MASK;
+	slab2 = bmp->array2 + index2;
+
+	/* Return if array2 slab is not all-zeros */
+	if (__sync_and_and_fetch(slab2, ~(1lu << offset2))) {
+		return;
+	}
+
+	/* Return if the array2 cache line is not all-zeros */
+	if (__rte_bitmap_line_not_empty(bmp->array2 +
+			(index2 & ~ RTE_BITMAP_CL_SLAB_MASK))) {
+		return;
+	}
+
+	__rte_bitmap_line_clear_atomic(bmp, index2);
+}
+
 static inline int
 __rte_bitmap_scan_search(struct rte_bitmap *bmp)
 {
@@ -556,6 +652,50 @@ rte_bitmap_scan(struct rte_bitmap *bmp, uint32_t *pos, uint64_t *slab)
 	return 0;
 }
 
+/**
+ * Bitmap scan (atomic, with automatic wrap-around)
+ *
+ * Same as rte_bitmap_scan(), but can be called by one thread while another
+ * thread is calling rte_bitmap_set_atomic() on the same bitmap. A concurrent
+ * set operation can leave an array1 bit set for an all-zeros array2 cache
+ * line; when such a line is found, its array1 bit is cleared and 0 is returned
+ * for the current call.
+ *
+ * @param bmp
+ *   Handle to bitmap instance
+ * @param pos
+ *   When function call returns 1, pos contains the position of the next set
+ *   bit, otherwise not modified
+ * @param slab
+ *   When function call returns 1, slab contains the value of the entire 64-bit
+ *   slab where the bit indicated by pos is located, otherwise not modified
+ * @return
+ *   0 if no bit set was found, 1 otherwise
+ */
+static inline int
+rte_bitmap_scan_atomic(struct rte_bitmap *bmp, uint32_t *pos, uint64_t *slab)
+{
+	/* Return data from current array2 line if available */
+	if (__rte_bitmap_scan_read(bmp, pos, slab)) {
+		return 1;
+	}
+
+	/* Look for non-empty array2 line */
+	if (__rte_bitmap_scan_search(bmp)) {
+		__rte_bitmap_scan_read_init(bmp);
+		if (likely(__rte_bitmap_scan_read(bmp, pos, slab))) {
+			return 1;
+		}
+
+		/* Stale array1 bit */
+		__rte_bitmap_line_clear_atomic(bmp,
+			((bmp->index1 << RTE_BITMAP_SLAB_BIT_SIZE_LOG2) +
+			bmp->offset1) << RTE_BITMAP_CL_SLAB_SIZE_LOG2);
+	}
+
+	return 0;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -42,6 +42,7 @@
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
 #include <rte_mbuf.h>
+#include <rte_ring.h>
 
 #include "rte_sched.h"
 #include "rte_bitmap.h"
@@ -102,32 +103,29 @@
 
 #define RTE_SCHED_BMP_POS_INVALID             UINT32_MAX
 
-struct rte_sched_subport {
-	/* Token bucket (TB) */
-	uint64_t tb_time; /* time of last update */
-	uint32_t tb_period;
-	uint32_t tb_credits_per_period;
-	uint32_t tb_size;
-	uint32_t tb_credits;
+#define RTE_SCHED_PORT_FLAGS_MASK             \
+	(RTE_SCHED_PORT_FLAG_ENQ_DEQ_SPLIT | RTE_SCHED_PORT_FLAG_SUBPORT_PARALLEL)
 
-	/* Traffic classes (TCs) */
-	uint64_t tc_time; /* time of next update */
-	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t tc_period;
+/* Number of entries of each subport output queue (parallel subport mode) */
+#ifndef RTE_SCHED_SUBPORT_OUT_SIZE
+#define RTE_SCHED_SUBPORT_OUT_SIZE            256
+#endif
+#if (RTE_SCHED_SUBPORT_OUT_SIZE == 0) || (RTE_SCHED_SUBPORT_OUT_SIZE & (RTE_SCHED_SUBPORT_OUT_SIZE - 1))
+#error Subport output queue size must be non-zero and a power of 2
+#endif
 
-	/* TC oversubscription */
-	uint32_t tc_ov_wm;
-	uint32_t tc_ov_wm_min;
-	uint32_t tc_ov_wm_max;
-	uint8_t tc_ov_period_id;
-	uint8_t tc_ov;
-	uint32_t tc_ov_n;
-	double tc_ov_rate;
+/* Maximum number of packets moved by one subport schedule call */
+#define RTE_SCHED_SUBPORT_SCHEDULE_MAX        64
 
-	/* Statistics */
-	struct rte_sched_subport_stats stats;
-};
+/* Maximum number of packets read from one subport output queue per merge round */
+#ifndef RTE_SCHED_PORT_MERGE_BURST
+#define RTE_SCHED_PORT_MERGE_BURST            8
+#endif
+
+/* How far (in MTUs) the port merge is allowed to run ahead of the CPU time */
+#ifndef RTE_SCHED_PORT_MERGE_MTUS
+#define RTE_SCHED_PORT_MERGE_MTUS             32
+#endif
 
 struct rte_sched_pipe_profile {
 	/* Token bucket (TB) */
@@ -166,8 +164,8 @@ struct rte_sched_pipe {
 } __rte_cache_aligned;
 
 struct rte_sched_queue {
-	uint16_t qw;
-	uint16_t qr;
+	volatile uint16_t qw;
+	volatile uint16_t qr;
 };
 
 struct rte_sched_queue_extra {
@@ -195,7 +193,6 @@ struct rte_sched_grinder {
 	enum grinder_state state;
 	uint32_t productive;
 	uint32_t pindex;
-	struct rte_sched_subport *subport;
 	struct rte_sched_pipe *pipe;
 	struct rte_sched_pipe_profile *pipe_params;
 
@@ -221,6 +218,56 @@ struct rte_sched_grinder {
 	uint8_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
 };
 
+struct rte_sched_subport {
+	/* Token bucket (TB) */
+	uint64_t tb_time; /* time of last update */
+	uint32_t tb_period;
+	uint32_t tb_credits_per_period;
+	uint32_t tb_size;
+	uint32_t tb_credits;
+
+	/* Traffic classes (TCs) */
+	uint64_t tc_time; /* time of next update */
+	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_period;
+
+	/* TC oversubscription */
+	uint32_t tc_ov_wm;
+	uint32_t tc_ov_wm_min;
+	uint32_t tc_ov_wm_max;
+	uint8_t tc_ov_period_id;
+	uint8_t tc_ov;
+	uint32_t tc_ov_n;
+	double tc_ov_rate;
+
+	/* Statistics (written by the enqueue side) */
+	struct rte_sched_subport_stats stats __rte_cache_aligned;
+
+	/* Timing */
+	uint64_t time_cpu_cycles __rte_cache_aligned; /* Current CPU time measured in CPU cyles */
+	uint64_t time_cpu_bytes;      /* Current CPU time measured in bytes */
+	uint64_t time;                /* Current NIC TX time measured in bytes */
+
+	/* Scheduling loop detection */
+	uint32_t pipe_loop;
+	uint32_t pipe_exhaustion;
+
+	/* Bitmap */
+	struct rte_bitmap *bmp;
+	uint32_t qindex_base;
+	uint32_t grinder_base_bmp_pos[RTE_SCHED_PORT_N_GRINDERS] __rte_aligned_16;
+
+	/* Grinders */
+	struct rte_sched_grinder grinder[RTE_SCHED_PORT_N_GRINDERS];
+	uint32_t busy_grinders;
+	struct rte_mbuf **pkts_out;
+	uint32_t n_pkts_out;
+
+	/* Output queue (parallel subport mode) */
+	struct rte_ring *out;
+} __rte_cache_aligned;
+
 struct rte_sched_port {
 	/* User parameters */
 	uint32_t n_subports_per_port;
@@ -231,6 +278,8 @@ struct rte_sched_port {
 	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
 	uint32_t n_pipe_profiles;
 	uint32_t pipe_tc3_rate_max;
+	uint32_t flags;
+	uint32_t n_queues_per_subport_log2;
 #ifdef RTE_SCHED_RED
 	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS];
 #endif
@@ -241,19 +290,8 @@ struct rte_sched_port {
 	uint64_t time;                /* Current NIC TX time measured in bytes */
 	double cycles_per_byte;       /* CPU cycles per byte */
 
-	/* Scheduling loop detection */
-	uint32_t pipe_loop;
-	uint32_t pipe_exhaustion;
-
-	/* Bitmap */
-	struct rte_bitmap *bmp;
-	uint32_t grinder_base_bmp_pos[RTE_SCHED_PORT_N_GRINDERS] __rte_aligned_16;
-
-	/* Grinders */
-	struct rte_sched_grinder grinder[RTE_SCHED_PORT_N_GRINDERS];
-	uint32_t busy_grinders;
-	struct rte_mbuf **pkts_out;
-	uint32_t n_pkts_out;
+	/* Subport round robin (dequeue and merge) */
+	uint32_t subport_id;
 
 	/* Queue base calculation */
 	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE];
@@ -267,6 +305,7 @@ struct rte_sched_port {
 	struct rte_sched_pipe_profile *pipe_profiles;
 	uint8_t *bmp_array;
 	struct rte_mbuf **queue_array;
+	uint8_t *subport_out_array;
 	uint8_t memory[0] __rte_cache_aligned;
 } __rte_cache_aligned;
 
@@ -278,25 +317,40 @@ enum rte_sched_port_array {
 	e_RTE_SCHED_PORT_ARRAY_PIPE_PROFILES,
 	e_RTE_SCHED_PORT_ARRAY_BMP_ARRAY,
 	e_RTE_SCHED_PORT_ARRAY_QUEUE_ARRAY,
+	e_RTE_SCHED_PORT_ARRAY_SUBPORT_OUT,
 	e_RTE_SCHED_PORT_ARRAY_TOTAL,
 };
 
-#ifdef RTE_SCHED_COLLECT_STATS
-
 static inline uint32_t
 rte_sched_port_queues_per_subport(struct rte_sched_port *port)
 {
 	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport;
 }
 
-#endif
-
 static inline uint32_t
 rte_sched_port_queues_per_port(struct rte_sched_port *port)
 {
 	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport * port->n_subports_per_port;
 }
 
+static inline struct rte_sched_subport *
+rte_sched_port_subport(struct rte_sched_port *port, uint32_t qindex)
+{
+	return port->subport + (qindex >> port->n_queues_per_subport_log2);
+}
+
+/* Time base used by the scheduler of the given subport: the subports share the
+ * port time, unless each of them is scheduled by its own lcore */
+static inline uint64_t
+rte_sched_subport_time(struct rte_sched_port *port, struct rte_sched_subport *s)
+{
+	if (port->flags & RTE_SCHED_PORT_FLAG_SUBPORT_PARALLEL) {
+		return s->time;
+	}
+
+	return port->time;
+}
+
 static int
 rte_sched_port_check_params(struct rte_sched_port_params *params)
 {
@@ -387,6 +441,11 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 		}
 	}
 
+	/* flags */
+	if (params->flags & ~RTE_SCHED_PORT_FLAGS_MASK) {
+		return -16;
+	}
+
 	return 0;
 }
 
@@ -396,15 +455,18 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 	uint32_t n_subports_per_port = params->n_subports_per_port;
 	uint32_t n_pipes_per_subport = params->n_pipes_per_subport;
 	uint32_t n_pipes_per_port = n_pipes_per_subport * n_subports_per_port;
-	uint32_t n_queues_per_port = RTE_SCHED_QUEUES_PER_PIPE * n_pipes_per_subport * n_subports_per_port;
+	uint32_t n_queues_per_subport = RTE_SCHED_QUEUES_PER_PIPE * n_pipes_per_subport;
+	uint32_t n_queues_per_port = n_queues_per_subport * n_subports_per_port;
 
 	uint32_t size_subport = n_subports_per_port * sizeof(struct rte_sched_subport);
 	uint32_t size_pipe = n_pipes_per_port * sizeof(struct rte_sched_pipe);
 	uint32_t size_queue = n_queues_per_port * sizeof(struct rte_sched_queue);
 	uint32_t size_queue_extra = n_queues_per_port * sizeof(struct rte_sched_queue_extra);
 	uint32_t size_pipe_profiles = RTE_SCHED_PIPE_PROFILES_PER_PORT * sizeof(struct rte_sched_pipe_profile);
-	uint32_t size_bmp_array = rte_bitmap_get_memory_footprint(n_queues_per_port);
+	uint32_t size_bmp_array = n_subports_per_port *
+		RTE_CACHE_LINE_ROUNDUP(rte_bitmap_get_memory_footprint(n_queues_per_subport));
 	uint32_t size_per_pipe_queue_array, size_queue_array;
+	uint32_t size_subport_out = 0;
 
 	uint32_t base, i;
 
@@ -413,6 +475,10 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 		size_per_pipe_queue_array += RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * params->qsize[i] * sizeof(struct rte_mbuf *);
 	}
 	size_queue_array = n_pipes_per_port * size_per_pipe_queue_array;
+	if (params->flags & RTE_SCHED_PORT_FLAG_SUBPORT_PARALLEL) {
+		size_subport_out = n_subports_per_port *
+			RTE_CACHE_LINE_ROUNDUP(rte_ring_get_memsize(RTE_SCHED_SUBPORT_OUT_SIZE));
+	}
 
 	base = 0;
 
@@ -437,6 +503,9 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 	if (array == e_RTE_SCHED_PORT_ARRAY_QUEUE_ARRAY) return base;
 	base += RTE_CACHE_LINE_ROUNDUP(size_queue_array);
 
+	if (array == e_RTE_SCHED_PORT_ARRAY_SUBPORT_OUT) return base;
+	base += RTE_CACHE_LINE_ROUNDUP(size_subport_out);
+
 	return base;
 }
 
@@ -608,7 +677,7 @@ struct rte_sched_port *
 rte_sched_port_config(struct rte_sched_port_params *params)
 {
 	struct rte_sched_port *port = NULL;
-	uint32_t mem_size, bmp_mem_size, n_queues_per_port, i;
+	uint32_t mem_size, bmp_mem_size, n_queues_per_subport, i;
 
 	/* Check user parameters. Determine the amount of memory to allocate */
 	mem_size = rte_sched_port_get_memory_footprint(params);
@@ -630,6 +699,11 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->frame_overhead = params->frame_overhead;
 	memcpy(port->qsize, params->qsize, sizeof(params->qsize));
 	port->n_pipe_profiles = params->n_pipe_profiles;
+	port->flags = params->flags;
+	if (port->flags & RTE_SCHED_PORT_FLAG_SUBPORT_PARALLEL) {
+		port->flags |= RTE_SCHED_PORT_FLAG_ENQ_DEQ_SPLIT;
+	}
+	port->n_queues_per_subport_log2 = __builtin_ctz(rte_sched_port_queues_per_subport(port));
 
 #ifdef RTE_SCHED_RED
 	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
@@ -653,14 +727,8 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->time = 0;
 	port->cycles_per_byte = ((double) rte_get_tsc_hz()) / ((double) params->rate);
 
-	/* Scheduling loop detection */
-	port->pipe_loop = RTE_SCHED_PIPE_INVALID;
-	port->pipe_exhaustion = 0;
-
-	/* Grinders */
-	port->busy_grinders = 0;
-	port->pkts_out = NULL;
-	port->n_pkts_out = 0;
+	/* Subport round robin */
+	port->subport_id = 0;
 
 	/* Queue base calculation */
 	rte_sched_port_config_qsize(port);
@@ -673,20 +741,56 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	port->pipe_profiles = (struct rte_sched_pipe_profile *) (port->memory + rte_sched_port_get_array_base(params, e_RTE_SCHED_PORT_ARRAY_PIPE_PROFILES));
 	port->bmp_array =  port->memory + rte_sched_port_get_array_base(params, e_RTE_SCHED_PORT_ARRAY_BMP_ARRAY);
 	port->queue_array = (struct rte_mbuf **) (port->memory + rte_sched_port_get_array_base(params, e_RTE_SCHED_PORT_ARRAY_QUEUE_ARRAY));
+	port->subport_out_array = port->memory + rte_sched_port_get_array_base(params, e_RTE_SCHED_PORT_ARRAY_SUBPORT_OUT);
 
 	/* Pipe profile table */
 	rte_sched_port_config_pipe_profile_table(port, params);
 
-	/* Bitmap */
-	n_queues_per_port = rte_sched_port_queues_per_port(port);
-	bmp_mem_size = rte_bitmap_get_memory_footprint(n_queues_per_port);
-	port->bmp = rte_bitmap_init(n_queues_per_port, port->bmp_array, bmp_mem_size);
-	if (port->bmp == NULL) {
-		RTE_LOG(INFO, SCHED, "Bitmap init error\n");
-		return NULL;
-	}
-	for (i = 0; i < RTE_SCHED_PORT_N_GRINDERS; i ++) {
-		port->grinder_base_bmp_pos[i] = RTE_SCHED_PIPE_INVALID;
+	/* Subport scheduling state: each subport has its own bitmap and grinders */
+	n_queues_per_subport = rte_sched_port_queues_per_subport(port);
+	bmp_mem_size = rte_bitmap_get_memory_footprint(n_queues_per_subport);
+	for (i = 0; i < port->n_subports_per_port; i ++) {
+		struct rte_sched_subport *s = port->subport + i;
+		uint32_t j;
+
+		/* Timing */
+		s->time_cpu_cycles = port->time_cpu_cycles;
+		s->time_cpu_bytes = 0;
+		s->time = 0;
+
+		/* Scheduling loop detection */
+		s->pipe_loop = RTE_SCHED_PIPE_INVALID;
+		s->pipe_exhaustion = 0;
+
+		/* Bitmap */
+		s->bmp = rte_bitmap_init(n_queues_per_subport,
+			port->bmp_array + i * RTE_CACHE_LINE_ROUNDUP(bmp_mem_size), bmp_mem_size);
+		if (s->bmp == NULL) {
+			RTE_LOG(INFO, SCHED, "Bitmap init error\n");
+			rte_free(port);
+			return NULL;
+		}
+		s->qindex_base = i * n_queues_per_subport;
+		for (j = 0; j < RTE_SCHED_PORT_N_GRINDERS; j ++) {
+			s->grinder_base_bmp_pos[j] = RTE_SCHED_PIPE_INVALID;
+		}
+
+		/* Grinders */
+		s->busy_grinders = 0;
+		s->pkts_out = NULL;
+		s->n_pkts_out = 0;
+
+		/* Output queue */
+		if (port->flags & RTE_SCHED_PORT_FLAG_SUBPORT_PARALLEL) {
+			s->out = (struct rte_ring *) (port->subport_out_array +
+				i * RTE_CACHE_LINE_ROUNDUP(rte_ring_get_memsize(RTE_SCHED_SUBPORT_OUT_SIZE)));
+			if (rte_ring_init(s->out, "sched_subport_out", RTE_SCHED_SUBPORT_OUT_SIZE,
+				RING_F_SP_ENQ | RING_F_SC_DEQ) != 0) {
+				RTE_LOG(INFO, SCHED, "Subport output queue init error\n");
+				rte_free(port);
+				return NULL;
+			}
+		}
 	}
 
 	return port;
@@ -695,12 +799,16 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 void
 rte_sched_port_free(struct rte_sched_port *port)
 {
+	uint32_t i;
+
 	/* Check user parameters */
 	if (port == NULL){
 		return;
 	}
 
-	rte_bitmap_free(port->bmp);
+	for (i = 0; i < port->n_subports_per_port; i ++) {
+		rte_bitmap_free(port->subport[i].bmp);
+	}
 	rte_free(port);
 }
 
@@ -778,7 +886,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		rte_approx(tb_rate, d, &s->tb_credits_per_period, &s->tb_period);
 	}
 	s->tb_size = params->tb_size;
-	s->tb_time = port->time;
+	s->tb_time = rte_sched_subport_time(port, s);
 	s->tb_credits = s->tb_size / 2;
 
 	/* Traffic Classes (TCs) */
@@ -786,7 +894,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
 		s->tc_credits_per_period[i] = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, params->tc_rate[i]);
 	}
-	s->tc_time = port->time + s->tc_period;
+	s->tc_time = rte_sched_subport_time(port, s) + s->tc_period;
 	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
 		s->tc_credits[i] = s->tc_credits_per_period[i];
 	}
@@ -869,11 +977,11 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 	params = port->pipe_profiles + p->profile;
 
 	/* Token Bucket (TB) */
-	p->tb_time = port->time;
+	p->tb_time = rte_sched_subport_time(port, s);
 	p->tb_credits = params->tb_size / 2;
 
 	/* Traffic Classes (TCs) */
-	p->tc_time = port->time + params->tc_period;
+	p->tc_time = rte_sched_subport_time(port, s) + params->tc_period;
 	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
 		p->tc_credits[i] = params->tc_credits_per_period[i];
 	}
@@ -1072,11 +1180,13 @@ rte_sched_port_red_drop(struct rte_sched_port *port, struct rte_mbuf *pkt, uint3
 	qe = port->queue_extra + qindex;
 	red = &qe->red;
 
-	return rte_red_enqueue(red_cfg, red, qlen, port->time);
+	return rte_red_enqueue(red_cfg, red, qlen,
+		rte_sched_subport_time(port, rte_sched_port_subport(port, qindex)));
 }
 
 static inline void
-rte_sched_port_set_queue_empty_timestamp(struct rte_sched_port *port, uint32_t qindex)
+rte_sched_port_set_queue_empty_timestamp(struct rte_sched_port *port,
+	struct rte_sched_subport *subport, uint32_t qindex)
 {
 	struct rte_sched_queue_extra *qe;
     struct rte_red *red;
@@ -1084,14 +1194,14 @@ rte_sched_port_set_queue_empty_timestamp(struct rte_sched_port *port, uint32_t q
 	qe = port->queue_extra + qindex;
 	red = &qe->red;
 
-	rte_red_mark_queue_empty(red, port->time);
+	rte_red_mark_queue_empty(red, subport->time);
 }
 
 #else
 
 #define rte_sched_port_red_drop(port, pkt, qindex, qlen)             0
 
-#define rte_sched_port_set_queue_empty_timestamp(port, qindex)
+#define rte_sched_port_set_queue_empty_timestamp(port, subport, qindex)
 
 #endif /* RTE_SCHED_RED */
 
@@ -1106,7 +1216,8 @@ debug_pipe_is_empty(struct rte_sched_port *port, uint32_t pindex)
 
 	for (i = 0; i < 16; i ++){
 		uint32_t queue_empty = rte_sched_port_queue_is_empty(port, qindex + i);
-		uint32_t bmp_bit_clear = (rte_bitmap_get(port->bmp, qindex + i) == 0);
+		struct rte_sched_subport *s = rte_sched_port_subport(port, qindex + i);
+		uint32_t bmp_bit_clear = (rte_bitmap_get(s->bmp, qindex + i - s->qindex_base) == 0);
 
 		if (queue_empty != bmp_bit_clear){
 			rte_panic("Queue status mismatch for queue %u of pipe %u\n", i, pindex);
@@ -1173,6 +1284,7 @@ rte_sched_port_enqueue_qptrs_prefetch0(struct rte_sched_port *port, struct rte_m
 static inline void
 rte_sched_port_enqueue_qwa_prefetch0(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf **qbase)
 {
+	struct rte_sched_subport *s;
 	struct rte_sched_queue *q;
 	struct rte_mbuf **q_qw;
 	uint16_t qsize;
@@ -1182,12 +1294,14 @@ rte_sched_port_enqueue_qwa_prefetch0(struct rte_sched_port *port, uint32_t qinde
 	q_qw = qbase + (q->qw & (qsize - 1));
 
 	rte_prefetch0(q_qw);
-	rte_bitmap_prefetch0(port->bmp, qindex);
+	s = rte_sched_port_subport(port, qindex);
+	rte_bitmap_prefetch0(s->bmp, qindex - s->qindex_base);
 }
 
 static inline int
 rte_sched_port_enqueue_qwa(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf **qbase, struct rte_mbuf *pkt)
 {
+	struct rte_sched_subport *s;
 	struct rte_sched_queue *q;
 	uint16_t qsize;
 	uint16_t qlen;
@@ -1206,12 +1320,18 @@ rte_sched_port_enqueue_qwa(struct rte_sched_port *port, uint32_t qindex, struct
 		return 0;
 	}
 
-	/* Enqueue packet */
+	/* Enqueue packet, making it visible before the write pointer update */
 	qbase[q->qw & (qsize - 1)] = pkt;
+	rte_compiler_barrier();
 	q->qw ++;
 
-	/* Activate queue in the port bitmap */
-	rte_bitmap_set(port->bmp, qindex);
+	/* Activate queue in the subport bitmap */
+	s = rte_sched_port_subport(port, qindex);
+	if (port->flags & RTE_SCHED_PORT_FLAG_ENQ_DEQ_SPLIT) {
+		rte_bitmap_set_atomic(s->bmp, qindex - s->qindex_base);
+	} else {
+		rte_bitmap_set(s->bmp, qindex - s->qindex_base);
+	}
 
 	/* Statistics */
 #ifdef RTE_SCHED_COLLECT_STATS
@@ -1416,57 +1536,54 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 
 #if RTE_SCHED_TS_CREDITS_UPDATE == 0
 
-#define grinder_credits_update(port, pos)
+#define grinder_credits_update(port, subport, pos)
 
 #elif !defined(RTE_SCHED_SUBPORT_TC_OV)
 
 static inline void
-grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
+grinder_credits_update(__rte_unused struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
-	struct rte_sched_subport *subport = grinder->subport;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *params = grinder->pipe_params;
 	uint64_t n_periods;
 
 	/* Subport TB */
-	n_periods = (port->time - subport->tb_time) / subport->tb_period;
+	n_periods = (subport->time - subport->tb_time) / subport->tb_period;
 	subport->tb_credits += n_periods * subport->tb_credits_per_period;
 	subport->tb_credits = rte_sched_min_val_2_u32(subport->tb_credits, subport->tb_size);
 	subport->tb_time += n_periods * subport->tb_period;
 
 	/* Pipe TB */
-	n_periods = (port->time - pipe->tb_time) / params->tb_period;
+	n_periods = (subport->time - pipe->tb_time) / params->tb_period;
 	pipe->tb_credits += n_periods * params->tb_credits_per_period;
 	pipe->tb_credits = rte_sched_min_val_2_u32(pipe->tb_credits, params->tb_size);
 	pipe->tb_time += n_periods * params->tb_period;
 
 	/* Subport TCs */
-	if (unlikely(port->time >= subport->tc_time)) {
+	if (unlikely(subport->time >= subport->tc_time)) {
 		subport->tc_credits[0] = subport->tc_credits_per_period[0];
 		subport->tc_credits[1] = subport->tc_credits_per_period[1];
 		subport->tc_credits[2] = subport->tc_credits_per_period[2];
 		subport->tc_credits[3] = subport->tc_credits_per_period[3];
-		subport->tc_time = port->time + subport->tc_period;
+		subport->tc_time = subport->time + subport->tc_period;
 	}
 
 	/* Pipe TCs */
-	if (unlikely(port->time >= pipe->tc_time)) {
+	if (unlikely(subport->time >= pipe->tc_time)) {
 		pipe->tc_credits[0] = params->tc_credits_per_period[0];
 		pipe->tc_credits[1] = params->tc_credits_per_period[1];
 		pipe->tc_credits[2] = params->tc_credits_per_period[2];
 		pipe->tc_credits[3] = params->tc_credits_per_period[3];
-		pipe->tc_time = port->time + params->tc_period;
+		pipe->tc_time = subport->time + params->tc_period;
 	}
 }
 
 #else
 
 static inline uint32_t
-grinder_tc_ov_credits_update(struct rte_sched_port *port, uint32_t pos)
+grinder_tc_ov_credits_update(struct rte_sched_port *port, struct rte_sched_subport *subport, __rte_unused uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
-	struct rte_sched_subport *subport = grinder->subport;
 	uint32_t tc_ov_consumption[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
 	uint32_t tc_ov_consumption_max;
 	uint32_t tc_ov_wm = subport->tc_ov_wm;
@@ -1499,46 +1616,45 @@ grinder_tc_ov_credits_update(struct rte_sched_port *port, uint32_t pos)
 }
 
 static inline void
-grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
+grinder_credits_update(struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
-	struct rte_sched_subport *subport = grinder->subport;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *params = grinder->pipe_params;
 	uint64_t n_periods;
 
 	/* Subport TB */
-	n_periods = (port->time - subport->tb_time) / subport->tb_period;
+	n_periods = (subport->time - subport->tb_time) / subport->tb_period;
 	subport->tb_credits += n_periods * subport->tb_credits_per_period;
 	subport->tb_credits = rte_sched_min_val_2_u32(subport->tb_credits, subport->tb_size);
 	subport->tb_time += n_periods * subport->tb_period;
 
 	/* Pipe TB */
-	n_periods = (port->time - pipe->tb_time) / params->tb_period;
+	n_periods = (subport->time - pipe->tb_time) / params->tb_period;
 	pipe->tb_credits += n_periods * params->tb_credits_per_period;
 	pipe->tb_credits = rte_sched_min_val_2_u32(pipe->tb_credits, params->tb_size);
 	pipe->tb_time += n_periods * params->tb_period;
 
 	/* Subport TCs */
-	if (unlikely(port->time >= subport->tc_time)) {
-		subport->tc_ov_wm = grinder_tc_ov_credits_update(port, pos);
+	if (unlikely(subport->time >= subport->tc_time)) {
+		subport->tc_ov_wm = grinder_tc_ov_credits_update(port, subport, pos);
 
 		subport->tc_credits[0] = subport->tc_credits_per_period[0];
 		subport->tc_credits[1] = subport->tc_credits_per_period[1];
 		subport->tc_credits[2] = subport->tc_credits_per_period[2];
 		subport->tc_credits[3] = subport->tc_credits_per_period[3];
 
-		subport->tc_time = port->time + subport->tc_period;
+		subport->tc_time = subport->time + subport->tc_period;
 		subport->tc_ov_period_id ++;
 	}
 
 	/* Pipe TCs */
-	if (unlikely(port->time >= pipe->tc_time)) {
+	if (unlikely(subport->time >= pipe->tc_time)) {
 		pipe->tc_credits[0] = params->tc_credits_per_period[0];
 		pipe->tc_credits[1] = params->tc_credits_per_period[1];
 		pipe->tc_credits[2] = params->tc_credits_per_period[2];
 		pipe->tc_credits[3] = params->tc_credits_per_period[3];
-		pipe->tc_time = port->time + params->tc_period;
+		pipe->tc_time = subport->time + params->tc_period;
 	}
 
 	/* Pipe TCs - Oversubscription */
@@ -1556,10 +1672,9 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 #ifndef RTE_SCHED_SUBPORT_TC_OV
 
 static inline int
-grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
+grinder_credits_check(struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
-	struct rte_sched_subport *subport = grinder->subport;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_mbuf *pkt = grinder->pkt;
 	uint32_t tc_index = grinder->tc_index;
@@ -1592,10 +1707,9 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 #else
 
 static inline int
-grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
+grinder_credits_check(struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
-	struct rte_sched_subport *subport = grinder->subport;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_mbuf *pkt = grinder->pkt;
 	uint32_t tc_index = grinder->tc_index;
@@ -1635,37 +1749,50 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 #endif /* RTE_SCHED_TS_CREDITS_CHECK */
 
 static inline int
-grinder_schedule(struct rte_sched_port *port, uint32_t pos)
+grinder_schedule(struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_sched_queue *queue = grinder->queue[grinder->qpos];
 	struct rte_mbuf *pkt = grinder->pkt;
 	uint32_t pkt_len = pkt->pkt_len + port->frame_overhead;
 
 #if RTE_SCHED_TS_CREDITS_CHECK
-	if (!grinder_credits_check(port, pos)) {
+	if (!grinder_credits_check(port, subport, pos)) {
 		return 0;
 	}
 #endif
 
 	/* Advance port time */
-	port->time += pkt_len;
+	subport->time += pkt_len;
 
 	/* Send packet */
-	port->pkts_out[port->n_pkts_out ++] = pkt;
+	subport->pkts_out[subport->n_pkts_out ++] = pkt;
 	queue->qr ++;
 	grinder->wrr_tokens[grinder->qpos] += pkt_len * grinder->wrr_cost[grinder->qpos];
 	if (queue->qr == queue->qw) {
 		uint32_t qindex = grinder->qindex[grinder->qpos];
+		uint32_t bmp_pos = qindex - subport->qindex_base;
+
+		if (port->flags & RTE_SCHED_PORT_FLAG_ENQ_DEQ_SPLIT) {
+			rte_bitmap_clear_atomic(subport->bmp, bmp_pos);
 
-		rte_bitmap_clear(port->bmp, qindex);
+			/* Reactivate the queue if a packet was enqueued in the meantime */
+			if (unlikely(queue->qr != queue->qw)) {
+				rte_bitmap_set_atomic(subport->bmp, bmp_pos);
+			}
+		} else {
+			rte_bitmap_clear(subport->bmp, bmp_pos);
+		}
 		grinder->qmask &= ~(1 << grinder->qpos);
 		grinder->wrr_mask[grinder->qpos] = 0;
-		rte_sched_port_set_queue_empty_timestamp(port, qindex);
+		rte_sched_port_set_queue_empty_timestamp(port, subport, qindex);
 	}
 
+	/* Read the queue write pointer before any of the queue entries */
+	rte_compiler_barrier();
+
 	/* Reset pipe loop detection */
-	port->pipe_loop = RTE_SCHED_PIPE_INVALID;
+	subport->pipe_loop = RTE_SCHED_PIPE_INVALID;
 	grinder->productive = 1;
 
 	return 1;
@@ -1674,12 +1801,12 @@ grinder_schedule(struct rte_sched_port *port, uint32_t pos)
 #if RTE_SCHED_OPTIMIZATIONS
 
 static inline int
-grinder_pipe_exists(struct rte_sched_port *port, uint32_t base_pipe)
+grinder_pipe_exists(struct rte_sched_subport *subport, uint32_t base_pipe)
 {
 	__m128i index = _mm_set1_epi32 (base_pipe);
-	__m128i pipes = _mm_load_si128((__m128i *)port->grinder_base_bmp_pos);
+	__m128i pipes = _mm_load_si128((__m128i *)subport->grinder_base_bmp_pos);
 	__m128i res = _mm_cmpeq_epi32(pipes, index);
-	pipes = _mm_load_si128((__m128i *)(port->grinder_base_bmp_pos + 4));
+	pipes = _mm_load_si128((__m128i *)(subport->grinder_base_bmp_pos + 4));
 	pipes = _mm_cmpeq_epi32(pipes, index);
 	res = _mm_or_si128(res, pipes);
 
@@ -1692,12 +1819,12 @@ grinder_pipe_exists(struct rte_sched_port *port, uint32_t base_pipe)
 #else
 
 static inline int
-grinder_pipe_exists(struct rte_sched_port *port, uint32_t base_pipe)
+grinder_pipe_exists(struct rte_sched_subport *subport, uint32_t base_pipe)
 {
 	uint32_t i;
 
 	for (i = 0; i < RTE_SCHED_PORT_N_GRINDERS; i ++) {
-		if (port->grinder_base_bmp_pos[i] == base_pipe) {
+		if (subport->grinder_base_bmp_pos[i] == base_pipe) {
 			return 1;
 		}
 	}
@@ -1708,9 +1835,9 @@ grinder_pipe_exists(struct rte_sched_port *port, uint32_t base_pipe)
 #endif /* RTE_SCHED_OPTIMIZATIONS */
 
 static inline void
-grinder_pcache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t bmp_pos, uint64_t bmp_slab)
+grinder_pcache_populate(__rte_unused struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos, uint32_t bmp_pos, uint64_t bmp_slab)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	uint16_t w[4];
 
 	grinder->pcache_w = 0;
@@ -1739,9 +1866,9 @@ grinder_pcache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t bmp_
 }
 
 static inline void
-grinder_tccache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t qindex, uint16_t qmask)
+grinder_tccache_populate(__rte_unused struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos, uint32_t qindex, uint16_t qmask)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	uint8_t b[4];
 
 	grinder->tccache_w = 0;
@@ -1770,9 +1897,9 @@ grinder_tccache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t qin
 }
 
 static inline int
-grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
+grinder_next_tc(struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_mbuf **qbase;
 	uint32_t qindex;
 	uint16_t qsize;
@@ -1809,9 +1936,9 @@ grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
 }
 
 static inline int
-grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
+grinder_next_pipe(struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	uint32_t pipe_qindex;
 	uint16_t pipe_qmask;
 
@@ -1824,23 +1951,27 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 		uint32_t bmp_pos = 0;
 
 		/* Get another non-empty pipe group */
-		if (unlikely(rte_bitmap_scan(port->bmp, &bmp_pos, &bmp_slab) <= 0)) {
+		if (port->flags & RTE_SCHED_PORT_FLAG_ENQ_DEQ_SPLIT) {
+			if (unlikely(rte_bitmap_scan_atomic(subport->bmp, &bmp_pos, &bmp_slab) <= 0)) {
+				return 0;
+			}
+		} else if (unlikely(rte_bitmap_scan(subport->bmp, &bmp_pos, &bmp_slab) <= 0)) {
 			return 0;
 		}
 
 #if RTE_SCHED_DEBUG
-		debug_check_queue_slab(port, bmp_pos, bmp_slab);
+		debug_check_queue_slab(port, subport->qindex_base + bmp_pos, bmp_slab);
 #endif
 
 		/* Return if pipe group already in one of the other grinders */
-		port->grinder_base_bmp_pos[pos] = RTE_SCHED_BMP_POS_INVALID;
-		if (unlikely(grinder_pipe_exists(port, bmp_pos))) {
+		subport->grinder_base_bmp_pos[pos] = RTE_SCHED_BMP_POS_INVALID;
+		if (unlikely(grinder_pipe_exists(subport, bmp_pos))) {
 			return 0;
 		}
-		port->grinder_base_bmp_pos[pos] = bmp_pos;
+		subport->grinder_base_bmp_pos[pos] = bmp_pos;
 
 		/* Install new pipe group into grinder's pipe cache */
-		grinder_pcache_populate(port, pos, bmp_pos, bmp_slab);
+		grinder_pcache_populate(port, subport, pos, subport->qindex_base + bmp_pos, bmp_slab);
 
 		pipe_qmask = grinder->pcache_qmask[0];
 		pipe_qindex = grinder->pcache_qindex[0];
@@ -1849,18 +1980,17 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 
 	/* Install new pipe in the grinder */
 	grinder->pindex = pipe_qindex >> 4;
-	grinder->subport = port->subport + (grinder->pindex / port->n_pipes_per_subport);
 	grinder->pipe = port->pipe + grinder->pindex;
 	grinder->pipe_params = NULL; /* to be set after the pipe structure is prefetched */
 	grinder->productive = 0;
 
-	grinder_tccache_populate(port, pos, pipe_qindex, pipe_qmask);
-	grinder_next_tc(port, pos);
+	grinder_tccache_populate(port, subport, pos, pipe_qindex, pipe_qmask);
+	grinder_next_tc(port, subport, pos);
 
 	/* Check for pipe exhaustion */
-	if (grinder->pindex == port->pipe_loop) {
-		port->pipe_exhaustion = 1;
-		port->pipe_loop = RTE_SCHED_PIPE_INVALID;
+	if (grinder->pindex == subport->pipe_loop) {
+		subport->pipe_exhaustion = 1;
+		subport->pipe_loop = RTE_SCHED_PIPE_INVALID;
 	}
 
 	return 1;
@@ -1868,14 +1998,14 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 
 #if RTE_SCHED_WRR == 0
 
-#define grinder_wrr_load(a,b)
+#define grinder_wrr_load(a,b,c)
 
-#define grinder_wrr_store(a,b)
+#define grinder_wrr_store(a,b,c)
 
 static inline void
-grinder_wrr(struct rte_sched_port *port, uint32_t pos)
+grinder_wrr(struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	uint64_t slab = grinder->qmask;
 
 	if (rte_bsf64(slab, &grinder->qpos) == 0) {
@@ -1886,9 +2016,9 @@ grinder_wrr(struct rte_sched_port *port, uint32_t pos)
 #elif RTE_SCHED_WRR == 1
 
 static inline void
-grinder_wrr_load(struct rte_sched_port *port, uint32_t pos)
+grinder_wrr_load(__rte_unused struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *pipe_params = grinder->pipe_params;
 	uint32_t tc_index = grinder->tc_index;
@@ -1914,9 +2044,9 @@ grinder_wrr_load(struct rte_sched_port *port, uint32_t pos)
 }
 
 static inline void
-grinder_wrr_store(struct rte_sched_port *port, uint32_t pos)
+grinder_wrr_store(__rte_unused struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	uint32_t tc_index = grinder->tc_index;
 	uint32_t qindex;
@@ -1930,9 +2060,9 @@ grinder_wrr_store(struct rte_sched_port *port, uint32_t pos)
 }
 
 static inline void
-grinder_wrr(struct rte_sched_port *port, uint32_t pos)
+grinder_wrr(__rte_unused struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	uint16_t wrr_tokens_min;
 
 	grinder->wrr_tokens[0] |= ~grinder->wrr_mask[0];
@@ -1955,21 +2085,21 @@ grinder_wrr(struct rte_sched_port *port, uint32_t pos)
 
 #endif /* RTE_SCHED_WRR */
 
-#define grinder_evict(port, pos)
+#define grinder_evict(port, subport, pos)
 
 static inline void
-grinder_prefetch_pipe(struct rte_sched_port *port, uint32_t pos)
+grinder_prefetch_pipe(__rte_unused struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 
 	rte_prefetch0(grinder->pipe);
 	rte_prefetch0(grinder->queue[0]);
 }
 
 static inline void
-grinder_prefetch_tc_queue_arrays(struct rte_sched_port *port, uint32_t pos)
+grinder_prefetch_tc_queue_arrays(struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	uint16_t qsize, qr[4];
 
 	qsize = grinder->qsize;
@@ -1981,17 +2111,17 @@ grinder_prefetch_tc_queue_arrays(struct rte_sched_port *port, uint32_t pos)
 	rte_prefetch0(grinder->qbase[0] + qr[0]);
 	rte_prefetch0(grinder->qbase[1] + qr[1]);
 
-	grinder_wrr_load(port, pos);
-	grinder_wrr(port, pos);
+	grinder_wrr_load(port, subport, pos);
+	grinder_wrr(port, subport, pos);
 
 	rte_prefetch0(grinder->qbase[2] + qr[2]);
 	rte_prefetch0(grinder->qbase[3] + qr[3]);
 }
 
 static inline void
-grinder_prefetch_mbuf(struct rte_sched_port *port, uint32_t pos)
+grinder_prefetch_mbuf(__rte_unused struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 	uint32_t qpos = grinder->qpos;
 	struct rte_mbuf **qbase = grinder->qbase[qpos];
 	uint16_t qsize = grinder->qsize;
@@ -2008,16 +2138,16 @@ grinder_prefetch_mbuf(struct rte_sched_port *port, uint32_t pos)
 }
 
 static inline uint32_t
-grinder_handle(struct rte_sched_port *port, uint32_t pos)
+grinder_handle(struct rte_sched_port *port, struct rte_sched_subport *subport, uint32_t pos)
 {
-	struct rte_sched_grinder *grinder = port->grinder + pos;
+	struct rte_sched_grinder *grinder = subport->grinder + pos;
 
 	switch (grinder->state) {
 	case e_GRINDER_PREFETCH_PIPE:
 	{
-		if (grinder_next_pipe(port, pos)) {
-			grinder_prefetch_pipe(port, pos);
-			port->busy_grinders ++;
+		if (grinder_next_pipe(port, subport, pos)) {
+			grinder_prefetch_pipe(port, subport, pos);
+			subport->busy_grinders ++;
 
 			grinder->state = e_GRINDER_PREFETCH_TC_QUEUE_ARRAYS;
 			return 0;
@@ -2031,8 +2161,8 @@ grinder_handle(struct rte_sched_port *port, uint32_t pos)
 		struct rte_sched_pipe *pipe = grinder->pipe;
 
 		grinder->pipe_params = port->pipe_profiles + pipe->profile;
-		grinder_prefetch_tc_queue_arrays(port, pos);
-		grinder_credits_update(port, pos);
+		grinder_prefetch_tc_queue_arrays(port, subport, pos);
+		grinder_credits_update(port, subport, pos);
 
 		grinder->state = e_GRINDER_PREFETCH_MBUF;
 		return 0;
@@ -2040,7 +2170,7 @@ grinder_handle(struct rte_sched_port *port, uint32_t pos)
 
 	case e_GRINDER_PREFETCH_MBUF:
 	{
-		grinder_prefetch_mbuf(port, pos);
+		grinder_prefetch_mbuf(port, subport, pos);
 
 		grinder->state = e_GRINDER_READ_MBUF;
 		return 0;
@@ -2050,39 +2180,39 @@ grinder_handle(struct rte_sched_port *port, uint32_t pos)
 	{
 		uint32_t result = 0;
 
-		result = grinder_schedule(port, pos);
+		result = grinder_schedule(port, subport, pos);
 
 		/* Look for next packet within the same TC */
 		if (result && grinder->qmask) {
-			grinder_wrr(port, pos);
-			grinder_prefetch_mbuf(port, pos);
+			grinder_wrr(port, subport, pos);
+			grinder_prefetch_mbuf(port, subport, pos);
 
 			return 1;
 		}
-		grinder_wrr_store(port, pos);
+		grinder_wrr_store(port, subport, pos);
 
 		/* Look for another active TC within same pipe */
-		if (grinder_next_tc(port, pos)) {
-			grinder_prefetch_tc_queue_arrays(port, pos);
+		if (grinder_next_tc(port, subport, pos)) {
+			grinder_prefetch_tc_queue_arrays(port, subport, pos);
 
 			grinder->state = e_GRINDER_PREFETCH_MBUF;
 			return result;
 		}
-		if ((grinder->productive == 0) && (port->pipe_loop == RTE_SCHED_PIPE_INVALID)) {
-			port->pipe_loop = grinder->pindex;
+		if ((grinder->productive == 0) && (subport->pipe_loop == RTE_SCHED_PIPE_INVALID)) {
+			subport->pipe_loop = grinder->pindex;
 		}
-		grinder_evict(port, pos);
+		grinder_evict(port, subport, pos);
 
 		/* Look for another active pipe */
-		if (grinder_next_pipe(port, pos)) {
-			grinder_prefetch_pipe(port, pos);
+		if (grinder_next_pipe(port, subport, pos)) {
+			grinder_prefetch_pipe(port, subport, pos);
 
 			grinder->state = e_GRINDER_PREFETCH_TC_QUEUE_ARRAYS;
 			return result;
 		}
 
 		/* No active pipe found */
-		port->busy_grinders --;
+		subport->busy_grinders --;
 
 		grinder->state = e_GRINDER_PREFETCH_PIPE;
 		return result;
@@ -2107,44 +2237,137 @@ rte_sched_port_time_resync(struct rte_sched_port *port)
 	if (port->time < port->time_cpu_bytes) {
 		port->time = port->time_cpu_bytes;
 	}
+}
 
-	/* Reset pipe loop detection */
-	port->pipe_loop = RTE_SCHED_PIPE_INVALID;
+static inline void
+rte_sched_subport_time_resync(struct rte_sched_port *port, struct rte_sched_subport *subport)
+{
+	uint64_t cycles = rte_get_tsc_cycles();
+	uint64_t cycles_diff = cycles - subport->time_cpu_cycles;
+	double bytes_diff = ((double) cycles_diff) / port->cycles_per_byte;
+
+	/* Advance subport time */
+	subport->time_cpu_cycles = cycles;
+	subport->time_cpu_bytes += (uint64_t) bytes_diff;
+	if (subport->time < subport->time_cpu_bytes) {
+		subport->time = subport->time_cpu_bytes;
+	}
 }
 
 static inline int
-rte_sched_port_exceptions(struct rte_sched_port *port, int second_pass)
+rte_sched_subport_exceptions(struct rte_sched_subport *subport, int second_pass)
 {
 	int exceptions;
 
 	/* Check if any exception flag is set */
-	exceptions = (second_pass && port->busy_grinders == 0) ||
-		(port->pipe_exhaustion == 1);
+	exceptions = (second_pass && subport->busy_grinders == 0) ||
+		(subport->pipe_exhaustion == 1);
 
 	/* Clear exception flags */
-	port->pipe_exhaustion = 0;
+	subport->pipe_exhaustion = 0;
 
 	return exceptions;
 }
 
-int
-rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+static inline uint32_t
+rte_sched_subport_grind(struct rte_sched_port *port, struct rte_sched_subport *subport,
+	struct rte_mbuf **pkts, uint32_t n_pkts)
 {
 	uint32_t i, count;
 
-	port->pkts_out = pkts;
-	port->n_pkts_out = 0;
+	subport->pkts_out = pkts;
+	subport->n_pkts_out = 0;
 
-	rte_sched_port_time_resync(port);
+	/* Reset pipe loop detection */
+	subport->pipe_loop = RTE_SCHED_PIPE_INVALID;
 
 	/* Take each queue in the grinder one step further */
 	for (i = 0, count = 0; ; i ++)  {
-		count += grinder_handle(port, i & (RTE_SCHED_PORT_N_GRINDERS - 1));
+		count += grinder_handle(port, subport, i & (RTE_SCHED_PORT_N_GRINDERS - 1));
 		if ((count == n_pkts) ||
-		    rte_sched_port_exceptions(port, i >= RTE_SCHED_PORT_N_GRINDERS)) {
+		    rte_sched_subport_exceptions(subport, i >= RTE_SCHED_PORT_N_GRINDERS)) {
 			break;
 		}
 	}
 
 	return count;
 }
+
+int
+rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	uint32_t subport_id = port->subport_id;
+	uint32_t i, count;
+
+	rte_sched_port_time_resync(port);
+
+	/* Visit the subports in round robin order, all of them sharing the port time */
+	for (i = 0, count = 0; (i < port->n_subports_per_port) && (count < n_pkts); i ++) {
+		struct rte_sched_subport *subport = port->subport + subport_id;
+
+		subport->time = port->time;
+		count += rte_sched_subport_grind(port, subport, pkts + count, n_pkts - count);
+		port->time = subport->time;
+
+		subport_id = (subport_id + 1) & (port->n_subports_per_port - 1);
+	}
+	port->subport_id = subport_id;
+
+	return count;
+}
+
+int
+rte_sched_subport_schedule(struct rte_sched_port *port, uint32_t subport_id, uint32_t n_pkts)
+{
+	struct rte_sched_subport *subport = port->subport + subport_id;
+	struct rte_mbuf *pkts[RTE_SCHED_SUBPORT_SCHEDULE_MAX];
+	uint32_t n_free, count;
+
+	/* Never schedule more packets than the output queue can take */
+	n_free = rte_ring_free_count(subport->out);
+	n_pkts = rte_sched_min_val_2_u32(n_pkts, RTE_SCHED_SUBPORT_SCHEDULE_MAX);
+	n_pkts = rte_sched_min_val_2_u32(n_pkts, n_free);
+	if (n_pkts == 0) {
+		return 0;
+	}
+
+	rte_sched_subport_time_resync(port, subport);
+
+	count = rte_sched_subport_grind(port, subport, pkts, n_pkts);
+	if (count) {
+		rte_ring_sp_enqueue_bulk(subport->out, (void * const *) pkts, count);
+	}
+
+	return count;
+}
+
+int
+rte_sched_port_merge(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts)
+{
+	uint32_t subport_id = port->subport_id;
+	uint32_t n_empty, count;
+	uint64_t time_max;
+
+	/* The subports are shaped independently, so the port rate is enforced here */
+	rte_sched_port_time_resync(port);
+	time_max = port->time_cpu_bytes + RTE_SCHED_PORT_MERGE_MTUS * port->mtu;
+
+	for (count = 0, n_empty = 0;
+	     (count < n_pkts) && (n_empty < port->n_subports_per_port) && (port->time < time_max); ) {
+		struct rte_sched_subport *subport = port->subport + subport_id;
+		uint32_t n, i;
+
+		n = rte_sched_min_val_2_u32(n_pkts - count, RTE_SCHED_PORT_MERGE_BURST);
+		n = rte_ring_sc_dequeue_burst(subport->out, (void **) (pkts + count), n);
+		for (i = 0; i < n; i ++) {
+			port->time += pkts[count + i]->pkt_len + port->frame_overhead;
+		}
+		count += n;
+		n_empty = (n == 0) ? n_empty + 1 : 0;
+
+		subport_id = (subport_id + 1) & (port->n_subports_per_port - 1);
+	}
+	port->subport_id = subport_id;
+
+	return count;
+}
@@ -112,6 +112,17 @@ of struct rte_mbuf). */
 #define RTE_SCHED_FRAME_OVERHEAD_DEFAULT      24
 #endif
 
+/** Port flag: rte_sched_port_enqueue() and rte_sched_port_dequeue() are called
+from two different lcores. Enqueue for any given subport must still be done by
+a single lcore at a time. */
+#define RTE_SCHED_PORT_FLAG_ENQ_DEQ_SPLIT     0x1
+
+/** Port flag: each subport is scheduled by rte_sched_subport_schedule(), which
+can run for different subports on different lcores, while rte_sched_port_merge()
+collects the scheduled packets at the port rate. rte_sched_port_dequeue() is not
+available for the port. Implies RTE_SCHED_PORT_FLAG_ENQ_DEQ_SPLIT. */
+#define RTE_SCHED_PORT_FLAG_SUBPORT_PARALLEL  0x2
+
 /** Subport configuration parameters. The period and credits_per_period parameters are measured
 in bytes, with one byte meaning the time duration associated with the transmission of one byte
 on the physical medium of the output port, with pipe or pipe traffic class rate (measured as
@@ -193,6 +204,7 @@ struct rte_sched_port_params {
 #ifdef RTE_SCHED_RED
 	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS]; /**< RED parameters */
 #endif
+	uint32_t flags;                  /**< Bitmask of RTE_SCHED_PORT_FLAG_* values, 0 for single lcore operation */
 };
 
 /** Path through the scheduler hierarchy used by the scheduler enqueue operation to
@@ -435,6 +447,45 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 int
 rte_sched_port_dequeue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts);
 
+/**
+ * Hierarchical scheduler subport schedule. Runs the scheduler of a single subport
+ * and moves up to n_pkts packets from the subport queues to the subport output
+ * queue, from where they are collected by rte_sched_port_merge(). Only available
+ * when the port is configured with RTE_SCHED_PORT_FLAG_SUBPORT_PARALLEL. Different
+ * subports of the same port can be scheduled in parallel by different lcores, but
+ * any given subport must be scheduled by a single lcore at a time.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param subport_id
+ *   Subport ID
+ * @param n_pkts
+ *   Maximum number of packets to schedule
+ * @return
+ *   Number of packets moved to the subport output queue
+ */
+int
+rte_sched_subport_schedule(struct rte_sched_port *port, uint32_t subport_id, uint32_t n_pkts);
+
+/**
+ * Hierarchical scheduler port merge. Reads up to n_pkts from the output queues of
+ * the port subports in round robin order and stores them in the pkts array,
+ * without exceeding the port rate. Only available when the port is configured
+ * with RTE_SCHED_PORT_FLAG_SUBPORT_PARALLEL. Must be called by a single lcore.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param pkts
+ *   Pre-allocated packet descriptor array where the packets read from the subport
+ *   output queues should be stored
+ * @param n_pkts
+ *   Number of packets to read
+ * @return
+ *   Number of packets successfully read and placed in the pkts array
+ */
+int
+rte_sched_port_merge(struct rte_sched_port *port, struct rte_mbuf **pkts, uint32_t n_pkts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -146,6 +146,129 @@ typedef int (*rte_table_op_entry_delete)(
 	int *key_found,
 	void *entry);
 
+/**
+ * Lookup table entry add bulk
+ *
+ * @param table
+ *   Handle to lookup table instance
+ * @param keys
+ *   Array containing n_keys lookup keys
+ * @param entries
+ *   Array containing n_keys entries, element i holds the data to be associated
+ *   with keys[i]. Each element has to point to a valid memory buffer where the
+ *   first entry_size bytes (table create parameter) are populated with the
+ *   data.
+ * @param n_keys
+ *   Number of keys to add
+ * @param key_found
+ *   Array of n_keys elements. After invocation, key_found[i] is set to a value
+ *   different than 0 if keys[i] was already present in the table and to 0 if
+ *   not.
+ * @param entries_ptr
+ *   Array of n_keys elements. After invocation, entries_ptr[i] stores the
+ *   handle to the table entry containing the data associated with keys[i], as
+ *   described for the single entry add operation, or NULL when keys[i] could
+ *   not be added to the table.
+ * @return
+ *   0 when all the keys were added successfully, otherwise the error code of
+ *   the first key that failed. A failure on one key does not prevent the
+ *   remaining keys from being added.
+ */
+typedef int (*rte_table_op_entry_add_bulk)(
+	void *table,
+	void **keys,
+	void **entries,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries_ptr);
+
+/**
+ * Lookup table entry delete bulk
+ *
+ * @param table
+ *   Handle to lookup table instance
+ * @param keys
+ *   Array containing n_keys lookup keys
+ * @param n_keys
+ *   Number of keys to delete
+ * @param key_found
+ *   Array of n_keys elements. After invocation, key_found[i] is set to a value
+ *   different than 0 if keys[i] was present in the table before the delete
+ *   operation was performed and to 0 if not.
+ * @param entries
+ *   Either NULL or array of n_keys elements. When keys[i] is found in the
+ *   table and entries[i] points to a valid buffer, the first entry_size bytes
+ *   (table create parameter) in entries[i] store a copy of the table entry
+ *   that contained the data associated with keys[i] before it was deleted.
+ * @return
+ *   0 on success, error code otherwise
+ */
+typedef int (*rte_table_op_entry_delete_bulk)(
+	void *table,
+	void **keys,
+	uint32_t n_keys,
+	int *key_found,
+	void **entries);
+
+/**
+ * Lookup table entry age report handler
+ *
+ * @param key
+ *   Key of the expired table entry
+ * @param entry
+ *   Handle to the expired table entry. When the entry is removed by the aging
+ *   operation, this handle is only valid until the handler returns.
+ * @param last_hit
+ *   Time stamp (CPU cycles) of the last lookup hit of the entry, or of the
+ *   last add operation for this key when more recent
+ * @param n_hits
+ *   Number of lookup hits of the entry since it was added to the table
+ * @param arg
+ *   Opaque parameter registered with the aging operation
+ */
+typedef void (*rte_table_age_report)(
+	void *key,
+	void *entry,
+	uint64_t last_hit,
+	uint64_t n_hits,
+	void *arg);
+
+/**
+ * Lookup table entry aging
+ *
+ * Incremental scan of the table for expired entries, i.e. entries not hit
+ * by any lookup since expire_time. Each invocation examines the next
+ * n_buckets buckets of the table, starting where the previous invocation
+ * stopped and wrapping around at the end of the table, so that the cost of
+ * each invocation is bounded and the scan can be spread between the
+ * processing of packet bursts.
+ *
+ * @param table
+ *   Handle to lookup table instance
+ * @param expire_time
+ *   Time stamp (CPU cycles): the entries with their last hit older than this
+ *   value are expired. Use UINT64_MAX to report all the table entries.
+ * @param n_buckets
+ *   Number of table buckets to examine. When bigger than the number of table
+ *   buckets, the entire table is examined exactly once.
+ * @param remove
+ *   When different than 0, the expired entries are deleted from the table
+ *   after being reported
+ * @param f_report
+ *   Handler called for each expired entry, can be NULL
+ * @param arg
+ *   Opaque parameter to be passed to f_report
+ * @return
+ *   Number of expired entries found on success, error code otherwise
+ */
+typedef int (*rte_table_op_age)(
+	void *table,
+	uint64_t expire_time,
+	uint32_t n_buckets,
+	int remove,
+	rte_table_age_report f_report,
+	void *arg);
+
 /**
  * Lookup table lookup
  *
@@ -193,6 +316,12 @@ struct rte_table_ops {
 	rte_table_op_entry_add f_add;       /**< Entry add */
 	rte_table_op_entry_delete f_delete; /**< Entry delete */
 	rte_table_op_lookup f_lookup;       /**< Lookup */
+	rte_table_op_entry_add_bulk f_add_bulk;       /**< Entry add bulk.
+		Optional, NULL when not supported by the table type */
+	rte_table_op_entry_delete_bulk f_delete_bulk; /**< Entry delete bulk.
+		Optional, NULL when not supported by the table type */
+	rte_table_op_age f_age;             /**< Entry aging. Optional, NULL
+		when not supported by the table type */
 };
 
 #ifdef __cplusplus
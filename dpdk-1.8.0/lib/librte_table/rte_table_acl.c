@@ -39,26 +39,48 @@
 #include <rte_memory.h>
 #include <rte_malloc.h>
 #include <rte_log.h>
+#include <rte_atomic.h>
 
 #include "rte_table_acl.h"
 #include <rte_ether.h>
 
+/* Rule position state flags */
+#define ACL_RULE_MAIN		0x1 /* rule is in the main low level table */
+#define ACL_RULE_MERGE		0x2 /* rule is in the table being merged */
+#define ACL_RULE_DELTA		0x4 /* rule is in the delta low level table */
+
+/* Merge states */
+enum {
+	ACL_MERGE_NONE = 0,
+	ACL_MERGE_STARTED,
+	ACL_MERGE_BUILT,
+	ACL_MERGE_FAILED,
+};
+
 struct rte_table_acl {
 	/* Low-level ACL table */
 	char name[2][RTE_ACL_NAMESIZE];
+	char delta_name[2][RTE_ACL_NAMESIZE];
 	struct rte_acl_param acl_params; /* for creating low level acl table */
 	struct rte_acl_config cfg; /* Holds the field definitions (metadata) */
 	struct rte_acl_ctx *ctx;
+	struct rte_acl_ctx *delta_ctx; /* Rules added since last merge */
+	struct rte_acl_ctx *merge_ctx; /* Table being rebuilt by merge */
+	volatile uint32_t merge_state;
 	uint32_t name_id;
+	uint32_t delta_name_id;
+	uint32_t n_deleted; /* Main table rules deleted since last merge */
 
 	/* Input parameters */
 	uint32_t n_rules;
+	uint32_t n_rules_delta;
 	uint32_t entry_size;
 
 	/* Internal tables */
 	uint8_t *action_table;
 	struct rte_acl_rule **acl_rule_list; /* Array of pointers to rules */
 	uint8_t *acl_rule_memory; /* Memory to store the rules */
+	uint8_t *acl_rule_state; /* ACL_RULE_* flags for each rule position */
 
 	/* Memory to store the action table and stack of free entries */
 	uint8_t memory[0] __rte_cache_aligned;
@@ -74,6 +96,7 @@ rte_table_acl_create(
 	struct rte_table_acl_params *p = (struct rte_table_acl_params *) params;
 	struct rte_table_acl *acl;
 	uint32_t action_table_size, acl_rule_list_size, acl_rule_memory_size;
+	uint32_t acl_rule_state_size;
 	uint32_t total_size;
 
 	RTE_BUILD_BUG_ON(((sizeof(struct rte_table_acl) % RTE_CACHE_LINE_SIZE)
@@ -99,6 +122,11 @@ rte_table_acl_create(
 			__func__);
 		return NULL;
 	}
+	if (p->n_rules_delta > p->n_rules) {
+		RTE_LOG(ERR, TABLE, "%s: Invalid value for n_rules_delta\n",
+			__func__);
+		return NULL;
+	}
 
 	entry_size = RTE_ALIGN(entry_size, sizeof(uint64_t));
 
@@ -108,8 +136,10 @@ rte_table_acl_create(
 		RTE_CACHE_LINE_ROUNDUP(p->n_rules * sizeof(struct rte_acl_rule *));
 	acl_rule_memory_size = RTE_CACHE_LINE_ROUNDUP(p->n_rules *
 		RTE_ACL_RULE_SZ(p->n_rule_fields));
+	acl_rule_state_size = RTE_CACHE_LINE_ROUNDUP(p->n_rules);
 	total_size = sizeof(struct rte_table_acl) + action_table_size +
-		acl_rule_list_size + acl_rule_memory_size;
+		acl_rule_list_size + acl_rule_memory_size +
+		acl_rule_state_size;
 
 	acl = rte_zmalloc_socket("TABLE", total_size, RTE_CACHE_LINE_SIZE,
 		socket_id);
@@ -125,11 +155,16 @@ rte_table_acl_create(
 		(struct rte_acl_rule **) &acl->memory[action_table_size];
 	acl->acl_rule_memory = (uint8_t *)
 		&acl->memory[action_table_size + acl_rule_list_size];
+	acl->acl_rule_state = &acl->memory[action_table_size +
+		acl_rule_list_size + acl_rule_memory_size];
 
 	/* Initialization of internal fields */
 	snprintf(acl->name[0], RTE_ACL_NAMESIZE, "%s_a", p->name);
 	snprintf(acl->name[1], RTE_ACL_NAMESIZE, "%s_b", p->name);
+	snprintf(acl->delta_name[0], RTE_ACL_NAMESIZE, "%s_da", p->name);
+	snprintf(acl->delta_name[1], RTE_ACL_NAMESIZE, "%s_db", p->name);
 	acl->name_id = 1;
+	acl->delta_name_id = 1;
 
 	acl->acl_params.name = acl->name[acl->name_id];
 	acl->acl_params.socket_id = socket_id;
@@ -142,8 +177,12 @@ rte_table_acl_create(
 		p->n_rule_fields * sizeof(struct rte_acl_field_def));
 
 	acl->ctx = NULL;
+	acl->delta_ctx = NULL;
+	acl->merge_ctx = NULL;
+	acl->merge_state = ACL_MERGE_NONE;
 
 	acl->n_rules = p->n_rules;
+	acl->n_rules_delta = p->n_rules_delta;
 	acl->entry_size = entry_size;
 
 	return acl;
@@ -163,6 +202,10 @@ rte_table_acl_free(void *table)
 	/* Free previously allocated resources */
 	if (acl->ctx != NULL)
 		rte_acl_free(acl->ctx);
+	if (acl->delta_ctx != NULL)
+		rte_acl_free(acl->delta_ctx);
+	if (acl->merge_ctx != NULL)
+		rte_acl_free(acl->merge_ctx);
 
 	rte_free(acl);
 
@@ -171,14 +214,24 @@ rte_table_acl_free(void *table)
 
 RTE_ACL_RULE_DEF(rte_pipeline_acl_rule, RTE_ACL_MAX_FIELDS);
 
+/*
+ * Create a low level ACL table and fill it with all the rules which have
+ * any of the *state* flags set, or with all the rules when *state* is 0.
+ * Positions of the added rules get *mark* flag set.
+ * No low level table is created when there are no such rules.
+ */
 static int
-rte_table_acl_build(struct rte_table_acl *acl, struct rte_acl_ctx **acl_ctx)
+rte_table_acl_fill(struct rte_table_acl *acl, const char *name,
+	uint8_t state, uint8_t mark, struct rte_acl_ctx **acl_ctx)
 {
 	struct rte_acl_ctx *ctx = NULL;
 	uint32_t n_rules, i;
 	int status;
 
+	*acl_ctx = NULL;
+
 	/* Create low level ACL table */
+	acl->acl_params.name = name;
 	ctx = rte_acl_create(&acl->acl_params);
 	if (ctx == NULL) {
 		RTE_LOG(ERR, TABLE, "%s: Cannot create low level ACL table\n",
@@ -189,40 +242,383 @@ rte_table_acl_build(struct rte_table_acl *acl, struct rte_acl_ctx **acl_ctx)
 	/* Add rules to low level ACL table */
 	n_rules = 0;
 	for (i = 1; i < acl->n_rules; i++) {
-		if (acl->acl_rule_list[i] != NULL) {
-			status = rte_acl_add_rules(ctx, acl->acl_rule_list[i],
-				1);
-			if (status != 0) {
-				RTE_LOG(ERR, TABLE,
-				"%s: Cannot add rule to low level ACL table\n",
-					__func__);
-				rte_acl_free(ctx);
-				return -1;
-			}
+		if (acl->acl_rule_list[i] == NULL ||
+			(state != 0 && (acl->acl_rule_state[i] & state) == 0))
+			continue;
 
-			n_rules++;
+		status = rte_acl_add_rules(ctx, acl->acl_rule_list[i], 1);
+		if (status != 0) {
+			RTE_LOG(ERR, TABLE,
+				"%s: Cannot add rule to low level ACL table\n",
+				__func__);
+			rte_acl_free(ctx);
+			for (i = 1; i < acl->n_rules; i++)
+				acl->acl_rule_state[i] &= ~mark;
+			return -1;
 		}
+
+		acl->acl_rule_state[i] |= mark;
+		n_rules++;
 	}
 
 	if (n_rules == 0) {
 		rte_acl_free(ctx);
-		*acl_ctx = NULL;
 		return 0;
 	}
 
+	*acl_ctx = ctx;
+	return 0;
+}
+
+static int
+rte_table_acl_build(struct rte_table_acl *acl, struct rte_acl_ctx *ctx)
+{
+	int status;
+
+	if (ctx == NULL)
+		return 0;
+
 	/* Build low level ACl table */
 	status = rte_acl_build(ctx, &acl->cfg);
 	if (status != 0) {
 		RTE_LOG(ERR, TABLE,
 			"%s: Cannot build the low level ACL table\n",
 			__func__);
-		rte_acl_free(ctx);
 		return -1;
 	}
 
 	rte_acl_dump(ctx);
 
-	*acl_ctx = ctx;
+	return 0;
+}
+
+static uint64_t
+rte_table_acl_field_value(const union rte_acl_field_types *v, uint8_t size)
+{
+	switch (size) {
+	case sizeof(uint8_t):
+		return v->u8;
+	case sizeof(uint16_t):
+		return v->u16;
+	case sizeof(uint32_t):
+		return v->u32;
+	default:
+		return v->u64;
+	}
+}
+
+/*
+ * Check whether there is any input that matches both rules.
+ */
+static int
+rte_table_acl_rules_overlap(struct rte_table_acl *acl,
+	const struct rte_acl_rule *r1, const struct rte_acl_rule *r2)
+{
+	const struct rte_acl_field *f1, *f2;
+	uint64_t v1, v2, m1, m2;
+	uint32_t bits, i;
+	uint8_t size;
+
+	f1 = ((const struct rte_pipeline_acl_rule *)r1)->field;
+	f2 = ((const struct rte_pipeline_acl_rule *)r2)->field;
+
+	for (i = 0; i < acl->cfg.num_fields; i++) {
+		size = acl->cfg.defs[i].size;
+		v1 = rte_table_acl_field_value(&f1[i].value, size);
+		v2 = rte_table_acl_field_value(&f2[i].value, size);
+		m1 = rte_table_acl_field_value(&f1[i].mask_range, size);
+		m2 = rte_table_acl_field_value(&f2[i].mask_range, size);
+
+		switch (acl->cfg.defs[i].type) {
+		case RTE_ACL_FIELD_TYPE_RANGE:
+			if (RTE_MAX(v1, v2) > RTE_MIN(m1, m2))
+				return 0;
+			break;
+
+		case RTE_ACL_FIELD_TYPE_MASK:
+			/* convert prefix lengths into bit masks */
+			bits = size * CHAR_BIT;
+			m1 = (m1 == 0) ? 0 : (UINT64_MAX << (bits - m1));
+			m2 = (m2 == 0) ? 0 : (UINT64_MAX << (bits - m2));
+			/* fall through */
+
+		default:
+			if (((v1 ^ v2) & m1 & m2) != 0)
+				return 0;
+			break;
+		}
+	}
+
+	return 1;
+}
+
+/*
+ * Select the rules for the delta table: the rules added since last merge
+ * and the rules of the main table which might have been hidden by one of
+ * the main table rules deleted since last merge. The latter let lookup
+ * fall back to the right rule when main table returns a deleted one.
+ * Returns number of the selected rules.
+ */
+static uint32_t
+rte_table_acl_delta_select(struct rte_table_acl *acl)
+{
+	const struct rte_acl_rule *deleted;
+	uint32_t n_rules, i, j;
+
+	n_rules = 0;
+	for (i = 1; i < acl->n_rules; i++) {
+		acl->acl_rule_state[i] &= ~ACL_RULE_DELTA;
+		if (acl->acl_rule_list[i] != NULL &&
+			(acl->acl_rule_state[i] & ACL_RULE_MAIN) == 0) {
+			acl->acl_rule_state[i] |= ACL_RULE_DELTA;
+			n_rules++;
+		}
+	}
+
+	if (acl->n_deleted == 0)
+		return n_rules;
+
+	for (i = 1; i < acl->n_rules; i++) {
+		if (acl->acl_rule_list[i] != NULL ||
+			(acl->acl_rule_state[i] & ACL_RULE_MAIN) == 0)
+			continue;
+
+		/* Main table still holds a copy of the deleted rule */
+		deleted = (const struct rte_acl_rule *)
+			&acl->acl_rule_memory[i * acl->acl_params.rule_size];
+
+		for (j = 1; j < acl->n_rules; j++) {
+			if (acl->acl_rule_list[j] == NULL ||
+				(acl->acl_rule_state[j] & (ACL_RULE_MAIN |
+				ACL_RULE_DELTA)) != ACL_RULE_MAIN ||
+				acl->acl_rule_list[j]->data.priority >
+				deleted->data.priority)
+				continue;
+
+			if (rte_table_acl_rules_overlap(acl,
+				acl->acl_rule_list[j], deleted)) {
+				acl->acl_rule_state[j] |= ACL_RULE_DELTA;
+				n_rules++;
+			}
+		}
+	}
+
+	return n_rules;
+}
+
+/*
+ * Rebuild the delta table from the rules selected by
+ * rte_table_acl_delta_select().
+ */
+static int
+rte_table_acl_delta_build(struct rte_table_acl *acl)
+{
+	struct rte_acl_ctx *ctx;
+	int status;
+
+	status = rte_table_acl_fill(acl,
+		acl->delta_name[acl->delta_name_id ^ 1],
+		ACL_RULE_DELTA, 0, &ctx);
+	if (status != 0)
+		return status;
+
+	status = rte_table_acl_build(acl, ctx);
+	if (status != 0) {
+		rte_acl_free(ctx);
+		return status;
+	}
+
+	/* Commit changes */
+	if (acl->delta_ctx != NULL)
+		rte_acl_free(acl->delta_ctx);
+	acl->delta_ctx = ctx;
+	acl->delta_name_id ^= 1;
+
+	return 0;
+}
+
+static void
+rte_table_acl_merge_abort(struct rte_table_acl *acl)
+{
+	uint32_t i;
+
+	if (acl->merge_ctx != NULL)
+		rte_acl_free(acl->merge_ctx);
+	acl->merge_ctx = NULL;
+
+	for (i = 1; i < acl->n_rules; i++)
+		acl->acl_rule_state[i] &= ~ACL_RULE_MERGE;
+
+	acl->merge_state = ACL_MERGE_NONE;
+}
+
+int
+rte_table_acl_merge_start(void *table)
+{
+	struct rte_table_acl *acl = (struct rte_table_acl *) table;
+	int status;
+
+	/* Check input parameters */
+	if (table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (acl->merge_state != ACL_MERGE_NONE) {
+		RTE_LOG(ERR, TABLE, "%s: Merge is already in progress\n",
+			__func__);
+		return -EBUSY;
+	}
+
+	status = rte_table_acl_fill(acl, acl->name[acl->name_id ^ 1],
+		0, ACL_RULE_MERGE, &acl->merge_ctx);
+	if (status != 0)
+		return -EINVAL;
+
+	acl->merge_state = ACL_MERGE_STARTED;
+	return 0;
+}
+
+int
+rte_table_acl_merge_build(void *table)
+{
+	struct rte_table_acl *acl = (struct rte_table_acl *) table;
+	int status;
+
+	/* Check input parameters */
+	if (table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (acl->merge_state != ACL_MERGE_STARTED) {
+		RTE_LOG(ERR, TABLE, "%s: Merge is not started\n", __func__);
+		return -EINVAL;
+	}
+
+	status = rte_table_acl_build(acl, acl->merge_ctx);
+
+	/* Make the built table visible before the state update */
+	rte_wmb();
+	acl->merge_state = (status == 0) ? ACL_MERGE_BUILT : ACL_MERGE_FAILED;
+
+	return (status == 0) ? 0 : -EINVAL;
+}
+
+int
+rte_table_acl_merge_finish(void *table)
+{
+	struct rte_table_acl *acl = (struct rte_table_acl *) table;
+	uint32_t n_deleted, i;
+	uint8_t state;
+
+	/* Check input parameters */
+	if (table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	switch (acl->merge_state) {
+	case ACL_MERGE_NONE:
+		RTE_LOG(ERR, TABLE, "%s: Merge is not started\n", __func__);
+		return -EINVAL;
+	case ACL_MERGE_STARTED:
+		return -EAGAIN;
+	case ACL_MERGE_FAILED:
+		rte_table_acl_merge_abort(acl);
+		return -EINVAL;
+	default:
+		break;
+	}
+
+	/* Swap the main table, it now holds the rules merged in */
+	rte_rmb();
+	if (acl->ctx != NULL)
+		rte_acl_free(acl->ctx);
+	acl->ctx = acl->merge_ctx;
+	acl->merge_ctx = NULL;
+	acl->name_id ^= 1;
+	acl->merge_state = ACL_MERGE_NONE;
+
+	n_deleted = 0;
+	for (i = 1; i < acl->n_rules; i++) {
+		state = acl->acl_rule_state[i] & ~(ACL_RULE_MAIN |
+			ACL_RULE_MERGE);
+		if (acl->acl_rule_state[i] & ACL_RULE_MERGE) {
+			state |= ACL_RULE_MAIN;
+			if (acl->acl_rule_list[i] == NULL)
+				n_deleted++;
+		}
+		acl->acl_rule_state[i] = state;
+	}
+	acl->n_deleted = n_deleted;
+
+	/* Keep the rules changed while the merge was in progress */
+	rte_table_acl_delta_select(acl);
+	if (rte_table_acl_delta_build(acl) != 0) {
+		RTE_LOG(ERR, TABLE, "%s: Cannot rebuild the delta table\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+/*
+ * Merge all the rules into the main table in place.
+ */
+static int
+rte_table_acl_merge(struct rte_table_acl *acl)
+{
+	int status;
+
+	status = rte_table_acl_merge_start(acl);
+	if (status != 0)
+		return status;
+
+	status = rte_table_acl_merge_build(acl);
+	if (status != 0) {
+		rte_table_acl_merge_abort(acl);
+		return status;
+	}
+
+	return rte_table_acl_merge_finish(acl);
+}
+
+/*
+ * Apply a rule set change to the low level tables: either rebuild the small
+ * delta table or, once the delta grows too big, merge everything into the
+ * main table.
+ */
+static int
+rte_table_acl_update(struct rte_table_acl *acl)
+{
+	uint32_t n_rules;
+
+	n_rules = rte_table_acl_delta_select(acl);
+	if (n_rules + acl->n_deleted <= acl->n_rules_delta ||
+		acl->merge_state != ACL_MERGE_NONE)
+		return rte_table_acl_delta_build(acl);
+
+	return rte_table_acl_merge(acl);
+}
+
+/*
+ * Look for a free rule position. Positions of the rules deleted since last
+ * merge can't be reused while the main or merged table still refers to them.
+ */
+static int
+rte_table_acl_free_pos(struct rte_table_acl *acl, uint32_t *pos)
+{
+	uint32_t i;
+
+	for (i = 1; i < acl->n_rules; i++) {
+		if (acl->acl_rule_list[i] == NULL &&
+			(acl->acl_rule_state[i] &
+			(ACL_RULE_MAIN | ACL_RULE_MERGE)) == 0) {
+			*pos = i;
+			return 1;
+		}
+	}
+
 	return 0;
 }
 
@@ -239,8 +635,7 @@ rte_table_acl_entry_add(
 		(struct rte_table_acl_rule_add_params *) key;
 	struct rte_pipeline_acl_rule acl_rule;
 	struct rte_acl_rule *rule_location;
-	struct rte_acl_ctx *ctx;
-	uint32_t free_pos, free_pos_valid, i;
+	uint32_t free_pos, i;
 	int status;
 
 	/* Check input parameters */
@@ -281,17 +676,9 @@ rte_table_acl_entry_add(
 		acl->cfg.num_fields * sizeof(struct rte_acl_field));
 
 	/* Look to see if the rule exists already in the table */
-	free_pos = 0;
-	free_pos_valid = 0;
 	for (i = 1; i < acl->n_rules; i++) {
-		if (acl->acl_rule_list[i] == NULL) {
-			if (free_pos_valid == 0) {
-				free_pos = i;
-				free_pos_valid = 1;
-			}
-
+		if (acl->acl_rule_list[i] == NULL)
 			continue;
-		}
 
 		/* Compare the key fields */
 		status = memcmp(&acl->acl_rule_list[i]->field[0],
@@ -308,8 +695,10 @@ rte_table_acl_entry_add(
 		}
 	}
 
-	/* Return if max rules */
-	if (free_pos_valid == 0) {
+	/* Positions of deleted rules are released by merge */
+	if (rte_table_acl_free_pos(acl, &free_pos) == 0 &&
+		(acl->n_deleted == 0 || rte_table_acl_merge(acl) != 0 ||
+		rte_table_acl_free_pos(acl, &free_pos) == 0)) {
 		RTE_LOG(ERR, TABLE, "%s: Max number of rules reached\n",
 			__func__);
 		return -ENOSPC;
@@ -323,21 +712,15 @@ rte_table_acl_entry_add(
 	acl->acl_rule_list[free_pos] = rule_location;
 
 	/* Build low level ACL table */
-	acl->name_id ^= 1;
-	acl->acl_params.name = acl->name[acl->name_id];
-	status = rte_table_acl_build(acl, &ctx);
+	status = rte_table_acl_update(acl);
 	if (status != 0) {
 		/* Roll back changes */
 		acl->acl_rule_list[free_pos] = NULL;
-		acl->name_id ^= 1;
 
 		return -EINVAL;
 	}
 
 	/* Commit changes */
-	if (acl->ctx != NULL)
-		rte_acl_free(acl->ctx);
-	acl->ctx = ctx;
 	*key_found = 0;
 	*entry_ptr = &acl->memory[free_pos * acl->entry_size];
 	memcpy(*entry_ptr, entry, acl->entry_size);
@@ -356,7 +739,6 @@ rte_table_acl_entry_delete(
 	struct rte_table_acl_rule_delete_params *rule =
 		(struct rte_table_acl_rule_delete_params *) key;
 	struct rte_acl_rule *deleted_rule = NULL;
-	struct rte_acl_ctx *ctx;
 	uint32_t pos, pos_valid, i;
 	int status;
 
@@ -402,23 +784,22 @@ rte_table_acl_entry_delete(
 		return 0;
 	}
 
+	/* Main table keeps returning the rule until next merge */
+	if (acl->acl_rule_state[pos] & ACL_RULE_MAIN)
+		acl->n_deleted++;
+
 	/* Build low level ACL table */
-	acl->name_id ^= 1;
-	acl->acl_params.name = acl->name[acl->name_id];
-	status = rte_table_acl_build(acl, &ctx);
+	status = rte_table_acl_update(acl);
 	if (status != 0) {
 		/* Roll back changes */
 		acl->acl_rule_list[pos] = deleted_rule;
-		acl->name_id ^= 1;
+		if (acl->acl_rule_state[pos] & ACL_RULE_MAIN)
+			acl->n_deleted--;
 
 		return -EINVAL;
 	}
 
 	/* Commit changes */
-	if (acl->ctx != NULL)
-		rte_acl_free(acl->ctx);
-
-	acl->ctx = ctx;
 	*key_found = 1;
 	if (entry != NULL)
 		memcpy(entry, &acl->memory[pos * acl->entry_size],
@@ -427,6 +808,41 @@ rte_table_acl_entry_delete(
 	return 0;
 }
 
+/*
+ * Combine main table results with the delta table ones: drop the rules
+ * deleted since last merge and pick the higher priority rule.
+ */
+static inline void
+rte_table_acl_lookup_delta(struct rte_table_acl *acl,
+	const uint8_t **pkts_data, uint32_t *results, uint32_t n_pkts)
+{
+	uint32_t delta_results[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t pos, delta_pos, i;
+
+	if (acl->delta_ctx != NULL)
+		rte_acl_classify(acl->delta_ctx, pkts_data, delta_results,
+			n_pkts, 1);
+	else
+		memset(delta_results, 0, n_pkts * sizeof(delta_results[0]));
+
+	for (i = 0; i < n_pkts; i++) {
+		pos = results[i];
+		delta_pos = delta_results[i];
+
+		if (pos != RTE_ACL_INVALID_USERDATA &&
+			acl->acl_rule_list[pos] == NULL)
+			pos = RTE_ACL_INVALID_USERDATA;
+
+		if (delta_pos != RTE_ACL_INVALID_USERDATA &&
+			(pos == RTE_ACL_INVALID_USERDATA ||
+			acl->acl_rule_list[delta_pos]->data.priority >
+			acl->acl_rule_list[pos]->data.priority))
+			pos = delta_pos;
+
+		results[i] = pos;
+	}
+}
+
 static int
 rte_table_acl_lookup(
 	void *table,
@@ -456,9 +872,14 @@ rte_table_acl_lookup(
 	/* Low-level ACL table lookup */
 	if (acl->ctx != NULL)
 		rte_acl_classify(acl->ctx, pkts_data, results, n_pkts, 1);
+	else if (acl->delta_ctx != NULL)
+		memset(results, 0, n_pkts * sizeof(results[0]));
 	else
 		n_pkts = 0;
 
+	if (acl->delta_ctx != NULL || acl->n_deleted != 0)
+		rte_table_acl_lookup_delta(acl, pkts_data, results, n_pkts);
+
 	/* Output conversion */
 	pkts_out_mask = 0;
 	for (i = 0; i < n_pkts; i++) {
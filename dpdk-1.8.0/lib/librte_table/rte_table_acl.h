@@ -47,6 +47,19 @@ extern "C" {
  *
  * Use-cases: Firewall rule database, etc.
  *
+ * Rules added since the last merge are kept in a small delta low level table
+ * which is looked up along with the main one, so that a rule update only
+ * rebuilds the delta table. Rules of the main table deleted since the last
+ * merge are filtered out at lookup time. Once the delta table grows past
+ * its limit, all the rules are merged into a new main table. The merge can
+ * also be split in three steps, so that the expensive build step runs on an
+ * lcore other than the one owning the table:
+ *   1. rte_table_acl_merge_start() on the owner lcore;
+ *   2. rte_table_acl_merge_build() on any lcore, while the owner lcore
+ *      keeps doing lookups and rule updates;
+ *   3. rte_table_acl_merge_finish() on the owner lcore, which swaps the
+ *      main table and returns -EAGAIN until the build step is completed.
+ *
  ***/
 
 #include <stdint.h>
@@ -66,6 +79,11 @@ struct rte_table_acl_params {
 	/** Number of fields in the ACL rule specification */
 	uint32_t n_rule_fields;
 
+	/** Maximum number of rules changed since the last merge before all the
+	rules are merged into the main table, 0 rebuilds the main table on each
+	rule update. Has to be smaller than n_rules. */
+	uint32_t n_rules_delta;
+
 	/** Format specification of the fields of the ACL rule */
 	struct rte_acl_field_def field_format[RTE_ACL_MAX_FIELDS];
 };
@@ -88,6 +106,46 @@ struct rte_table_acl_rule_delete_params {
 /** ACL table operations */
 extern struct rte_table_ops rte_table_acl_ops;
 
+/**
+ * Start merging all the ACL table rules into a new main low level table.
+ * Has to be called by the lcore owning the table.
+ *
+ * @param table
+ *   Handle to ACL table
+ * @return
+ *   0 on success, -EBUSY if a merge is already in progress,
+ *   -EINVAL on error
+ */
+int
+rte_table_acl_merge_start(void *table);
+
+/**
+ * Build the low level table of a started merge. This is the expensive step
+ * of the merge, it might be called by any lcore and runs concurrently with
+ * lookups and rule updates done by the lcore owning the table.
+ *
+ * @param table
+ *   Handle to ACL table
+ * @return
+ *   0 on success, -EINVAL on error
+ */
+int
+rte_table_acl_merge_build(void *table);
+
+/**
+ * Complete a merge: replace the main low level table with the built one and
+ * rebuild the delta table from the rules updated in the meantime.
+ * Has to be called by the lcore owning the table.
+ *
+ * @param table
+ *   Handle to ACL table
+ * @return
+ *   0 on success, -EAGAIN if the build step is not completed yet,
+ *   -EINVAL on error (a failed merge is cancelled)
+ */
+int
+rte_table_acl_merge_finish(void *table);
+
 #ifdef __cplusplus
 }
 #endif
@@ -39,6 +39,7 @@
 #include <rte_memory.h>
 #include <rte_malloc.h>
 #include <rte_log.h>
+#include <rte_prefetch.h>
 
 #include "rte_table_array.h"
 
@@ -171,6 +172,15 @@ rte_table_array_lookup(
 		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
 		uint32_t i;
 
+		/* Stage 0: prefetch the packet meta-data */
+		for (i = 0; i < n_pkts; i++)
+			rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(pkts[i],
+				t->offset));
+
+		/*
+		 * Stage 1: read the entry position, prefetch the table entry
+		 * for the action handlers that will read it next
+		 */
 		for (i = 0; i < n_pkts; i++) {
 			struct rte_mbuf *pkt = pkts[i];
 			uint32_t entry_pos = RTE_MBUF_METADATA_UINT32(pkt,
@@ -178,6 +188,7 @@ rte_table_array_lookup(
 
 			entries[i] = (void *) &t->array[entry_pos *
 				t->entry_size];
+			rte_prefetch0(entries[i]);
 		}
 	} else {
 		for ( ; pkts_mask; ) {
@@ -74,6 +74,16 @@ extern "C" {
  *        4 keys, potentially until all keys in this bucket are examined. The
  *        extendible bucket logic requires maintaining specific data structures
  *        per table and per each bucket.
+ *     c. Cuckoo: Each key has two candidate buckets of 8 keys each, the
+ *        primary bucket selected by the key signature and the alternative
+ *        bucket derived from the primary bucket index and the 16-bit key tag.
+ *        On key add operation, when both candidate buckets are full, room is
+ *        made by moving existing keys to their alternative bucket, following
+ *        the shortest displacement path found through a bounded breadth first
+ *        search. The key add operation fails only when no such path exists or
+ *        when the pool of free keys is exhausted. The key lookup operation
+ *        examines at most two buckets, without any bucket chaining. Bulk key
+ *        add and delete operations are supported.
  * 2. Key signature computation:
  *     a. Pre-computed key signature: The key lookup operation is split between
  *        two CPU cores. The first CPU core (typically the CPU core performing
@@ -89,6 +99,13 @@ extern "C" {
  * 3. Key size:
  *     a. Configurable key size
  *     b. Single key size (8-byte, 16-byte or 32-byte key size)
+ * 4. Per-entry aging (optional): Each table entry records the time of its
+ *    last lookup hit and its number of lookup hits. The lookup operation
+ *    updates this information once per burst, only for the entries it hits.
+ *    The table age operation scans a configurable number of buckets per
+ *    call, resuming from where the previous call stopped, and reports and
+ *    optionally deletes the entries that were not hit since a given time,
+ *    so that flow expiry can be spread over the packet processing loop.
  *
  ***/
 #include <stdint.h>
@@ -133,6 +150,11 @@ struct rte_table_hash_ext_params {
 
 	/** Byte offset within packet meta-data where the key is located */
 	uint32_t key_offset;
+
+	/** Per-entry aging: when different than 0, each table entry keeps track
+	of the time of its last lookup hit and of its number of lookup hits,
+	which are examined by the f_age table operation */
+	uint32_t aging;
 };
 
 /** Extendible bucket hash table operations for pre-computed key signature */
@@ -142,6 +164,45 @@ extern struct rte_table_ops rte_table_hash_ext_ops;
 	lookup ("do-sig") */
 extern struct rte_table_ops rte_table_hash_ext_dosig_ops;
 
+/** Cuckoo hash table parameters */
+struct rte_table_hash_cuckoo_params {
+	/** Key size (number of bytes) */
+	uint32_t key_size;
+
+	/** Maximum number of keys */
+	uint32_t n_keys;
+
+	/** Number of hash table buckets. Each bucket stores up to 8 keys. It is
+	recommended to provision at least 25% more key slots than n_keys. */
+	uint32_t n_buckets;
+
+	/** Hash function */
+	rte_table_hash_op_hash f_hash;
+
+	/** Seed value for the hash function */
+	uint64_t seed;
+
+	/** Byte offset within packet meta-data where the 4-byte key signature
+	is located. Valid for pre-computed key signature tables, ignored for
+	do-sig tables. */
+	uint32_t signature_offset;
+
+	/** Byte offset within packet meta-data where the key is located */
+	uint32_t key_offset;
+
+	/** Per-entry aging: when different than 0, each table entry keeps track
+	of the time of its last lookup hit and of its number of lookup hits,
+	which are examined by the f_age table operation */
+	uint32_t aging;
+};
+
+/** Cuckoo hash table operations for pre-computed key signature */
+extern struct rte_table_ops rte_table_hash_cuckoo_ops;
+
+/** Cuckoo hash table operations for key signature computed on lookup
+	("do-sig") */
+extern struct rte_table_ops rte_table_hash_cuckoo_dosig_ops;
+
 /** LRU hash table parameters */
 struct rte_table_hash_lru_params {
 	/** Key size (number of bytes) */
@@ -166,6 +227,11 @@ struct rte_table_hash_lru_params {
 
 	/** Byte offset within packet meta-data where the key is located */
 	uint32_t key_offset;
+
+	/** Per-entry aging: when different than 0, each table entry keeps track
+	of the time of its last lookup hit and of its number of lookup hits,
+	which are examined by the f_age table operation */
+	uint32_t aging;
 };
 
 /** LRU hash table operations for pre-computed key signature */
@@ -196,6 +262,11 @@ struct rte_table_hash_key8_lru_params {
 
 	/** Byte offset within packet meta-data where the key is located */
 	uint32_t key_offset;
+
+	/** Per-entry aging: when different than 0, each table entry keeps track
+	of the time of its last lookup hit and of its number of lookup hits,
+	which are examined by the f_age table operation */
+	uint32_t aging;
 };
 
 /** LRU hash table operations for pre-computed key signature */
@@ -226,6 +297,11 @@ struct rte_table_hash_key8_ext_params {
 
 	/** Byte offset within packet meta-data where the key is located */
 	uint32_t key_offset;
+
+	/** Per-entry aging: when different than 0, each table entry keeps track
+	of the time of its last lookup hit and of its number of lookup hits,
+	which are examined by the f_age table operation */
+	uint32_t aging;
 };
 
 /** Extendible bucket hash table operations for pre-computed key signature */
@@ -257,6 +333,11 @@ struct rte_table_hash_key16_lru_params {
 
 	/** Byte offset within packet meta-data where the key is located */
 	uint32_t key_offset;
+
+	/** Per-entry aging: when different than 0, each table entry keeps track
+	of the time of its last lookup hit and of its number of lookup hits,
+	which are examined by the f_age table operation */
+	uint32_t aging;
 };
 
 /** LRU hash table operations for pre-computed key signature */
@@ -284,6 +365,11 @@ struct rte_table_hash_key16_ext_params {
 
 	/** Byte offset within packet meta-data where the key is located */
 	uint32_t key_offset;
+
+	/** Per-entry aging: when different than 0, each table entry keeps track
+	of the time of its last lookup hit and of its number of lookup hits,
+	which are examined by the f_age table operation */
+	uint32_t aging;
 };
 
 /** Extendible bucket operations for pre-computed key signature */
@@ -311,6 +397,11 @@ struct rte_table_hash_key32_lru_params {
 
 	/** Byte offset within packet meta-data where the key is located */
 	uint32_t key_offset;
+
+	/** Per-entry aging: when different than 0, each table entry keeps track
+	of the time of its last lookup hit and of its number of lookup hits,
+	which are examined by the f_age table operation */
+	uint32_t aging;
 };
 
 /** LRU hash table operations for pre-computed key signature */
@@ -338,6 +429,11 @@ struct rte_table_hash_key32_ext_params {
 
 	/** Byte offset within packet meta-data where the key is located */
 	uint32_t key_offset;
+
+	/** Per-entry aging: when different than 0, each table entry keeps track
+	of the time of its last lookup hit and of its number of lookup hits,
+	which are examined by the f_age table operation */
+	uint32_t aging;
 };
 
 /** Extendible bucket hash table operations */
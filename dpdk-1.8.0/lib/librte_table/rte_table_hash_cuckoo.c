@@ -0,0 +1,788 @@
+/*-
+ *	 BSD LICENSE
+ *
+ *	 Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *	 All rights reserved.
+ *
+ *	 Redistribution and use in source and binary forms, with or without
+ *	 modification, are permitted provided that the following conditions
+ *	 are met:
+ *
+ *	* Redistributions of source code must retain the above copyright
+ *		 notice, this list of conditions and the following disclaimer.
+ *	* Redistributions in binary form must reproduce the above copyright
+ *		 notice, this list of conditions and the following disclaimer in
+ *		 the documentation and/or other materials provided with the
+ *		 distribution.
+ *	* Neither the name of Intel Corporation nor the names of its
+ *		 contributors may be used to endorse or promote products derived
+ *		 from this software without specific prior written permission.
+ *
+ *	 THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *	 "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *	 LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *	 A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *	 OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *	 SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *	 LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *	 DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *	 THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *	 (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *	 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+#include <rte_log.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "rte_table_hash.h"
+#include "table_hash_age.h"
+
+#define KEYS_PER_BUCKET	8
+
+/* Maximum number of buckets visited while searching for a displacement path */
+#define BFS_NODES_MAX	256
+
+/* Number of keys hashed and prefetched in advance by the bulk operations */
+#define BULK_SIZE_MAX	64
+
+struct bucket {
+	uint16_t sig[KEYS_PER_BUCKET];
+	uint32_t key_pos[KEYS_PER_BUCKET];
+} __rte_cache_aligned;
+
+struct grinder {
+	struct bucket *bkt[2];
+	uint8_t *key;
+	uint32_t match;
+	uint16_t sig;
+};
+
+struct bfs_node {
+	uint32_t bkt_index;
+	uint32_t pos;      /* Key position within the parent bucket */
+	int32_t parent;    /* Parent node index, -1 for the candidate buckets */
+};
+
+struct rte_table_hash {
+	/* Input parameters */
+	uint32_t key_size;
+	uint32_t entry_size;
+	uint32_t n_keys;
+	uint32_t n_buckets;
+	rte_table_hash_op_hash f_hash;
+	uint64_t seed;
+	uint32_t signature_offset;
+	uint32_t key_offset;
+	uint32_t aging;
+
+	/* Internal */
+	uint64_t bucket_mask;
+	uint32_t kv_size_shl;
+	uint32_t data_offset;
+	uint32_t key_stack_tos;
+	uint32_t age_bkt_index;
+
+	/* Grinder */
+	struct grinder grinders[RTE_PORT_IN_BURST_SIZE_MAX];
+
+	/* Displacement path search queue */
+	struct bfs_node bfs[BFS_NODES_MAX];
+
+	/* Tables */
+	struct bucket *buckets;
+	uint8_t *kv_mem;
+	uint32_t *key_stack;
+
+	/* Table memory */
+	uint8_t memory[0] __rte_cache_aligned;
+};
+
+/*
+ * Each key is stored together with its data in a power of 2 sized record,
+ * so that the key compare and the access to the entry hit by the lookup
+ * usually touch a single cache line.
+ */
+#define KV_KEY(t, key_index)						\
+	(&(t)->kv_mem[((uint64_t) (key_index)) << (t)->kv_size_shl])
+
+#define KV_DATA(t, key_index)						\
+	(KV_KEY(t, key_index) + (t)->data_offset)
+
+#define SIG_TAG(sig)	((uint16_t) (((sig) >> 16) | 1LLU))
+
+/*
+ * The alternative bucket only depends on the current bucket and on the key
+ * tag, so keys can be moved between their two candidate buckets without
+ * access to the key itself. The operation is its own inverse.
+ */
+static inline uint32_t
+bucket_alt(struct rte_table_hash *t, uint32_t bkt_index, uint16_t sig)
+{
+	uint64_t offset = (((uint64_t) sig) * 0x9E3779B97F4A7C15LLU) >> 32;
+
+	return (bkt_index ^ (uint32_t) (offset | 1)) & t->bucket_mask;
+}
+
+/* Bitmask of the bucket positions whose tag is equal to sig */
+static inline uint32_t
+bucket_match(struct bucket *bkt, uint16_t sig)
+{
+#ifdef __SSE2__
+	__m128i bkt_sig = _mm_load_si128((__m128i *) bkt->sig);
+	__m128i match = _mm_cmpeq_epi16(bkt_sig, _mm_set1_epi16(sig));
+
+	return _mm_movemask_epi8(_mm_packs_epi16(match, _mm_setzero_si128()));
+#else
+	uint32_t match = 0, i;
+
+	for (i = 0; i < KEYS_PER_BUCKET; i++)
+		match |= ((uint32_t) (bkt->sig[i] == sig)) << i;
+
+	return match;
+#endif
+}
+
+static inline int
+keycmp(uint32_t key_size, uint64_t *pkt_key, uint64_t *bkt_key)
+{
+	switch (key_size) {
+	case 8:
+		return (pkt_key[0] ^ bkt_key[0]) != 0;
+
+	case 16:
+		return ((pkt_key[0] ^ bkt_key[0]) |
+			(pkt_key[1] ^ bkt_key[1])) != 0;
+
+	case 32:
+		return ((pkt_key[0] ^ bkt_key[0]) |
+			(pkt_key[1] ^ bkt_key[1]) |
+			(pkt_key[2] ^ bkt_key[2]) |
+			(pkt_key[3] ^ bkt_key[3])) != 0;
+
+	case 64:
+		return ((pkt_key[0] ^ bkt_key[0]) |
+			(pkt_key[1] ^ bkt_key[1]) |
+			(pkt_key[2] ^ bkt_key[2]) |
+			(pkt_key[3] ^ bkt_key[3]) |
+			(pkt_key[4] ^ bkt_key[4]) |
+			(pkt_key[5] ^ bkt_key[5]) |
+			(pkt_key[6] ^ bkt_key[6]) |
+			(pkt_key[7] ^ bkt_key[7])) != 0;
+
+	default:
+		return memcmp(pkt_key, bkt_key, key_size);
+	}
+}
+
+static int
+check_params_create(struct rte_table_hash_cuckoo_params *params)
+{
+	/* key_size */
+	if ((params->key_size == 0) ||
+		(!rte_is_power_of_2(params->key_size))) {
+		RTE_LOG(ERR, TABLE, "%s: key_size invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	/* n_keys */
+	if ((params->n_keys == 0) ||
+		(!rte_is_power_of_2(params->n_keys))) {
+		RTE_LOG(ERR, TABLE, "%s: n_keys invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	/* n_buckets */
+	if ((params->n_buckets == 0) ||
+		(!rte_is_power_of_2(params->n_buckets)) ||
+		(params->n_buckets < params->n_keys / KEYS_PER_BUCKET)) {
+		RTE_LOG(ERR, TABLE, "%s: n_buckets invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	/* f_hash */
+	if (params->f_hash == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: f_hash invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	/* signature offset */
+	if ((params->signature_offset & 0x3) != 0) {
+		RTE_LOG(ERR, TABLE, "%s: signature_offset invalid value\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	/* key offset */
+	if ((params->key_offset & 0x7) != 0) {
+		RTE_LOG(ERR, TABLE, "%s: key_offset invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static void *
+rte_table_hash_cuckoo_create(void *params, int socket_id, uint32_t entry_size)
+{
+	struct rte_table_hash_cuckoo_params *p =
+		(struct rte_table_hash_cuckoo_params *) params;
+	struct rte_table_hash *t;
+	uint64_t total_size;
+	uint64_t kv_sz;
+	uint32_t table_meta_sz, bucket_sz, key_stack_sz;
+	uint32_t bucket_offset, kv_offset, key_stack_offset;
+	uint32_t data_offset, kv_size;
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((p == NULL) ||
+		(check_params_create(p) != 0) ||
+		(!rte_is_power_of_2(entry_size)) ||
+		((sizeof(struct rte_table_hash) % RTE_CACHE_LINE_SIZE) != 0) ||
+		(sizeof(struct bucket) != RTE_CACHE_LINE_SIZE))
+		return NULL;
+
+	/* Memory allocation */
+	table_meta_sz = RTE_CACHE_LINE_ROUNDUP(sizeof(struct rte_table_hash));
+	bucket_sz = RTE_CACHE_LINE_ROUNDUP(p->n_buckets * sizeof(struct bucket));
+	data_offset = RTE_MAX(p->key_size, (uint32_t) sizeof(uint64_t));
+	kv_size = rte_align32pow2(data_offset +
+		table_hash_age_entry_size(entry_size, p->aging));
+	kv_sz = RTE_CACHE_LINE_ROUNDUP((uint64_t) p->n_keys * kv_size);
+	key_stack_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * sizeof(uint32_t));
+	total_size = (uint64_t) table_meta_sz + bucket_sz + kv_sz +
+		key_stack_sz;
+	if (total_size > UINT32_MAX) {
+		RTE_LOG(ERR, TABLE, "%s: Hash table too big\n", __func__);
+		return NULL;
+	}
+
+	t = rte_zmalloc_socket("TABLE", total_size, RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (t == NULL) {
+		RTE_LOG(ERR, TABLE,
+			"%s: Cannot allocate %u bytes for hash table\n",
+			__func__, (uint32_t) total_size);
+		return NULL;
+	}
+	RTE_LOG(INFO, TABLE, "%s (%u-byte key): Hash table memory footprint is "
+		"%u bytes\n", __func__, p->key_size, (uint32_t) total_size);
+
+	/* Memory initialization */
+	t->key_size = p->key_size;
+	t->entry_size = entry_size;
+	t->n_keys = p->n_keys;
+	t->n_buckets = p->n_buckets;
+	t->f_hash = p->f_hash;
+	t->seed = p->seed;
+	t->signature_offset = p->signature_offset;
+	t->key_offset = p->key_offset;
+	t->aging = p->aging;
+
+	/* Internal */
+	t->bucket_mask = t->n_buckets - 1;
+	t->kv_size_shl = __builtin_ctzl(kv_size);
+	t->data_offset = data_offset;
+
+	/* Tables */
+	bucket_offset = 0;
+	kv_offset = bucket_offset + bucket_sz;
+	key_stack_offset = kv_offset + kv_sz;
+
+	t->buckets = (struct bucket *) &t->memory[bucket_offset];
+	t->kv_mem = &t->memory[kv_offset];
+	t->key_stack = (uint32_t *) &t->memory[key_stack_offset];
+
+	/* Key stack */
+	for (i = 0; i < t->n_keys; i++)
+		t->key_stack[i] = t->n_keys - 1 - i;
+	t->key_stack_tos = t->n_keys;
+
+	return t;
+}
+
+static int
+rte_table_hash_cuckoo_free(void *table)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+
+	/* Check input parameters */
+	if (t == NULL)
+		return -EINVAL;
+
+	rte_free(t);
+	return 0;
+}
+
+static inline int
+bfs_path_contains(struct bfs_node *q, int32_t n, uint32_t bkt_index)
+{
+	for ( ; n >= 0; n = q[n].parent)
+		if (q[n].bkt_index == bkt_index)
+			return 1;
+
+	return 0;
+}
+
+/*
+ * Find a free key position in one of the two candidate buckets, moving keys
+ * to their alternative bucket when both are full. The moves are done from the
+ * free end of the path backwards, so every key is present in the table at any
+ * time, possibly twice, but never missing.
+ */
+static int
+cuckoo_make_room(struct rte_table_hash *t, uint32_t bkt0_index,
+	uint32_t bkt1_index, struct bucket **bkt_free, uint32_t *pos_free)
+{
+	struct bfs_node *q = t->bfs;
+	int32_t head, tail;
+
+	q[0].bkt_index = bkt0_index;
+	q[0].parent = -1;
+	q[1].bkt_index = bkt1_index;
+	q[1].parent = -1;
+	tail = (bkt0_index == bkt1_index) ? 1 : 2;
+
+	for (head = 0; head < tail; head++) {
+		struct bucket *bkt = &t->buckets[q[head].bkt_index];
+		uint32_t pos;
+		int32_t n;
+
+		for (pos = 0; pos < KEYS_PER_BUCKET; pos++)
+			if (bkt->sig[pos] == 0)
+				break;
+
+		if (pos == KEYS_PER_BUCKET) {
+			/* Bucket full: enqueue the alternative buckets */
+			for (pos = 0; (pos < KEYS_PER_BUCKET) &&
+				(tail < BFS_NODES_MAX); pos++) {
+				uint32_t alt = bucket_alt(t, q[head].bkt_index,
+					bkt->sig[pos]);
+
+				if (bfs_path_contains(q, head, alt))
+					continue;
+
+				q[tail].bkt_index = alt;
+				q[tail].pos = pos;
+				q[tail].parent = head;
+				tail++;
+			}
+
+			continue;
+		}
+
+		/* Free position found: move the keys along the path */
+		for (n = head; q[n].parent >= 0; n = q[n].parent) {
+			struct bucket *src = &t->buckets[q[q[n].parent].bkt_index];
+
+			bkt->key_pos[pos] = src->key_pos[q[n].pos];
+			bkt->sig[pos] = src->sig[q[n].pos];
+
+			bkt = src;
+			pos = q[n].pos;
+		}
+
+		*bkt_free = bkt;
+		*pos_free = pos;
+		return 0;
+	}
+
+	return -ENOSPC;
+}
+
+static inline void
+cuckoo_prefetch(struct rte_table_hash *t, uint64_t sig)
+{
+	uint32_t bkt_index = sig & t->bucket_mask;
+
+	rte_prefetch0(&t->buckets[bkt_index]);
+	rte_prefetch0(&t->buckets[bucket_alt(t, bkt_index, SIG_TAG(sig))]);
+}
+
+static int
+cuckoo_entry_add(struct rte_table_hash *t, void *key, uint64_t sig,
+	void *entry, int *key_found, void **entry_ptr)
+{
+	struct bucket *bkt[2], *bkt_free;
+	uint32_t bkt_index[2], pos, bkt_key_index, i, j;
+	uint8_t *bkt_key, *data;
+	uint16_t tag;
+	int status;
+
+	tag = SIG_TAG(sig);
+	bkt_index[0] = sig & t->bucket_mask;
+	bkt_index[1] = bucket_alt(t, bkt_index[0], tag);
+	bkt[0] = &t->buckets[bkt_index[0]];
+	bkt[1] = &t->buckets[bkt_index[1]];
+
+	/* Key is present in one of the candidate buckets */
+	for (i = 0; i < 2; i++)
+		for (j = 0; j < KEYS_PER_BUCKET; j++) {
+			if (bkt[i]->sig[j] != tag)
+				continue;
+
+			bkt_key_index = bkt[i]->key_pos[j];
+			bkt_key = KV_KEY(t, bkt_key_index);
+
+			if (memcmp(key, bkt_key, t->key_size) == 0) {
+				data = KV_DATA(t, bkt_key_index);
+
+				memcpy(data, entry, t->entry_size);
+				if (t->aging)
+					table_hash_age_add(data, t->entry_size,
+						1);
+				*key_found = 1;
+				*entry_ptr = (void *) data;
+				return 0;
+			}
+		}
+
+	/* Key is not present: allocate new key */
+	if (t->key_stack_tos == 0) /* No free keys */
+		return -ENOSPC;
+
+	status = cuckoo_make_room(t, bkt_index[0], bkt_index[1], &bkt_free,
+		&pos);
+	if (status != 0)
+		return status;
+
+	bkt_key_index = t->key_stack[--t->key_stack_tos];
+
+	/* Install new key */
+	bkt_key = KV_KEY(t, bkt_key_index);
+	data = KV_DATA(t, bkt_key_index);
+
+	memcpy(bkt_key, key, t->key_size);
+	memcpy(data, entry, t->entry_size);
+	if (t->aging)
+		table_hash_age_add(data, t->entry_size, 0);
+	bkt_free->key_pos[pos] = bkt_key_index;
+	bkt_free->sig[pos] = tag;
+
+	*key_found = 0;
+	*entry_ptr = (void *) data;
+	return 0;
+}
+
+static void
+cuckoo_entry_delete(struct rte_table_hash *t, void *key, uint64_t sig,
+	int *key_found, void *entry)
+{
+	struct bucket *bkt;
+	uint32_t bkt_index, i, j;
+	uint16_t tag;
+
+	tag = SIG_TAG(sig);
+	bkt_index = sig & t->bucket_mask;
+
+	for (i = 0; i < 2; i++) {
+		bkt = &t->buckets[bkt_index];
+
+		for (j = 0; j < KEYS_PER_BUCKET; j++) {
+			uint32_t bkt_key_index = bkt->key_pos[j];
+			uint8_t *bkt_key = KV_KEY(t, bkt_key_index);
+
+			if ((bkt->sig[j] == tag) &&
+				(memcmp(key, bkt_key, t->key_size) == 0)) {
+				uint8_t *data = KV_DATA(t, bkt_key_index);
+
+				/* Uninstall key from bucket */
+				bkt->sig[j] = 0;
+				*key_found = 1;
+				if (entry)
+					memcpy(entry, data, t->entry_size);
+
+				/* Free key */
+				t->key_stack[t->key_stack_tos++] =
+					bkt_key_index;
+				return;
+			}
+		}
+
+		bkt_index = bucket_alt(t, bkt_index, tag);
+	}
+
+	/* Key is not present in the table */
+	*key_found = 0;
+}
+
+static int
+rte_table_hash_cuckoo_entry_add(void *table, void *key, void *entry,
+	int *key_found, void **entry_ptr)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	uint64_t sig = t->f_hash(key, t->key_size, t->seed);
+
+	return cuckoo_entry_add(t, key, sig, entry, key_found, entry_ptr);
+}
+
+static int
+rte_table_hash_cuckoo_entry_delete(void *table, void *key, int *key_found,
+	void *entry)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	uint64_t sig = t->f_hash(key, t->key_size, t->seed);
+
+	cuckoo_entry_delete(t, key, sig, key_found, entry);
+	return 0;
+}
+
+static int
+rte_table_hash_cuckoo_entry_add_bulk(void *table, void **keys,
+	void **entries, uint32_t n_keys, int *key_found, void **entries_ptr)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	uint64_t sig[BULK_SIZE_MAX];
+	uint32_t i, j, n;
+	int status = 0;
+
+	for (i = 0; i < n_keys; i += n) {
+		n = RTE_MIN(n_keys - i, (uint32_t) BULK_SIZE_MAX);
+
+		/* Hash the keys and prefetch their candidate buckets */
+		for (j = 0; j < n; j++) {
+			sig[j] = t->f_hash(keys[i + j], t->key_size, t->seed);
+			cuckoo_prefetch(t, sig[j]);
+		}
+
+		/* Install the keys */
+		for (j = 0; j < n; j++) {
+			int s = cuckoo_entry_add(t, keys[i + j], sig[j],
+				entries[i + j], &key_found[i + j],
+				&entries_ptr[i + j]);
+
+			if (s != 0) {
+				key_found[i + j] = 0;
+				entries_ptr[i + j] = NULL;
+				if (status == 0)
+					status = s;
+			}
+		}
+	}
+
+	return status;
+}
+
+static int
+rte_table_hash_cuckoo_entry_delete_bulk(void *table, void **keys,
+	uint32_t n_keys, int *key_found, void **entries)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	uint64_t sig[BULK_SIZE_MAX];
+	uint32_t i, j, n;
+
+	for (i = 0; i < n_keys; i += n) {
+		n = RTE_MIN(n_keys - i, (uint32_t) BULK_SIZE_MAX);
+
+		/* Hash the keys and prefetch their candidate buckets */
+		for (j = 0; j < n; j++) {
+			sig[j] = t->f_hash(keys[i + j], t->key_size, t->seed);
+			cuckoo_prefetch(t, sig[j]);
+		}
+
+		/* Uninstall the keys */
+		for (j = 0; j < n; j++)
+			cuckoo_entry_delete(t, keys[i + j], sig[j],
+				&key_found[i + j],
+				(entries != NULL) ? entries[i + j] : NULL);
+	}
+
+	return 0;
+}
+
+/*
+ * The lookup is split in stages, each stage being run for the whole burst
+ * before moving to the next one, so that the memory accesses of one packet
+ * (meta-data, the two candidate buckets, the key and the entry) are covered
+ * by prefetches issued while processing the other packets of the burst.
+ */
+static inline int
+rte_table_hash_cuckoo_lookup_generic(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries,
+	int dosig)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	struct grinder *g = t->grinders;
+	uint64_t pkts_mask_out = 0, mask;
+
+	/* Stage 0: prefetch the packet meta-data */
+	for (mask = pkts_mask; mask; mask &= mask - 1) {
+		uint32_t pkt_index = __builtin_ctzll(mask);
+
+		rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(pkts[pkt_index],
+			t->key_offset));
+	}
+
+	/* Stage 1: compute the candidate buckets and prefetch them */
+	for (mask = pkts_mask; mask; mask &= mask - 1) {
+		uint32_t pkt_index = __builtin_ctzll(mask);
+		struct rte_mbuf *pkt = pkts[pkt_index];
+		struct grinder *gr = &g[pkt_index];
+		uint8_t *key = RTE_MBUF_METADATA_UINT8_PTR(pkt, t->key_offset);
+		uint64_t sig;
+		uint32_t bkt_index;
+
+		if (dosig)
+			sig = t->f_hash(key, t->key_size, t->seed);
+		else
+			sig = RTE_MBUF_METADATA_UINT32(pkt,
+				t->signature_offset);
+
+		bkt_index = sig & t->bucket_mask;
+		gr->sig = SIG_TAG(sig);
+		gr->key = key;
+		gr->bkt[0] = &t->buckets[bkt_index];
+		gr->bkt[1] = &t->buckets[bucket_alt(t, bkt_index, gr->sig)];
+
+		rte_prefetch0(gr->bkt[0]);
+		rte_prefetch0(gr->bkt[1]);
+	}
+
+	/* Stage 2: match the key tags, prefetch the first candidate key */
+	for (mask = pkts_mask; mask; mask &= mask - 1) {
+		uint32_t pkt_index = __builtin_ctzll(mask);
+		struct grinder *gr = &g[pkt_index];
+		uint32_t match, pos, bkt_key_index;
+
+		match = bucket_match(gr->bkt[0], gr->sig) |
+			(bucket_match(gr->bkt[1], gr->sig) << KEYS_PER_BUCKET);
+		gr->match = match;
+		if (match == 0)
+			continue;
+
+		pos = __builtin_ctz(match);
+		bkt_key_index = gr->bkt[pos / KEYS_PER_BUCKET]->key_pos[
+			pos % KEYS_PER_BUCKET];
+		rte_prefetch0(KV_KEY(t, bkt_key_index));
+	}
+
+	/* Stage 3: compare the keys */
+	for (mask = pkts_mask; mask; mask &= mask - 1) {
+		uint32_t pkt_index = __builtin_ctzll(mask);
+		struct grinder *gr = &g[pkt_index];
+		uint32_t match;
+
+		for (match = gr->match; match; match &= match - 1) {
+			uint32_t pos = __builtin_ctz(match);
+			uint32_t bkt_key_index =
+				gr->bkt[pos / KEYS_PER_BUCKET]->key_pos[
+				pos % KEYS_PER_BUCKET];
+			uint8_t *bkt_key = KV_KEY(t, bkt_key_index);
+
+			if (keycmp(t->key_size, (uint64_t *) gr->key,
+				(uint64_t *) bkt_key) == 0) {
+				pkts_mask_out |= 1LLU << pkt_index;
+				entries[pkt_index] =
+					(void *) KV_DATA(t, bkt_key_index);
+				break;
+			}
+		}
+	}
+
+	*lookup_hit_mask = pkts_mask_out;
+	if (t->aging)
+		table_hash_age_lookup(entries, pkts_mask_out, t->entry_size);
+	return 0;
+}
+
+static int
+rte_table_hash_cuckoo_lookup(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	return rte_table_hash_cuckoo_lookup_generic(table, pkts, pkts_mask,
+		lookup_hit_mask, entries, 0);
+}
+
+static int
+rte_table_hash_cuckoo_lookup_dosig(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	return rte_table_hash_cuckoo_lookup_generic(table, pkts, pkts_mask,
+		lookup_hit_mask, entries, 1);
+}
+
+static int
+rte_table_hash_cuckoo_age(void *table, uint64_t expire_time,
+	uint32_t n_buckets, int remove, rte_table_age_report f_report,
+	void *arg)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	uint32_t i, j;
+	int n_expired = 0;
+
+	if (t->aging == 0)
+		return -ENOTSUP;
+
+	if (n_buckets > t->n_buckets)
+		n_buckets = t->n_buckets;
+
+	for (i = 0; i < n_buckets; i++) {
+		struct bucket *bkt = &t->buckets[t->age_bkt_index];
+
+		for (j = 0; j < KEYS_PER_BUCKET; j++) {
+			uint32_t bkt_key_index = bkt->key_pos[j];
+
+			if ((bkt->sig[j] == 0) ||
+				(table_hash_age_check(KV_KEY(t, bkt_key_index),
+				KV_DATA(t, bkt_key_index), t->entry_size,
+				expire_time, f_report, arg) == 0))
+				continue;
+
+			n_expired++;
+			if (remove) {
+				bkt->sig[j] = 0;
+				t->key_stack[t->key_stack_tos++] =
+					bkt_key_index;
+			}
+		}
+
+		t->age_bkt_index = (t->age_bkt_index + 1) & t->bucket_mask;
+	}
+
+	return n_expired;
+}
+
+struct rte_table_ops rte_table_hash_cuckoo_ops = {
+	.f_create = rte_table_hash_cuckoo_create,
+	.f_free = rte_table_hash_cuckoo_free,
+	.f_add = rte_table_hash_cuckoo_entry_add,
+	.f_delete = rte_table_hash_cuckoo_entry_delete,
+	.f_lookup = rte_table_hash_cuckoo_lookup,
+	.f_add_bulk = rte_table_hash_cuckoo_entry_add_bulk,
+	.f_delete_bulk = rte_table_hash_cuckoo_entry_delete_bulk,
+	.f_age = rte_table_hash_cuckoo_age,
+};
+
+struct rte_table_ops rte_table_hash_cuckoo_dosig_ops = {
+	.f_create = rte_table_hash_cuckoo_create,
+	.f_free = rte_table_hash_cuckoo_free,
+	.f_add = rte_table_hash_cuckoo_entry_add,
+	.f_delete = rte_table_hash_cuckoo_entry_delete,
+	.f_lookup = rte_table_hash_cuckoo_lookup_dosig,
+	.f_add_bulk = rte_table_hash_cuckoo_entry_add_bulk,
+	.f_delete_bulk = rte_table_hash_cuckoo_entry_delete_bulk,
+	.f_age = rte_table_hash_cuckoo_age,
+};
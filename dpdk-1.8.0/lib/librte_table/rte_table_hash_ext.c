@@ -41,6 +41,7 @@
 #include <rte_log.h>
 
 #include "rte_table_hash.h"
+#include "table_hash_age.h"
 
 #define KEYS_PER_BUCKET	4
 
@@ -92,12 +93,14 @@ struct rte_table_hash {
 	uint64_t seed;
 	uint32_t signature_offset;
 	uint32_t key_offset;
+	uint32_t aging;
 
 	/* Internal */
 	uint64_t bucket_mask;
 	uint32_t key_size_shl;
 	uint32_t data_size_shl;
 	uint32_t key_stack_tos;
+	uint32_t age_bkt_index;
 	uint32_t bkt_ext_stack_tos;
 
 	/* Grinder */
@@ -173,7 +176,7 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 	struct rte_table_hash *t;
 	uint32_t total_size, table_meta_sz;
 	uint32_t bucket_sz, bucket_ext_sz, key_sz;
-	uint32_t key_stack_sz, bkt_ext_stack_sz, data_sz;
+	uint32_t key_stack_sz, bkt_ext_stack_sz, data_sz, data_size;
 	uint32_t bucket_offset, bucket_ext_offset, key_offset;
 	uint32_t key_stack_offset, bkt_ext_stack_offset, data_offset;
 	uint32_t i;
@@ -194,7 +197,9 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 	key_stack_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * sizeof(uint32_t));
 	bkt_ext_stack_sz =
 		RTE_CACHE_LINE_ROUNDUP(p->n_buckets_ext * sizeof(uint32_t));
-	data_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * entry_size);
+	data_size = rte_align32pow2(table_hash_age_entry_size(entry_size,
+		p->aging));
+	data_sz = RTE_CACHE_LINE_ROUNDUP(p->n_keys * data_size);
 	total_size = table_meta_sz + bucket_sz + bucket_ext_sz + key_sz +
 		key_stack_sz + bkt_ext_stack_sz + data_sz;
 
@@ -218,11 +223,12 @@ rte_table_hash_ext_create(void *params, int socket_id, uint32_t entry_size)
 	t->seed = p->seed;
 	t->signature_offset = p->signature_offset;
 	t->key_offset = p->key_offset;
+	t->aging = p->aging;
 
 	/* Internal */
 	t->bucket_mask = t->n_buckets - 1;
 	t->key_size_shl = __builtin_ctzl(p->key_size);
-	t->data_size_shl = __builtin_ctzl(entry_size);
+	t->data_size_shl = __builtin_ctzl(data_size);
 
 	/* Tables */
 	bucket_offset = 0;
@@ -274,7 +280,7 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 	uint64_t sig;
 	uint32_t bkt_index, i;
 
-	sig = t->f_hash(key, t->key_size, t->seed);
+	sig = (uint32_t) t->f_hash(key, t->key_size, t->seed);
 	bkt_index = sig & t->bucket_mask;
 	bkt0 = &t->buckets[bkt_index];
 	sig = (sig >> 16) | 1LLU;
@@ -293,6 +299,8 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 					t->data_size_shl];
 
 				memcpy(data, entry, t->entry_size);
+				if (t->aging)
+					table_hash_age_add(data, t->entry_size, 1);
 				*key_found = 1;
 				*entry_ptr = (void *) data;
 				return 0;
@@ -326,6 +334,8 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 				bkt->key_pos[i] = bkt_key_index;
 				memcpy(bkt_key, key, t->key_size);
 				memcpy(data, entry, t->entry_size);
+				if (t->aging)
+					table_hash_age_add(data, t->entry_size, 0);
 
 				*key_found = 0;
 				*entry_ptr = (void *) data;
@@ -357,6 +367,8 @@ rte_table_hash_ext_entry_add(void *table, void *key, void *entry,
 		bkt->key_pos[0] = bkt_key_index;
 		memcpy(bkt_key, key, t->key_size);
 		memcpy(data, entry, t->entry_size);
+		if (t->aging)
+			table_hash_age_add(data, t->entry_size, 0);
 
 		*key_found = 0;
 		*entry_ptr = (void *) data;
@@ -375,7 +387,7 @@ void *entry)
 	uint64_t sig;
 	uint32_t bkt_index, i;
 
-	sig = t->f_hash(key, t->key_size, t->seed);
+	sig = (uint32_t) t->f_hash(key, t->key_size, t->seed);
 	bkt_index = sig & t->bucket_mask;
 	bkt0 = &t->buckets[bkt_index];
 	sig = (sig >> 16) | 1LLU;
@@ -454,7 +466,7 @@ static int rte_table_hash_ext_lookup_unoptimized(
 		pkt = pkts[pkt_index];
 		key = RTE_MBUF_METADATA_UINT8_PTR(pkt, t->key_offset);
 		if (dosig)
-			sig = (uint64_t) t->f_hash(key, t->key_size, t->seed);
+			sig = (uint32_t) t->f_hash(key, t->key_size, t->seed);
 		else
 			sig = RTE_MBUF_METADATA_UINT32(pkt,
 				t->signature_offset);
@@ -724,13 +736,13 @@ static int rte_table_hash_ext_lookup_unoptimized(
 									\
 	mbuf10 = pkts[pkt10_index];					\
 	key10 = RTE_MBUF_METADATA_UINT8_PTR(mbuf10, key_offset);	\
-	sig10 = (uint64_t) f_hash(key10, key_size, seed);		\
+	sig10 = (uint32_t) f_hash(key10, key_size, seed);		\
 	bkt10_index = sig10 & bucket_mask;				\
 	bkt10 = &buckets[bkt10_index];					\
 									\
 	mbuf11 = pkts[pkt11_index];					\
 	key11 = RTE_MBUF_METADATA_UINT8_PTR(mbuf11, key_offset);	\
-	sig11 = (uint64_t) f_hash(key11, key_size, seed);		\
+	sig11 = (uint32_t) f_hash(key11, key_size, seed);		\
 	bkt11_index = sig11 & bucket_mask;				\
 	bkt11 = &buckets[bkt11_index];					\
 									\
@@ -862,9 +874,14 @@ static int rte_table_hash_ext_lookup(
 	int status = 0;
 
 	/* Cannot run the pipeline with less than 7 packets */
-	if (__builtin_popcountll(pkts_mask) < 7)
-		return rte_table_hash_ext_lookup_unoptimized(table, pkts,
+	if (__builtin_popcountll(pkts_mask) < 7) {
+		status = rte_table_hash_ext_lookup_unoptimized(table, pkts,
 			pkts_mask, lookup_hit_mask, entries, 0);
+		if (t->aging)
+			table_hash_age_lookup(entries, *lookup_hit_mask,
+				t->entry_size);
+		return status;
+	}
 
 	/* Pipeline stage 0 */
 	lookup2_stage0(t, g, pkts, pkts_mask, pkt00_index, pkt01_index);
@@ -973,6 +990,8 @@ static int rte_table_hash_ext_lookup(
 	}
 
 	*lookup_hit_mask = pkts_mask_out;
+	if (t->aging)
+		table_hash_age_lookup(entries, pkts_mask_out, t->entry_size);
 	return status;
 }
 
@@ -991,9 +1010,14 @@ static int rte_table_hash_ext_lookup_dosig(
 	int status = 0;
 
 	/* Cannot run the pipeline with less than 7 packets */
-	if (__builtin_popcountll(pkts_mask) < 7)
-		return rte_table_hash_ext_lookup_unoptimized(table, pkts,
+	if (__builtin_popcountll(pkts_mask) < 7) {
+		status = rte_table_hash_ext_lookup_unoptimized(table, pkts,
 			pkts_mask, lookup_hit_mask, entries, 1);
+		if (t->aging)
+			table_hash_age_lookup(entries, *lookup_hit_mask,
+				t->entry_size);
+		return status;
+	}
 
 	/* Pipeline stage 0 */
 	lookup2_stage0(t, g, pkts, pkts_mask, pkt00_index, pkt01_index);
@@ -1102,15 +1126,69 @@ static int rte_table_hash_ext_lookup_dosig(
 	}
 
 	*lookup_hit_mask = pkts_mask_out;
+	if (t->aging)
+		table_hash_age_lookup(entries, pkts_mask_out, t->entry_size);
 	return status;
 }
 
+static int
+rte_table_hash_ext_age(void *table, uint64_t expire_time, uint32_t n_buckets,
+	int remove, rte_table_age_report f_report, void *arg)
+{
+	struct rte_table_hash *t = (struct rte_table_hash *) table;
+	uint32_t i;
+	int n_expired = 0;
+
+	if (t->aging == 0)
+		return -ENOTSUP;
+
+	if (n_buckets > t->n_buckets)
+		n_buckets = t->n_buckets;
+
+	for (i = 0; i < n_buckets; i++) {
+		struct bucket *bkt, *bkt_next;
+
+		for (bkt = &t->buckets[t->age_bkt_index]; bkt != NULL;
+			bkt = bkt_next) {
+			uint32_t j;
+
+			/* Read now, as the delete below can release bkt */
+			bkt_next = BUCKET_NEXT(bkt);
+
+			for (j = 0; j < KEYS_PER_BUCKET; j++) {
+				uint32_t bkt_key_index = bkt->key_pos[j];
+				uint8_t *bkt_key = &t->key_mem[bkt_key_index <<
+					t->key_size_shl];
+				uint8_t *data = &t->data_mem[bkt_key_index <<
+					t->data_size_shl];
+				int key_found;
+
+				if ((bkt->sig[j] == 0) ||
+					(table_hash_age_check(bkt_key, data,
+					t->entry_size, expire_time, f_report,
+					arg) == 0))
+					continue;
+
+				n_expired++;
+				if (remove)
+					rte_table_hash_ext_entry_delete(t,
+						bkt_key, &key_found, NULL);
+			}
+		}
+
+		t->age_bkt_index = (t->age_bkt_index + 1) & t->bucket_mask;
+	}
+
+	return n_expired;
+}
+
 struct rte_table_ops rte_table_hash_ext_ops	 = {
 	.f_create = rte_table_hash_ext_create,
 	.f_free = rte_table_hash_ext_free,
 	.f_add = rte_table_hash_ext_entry_add,
 	.f_delete = rte_table_hash_ext_entry_delete,
 	.f_lookup = rte_table_hash_ext_lookup,
+	.f_age = rte_table_hash_ext_age,
 };
 
 struct rte_table_ops rte_table_hash_ext_dosig_ops  = {
@@ -1119,4 +1197,5 @@ struct rte_table_ops rte_table_hash_ext_dosig_ops  = {
 	.f_add = rte_table_hash_ext_entry_add,
 	.f_delete = rte_table_hash_ext_entry_delete,
 	.f_lookup = rte_table_hash_ext_lookup_dosig,
+	.f_age = rte_table_hash_ext_age,
 };
@@ -41,6 +41,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "table_hash_age.h"
 
 #define RTE_TABLE_HASH_KEY_SIZE						32
 
@@ -72,6 +73,11 @@ struct rte_table_hash {
 	rte_table_hash_op_hash f_hash;
 	uint64_t seed;
 
+	/* Per-entry aging */
+	uint32_t aging;
+	uint32_t entry_stride;
+	uint32_t age_bucket_index;
+
 	/* Extendible buckets */
 	uint32_t n_buckets_ext;
 	uint32_t stack_pos;
@@ -119,6 +125,7 @@ rte_table_hash_create_key32_lru(void *params,
 	struct rte_table_hash_key32_lru_params *p =
 		(struct rte_table_hash_key32_lru_params *) params;
 	struct rte_table_hash *f;
+	uint32_t entry_stride;
 	uint32_t n_buckets, n_entries_per_bucket, key_size, bucket_size_cl;
 	uint32_t total_size, i;
 
@@ -130,12 +137,13 @@ rte_table_hash_create_key32_lru(void *params,
 	}
 	n_entries_per_bucket = 4;
 	key_size = 32;
+	entry_stride = table_hash_age_entry_size(entry_size, p->aging);
 
 	/* Memory allocation */
 	n_buckets = rte_align32pow2((p->n_entries + n_entries_per_bucket - 1) /
 		n_entries_per_bucket);
 	bucket_size_cl = (sizeof(struct rte_bucket_4_32) + n_entries_per_bucket
-		* entry_size + RTE_CACHE_LINE_SIZE - 1) / RTE_CACHE_LINE_SIZE;
+		* entry_stride + RTE_CACHE_LINE_SIZE - 1) / RTE_CACHE_LINE_SIZE;
 	total_size = sizeof(struct rte_table_hash) + n_buckets *
 		bucket_size_cl * RTE_CACHE_LINE_SIZE;
 
@@ -160,6 +168,8 @@ rte_table_hash_create_key32_lru(void *params,
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	f->aging = p->aging;
+	f->entry_stride = entry_stride;
 
 	for (i = 0; i < n_buckets; i++) {
 		struct rte_bucket_4_32 *bucket;
@@ -213,9 +223,13 @@ rte_table_hash_entry_add_key32_lru(
 
 		if ((bucket_signature == signature) &&
 			(memcmp(key, bucket_key, f->key_size) == 0)) {
-			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
+			uint8_t *bucket_data = &bucket->data[i *
+				f->entry_stride];
 
 			memcpy(bucket_data, entry, f->entry_size);
+			if (f->aging)
+				table_hash_age_add(bucket_data,
+					f->entry_size, 1);
 			lru_update(bucket, i);
 			*key_found = 1;
 			*entry_ptr = (void *) bucket_data;
@@ -229,11 +243,15 @@ rte_table_hash_entry_add_key32_lru(
 		uint8_t *bucket_key = (uint8_t *) bucket->key[i];
 
 		if (bucket_signature == 0) {
-			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
+			uint8_t *bucket_data = &bucket->data[i *
+				f->entry_stride];
 
 			bucket->signature[i] = signature;
 			memcpy(bucket_key, key, f->key_size);
 			memcpy(bucket_data, entry, f->entry_size);
+			if (f->aging)
+				table_hash_age_add(bucket_data,
+					f->entry_size, 0);
 			lru_update(bucket, i);
 			*key_found = 0;
 			*entry_ptr = (void *) bucket_data;
@@ -246,10 +264,13 @@ rte_table_hash_entry_add_key32_lru(
 	pos = lru_pos(bucket);
 	bucket->signature[pos] = signature;
 	memcpy(bucket->key[pos], key, f->key_size);
-	memcpy(&bucket->data[pos * f->entry_size], entry, f->entry_size);
+	memcpy(&bucket->data[pos * f->entry_stride], entry, f->entry_size);
+	if (f->aging)
+		table_hash_age_add(&bucket->data[pos * f->entry_stride],
+			f->entry_size, 0);
 	lru_update(bucket, pos);
 	*key_found	= 0;
-	*entry_ptr = (void *) &bucket->data[pos * f->entry_size];
+	*entry_ptr = (void *) &bucket->data[pos * f->entry_stride];
 
 	return 0;
 }
@@ -279,7 +300,8 @@ rte_table_hash_entry_delete_key32_lru(
 
 		if ((bucket_signature == signature) &&
 			(memcmp(key, bucket_key, f->key_size) == 0)) {
-			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
+			uint8_t *bucket_data = &bucket->data[i *
+				f->entry_stride];
 
 			bucket->signature[i] = 0;
 			*key_found = 1;
@@ -339,6 +361,7 @@ rte_table_hash_create_key32_ext(void *params,
 	struct rte_table_hash_key32_ext_params *p =
 			(struct rte_table_hash_key32_ext_params *) params;
 	struct rte_table_hash *f;
+	uint32_t entry_stride;
 	uint32_t n_buckets, n_buckets_ext, n_entries_per_bucket;
 	uint32_t key_size, bucket_size_cl, stack_size_cl, total_size, i;
 
@@ -350,6 +373,7 @@ rte_table_hash_create_key32_ext(void *params,
 
 	n_entries_per_bucket = 4;
 	key_size = 32;
+	entry_stride = table_hash_age_entry_size(entry_size, p->aging);
 
 	/* Memory allocation */
 	n_buckets = rte_align32pow2((p->n_entries + n_entries_per_bucket - 1) /
@@ -357,7 +381,7 @@ rte_table_hash_create_key32_ext(void *params,
 	n_buckets_ext = (p->n_entries_ext + n_entries_per_bucket - 1) /
 		n_entries_per_bucket;
 	bucket_size_cl = (sizeof(struct rte_bucket_4_32) + n_entries_per_bucket
-		* entry_size + RTE_CACHE_LINE_SIZE - 1) / RTE_CACHE_LINE_SIZE;
+		* entry_stride + RTE_CACHE_LINE_SIZE - 1) / RTE_CACHE_LINE_SIZE;
 	stack_size_cl = (n_buckets_ext * sizeof(uint32_t) + RTE_CACHE_LINE_SIZE - 1)
 		/ RTE_CACHE_LINE_SIZE;
 	total_size = sizeof(struct rte_table_hash) +
@@ -385,6 +409,8 @@ rte_table_hash_create_key32_ext(void *params,
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	f->aging = p->aging;
+	f->entry_stride = entry_stride;
 
 	f->n_buckets_ext = n_buckets_ext;
 	f->stack_pos = n_buckets_ext;
@@ -440,9 +466,12 @@ rte_table_hash_entry_add_key32_ext(
 			if ((bucket_signature == signature) &&
 				(memcmp(key, bucket_key, f->key_size) == 0)) {
 				uint8_t *bucket_data = &bucket->data[i *
-					f->entry_size];
+					f->entry_stride];
 
 				memcpy(bucket_data, entry, f->entry_size);
+				if (f->aging)
+					table_hash_age_add(bucket_data,
+						f->entry_size, 1);
 				*key_found = 1;
 				*entry_ptr = (void *) bucket_data;
 
@@ -460,11 +489,14 @@ rte_table_hash_entry_add_key32_ext(
 
 			if (bucket_signature == 0) {
 				uint8_t *bucket_data = &bucket->data[i *
-					f->entry_size];
+					f->entry_stride];
 
 				bucket->signature[i] = signature;
 				memcpy(bucket_key, key, f->key_size);
 				memcpy(bucket_data, entry, f->entry_size);
+				if (f->aging)
+					table_hash_age_add(bucket_data,
+						f->entry_size, 0);
 				*key_found = 0;
 				*entry_ptr = (void *) bucket_data;
 
@@ -485,6 +517,8 @@ rte_table_hash_entry_add_key32_ext(
 		bucket->signature[0] = signature;
 		memcpy(bucket->key[0], key, f->key_size);
 		memcpy(&bucket->data[0], entry, f->entry_size);
+		if (f->aging)
+			table_hash_age_add(&bucket->data[0], f->entry_size, 0);
 		*key_found = 0;
 		*entry_ptr = (void *) &bucket->data[0];
 		return 0;
@@ -521,7 +555,7 @@ rte_table_hash_entry_delete_key32_ext(
 			if ((bucket_signature == signature) &&
 				(memcmp(key, bucket_key, f->key_size) == 0)) {
 				uint8_t *bucket_data = &bucket->data[i *
-					f->entry_size];
+					f->entry_stride];
 
 				bucket->signature[i] = 0;
 				*key_found = 1;
@@ -540,9 +574,9 @@ rte_table_hash_entry_delete_key32_ext(
 
 					memset(bucket, 0,
 						sizeof(struct rte_bucket_4_32));
-					bucket_index = (bucket -
-						((struct rte_bucket_4_32 *)
-						f->memory)) - f->n_buckets;
+					bucket_index = ((uint8_t *) bucket -
+						f->memory) / f->bucket_size -
+						f->n_buckets;
 					f->stack[f->stack_pos++] = bucket_index;
 				}
 
@@ -641,7 +675,7 @@ rte_table_hash_entry_delete_key32_ext(
 	pkt_mask = (bucket2->signature[pos] & 1LLU) << pkt2_index;\
 	pkts_mask_out |= pkt_mask;				\
 								\
-	a = (void *) &bucket2->data[pos * f->entry_size];	\
+	a = (void *) &bucket2->data[pos * f->entry_stride];	\
 	rte_prefetch0(a);					\
 	entries[pkt2_index] = a;				\
 	lru_update(bucket2, pos);				\
@@ -663,7 +697,7 @@ rte_table_hash_entry_delete_key32_ext(
 	pkt_mask = (bucket2->signature[pos] & 1LLU) << pkt2_index;\
 	pkts_mask_out |= pkt_mask;				\
 								\
-	a = (void *) &bucket2->data[pos * f->entry_size];	\
+	a = (void *) &bucket2->data[pos * f->entry_stride];	\
 	rte_prefetch0(a);					\
 	entries[pkt2_index] = a;				\
 								\
@@ -691,7 +725,7 @@ rte_table_hash_entry_delete_key32_ext(
 	pkt_mask = (bucket->signature[pos] & 1LLU) << pkt_index;\
 	pkts_mask_out |= pkt_mask;				\
 								\
-	a = (void *) &bucket->data[pos * f->entry_size];	\
+	a = (void *) &bucket->data[pos * f->entry_stride];	\
 	rte_prefetch0(a);					\
 	entries[pkt_index] = a;					\
 								\
@@ -789,8 +823,8 @@ rte_table_hash_entry_delete_key32_ext(
 	pkt21_mask = (bucket21->signature[pos21] & 1LLU) << pkt21_index;\
 	pkts_mask_out |= pkt20_mask | pkt21_mask;		\
 								\
-	a20 = (void *) &bucket20->data[pos20 * f->entry_size];	\
-	a21 = (void *) &bucket21->data[pos21 * f->entry_size];	\
+	a20 = (void *) &bucket20->data[pos20 * f->entry_stride];	\
+	a21 = (void *) &bucket21->data[pos21 * f->entry_stride];	\
 	rte_prefetch0(a20);					\
 	rte_prefetch0(a21);					\
 	entries[pkt20_index] = a20;				\
@@ -818,8 +852,8 @@ rte_table_hash_entry_delete_key32_ext(
 	pkt21_mask = (bucket21->signature[pos21] & 1LLU) << pkt21_index;\
 	pkts_mask_out |= pkt20_mask | pkt21_mask;		\
 								\
-	a20 = (void *) &bucket20->data[pos20 * f->entry_size];	\
-	a21 = (void *) &bucket21->data[pos21 * f->entry_size];	\
+	a20 = (void *) &bucket20->data[pos20 * f->entry_stride];	\
+	a21 = (void *) &bucket21->data[pos21 * f->entry_stride];	\
 	rte_prefetch0(a20);					\
 	rte_prefetch0(a21);					\
 	entries[pkt20_index] = a20;				\
@@ -864,6 +898,9 @@ rte_table_hash_lookup_key32_lru(
 					pkts_mask_out, entries, f);
 		}
 
+		if (f->aging)
+			table_hash_age_lookup(entries,
+				pkts_mask_out, f->entry_size);
 		*lookup_hit_mask = pkts_mask_out;
 		return 0;
 	}
@@ -954,6 +991,8 @@ rte_table_hash_lookup_key32_lru(
 	lookup2_stage2_lru(pkt20_index, pkt21_index,
 		mbuf20, mbuf21, bucket20, bucket21, pkts_mask_out, entries, f);
 
+	if (f->aging)
+		table_hash_age_lookup(entries, pkts_mask_out, f->entry_size);
 	*lookup_hit_mask = pkts_mask_out;
 	return 0;
 } /* rte_table_hash_lookup_key32_lru() */
@@ -1100,16 +1139,119 @@ grind_next_buckets:
 		buckets_mask = buckets_mask_next;
 	}
 
+	if (f->aging)
+		table_hash_age_lookup(entries, pkts_mask_out, f->entry_size);
 	*lookup_hit_mask = pkts_mask_out;
 	return 0;
 } /* rte_table_hash_lookup_key32_ext() */
 
+static int
+rte_table_hash_age_key32_lru(
+	void *table,
+	uint64_t expire_time,
+	uint32_t n_buckets,
+	int remove,
+	rte_table_age_report f_report,
+	void *arg)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint32_t i, j;
+	int n_expired = 0;
+
+	if (f->aging == 0)
+		return -ENOTSUP;
+
+	if (n_buckets > f->n_buckets)
+		n_buckets = f->n_buckets;
+
+	for (i = 0; i < n_buckets; i++) {
+		struct rte_bucket_4_32 *bucket = (struct rte_bucket_4_32 *)
+			&f->memory[f->age_bucket_index * f->bucket_size];
+
+		for (j = 0; j < 4; j++) {
+			uint8_t *bucket_data = &bucket->data[j *
+				f->entry_stride];
+
+			if ((bucket->signature[j] == 0) ||
+				(table_hash_age_check(bucket->key[j],
+				bucket_data, f->entry_size, expire_time,
+				f_report, arg) == 0))
+				continue;
+
+			n_expired++;
+			if (remove)
+				bucket->signature[j] = 0;
+		}
+
+		f->age_bucket_index = (f->age_bucket_index + 1) &
+			(f->n_buckets - 1);
+	}
+
+	return n_expired;
+}
+
+static int
+rte_table_hash_age_key32_ext(
+	void *table,
+	uint64_t expire_time,
+	uint32_t n_buckets,
+	int remove,
+	rte_table_age_report f_report,
+	void *arg)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint32_t i, j;
+	int n_expired = 0;
+
+	if (f->aging == 0)
+		return -ENOTSUP;
+
+	if (n_buckets > f->n_buckets)
+		n_buckets = f->n_buckets;
+
+	for (i = 0; i < n_buckets; i++) {
+		struct rte_bucket_4_32 *bucket, *bucket_next;
+
+		bucket = (struct rte_bucket_4_32 *)
+			&f->memory[f->age_bucket_index * f->bucket_size];
+
+		/* The delete may release the current extension bucket */
+		for ( ; bucket != NULL; bucket = bucket_next) {
+			bucket_next = bucket->next;
+
+			for (j = 0; j < 4; j++) {
+				uint8_t *bucket_data = &bucket->data[j *
+					f->entry_stride];
+				int key_found;
+
+				if ((bucket->signature[j] == 0) ||
+					(table_hash_age_check(bucket->key[j],
+					bucket_data, f->entry_size, expire_time,
+					f_report, arg) == 0))
+					continue;
+
+				n_expired++;
+				if (remove)
+					rte_table_hash_entry_delete_key32_ext(
+						f, bucket->key[j], &key_found,
+						NULL);
+			}
+		}
+
+		f->age_bucket_index = (f->age_bucket_index + 1) &
+			(f->n_buckets - 1);
+	}
+
+	return n_expired;
+}
+
 struct rte_table_ops rte_table_hash_key32_lru_ops = {
 	.f_create = rte_table_hash_create_key32_lru,
 	.f_free = rte_table_hash_free_key32_lru,
 	.f_add = rte_table_hash_entry_add_key32_lru,
 	.f_delete = rte_table_hash_entry_delete_key32_lru,
 	.f_lookup = rte_table_hash_lookup_key32_lru,
+	.f_age = rte_table_hash_age_key32_lru,
 };
 
 struct rte_table_ops rte_table_hash_key32_ext_ops = {
@@ -1118,4 +1260,5 @@ struct rte_table_ops rte_table_hash_key32_ext_ops = {
 	.f_add = rte_table_hash_entry_add_key32_ext,
 	.f_delete = rte_table_hash_entry_delete_key32_ext,
 	.f_lookup = rte_table_hash_lookup_key32_ext,
+	.f_age = rte_table_hash_age_key32_ext,
 };
@@ -41,6 +41,7 @@
 
 #include "rte_table_hash.h"
 #include "rte_lru.h"
+#include "table_hash_age.h"
 
 #define RTE_TABLE_HASH_KEY_SIZE						8
 
@@ -69,6 +70,11 @@ struct rte_table_hash {
 	rte_table_hash_op_hash f_hash;
 	uint64_t seed;
 
+	/* Per-entry aging */
+	uint32_t aging;
+	uint32_t entry_stride;
+	uint32_t age_bucket_index;
+
 	/* Extendible buckets */
 	uint32_t n_buckets_ext;
 	uint32_t stack_pos;
@@ -114,6 +120,7 @@ rte_table_hash_create_key8_lru(void *params, int socket_id, uint32_t entry_size)
 	struct rte_table_hash_key8_lru_params *p =
 		(struct rte_table_hash_key8_lru_params *) params;
 	struct rte_table_hash *f;
+	uint32_t entry_stride;
 	uint32_t n_buckets, n_entries_per_bucket, key_size, bucket_size_cl;
 	uint32_t total_size, i;
 
@@ -125,12 +132,13 @@ rte_table_hash_create_key8_lru(void *params, int socket_id, uint32_t entry_size)
 	}
 	n_entries_per_bucket = 4;
 	key_size = 8;
+	entry_stride = table_hash_age_entry_size(entry_size, p->aging);
 
 	/* Memory allocation */
 	n_buckets = rte_align32pow2((p->n_entries + n_entries_per_bucket - 1) /
 		n_entries_per_bucket);
 	bucket_size_cl = (sizeof(struct rte_bucket_4_8) + n_entries_per_bucket *
-		entry_size + RTE_CACHE_LINE_SIZE - 1) / RTE_CACHE_LINE_SIZE;
+		entry_stride + RTE_CACHE_LINE_SIZE - 1) / RTE_CACHE_LINE_SIZE;
 	total_size = sizeof(struct rte_table_hash) + n_buckets *
 		bucket_size_cl * RTE_CACHE_LINE_SIZE;
 
@@ -155,6 +163,8 @@ rte_table_hash_create_key8_lru(void *params, int socket_id, uint32_t entry_size)
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	f->aging = p->aging;
+	f->entry_stride = entry_stride;
 
 	for (i = 0; i < n_buckets; i++) {
 		struct rte_bucket_4_8 *bucket;
@@ -207,9 +217,13 @@ rte_table_hash_entry_add_key8_lru(
 
 		if ((bucket_signature & mask) &&
 		    (*((uint64_t *) key) == bucket_key)) {
-			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
+			uint8_t *bucket_data = &bucket->data[i *
+				f->entry_stride];
 
 			memcpy(bucket_data, entry, f->entry_size);
+			if (f->aging)
+				table_hash_age_add(bucket_data,
+					f->entry_size, 1);
 			lru_update(bucket, i);
 			*key_found = 1;
 			*entry_ptr = (void *) bucket_data;
@@ -222,11 +236,15 @@ rte_table_hash_entry_add_key8_lru(
 		uint64_t bucket_signature = bucket->signature;
 
 		if ((bucket_signature & mask) == 0) {
-			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
+			uint8_t *bucket_data = &bucket->data[i *
+				f->entry_stride];
 
 			bucket->signature |= mask;
 			bucket->key[i] = *((uint64_t *) key);
 			memcpy(bucket_data, entry, f->entry_size);
+			if (f->aging)
+				table_hash_age_add(bucket_data,
+					f->entry_size, 0);
 			lru_update(bucket, i);
 			*key_found = 0;
 			*entry_ptr = (void *) bucket_data;
@@ -238,10 +256,13 @@ rte_table_hash_entry_add_key8_lru(
 	/* Bucket full: replace LRU entry */
 	pos = lru_pos(bucket);
 	bucket->key[pos] = *((uint64_t *) key);
-	memcpy(&bucket->data[pos * f->entry_size], entry, f->entry_size);
+	memcpy(&bucket->data[pos * f->entry_stride], entry, f->entry_size);
+	if (f->aging)
+		table_hash_age_add(&bucket->data[pos * f->entry_stride],
+			f->entry_size, 0);
 	lru_update(bucket, pos);
 	*key_found	= 0;
-	*entry_ptr = (void *) &bucket->data[pos * f->entry_size];
+	*entry_ptr = (void *) &bucket->data[pos * f->entry_stride];
 
 	return 0;
 }
@@ -270,7 +291,8 @@ rte_table_hash_entry_delete_key8_lru(
 
 		if ((bucket_signature & mask) &&
 		    (*((uint64_t *) key) == bucket_key)) {
-			uint8_t *bucket_data = &bucket->data[i * f->entry_size];
+			uint8_t *bucket_data = &bucket->data[i *
+				f->entry_stride];
 
 			bucket->signature &= ~mask;
 			*key_found = 1;
@@ -328,6 +350,7 @@ rte_table_hash_create_key8_ext(void *params, int socket_id, uint32_t entry_size)
 	struct rte_table_hash_key8_ext_params *p =
 		(struct rte_table_hash_key8_ext_params *) params;
 	struct rte_table_hash *f;
+	uint32_t entry_stride;
 	uint32_t n_buckets, n_buckets_ext, n_entries_per_bucket, key_size;
 	uint32_t bucket_size_cl, stack_size_cl, total_size, i;
 
@@ -339,6 +362,7 @@ rte_table_hash_create_key8_ext(void *params, int socket_id, uint32_t entry_size)
 
 	n_entries_per_bucket = 4;
 	key_size = 8;
+	entry_stride = table_hash_age_entry_size(entry_size, p->aging);
 
 	/* Memory allocation */
 	n_buckets = rte_align32pow2((p->n_entries + n_entries_per_bucket - 1) /
@@ -346,7 +370,7 @@ rte_table_hash_create_key8_ext(void *params, int socket_id, uint32_t entry_size)
 	n_buckets_ext = (p->n_entries_ext + n_entries_per_bucket - 1) /
 		n_entries_per_bucket;
 	bucket_size_cl = (sizeof(struct rte_bucket_4_8) + n_entries_per_bucket *
-		entry_size + RTE_CACHE_LINE_SIZE - 1) / RTE_CACHE_LINE_SIZE;
+		entry_stride + RTE_CACHE_LINE_SIZE - 1) / RTE_CACHE_LINE_SIZE;
 	stack_size_cl = (n_buckets_ext * sizeof(uint32_t) + RTE_CACHE_LINE_SIZE - 1)
 		/ RTE_CACHE_LINE_SIZE;
 	total_size = sizeof(struct rte_table_hash) + ((n_buckets +
@@ -374,6 +398,8 @@ rte_table_hash_create_key8_ext(void *params, int socket_id, uint32_t entry_size)
 	f->key_offset = p->key_offset;
 	f->f_hash = p->f_hash;
 	f->seed = p->seed;
+	f->aging = p->aging;
+	f->entry_stride = entry_stride;
 
 	f->n_buckets_ext = n_buckets_ext;
 	f->stack_pos = n_buckets_ext;
@@ -430,9 +456,12 @@ rte_table_hash_entry_add_key8_ext(
 			if ((bucket_signature & mask) &&
 					(*((uint64_t *) key) == bucket_key)) {
 				uint8_t *bucket_data = &bucket->data[i *
-					f->entry_size];
+					f->entry_stride];
 
 				memcpy(bucket_data, entry, f->entry_size);
+				if (f->aging)
+					table_hash_age_add(bucket_data,
+						f->entry_size, 1);
 				*key_found = 1;
 				*entry_ptr = (void *) bucket_data;
 				return 0;
@@ -450,11 +479,14 @@ rte_table_hash_entry_add_key8_ext(
 
 			if ((bucket_signature & mask) == 0) {
 				uint8_t *bucket_data = &bucket->data[i *
-					f->entry_size];
+					f->entry_stride];
 
 				bucket->signature |= mask;
 				bucket->key[i] = *((uint64_t *) key);
 				memcpy(bucket_data, entry, f->entry_size);
+				if (f->aging)
+					table_hash_age_add(bucket_data,
+						f->entry_size, 0);
 				*key_found = 0;
 				*entry_ptr = (void *) bucket_data;
 
@@ -475,6 +507,8 @@ rte_table_hash_entry_add_key8_ext(
 		bucket->signature = 1;
 		bucket->key[0] = *((uint64_t *) key);
 		memcpy(&bucket->data[0], entry, f->entry_size);
+		if (f->aging)
+			table_hash_age_add(&bucket->data[0], f->entry_size, 0);
 		*key_found = 0;
 		*entry_ptr = (void *) &bucket->data[0];
 		return 0;
@@ -512,7 +546,7 @@ rte_table_hash_entry_delete_key8_ext(
 			if ((bucket_signature & mask) &&
 				(*((uint64_t *) key) == bucket_key)) {
 				uint8_t *bucket_data = &bucket->data[i *
-					f->entry_size];
+					f->entry_stride];
 
 				bucket->signature &= ~mask;
 				*key_found = 1;
@@ -528,9 +562,9 @@ rte_table_hash_entry_delete_key8_ext(
 
 					memset(bucket, 0,
 						sizeof(struct rte_bucket_4_8));
-					bucket_index = (bucket -
-						((struct rte_bucket_4_8 *)
-						f->memory)) - f->n_buckets;
+					bucket_index = ((uint8_t *) bucket -
+						f->memory) / f->bucket_size -
+						f->n_buckets;
 					f->stack[f->stack_pos++] = bucket_index;
 				}
 
@@ -619,7 +653,7 @@ rte_table_hash_entry_delete_key8_ext(
 	pkt_mask = ((bucket2->signature >> pos) & 1LLU) << pkt2_index;\
 	pkts_mask_out |= pkt_mask;				\
 								\
-	a = (void *) &bucket2->data[pos * f->entry_size];	\
+	a = (void *) &bucket2->data[pos * f->entry_stride];	\
 	rte_prefetch0(a);					\
 	entries[pkt2_index] = a;				\
 	lru_update(bucket2, pos);				\
@@ -641,7 +675,7 @@ rte_table_hash_entry_delete_key8_ext(
 	pkt_mask = ((bucket2->signature >> pos) & 1LLU) << pkt2_index;\
 	pkts_mask_out |= pkt_mask;				\
 								\
-	a = (void *) &bucket2->data[pos * f->entry_size];	\
+	a = (void *) &bucket2->data[pos * f->entry_stride];	\
 	rte_prefetch0(a);					\
 	entries[pkt2_index] = a;				\
 								\
@@ -669,7 +703,7 @@ rte_table_hash_entry_delete_key8_ext(
 	pkt_mask = ((bucket->signature >> pos) & 1LLU) << pkt_index;\
 	pkts_mask_out |= pkt_mask;				\
 								\
-	a = (void *) &bucket->data[pos * f->entry_size];	\
+	a = (void *) &bucket->data[pos * f->entry_stride];	\
 	rte_prefetch0(a);					\
 	entries[pkt_index] = a;					\
 								\
@@ -785,8 +819,8 @@ rte_table_hash_entry_delete_key8_ext(
 	pkt21_mask = ((bucket21->signature >> pos21) & 1LLU) << pkt21_index;\
 	pkts_mask_out |= pkt20_mask | pkt21_mask;		\
 								\
-	a20 = (void *) &bucket20->data[pos20 * f->entry_size];	\
-	a21 = (void *) &bucket21->data[pos21 * f->entry_size];	\
+	a20 = (void *) &bucket20->data[pos20 * f->entry_stride];	\
+	a21 = (void *) &bucket21->data[pos21 * f->entry_stride];	\
 	rte_prefetch0(a20);					\
 	rte_prefetch0(a21);					\
 	entries[pkt20_index] = a20;				\
@@ -814,8 +848,8 @@ rte_table_hash_entry_delete_key8_ext(
 	pkt21_mask = ((bucket21->signature >> pos21) & 1LLU) << pkt21_index;\
 	pkts_mask_out |= pkt20_mask | pkt21_mask;		\
 								\
-	a20 = (void *) &bucket20->data[pos20 * f->entry_size];	\
-	a21 = (void *) &bucket21->data[pos21 * f->entry_size];	\
+	a20 = (void *) &bucket20->data[pos20 * f->entry_stride];	\
+	a21 = (void *) &bucket21->data[pos21 * f->entry_stride];	\
 	rte_prefetch0(a20);					\
 	rte_prefetch0(a21);					\
 	entries[pkt20_index] = a20;				\
@@ -860,6 +894,9 @@ rte_table_hash_lookup_key8_lru(
 					pkts_mask_out, entries, f);
 		}
 
+		if (f->aging)
+			table_hash_age_lookup(entries,
+				pkts_mask_out, f->entry_size);
 		*lookup_hit_mask = pkts_mask_out;
 		return 0;
 	}
@@ -949,6 +986,8 @@ rte_table_hash_lookup_key8_lru(
 	lookup2_stage2_lru(pkt20_index, pkt21_index, mbuf20, mbuf21,
 		bucket20, bucket21, pkts_mask_out, entries, f);
 
+	if (f->aging)
+		table_hash_age_lookup(entries, pkts_mask_out, f->entry_size);
 	*lookup_hit_mask = pkts_mask_out;
 	return 0;
 } /* rte_table_hash_lookup_key8_lru() */
@@ -981,6 +1020,9 @@ rte_table_hash_lookup_key8_lru_dosig(
 				pkts_mask_out, entries, f);
 		}
 
+		if (f->aging)
+			table_hash_age_lookup(entries,
+				pkts_mask_out, f->entry_size);
 		*lookup_hit_mask = pkts_mask_out;
 		return 0;
 	}
@@ -1070,6 +1112,8 @@ rte_table_hash_lookup_key8_lru_dosig(
 	lookup2_stage2_lru(pkt20_index, pkt21_index, mbuf20, mbuf21,
 		bucket20, bucket21, pkts_mask_out, entries, f);
 
+	if (f->aging)
+		table_hash_age_lookup(entries, pkts_mask_out, f->entry_size);
 	*lookup_hit_mask = pkts_mask_out;
 	return 0;
 } /* rte_table_hash_lookup_key8_lru_dosig() */
@@ -1216,6 +1260,8 @@ grind_next_buckets:
 		buckets_mask = buckets_mask_next;
 	}
 
+	if (f->aging)
+		table_hash_age_lookup(entries, pkts_mask_out, f->entry_size);
 	*lookup_hit_mask = pkts_mask_out;
 	return 0;
 } /* rte_table_hash_lookup_key8_ext() */
@@ -1362,16 +1408,119 @@ grind_next_buckets:
 		buckets_mask = buckets_mask_next;
 	}
 
+	if (f->aging)
+		table_hash_age_lookup(entries, pkts_mask_out, f->entry_size);
 	*lookup_hit_mask = pkts_mask_out;
 	return 0;
 } /* rte_table_hash_lookup_key8_dosig_ext() */
 
+static int
+rte_table_hash_age_key8_lru(
+	void *table,
+	uint64_t expire_time,
+	uint32_t n_buckets,
+	int remove,
+	rte_table_age_report f_report,
+	void *arg)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint32_t i, j;
+	int n_expired = 0;
+
+	if (f->aging == 0)
+		return -ENOTSUP;
+
+	if (n_buckets > f->n_buckets)
+		n_buckets = f->n_buckets;
+
+	for (i = 0; i < n_buckets; i++) {
+		struct rte_bucket_4_8 *bucket = (struct rte_bucket_4_8 *)
+			&f->memory[f->age_bucket_index * f->bucket_size];
+
+		for (j = 0; j < 4; j++) {
+			uint8_t *bucket_data = &bucket->data[j *
+				f->entry_stride];
+
+			if (((bucket->signature & (1LLU << j)) == 0) ||
+				(table_hash_age_check(&bucket->key[j],
+				bucket_data, f->entry_size, expire_time,
+				f_report, arg) == 0))
+				continue;
+
+			n_expired++;
+			if (remove)
+				bucket->signature &= ~(1LLU << j);
+		}
+
+		f->age_bucket_index = (f->age_bucket_index + 1) &
+			(f->n_buckets - 1);
+	}
+
+	return n_expired;
+}
+
+static int
+rte_table_hash_age_key8_ext(
+	void *table,
+	uint64_t expire_time,
+	uint32_t n_buckets,
+	int remove,
+	rte_table_age_report f_report,
+	void *arg)
+{
+	struct rte_table_hash *f = (struct rte_table_hash *) table;
+	uint32_t i, j;
+	int n_expired = 0;
+
+	if (f->aging == 0)
+		return -ENOTSUP;
+
+	if (n_buckets > f->n_buckets)
+		n_buckets = f->n_buckets;
+
+	for (i = 0; i < n_buckets; i++) {
+		struct rte_bucket_4_8 *bucket, *bucket_next;
+
+		bucket = (struct rte_bucket_4_8 *)
+			&f->memory[f->age_bucket_index * f->bucket_size];
+
+		/* The delete may release the current extension bucket */
+		for ( ; bucket != NULL; bucket = bucket_next) {
+			bucket_next = bucket->next;
+
+			for (j = 0; j < 4; j++) {
+				uint8_t *bucket_data = &bucket->data[j *
+					f->entry_stride];
+				int key_found;
+
+				if (((bucket->signature & (1LLU << j)) == 0) ||
+					(table_hash_age_check(&bucket->key[j],
+					bucket_data, f->entry_size, expire_time,
+					f_report, arg) == 0))
+					continue;
+
+				n_expired++;
+				if (remove)
+					rte_table_hash_entry_delete_key8_ext(
+						f, &bucket->key[j], &key_found,
+						NULL);
+			}
+		}
+
+		f->age_bucket_index = (f->age_bucket_index + 1) &
+			(f->n_buckets - 1);
+	}
+
+	return n_expired;
+}
+
 struct rte_table_ops rte_table_hash_key8_lru_ops = {
 	.f_create = rte_table_hash_create_key8_lru,
 	.f_free = rte_table_hash_free_key8_lru,
 	.f_add = rte_table_hash_entry_add_key8_lru,
 	.f_delete = rte_table_hash_entry_delete_key8_lru,
 	.f_lookup = rte_table_hash_lookup_key8_lru,
+	.f_age = rte_table_hash_age_key8_lru,
 };
 
 struct rte_table_ops rte_table_hash_key8_lru_dosig_ops = {
@@ -1380,6 +1529,7 @@ struct rte_table_ops rte_table_hash_key8_lru_dosig_ops = {
 	.f_add = rte_table_hash_entry_add_key8_lru,
 	.f_delete = rte_table_hash_entry_delete_key8_lru,
 	.f_lookup = rte_table_hash_lookup_key8_lru_dosig,
+	.f_age = rte_table_hash_age_key8_lru,
 };
 
 struct rte_table_ops rte_table_hash_key8_ext_ops = {
@@ -1388,6 +1538,7 @@ struct rte_table_ops rte_table_hash_key8_ext_ops = {
 	.f_add = rte_table_hash_entry_add_key8_ext,
 	.f_delete = rte_table_hash_entry_delete_key8_ext,
 	.f_lookup = rte_table_hash_lookup_key8_ext,
+	.f_age = rte_table_hash_age_key8_ext,
 };
 
 struct rte_table_ops rte_table_hash_key8_ext_dosig_ops = {
@@ -1396,4 +1547,5 @@ struct rte_table_ops rte_table_hash_key8_ext_dosig_ops = {
 	.f_add = rte_table_hash_entry_add_key8_ext,
 	.f_delete = rte_table_hash_entry_delete_key8_ext,
 	.f_lookup = rte_table_hash_lookup_key8_ext_dosig,
+	.f_age = rte_table_hash_age_key8_ext,
 };
@@ -40,6 +40,7 @@
 #include <rte_malloc.h>
 #include <rte_byteorder.h>
 #include <rte_log.h>
+#include <rte_prefetch.h>
 #include <rte_lpm.h>
 
 #include "rte_table_lpm.h"
@@ -186,7 +187,7 @@ rte_table_lpm_entry_add(
 	struct rte_table_lpm_key *ip_prefix = (struct rte_table_lpm_key *) key;
 	uint32_t nht_pos, nht_pos0_valid;
 	int status;
-	uint8_t nht_pos0 = 0;
+	uint32_t nht_pos0 = 0;
 
 	/* Check input parameters */
 	if (lpm == NULL) {
@@ -229,7 +230,7 @@ rte_table_lpm_entry_add(
 
 	/* Add rule to low level LPM table */
 	if (rte_lpm_add(lpm->lpm, ip_prefix->ip, ip_prefix->depth,
-		(uint8_t) nht_pos) < 0) {
+		nht_pos) < 0) {
 		RTE_LOG(ERR, TABLE, "%s: LPM rule add failed\n", __func__);
 		return -1;
 	}
@@ -252,7 +253,7 @@ rte_table_lpm_entry_delete(
 {
 	struct rte_table_lpm *lpm = (struct rte_table_lpm *) table;
 	struct rte_table_lpm_key *ip_prefix = (struct rte_table_lpm_key *) key;
-	uint8_t nht_pos;
+	uint32_t nht_pos;
 	int status;
 
 	/* Check input parameters */
@@ -301,6 +302,9 @@ rte_table_lpm_entry_delete(
 	return 0;
 }
 
+/* Next hop value of the lookup misses, out of the range of LPM next hops */
+#define RTE_TABLE_LPM_LOOKUP_MISS                          UINT32_MAX
+
 static int
 rte_table_lpm_lookup(
 	void *table,
@@ -310,27 +314,70 @@ rte_table_lpm_lookup(
 	void **entries)
 {
 	struct rte_table_lpm *lpm = (struct rte_table_lpm *) table;
+	struct rte_lpm *l = lpm->lpm;
+	uint32_t ips[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t nht_pos[RTE_PORT_IN_BURST_SIZE_MAX];
 	uint64_t pkts_out_mask = 0;
-	uint32_t i;
+	uint32_t n_pkts, i;
+
+	if (pkts_mask == 0) {
+		*lookup_hit_mask = 0;
+		return 0;
+	}
+
+	n_pkts = RTE_PORT_IN_BURST_SIZE_MAX - __builtin_clzll(pkts_mask);
+
+	/*
+	 * The lookup is done in stages over the whole burst, so that the memory
+	 * accesses of each stage are prefetched by the previous stage for all
+	 * the packets, instead of being serialized packet by packet.
+	 */
+
+	/* Stage 0: prefetch the packet meta-data */
+	for (i = 0; i < n_pkts; i++)
+		if (pkts_mask & (1LLU << i))
+			rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(pkts[i],
+				lpm->offset));
+
+	/* Stage 1: read the IP address, prefetch the tbl24 entry */
+	for (i = 0; i < n_pkts; i++) {
+		uint32_t ip = 0;
+
+		if (pkts_mask & (1LLU << i))
+			ip = rte_bswap32(RTE_MBUF_METADATA_UINT32(pkts[i],
+				lpm->offset));
+
+		ips[i] = ip;
+		rte_prefetch0(&l->tbl24[ip >> 8]);
+	}
+	for ( ; i & 3; i++)
+		ips[i] = 0;
+
+	/* Stage 2: prefetch the tbl8 entry, when needed */
+	for (i = 0; i < n_pkts; i++) {
+		struct rte_lpm_tbl24_entry *e = &l->tbl24[ips[i] >> 8];
+
+		if (unlikely(e->valid && e->ext_entry))
+			rte_prefetch0(&l->tbl8[(uint8_t) ips[i] +
+				e->next_hop * RTE_LPM_TBL8_GROUP_NUM_ENTRIES]);
+	}
+
+	/* Stage 3: lookup, four packets at a time */
+	for (i = 0; i < n_pkts; i += 4) {
+		__m128i ip = _mm_loadu_si128((__m128i *) &ips[i]);
+
+		rte_lpm_lookupx4(l, ip, &nht_pos[i],
+			RTE_TABLE_LPM_LOOKUP_MISS);
+	}
 
-	pkts_out_mask = 0;
-	for (i = 0; i < (uint32_t)(RTE_PORT_IN_BURST_SIZE_MAX -
-		__builtin_clzll(pkts_mask)); i++) {
+	for (i = 0; i < n_pkts; i++) {
 		uint64_t pkt_mask = 1LLU << i;
 
-		if (pkt_mask & pkts_mask) {
-			struct rte_mbuf *pkt = pkts[i];
-			uint32_t ip = rte_bswap32(
-				RTE_MBUF_METADATA_UINT32(pkt, lpm->offset));
-			int status;
-			uint8_t nht_pos;
-
-			status = rte_lpm_lookup(lpm->lpm, ip, &nht_pos);
-			if (status == 0) {
-				pkts_out_mask |= pkt_mask;
-				entries[i] = (void *) &lpm->nht[nht_pos *
-					lpm->entry_size];
-			}
+		if ((pkt_mask & pkts_mask) &&
+			(nht_pos[i] != RTE_TABLE_LPM_LOOKUP_MISS)) {
+			pkts_out_mask |= pkt_mask;
+			entries[i] = (void *) &lpm->nht[nht_pos[i] *
+				lpm->entry_size];
 		}
 	}
 
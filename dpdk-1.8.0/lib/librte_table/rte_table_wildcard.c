@@ -0,0 +1,703 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdio.h>
+
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_memory.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+#include <rte_log.h>
+
+#include "rte_table_wildcard.h"
+
+#define KEY_WORDS_MAX							\
+	(RTE_TABLE_WILDCARD_KEY_SIZE_MAX / sizeof(uint64_t))
+
+#define INDEX_INVALID	UINT32_MAX
+
+struct rule {
+	uint32_t next;       /* Next rule in the same hash chain */
+	uint32_t sig;        /* Hash of the masked key */
+	uint32_t group;      /* Group of the rule mask */
+	int32_t priority;
+	uint32_t group_next; /* Next rule of the same group */
+	uint32_t group_prev; /* Previous rule of the same group */
+
+	/* Masked key, followed by the entry data */
+	uint64_t key[0];
+};
+
+struct group {
+	uint64_t mask[KEY_WORDS_MAX];
+	uint32_t n_rules;
+	int32_t priority;    /* Highest priority of the group rules */
+	uint32_t n_rules_top; /* Number of group rules with this priority */
+	uint32_t rules;      /* First rule of the group */
+} __rte_cache_aligned;
+
+struct rte_table_wildcard {
+	/* Input parameters */
+	uint32_t key_size;
+	uint32_t entry_size;
+	uint32_t n_rules;
+	uint32_t n_masks;
+	uint32_t key_offset;
+
+	/* Internal */
+	uint32_t n_key_words;
+	uint32_t rule_size_shl;
+	uint32_t bucket_mask;
+	uint32_t rule_stack_tos;
+	uint32_t n_groups;
+
+	/* Tables */
+	struct group *groups;
+	uint32_t *group_order; /* Groups in use, by decreasing priority */
+	uint32_t *buckets;     /* Hash chain heads, shared by all the groups */
+	uint8_t *rule_mem;
+	uint32_t *rule_stack;
+
+	/* Table memory */
+	uint8_t memory[0] __rte_cache_aligned;
+};
+
+#define RULE(t, rule_index)						\
+	((struct rule *)						\
+	&(t)->rule_mem[((uint64_t) (rule_index)) << (t)->rule_size_shl])
+
+#define RULE_DATA(t, r)							\
+	(&((uint8_t *) (r)->key)[(t)->key_size])
+
+static inline uint32_t
+key_hash(uint64_t *key, uint32_t n_key_words, uint32_t group_id)
+{
+	uint64_t h = (group_id + 1) * 0x9E3779B97F4A7C15LLU;
+	uint32_t i;
+
+	for (i = 0; i < n_key_words; i++) {
+		h ^= key[i];
+		h *= 0xff51afd7ed558ccdLLU;
+		h ^= h >> 33;
+	}
+
+	return (uint32_t) h;
+}
+
+static inline int
+key_equal(uint64_t *a, uint64_t *b, uint32_t n_key_words)
+{
+	uint64_t x = 0;
+	uint32_t i;
+
+	for (i = 0; i < n_key_words; i++)
+		x |= a[i] ^ b[i];
+
+	return x == 0;
+}
+
+static int
+check_params_create(struct rte_table_wildcard_params *params)
+{
+	/* key_size */
+	if ((params->key_size == 0) ||
+		(params->key_size > RTE_TABLE_WILDCARD_KEY_SIZE_MAX) ||
+		((params->key_size & 0x7) != 0)) {
+		RTE_LOG(ERR, TABLE, "%s: key_size invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	/* n_rules */
+	if (params->n_rules == 0) {
+		RTE_LOG(ERR, TABLE, "%s: n_rules invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	/* n_masks */
+	if (params->n_masks == 0) {
+		RTE_LOG(ERR, TABLE, "%s: n_masks invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	/* key_offset */
+	if ((params->key_offset & 0x7) != 0) {
+		RTE_LOG(ERR, TABLE, "%s: key_offset invalid value\n", __func__);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static void *
+rte_table_wildcard_create(void *params, int socket_id, uint32_t entry_size)
+{
+	struct rte_table_wildcard_params *p =
+		(struct rte_table_wildcard_params *) params;
+	struct rte_table_wildcard *t;
+	uint64_t total_size, rule_sz;
+	uint32_t table_meta_sz, group_sz, group_order_sz, bucket_sz;
+	uint32_t rule_stack_sz, n_buckets, rule_size;
+	uint32_t group_offset, group_order_offset, bucket_offset, rule_offset;
+	uint32_t rule_stack_offset;
+	uint32_t i;
+
+	/* Check input parameters */
+	if ((p == NULL) ||
+		(check_params_create(p) != 0) ||
+		((sizeof(struct rte_table_wildcard) % RTE_CACHE_LINE_SIZE) !=
+		0))
+		return NULL;
+
+	/* Memory allocation */
+	n_buckets = rte_align32pow2(p->n_rules);
+	rule_size = rte_align32pow2(sizeof(struct rule) + p->key_size +
+		entry_size);
+
+	table_meta_sz =
+		RTE_CACHE_LINE_ROUNDUP(sizeof(struct rte_table_wildcard));
+	group_sz = RTE_CACHE_LINE_ROUNDUP(p->n_masks * sizeof(struct group));
+	group_order_sz = RTE_CACHE_LINE_ROUNDUP(p->n_masks * sizeof(uint32_t));
+	bucket_sz = RTE_CACHE_LINE_ROUNDUP(n_buckets * sizeof(uint32_t));
+	rule_sz = RTE_CACHE_LINE_ROUNDUP((uint64_t) p->n_rules * rule_size);
+	rule_stack_sz = RTE_CACHE_LINE_ROUNDUP(p->n_rules * sizeof(uint32_t));
+	total_size = (uint64_t) table_meta_sz + group_sz + group_order_sz +
+		bucket_sz + rule_sz + rule_stack_sz;
+	if (total_size > UINT32_MAX) {
+		RTE_LOG(ERR, TABLE, "%s: Wildcard table too big\n", __func__);
+		return NULL;
+	}
+
+	t = rte_zmalloc_socket("TABLE", total_size, RTE_CACHE_LINE_SIZE,
+		socket_id);
+	if (t == NULL) {
+		RTE_LOG(ERR, TABLE,
+			"%s: Cannot allocate %u bytes for wildcard table\n",
+			__func__, (uint32_t) total_size);
+		return NULL;
+	}
+	RTE_LOG(INFO, TABLE, "%s: Wildcard table memory footprint is "
+		"%u bytes\n", __func__, (uint32_t) total_size);
+
+	/* Memory initialization */
+	t->key_size = p->key_size;
+	t->entry_size = entry_size;
+	t->n_rules = p->n_rules;
+	t->n_masks = p->n_masks;
+	t->key_offset = p->key_offset;
+
+	/* Internal */
+	t->n_key_words = p->key_size / sizeof(uint64_t);
+	t->rule_size_shl = __builtin_ctz(rule_size);
+	t->bucket_mask = n_buckets - 1;
+
+	/* Tables */
+	group_offset = 0;
+	group_order_offset = group_offset + group_sz;
+	bucket_offset = group_order_offset + group_order_sz;
+	rule_offset = bucket_offset + bucket_sz;
+	rule_stack_offset = rule_offset + rule_sz;
+
+	t->groups = (struct group *) &t->memory[group_offset];
+	t->group_order = (uint32_t *) &t->memory[group_order_offset];
+	t->buckets = (uint32_t *) &t->memory[bucket_offset];
+	t->rule_mem = &t->memory[rule_offset];
+	t->rule_stack = (uint32_t *) &t->memory[rule_stack_offset];
+
+	for (i = 0; i < n_buckets; i++)
+		t->buckets[i] = INDEX_INVALID;
+
+	/* Rule stack */
+	for (i = 0; i < t->n_rules; i++)
+		t->rule_stack[i] = t->n_rules - 1 - i;
+	t->rule_stack_tos = t->n_rules;
+
+	return t;
+}
+
+static int
+rte_table_wildcard_free(void *table)
+{
+	struct rte_table_wildcard *t = (struct rte_table_wildcard *) table;
+
+	/* Check input parameters */
+	if (t == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+
+	rte_free(t);
+	return 0;
+}
+
+/* Keep the groups in use sorted by decreasing priority (insertion sort) */
+static void
+group_order_update(struct rte_table_wildcard *t)
+{
+	uint32_t i;
+
+	for (i = 1; i < t->n_groups; i++) {
+		uint32_t group_id = t->group_order[i];
+		int32_t priority = t->groups[group_id].priority;
+		uint32_t j;
+
+		for (j = i; (j > 0) &&
+			(t->groups[t->group_order[j - 1]].priority > priority);
+			j--)
+			t->group_order[j] = t->group_order[j - 1];
+
+		t->group_order[j] = group_id;
+	}
+}
+
+static uint32_t
+group_find(struct rte_table_wildcard *t, uint64_t *mask)
+{
+	uint32_t i;
+
+	for (i = 0; i < t->n_groups; i++) {
+		uint32_t group_id = t->group_order[i];
+
+		if (key_equal(t->groups[group_id].mask, mask, t->n_key_words))
+			return group_id;
+	}
+
+	return INDEX_INVALID;
+}
+
+static uint32_t
+group_alloc(struct rte_table_wildcard *t, uint64_t *mask)
+{
+	uint32_t group_id;
+
+	if (t->n_groups == t->n_masks)
+		return INDEX_INVALID;
+
+	for (group_id = 0; t->groups[group_id].n_rules != 0; group_id++)
+		;
+
+	memcpy(t->groups[group_id].mask, mask, t->key_size);
+	t->groups[group_id].rules = INDEX_INVALID;
+	t->group_order[t->n_groups++] = group_id;
+
+	return group_id;
+}
+
+static void
+group_free(struct rte_table_wildcard *t, uint32_t group_id)
+{
+	uint32_t i;
+
+	for (i = 0; t->group_order[i] != group_id; i++)
+		;
+
+	for ( ; i < t->n_groups - 1; i++)
+		t->group_order[i] = t->group_order[i + 1];
+
+	t->n_groups--;
+}
+
+/*
+ * Rescan the group rules, only needed once the last rule holding the group
+ * priority is deleted or demoted.
+ */
+static void
+group_priority_compute(struct rte_table_wildcard *t, struct group *g)
+{
+	uint32_t pos;
+
+	g->priority = INT32_MAX;
+	g->n_rules_top = 0;
+	for (pos = g->rules; pos != INDEX_INVALID; ) {
+		struct rule *r = RULE(t, pos);
+
+		if (r->priority < g->priority) {
+			g->priority = r->priority;
+			g->n_rules_top = 1;
+		} else if (r->priority == g->priority)
+			g->n_rules_top++;
+
+		pos = r->group_next;
+	}
+}
+
+/* Account for a rule of the group getting the given priority */
+static void
+group_priority_add(struct group *g, int32_t priority)
+{
+	if (priority < g->priority) {
+		g->priority = priority;
+		g->n_rules_top = 1;
+	} else if (priority == g->priority)
+		g->n_rules_top++;
+}
+
+static uint32_t
+rule_find(struct rte_table_wildcard *t, uint32_t group_id, uint64_t *key,
+	uint32_t sig)
+{
+	uint32_t pos;
+
+	for (pos = t->buckets[sig & t->bucket_mask]; pos != INDEX_INVALID; ) {
+		struct rule *r = RULE(t, pos);
+
+		if ((r->sig == sig) && (r->group == group_id) &&
+			key_equal(r->key, key, t->n_key_words))
+			return pos;
+
+		pos = r->next;
+	}
+
+	return INDEX_INVALID;
+}
+
+/* Rule mask and masked rule key */
+static void
+rule_key_mask(struct rte_table_wildcard *t, uint8_t *key_in, uint8_t *mask_in,
+	uint64_t *key, uint64_t *mask)
+{
+	uint32_t i;
+
+	memcpy(key, key_in, t->key_size);
+	memcpy(mask, mask_in, t->key_size);
+
+	for (i = 0; i < t->n_key_words; i++)
+		key[i] &= mask[i];
+}
+
+static int
+rte_table_wildcard_entry_add(
+	void *table,
+	void *key,
+	void *entry,
+	int *key_found,
+	void **entry_ptr)
+{
+	struct rte_table_wildcard *t = (struct rte_table_wildcard *) table;
+	struct rte_table_wildcard_rule_add_params *rule =
+		(struct rte_table_wildcard_rule_add_params *) key;
+	uint64_t rule_key[KEY_WORDS_MAX], rule_mask[KEY_WORDS_MAX];
+	struct group *g;
+	struct rule *r;
+	uint32_t group_id, pos, sig;
+
+	/* Check input parameters */
+	if (table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (key == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (entry == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: entry parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (key_found == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key_found parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+	if (entry_ptr == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: entry_ptr parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	rule_key_mask(t, rule->key, rule->mask, rule_key, rule_mask);
+	group_id = group_find(t, rule_mask);
+
+	/* Rule already present: update its priority and entry */
+	if (group_id != INDEX_INVALID) {
+		sig = key_hash(rule_key, t->n_key_words, group_id);
+		pos = rule_find(t, group_id, rule_key, sig);
+		if (pos != INDEX_INVALID) {
+			int32_t priority;
+
+			g = &t->groups[group_id];
+			r = RULE(t, pos);
+			priority = r->priority;
+
+			r->priority = rule->priority;
+			memcpy(RULE_DATA(t, r), entry, t->entry_size);
+
+			if (priority == g->priority)
+				g->n_rules_top--;
+			group_priority_add(g, rule->priority);
+			if (g->n_rules_top == 0)
+				group_priority_compute(t, g);
+			if (g->priority != priority)
+				group_order_update(t);
+
+			*key_found = 1;
+			*entry_ptr = (void *) RULE_DATA(t, r);
+			return 0;
+		}
+	}
+
+	/* New rule */
+	if (t->rule_stack_tos == 0)
+		return -ENOSPC;
+
+	if (group_id == INDEX_INVALID) {
+		group_id = group_alloc(t, rule_mask);
+		if (group_id == INDEX_INVALID)
+			return -ENOSPC;
+
+		sig = key_hash(rule_key, t->n_key_words, group_id);
+	}
+
+	g = &t->groups[group_id];
+	pos = t->rule_stack[--t->rule_stack_tos];
+	r = RULE(t, pos);
+
+	memcpy(r->key, rule_key, t->key_size);
+	memcpy(RULE_DATA(t, r), entry, t->entry_size);
+	r->sig = sig;
+	r->group = group_id;
+	r->priority = rule->priority;
+
+	/* Link the rule into its hash chain and its group */
+	r->next = t->buckets[sig & t->bucket_mask];
+	t->buckets[sig & t->bucket_mask] = pos;
+
+	r->group_prev = INDEX_INVALID;
+	r->group_next = g->rules;
+	if (g->rules != INDEX_INVALID)
+		RULE(t, g->rules)->group_prev = pos;
+	g->rules = pos;
+
+	if (g->n_rules++ == 0) {
+		g->priority = rule->priority;
+		g->n_rules_top = 1;
+		group_order_update(t);
+	} else if (rule->priority <= g->priority) {
+		int32_t priority = g->priority;
+
+		group_priority_add(g, rule->priority);
+		if (g->priority != priority)
+			group_order_update(t);
+	}
+
+	*key_found = 0;
+	*entry_ptr = (void *) RULE_DATA(t, r);
+	return 0;
+}
+
+static int
+rte_table_wildcard_entry_delete(
+	void *table,
+	void *key,
+	int *key_found,
+	void *entry)
+{
+	struct rte_table_wildcard *t = (struct rte_table_wildcard *) table;
+	struct rte_table_wildcard_rule_delete_params *rule =
+		(struct rte_table_wildcard_rule_delete_params *) key;
+	uint64_t rule_key[KEY_WORDS_MAX], rule_mask[KEY_WORDS_MAX];
+	struct group *g;
+	struct rule *r;
+	uint32_t group_id, pos, sig, *link;
+
+	/* Check input parameters */
+	if (table == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: table parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (key == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key parameter is NULL\n", __func__);
+		return -EINVAL;
+	}
+	if (key_found == NULL) {
+		RTE_LOG(ERR, TABLE, "%s: key_found parameter is NULL\n",
+			__func__);
+		return -EINVAL;
+	}
+
+	rule_key_mask(t, rule->key, rule->mask, rule_key, rule_mask);
+	group_id = group_find(t, rule_mask);
+	if (group_id == INDEX_INVALID) {
+		*key_found = 0;
+		return 0;
+	}
+
+	sig = key_hash(rule_key, t->n_key_words, group_id);
+	pos = rule_find(t, group_id, rule_key, sig);
+	if (pos == INDEX_INVALID) {
+		*key_found = 0;
+		return 0;
+	}
+
+	g = &t->groups[group_id];
+	r = RULE(t, pos);
+
+	/* Unlink the rule from its hash chain and its group */
+	for (link = &t->buckets[sig & t->bucket_mask]; *link != pos;
+		link = &RULE(t, *link)->next)
+		;
+	*link = r->next;
+
+	if (r->group_prev != INDEX_INVALID)
+		RULE(t, r->group_prev)->group_next = r->group_next;
+	else
+		g->rules = r->group_next;
+	if (r->group_next != INDEX_INVALID)
+		RULE(t, r->group_next)->group_prev = r->group_prev;
+
+	if (entry)
+		memcpy(entry, RULE_DATA(t, r), t->entry_size);
+
+	t->rule_stack[t->rule_stack_tos++] = pos;
+
+	if (--g->n_rules == 0)
+		group_free(t, group_id);
+	else if ((r->priority == g->priority) && (--g->n_rules_top == 0)) {
+		group_priority_compute(t, g);
+		group_order_update(t);
+	}
+
+	*key_found = 1;
+	return 0;
+}
+
+static int
+rte_table_wildcard_lookup(
+	void *table,
+	struct rte_mbuf **pkts,
+	uint64_t pkts_mask,
+	uint64_t *lookup_hit_mask,
+	void **entries)
+{
+	struct rte_table_wildcard *t = (struct rte_table_wildcard *) table;
+	uint64_t keys[RTE_PORT_IN_BURST_SIZE_MAX][KEY_WORDS_MAX];
+	struct rule *match[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t sig[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint32_t pos[RTE_PORT_IN_BURST_SIZE_MAX];
+	uint64_t pkts_mask_match = 0, pkts_mask_todo = pkts_mask, m;
+	uint32_t n_key_words = t->n_key_words, i;
+
+	/* Prefetch the packet keys */
+	for (m = pkts_mask; m; m &= m - 1)
+		rte_prefetch0(RTE_MBUF_METADATA_UINT8_PTR(
+			pkts[__builtin_ctzll(m)], t->key_offset));
+
+	/*
+	 * Search the groups by decreasing priority, each one in stages over all
+	 * the packets still to be resolved.
+	 */
+	for (i = 0; (i < t->n_groups) && pkts_mask_todo; i++) {
+		uint32_t group_id = t->group_order[i];
+		struct group *g = &t->groups[group_id];
+
+		/*
+		 * Done with the packets whose match has higher or equal
+		 * priority than any rule of this group and of the next ones
+		 */
+		for (m = pkts_mask_todo & pkts_mask_match; m; m &= m - 1) {
+			uint32_t pkt_index = __builtin_ctzll(m);
+
+			if (match[pkt_index]->priority <= g->priority)
+				pkts_mask_todo &= ~(1LLU << pkt_index);
+		}
+
+		/* Stage 0: mask the key, hash it, prefetch the chain head */
+		for (m = pkts_mask_todo; m; m &= m - 1) {
+			uint32_t pkt_index = __builtin_ctzll(m);
+			uint64_t *pkt_key = RTE_MBUF_METADATA_UINT64_PTR(
+				pkts[pkt_index], t->key_offset);
+			uint64_t *key = keys[pkt_index];
+			uint32_t j;
+
+			for (j = 0; j < n_key_words; j++)
+				key[j] = pkt_key[j] & g->mask[j];
+
+			sig[pkt_index] = key_hash(key, n_key_words, group_id);
+			rte_prefetch0(&t->buckets[sig[pkt_index] &
+				t->bucket_mask]);
+		}
+
+		/* Stage 1: read the chain head, prefetch the first rule */
+		for (m = pkts_mask_todo; m; m &= m - 1) {
+			uint32_t pkt_index = __builtin_ctzll(m);
+
+			pos[pkt_index] = t->buckets[sig[pkt_index] &
+				t->bucket_mask];
+			if (pos[pkt_index] != INDEX_INVALID)
+				rte_prefetch0(RULE(t, pos[pkt_index]));
+		}
+
+		/* Stage 2: walk the chain, keep the best match */
+		for (m = pkts_mask_todo; m; m &= m - 1) {
+			uint32_t pkt_index = __builtin_ctzll(m);
+			uint64_t pkt_mask = 1LLU << pkt_index;
+			uint32_t p;
+
+			for (p = pos[pkt_index]; p != INDEX_INVALID; ) {
+				struct rule *r = RULE(t, p);
+
+				if ((r->sig == sig[pkt_index]) &&
+					(r->group == group_id) &&
+					key_equal(r->key, keys[pkt_index],
+					n_key_words)) {
+					if (((pkts_mask_match & pkt_mask) ==
+						0) || (r->priority <
+						match[pkt_index]->priority))
+						match[pkt_index] = r;
+					pkts_mask_match |= pkt_mask;
+					break;
+				}
+
+				p = r->next;
+			}
+		}
+	}
+
+	for (m = pkts_mask_match; m; m &= m - 1) {
+		uint32_t pkt_index = __builtin_ctzll(m);
+
+		entries[pkt_index] = (void *) RULE_DATA(t, match[pkt_index]);
+	}
+
+	*lookup_hit_mask = pkts_mask_match;
+	return 0;
+}
+
+struct rte_table_ops rte_table_wildcard_ops = {
+	.f_create = rte_table_wildcard_create,
+	.f_free = rte_table_wildcard_free,
+	.f_add = rte_table_wildcard_entry_add,
+	.f_delete = rte_table_wildcard_entry_delete,
+	.f_lookup = rte_table_wildcard_lookup,
+};
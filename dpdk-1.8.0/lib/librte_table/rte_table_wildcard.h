@@ -0,0 +1,118 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_RTE_TABLE_WILDCARD_H__
+#define __INCLUDE_RTE_TABLE_WILDCARD_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file
+ * RTE Table Wildcard
+ *
+ * This table associates data to ternary (value/mask) rules with priorities,
+ * using tuple space search. The rules sharing the same mask are grouped
+ * together and each group is an exact match hash table on the masked key.
+ * The lookup operation searches the groups in the order of the highest
+ * priority of their rules and stops as soon as no remaining group can hold
+ * a rule of higher priority than the best one already found.
+ *
+ * Rule add and delete are constant time hash table operations, plus a
+ * reorder of the groups (linear in the number of masks) when the highest
+ * priority of a group changes. Deleting the last rule that holds the highest
+ * priority of its group, or giving it a lower priority, also rescans the
+ * rules of that group to find its new highest priority. This table fits rule
+ * sets of up to a few thousand rules, using a few tens of distinct masks,
+ * that change frequently.
+ *
+ * Use-cases: OpenFlow-style flow tables, ingress/egress filters, etc.
+ *
+ ***/
+
+#include <stdint.h>
+
+#include "rte_table.h"
+
+/** Maximum key size (in bytes) */
+#define RTE_TABLE_WILDCARD_KEY_SIZE_MAX                          64
+
+/** Wildcard table parameters */
+struct rte_table_wildcard_params {
+	/** Key size (number of bytes). Has to be a non-zero multiple of 8 and
+	no bigger than RTE_TABLE_WILDCARD_KEY_SIZE_MAX. */
+	uint32_t key_size;
+
+	/** Maximum number of rules in the table */
+	uint32_t n_rules;
+
+	/** Maximum number of distinct rule masks in the table */
+	uint32_t n_masks;
+
+	/** Byte offset within packet meta-data where the key is located. Has to
+	be a multiple of 8. */
+	uint32_t key_offset;
+};
+
+/** Wildcard rule specification for entry add operation */
+struct rte_table_wildcard_rule_add_params {
+	/** Rule priority, with 0 as the highest priority. When the lookup key
+	matches several rules of the same priority, any of them can be
+	picked. */
+	int32_t priority;
+
+	/** Rule key, only the bits set in the mask are relevant */
+	uint8_t key[RTE_TABLE_WILDCARD_KEY_SIZE_MAX];
+
+	/** Rule mask, the bits set to 1 have to match the lookup key */
+	uint8_t mask[RTE_TABLE_WILDCARD_KEY_SIZE_MAX];
+};
+
+/** Wildcard rule specification for entry delete operation */
+struct rte_table_wildcard_rule_delete_params {
+	/** Rule key, only the bits set in the mask are relevant */
+	uint8_t key[RTE_TABLE_WILDCARD_KEY_SIZE_MAX];
+
+	/** Rule mask */
+	uint8_t mask[RTE_TABLE_WILDCARD_KEY_SIZE_MAX];
+};
+
+/** Wildcard table operations */
+extern struct rte_table_ops rte_table_wildcard_ops;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
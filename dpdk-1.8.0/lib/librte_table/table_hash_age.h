@@ -0,0 +1,129 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2010-2014 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __INCLUDE_TABLE_HASH_AGE_H__
+#define __INCLUDE_TABLE_HASH_AGE_H__
+
+/*
+ * Per-entry aging support shared by the hash tables. When aging is enabled,
+ * the aging information is stored right after the data of each table entry,
+ * so that it sits in the cache lines already brought in by the lookup and by
+ * the subsequent access to the entry data.
+ */
+
+#include <stdint.h>
+
+#include <rte_common.h>
+#include <rte_cycles.h>
+
+#include "rte_table.h"
+
+struct table_hash_age {
+	uint64_t last_hit;
+	uint64_t n_hits;
+};
+
+/* Byte offset of the aging information within the table entry */
+#define TABLE_HASH_AGE_OFFSET(entry_size)				\
+	RTE_ALIGN_CEIL(entry_size, sizeof(uint64_t))
+
+/* Table entry size including the aging information, when enabled */
+static inline uint32_t
+table_hash_age_entry_size(uint32_t entry_size, uint32_t aging)
+{
+	if (aging == 0)
+		return entry_size;
+
+	return TABLE_HASH_AGE_OFFSET(entry_size) +
+		sizeof(struct table_hash_age);
+}
+
+static inline struct table_hash_age *
+table_hash_age_get(void *entry, uint32_t entry_size)
+{
+	return (struct table_hash_age *)
+		&((uint8_t *) entry)[TABLE_HASH_AGE_OFFSET(entry_size)];
+}
+
+/* Entry add: reset the hit counter of new keys, refresh existing keys */
+static inline void
+table_hash_age_add(void *entry, uint32_t entry_size, int key_found)
+{
+	struct table_hash_age *age = table_hash_age_get(entry, entry_size);
+
+	age->last_hit = rte_rdtsc();
+	if (!key_found)
+		age->n_hits = 0;
+}
+
+/*
+ * Lookup: record the hits of the current burst. The time stamp is read once
+ * per burst and only the entries just returned by the lookup are written.
+ */
+static inline void
+table_hash_age_lookup(void **entries, uint64_t lookup_hit_mask,
+	uint32_t entry_size)
+{
+	uint64_t now;
+
+	if (lookup_hit_mask == 0)
+		return;
+
+	now = rte_rdtsc();
+	for ( ; lookup_hit_mask; lookup_hit_mask &= lookup_hit_mask - 1) {
+		uint32_t pkt_index = __builtin_ctzll(lookup_hit_mask);
+		struct table_hash_age *age =
+			table_hash_age_get(entries[pkt_index], entry_size);
+
+		age->last_hit = now;
+		age->n_hits++;
+	}
+}
+
+/* Aging scan: report the entry when expired, return 1 if expired */
+static inline int
+table_hash_age_check(void *key, void *entry, uint32_t entry_size,
+	uint64_t expire_time, rte_table_age_report f_report, void *arg)
+{
+	struct table_hash_age *age = table_hash_age_get(entry, entry_size);
+
+	if (age->last_hit >= expire_time)
+		return 0;
+
+	if (f_report != NULL)
+		f_report(key, entry, age->last_hit, age->n_hits, arg);
+
+	return 1;
+}
+
+#endif
@@ -50,11 +50,59 @@
 #include <rte_branch_prediction.h>
 #include <rte_spinlock.h>
 #include <rte_random.h>
+#include <rte_malloc.h>
+#include <rte_prefetch.h>
+#include <rte_log.h>
+#include <rte_ring.h>
 
 #include "rte_timer.h"
 
 LIST_HEAD(rte_timer_list, rte_timer);
 
+#define TIMER_WHEEL_LEVELS      4
+#define TIMER_WHEEL_SLOTS_LOG2  8
+#define TIMER_WHEEL_SLOTS       (1 << TIMER_WHEEL_SLOTS_LOG2)
+#define TIMER_WHEEL_SLOT_MASK   (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_N_SLOTS     (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS)
+/* ticks covered by the wheel, farther timers are cascaded more than once */
+#define TIMER_WHEEL_MAX_DELTA \
+	((1ULL << (TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS_LOG2)) - 1)
+/* expired timers collected per list lock acquisition */
+#define TIMER_WHEEL_RUN_BATCH   32
+
+/*
+ * Hierarchical timer wheel of one lcore. The slots of level 0 hold the
+ * timers expiring at each of the next 256 ticks; a slot of level n holds
+ * the timers of 256^n consecutive ticks, which are cascaded to the lower
+ * levels when the wheel turns to them.
+ */
+struct timer_wheel {
+	uint64_t cur_tick;   /**< next tick to process */
+	uint64_t n_pending;  /**< number of timers in the wheel */
+	/** bitmap of the non-empty slots */
+	uint64_t slot_bmp[TIMER_WHEEL_N_SLOTS / 64];
+	/** slot lists, level after level */
+	struct rte_timer *slot[TIMER_WHEEL_N_SLOTS];
+} __rte_cache_aligned;
+
+#define TIMER_MBOX_SIZE         4096 /* requests per target lcore */
+#define TIMER_MBOX_BURST        32   /* requests applied per lock */
+
+/* flags of a mailbox request */
+#define TIMER_MBOX_DEL          0x1  /* remove from the target list first */
+
+/*
+ * Request to arm a timer, posted by an lcore to the lcore owning the list
+ * of pending timers to update. The timer stays in the CONFIG state until
+ * the target lcore applies the request.
+ */
+struct timer_mbox_req {
+	struct rte_timer *tim;
+	uint64_t expire;     /**< new expiry time */
+	uint32_t flags;
+	uint32_t reserved;
+};
+
 struct priv_timer {
 	struct rte_timer pending_head;  /**< dummy timer instance to head up list */
 	rte_spinlock_t list_lock;       /**< lock to protect list access */
@@ -68,6 +116,12 @@ struct priv_timer {
 
 	unsigned prev_lcore;              /**< used for lcore round robin */
 
+	/** timer wheel, when it is the selected backend */
+	struct timer_wheel *wheel;
+
+	/** ring of the requests posted by the other lcores */
+	struct rte_ring *mbox;
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
@@ -77,6 +131,15 @@ struct priv_timer {
 /** per-lcore private info for timers */
 static struct priv_timer priv_timer[RTE_MAX_LCORE];
 
+/** implementation of the pending timer lists, common to all lcores */
+static enum rte_timer_backend timer_backend = RTE_TIMER_BACKEND_SKIPLIST;
+
+/** log2 of the timer wheel tick, in timer cycles */
+static unsigned timer_wheel_tick_shift;
+
+/** true if the cross-lcore requests go through the mailboxes */
+static int timer_mbox_enabled;
+
 /* when debug is enabled, store some statistics */
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 #define __TIMER_STAT_ADD(name, n) do {				\
@@ -102,6 +165,119 @@ rte_timer_subsystem_init(void)
 	}
 }
 
+/* Select the implementation of the pending timer lists. */
+int
+rte_timer_subsystem_backend_set(enum rte_timer_backend backend,
+		uint64_t resolution)
+{
+	uint64_t cur_tick;
+	unsigned lcore_id, shift;
+
+	if ((backend != RTE_TIMER_BACKEND_SKIPLIST &&
+			backend != RTE_TIMER_BACKEND_WHEEL) ||
+			(backend == RTE_TIMER_BACKEND_WHEEL &&
+			(resolution == 0 || resolution > (1ULL << 62)))) {
+		RTE_LOG(ERR, TIMER, "%s: invalid parameters\n", __func__);
+		return -EINVAL;
+	}
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		struct priv_timer *priv = &priv_timer[lcore_id];
+
+		/* a posted request adds its timer to the list of the
+		 * backend selected when it is applied */
+		if (priv->pending_head.sl_next[0] != NULL ||
+				(priv->wheel != NULL &&
+				priv->wheel->n_pending != 0) ||
+				(priv->mbox != NULL &&
+				!rte_ring_empty(priv->mbox))) {
+			RTE_LOG(ERR, TIMER, "%s: timers pending on lcore %u\n",
+				__func__, lcore_id);
+			return -EBUSY;
+		}
+	}
+
+	if (backend == RTE_TIMER_BACKEND_SKIPLIST) {
+		timer_backend = backend;
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+			rte_free(priv_timer[lcore_id].wheel);
+			priv_timer[lcore_id].wheel = NULL;
+		}
+		return 0;
+	}
+
+	for (shift = 0; (1ULL << shift) < resolution; shift++)
+		;
+	cur_tick = rte_get_timer_cycles() >> shift;
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		struct priv_timer *priv = &priv_timer[lcore_id];
+
+		if (priv->wheel == NULL) {
+			priv->wheel = rte_zmalloc_socket("TIMER_WHEEL",
+				sizeof(struct timer_wheel), RTE_CACHE_LINE_SIZE,
+				rte_lcore_to_socket_id(lcore_id));
+			if (priv->wheel == NULL) {
+				RTE_LOG(ERR, TIMER,
+					"%s: cannot allocate timer wheel\n",
+					__func__);
+				return -ENOMEM;
+			}
+		}
+		priv->wheel->cur_tick = cur_tick;
+	}
+
+	timer_wheel_tick_shift = shift;
+	timer_backend = backend;
+
+	return 0;
+}
+
+/* Enable or disable the lcore mailboxes. */
+int
+rte_timer_subsystem_mailbox_set(int enable)
+{
+	char name[RTE_RING_NAMESIZE];
+	unsigned lcore_id;
+
+	if (enable == 0) {
+		RTE_LCORE_FOREACH(lcore_id) {
+			struct rte_ring *r = priv_timer[lcore_id].mbox;
+
+			if (r != NULL && !rte_ring_empty(r)) {
+				RTE_LOG(ERR, TIMER, "%s: requests pending on "
+					"lcore %u\n", __func__, lcore_id);
+				return -EBUSY;
+			}
+		}
+		timer_mbox_enabled = 0;
+		return 0;
+	}
+
+	/* the rings cannot be freed, they are kept when disabled */
+	RTE_LCORE_FOREACH(lcore_id) {
+		struct rte_ring *r;
+
+		if (priv_timer[lcore_id].mbox != NULL)
+			continue;
+
+		snprintf(name, sizeof(name), "TIMER_MBOX_%u", lcore_id);
+		r = rte_ring_create_elem(name, sizeof(struct timer_mbox_req),
+			TIMER_MBOX_SIZE, rte_lcore_to_socket_id(lcore_id),
+			RING_F_SC_DEQ);
+		if (r == NULL) {
+			RTE_LOG(ERR, TIMER, "%s: cannot create ring %s\n",
+				__func__, name);
+			return -ENOMEM;
+		}
+		priv_timer[lcore_id].mbox = r;
+	}
+
+	timer_mbox_enabled = 1;
+
+	return 0;
+}
+
 /* Initialize the timer handle tim for use */
 void
 rte_timer_init(struct rte_timer *tim)
@@ -263,6 +439,207 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 	}
 }
 
+/* insert the timer at the head of a wheel slot */
+static inline void
+timer_wheel_link(struct timer_wheel *w, unsigned slot, struct rte_timer *tim)
+{
+	struct rte_timer **head = &w->slot[slot];
+
+	tim->wl.next = *head;
+	if (*head != NULL)
+		(*head)->wl.pprev = &tim->wl.next;
+	tim->wl.pprev = head;
+	*head = tim;
+
+	w->slot_bmp[slot / 64] |= 1ULL << (slot % 64);
+}
+
+/* remove the timer from its wheel slot */
+static inline void
+timer_wheel_unlink(struct timer_wheel *w, struct rte_timer *tim)
+{
+	struct rte_timer **pprev = tim->wl.pprev;
+	struct rte_timer *next = tim->wl.next;
+
+	*pprev = next;
+	if (next != NULL)
+		next->wl.pprev = pprev;
+	else if (pprev >= &w->slot[0] && pprev < &w->slot[TIMER_WHEEL_N_SLOTS]) {
+		/* the slot is now empty */
+		unsigned slot = pprev - &w->slot[0];
+
+		w->slot_bmp[slot / 64] &= ~(1ULL << (slot % 64));
+	}
+}
+
+/* detach the whole list of a wheel slot */
+static inline struct rte_timer *
+timer_wheel_slot_take(struct timer_wheel *w, unsigned slot)
+{
+	struct rte_timer *tim = w->slot[slot];
+
+	w->slot[slot] = NULL;
+	w->slot_bmp[slot / 64] &= ~(1ULL << (slot % 64));
+
+	return tim;
+}
+
+/* hash the timer into the slot matching its distance to the current tick */
+static void
+timer_wheel_insert(struct timer_wheel *w, struct rte_timer *tim)
+{
+	uint64_t mask = (1ULL << timer_wheel_tick_shift) - 1;
+	uint64_t tick, delta;
+	unsigned level;
+
+	/* round up, so that the timer never expires early */
+	tick = (tim->expire + mask) >> timer_wheel_tick_shift;
+	if (tick < w->cur_tick)
+		tick = w->cur_tick;
+
+	delta = tick - w->cur_tick;
+	if (delta > TIMER_WHEEL_MAX_DELTA) {
+		delta = TIMER_WHEEL_MAX_DELTA;
+		tick = w->cur_tick + delta;
+	}
+
+	level = (delta < TIMER_WHEEL_SLOTS) ? 0 :
+		(63 - __builtin_clzll(delta)) / TIMER_WHEEL_SLOTS_LOG2;
+
+	timer_wheel_link(w, level * TIMER_WHEEL_SLOTS +
+		((tick >> (level * TIMER_WHEEL_SLOTS_LOG2)) &
+		TIMER_WHEEL_SLOT_MASK), tim);
+}
+
+static void
+timer_wheel_add(struct timer_wheel *w, struct rte_timer *tim)
+{
+	/* an empty wheel is not turned by rte_timer_manage(), catch up now
+	 * rather than cascading through all the elapsed ticks later */
+	if (w->n_pending == 0) {
+		uint64_t cur_tick = rte_get_timer_cycles() >>
+			timer_wheel_tick_shift;
+
+		if (cur_tick > w->cur_tick)
+			w->cur_tick = cur_tick;
+	}
+
+	timer_wheel_insert(w, tim);
+	w->n_pending++;
+}
+
+static void
+timer_wheel_del(struct timer_wheel *w, struct rte_timer *tim)
+{
+	timer_wheel_unlink(w, tim);
+	w->n_pending--;
+}
+
+/* re-hash the timers of a slot of an upper level into the lower levels */
+static void
+timer_wheel_cascade(struct timer_wheel *w, unsigned slot)
+{
+	struct rte_timer *tim, *next_tim;
+
+	for (tim = timer_wheel_slot_take(w, slot); tim != NULL; tim = next_tim) {
+		next_tim = tim->wl.next;
+		rte_prefetch0(next_tim);
+		timer_wheel_insert(w, tim);
+	}
+}
+
+/* first non-empty slot of level 0 starting from idx, TIMER_WHEEL_SLOTS if
+ * none */
+static inline unsigned
+timer_wheel_next_slot(struct timer_wheel *w, unsigned idx)
+{
+	unsigned i = idx / 64;
+	uint64_t bmp;
+
+	if (idx == TIMER_WHEEL_SLOTS)
+		return TIMER_WHEEL_SLOTS;
+
+	for (bmp = w->slot_bmp[i] & (~0ULL << (idx % 64)); ; ) {
+		if (bmp != 0)
+			return i * 64 + __builtin_ctzll(bmp);
+		if (++i == TIMER_WHEEL_SLOTS / 64)
+			return TIMER_WHEEL_SLOTS;
+		bmp = w->slot_bmp[i];
+	}
+}
+
+/*
+ * Move the wheel to the given tick. When level 0 wraps around, the next
+ * slot of level 1 is cascaded, and so on for the upper levels.
+ */
+static void
+timer_wheel_turn(struct timer_wheel *w, uint64_t tick)
+{
+	unsigned level;
+
+	w->cur_tick = tick;
+	if ((tick & TIMER_WHEEL_SLOT_MASK) != 0)
+		return;
+
+	for (level = 1; level < TIMER_WHEEL_LEVELS; level++) {
+		unsigned i = (tick >> (level * TIMER_WHEEL_SLOTS_LOG2)) &
+			TIMER_WHEEL_SLOT_MASK;
+
+		timer_wheel_cascade(w, level * TIMER_WHEEL_SLOTS + i);
+		if (i != 0)
+			break;
+	}
+}
+
+/*
+ * Turn the wheel up to cur_tick (included) and return the list, linked
+ * through wl.run_next, of up to n_max expired timers that were moved to
+ * the RUNNING state. The expired timers left in the wheel are collected
+ * by the next call. Called with the list lock held.
+ */
+static struct rte_timer *
+timer_wheel_expire(struct timer_wheel *w, uint64_t cur_tick, unsigned n_max)
+{
+	struct rte_timer *run_first = NULL, **run_last = &run_first;
+	unsigned n = 0;
+
+	while (w->cur_tick <= cur_tick) {
+		uint64_t base = w->cur_tick & ~(uint64_t)TIMER_WHEEL_SLOT_MASK;
+		unsigned idx = w->cur_tick & TIMER_WHEEL_SLOT_MASK;
+		unsigned slot_next = (idx + 1) & TIMER_WHEEL_SLOT_MASK;
+		struct rte_timer *tim;
+
+		while ((tim = w->slot[idx]) != NULL) {
+			if (n == n_max)
+				goto done;
+
+			rte_prefetch0(tim->wl.next);
+			timer_wheel_unlink(w, tim);
+
+			/* the timer is being stopped or reset by another
+			 * core, waiting for the list lock to remove it: keep
+			 * it in the wheel until then */
+			if (timer_set_running_state(tim) < 0) {
+				timer_wheel_link(w, slot_next, tim);
+				continue;
+			}
+
+			w->n_pending--;
+			*run_last = tim;
+			run_last = &tim->wl.run_next;
+			n++;
+		}
+
+		/* skip the empty slots, up to the next wrap around */
+		idx = timer_wheel_next_slot(w, idx + 1);
+		timer_wheel_turn(w, RTE_MIN(base + idx, cur_tick + 1));
+	}
+
+done:
+	*run_last = NULL;
+	return run_first;
+}
+
 /*
  * add in list, lock if needed
  * timer must be in config state
@@ -281,6 +658,11 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 	if (tim_lcore != lcore_id || !local_is_locked)
 		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
 
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL) {
+		timer_wheel_add(priv_timer[tim_lcore].wheel, tim);
+		goto done;
+	}
+
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
 	timer_get_prev_entries(tim->expire, tim_lcore, prev);
@@ -305,6 +687,7 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 	priv_timer[tim_lcore].pending_head.expire = priv_timer[tim_lcore].\
 			pending_head.sl_next[0]->expire;
 
+done:
 	if (tim_lcore != lcore_id || !local_is_locked)
 		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
 }
@@ -329,6 +712,11 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
 
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL) {
+		timer_wheel_del(priv_timer[prev_owner].wheel, tim);
+		goto done;
+	}
+
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
 	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
@@ -349,10 +737,92 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 		else
 			break;
 
+done:
 	if (prev_owner != lcore_id || !local_is_locked)
 		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
 }
 
+/*
+ * Return the ring to post requests from lcore src to lcore dst, NULL if
+ * dst list must be updated directly.
+ */
+static inline struct rte_ring *
+timer_mbox_ring(unsigned src, unsigned dst)
+{
+	if (!timer_mbox_enabled || src == dst || src >= RTE_MAX_LCORE)
+		return NULL;
+
+	return priv_timer[dst].mbox;
+}
+
+/* post a request, return 0 on success or -ENOBUFS if the ring is full */
+static inline int
+timer_mbox_post(struct rte_ring *r, struct rte_timer *tim, uint64_t expire,
+		uint32_t flags)
+{
+	struct timer_mbox_req req;
+
+	req.tim = tim;
+	req.expire = expire;
+	req.flags = flags;
+	req.reserved = 0;
+
+	return rte_ring_mp_enqueue_bulk_elem(r, &req, sizeof(req), 1);
+}
+
+/*
+ * Apply the requests posted to this lcore by the other ones. The timers
+ * are in the CONFIG state: only this lcore can modify them now.
+ */
+static void
+timer_mbox_drain(unsigned lcore_id)
+{
+	struct timer_mbox_req req[TIMER_MBOX_BURST];
+	union rte_timer_status prev_status, status;
+	unsigned j, n;
+
+	prev_status.state = RTE_TIMER_PENDING;
+	prev_status.owner = (int16_t)lcore_id;
+
+	do {
+		n = rte_ring_sc_dequeue_burst_elem(priv_timer[lcore_id].mbox,
+			req, sizeof(req[0]), TIMER_MBOX_BURST);
+		if (n == 0)
+			break;
+
+		rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+		for (j = 0; j < n; j++) {
+			struct rte_timer *tim = req[j].tim;
+
+			if (req[j].flags & TIMER_MBOX_DEL)
+				timer_del(tim, prev_status, 1);
+
+			tim->expire = req[j].expire;
+			timer_add(tim, lcore_id, 1);
+
+			rte_wmb();
+			status.state = RTE_TIMER_PENDING;
+			status.owner = (int16_t)lcore_id;
+			tim->status.u32 = status.u32;
+		}
+		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	} while (n == TIMER_MBOX_BURST);
+}
+
+/*
+ * Called while waiting for a timer in the CONFIG state: the request
+ * being waited for may be in the mailbox of this lcore.
+ */
+static inline void
+timer_mbox_sync(void)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	if (timer_mbox_enabled && lcore_id < RTE_MAX_LCORE &&
+			priv_timer[lcore_id].mbox != NULL)
+		timer_mbox_drain(lcore_id);
+}
+
 /* Reset and start the timer associated with the timer handle (private func) */
 static int
 __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
@@ -361,6 +831,8 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 		  int local_is_locked)
 {
 	union rte_timer_status prev_status, status;
+	struct rte_ring *mbox;
+	uint32_t mbox_flags = 0;
 	int ret;
 	unsigned lcore_id = rte_lcore_id();
 
@@ -382,18 +854,37 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 		priv_timer[lcore_id].updated = 1;
 	}
 
+	/* the list of another lcore is updated by this lcore itself, when
+	 * the mailboxes are enabled */
+	mbox = timer_mbox_ring(lcore_id, tim_lcore);
+
 	/* remove it from list */
 	if (prev_status.state == RTE_TIMER_PENDING) {
-		timer_del(tim, prev_status, local_is_locked);
+		if (mbox != NULL && (unsigned)prev_status.owner == tim_lcore)
+			mbox_flags |= TIMER_MBOX_DEL;
+		else
+			timer_del(tim, prev_status, local_is_locked);
 		__TIMER_STAT_ADD(pending, -1);
 	}
 
+	/* the expiry time is only updated out of the list, as it orders the
+	 * skiplist */
 	tim->period = period;
-	tim->expire = expire;
 	tim->f = fct;
 	tim->arg = arg;
 
 	__TIMER_STAT_ADD(pending, 1);
+
+	/* the target lcore sets the PENDING state */
+	if (mbox != NULL && timer_mbox_post(mbox, tim, expire,
+			mbox_flags) == 0)
+		return 0;
+
+	/* no mailbox, or it is full */
+	if (mbox_flags & TIMER_MBOX_DEL)
+		timer_del(tim, prev_status, local_is_locked);
+
+	tim->expire = expire;
 	timer_add(tim, tim_lcore, local_is_locked);
 
 	/* update state: as we are in CONFIG state, only us can modify
@@ -424,10 +915,8 @@ rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
 	else
 		period = 0;
 
-	__rte_timer_reset(tim,  cur_time + ticks, period, tim_lcore,
-			  fct, arg, 0);
-
-	return 0;
+	return __rte_timer_reset(tim,  cur_time + ticks, period, tim_lcore,
+			 fct, arg, 0);
 }
 
 /* loop until rte_timer_reset() succeed */
@@ -437,7 +926,8 @@ rte_timer_reset_sync(struct rte_timer *tim, uint64_t ticks,
 		     rte_timer_cb_t fct, void *arg)
 {
 	while (rte_timer_reset(tim, ticks, type, tim_lcore,
-			       fct, arg) != 0);
+			       fct, arg) != 0)
+		timer_mbox_sync();
 }
 
 /* Stop the timer associated with the timer handle tim */
@@ -459,7 +949,8 @@ rte_timer_stop(struct rte_timer *tim)
 		priv_timer[lcore_id].updated = 1;
 	}
 
-	/* remove it from list */
+	/* remove it from list; this is never posted to the mailbox of the
+	 * owner, so that the timer can be freed as soon as we return */
 	if (prev_status.state == RTE_TIMER_PENDING) {
 		timer_del(tim, prev_status, 0);
 		__TIMER_STAT_ADD(pending, -1);
@@ -474,12 +965,16 @@ rte_timer_stop(struct rte_timer *tim)
 	return 0;
 }
 
-/* loop until rte_timer_stop() succeed */
+/* loop until rte_timer_stop() succeed, the timer is then stopped */
 void
 rte_timer_stop_sync(struct rte_timer *tim)
 {
-	while (rte_timer_stop(tim) != 0)
+	while (rte_timer_stop(tim) != 0) {
+		/* the timer may be in CONFIG state until we apply a reset
+		 * request posted to this lcore */
+		timer_mbox_sync();
 		rte_pause();
+	}
 }
 
 /* Test the PENDING status of the timer handle tim */
@@ -489,6 +984,82 @@ rte_timer_pending(struct rte_timer *tim)
 	return tim->status.state == RTE_TIMER_PENDING;
 }
 
+/*
+ * Run the callbacks of a list of expired timers. The timers are RUNNING,
+ * so no other core can modify them; they are linked through wl.run_next,
+ * which is left untouched by the callbacks resetting them.
+ */
+static void
+timer_wheel_run(struct rte_timer *tim, unsigned lcore_id, uint64_t cur_time)
+{
+	union rte_timer_status status;
+	struct rte_timer *next_tim;
+
+	for ( ; tim != NULL; tim = next_tim) {
+		next_tim = tim->wl.run_next;
+
+		/* the timer was reset or stopped by a previous callback */
+		if (tim->status.state != RTE_TIMER_RUNNING)
+			continue;
+
+		priv_timer[lcore_id].updated = 0;
+
+		/* execute callback function with list unlocked */
+		tim->f(tim, tim->arg);
+
+		__TIMER_STAT_ADD(pending, -1);
+		/* the timer was stopped or reloaded by the callback
+		 * function, we have nothing to do here */
+		if (priv_timer[lcore_id].updated == 1)
+			continue;
+
+		if (tim->period == 0) {
+			/* mark timer as stopped */
+			status.state = RTE_TIMER_STOP;
+			status.owner = RTE_TIMER_NO_OWNER;
+			rte_wmb();
+			tim->status.u32 = status.u32;
+		} else {
+			/* the timer is not in the wheel, reload it from the
+			 * RUNNING state so that it is not removed first */
+			__rte_timer_reset(tim, cur_time + tim->period,
+				tim->period, lcore_id, tim->f, tim->arg, 0);
+		}
+	}
+}
+
+/* rte_timer_manage() for the timer wheel backend */
+static void
+timer_wheel_manage(unsigned lcore_id)
+{
+	struct timer_wheel *w = priv_timer[lcore_id].wheel;
+	struct rte_timer *tim;
+	uint64_t cur_time, cur_tick;
+
+	/* optimize for the case where the wheel is empty or has not turned
+	 * since the last call, these fields are only updated by this lcore
+	 * or are atomic on 64-bit */
+	if (w->n_pending == 0)
+		return;
+	cur_time = rte_get_timer_cycles();
+	cur_tick = cur_time >> timer_wheel_tick_shift;
+	if (cur_tick < w->cur_tick)
+		return;
+
+	/* run the expired timers by small batches, so that the list lock is
+	 * not held for long and the timers are still in cache when run */
+	for ( ; ; ) {
+		rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+		tim = timer_wheel_expire(w, cur_tick, TIMER_WHEEL_RUN_BATCH);
+		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+
+		if (tim == NULL)
+			break;
+
+		timer_wheel_run(tim, lcore_id, cur_time);
+	}
+}
+
 /* must be called periodically, run all timer that expired */
 void rte_timer_manage(void)
 {
@@ -500,6 +1071,17 @@ void rte_timer_manage(void)
 	int i, ret;
 
 	__TIMER_STAT_ADD(manage, 1);
+
+	/* apply the requests of the other lcores before looking for the
+	 * expired timers */
+	if (timer_mbox_enabled && priv_timer[lcore_id].mbox != NULL)
+		timer_mbox_drain(lcore_id);
+
+	if (timer_backend == RTE_TIMER_BACKEND_WHEEL) {
+		timer_wheel_manage(lcore_id);
+		return;
+	}
+
 	/* optimize for the case where per-cpu list is empty */
 	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
 		return;
@@ -119,13 +119,30 @@ typedef void (rte_timer_cb_t)(struct rte_timer *, void *);
 
 #define MAX_SKIPLIST_DEPTH 10
 
+/**
+ * Implementation of the per-lcore lists of pending timers.
+ */
+enum rte_timer_backend {
+	RTE_TIMER_BACKEND_SKIPLIST, /**< Skiplist sorted by expiry (default). */
+	RTE_TIMER_BACKEND_WHEEL,    /**< Hierarchical timer wheel. */
+};
+
 /**
  * A structure describing a timer in RTE.
  */
 struct rte_timer
 {
 	uint64_t expire;       /**< Time when timer expire. */
-	struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+	union {
+		/** Links of the skiplist backend. */
+		struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+		/** Links of the timer wheel backend. */
+		struct {
+			struct rte_timer *next;     /**< Next in wheel slot. */
+			struct rte_timer **pprev;   /**< Link to this timer. */
+			struct rte_timer *run_next; /**< Next expired timer. */
+		} wl;
+	};
 	volatile union rte_timer_status status; /**< Status of timer. */
 	uint64_t period;       /**< Period of timer (0 if not periodic). */
 	rte_timer_cb_t *f;     /**< Callback function. */
@@ -165,6 +182,75 @@ struct rte_timer
  */
 void rte_timer_subsystem_init(void);
 
+/**
+ * Select the implementation of the per-lcore lists of pending timers.
+ *
+ * The default skiplist keeps the timers sorted by expiry time, so
+ * arming and stopping a timer costs O(log n) and the timers expire with
+ * the precision of the rte_timer_manage() calls.
+ *
+ * The timer wheel hashes the timers into the slots of four levels of 256
+ * slots each, the first level covering the next 256 ticks of
+ * *resolution* cycles and each following level covering 256 times the
+ * span of the previous one. Arming, re-arming and stopping a timer cost
+ * O(1) whatever the number of pending timers, and rte_timer_manage()
+ * collects all the timers of an expired slot at once. The timers expire
+ * up to one tick late (never early), and the cost of rte_timer_manage()
+ * grows with the number of ticks elapsed since its previous call, so the
+ * tick is best set close to the period of the rte_timer_manage() calls.
+ *
+ * This function must be called when no timer is pending, including
+ * timers whose reset request is still in a lcore mailbox (see
+ * rte_timer_subsystem_mailbox_set()), and while no other lcore uses the
+ * timer library.
+ *
+ * @param backend
+ *   The implementation to use on all the lcores.
+ * @param resolution
+ *   Timer wheel tick, in timer cycles (see rte_get_timer_hz()). It is
+ *   rounded up to a power of 2. Ignored for the skiplist.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid backend or resolution.
+ *   - (-EBUSY): Some timers are pending, or some requests are still
+ *     posted: rte_timer_manage() must be called first on their target
+ *     lcores.
+ *   - (-ENOMEM): Cannot allocate the timer wheels.
+ */
+int rte_timer_subsystem_backend_set(enum rte_timer_backend backend,
+		uint64_t resolution);
+
+/**
+ * Enable or disable the lcore mailboxes.
+ *
+ * By default, arming a timer on another lcore, or re-arming a timer
+ * pending on another lcore, takes the spinlock protecting the list of
+ * pending timers of that lcore, which it also takes in rte_timer_manage().
+ *
+ * When the mailboxes are enabled, these requests are instead posted to a
+ * multi-producer single-consumer ring of the target lcore, and are
+ * applied by the target lcore in batches in its next rte_timer_manage()
+ * call. The timer stays in the CONFIG state until then, so other
+ * rte_timer_reset() and rte_timer_stop() calls on this timer fail in the
+ * meantime; the *_sync() variants apply the requests posted to the
+ * calling lcore while they wait. The spinlock of the other lcore is still
+ * taken when its mailbox is full, when the caller is not an EAL lcore, to
+ * move a timer pending on one lcore to a third one, and to stop a timer,
+ * so that a stopped timer can always be freed at once.
+ *
+ * This function must be called while no other lcore uses the timer
+ * library.
+ *
+ * @param enable
+ *   Non-zero to enable the mailboxes, 0 to disable them.
+ * @return
+ *   - 0: Success.
+ *   - (-EBUSY): Some requests are still posted, rte_timer_manage() must
+ *     be called first on their target lcores.
+ *   - (-ENOMEM): Cannot allocate the mailboxes.
+ */
+int rte_timer_subsystem_mailbox_set(int enable);
+
 /**
  * Initialize a timer handle.
  *
@@ -191,7 +277,9 @@ void rte_timer_init(struct rte_timer *tim);
  * timer is in the RUNNING state.
  *
  * If the timer is being configured on another core (the CONFIG state),
- * it will also fail.
+ * it will also fail. This includes a timer whose previous reset
+ * request is still in the mailbox of another lcore (see
+ * rte_timer_subsystem_mailbox_set()).
  *
  * If the timer is pending or stopped, it will be rescheduled with the
  * new parameters.
@@ -103,6 +103,10 @@ ifeq ($(CONFIG_RTE_LIBRTE_LPM),y)
 LDLIBS += -lrte_lpm
 endif
 
+ifeq ($(CONFIG_RTE_LIBRTE_RCU),y)
+LDLIBS += -lrte_rcu
+endif
+
 ifeq ($(CONFIG_RTE_LIBRTE_POWER),y)
 LDLIBS += -lrte_power
 endif